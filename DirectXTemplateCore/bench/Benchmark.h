@@ -0,0 +1,78 @@
+/**
+ * @brief A minimal benchmark harness for the DirectXTemplateCore library.
+ *
+ * Benchmarks are registered with the BENCHMARK macro and are run by the
+ * DirectXTemplateCoreBench executable. Pass a name (or part of a name) on the
+ * command line to run only the matching benchmarks.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct BenchmarkOptions
+{
+    // The directory where benchmarks write their output images.
+    // Images are not written if this is empty.
+    std::string OutputDirectory;
+    // Run fewer iterations (useful for smoke testing).
+    bool Quick;
+};
+
+typedef void (*BenchmarkFunction)( const BenchmarkOptions& options );
+
+struct BenchmarkInfo
+{
+    const char* Name;
+    BenchmarkFunction Function;
+};
+
+// The list of registered benchmarks.
+std::vector<BenchmarkInfo>& GetBenchmarks();
+
+struct BenchmarkRegistrar
+{
+    BenchmarkRegistrar( const char* name, BenchmarkFunction function )
+    {
+        BenchmarkInfo info = { name, function };
+        GetBenchmarks().push_back( info );
+    }
+};
+
+#define BENCHMARK( name ) \
+    static void name( const BenchmarkOptions& options ); \
+    static BenchmarkRegistrar g_##name##Registrar( #name, name ); \
+    static void name( const BenchmarkOptions& options )
+
+// Measures elapsed wall-clock time.
+class BenchmarkTimer
+{
+public:
+    BenchmarkTimer()
+        : m_Start( std::chrono::high_resolution_clock::now() )
+    {}
+
+    void Reset()
+    {
+        m_Start = std::chrono::high_resolution_clock::now();
+    }
+
+    // The elapsed time in seconds since the timer was created or reset.
+    double ElapsedSeconds() const
+    {
+        return std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - m_Start ).count();
+    }
+
+private:
+    std::chrono::high_resolution_clock::time_point m_Start;
+};
+
+// Prevent the compiler from optimizing away a computed value.
+template<typename T>
+inline void DoNotOptimize( const T& value )
+{
+    static volatile const void* sink;
+    sink = &value;
+}
@@ -0,0 +1,64 @@
+#include <Benchmark.h>
+
+#include <cstring>
+#include <iostream>
+
+std::vector<BenchmarkInfo>& GetBenchmarks()
+{
+    static std::vector<BenchmarkInfo> benchmarks;
+    return benchmarks;
+}
+
+static void PrintUsage( const char* program )
+{
+    std::cout << "Usage: " << program << " [-quick] [-output <directory>] [filter...]" << std::endl;
+    std::cout << "Available benchmarks:" << std::endl;
+    for ( const BenchmarkInfo& info : GetBenchmarks() )
+    {
+        std::cout << "  " << info.Name << std::endl;
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    BenchmarkOptions options;
+    options.Quick = false;
+    std::vector<std::string> filters;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-quick" ) == 0 )
+        {
+            options.Quick = true;
+        }
+        else if ( strcmp( argv[i], "-output" ) == 0 && i + 1 < argc )
+        {
+            options.OutputDirectory = argv[++i];
+        }
+        else if ( strcmp( argv[i], "-help" ) == 0 || strcmp( argv[i], "-h" ) == 0 )
+        {
+            PrintUsage( argv[0] );
+            return 0;
+        }
+        else
+        {
+            filters.push_back( argv[i] );
+        }
+    }
+
+    for ( const BenchmarkInfo& info : GetBenchmarks() )
+    {
+        bool run = filters.empty();
+        for ( const std::string& filter : filters )
+        {
+            run |= ( std::string( info.Name ).find( filter ) != std::string::npos );
+        }
+        if ( !run ) continue;
+
+        std::cout << "[" << info.Name << "]" << std::endl;
+        info.Function( options );
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <Benchmark.h>
+
+#include <Geometry.h>
+#include <Simd.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Math;
+
+namespace
+{
+    BoundingBox ComputeBoundingBoxScalar( const VertexCollection& vertices )
+    {
+        Float3 boxMin = vertices[0].position;
+        Float3 boxMax = vertices[0].position;
+        for ( const VertexPositionNormalTexture& vertex : vertices )
+        {
+            boxMin = Min( boxMin, vertex.position );
+            boxMax = Max( boxMax, vertex.position );
+        }
+        return BoundingBox( ( boxMin + boxMax ) * 0.5f, ( boxMax - boxMin ) * 0.5f );
+    }
+
+    // The largest difference between the corners of two boxes.
+    float BoxError( const BoundingBox& a, const BoundingBox& b )
+    {
+        Float3 minError = ( a.Center - a.Extents ) - ( b.Center - b.Extents );
+        Float3 maxError = ( a.Center + a.Extents ) - ( b.Center + b.Extents );
+        return std::max( { std::abs( minError.x ), std::abs( minError.y ), std::abs( minError.z ),
+                           std::abs( maxError.x ), std::abs( maxError.y ), std::abs( maxError.z ) } );
+    }
+
+    // Returns true if all of the vertices are inside the sphere.
+    bool Encloses( const BoundingSphere& sphere, const VertexCollection& vertices )
+    {
+        const float tolerance = 1e-5f;
+        for ( const VertexPositionNormalTexture& vertex : vertices )
+        {
+            if ( Length( vertex.position - sphere.Center ) > sphere.Radius + tolerance )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void RunBoundsBenchmark( const char* name, const VertexCollection& vertices, const BoundingBox& analyticBox, const BoundingSphere& analyticSphere, int numIterations )
+    {
+        BoundingBox scalarBox, simdBox;
+        BoundingSphere sphere;
+
+        BenchmarkTimer timer;
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            scalarBox = ComputeBoundingBoxScalar( vertices );
+            DoNotOptimize( scalarBox );
+        }
+        double scalarSeconds = timer.ElapsedSeconds();
+
+        timer.Reset();
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            simdBox = ComputeBoundingBox( vertices );
+            DoNotOptimize( simdBox );
+        }
+        double simdSeconds = timer.ElapsedSeconds();
+
+        timer.Reset();
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            sphere = ComputeBoundingSphere( vertices );
+            DoNotOptimize( sphere );
+        }
+        double sphereSeconds = timer.ElapsedSeconds();
+
+        double numVertices = static_cast<double>( vertices.size() ) * numIterations;
+        const char* result = ( BoxError( scalarBox, simdBox ) == 0.0f && Encloses( sphere, vertices ) ) ? "ok" : "FAILED";
+
+        printf( "%-8s %8zu %12.1f %12.1f %12.1f %10.4f %10.4f %10.2g %8s\n", name, vertices.size(),
+            numVertices / ( scalarSeconds * 1e6 ), numVertices / ( simdSeconds * 1e6 ), numVertices / ( sphereSeconds * 1e6 ),
+            sphere.Radius, analyticSphere.Radius, BoxError( simdBox, analyticBox ), result );
+    }
+}
+
+BENCHMARK( BoundingVolume_Compute )
+{
+    const size_t tessellation = options.Quick ? 32 : 128;
+    const int numIterations = options.Quick ? 10 : 500;
+
+    printf( "SIMD width %d, tessellation %zu, %d iterations\n", Simd::Width, tessellation, numIterations );
+    printf( "%-8s %8s %12s %12s %12s %10s %10s %10s %8s\n", "mesh", "vertices",
+        "scalar box", "SIMD box", "sphere", "radius", "analytic", "box error", "result" );
+    printf( "%-8s %8s %12s %12s %12s\n", "", "", "vertices/us", "vertices/us", "vertices/us" );
+
+    VertexCollection vertices;
+    IndexCollection indices;
+    BoundingBox box;
+    BoundingSphere sphere;
+
+    ComputeCube( vertices, indices );
+    ComputeCubeBounds( box, sphere );
+    RunBoundsBenchmark( "cube", vertices, box, sphere, numIterations );
+
+    ComputeSphere( vertices, indices, 1, tessellation );
+    ComputeSphereBounds( box, sphere );
+    RunBoundsBenchmark( "sphere", vertices, box, sphere, numIterations );
+
+    ComputeCone( vertices, indices, 1, 1, tessellation );
+    ComputeConeBounds( box, sphere );
+    RunBoundsBenchmark( "cone", vertices, box, sphere, numIterations );
+
+    ComputeTorus( vertices, indices, 1, 0.333f, tessellation );
+    ComputeTorusBounds( box, sphere );
+    RunBoundsBenchmark( "torus", vertices, box, sphere, numIterations );
+}
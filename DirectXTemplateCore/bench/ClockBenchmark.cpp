@@ -0,0 +1,125 @@
+#include <Benchmark.h>
+
+#include <Clock.h>
+
+#include <random>
+
+namespace
+{
+    // The frequency of QueryPerformanceCounter on most Windows 10 machines.
+    const int64_t QpcFrequency = 10000000;
+
+    // Jittery frame times between 14 and 19 ms.
+    int64_t NextFrameTicks( std::mt19937& random, int64_t frequency )
+    {
+        return frequency * 14 / 1000 + static_cast<int64_t>( random() % static_cast<uint32_t>( frequency * 5 / 1000 ) );
+    }
+}
+
+// The cost and resolution of the clock.
+BENCHMARK( Clock_Resolution )
+{
+    const int numSamples = options.Quick ? 1000000 : 10000000;
+
+    bool monotonic = true;
+    int64_t minDelta = INT64_MAX;
+    int64_t previous = Clock::GetTicks();
+
+    BenchmarkTimer timer;
+    for ( int i = 0; i < numSamples; ++i )
+    {
+        int64_t ticks = Clock::GetTicks();
+        monotonic = monotonic && ticks >= previous;
+        if ( ticks > previous )
+        {
+            minDelta = std::min( minDelta, ticks - previous );
+        }
+        previous = ticks;
+    }
+    double seconds = timer.ElapsedSeconds();
+
+    printf( "%lld ticks per second, %.1f ns per call, smallest step %.1f ns %-6s\n",
+        static_cast<long long>( Clock::GetFrequency() ), seconds / numSamples * 1e9,
+        Clock::TicksToSeconds( minDelta ) * 1e9, monotonic ? "ok" : "FAILED" );
+}
+
+// Run the application clock for days of jittery frames and compare the accumulated
+// total time and the number of fixed steps with the exact values. The float total time
+// and millisecond deltas (the old timeGetTime loop) and a double accumulator for the
+// fixed steps are shown for comparison.
+BENCHMARK( Clock_LongRun )
+{
+    const int numDays = options.Quick ? 1 : 21;
+    const uint32_t stepsPerSecond = 60;
+
+    printf( "%d days of frames at 14-19 ms\n", numDays );
+    printf( "%10s %14s %16s %16s %14s %14s %-6s\n", "frequency", "frames", "float drift s", "ms delta error", "steps", "double error", "" );
+
+    for ( int64_t frequency : { QpcFrequency, Clock::GetFrequency() } )
+    {
+        std::mt19937 random( 42 );
+
+        const int64_t endTicks = static_cast<int64_t>( numDays ) * 86400 * frequency;
+
+        Clock clock;
+        clock.Reset();
+        FixedTimestep timestep( stepsPerSecond, frequency, 1000 );
+
+        // The old loop: a float total time of millisecond deltas.
+        float floatTotal = 0.0f;
+        int64_t previousMilliseconds = 0;
+        double maxDeltaError = 0.0;
+
+        // A double accumulator with a step of 1/60 s.
+        double doubleAccumulator = 0.0;
+        uint64_t doubleSteps = 0;
+
+        int64_t exactTicks = 0;
+        uint64_t numFrames = 0;
+        bool alphaValid = true;
+        while ( exactTicks < endTicks )
+        {
+            int64_t deltaTicks = NextFrameTicks( random, frequency );
+            exactTicks += deltaTicks;
+            ++numFrames;
+
+            clock.Advance( deltaTicks );
+            timestep.Advance( deltaTicks );
+            double alpha = timestep.get_Alpha();
+            alphaValid = alphaValid && alpha >= 0.0 && alpha < 1.0;
+
+            int64_t milliseconds = exactTicks * 1000 / frequency;
+            float deltaTime = ( milliseconds - previousMilliseconds ) / 1000.0f;
+            previousMilliseconds = milliseconds;
+            floatTotal += deltaTime;
+            maxDeltaError = std::max( maxDeltaError, std::abs( deltaTime - static_cast<double>( deltaTicks ) / frequency ) );
+
+            doubleAccumulator += static_cast<double>( deltaTicks ) / frequency;
+            while ( doubleAccumulator >= 1.0 / stepsPerSecond )
+            {
+                doubleAccumulator -= 1.0 / stepsPerSecond;
+                ++doubleSteps;
+            }
+        }
+
+        // The exact number of steps in the elapsed time.
+        uint64_t exactSteps = static_cast<uint64_t>( exactTicks / frequency ) * stepsPerSecond + static_cast<uint64_t>( exactTicks % frequency ) * stepsPerSecond / frequency;
+        double exactSeconds = static_cast<double>( exactTicks ) / frequency;
+
+        bool valid = clock.get_TotalTicks() == exactTicks && clock.get_FrameCount() == numFrames &&
+            timestep.get_NumSteps() == exactSteps && timestep.get_DroppedTicks() == 0 && alphaValid;
+
+        printf( "%10lld %14llu %16.3f %16.3f %14llu %14lld %-6s\n", static_cast<long long>( frequency ),
+            static_cast<unsigned long long>( numFrames ), floatTotal - exactSeconds, maxDeltaError * 1e3,
+            static_cast<unsigned long long>( timestep.get_NumSteps() ),
+            static_cast<long long>( doubleSteps ) - static_cast<long long>( exactSteps ), valid ? "ok" : "FAILED" );
+    }
+
+    // A frame that takes too long is simulated with at most maxStepsPerAdvance steps.
+    FixedTimestep timestep( stepsPerSecond, QpcFrequency, 8 );
+    uint32_t numSteps = timestep.Advance( QpcFrequency );
+    bool clamped = numSteps == 8 && timestep.get_DroppedTicks() == QpcFrequency * 52 / stepsPerSecond &&
+        timestep.Advance( QpcFrequency / stepsPerSecond + 1 ) == 1;
+    printf( "A one second frame at %u steps per second: %u steps, %.3f s dropped %-6s\n", stepsPerSecond, numSteps,
+        static_cast<double>( timestep.get_DroppedTicks() ) / QpcFrequency, clamped ? "ok" : "FAILED" );
+}
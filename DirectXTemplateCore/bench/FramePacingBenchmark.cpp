@@ -0,0 +1,26 @@
+#include <Benchmark.h>
+
+#include <FramePacer.h>
+#include <FramePacingSimulation.h>
+
+using namespace FramePacingSimulation;
+
+// Simulate the frame loop on synthetic frame-time traces at 60 Hz and compare the
+// latency and the frame rate of the pacing policies.
+BENCHMARK( FramePacing_Simulation )
+{
+    const size_t numFrames = options.Quick ? 2000 : 20000;
+    const std::vector<Policy> policies = CreatePolicies();
+
+    printf( "%-10s %-22s %12s %12s %8s %10s %8s\n", "trace", "policy", "latency ms", "max ms", "fps", "repeated", "queued" );
+    for ( const Trace& trace : CreateTraces( numFrames ) )
+    {
+        for ( size_t p = 0; p < policies.size(); ++p )
+        {
+            PacingResult result = Simulate( policies[p], trace.Frames );
+            printf( "%-10s %-22s %12.2f %12.2f %8.1f %9.1f%% %8u\n", p == 0 ? trace.Name : "", policies[p].Name,
+                result.MeanLatency * 1e3, result.MaxLatency * 1e3, result.FramesPerSecond, result.RepeatedVBlanks * 100.0,
+                result.MaxQueuedFrames );
+        }
+    }
+}
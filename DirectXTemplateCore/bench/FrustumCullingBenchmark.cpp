@@ -0,0 +1,102 @@
+#include <Benchmark.h>
+
+#include <Camera.h>
+#include <Frustum.h>
+#include <Simd.h>
+
+#include <random>
+
+using namespace Math;
+
+namespace
+{
+    // A camera in the middle of a scene that is 200 units wide.
+    Camera CreateCamera()
+    {
+        Camera camera;
+        camera.set_Projection( 45.0f, 16.0f / 9.0f, 0.1f, 100.0f );
+        camera.set_LookAt( Float3( 0.0f, 0.0f, 0.0f ), Float3( 1.0f, 0.2f, 1.0f ), Float3( 0.0f, 1.0f, 0.0f ) );
+        return camera;
+    }
+
+    void GenerateScene( size_t numObjects, BoundingSphereArrays& spheres, BoundingBoxArrays& boxes )
+    {
+        std::mt19937 random( 1234 );
+        std::uniform_real_distribution<float> position( -100.0f, 100.0f );
+        std::uniform_real_distribution<float> size( 0.1f, 2.0f );
+
+        spheres.Reserve( numObjects );
+        boxes.Reserve( numObjects );
+        for ( size_t i = 0; i < numObjects; ++i )
+        {
+            Float3 center( position( random ), position( random ), position( random ) );
+            Float3 extents( size( random ), size( random ), size( random ) );
+
+            boxes.Add( BoundingBox( center, extents ) );
+            spheres.Add( BoundingSphere( center, Length( extents ) ) );
+        }
+    }
+
+    template<typename Arrays>
+    size_t CullScalar( const Frustum& frustum, const Arrays& volumes, std::vector<uint32_t>& visibleIndices )
+    {
+        visibleIndices.clear();
+        for ( size_t i = 0; i < volumes.Size(); ++i )
+        {
+            if ( frustum.Intersects( volumes.Get( i ) ) )
+            {
+                visibleIndices.push_back( static_cast<uint32_t>( i ) );
+            }
+        }
+        return visibleIndices.size();
+    }
+
+    template<typename Arrays>
+    void RunCullingBenchmark( const char* name, const Frustum& frustum, const Arrays& volumes, int numIterations )
+    {
+        std::vector<uint32_t> scalarVisible;
+        std::vector<uint32_t> simdVisible;
+        size_t numObjects = volumes.Size();
+
+        BenchmarkTimer timer;
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            CullScalar( frustum, volumes, scalarVisible );
+        }
+        double scalarSeconds = timer.ElapsedSeconds();
+
+        timer.Reset();
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            frustum.Cull( volumes, simdVisible );
+        }
+        double simdSeconds = timer.ElapsedSeconds();
+
+        DoNotOptimize( simdVisible.data() );
+
+        const char* result = ( scalarVisible == simdVisible ) ? "match" : "MISMATCH";
+        printf( "%-10s %10zu %10zu %18.1f %18.1f %10s\n", name, numObjects, simdVisible.size(),
+            numObjects * numIterations / ( scalarSeconds * 1e6 ),
+            numObjects * numIterations / ( simdSeconds * 1e6 ),
+            result );
+    }
+}
+
+BENCHMARK( Frustum_Culling )
+{
+    const size_t numObjects = options.Quick ? 10000 : 100000;
+    const int numIterations = options.Quick ? 10 : 200;
+
+    BoundingSphereArrays spheres;
+    BoundingBoxArrays boxes;
+    GenerateScene( numObjects, spheres, boxes );
+
+    Camera camera = CreateCamera();
+    const Frustum& frustum = camera.get_Frustum();
+
+    printf( "SIMD width %d, %d iterations\n", Simd::Width, numIterations );
+    printf( "%-10s %10s %10s %18s %18s %10s\n", "volume", "objects", "visible", "scalar objects/us", "SIMD objects/us", "result" );
+
+    RunCullingBenchmark( "spheres", frustum, spheres, numIterations );
+    RunCullingBenchmark( "boxes", frustum, boxes, numIterations );
+}
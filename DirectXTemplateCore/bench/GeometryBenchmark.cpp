@@ -0,0 +1,63 @@
+#include <Benchmark.h>
+
+#include <Geometry.h>
+#include <GeometryReference.h>
+
+#include <algorithm>
+#include <thread>
+
+using namespace Math;
+using namespace GeometryReference;
+
+namespace
+{
+    template<typename ReferenceFunction, typename Function>
+    void RunGeneratorBenchmark( const char* name, size_t tessellation, int numIterations,
+                                const ReferenceFunction& reference, const Function& function )
+    {
+        VertexCollection referenceVertices, vertices;
+        IndexCollection referenceIndices, indices;
+
+        BenchmarkTimer timer;
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            reference( referenceVertices, referenceIndices, tessellation );
+            DoNotOptimize( referenceVertices.data() );
+        }
+        double referenceSeconds = timer.ElapsedSeconds();
+
+        timer.Reset();
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            function( vertices, indices, tessellation );
+            DoNotOptimize( vertices.data() );
+        }
+        double seconds = timer.ElapsedSeconds();
+
+        double numVertices = static_cast<double>( vertices.size() ) * numIterations;
+        printf( "%-6s %12zu %10zu %10.0f %10.0f %8.2fx %10.2e\n", name, tessellation, vertices.size(),
+            numVertices / ( referenceSeconds * 1e3 ), numVertices / ( seconds * 1e3 ), referenceSeconds / seconds,
+            MeshDifference( referenceVertices, referenceIndices, vertices, indices ) );
+    }
+}
+
+BENCHMARK( Geometry_ProceduralMeshes )
+{
+    const size_t maxTessellation = options.Quick ? 256 : 1024;
+
+    printf( "Vertices generated per millisecond (%u hardware threads)\n", std::thread::hardware_concurrency() );
+    printf( "%-6s %12s %10s %10s %10s %9s %10s\n", "mesh", "tessellation", "vertices", "reference", "optimized", "speedup", "difference" );
+
+    for ( size_t tessellation = 16; tessellation <= maxTessellation; tessellation *= 4 )
+    {
+        // Keep the number of vertices generated per measurement roughly constant.
+        int numIterations = static_cast<int>( std::max<size_t>( 1, ( options.Quick ? 1 << 18 : 1 << 22 ) / ( tessellation * tessellation ) ) );
+
+        RunGeneratorBenchmark( "sphere", tessellation, numIterations,
+            []( VertexCollection& vertices, IndexCollection& indices, size_t tessellation ) { ComputeSphereReference( vertices, indices, 1.0f, tessellation, false ); },
+            []( VertexCollection& vertices, IndexCollection& indices, size_t tessellation ) { ComputeSphere( vertices, indices, 1.0f, tessellation, false ); } );
+        RunGeneratorBenchmark( "torus", tessellation, numIterations,
+            []( VertexCollection& vertices, IndexCollection& indices, size_t tessellation ) { ComputeTorusReference( vertices, indices, 1.0f, 0.333f, tessellation, false ); },
+            []( VertexCollection& vertices, IndexCollection& indices, size_t tessellation ) { ComputeTorus( vertices, indices, 1.0f, 0.333f, tessellation, false ); } );
+    }
+}
@@ -0,0 +1,62 @@
+#include <Benchmark.h>
+
+#include <GpuProfiler.h>
+#include <GpuProfilerFakes.h>
+#include <Profiler.h>
+
+using namespace GpuProfilerFakes;
+
+// Run the GPU profiler against a simulated GPU and report how many frames are read
+// back, skipped and disjoint, the dropped scopes and the readback latency in frames.
+BENCHMARK( GpuProfiler_Readback )
+{
+    const size_t numFrames = options.Quick ? 2000 : 20000;
+
+    // The profiler records the read back zones on the CPU profiler; the simulated times are meaningless there.
+    bool profilerEnabled = Profiler::get_Enabled();
+    Profiler::set_Enabled( false );
+
+    const Workload workloads[] = {
+        { "light", 0.010, 0.004, 0, 64 },
+        { "gpu bound", 0.010, 0.015, 0, 64 },
+        { "disjoint", 0.010, 0.004, 50, 64 },
+        { "few queries", 0.010, 0.004, 0, 6 },
+    };
+
+    printf( "%-12s %6s %10s %10s %10s %10s %10s\n", "workload", "slots", "resolved", "skipped", "disjoint", "dropped", "latency" );
+    for ( const Workload& workload : workloads )
+    {
+        for ( uint32_t numSlots = 2; numSlots <= 5; ++numSlots )
+        {
+            ProfilerResult result = RunProfiler( workload, numSlots, numFrames );
+
+            printf( "%-12s %6u %10llu %10llu %10llu %10llu %10llu\n", numSlots == 2 ? workload.Name : "", numSlots,
+                static_cast<unsigned long long>( result.NumResolved ), static_cast<unsigned long long>( result.NumSkipped ),
+                static_cast<unsigned long long>( result.NumDisjoint ), static_cast<unsigned long long>( result.NumDropped ),
+                static_cast<unsigned long long>( result.MaxLatency ) );
+        }
+    }
+
+    Profiler::set_Enabled( profilerEnabled );
+}
+
+// The error of the GPU to CPU clock mapping, with the GPU clock drifting by 100 ppm.
+BENCHMARK( GpuProfiler_ClockSync )
+{
+    const uint32_t numFrames = options.Quick ? 2000 : 20000;
+    const double submitLatency = 0.0005;
+    const double drift = 0.0001;
+
+    printf( "%-12s %10s %14s\n", "workload", "window", "max error ms" );
+    for ( double gpuFrameTime : { 0.004, 0.015 } )
+    {
+        double windowError = RunClockSync( numFrames, gpuFrameTime, drift, submitLatency, 64 );
+        double unboundedError = RunClockSync( numFrames, gpuFrameTime, drift, submitLatency, numFrames );
+
+        // A GPU that is always busy has no idle time to measure the offset, the error
+        // is the time that the commands wait in the queue.
+        const char* name = gpuFrameTime > 0.010 ? "gpu bound" : "light";
+        printf( "%-12s %10u %14.3f\n", name, 64, windowError * 1e3 );
+        printf( "%-12s %10u %14.3f\n", "", numFrames, unboundedError * 1e3 );
+    }
+}
@@ -0,0 +1,160 @@
+#include <Benchmark.h>
+
+#include <Geometry.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+using namespace Math;
+
+namespace
+{
+    // A terrain-like grid of ( size + 1 ) x ( size + 1 ) vertices in row-major order.
+    void ComputeGrid( VertexCollection& vertices, IndexCollection& indices, size_t size )
+    {
+        vertices.clear();
+        indices.clear();
+
+        size_t stride = size + 1;
+        for ( size_t z = 0; z <= size; ++z )
+        {
+            for ( size_t x = 0; x <= size; ++x )
+            {
+                float u = static_cast<float>( x ) / size;
+                float v = static_cast<float>( z ) / size;
+                float height = 0.1f * std::sin( u * 20.0f ) * std::cos( v * 20.0f );
+                vertices.push_back( VertexPositionNormalTexture( Float3( u, height, v ), Float3( 0, 1, 0 ), Float2( u, v ) ) );
+            }
+        }
+
+        for ( size_t z = 0; z < size; ++z )
+        {
+            for ( size_t x = 0; x < size; ++x )
+            {
+                uint32_t i0 = static_cast<uint32_t>( z * stride + x );
+                uint32_t i1 = i0 + 1;
+                uint32_t i2 = i0 + static_cast<uint32_t>( stride );
+                uint32_t i3 = i2 + 1;
+
+                indices.push_back( i0 ); indices.push_back( i2 ); indices.push_back( i1 );
+                indices.push_back( i1 ); indices.push_back( i2 ); indices.push_back( i3 );
+            }
+        }
+    }
+
+    // Shuffle the order of the triangles to simulate a mesh with poor locality (for
+    // example a scanned asset that was not optimized).
+    void ShuffleTriangles( IndexCollection& indices )
+    {
+        std::vector<uint32_t> triangles( indices.size() / 3 );
+        std::iota( triangles.begin(), triangles.end(), 0 );
+        std::shuffle( triangles.begin(), triangles.end(), std::mt19937( 1234 ) );
+
+        IndexCollection shuffled;
+        shuffled.reserve( indices.size() );
+        for ( uint32_t triangle : triangles )
+        {
+            shuffled.push_back( indices[triangle * 3] );
+            shuffled.push_back( indices[triangle * 3 + 1] );
+            shuffled.push_back( indices[triangle * 3 + 2] );
+        }
+        indices = shuffled;
+    }
+
+    /**
+     * Fetch the vertices of every triangle the way the input assembler does. This
+     * measures the cost of the index and vertex data on the CPU as a stand-in for
+     * the vertex fetch on the GPU.
+     */
+    float FetchTriangles( const VertexCollection& vertices, const IndexCollection& indices, const SubMesh& subMesh )
+    {
+        const VertexPositionNormalTexture* base = vertices.data() + subMesh.BaseVertex;
+        float sum = 0.0f;
+        if ( indices.get_Is32Bit() )
+        {
+            const uint32_t* index = static_cast<const uint32_t*>( indices.data() ) + subMesh.StartIndex;
+            for ( uint32_t i = 0; i < subMesh.IndexCount; ++i )
+            {
+                sum += base[index[i]].position.y;
+            }
+        }
+        else
+        {
+            const uint16_t* index = static_cast<const uint16_t*>( indices.data() ) + subMesh.StartIndex;
+            for ( uint32_t i = 0; i < subMesh.IndexCount; ++i )
+            {
+                sum += base[index[i]].position.y;
+            }
+        }
+        return sum;
+    }
+
+    double MeasureFetch( const VertexCollection& vertices, const IndexCollection& indices, const SubMeshCollection& subMeshes, int numIterations )
+    {
+        float sum = 0.0f;
+        BenchmarkTimer timer;
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            for ( const SubMesh& subMesh : subMeshes )
+            {
+                sum += FetchTriangles( vertices, indices, subMesh );
+            }
+        }
+        double seconds = timer.ElapsedSeconds();
+        DoNotOptimize( sum );
+        return seconds;
+    }
+
+    void RunIndexStrategyBenchmark( const char* name, const VertexCollection& vertices, const IndexCollection& indices, int numIterations )
+    {
+        SubMesh wholeMesh = { 0, static_cast<uint32_t>( indices.size() ), 0, static_cast<uint32_t>( vertices.size() ) };
+        SubMeshCollection singleDraw( 1, wholeMesh );
+
+        VertexCollection splitVertices;
+        IndexCollection splitIndices;
+        SubMeshCollection subMeshes;
+
+        BenchmarkTimer timer;
+        SplitMesh16( vertices, indices, splitVertices, splitIndices, subMeshes );
+        double splitSeconds = timer.ElapsedSeconds();
+
+        double seconds32 = MeasureFetch( vertices, indices, singleDraw, numIterations );
+        double seconds16 = MeasureFetch( splitVertices, splitIndices, subMeshes, numIterations );
+
+        const double MB = 1024.0 * 1024.0;
+        double bytes32 = indices.get_SizeInBytes() + vertices.size() * sizeof( VertexPositionNormalTexture );
+        double bytes16 = splitIndices.get_SizeInBytes() + splitVertices.size() * sizeof( VertexPositionNormalTexture );
+        double numTriangles = indices.size() / 3.0 * numIterations;
+
+        bool preferSplit = PreferSplitMesh( indices.size(), vertices.size(), splitVertices.size(), subMeshes.size() );
+
+        printf( "%-8s %9zu %9zu %6zu %9zu %8.1f %8.1f %8.2f %8.2f %8.1f %8s\n", name,
+            vertices.size(), indices.size() / 3, subMeshes.size(), splitVertices.size() - vertices.size(),
+            bytes32 / MB, bytes16 / MB,
+            numTriangles / ( seconds32 * 1e6 ), numTriangles / ( seconds16 * 1e6 ),
+            splitSeconds * 1e3, preferSplit ? "split" : "32-bit" );
+    }
+}
+
+BENCHMARK( Mesh_LargeIndexStrategies )
+{
+    const size_t gridSize = options.Quick ? 300 : 1024;
+    const int numIterations = options.Quick ? 2 : 20;
+
+    printf( "%d iterations\n", numIterations );
+    printf( "%-8s %9s %9s %6s %9s %8s %8s %8s %8s %8s %8s\n", "mesh", "vertices", "triangles", "draws", "dup verts",
+        "32 MB", "split MB", "32 tri/us", "16 tri/us", "split ms", "choice" );
+
+    VertexCollection vertices;
+    IndexCollection indices;
+
+    ComputeGrid( vertices, indices, gridSize );
+    RunIndexStrategyBenchmark( "terrain", vertices, indices, numIterations );
+
+    ShuffleTriangles( indices );
+    RunIndexStrategyBenchmark( "shuffled", vertices, indices, numIterations );
+
+    ComputeSphere( vertices, indices, 1.0f, options.Quick ? 200 : 400 );
+    RunIndexStrategyBenchmark( "sphere", vertices, indices, numIterations );
+}
@@ -0,0 +1,245 @@
+#include <Benchmark.h>
+
+#include <Camera.h>
+#include <Frustum.h>
+#include <JobSystem.h>
+#include <JobSystemStress.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <thread>
+
+using namespace Math;
+using namespace JobSystemStress;
+
+namespace
+{
+    // The thread counts to test: powers of two up to the number of hardware threads
+    // (at least 4 so that stealing is also tested on small machines).
+    std::vector<size_t> GetThreadCounts()
+    {
+        size_t maxThreads = std::max<size_t>( std::thread::hardware_concurrency(), 4 );
+
+        std::vector<size_t> threadCounts;
+        for ( size_t numThreads = 1; numThreads < maxThreads; numThreads *= 2 )
+        {
+            threadCounts.push_back( numThreads );
+        }
+        threadCounts.push_back( maxThreads );
+        return threadCounts;
+    }
+
+    // Many small jobs, jobs that start jobs, and jobs that wait for other jobs.
+    void StressJobs( JobSystem& jobSystem, int numJobs )
+    {
+        std::atomic<int> sum( 0 );
+        JobCounter counter;
+        for ( int i = 0; i < numJobs; ++i )
+        {
+            jobSystem.Run( [&sum, i]() { sum.fetch_add( i ); }, &counter );
+        }
+        jobSystem.Wait( counter );
+
+        // A tree of jobs: every job starts two children until the depth is reached.
+        std::atomic<int> numNodes( 0 );
+        JobCounter treeCounter;
+        std::function<void( int )> node = [&]( int depth )
+        {
+            numNodes.fetch_add( 1 );
+            if ( depth == 0 ) return;
+            jobSystem.Run( [&node, depth]() { node( depth - 1 ); }, &treeCounter );
+            jobSystem.Run( [&node, depth]() { node( depth - 1 ); }, &treeCounter );
+        };
+        jobSystem.Run( [&node]() { node( 12 ); }, &treeCounter );
+        jobSystem.Wait( treeCounter );
+
+        // A job that waits for its own child jobs.
+        std::atomic<int> nested( 0 );
+        JobCounter outerCounter;
+        for ( int i = 0; i < 64; ++i )
+        {
+            jobSystem.Run( [&jobSystem, &nested]()
+            {
+                JobCounter innerCounter;
+                for ( int j = 0; j < 16; ++j )
+                {
+                    jobSystem.Run( [&nested]() { nested.fetch_add( 1 ); }, &innerCounter );
+                }
+                jobSystem.Wait( innerCounter );
+            }, &outerCounter );
+        }
+        jobSystem.Wait( outerCounter );
+    }
+
+    // A diamond (A before B and C, both before D) and a chain of RunAfter jobs.
+    void StressDependencies( JobSystem& jobSystem, int numIterations )
+    {
+        for ( int iteration = 0; iteration < numIterations; ++iteration )
+        {
+            std::atomic<int> a( 0 ), b( 0 ), c( 0 ), d( 0 );
+            JobCounter aCounter, bcCounter, dCounter;
+            jobSystem.Run( [&]() { a.store( 1 ); }, &aCounter );
+            jobSystem.RunAfter( aCounter, [&]() { b.store( a.load() + 1 ); }, &bcCounter );
+            jobSystem.RunAfter( aCounter, [&]() { c.store( a.load() + 2 ); }, &bcCounter );
+            jobSystem.RunAfter( bcCounter, [&]() { d.store( b.load() + c.load() ); }, &dCounter );
+            jobSystem.Wait( dCounter );
+            jobSystem.Wait( aCounter );
+            jobSystem.Wait( bcCounter );
+
+            // Each stage of the chain starts after the previous one.
+            const int numStages = 16;
+            std::atomic<int> lastStage( 0 );
+            JobCounter stages[numStages];
+            jobSystem.Run( [&]() { lastStage.store( 0 ); }, &stages[0] );
+            for ( int stage = 1; stage < numStages; ++stage )
+            {
+                jobSystem.RunAfter( stages[stage - 1], [&, stage]() { lastStage.store( stage ); }, &stages[stage] );
+            }
+            for ( JobCounter& stage : stages ) jobSystem.Wait( stage );
+        }
+    }
+
+    // Ranges of random sizes and grain sizes.
+    void StressParallelFor( JobSystem& jobSystem, int numIterations )
+    {
+        std::mt19937 random( 11 );
+        for ( int iteration = 0; iteration < numIterations; ++iteration )
+        {
+            size_t begin = random() % 100;
+            size_t end = begin + random() % 20000;
+            size_t grainSize = 1 + random() % 500;
+
+            std::vector<uint32_t> visits( end, 0 );
+            jobSystem.ParallelFor( begin, end, grainSize, [&]( size_t rangeBegin, size_t rangeEnd )
+            {
+                for ( size_t i = rangeBegin; i < rangeEnd; ++i ) ++visits[i];
+            } );
+            DoNotOptimize( visits.data() );
+        }
+    }
+
+    // Animate objects: a transform per object from a few sines and cosines.
+    void AnimateObjects( std::vector<Float3>& positions, size_t begin, size_t end, float time )
+    {
+        for ( size_t i = begin; i < end; ++i )
+        {
+            float phase = static_cast<float>( i ) * 0.001f + time;
+            float radius = 10.0f + 5.0f * std::sin( phase * 0.37f );
+            positions[i] = Float3( radius * std::cos( phase ), 2.0f * std::sin( phase * 3.0f ), radius * std::sin( phase ) );
+        }
+    }
+
+    // Cull objects one at a time against the frustum.
+    size_t CullObjects( const Frustum& frustum, const std::vector<Float3>& positions, size_t begin, size_t end )
+    {
+        size_t numVisible = 0;
+        for ( size_t i = begin; i < end; ++i )
+        {
+            numVisible += frustum.Intersects( BoundingSphere( positions[i], 0.5f ) );
+        }
+        return numVisible;
+    }
+}
+
+// The time of the stress workloads on 1 to N threads: the deque with N - 1 thieves,
+// nested jobs, dependency chains and ParallelFor over ranges of random sizes.
+BENCHMARK( JobSystem_Stress )
+{
+    const int numIterations = options.Quick ? 20 : 2000;
+    const size_t numTokens = options.Quick ? 20000 : 200000;
+
+    printf( "%8s %12s %12s %15s %12s\n", "threads", "deque ns", "jobs ms", "dependencies ms", "for ms" );
+    for ( size_t numThreads : GetThreadCounts() )
+    {
+        BenchmarkTimer timer;
+        std::vector<uint32_t> counts = StressQueue( numThreads - 1, numTokens );
+        double queueSeconds = timer.ElapsedSeconds() / numTokens;
+        DoNotOptimize( counts.data() );
+
+        JobSystem jobSystem( numThreads );
+        const int numJobRuns = numIterations / 10 + 1;
+        timer.Reset();
+        for ( int i = 0; i < numJobRuns; ++i )
+        {
+            StressJobs( jobSystem, 20000 );
+        }
+        double jobsSeconds = timer.ElapsedSeconds() / numJobRuns;
+
+        timer.Reset();
+        StressDependencies( jobSystem, numIterations );
+        double dependenciesSeconds = timer.ElapsedSeconds();
+
+        timer.Reset();
+        StressParallelFor( jobSystem, numIterations );
+        double parallelForSeconds = timer.ElapsedSeconds();
+
+        printf( "%8zu %12.1f %12.3f %15.3f %12.3f\n", numThreads, queueSeconds * 1e9, jobsSeconds * 1e3,
+            dependenciesSeconds * 1e3, parallelForSeconds * 1e3 );
+    }
+}
+
+// The time to animate and cull objects with ParallelFor on 1 to N threads,
+// and the overhead of a job.
+BENCHMARK( JobSystem_Scalability )
+{
+    const size_t numObjects = options.Quick ? 200000 : 2000000;
+    const int numFrames = options.Quick ? 5 : 30;
+    const size_t grainSize = 4096;
+    const int numEmptyJobs = options.Quick ? 20000 : 200000;
+
+    Camera camera;
+    camera.set_Projection( 60.0f, 16.0f / 9.0f, 0.1f, 100.0f );
+    camera.set_LookAt( Float3( 0, 5, -25 ), Float3( 0, 0, 0 ), Float3( 0, 1, 0 ) );
+    const Frustum& frustum = camera.get_Frustum();
+
+    std::vector<Float3> positions( numObjects );
+
+    printf( "%zu objects in ranges of %zu, %d frames (%u hardware threads)\n", numObjects, grainSize, numFrames, std::thread::hardware_concurrency() );
+    printf( "%8s %12s %10s %12s %10s %8s %12s\n", "threads", "ms/frame", "speedup", "efficiency", "stolen", "sleeps", "ns/job" );
+
+    double baseSeconds = 0.0;
+    for ( size_t numThreads : GetThreadCounts() )
+    {
+        JobSystem jobSystem( numThreads );
+
+        std::atomic<size_t> numVisible( 0 );
+
+        BenchmarkTimer timer;
+        for ( int frame = 0; frame < numFrames; ++frame )
+        {
+            float time = frame * 0.016f;
+            numVisible.store( 0 );
+
+            jobSystem.ParallelFor( 0, numObjects, grainSize, [&]( size_t begin, size_t end )
+            {
+                AnimateObjects( positions, begin, end, time );
+                numVisible.fetch_add( CullObjects( frustum, positions, begin, end ) );
+            } );
+        }
+        double seconds = timer.ElapsedSeconds() / numFrames;
+        JobSystem::Statistics statistics = jobSystem.get_Statistics();
+
+        if ( numThreads == 1 )
+        {
+            baseSeconds = seconds;
+        }
+
+        // The overhead of starting and finishing an empty job.
+        JobCounter counter;
+        timer.Reset();
+        for ( int i = 0; i < numEmptyJobs; ++i )
+        {
+            jobSystem.Run( []() {}, &counter );
+        }
+        jobSystem.Wait( counter );
+        double jobSeconds = timer.ElapsedSeconds() / numEmptyJobs;
+
+        double speedup = baseSeconds / seconds;
+        printf( "%8zu %12.3f %9.2fx %11.0f%% %10llu %8llu %12.1f\n", numThreads, seconds * 1e3, speedup,
+            100.0 * speedup / numThreads, static_cast<unsigned long long>( statistics.JobsStolen ),
+            static_cast<unsigned long long>( statistics.Sleeps ), jobSeconds * 1e9 );
+    }
+}
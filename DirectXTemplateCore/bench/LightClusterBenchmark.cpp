@@ -0,0 +1,63 @@
+#include <Benchmark.h>
+
+#include <Camera.h>
+#include <JobSystem.h>
+#include <LightClusters.h>
+#include <VenueScene.h>
+
+#include <algorithm>
+#include <thread>
+
+using namespace Math;
+using namespace VenueScene;
+
+// The time to assign growing numbers of lights to 16 x 9 x 24 clusters on one and on
+// all threads, the number of light indices and the memory of the buffers.
+BENCHMARK( LightClusters_Assign )
+{
+    const int numIterations = options.Quick ? 5 : 50;
+    const size_t maxLights = options.Quick ? 4096 : 65536;
+    const size_t numThreads = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+
+    Camera camera = CreateCamera();
+    LightClusters clusters;
+    clusters.SetProjection( camera );
+    LightClusters parallelClusters;
+    parallelClusters.SetProjection( camera );
+    JobSystem jobSystem( numThreads );
+
+    printf( "%u x %u x %u clusters, %zu threads, %d iterations\n", clusters.get_NumTilesX(), clusters.get_NumTilesY(),
+        clusters.get_NumSlices(), numThreads, numIterations );
+    printf( "%8s %10s %10s %12s %12s %10s %10s %10s %10s\n", "lights", "ms", "ms (MT)", "lights/ms",
+        "lights/ms MT", "indices", "avg/cluster", "GPU KB", "CPU KB" );
+
+    BoundingSphereArrays bounds;
+    for ( size_t numLights = 16; numLights <= maxLights; numLights *= 4 )
+    {
+        ViewSpaceBounds( GenerateLights( numLights ), camera.get_ViewMatrix(), bounds );
+
+        BenchmarkTimer timer;
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            clusters.AssignLights( bounds );
+        }
+        double seconds = timer.ElapsedSeconds() / numIterations;
+
+        timer.Reset();
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            parallelClusters.AssignLights( bounds, &jobSystem );
+        }
+        double parallelSeconds = timer.ElapsedSeconds() / numIterations;
+        DoNotOptimize( parallelClusters.get_LightIndices().data() );
+
+        // The GPU buffers: the lights, the clusters and the light indices.
+        size_t numIndices = clusters.get_LightIndices().size();
+        size_t gpuBytes = numLights * sizeof( Light ) + clusters.get_NumClusters() * sizeof( LightCluster ) + numIndices * sizeof( uint32_t );
+
+        printf( "%8zu %10.3f %10.3f %12.0f %12.0f %10zu %10.1f %10.1f %10.1f\n", numLights, seconds * 1e3, parallelSeconds * 1e3,
+            numLights / ( seconds * 1e3 ), numLights / ( parallelSeconds * 1e3 ), numIndices,
+            static_cast<double>( numIndices ) / clusters.get_NumClusters(), gpuBytes / 1024.0,
+            clusters.get_MemoryUsage() / 1024.0 );
+    }
+}
@@ -0,0 +1,67 @@
+#include <Benchmark.h>
+
+#include <LightManager.h>
+#include <LightManagerScene.h>
+
+#include <cstring>
+#include <random>
+
+using namespace LightManagerScene;
+
+// The time and the bytes per frame to upload the lights of a scene with growing
+// numbers of static lights and eight animated lights: rebuilding and uploading all
+// of the lights every frame, and uploading only the dirty lights through a staging
+// ring.
+BENCHMARK( LightManager_Upload )
+{
+    const int numFrames = options.Quick ? 50 : 500;
+    const uint32_t maxStaticLights = options.Quick ? 4096 : 65536;
+    const uint64_t framesInFlight = 3;
+
+    printf( "%d animated lights, %d frames, %llu frames in flight\n", NumAnimatedLights, numFrames, static_cast<unsigned long long>( framesInFlight ) );
+    printf( "%8s %12s %12s %12s %12s %8s %8s\n", "static", "full us", "full KB", "dirty us", "dirty KB", "ranges", "stalls" );
+
+    for ( uint32_t numStaticLights = 16; numStaticLights <= maxStaticLights; numStaticLights *= 4 )
+    {
+        std::mt19937 random( 1234 );
+
+        LightManager lights;
+        LightHandle animated[NumAnimatedLights];
+        AddLights( lights, numStaticLights, random, animated );
+
+        // The old path: every light is built and uploaded every frame.
+        std::vector<Light> fullUpload( lights.get_NumLights() );
+        std::vector<Light> gpuLights( lights.get_NumLights() );
+        BenchmarkTimer timer;
+        for ( int frame = 0; frame < numFrames; ++frame )
+        {
+            AnimateLights( lights, animated, frame * 0.01f );
+            lights.WriteLights( 0, lights.get_NumLights(), fullUpload.data() );
+            memcpy( gpuLights.data(), fullUpload.data(), fullUpload.size() * sizeof( Light ) );
+            DoNotOptimize( gpuLights.data() );
+        }
+        double fullSeconds = timer.ElapsedSeconds() / numFrames;
+        size_t fullBytes = lights.get_NumLights() * sizeof( Light );
+
+        // Only the animated lights are dirty after the first frame.
+        SimulatedLightBuffer buffer( 1024 * 1024 );
+        lights.MarkAllDirty();
+        buffer.Update( lights );
+
+        size_t dirtyBytes = 0;
+        size_t numRanges = 0;
+        timer.Reset();
+        for ( int frame = 0; frame < numFrames; ++frame )
+        {
+            AnimateLights( lights, animated, frame * 0.01f );
+            dirtyBytes += buffer.Update( lights );
+            numRanges += buffer.get_Ranges().size();
+            buffer.EndFrame( frame + 1, framesInFlight );
+        }
+        double dirtySeconds = timer.ElapsedSeconds() / numFrames;
+
+        printf( "%8u %12.2f %12.1f %12.2f %12.2f %8.1f %8llu\n", numStaticLights, fullSeconds * 1e6, fullBytes / 1024.0,
+            dirtySeconds * 1e6, dirtyBytes / 1024.0 / numFrames, static_cast<double>( numRanges ) / numFrames,
+            static_cast<unsigned long long>( buffer.get_Stalls() ) );
+    }
+}
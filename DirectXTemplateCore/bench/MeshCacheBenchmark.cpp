@@ -0,0 +1,140 @@
+#include <Benchmark.h>
+
+#include <Geometry.h>
+#include <MeshCache.h>
+#include <MeshOptimizer.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    // The view of a generated mesh that is drawn with a single draw call.
+    MeshData GetMeshData( const VertexCollection& vertices, const IndexCollection& indices, const SubMesh& subMesh )
+    {
+        MeshData mesh = {};
+        mesh.VertexLayout = MeshVertexLayoutFullPrecision;
+        mesh.VertexStride = sizeof( VertexPositionNormalTexture );
+        mesh.VertexCount = static_cast<uint32_t>( vertices.size() );
+        mesh.Vertices = vertices.data();
+        mesh.IndexSize = static_cast<uint32_t>( indices.get_IndexSize() );
+        mesh.IndexCount = static_cast<uint32_t>( indices.size() );
+        mesh.Indices = indices.data();
+        mesh.SubMeshCount = 1;
+        mesh.SubMeshes = &subMesh;
+        mesh.Box = ComputeBoundingBox( vertices );
+        mesh.Sphere = ComputeBoundingSphere( vertices );
+        return mesh;
+    }
+
+    bool IsEqual( const MeshData& a, const MeshData& b )
+    {
+        return a.VertexLayout == b.VertexLayout && a.VertexCount == b.VertexCount && a.IndexSize == b.IndexSize &&
+               a.IndexCount == b.IndexCount && a.SubMeshCount == b.SubMeshCount && a.LodCount == b.LodCount &&
+               a.MeshletCount == b.MeshletCount &&
+               memcmp( a.Vertices, b.Vertices, static_cast<size_t>( a.VertexCount ) * a.VertexStride ) == 0 &&
+               memcmp( a.Indices, b.Indices, static_cast<size_t>( a.IndexCount ) * a.IndexSize ) == 0 &&
+               memcmp( a.SubMeshes, b.SubMeshes, a.SubMeshCount * sizeof( SubMesh ) ) == 0 &&
+               memcmp( a.Lods, b.Lods, a.LodCount * sizeof( MeshLod ) ) == 0 &&
+               memcmp( a.Meshlets, b.Meshlets, a.MeshletCount * sizeof( Meshlet ) ) == 0;
+    }
+
+    void RunCacheBenchmark( const MeshCache& cache, size_t tessellation, int numIterations )
+    {
+        MeshCacheKey key( "Sphere" );
+        key.Add( 1.0f ).Add( tessellation ).Add( false );
+
+        VertexCollection vertices;
+        IndexCollection indices;
+
+        // What a cache miss costs: generate and optimize the mesh.
+        BenchmarkTimer timer;
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            ComputeSphere( vertices, indices, 1.0f, tessellation, false );
+            OptimizeMesh( vertices, indices );
+            DoNotOptimize( vertices.data() );
+        }
+        double generateSeconds = timer.ElapsedSeconds() / numIterations;
+
+        SubMesh subMesh = { 0, static_cast<uint32_t>( indices.size() ), 0, static_cast<uint32_t>( vertices.size() ) };
+        MeshData mesh = GetMeshData( vertices, indices, subMesh );
+
+        timer.Reset();
+        bool stored = cache.Store( key, mesh );
+        double storeSeconds = timer.ElapsedSeconds();
+
+        // What a cache hit costs: map and validate the file and copy the streams
+        // once, like the buffer creation does (the file is in the file cache).
+        std::vector<uint8_t> uploadBuffer( static_cast<size_t>( mesh.VertexCount ) * mesh.VertexStride + static_cast<size_t>( mesh.IndexCount ) * mesh.IndexSize );
+        bool loaded = true;
+        MeshFile file;
+
+        timer.Reset();
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            loaded = loaded && cache.Load( key, file );
+            if ( loaded )
+            {
+                const MeshData& loadedMesh = file.get_MeshData();
+                size_t verticesSize = static_cast<size_t>( loadedMesh.VertexCount ) * loadedMesh.VertexStride;
+                memcpy( uploadBuffer.data(), loadedMesh.Vertices, verticesSize );
+                memcpy( uploadBuffer.data() + verticesSize, loadedMesh.Indices, static_cast<size_t>( loadedMesh.IndexCount ) * loadedMesh.IndexSize );
+                DoNotOptimize( uploadBuffer.data() );
+            }
+        }
+        double loadSeconds = timer.ElapsedSeconds() / numIterations;
+
+        bool valid = stored && loaded && IsEqual( mesh, file.get_MeshData() );
+        file.Close();
+
+        printf( "%12zu %10zu %10.1f %10.3f %10.3f %10.3f %8.1fx %-6s\n", tessellation, vertices.size(),
+            uploadBuffer.size() / 1024.0, generateSeconds * 1e3, storeSeconds * 1e3, loadSeconds * 1e3,
+            generateSeconds / loadSeconds, valid ? "ok" : "FAILED" );
+
+        std::remove( cache.get_FileName( key ).c_str() );
+    }
+}
+
+BENCHMARK( MeshCache_LoadVsGenerate )
+{
+    const size_t maxTessellation = options.Quick ? 256 : 1024;
+    const int numIterations = options.Quick ? 1 : 4;
+
+    // The cache files are written to the output directory (or the current directory) and removed afterwards.
+    MeshCache cache( options.OutputDirectory );
+
+    printf( "Generating and optimizing a sphere compared to loading it from a memory-mapped mesh file\n" );
+    printf( "%12s %10s %10s %10s %10s %10s %9s %-6s\n", "tessellation", "vertices", "KB", "generate", "store", "load", "speedup", "" );
+    printf( "%12s %10s %10s %10s %10s %10s %9s %-6s\n", "", "", "", "ms", "ms", "ms", "", "" );
+
+    for ( size_t tessellation = 64; tessellation <= maxTessellation; tessellation *= 4 )
+    {
+        RunCacheBenchmark( cache, tessellation, numIterations );
+    }
+
+    // A file with another version is a cache miss.
+    MeshCacheKey key( "Invalid" );
+    VertexCollection vertices;
+    IndexCollection indices;
+    ComputeCube( vertices, indices );
+    SubMesh subMesh = { 0, static_cast<uint32_t>( indices.size() ), 0, static_cast<uint32_t>( vertices.size() ) };
+    cache.Store( key, GetMeshData( vertices, indices, subMesh ) );
+
+    std::string fileName = cache.get_FileName( key );
+    FILE* file = fopen( fileName.c_str(), "r+b" );
+    bool rejected = false;
+    if ( file )
+    {
+        uint32_t version = MeshFileHeader::FileVersion + 1;
+        fseek( file, offsetof( MeshFileHeader, Version ), SEEK_SET );
+        fwrite( &version, sizeof( version ), 1, file );
+        fclose( file );
+
+        MeshFile meshFile;
+        rejected = !cache.Load( key, meshFile );
+    }
+    printf( "Files with another version are rejected: %s\n", rejected ? "ok" : "FAILED" );
+    std::remove( fileName.c_str() );
+}
@@ -0,0 +1,108 @@
+#include <Benchmark.h>
+
+#include <Camera.h>
+#include <Geometry.h>
+#include <MeshOptimizer.h>
+#include <MeshOptimizerMeshes.h>
+#include <SoftwareRasterizer.h>
+
+#include <cmath>
+
+using namespace Math;
+using namespace MeshOptimizerMeshes;
+
+namespace
+{
+    /**
+     * The number of pixels that pass the depth test when the mesh is drawn from a
+     * few directions around it. The fewer pixels are shaded, the less overdraw.
+     */
+    uint64_t MeasureShadedPixels( const VertexCollection& vertices, const IndexCollection& indices )
+    {
+        const uint32_t size = 256;
+        const int numViews = 8;
+
+        SoftwareRasterizer rasterizer( size, size, 1 );
+        rasterizer.set_MaterialProperties( MaterialProperties() );
+        rasterizer.set_LightProperties( LightProperties() );
+
+        Camera camera( Camera::LeftHanded );
+        camera.set_Projection( 45.0f, 1.0f, 0.1f, 100.0f );
+
+        PerObjectConstants perObject;
+        perObject.WorldMatrix = MatrixIdentity();
+        perObject.InverseTransposeWorldMatrix = MatrixIdentity();
+
+        uint64_t pixelsShaded = 0;
+        for ( int view = 0; view < numViews; ++view )
+        {
+            float angle = view * TwoPi / numViews;
+            Float3 eye( std::sin( angle ) * 2.0f, 1.2f, std::cos( angle ) * 2.0f );
+            camera.set_LookAt( eye, Float3( 0, 0, 0 ), Float3( 0, 1, 0 ) );
+            perObject.WorldViewProjectionMatrix = camera.get_ViewMatrix() * camera.get_ProjectionMatrix();
+
+            rasterizer.ResetStatistics();
+            rasterizer.Clear( Float4( 0, 0, 0, 1 ), 1.0f );
+            rasterizer.DrawIndexed( vertices, indices, perObject );
+            rasterizer.Flush();
+            pixelsShaded += rasterizer.get_Statistics().PixelsShaded;
+        }
+        return pixelsShaded;
+    }
+
+    void RunOptimizerBenchmark( const char* name, VertexCollection vertices, IndexCollection indices )
+    {
+        VertexCache::Statistics fifoBefore = AnalyzeVertexCache( indices, vertices.size(), 16, VertexCache::FIFO );
+        VertexCache::Statistics lruBefore = AnalyzeVertexCache( indices, vertices.size(), 32, VertexCache::LRU );
+        uint64_t pixelsBefore = MeasureShadedPixels( vertices, indices );
+
+        BenchmarkTimer timer;
+        OptimizeVertexCache( indices, vertices.size() );
+        double cacheSeconds = timer.ElapsedSeconds();
+        VertexCache::Statistics fifoCache = AnalyzeVertexCache( indices, vertices.size(), 16, VertexCache::FIFO );
+
+        timer.Reset();
+        OptimizeOverdraw( indices, vertices );
+        OptimizeVertexFetch( vertices, indices );
+        double overdrawSeconds = timer.ElapsedSeconds();
+
+        VertexCache::Statistics fifoAfter = AnalyzeVertexCache( indices, vertices.size(), 16, VertexCache::FIFO );
+        VertexCache::Statistics lruAfter = AnalyzeVertexCache( indices, vertices.size(), 32, VertexCache::LRU );
+        uint64_t pixelsAfter = MeasureShadedPixels( vertices, indices );
+
+        printf( "%-9s %9zu %6.3f %6.3f %6.3f %6.3f %6.3f %6.3f %6.3f %11llu %11llu %8.1f %8.1f\n", name, fifoBefore.Triangles,
+            fifoBefore.ACMR, fifoCache.ACMR, fifoAfter.ACMR, lruBefore.ACMR, lruAfter.ACMR,
+            fifoBefore.ATVR, fifoAfter.ATVR,
+            static_cast<unsigned long long>( pixelsBefore ), static_cast<unsigned long long>( pixelsAfter ),
+            cacheSeconds * 1e3, overdrawSeconds * 1e3 );
+    }
+}
+
+BENCHMARK( MeshOptimizer_VertexCacheAndOverdraw )
+{
+    const size_t tessellation = options.Quick ? 32 : 128;
+
+    printf( "ACMR and ATVR for a 16 entry FIFO and a 32 entry LRU cache, pixels shaded from 8 views\n" );
+    printf( "%-9s %9s %6s %6s %6s %6s %6s %6s %6s %11s %11s %8s %8s\n", "mesh", "triangles",
+        "FIFO", "cache", "all", "LRU", "LRU", "ATVR", "ATVR", "pixels", "pixels", "cache", "overdraw" );
+    printf( "%-9s %9s %6s %6s %6s %6s %6s %6s %6s %11s %11s %8s %8s\n", "", "",
+        "before", "pass", "passes", "before", "after", "before", "after", "before", "after", "ms", "ms" );
+
+    VertexCollection vertices;
+    IndexCollection indices;
+
+    ComputeSphere( vertices, indices, 1.0f, tessellation, false );
+    RunOptimizerBenchmark( "sphere", vertices, indices );
+
+    ComputeCone( vertices, indices, 1.0f, 1.0f, tessellation, false );
+    RunOptimizerBenchmark( "cone", vertices, indices );
+
+    ComputeSphereBlock( vertices, indices, tessellation / 4 );
+    RunOptimizerBenchmark( "block", vertices, indices );
+
+    ComputeTorus( vertices, indices, 1.0f, 0.333f, tessellation, false );
+    RunOptimizerBenchmark( "torus", vertices, indices );
+
+    ShuffleTriangles( indices );
+    RunOptimizerBenchmark( "shuffled", vertices, indices );
+}
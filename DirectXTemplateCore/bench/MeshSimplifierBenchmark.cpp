@@ -0,0 +1,75 @@
+#include <Benchmark.h>
+
+#include <Camera.h>
+#include <Geometry.h>
+#include <MeshSimplifier.h>
+#include <MeshSimplifierMeshes.h>
+
+#include <string>
+
+using namespace MeshSimplifierMeshes;
+
+namespace
+{
+    /**
+     * Generate the LOD chain of a mesh and report the triangles, the estimated error of
+     * each LOD, the measured deviation and the distance from which each LOD is drawn
+     * by a 1080p camera with a 1 pixel error threshold.
+     */
+    void RunLodBenchmark( const char* name, const VertexCollection& vertices, const IndexCollection& sourceIndices, bool measure )
+    {
+        IndexCollection indices = sourceIndices;
+        MeshLodCollection lods;
+
+        BenchmarkTimer timer;
+        GenerateLods( vertices, indices, lods, 5, 0.5f );
+        double seconds = timer.ElapsedSeconds();
+
+        Camera camera( Camera::LeftHanded );
+        Viewport viewport = { 0.0f, 0.0f, 1920.0f, 1080.0f, 0.0f, 1.0f };
+        camera.set_Viewport( viewport );
+        camera.set_Projection( 60.0f, 1920.0f / 1080.0f, 0.1f, 1000.0f );
+
+        printf( "%s: %zu vertices, %zu LODs in %.2f ms\n", name, vertices.size(), lods.size(), seconds * 1e3 );
+        printf( "%5s %10s %8s %12s %12s %12s\n", "LOD", "triangles", "kept", "estimated", "measured", "from" );
+
+        for ( size_t i = 0; i < lods.size(); ++i )
+        {
+            const MeshLod& lod = lods[i];
+            float measured = ( measure && i > 0 ) ? MeasureDeviation( vertices, indices, lods[0], lod ) : 0.0f;
+
+            // The distance from the surface of the bounding sphere at which the error
+            // of the LOD projects to 1 pixel.
+            float distance = ( lod.Error > 0.0f ) ? camera.ProjectedSize( lod.Error, 1.0f ) : 0.0f;
+
+            printf( "%5zu %10u %7.1f%% %12.6f %12s %12.2f\n", i, lod.IndexCount / 3,
+                100.0f * lod.IndexCount / lods[0].IndexCount, lod.Error,
+                measure ? std::to_string( measured ).c_str() : "-", distance );
+        }
+    }
+}
+
+BENCHMARK( MeshSimplifier_LodChain )
+{
+    VertexCollection vertices;
+    IndexCollection indices;
+
+    // The deviation is measured by brute force on the small meshes.
+    ComputeSphere( vertices, indices, 1.0f, 24, false );
+    RunLodBenchmark( "Sphere (diameter 1)", vertices, indices, true );
+
+    ComputeTorus( vertices, indices, 1.0f, 0.333f, 32, false );
+    RunLodBenchmark( "Torus (diameter 1)", vertices, indices, true );
+
+    ComputeTerrain( vertices, indices, 100.0f, 48 );
+    RunLodBenchmark( "Terrain (100 x 100)", vertices, indices, true );
+
+    if ( !options.Quick )
+    {
+        ComputeTerrain( vertices, indices, 100.0f, 512 );
+        RunLodBenchmark( "Large terrain (100 x 100)", vertices, indices, false );
+
+        ComputeSphere( vertices, indices, 1.0f, 256, false );
+        RunLodBenchmark( "Large sphere (diameter 1)", vertices, indices, false );
+    }
+}
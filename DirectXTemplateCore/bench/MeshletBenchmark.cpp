@@ -0,0 +1,104 @@
+#include <Benchmark.h>
+
+#include <Camera.h>
+#include <Geometry.h>
+#include <MeshOptimizer.h>
+#include <Meshlets.h>
+#include <MeshletVisibility.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Math;
+using namespace MeshletVisibility;
+
+namespace
+{
+    void RunMeshletBenchmark( const char* name, const VertexCollection& vertices, IndexCollection indices, int numIterations )
+    {
+        OptimizeVertexCache( indices, vertices.size() );
+
+        MeshletCollection meshlets;
+        BenchmarkTimer timer;
+        BuildMeshlets( vertices, indices, meshlets );
+        double buildSeconds = timer.ElapsedSeconds();
+
+        MeshletBoundsArrays bounds;
+        size_t maxVertices = 0, maxTriangles = 0, numCullable = 0;
+        for ( const Meshlet& meshlet : meshlets )
+        {
+            bounds.Add( meshlet );
+            maxVertices = std::max<size_t>( maxVertices, meshlet.VertexCount );
+            maxTriangles = std::max<size_t>( maxTriangles, meshlet.IndexCount / 3 );
+            numCullable += ( meshlet.ConeCutoff < 1.0f );
+        }
+
+        size_t numTriangles = indices.size() / 3;
+
+        printf( "%s: %zu triangles, %zu meshlets (%.1f triangles, at most %zu vertices and %zu triangles), %.0f%% with a cone, built in %.2f ms\n",
+            name, numTriangles, meshlets.size(), static_cast<double>( numTriangles ) / meshlets.size(), maxVertices, maxTriangles,
+            100.0 * numCullable / meshlets.size(), buildSeconds * 1e3 );
+        printf( "%8s %10s %10s %10s %8s %12s\n", "view", "drawn", "ideal", "reduction", "ranges", "ns/meshlet" );
+
+        Camera camera( Camera::LeftHanded );
+        camera.set_Projection( 45.0f, 16.0f / 9.0f, 0.1f, 100.0f );
+
+        const char* viewNames[] = { "outside", "close" };
+        const float viewDistances[] = { 3.0f, 0.9f };
+
+        std::vector<uint32_t> visibleMeshlets;
+        IndexRangeCollection ranges;
+        for ( int view = 0; view < 2; ++view )
+        {
+            // The close view only sees a part of the mesh so the frustum test culls
+            // as well. Average over views from several directions.
+            size_t drawnIndices = 0, idealTriangles = 0, numRanges = 0;
+            double cullSeconds = 0.0;
+            const int numDirections = 8;
+            for ( int direction = 0; direction < numDirections; ++direction )
+            {
+                float angle = direction * TwoPi / numDirections;
+                Float3 eye( std::sin( angle ) * viewDistances[view], 0.4f * viewDistances[view], std::cos( angle ) * viewDistances[view] );
+                camera.set_LookAt( eye, Float3( 0, 0, 0 ), Float3( 0, 1, 0 ) );
+                const Frustum& frustum = camera.get_Frustum();
+
+                timer.Reset();
+                for ( int i = 0; i < numIterations; ++i )
+                {
+                    CullMeshlets( bounds, frustum, eye, visibleMeshlets );
+                    DoNotOptimize( visibleMeshlets.data() );
+                }
+                cullSeconds += timer.ElapsedSeconds() / numIterations;
+
+                drawnIndices += GetIndexRanges( meshlets, visibleMeshlets, ranges );
+                numRanges += ranges.size();
+
+                idealTriangles += CountVisibleTriangles( vertices, indices, meshlets, visibleMeshlets, frustum, eye ).Visible;
+            }
+
+            double drawn = drawnIndices / 3.0 / numDirections;
+            printf( "%8s %10.0f %10.0f %9.1f%% %8.1f %12.2f\n", viewNames[view], drawn,
+                static_cast<double>( idealTriangles ) / numDirections, 100.0 * ( 1.0 - drawn / numTriangles ),
+                static_cast<double>( numRanges ) / numDirections, cullSeconds / numDirections / meshlets.size() * 1e9 );
+        }
+    }
+}
+
+BENCHMARK( Meshlets_BuildAndCull )
+{
+    const size_t tessellation = options.Quick ? 64 : 256;
+    const int numIterations = options.Quick ? 10 : 100;
+
+    printf( "Meshlets of at most %zu vertices and %zu triangles culled against the frustum and by normal cones\n",
+        MaxMeshletVertices, MaxMeshletTriangles );
+    printf( "(drawn and ideal are triangles per view; ideal is a per-triangle frustum and back-face cull)\n" );
+
+    VertexCollection vertices;
+    IndexCollection indices;
+
+    ComputeSphere( vertices, indices, 1.0f, tessellation, false );
+    RunMeshletBenchmark( "Sphere", vertices, indices, numIterations );
+
+    ComputeTorus( vertices, indices, 1.0f, 0.333f, tessellation, false );
+    RunMeshletBenchmark( "Torus", vertices, indices, numIterations );
+}
@@ -0,0 +1,70 @@
+#include <Benchmark.h>
+
+#include <MockRenderContext.h>
+#include <ParallelCommandRecorder.h>
+#include <RenderQueue.h>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+using namespace MockRenderContext;
+
+// Record the sorted draw commands of a frame into 1 to N mock deferred contexts and
+// execute the command lists. Reports the record and execute time per frame and the
+// speedup over one thread.
+BENCHMARK( ParallelRecording_SubmitFrame )
+{
+    const int numDraws = options.Quick ? 4000 : 40000;
+    const int numFrames = options.Quick ? 10 : 100;
+    const size_t maxThreads = std::max<size_t>( std::max( std::thread::hardware_concurrency(), 1u ), 8 );
+
+    FakeObjects objects;
+    RenderQueue renderQueue;
+    SubmitScene( renderQueue, objects, numDraws );
+    renderQueue.Sort();
+
+    printf( "%d sorted draws, %d frames (%u hardware threads)\n", numDraws, numFrames, std::thread::hardware_concurrency() );
+    printf( "%8s %14s %12s %12s %10s\n", "threads", "lists/frame", "record ms", "execute ms", "speedup" );
+
+    double baseSeconds = 0.0;
+    for ( size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2 )
+    {
+        std::vector<uint64_t> immediateContext;
+        std::vector<std::unique_ptr<MockCommandRecorder>> recorders;
+        std::vector<CommandRecorder*> recorderPointers;
+        for ( size_t i = 0; i < numThreads; ++i )
+        {
+            recorders.push_back( std::unique_ptr<MockCommandRecorder>( new MockCommandRecorder( immediateContext ) ) );
+            recorderPointers.push_back( recorders.back().get() );
+        }
+
+        ParallelCommandRecorder parallelRecorder( recorderPointers );
+        ParallelCommandRecorder::RecordFunction record = [&renderQueue]( RenderContext& renderContext, size_t begin, size_t end )
+        {
+            RecordQueue( renderQueue, renderContext, begin, end );
+        };
+
+        size_t numCommandLists = ParallelCommandRecorder::GetNumCommandLists( numDraws, numThreads, parallelRecorder.get_MinItemsPerCommandList() );
+        double recordSeconds = 0.0, executeSeconds = 0.0;
+        BenchmarkTimer timer;
+        for ( int frame = 0; frame < numFrames; ++frame )
+        {
+            immediateContext.clear();
+
+            timer.Reset();
+            parallelRecorder.Record( numDraws, record );
+            recordSeconds += timer.ElapsedSeconds();
+
+            timer.Reset();
+            parallelRecorder.Execute();
+            executeSeconds += timer.ElapsedSeconds();
+        }
+
+        double seconds = ( recordSeconds + executeSeconds ) / numFrames;
+        if ( numThreads == 1 ) baseSeconds = seconds;
+
+        printf( "%8zu %14zu %12.3f %12.3f %9.2fx\n", numThreads, numCommandLists, recordSeconds * 1e3 / numFrames,
+            executeSeconds * 1e3 / numFrames, baseSeconds / seconds );
+    }
+}
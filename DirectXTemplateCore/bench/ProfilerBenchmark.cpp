@@ -0,0 +1,172 @@
+#include <Benchmark.h>
+
+#include <Profiler.h>
+#include <ProfilerWorkloads.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+using namespace ProfilerWorkloads;
+
+namespace
+{
+    // The nanoseconds per zone of numZones zones with the profiler enabled or disabled.
+    double MeasureZones( int numZones, bool enabled )
+    {
+        Profiler::set_Enabled( enabled );
+
+        uint32_t value = 0;
+        BenchmarkTimer timer;
+        for ( int i = 0; i < numZones; ++i )
+        {
+            PROFILE_SCOPE( "Zone" );
+            value = Work( value, 1 );
+            DoNotOptimize( value );
+        }
+        double seconds = timer.ElapsedSeconds();
+
+        Profiler::set_Enabled( true );
+        return seconds / numZones * 1e9;
+    }
+
+    // The nanoseconds of the loop without zones.
+    double MeasureLoop( int numIterations )
+    {
+        uint32_t value = 0;
+        BenchmarkTimer timer;
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            value = Work( value, 1 );
+            DoNotOptimize( value );
+        }
+        return timer.ElapsedSeconds() / numIterations * 1e9;
+    }
+
+    long GetFileSize( const std::string& fileName )
+    {
+        FILE* file = fopen( fileName.c_str(), "rb" );
+        if ( !file )
+        {
+            return 0;
+        }
+        fseek( file, 0, SEEK_END );
+        long size = ftell( file );
+        fclose( file );
+        return size;
+    }
+}
+
+// The cost of a zone, with the profiler enabled and disabled.
+BENCHMARK( Profiler_Overhead )
+{
+    const int numZones = options.Quick ? 1000000 : 20000000;
+
+    // Discard the zones of the benchmarks that ran before.
+    ProfileCapture capture;
+    Profiler::Collect( capture );
+
+    double loop = MeasureLoop( numZones );
+    double enabled = MeasureZones( numZones, true ) - loop;
+    double disabled = MeasureZones( numZones, false ) - loop;
+
+    // Discard the zones of this benchmark.
+    Profiler::Collect( capture );
+
+    printf( "%12s %12s %12s\n", "zones", "enabled ns", "disabled ns" );
+    printf( "%12d %12.1f %12.1f\n", numZones, enabled, disabled );
+}
+
+// Four threads record nested zones while the main thread collects them. Reports the
+// zones that were collected and dropped, and the time until the threads finished.
+BENCHMARK( Profiler_Threads )
+{
+    const int numThreads = 4;
+    const int numFrames = options.Quick ? 20000 : 200000;
+
+    ProfileCapture capture;
+    Profiler::Collect( capture );
+
+    std::atomic<int> numRunning( numThreads );
+    std::vector<std::thread> threads;
+    for ( int t = 0; t < numThreads; ++t )
+    {
+        threads.push_back( std::thread( [&numRunning, numFrames, t]()
+        {
+            Profiler::SetThreadName( "Worker " + std::to_string( t ) );
+            uint32_t value = RecordNestedZones( t, numFrames );
+            DoNotOptimize( value );
+            --numRunning;
+        } ) );
+    }
+
+    // Collect while the threads are running.
+    size_t numCollected = 0;
+    uint64_t numDropped = 0;
+    int numCaptures = 0;
+    BenchmarkTimer timer;
+    for ( bool running = true; running; )
+    {
+        running = numRunning > 0;
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+        Profiler::Collect( capture );
+        ++numCaptures;
+        numCollected += capture.Zones.size();
+        numDropped += capture.NumDropped;
+    }
+    double seconds = timer.ElapsedSeconds();
+
+    for ( std::thread& thread : threads )
+    {
+        thread.join();
+    }
+
+    size_t numRecorded = static_cast<size_t>( numThreads ) * numFrames * 3;
+    printf( "%8s %12s %12s %12s %10s %10s\n", "threads", "recorded", "collected", "dropped", "captures", "ms" );
+    printf( "%8d %12zu %12zu %12llu %10d %10.1f\n", numThreads, numRecorded, numCollected,
+        static_cast<unsigned long long>( numDropped ), numCaptures, seconds * 1e3 );
+}
+
+// The size of the Chrome trace and of the binary format of a capture of frames, and
+// the time to write them and to read the binary file back.
+BENCHMARK( Profiler_Export )
+{
+    const int numFrames = options.Quick ? 1000 : 10000;
+
+    ProfileCapture capture;
+    Profiler::Collect( capture );
+
+    uint32_t value = RecordFrames( 0, numFrames );
+    DoNotOptimize( value );
+    Profiler::Collect( capture );
+
+    // The files are written to the output directory (or the current directory) and removed afterwards.
+    std::string directory = options.OutputDirectory.empty() ? "" : options.OutputDirectory + "/";
+    std::string traceFileName = directory + "Profiler_Export.json";
+    std::string binaryFileName = directory + "Profiler_Export.dxtp";
+
+    BenchmarkTimer timer;
+    capture.WriteChromeTrace( traceFileName );
+    double traceSeconds = timer.ElapsedSeconds();
+    timer.Reset();
+    capture.WriteBinary( binaryFileName );
+    double binarySeconds = timer.ElapsedSeconds();
+    timer.Reset();
+    ProfileCapture loaded;
+    loaded.ReadBinary( binaryFileName );
+    double readSeconds = timer.ElapsedSeconds();
+    DoNotOptimize( loaded.Zones.data() );
+
+    long traceSize = GetFileSize( traceFileName );
+    long binarySize = GetFileSize( binaryFileName );
+    printf( "%zu zones\n", capture.Zones.size() );
+    printf( "%10s %12s %12s %12s\n", "format", "bytes", "bytes/zone", "write ms" );
+    printf( "%10s %12ld %12.1f %12.2f\n", "chrome", traceSize, static_cast<double>( traceSize ) / capture.Zones.size(), traceSeconds * 1e3 );
+    printf( "%10s %12ld %12.1f %12.2f\n", "binary", binarySize, static_cast<double>( binarySize ) / capture.Zones.size(), binarySeconds * 1e3 );
+    printf( "Read binary %.2f ms\n", readSeconds * 1e3 );
+
+    std::remove( traceFileName.c_str() );
+    std::remove( binaryFileName.c_str() );
+}
@@ -0,0 +1,90 @@
+#include <Benchmark.h>
+
+#include <MockRenderContext.h>
+#include <RenderQueue.h>
+#include <StateCache.h>
+
+using namespace MockRenderContext;
+
+namespace
+{
+    // A render context that only counts the calls that reach the device.
+    class CountingRenderContext : public RenderContext
+    {
+    public:
+        CountingRenderContext()
+            : StateChanges( 0 )
+            , DrawCalls( 0 )
+        {}
+
+        virtual void SetInputLayout( StateHandle ) { ++StateChanges; }
+        virtual void SetPrimitiveTopology( uint32_t ) { ++StateChanges; }
+        virtual void SetVertexBuffer( uint32_t, const VertexBufferBinding& ) { ++StateChanges; }
+        virtual void SetIndexBuffer( StateHandle, uint32_t ) { ++StateChanges; }
+        virtual void SetVertexShader( StateHandle ) { ++StateChanges; }
+        virtual void SetVSConstantBuffer( uint32_t, const ConstantBufferBinding& ) { ++StateChanges; }
+        virtual void SetRasterizerState( StateHandle ) { ++StateChanges; }
+        virtual void SetPixelShader( StateHandle ) { ++StateChanges; }
+        virtual void SetPSConstantBuffer( uint32_t, const ConstantBufferBinding& ) { ++StateChanges; }
+        virtual void SetPSShaderResource( uint32_t, StateHandle ) { ++StateChanges; }
+        virtual void SetDepthStencilState( StateHandle ) { ++StateChanges; }
+        virtual void SetBlendState( StateHandle ) { ++StateChanges; }
+        virtual void DrawIndexed( uint32_t, uint32_t, int32_t ) { ++DrawCalls; }
+        virtual void DrawIndexedInstanced( uint32_t, uint32_t, uint32_t, int32_t, uint32_t ) { ++DrawCalls; }
+
+        uint64_t StateChanges;
+        uint64_t DrawCalls;
+    };
+}
+
+// Compare the number of state changes that reach a (mock) device context when the draw
+// calls are issued in submission order and when they are sorted, with and without the
+// StateCache. Every frame the queue is filled, sorted and executed.
+BENCHMARK( RenderQueue_SortAndFilter )
+{
+    const int numDraws = options.Quick ? 2000 : 20000;
+    const int numFrames = options.Quick ? 5 : 100;
+
+    FakeObjects objects;
+
+    printf( "%d draws, %d frames\n", numDraws, numFrames );
+    printf( "%-24s %12s %16s %16s\n", "mode", "ms/frame", "changes/frame", "avoided/frame" );
+
+    for ( int mode = 0; mode < 4; ++mode )
+    {
+        bool useSortKeys = ( mode & 1 ) != 0;
+        bool useStateCache = ( mode & 2 ) != 0;
+
+        RenderQueue renderQueue;
+        CountingRenderContext renderContext;
+        StateCache stateCache( renderContext );
+        uint64_t numAvoided = 0;
+
+        BenchmarkTimer timer;
+        for ( int frame = 0; frame < numFrames; ++frame )
+        {
+            renderQueue.Clear();
+            SubmitScene( renderQueue, objects, numDraws, useSortKeys );
+
+            if ( useStateCache )
+            {
+                // Other rendering code may have changed the state between frames.
+                stateCache.Invalidate();
+                stateCache.ResetStatistics();
+                renderQueue.Execute( stateCache );
+                numAvoided += stateCache.get_Statistics().StateChangesAvoided;
+            }
+            else
+            {
+                renderQueue.Execute( renderContext );
+            }
+        }
+        double seconds = timer.ElapsedSeconds();
+
+        const char* modeNames[] = { "submission order", "sorted", "submission + cache", "sorted + cache" };
+        printf( "%-24s %12.3f %16.1f %16.1f\n", modeNames[mode],
+            seconds * 1000.0 / numFrames,
+            static_cast<double>( renderContext.StateChanges ) / numFrames,
+            static_cast<double>( numAvoided ) / numFrames );
+    }
+}
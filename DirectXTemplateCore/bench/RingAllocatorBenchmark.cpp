@@ -0,0 +1,84 @@
+#include <Benchmark.h>
+
+#include <RingAllocator.h>
+#include <SoftwareRasterizer.h>
+
+#include <cstring>
+
+namespace
+{
+    // Allocate from the ring. If the ring is full, wait for the oldest frame
+    // (the GPU is simulated, so the frame completes immediately).
+    size_t AllocateOrWait( RingAllocator& allocator, size_t size, uint64_t& numStalls )
+    {
+        size_t offset = allocator.Allocate( size );
+        while ( offset == RingAllocator::InvalidOffset && allocator.get_NumFramesInFlight() > 0 )
+        {
+            ++numStalls;
+            allocator.ReleaseCompletedFrames( allocator.get_OldestFenceValue() );
+            offset = allocator.Allocate( size );
+        }
+        return offset;
+    }
+}
+
+// Simulates the constant buffer traffic of the DynamicConstantBuffer:
+// every draw call allocates a per-object and a material slice, the frame
+// is fenced at the end, and the GPU lags a fixed number of frames behind.
+BENCHMARK( RingAllocator_DynamicConstantBuffer )
+{
+    const size_t capacity = 16 * 1024 * 1024;
+    const int numDrawsPerFrame = options.Quick ? 1000 : 10000;
+    const int numFrames = options.Quick ? 10 : 200;
+    const int framesInFlight = 3;
+
+    RingAllocator allocator( capacity );
+    std::vector<uint8_t> buffer( capacity );
+
+    PerObjectConstants perObject;
+    memset( &perObject, 0, sizeof(perObject) );
+    MaterialProperties material;
+    memset( &material, 0, sizeof(material) );
+
+    uint64_t numAllocations = 0;
+    uint64_t numStalls = 0;
+
+    BenchmarkTimer timer;
+    for ( int frame = 1; frame <= numFrames; ++frame )
+    {
+        // The GPU has finished the frames that are more than framesInFlight behind.
+        if ( frame > framesInFlight )
+        {
+            allocator.ReleaseCompletedFrames( frame - framesInFlight );
+        }
+
+        for ( int draw = 0; draw < numDrawsPerFrame; ++draw )
+        {
+            size_t perObjectOffset = AllocateOrWait( allocator, sizeof(perObject), numStalls );
+            size_t materialOffset = AllocateOrWait( allocator, sizeof(material), numStalls );
+            if ( perObjectOffset == RingAllocator::InvalidOffset || materialOffset == RingAllocator::InvalidOffset )
+            {
+                printf( "The constants of a single frame do not fit in the ring.\n" );
+                return;
+            }
+
+            memcpy( &buffer[perObjectOffset], &perObject, sizeof(perObject) );
+            memcpy( &buffer[materialOffset], &material, sizeof(material) );
+
+            numAllocations += 2;
+        }
+
+        allocator.FinishFrame( frame );
+    }
+    double seconds = timer.ElapsedSeconds();
+
+    DoNotOptimize( buffer[0] );
+
+    printf( "%d draws/frame, %d frames, %llu KB ring\n", numDrawsPerFrame, numFrames, static_cast<unsigned long long>( capacity / 1024 ) );
+    printf( "%16s %16s %12s %12s\n", "Mallocations/s", "ns/allocation", "wraps", "stalls" );
+    printf( "%16.3f %16.3f %12llu %12llu\n",
+        numAllocations / seconds * 1e-6,
+        seconds * 1e9 / numAllocations,
+        static_cast<unsigned long long>( allocator.get_WrapCount() ),
+        static_cast<unsigned long long>( numStalls ) );
+}
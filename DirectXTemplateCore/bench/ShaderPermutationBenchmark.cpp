@@ -0,0 +1,188 @@
+#include <Benchmark.h>
+
+#include <ShaderPermutations.h>
+#include <ShaderPermutationsFakes.h>
+
+#include <cstdio>
+#include <map>
+#include <set>
+
+using namespace ShaderPermutationsFakes;
+
+namespace
+{
+    // Load every variant through a new cache, and print what was loaded and compiled and the time it took.
+    void PrintLoadVariants( const char* name, SimulatedShaderCompiler& compiler, const std::string& directory, const ShaderSource& source,
+        const ShaderPermutations& permutations, std::vector<std::vector<uint8_t>>& bytecode )
+    {
+        BenchmarkTimer timer;
+        CacheRun run = LoadVariants( compiler, directory, source, permutations, bytecode );
+        double seconds = timer.ElapsedSeconds();
+        printf( "%-26s %8u %8u %8u %10.3f\n", name, run.Statistics.Loaded, run.Statistics.Compiled, run.Statistics.Failed,
+            seconds * 1e3 );
+    }
+}
+
+// The time to enumerate the defines of the variants of a shader, and the number of
+// distinct content hashes of the variants. The lookup of the variant of
+// TexturedLitPixelShader for a material and the light counts is compared with a
+// lookup by the names and values of the defines.
+BENCHMARK( Shader_Permutations )
+{
+    const int numLookups = options.Quick ? 100000 : 10000000;
+
+    printf( "%10s %10s %12s %10s\n", "keywords", "variants", "defines us", "hashes" );
+    for ( uint32_t numKeywords = 1; numKeywords <= 12; numKeywords += 3 )
+    {
+        // Alternate between boolean keywords and counts.
+        std::vector<ShaderKeyword> keywords;
+        for ( uint32_t i = 0; i < numKeywords; ++i )
+        {
+            ShaderKeyword keyword = { "KEYWORD_" + std::to_string( i ), ( i % 2 == 0 ) ? 2u : 3u };
+            keywords.push_back( keyword );
+        }
+        ShaderPermutations permutations( keywords );
+
+        ShaderSource source = { "Test.hlsl", TexturedLitCode, "main", "ps_5_0" };
+        std::vector<ShaderDefine> defines;
+        std::set<uint64_t> hashes;
+
+        BenchmarkTimer timer;
+        for ( uint32_t variant = 0; variant < permutations.get_NumVariants(); ++variant )
+        {
+            permutations.GetDefines( variant, defines );
+            DoNotOptimize( defines.data() );
+        }
+        double definesSeconds = timer.ElapsedSeconds() / permutations.get_NumVariants();
+
+        for ( uint32_t variant = 0; variant < permutations.get_NumVariants(); ++variant )
+        {
+            permutations.GetDefines( variant, defines );
+            hashes.insert( ComputeShaderHash( source, defines, "Simulated" ) );
+        }
+
+        printf( "%10u %10u %12.3f %10zu\n", numKeywords, permutations.get_NumVariants(), definesSeconds * 1e6, hashes.size() );
+    }
+
+    // The variants of TexturedLitPixelShader for the materials and the light configurations.
+    ShaderPermutations permutations( GetTexturedLitKeywords() );
+    printf( "TexturedLitPixelShader: %u variants\n", permutations.get_NumVariants() );
+
+    _Material texturedMaterial;
+    texturedMaterial.UseTexture = true;
+    _Material plainMaterial;
+
+    uint32_t spotAndPointLights[LightTypeCount] = { 0, 2, 6 };
+    uint32_t spotLights[LightTypeCount] = { 0, 0, 6 };
+    uint32_t noLights[LightTypeCount] = { 0, 0, 0 };
+    uint32_t allLights[LightTypeCount] = { 1, 4096, 6 };
+
+    // A lookup by the defines: the key is built from the names and the values.
+    std::vector<ShaderDefine> defines;
+    std::map<std::string, uint32_t> variantsByName;
+    for ( uint32_t variant = 0; variant < permutations.get_NumVariants(); ++variant )
+    {
+        permutations.GetDefines( variant, defines );
+        std::string key;
+        for ( const ShaderDefine& define : defines )
+        {
+            key += define.Name + "=" + define.Value + ";";
+        }
+        variantsByName[key] = variant;
+    }
+
+    const _Material* materials[2] = { &plainMaterial, &texturedMaterial };
+    uint32_t* lightCounts[4] = { spotAndPointLights, spotLights, noLights, allLights };
+
+    BenchmarkTimer timer;
+    uint32_t checksum = 0;
+    for ( int i = 0; i < numLookups; ++i )
+    {
+        checksum += GetTexturedLitVariant( permutations, *materials[i & 1], lightCounts[( i >> 1 ) & 3] );
+    }
+    double indexSeconds = timer.ElapsedSeconds() / numLookups;
+    DoNotOptimize( &checksum );
+
+    const int numNameLookups = numLookups / 10;
+    std::vector<std::string> names;
+    names.push_back( "USE_TEXTURE" );
+    names.push_back( "DIRECTIONAL_LIGHTS" );
+    names.push_back( "POINT_LIGHTS" );
+    names.push_back( "SPOT_LIGHTS" );
+    timer.Reset();
+    for ( int i = 0; i < numNameLookups; ++i )
+    {
+        const uint32_t* counts = lightCounts[( i >> 1 ) & 3];
+        std::string key;
+        key += names[0] + "=" + ( materials[i & 1]->UseTexture ? "1" : "0" ) + ";";
+        for ( int type = 0; type < LightTypeCount; ++type )
+        {
+            key += names[1 + type] + "=" + ( counts[type] > 0 ? "1" : "0" ) + ";";
+        }
+        checksum += variantsByName[key];
+    }
+    double nameSeconds = timer.ElapsedSeconds() / numNameLookups;
+    DoNotOptimize( &checksum );
+
+    printf( "Variant lookup: %.2f ns by index, %.2f ns by the names of the defines\n", indexSeconds * 1e9, nameSeconds * 1e9 );
+}
+
+// Loads the 16 variants of TexturedLitPixelShader through the shader cache with a
+// simulated compiler, and reports the variants that were loaded, compiled and failed
+// and the time it took: for a cold and a warm cache, after a change of the source, of
+// the compiler or of a cache file, and with a compiler that fails half of the variants.
+BENCHMARK( Shader_Cache )
+{
+    ShaderPermutations permutations( GetTexturedLitKeywords() );
+    ShaderSource source = { "..\\data\\Shaders\\TexturedLitPixelShader.hlsl", TexturedLitCode, "TexturedLitPixelShader", "ps_5_0" };
+    ShaderSource changedSource = source;
+    changedSource.Code += "\n// A changed comment.";
+
+    // The cache files are written to the output directory (or the current directory) and removed afterwards.
+    const std::string& directory = options.OutputDirectory;
+    RemoveCacheFiles( directory, source, permutations, "Simulated 1" );
+
+    printf( "%-26s %8s %8s %8s %10s\n", "", "loaded", "compiled", "failed", "ms" );
+
+    SimulatedShaderCompiler compiler( "Simulated 1" );
+    std::vector<std::vector<uint8_t>> bytecode;
+    PrintLoadVariants( "cold cache", compiler, directory, source, permutations, bytecode );
+    PrintLoadVariants( "warm cache", compiler, directory, source, permutations, bytecode );
+
+    // The changed source has other hashes, so the old files are not loaded.
+    PrintLoadVariants( "changed source", compiler, directory, changedSource, permutations, bytecode );
+    RemoveCacheFiles( directory, changedSource, permutations, "Simulated 1" );
+
+    // Another compiler (or other flags) does not load the files of the first one.
+    SimulatedShaderCompiler otherCompiler( "Simulated 2" );
+    PrintLoadVariants( "other compiler", otherCompiler, directory, source, permutations, bytecode );
+    RemoveCacheFiles( directory, source, permutations, "Simulated 2" );
+
+    // A damaged file is a cache miss, and only its variant is compiled again.
+    {
+        ShaderCache cache( compiler, directory );
+        std::vector<ShaderDefine> defines;
+        permutations.GetDefines( 5, defines );
+        std::string fileName = cache.get_FileName( source, ComputeShaderHash( source, defines, compiler.get_Identifier() ) );
+        FILE* file = fopen( fileName.c_str(), "r+b" );
+        if ( file )
+        {
+            uint8_t byte = 0xFF;
+            fseek( file, sizeof( ShaderCacheFileHeader ) + 100, SEEK_SET );
+            fread( &byte, 1, 1, file );
+            byte = static_cast<uint8_t>( ~byte );
+            fseek( file, sizeof( ShaderCacheFileHeader ) + 100, SEEK_SET );
+            fwrite( &byte, 1, 1, file );
+            fclose( file );
+        }
+    }
+    PrintLoadVariants( "damaged file", compiler, directory, source, permutations, bytecode );
+    RemoveCacheFiles( directory, source, permutations, "Simulated 1" );
+
+    // The variants with spot lights do not compile: they are reported and not stored.
+    SimulatedShaderCompiler failingCompiler( "Simulated 3" );
+    failingCompiler.set_FailDefine( "SPOT_LIGHTS" );
+    PrintLoadVariants( "compile errors", failingCompiler, directory, source, permutations, bytecode );
+    PrintLoadVariants( "compile errors (retried)", failingCompiler, directory, source, permutations, bytecode );
+    RemoveCacheFiles( directory, source, permutations, "Simulated 3" );
+}
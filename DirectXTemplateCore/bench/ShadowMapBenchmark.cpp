@@ -0,0 +1,187 @@
+#include <Benchmark.h>
+
+#include <Camera.h>
+#include <LightClusters.h>
+#include <ShadowMaps.h>
+#include <VenueScene.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Math;
+using namespace VenueScene;
+
+// The time to pack the shadow maps of up to 4096 spot lights into a 4096 x 4096
+// atlas (from 128 to 2048 texels per tile) with the importance seen by a camera that
+// moves through the venue, the visible and packed shadow maps per frame and the
+// fraction of the atlas that is filled.
+BENCHMARK( Shadow_AtlasPack )
+{
+    const int numFrames = options.Quick ? 10 : 100;
+    const size_t maxLights = options.Quick ? 1024 : 4096;
+
+    ShadowAtlas atlas( 4096, 128, 2048 );
+    Camera camera = CreateCamera();
+
+    printf( "%6s %12s %8s %8s %8s\n", "lights", "repack us", "visible", "packed", "fill %" );
+    for ( size_t numLights = 16; numLights <= maxLights; numLights *= 4 )
+    {
+        std::vector<Light> lights = GenerateSpotLights( numLights, 1234 );
+        std::vector<float> importance( numLights );
+        std::vector<ShadowAtlasTile> tiles;
+
+        double seconds = 0.0;
+        size_t visible = 0;
+        size_t packed = 0;
+        uint64_t area = 0;
+        for ( int frame = 0; frame < numFrames; ++frame )
+        {
+            WalkThroughVenue( camera, -100.0f + 200.0f * frame / numFrames );
+
+            for ( size_t i = 0; i < numLights; ++i )
+            {
+                importance[i] = ShadowImportance( lights[i], camera );
+                visible += ( importance[i] > 0.0f ) ? 1 : 0;
+            }
+
+            BenchmarkTimer timer;
+            size_t count = atlas.Pack( importance, tiles );
+            seconds += timer.ElapsedSeconds();
+            DoNotOptimize( tiles.data() );
+
+            packed += count;
+            for ( const ShadowAtlasTile& tile : tiles )
+            {
+                area += static_cast<uint64_t>( tile.Size ) * tile.Size;
+            }
+        }
+
+        double fill = 100.0 * area / ( static_cast<double>( atlas.get_Size() ) * atlas.get_Size() * numFrames );
+        printf( "%6zu %12.2f %8.1f %8.1f %8.1f\n", numLights, seconds / numFrames * 1e6,
+            static_cast<double>( visible ) / numFrames, static_cast<double>( packed ) / numFrames, fill );
+    }
+}
+
+// The time to fit four cascades of a directional light to a camera that moves and
+// turns, and the largest change of the sub-texel position of a static point in the
+// last cascade (the cascades move in whole texels, so it does not shimmer).
+BENCHMARK( Shadow_Cascades )
+{
+    const int numFrames = options.Quick ? 1000 : 10000;
+    const uint32_t numCascades = 4;
+    const uint32_t resolution = 2048;
+
+    Camera camera = CreateCamera();
+    Float3 lightDirection = Normalize( Float3( 0.3f, -1.0f, 0.5f ) );
+    Float3 staticPoint( 3.0f, 1.0f, -80.0f );
+
+    float splits[numCascades + 1];
+    ComputeCascadeSplits( camera.get_NearClipPlane(), camera.get_FarClipPlane(), numCascades, 0.8f, splits );
+    printf( "splits:" );
+    for ( uint32_t i = 0; i <= numCascades; ++i )
+    {
+        printf( " %.2f", splits[i] );
+    }
+    printf( "\n" );
+
+    double seconds = 0.0;
+    Float3 firstTexel( 0.0f, 0.0f, 0.0f );
+    float largestTexelDrift = 0.0f;
+    for ( int frame = 0; frame < numFrames; ++frame )
+    {
+        MoveAndTurn( camera, static_cast<float>( frame ) / numFrames );
+
+        ShadowView views[numCascades];
+        BenchmarkTimer timer;
+        for ( uint32_t i = 0; i < numCascades; ++i )
+        {
+            views[i] = ComputeCascadeView( camera, lightDirection, splits[i], splits[i + 1], resolution, 50.0f );
+        }
+        seconds += timer.ElapsedSeconds();
+        DoNotOptimize( views );
+
+        // The sub-texel position of the static point in the last cascade.
+        Float3 texel = ShadowTexel( views[numCascades - 1], staticPoint, resolution );
+        if ( frame == 0 )
+        {
+            firstTexel = texel;
+        }
+        float driftX = std::abs( ( texel.x - firstTexel.x ) - std::round( texel.x - firstTexel.x ) );
+        float driftY = std::abs( ( texel.y - firstTexel.y ) - std::round( texel.y - firstTexel.y ) );
+        largestTexelDrift = std::max( largestTexelDrift, std::max( driftX, driftY ) );
+    }
+
+    printf( "%d frames, %.3f us per frame for %u cascades, largest sub-texel drift %.4f texels\n", numFrames,
+        seconds / numFrames * 1e6, numCascades, largestTexelDrift );
+}
+
+// The static shadow maps of 256 spot lights of which 16 move. The camera moves
+// through the venue in the first half of the frames, so the importance of the
+// lights and their tiles change, and stands still in the second half. Reports the
+// time of the cache and the cached and rendered shadow maps in both halves.
+BENCHMARK( Shadow_Cache )
+{
+    const int numFrames = options.Quick ? 50 : 500;
+    const size_t numLights = 256;
+    const size_t numMovingLights = 16;
+
+    ShadowAtlas atlas( 8192, 256, 2048 );
+    ShadowCache cache;
+    Camera camera = CreateCamera();
+    std::vector<Light> lights = GenerateSpotLights( numLights, 5678 );
+
+    std::vector<float> importance( numLights );
+    std::vector<ShadowAtlasTile> tiles;
+    std::vector<ShadowView> views( numLights );
+
+    // The hits and misses while the camera moves and while it stands still.
+    uint64_t hits[2] = {};
+    uint64_t misses[2] = {};
+    double seconds = 0.0;
+    BoundingSphere movingObject( Float3( 0.0f, 2.0f, 0.0f ), 3.0f );
+    for ( int frame = 0; frame < numFrames; ++frame )
+    {
+        int phase = ( frame < numFrames / 2 ) ? 0 : 1;
+        WalkThroughVenue( camera, -100.0f + 100.0f * std::min( frame, numFrames / 2 ) / numFrames );
+
+        for ( size_t i = 0; i < numMovingLights; ++i )
+        {
+            lights[i].Position.x += 0.1f;
+        }
+
+        for ( size_t i = 0; i < numLights; ++i )
+        {
+            importance[i] = ShadowImportance( lights[i], camera );
+            views[i] = ComputeSpotShadowView( lights[i], 0.1f, 100.0f );
+        }
+
+        BenchmarkTimer timer;
+        atlas.Pack( importance, tiles );
+        cache.BeginFrame();
+
+        // A static object moves every tenth frame (for example a door that opens).
+        bool objectMoved = ( frame % 10 == 5 );
+        if ( objectMoved )
+        {
+            cache.Invalidate( movingObject );
+        }
+
+        for ( size_t i = 0; i < numLights; ++i )
+        {
+            if ( tiles[i].Size != 0 )
+            {
+                cache.Update( i, tiles[i], views[i] );
+            }
+        }
+        seconds += timer.ElapsedSeconds();
+        hits[phase] += cache.get_Statistics().Hits;
+        misses[phase] += cache.get_Statistics().Misses;
+    }
+
+    int phaseFrames = numFrames / 2;
+    printf( "%zu lights (%zu moving), %d frames, %.2f us per frame\n", numLights, numMovingLights, numFrames, seconds / numFrames * 1e6 );
+    printf( "moving camera: %.1f cached and %.1f rendered shadow maps per frame\n",
+        static_cast<double>( hits[0] ) / phaseFrames, static_cast<double>( misses[0] ) / phaseFrames );
+    printf( "static camera: %.1f cached and %.1f rendered shadow maps per frame\n",
+        static_cast<double>( hits[1] ) / phaseFrames, static_cast<double>( misses[1] ) / phaseFrames );
+}
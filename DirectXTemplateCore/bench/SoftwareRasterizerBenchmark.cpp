@@ -0,0 +1,296 @@
+#include <Benchmark.h>
+
+#include <Camera.h>
+#include <Geometry.h>
+#include <Image.h>
+#include <Simd.h>
+#include <SoftwareRasterizer.h>
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+using namespace Math;
+
+namespace
+{
+    // Generate a checkerboard texture (stand-in for the textures loaded by the demo).
+    SoftwareTexture CreateCheckerTexture( uint32_t size, uint32_t checks, const uint8_t color0[4], const uint8_t color1[4] )
+    {
+        std::vector<uint8_t> texels( size * size * 4 );
+        uint32_t checkSize = size / checks;
+        for ( uint32_t y = 0; y < size; ++y )
+        {
+            for ( uint32_t x = 0; x < size; ++x )
+            {
+                const uint8_t* color = ( ( x / checkSize + y / checkSize ) % 2 ) ? color1 : color0;
+                memcpy( &texels[( y * size + x ) * 4], color, 4 );
+            }
+        }
+        return SoftwareTexture( size, size, texels.data() );
+    }
+
+    PerInstanceData MakeInstance( const Float4x4& worldMatrix )
+    {
+        PerInstanceData instance;
+        instance.WorldMatrix = worldMatrix;
+        instance.InverseTransposeWorldMatrix = MatrixTranspose( MatrixInverse( worldMatrix ) );
+        return instance;
+    }
+
+    PerObjectConstants MakePerObject( const Float4x4& worldMatrix, const Float4x4& viewProjectionMatrix )
+    {
+        PerObjectConstants perObject;
+        perObject.WorldMatrix = worldMatrix;
+        perObject.InverseTransposeWorldMatrix = MatrixTranspose( MatrixInverse( worldMatrix ) );
+        perObject.WorldViewProjectionMatrix = worldMatrix * viewProjectionMatrix;
+        return perObject;
+    }
+
+    // Same as the LookAtMatrix function in the TextureAndLighting demo.
+    Float4x4 LookAtMatrix( const Float3& position, const Float3& direction, const Float3& up )
+    {
+        Float3 r2 = Normalize( direction );
+        Float3 r0 = Normalize( Cross( up, r2 ) );
+        Float3 r1 = Cross( r2, r0 );
+
+        return Float4x4( r0.x, r0.y, r0.z, 0.0f,
+                         r1.x, r1.y, r1.z, 0.0f,
+                         r2.x, r2.y, r2.z, 0.0f,
+                         position.x, position.y, position.z, 1.0f );
+    }
+
+    /**
+     * The scene rendered by the TextureAndLighting demo (at time 0 and with the
+     * initial camera) submitted to the software rasterizer.
+     */
+    class TextureAndLightingScene
+    {
+    public:
+        TextureAndLightingScene( uint32_t width, uint32_t height )
+            : m_Camera( Camera::LeftHanded )
+            , m_WallTexture( CreateCheckerTexture( 256, 8, WallColor0, WallColor1 ) )
+            , m_SphereTexture( CreateCheckerTexture( 256, 16, SphereColor0, SphereColor1 ) )
+        {
+            m_Camera.set_LookAt( Float3( 0, 5, -20 ), Float3( 0, 5, 0 ), Float3( 0, 1, 0 ) );
+            m_Camera.set_Projection( 45.0f, width / static_cast<float>( height ), 0.1f, 100.0f );
+
+            // Unit plane.
+            m_PlaneVertices.push_back( VertexPositionNormalTexture( Float3( -0.5f, 0.0f,  0.5f ), Float3( 0.0f, 1.0f, 0.0f ), Float2( 0.0f, 0.0f ) ) );
+            m_PlaneVertices.push_back( VertexPositionNormalTexture( Float3(  0.5f, 0.0f,  0.5f ), Float3( 0.0f, 1.0f, 0.0f ), Float2( 1.0f, 0.0f ) ) );
+            m_PlaneVertices.push_back( VertexPositionNormalTexture( Float3(  0.5f, 0.0f, -0.5f ), Float3( 0.0f, 1.0f, 0.0f ), Float2( 1.0f, 1.0f ) ) );
+            m_PlaneVertices.push_back( VertexPositionNormalTexture( Float3( -0.5f, 0.0f, -0.5f ), Float3( 0.0f, 1.0f, 0.0f ), Float2( 0.0f, 1.0f ) ) );
+            const uint16_t planeIndices[6] = { 0, 1, 3, 1, 2, 3 };
+            m_PlaneIndices.assign( planeIndices, planeIndices + 6 );
+
+            // The six walls of the room.
+            float scalePlane = 20.0f;
+            float translateOffset = scalePlane / 2.0f;
+            Float4x4 scaleMatrix = MatrixScaling( scalePlane, 1.0f, scalePlane );
+            m_PlaneInstances.push_back( MakeInstance( scaleMatrix ) );
+            m_PlaneInstances.push_back( MakeInstance( scaleMatrix * MatrixRotationX( ConvertToRadians( -90 ) ) * MatrixTranslation( 0, translateOffset, translateOffset ) ) );
+            m_PlaneInstances.push_back( MakeInstance( scaleMatrix * MatrixRotationX( ConvertToRadians( 180 ) ) * MatrixTranslation( 0, translateOffset * 2.0f, 0 ) ) );
+            m_PlaneInstances.push_back( MakeInstance( scaleMatrix * MatrixRotationX( ConvertToRadians( 90 ) ) * MatrixTranslation( 0, translateOffset, -translateOffset ) ) );
+            m_PlaneInstances.push_back( MakeInstance( scaleMatrix * MatrixRotationZ( ConvertToRadians( -90 ) ) * MatrixTranslation( -translateOffset, translateOffset, 0 ) ) );
+            m_PlaneInstances.push_back( MakeInstance( scaleMatrix * MatrixRotationZ( ConvertToRadians( 90 ) ) * MatrixTranslation( translateOffset, translateOffset, 0 ) ) );
+
+            ComputeSphere( m_SphereVertices, m_SphereIndices, 1.0f, 16, false );
+            ComputeCube( m_CubeVertices, m_CubeIndices, 1.0f, false );
+            ComputeCone( m_ConeVertices, m_ConeIndices, 1.0f, 1.0f, 32, false );
+            ComputeTorus( m_TorusVertices, m_TorusIndices, 1.0f, 0.33f, 32, false );
+
+            // Materials.
+            m_DefaultMaterial = MaterialProperties();
+
+            m_GreenMaterial.Material.Ambient = Float4( 0.07568f, 0.61424f, 0.07568f, 1.0f );
+            m_GreenMaterial.Material.Diffuse = Float4( 0.07568f, 0.61424f, 0.07568f, 1.0f );
+            m_GreenMaterial.Material.Specular = Float4( 0.07568f, 0.61424f, 0.07568f, 1.0f );
+            m_GreenMaterial.Material.SpecularPower = 76.8f;
+
+            m_RedPlasticMaterial.Material.Diffuse = Float4( 0.6f, 0.1f, 0.1f, 1.0f );
+            m_RedPlasticMaterial.Material.Specular = Float4( 1.0f, 0.2f, 0.2f, 1.0f );
+            m_RedPlasticMaterial.Material.SpecularPower = 32.0f;
+
+            m_PearlMaterial.Material.Ambient = Float4( 0.25f, 0.20725f, 0.20725f, 1.0f );
+            m_PearlMaterial.Material.Diffuse = Float4( 1.0f, 0.829f, 0.829f, 1.0f );
+            m_PearlMaterial.Material.Specular = Float4( 0.296648f, 0.296648f, 0.296648f, 1.0f );
+            m_PearlMaterial.Material.SpecularPower = 11.264f;
+
+            // Lights.
+            static const Float4 LightColors[MAX_LIGHTS] = {
+                Float4( 1.0f, 1.0f, 1.0f, 1.0f ),           // White
+                Float4( 1.0f, 0.647f, 0.0f, 1.0f ),         // Orange
+                Float4( 1.0f, 1.0f, 0.0f, 1.0f ),           // Yellow
+                Float4( 0.0f, 0.502f, 0.0f, 1.0f ),         // Green
+                Float4( 0.0f, 0.0f, 1.0f, 1.0f ),           // Blue
+                Float4( 0.294f, 0.0f, 0.51f, 1.0f ),        // Indigo
+                Float4( 0.933f, 0.51f, 0.933f, 1.0f ),      // Violet
+                Float4( 1.0f, 1.0f, 1.0f, 1.0f ),           // White
+            };
+
+            static const LightType LightTypes[MAX_LIGHTS] = {
+                SpotLight, SpotLight, SpotLight, PointLight, SpotLight, SpotLight, SpotLight, PointLight
+            };
+
+            m_LightProperties.GlobalAmbient = Float4( 0.2f, 0.2f, 0.2f, 1.0f );
+            m_LightProperties.EyePosition = Float4( m_Camera.get_Translation(), 1.0f );
+
+            float radius = 8.0f;
+            float offset = TwoPi / MAX_LIGHTS;
+            for ( int i = 0; i < MAX_LIGHTS; ++i )
+            {
+                Light& light = m_LightProperties.Lights[i];
+                light.Enabled = 1;
+                light.LightType = LightTypes[i];
+                light.Color = LightColors[i];
+                light.SpotAngle = ConvertToRadians( 45.0f );
+                light.ConstantAttenuation = 1.0f;
+                light.LinearAttenuation = 0.08f;
+                light.QuadraticAttenuation = 0.0f;
+                light.Position = Float4( std::sin( offset * i ) * radius, 9.0f, std::cos( offset * i ) * radius, 1.0f );
+                light.Direction = Float4( Normalize( -XYZ( light.Position ) ), 0.0f );
+            }
+        }
+
+        void Render( SoftwareRasterizer& rasterizer )
+        {
+            // Cornflower blue.
+            rasterizer.Clear( Float4( 0.392f, 0.584f, 0.929f, 1.0f ), 1.0f );
+
+            Float4x4 viewProjectionMatrix = m_Camera.get_ViewMatrix() * m_Camera.get_ProjectionMatrix();
+
+            rasterizer.set_LightProperties( m_LightProperties );
+
+            // Walls.
+            MaterialProperties wallMaterial = m_GreenMaterial;
+            wallMaterial.Material.UseTexture = true;
+            rasterizer.set_MaterialProperties( wallMaterial );
+            rasterizer.set_Texture( &m_WallTexture );
+            rasterizer.DrawIndexedInstanced( m_PlaneVertices, m_PlaneIndices, m_PlaneInstances.data(), m_PlaneInstances.size(), viewProjectionMatrix );
+
+            // Sphere.
+            MaterialProperties sphereMaterial = m_DefaultMaterial;
+            sphereMaterial.Material.UseTexture = true;
+            rasterizer.set_MaterialProperties( sphereMaterial );
+            rasterizer.set_Texture( &m_SphereTexture );
+            Float4x4 worldMatrix = MatrixScaling( 4.0f, 4.0f, 4.0f ) * MatrixTranslation( -4.0f, 2.0f, -4.0f );
+            rasterizer.DrawIndexed( m_SphereVertices, m_SphereIndices, MakePerObject( worldMatrix, viewProjectionMatrix ) );
+
+            // Cube.
+            rasterizer.set_MaterialProperties( m_RedPlasticMaterial );
+            worldMatrix = MatrixScaling( 4.0f, 8.0f, 4.0f ) * MatrixRotationY( ConvertToRadians( 45.0f ) ) * MatrixTranslation( 4.0f, 4.0f, 4.0f );
+            rasterizer.DrawIndexed( m_CubeVertices, m_CubeIndices, MakePerObject( worldMatrix, viewProjectionMatrix ) );
+
+            // Torus.
+            rasterizer.set_MaterialProperties( m_PearlMaterial );
+            worldMatrix = MatrixScaling( 4.0f, 4.0f, 4.0f ) * MatrixRotationY( ConvertToRadians( 45.0f ) ) * MatrixTranslation( 4.0f, 0.5f, -4.0f );
+            rasterizer.DrawIndexed( m_TorusVertices, m_TorusIndices, MakePerObject( worldMatrix, viewProjectionMatrix ) );
+
+            // Light markers.
+            MaterialProperties lightMaterial = m_DefaultMaterial;
+            for ( int i = 0; i < MAX_LIGHTS; ++i )
+            {
+                const Light& light = m_LightProperties.Lights[i];
+                if ( !light.Enabled ) continue;
+
+                // The demo rotates the markers by -90 radians (not degrees).
+                worldMatrix = MatrixRotationX( -90.0f ) * LookAtMatrix( XYZ( light.Position ), XYZ( light.Direction ), Float3( 0, 1, 0 ) );
+                lightMaterial.Material.Emissive = light.Color;
+                rasterizer.set_MaterialProperties( lightMaterial );
+
+                if ( light.LightType == PointLight )
+                {
+                    rasterizer.DrawIndexed( m_SphereVertices, m_SphereIndices, MakePerObject( worldMatrix, viewProjectionMatrix ) );
+                }
+                else
+                {
+                    rasterizer.DrawIndexed( m_ConeVertices, m_ConeIndices, MakePerObject( worldMatrix, viewProjectionMatrix ) );
+                }
+            }
+
+            rasterizer.Flush();
+        }
+
+    private:
+        static const uint8_t WallColor0[4];
+        static const uint8_t WallColor1[4];
+        static const uint8_t SphereColor0[4];
+        static const uint8_t SphereColor1[4];
+
+        Camera m_Camera;
+
+        SoftwareTexture m_WallTexture;
+        SoftwareTexture m_SphereTexture;
+
+        VertexCollection m_PlaneVertices;
+        IndexCollection m_PlaneIndices;
+        std::vector<PerInstanceData> m_PlaneInstances;
+
+        VertexCollection m_SphereVertices, m_CubeVertices, m_ConeVertices, m_TorusVertices;
+        IndexCollection m_SphereIndices, m_CubeIndices, m_ConeIndices, m_TorusIndices;
+
+        MaterialProperties m_DefaultMaterial, m_GreenMaterial, m_RedPlasticMaterial, m_PearlMaterial;
+        LightProperties m_LightProperties;
+    };
+
+    const uint8_t TextureAndLightingScene::WallColor0[4] = { 255, 255, 255, 255 };
+    const uint8_t TextureAndLightingScene::WallColor1[4] = { 96, 96, 96, 255 };
+    const uint8_t TextureAndLightingScene::SphereColor0[4] = { 32, 64, 192, 255 };
+    const uint8_t TextureAndLightingScene::SphereColor1[4] = { 64, 160, 64, 255 };
+}
+
+BENCHMARK( SoftwareRasterizer_TextureAndLighting )
+{
+    const uint32_t width = 1280;
+    const uint32_t height = 720;
+    const int numFrames = options.Quick ? 2 : 30;
+
+    TextureAndLightingScene scene( width, height );
+
+    uint32_t maxThreads = std::max( std::thread::hardware_concurrency(), 1u );
+
+    std::vector<uint32_t> threadCounts;
+    for ( uint32_t n = 1; n < maxThreads; n *= 2 )
+    {
+        threadCounts.push_back( n );
+    }
+    threadCounts.push_back( maxThreads );
+
+    printf( "%ux%u, %d frames, SIMD width %d\n", width, height, numFrames, Simd::Width );
+    printf( "%8s %12s %16s %16s\n", "threads", "ms/frame", "Mtriangles/s", "Mpixels/s" );
+
+    for ( uint32_t numThreads : threadCounts )
+    {
+        SoftwareRasterizer rasterizer( width, height, numThreads );
+
+        // Warm up.
+        scene.Render( rasterizer );
+        rasterizer.ResetStatistics();
+
+        BenchmarkTimer timer;
+        for ( int frame = 0; frame < numFrames; ++frame )
+        {
+            scene.Render( rasterizer );
+        }
+        double seconds = timer.ElapsedSeconds();
+
+        const SoftwareRasterizer::Statistics& statistics = rasterizer.get_Statistics();
+        printf( "%8u %12.3f %16.3f %16.3f\n", numThreads,
+            seconds * 1000.0 / numFrames,
+            statistics.TrianglesSubmitted / seconds * 1e-6,
+            statistics.PixelsShaded / seconds * 1e-6 );
+
+        if ( numThreads == maxThreads && !options.OutputDirectory.empty() )
+        {
+            std::string fileName = options.OutputDirectory + "/SoftwareRasterizer_TextureAndLighting.tga";
+            if ( SaveTGA( fileName, width, height, rasterizer.get_ColorBuffer().data() ) )
+            {
+                std::cout << "Wrote " << fileName << std::endl;
+            }
+            else
+            {
+                std::cerr << "Failed to write " << fileName << std::endl;
+            }
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#include <Benchmark.h>
+
+#include <Camera.h>
+#include <JobSystem.h>
+#include <TiledDeferred.h>
+#include <TiledDeferredScene.h>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+
+using namespace Math;
+using namespace TiledDeferredScene;
+
+// The throughput of the G-buffer encoding and decoding, the errors of the decoded
+// values, and the difference between the forward and the deferred lighting of the
+// eight animated lights of the demo.
+BENCHMARK( TiledDeferred_GBuffer )
+{
+    const size_t numTexels = options.Quick ? 100000 : 1000000;
+
+    std::mt19937 random( 1234 );
+    std::vector<_Material> materials = GenerateMaterials( 64, random );
+    std::vector<Float4> texColors;
+    std::vector<Float3> normals;
+    GenerateTexels( numTexels, random, texColors, normals );
+    Float4 globalAmbient( 0.2f, 0.2f, 0.2f, 1.0f );
+
+    std::vector<GBufferTexel> texels( numTexels );
+    BenchmarkTimer timer;
+    for ( size_t i = 0; i < numTexels; ++i )
+    {
+        texels[i] = EncodeGBuffer( materials[i % materials.size()], texColors[i], normals[i], globalAmbient );
+    }
+    double encodeSeconds = timer.ElapsedSeconds();
+    DoNotOptimize( texels.data() );
+
+    std::vector<GBufferSample> samples( numTexels );
+    timer.Reset();
+    for ( size_t i = 0; i < numTexels; ++i )
+    {
+        samples[i] = DecodeGBuffer( texels[i] );
+    }
+    double decodeSeconds = timer.ElapsedSeconds();
+    DoNotOptimize( samples.data() );
+
+    GBufferErrors errors = MeasureGBufferErrors( materials, texColors, normals, globalAmbient, samples );
+    float shadingError = MeasureShadingError( materials, texColors, normals, globalAmbient, std::min<size_t>( numTexels, 100000 ), random );
+
+    printf( "%zu texels, %zu bytes per texel\n", numTexels, sizeof( GBufferTexel ) );
+    printf( "%12s %12s %12s %12s %12s %14s\n", "Mtexels/s enc", "Mtexels/s dec", "color err", "power err", "normal err", "shading err" );
+    printf( "%12.1f %12.1f %12.5f %12.5f %12.2e %14.5f\n", numTexels / encodeSeconds * 1e-6, numTexels / decodeSeconds * 1e-6,
+        errors.Color, errors.SpecularPower, errors.NormalAngle, shadingError );
+}
+
+// The time to find the depth bounds of the 16 x 16 pixel tiles of a 1280 x 720 depth
+// buffer and to cull growing numbers of lights against them, on one and on all
+// threads. The lights per pixel is the number of lights the lighting pass shades per
+// pixel (all of the lights without culling).
+BENCHMARK( TiledDeferred_Culling )
+{
+    const int numIterations = options.Quick ? 3 : 20;
+    const size_t maxLights = options.Quick ? 1024 : 4096;
+    const size_t numThreads = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+
+    Camera camera = CreateCamera();
+    std::vector<float> depthBuffer;
+    RenderDepth( camera, depthBuffer );
+
+    TiledLightCulling culling( ScreenWidth, ScreenHeight );
+    culling.SetProjection( camera );
+    TiledLightCulling parallelCulling( ScreenWidth, ScreenHeight );
+    parallelCulling.SetProjection( camera );
+    JobSystem jobSystem( numThreads );
+
+    printf( "%u x %u tiles, %zu threads, %d iterations\n", culling.get_NumTilesX(), culling.get_NumTilesY(), numThreads, numIterations );
+    printf( "%8s %10s %10s %12s %12s %12s %10s %10s\n", "lights", "ms", "ms (MT)", "lights/tile", "max/tile",
+        "lights/pixel", "overflow", "CPU KB" );
+
+    BoundingSphereArrays bounds;
+    for ( size_t numLights = 16; numLights <= maxLights; numLights *= 4 )
+    {
+        ViewSpaceBounds( GenerateLights( numLights ), camera, bounds );
+
+        BenchmarkTimer timer;
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            culling.CullLights( depthBuffer.data(), ScreenWidth, bounds );
+        }
+        double seconds = timer.ElapsedSeconds() / numIterations;
+
+        timer.Reset();
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            parallelCulling.CullLights( depthBuffer.data(), ScreenWidth, bounds, &jobSystem );
+        }
+        double parallelSeconds = timer.ElapsedSeconds() / numIterations;
+        DoNotOptimize( parallelCulling.get_LightIndices().data() );
+
+        // The lights that are shaded per pixel (every pixel of a tile shades all of its lights).
+        const std::vector<LightCluster>& tiles = culling.get_Tiles();
+        uint32_t maxPerTile = 0;
+        double lightPixels = 0.0;
+        for ( uint32_t t = 0; t < culling.get_NumTiles(); ++t )
+        {
+            uint32_t x = t % culling.get_NumTilesX();
+            uint32_t y = t / culling.get_NumTilesX();
+            uint32_t width = std::min( TiledLightCulling::TileSize, ScreenWidth - x * TiledLightCulling::TileSize );
+            uint32_t height = std::min( TiledLightCulling::TileSize, ScreenHeight - y * TiledLightCulling::TileSize );
+            maxPerTile = std::max( maxPerTile, tiles[t].Count );
+            lightPixels += static_cast<double>( tiles[t].Count ) * width * height;
+        }
+
+        printf( "%8zu %10.3f %10.3f %12.1f %12u %12.2f %10u %10.1f\n", numLights, seconds * 1e3, parallelSeconds * 1e3,
+            static_cast<double>( culling.get_LightIndices().size() ) / culling.get_NumTiles(), maxPerTile,
+            lightPixels / ( ScreenWidth * ScreenHeight ), culling.get_NumOverflowTiles(), culling.get_MemoryUsage() / 1024.0 );
+    }
+}
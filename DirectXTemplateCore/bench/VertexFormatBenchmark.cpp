@@ -0,0 +1,90 @@
+#include <Benchmark.h>
+
+#include <Geometry.h>
+#include <VertexFormats.h>
+#include <VertexFormatErrors.h>
+
+using namespace Math;
+using namespace VertexFormatErrors;
+
+namespace
+{
+    void PrintResult( const char* name, const char* format, size_t bytesPerVertex, size_t numVertices, int numIterations,
+        double encodeSeconds, double decodeSeconds, const VertexErrors& errors )
+    {
+        double vertices = static_cast<double>( numVertices ) * numIterations;
+        printf( "%-9s %-9s %5zu %9.1f %9.1f %10.2e %10.2e %10.2e\n", name, format, bytesPerVertex,
+            vertices / ( encodeSeconds * 1e6 ), vertices / ( decodeSeconds * 1e6 ),
+            errors.Position, errors.NormalAngle, errors.TextureCoordinate );
+    }
+
+    void RunVertexFormatBenchmark( const char* name, const VertexCollection& vertices, int numIterations )
+    {
+        BoundingBox box = ComputeBoundingBox( vertices );
+
+        HalfVertexCollection halfVertices;
+        QuantizedVertexCollection quantizedVertices;
+        VertexCollection decodedVertices;
+
+        printf( "%-9s %-9s %5zu\n", name, "float", sizeof( VertexPositionNormalTexture ) );
+
+        BenchmarkTimer timer;
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            EncodeVertices( vertices, halfVertices );
+            DoNotOptimize( halfVertices.data() );
+        }
+        double encodeSeconds = timer.ElapsedSeconds();
+
+        timer.Reset();
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            DecodeVertices( halfVertices, decodedVertices );
+            DoNotOptimize( decodedVertices.data() );
+        }
+        double decodeSeconds = timer.ElapsedSeconds();
+
+        PrintResult( name, "half", sizeof( VertexPositionNormalTextureHalf ), vertices.size(), numIterations,
+            encodeSeconds, decodeSeconds, MeasureErrors( vertices, decodedVertices, nullptr ) );
+
+        timer.Reset();
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            EncodeVertices( vertices, box, quantizedVertices );
+            DoNotOptimize( quantizedVertices.data() );
+        }
+        encodeSeconds = timer.ElapsedSeconds();
+
+        timer.Reset();
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            DecodeVertices( quantizedVertices, box, decodedVertices );
+            DoNotOptimize( decodedVertices.data() );
+        }
+        decodeSeconds = timer.ElapsedSeconds();
+
+        PrintResult( name, "quantized", sizeof( VertexPositionNormalTextureQuantized ), vertices.size(), numIterations,
+            encodeSeconds, decodeSeconds, MeasureErrors( vertices, decodedVertices, &box ) );
+    }
+}
+
+BENCHMARK( VertexFormat_EncodeDecode )
+{
+    const size_t tessellation = options.Quick ? 64 : 256;
+    const int numIterations = options.Quick ? 4 : 32;
+
+    printf( "Encode and decode throughput (vertices per microsecond) and the largest decoding errors\n" );
+    printf( "%-9s %-9s %5s %9s %9s %10s %10s %10s\n", "mesh", "format", "bytes",
+        "encode", "decode", "position", "normal", "texcoord" );
+
+    VertexCollection vertices;
+    IndexCollection indices;
+
+    ComputeSphere( vertices, indices, 1.0f, tessellation, false );
+    RunVertexFormatBenchmark( "sphere", vertices, numIterations );
+
+    ComputeTorus( vertices, indices, 1.0f, 0.333f, tessellation, false );
+    RunVertexFormatBenchmark( "torus", vertices, numIterations );
+
+    RunVertexFormatBenchmark( "random", ComputeRandomVertices( vertices.size() ), numIterations );
+}
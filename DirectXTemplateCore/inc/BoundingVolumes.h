@@ -0,0 +1,148 @@
+/**
+ * @brief Bounding volumes used for culling.
+ *
+ * The single-object types are used to describe the bounds of an object. The
+ * Arrays types store the bounds of many objects in structure-of-arrays layout
+ * so that they can be culled several objects at a time (see Frustum).
+ *
+ * Use the Transform functions to move the bounds of a mesh (see Geometry.h) to
+ * world space.
+ */
+#pragma once
+
+#include <CoreMath.h>
+
+#include <vector>
+
+struct BoundingSphere
+{
+    BoundingSphere() = default;
+    BoundingSphere( const Math::Float3& center, float radius )
+        : Center( center )
+        , Radius( radius )
+    {}
+
+    Math::Float3 Center;
+    float Radius;
+};
+
+// An axis-aligned bounding box.
+struct BoundingBox
+{
+    BoundingBox() = default;
+    BoundingBox( const Math::Float3& center, const Math::Float3& extents )
+        : Center( center )
+        , Extents( extents )
+    {}
+
+    Math::Float3 Center;
+    // Half the size of the box along each axis.
+    Math::Float3 Extents;
+};
+
+/**
+ * Transform a bounding sphere by an affine matrix. The radius is scaled by the
+ * largest scale of the matrix so the sphere still encloses the object if the
+ * matrix contains a non-uniform scale.
+ */
+BoundingSphere Transform( const BoundingSphere& sphere, const Math::Float4x4& matrix );
+/**
+ * Transform an axis-aligned bounding box by an affine matrix. The result is the
+ * axis-aligned box that encloses the transformed box (Arvo).
+ */
+BoundingBox Transform( const BoundingBox& box, const Math::Float4x4& matrix );
+
+// Bounding spheres in structure-of-arrays layout.
+struct BoundingSphereArrays
+{
+    std::vector<float> CenterX;
+    std::vector<float> CenterY;
+    std::vector<float> CenterZ;
+    std::vector<float> Radius;
+
+    void Add( const BoundingSphere& sphere )
+    {
+        CenterX.push_back( sphere.Center.x );
+        CenterY.push_back( sphere.Center.y );
+        CenterZ.push_back( sphere.Center.z );
+        Radius.push_back( sphere.Radius );
+    }
+
+    BoundingSphere Get( size_t index ) const
+    {
+        return BoundingSphere( Math::Float3( CenterX[index], CenterY[index], CenterZ[index] ), Radius[index] );
+    }
+
+    size_t Size() const
+    {
+        return Radius.size();
+    }
+
+    void Reserve( size_t size )
+    {
+        CenterX.reserve( size );
+        CenterY.reserve( size );
+        CenterZ.reserve( size );
+        Radius.reserve( size );
+    }
+
+    void Clear()
+    {
+        CenterX.clear();
+        CenterY.clear();
+        CenterZ.clear();
+        Radius.clear();
+    }
+};
+
+// Axis-aligned bounding boxes in structure-of-arrays layout.
+struct BoundingBoxArrays
+{
+    std::vector<float> CenterX;
+    std::vector<float> CenterY;
+    std::vector<float> CenterZ;
+    std::vector<float> ExtentsX;
+    std::vector<float> ExtentsY;
+    std::vector<float> ExtentsZ;
+
+    void Add( const BoundingBox& box )
+    {
+        CenterX.push_back( box.Center.x );
+        CenterY.push_back( box.Center.y );
+        CenterZ.push_back( box.Center.z );
+        ExtentsX.push_back( box.Extents.x );
+        ExtentsY.push_back( box.Extents.y );
+        ExtentsZ.push_back( box.Extents.z );
+    }
+
+    BoundingBox Get( size_t index ) const
+    {
+        return BoundingBox( Math::Float3( CenterX[index], CenterY[index], CenterZ[index] ),
+                            Math::Float3( ExtentsX[index], ExtentsY[index], ExtentsZ[index] ) );
+    }
+
+    size_t Size() const
+    {
+        return CenterX.size();
+    }
+
+    void Reserve( size_t size )
+    {
+        CenterX.reserve( size );
+        CenterY.reserve( size );
+        CenterZ.reserve( size );
+        ExtentsX.reserve( size );
+        ExtentsY.reserve( size );
+        ExtentsZ.reserve( size );
+    }
+
+    void Clear()
+    {
+        CenterX.clear();
+        CenterY.clear();
+        CenterZ.clear();
+        ExtentsX.clear();
+        ExtentsY.clear();
+        ExtentsZ.clear();
+    }
+};
@@ -0,0 +1,137 @@
+/**
+ * A DirectX camera class.
+ */
+#pragma once
+
+#include <CoreMath.h>
+#include <Frustum.h>
+
+// The viewport of the camera.
+// This struct has the same layout as D3D11_VIEWPORT.
+struct Viewport
+{
+    float TopLeftX;
+    float TopLeftY;
+    float Width;
+    float Height;
+    float MinDepth;
+    float MaxDepth;
+};
+
+class Camera
+{
+public:
+
+    // When performing transformations on the camera,
+    // it is sometimes useful to express which space this
+    // transformation should be applied.
+    enum Space
+    {
+        LocalSpace,
+        WorldSpace,
+    };
+
+    // Express whether this is a left-handed coordinate system (commonly used for DirectX)
+    // or a right-handed coordinate system (commonly used for OpenGL).
+    enum Handedness
+    {
+        LeftHanded,
+        RightHanded
+    };
+
+    Camera(Handedness handedness = LeftHanded);
+    virtual ~Camera();
+
+    void set_Viewport( const Viewport& viewport );
+    const Viewport& get_Viewport() const;
+
+    void set_LookAt( const Math::Float3& eye, const Math::Float3& target, const Math::Float3& up );
+    const Math::Float4x4& get_ViewMatrix() const;
+    const Math::Float4x4& get_InverseViewMatrix() const;
+
+    /**
+     * Set the camera to a perspective projection matrix.
+     * @param fovy The vertical field of view in degrees.
+     * @param aspect The aspect ratio of the screen.
+     * @param zNear The distance to the near clipping plane.
+     * @param zFar The distance to the far clipping plane.
+     */
+    void set_Projection( float fovy, float aspect, float zNear, float zFar );
+    const Math::Float4x4& get_ProjectionMatrix() const;
+    const Math::Float4x4& get_InverseProjectionMatrix() const;
+
+    // The vertical field of view in degrees.
+    float get_VerticalFieldOfView() const;
+    float get_AspectRatio() const;
+    // The distances to the near and far clipping planes.
+    float get_NearClipPlane() const;
+    float get_FarClipPlane() const;
+    /**
+     * The height in pixels of the projection of a world-space length at a distance
+     * from the camera, computed from the vertical field of view and the height of
+     * the viewport.
+     */
+    float ProjectedSize( float size, float distance ) const;
+
+    /**
+     * Get the world-space view frustum of the camera.
+     */
+    const Frustum& get_Frustum() const;
+
+    /**
+     * Set the camera's position in world-space.
+     */
+    void set_Translation( const Math::Float3& translation );
+    const Math::Float3& get_Translation() const;
+
+    /**
+     * Set the camera's rotation in world-space.
+     * @param rotation The rotation quaternion.
+     */
+    void set_Rotation( const Math::Float4& rotation );
+    /**
+     * Query the camera's rotation.
+     * @returns The camera's rotation quaternion.
+     */
+    const Math::Float4& get_Rotation() const;
+
+    void Translate( const Math::Float3& translation, Space space = LocalSpace );
+    void Rotate( const Math::Float4& quaternion );
+
+protected:
+    virtual void UpdateViewMatrix() const;
+    virtual void UpdateInverseViewMatrix() const;
+    virtual void UpdateProjectionMatrix() const;
+    virtual void UpdateInverseProjectionMatrix() const;
+    virtual void UpdateFrustum() const;
+
+    // World-space position of the camera.
+    Math::Float3 m_Translation;
+    // World-space rotation of the camera.
+    // THIS IS A QUATERNION!!!!
+    Math::Float4 m_Rotation;
+
+    mutable Math::Float4x4 m_ViewMatrix, m_InverseViewMatrix;
+    mutable Math::Float4x4 m_ProjectionMatrix, m_InverseProjectionMatrix;
+    mutable Frustum m_Frustum;
+
+    // projection parameters
+    float m_vFoV;   // Vertical field of view.
+    float m_AspectRatio; // Aspect ratio
+    float m_zNear;      // Near clip distance
+    float m_zFar;       // Far clip distance.
+
+    Viewport m_Viewport;
+
+    // True if the view matrix needs to be updated.
+    mutable bool m_ViewDirty, m_InverseViewDirty;
+    // True if the projection matrix needs to be updated.
+    mutable bool m_ProjectionDirty, m_InverseProjectionDirty;
+    // True if the frustum needs to be updated.
+    mutable bool m_FrustumDirty;
+
+    Handedness m_Handedness;
+
+private:
+
+};
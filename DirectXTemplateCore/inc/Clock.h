@@ -0,0 +1,108 @@
+/**
+ * @brief A high-resolution monotonic clock.
+ *
+ * Time is kept in 64-bit integer ticks of the platform counter (QueryPerformanceCounter
+ * on Windows, clock_gettime( CLOCK_MONOTONIC ) elsewhere) and only converted to seconds
+ * when it is read. The total time is the exact sum of the deltas, so it does not drift
+ * or lose precision however long the application runs.
+ */
+#pragma once
+
+#include <cstdint>
+
+class Clock
+{
+public:
+    // The current value of the monotonic counter.
+    static int64_t GetTicks();
+    // The number of ticks per second.
+    static int64_t GetFrequency();
+
+    static double TicksToSeconds( int64_t ticks );
+    static int64_t SecondsToTicks( double seconds );
+
+    // Start the clock at the current time.
+    Clock();
+
+    /**
+     * Measure the time since the previous call (or since the clock was started or reset)
+     * and add it to the total time.
+     */
+    void Tick();
+    // Add a fixed delta instead of measuring it (for reproducible runs).
+    void Advance( int64_t deltaTicks );
+    // Restart the clock at the current time with a total time of zero.
+    void Reset();
+
+    /**
+     * The largest delta that Tick adds to the total time (0 for no limit). Longer frames,
+     * for example after stopping in the debugger, are clamped to this value.
+     */
+    int64_t get_MaxDeltaTicks() const;
+    void set_MaxDeltaTicks( int64_t maxDeltaTicks );
+
+    int64_t get_DeltaTicks() const;
+    int64_t get_TotalTicks() const;
+    double get_DeltaSeconds() const;
+    double get_TotalSeconds() const;
+    // The number of calls to Tick or Advance since the clock was started or reset.
+    uint64_t get_FrameCount() const;
+
+private:
+    int64_t m_PreviousTicks;
+    int64_t m_MaxDeltaTicks;
+    int64_t m_DeltaTicks;
+    int64_t m_TotalTicks;
+    uint64_t m_FrameCount;
+};
+
+/**
+ * @brief Split elapsed time into fixed simulation steps.
+ *
+ * The remainder is kept in units of ticks times steps per second, so a rate such as
+ * 60 steps per second is exact even if the tick frequency is not a multiple of it.
+ * The alpha is the fraction of a step that has accumulated since the last step; use it
+ * to interpolate between the previous and the current simulation state when rendering.
+ */
+class FixedTimestep
+{
+public:
+    /**
+     * @param stepsPerSecond The number of simulation steps per second.
+     * @param frequency The number of ticks per second of the deltas.
+     * @param maxStepsPerAdvance The most steps that Advance returns. Any more time is dropped
+     * so a slow frame does not cause ever slower frames.
+     */
+    FixedTimestep( uint32_t stepsPerSecond, int64_t frequency = Clock::GetFrequency(), uint32_t maxStepsPerAdvance = 8 );
+
+    // Add the elapsed time and return the number of steps to simulate.
+    uint32_t Advance( int64_t deltaTicks );
+    void Reset();
+
+    uint32_t get_StepsPerSecond() const;
+    // The duration of one step.
+    double get_StepSeconds() const;
+    // The number of steps since the timestep was created or reset.
+    uint64_t get_NumSteps() const;
+    // The simulated time (the number of steps times the duration of a step).
+    double get_TotalSeconds() const;
+    // The fraction of the next step that has accumulated, in [0, 1).
+    double get_Alpha() const;
+    /**
+     * The time to render when interpolating between the previous and the current step
+     * with get_Alpha: ( NumSteps - 1 + alpha ) / StepsPerSecond, which lags the simulated
+     * time by one step (0 before the second step).
+     */
+    double get_InterpolatedSeconds() const;
+    // The time that was dropped because of maxStepsPerAdvance.
+    int64_t get_DroppedTicks() const;
+
+private:
+    uint32_t m_StepsPerSecond;
+    int64_t m_Frequency;
+    uint32_t m_MaxStepsPerAdvance;
+    // The elapsed time that is not simulated yet, in ticks times steps per second.
+    int64_t m_Accumulator;
+    uint64_t m_NumSteps;
+    int64_t m_DroppedTicks;
+};
@@ -0,0 +1,194 @@
+/**
+ * @brief A small, platform-neutral math library used by the core library.
+ *
+ * The matrix conventions match the DirectX Math library: matrices are stored
+ * row-major and vectors are treated as row vectors (v * M). A Float4x4 has the
+ * same memory layout as DirectX::XMFLOAT4X4 so it can be loaded directly into
+ * an XMMATRIX or copied into a constant buffer.
+ */
+#pragma once
+
+#include <cmath>
+
+namespace Math
+{
+    const float Pi      = 3.141592654f;
+    const float TwoPi   = 6.283185307f;
+    const float PiDiv2  = 1.570796327f;
+    const float PiDiv4  = 0.785398163f;
+
+    inline float ConvertToRadians( float degrees )
+    {
+        return degrees * ( Pi / 180.0f );
+    }
+
+    inline float ConvertToDegrees( float radians )
+    {
+        return radians * ( 180.0f / Pi );
+    }
+
+    inline void ScalarSinCos( float* pSin, float* pCos, float angle )
+    {
+        *pSin = std::sin( angle );
+        *pCos = std::cos( angle );
+    }
+
+    struct Float2
+    {
+        Float2() = default;
+        Float2( float _x, float _y )
+            : x( _x ), y( _y )
+        {}
+
+        float x, y;
+    };
+
+    struct Float3
+    {
+        Float3() = default;
+        Float3( float _x, float _y, float _z )
+            : x( _x ), y( _y ), z( _z )
+        {}
+
+        float x, y, z;
+    };
+
+    struct Float4
+    {
+        Float4() = default;
+        Float4( float _x, float _y, float _z, float _w )
+            : x( _x ), y( _y ), z( _z ), w( _w )
+        {}
+        Float4( const Float3& v, float _w )
+            : x( v.x ), y( v.y ), z( v.z ), w( _w )
+        {}
+
+        float x, y, z, w;
+    };
+
+    struct Float4x4
+    {
+        Float4x4() = default;
+        Float4x4( float m00, float m01, float m02, float m03,
+                  float m10, float m11, float m12, float m13,
+                  float m20, float m21, float m22, float m23,
+                  float m30, float m31, float m32, float m33 );
+
+        float m[4][4];
+    };
+
+    // Float2 operators.
+    inline Float2 operator+( const Float2& a, const Float2& b ) { return Float2( a.x + b.x, a.y + b.y ); }
+    inline Float2 operator-( const Float2& a, const Float2& b ) { return Float2( a.x - b.x, a.y - b.y ); }
+    inline Float2 operator*( const Float2& a, float s ) { return Float2( a.x * s, a.y * s ); }
+
+    // Float3 operators.
+    inline Float3 operator-( const Float3& a ) { return Float3( -a.x, -a.y, -a.z ); }
+    inline Float3 operator+( const Float3& a, const Float3& b ) { return Float3( a.x + b.x, a.y + b.y, a.z + b.z ); }
+    inline Float3 operator-( const Float3& a, const Float3& b ) { return Float3( a.x - b.x, a.y - b.y, a.z - b.z ); }
+    inline Float3 operator*( const Float3& a, const Float3& b ) { return Float3( a.x * b.x, a.y * b.y, a.z * b.z ); }
+    inline Float3 operator*( const Float3& a, float s ) { return Float3( a.x * s, a.y * s, a.z * s ); }
+    inline Float3 operator*( float s, const Float3& a ) { return a * s; }
+    inline Float3 operator/( const Float3& a, float s ) { return a * ( 1.0f / s ); }
+    inline Float3& operator+=( Float3& a, const Float3& b ) { a = a + b; return a; }
+    inline Float3& operator-=( Float3& a, const Float3& b ) { a = a - b; return a; }
+
+    // Float4 operators.
+    inline Float4 operator+( const Float4& a, const Float4& b ) { return Float4( a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w ); }
+    inline Float4 operator-( const Float4& a, const Float4& b ) { return Float4( a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w ); }
+    inline Float4 operator*( const Float4& a, const Float4& b ) { return Float4( a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w ); }
+    inline Float4 operator*( const Float4& a, float s ) { return Float4( a.x * s, a.y * s, a.z * s, a.w * s ); }
+    inline Float4& operator+=( Float4& a, const Float4& b ) { a = a + b; return a; }
+
+    inline float Dot( const Float3& a, const Float3& b )
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    inline float Dot( const Float4& a, const Float4& b )
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    }
+
+    inline Float3 Cross( const Float3& a, const Float3& b )
+    {
+        return Float3( a.y * b.z - a.z * b.y,
+                       a.z * b.x - a.x * b.z,
+                       a.x * b.y - a.y * b.x );
+    }
+
+    inline float Length( const Float3& v )
+    {
+        return std::sqrt( Dot( v, v ) );
+    }
+
+    inline float LengthSq( const Float3& v )
+    {
+        return Dot( v, v );
+    }
+
+    inline Float3 Normalize( const Float3& v )
+    {
+        float length = Length( v );
+        return ( length > 0.0f ) ? v / length : v;
+    }
+
+    inline Float3 Min( const Float3& a, const Float3& b )
+    {
+        return Float3( a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z );
+    }
+
+    inline Float3 Max( const Float3& a, const Float3& b )
+    {
+        return Float3( a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z );
+    }
+
+    inline Float3 Lerp( const Float3& a, const Float3& b, float t )
+    {
+        return a + ( b - a ) * t;
+    }
+
+    inline Float3 XYZ( const Float4& v )
+    {
+        return Float3( v.x, v.y, v.z );
+    }
+
+    // Matrix functions.
+    Float4x4 MatrixIdentity();
+    Float4x4 MatrixMultiply( const Float4x4& a, const Float4x4& b );
+    Float4x4 MatrixTranspose( const Float4x4& m );
+    Float4x4 MatrixInverse( const Float4x4& m );
+    Float4x4 MatrixTranslation( float x, float y, float z );
+    Float4x4 MatrixTranslation( const Float3& translation );
+    Float4x4 MatrixScaling( float x, float y, float z );
+    Float4x4 MatrixRotationX( float angle );
+    Float4x4 MatrixRotationY( float angle );
+    Float4x4 MatrixRotationZ( float angle );
+    Float4x4 MatrixRotationQuaternion( const Float4& quaternion );
+    Float4x4 MatrixLookAtLH( const Float3& eye, const Float3& target, const Float3& up );
+    Float4x4 MatrixLookAtRH( const Float3& eye, const Float3& target, const Float3& up );
+    Float4x4 MatrixPerspectiveFovLH( float fovAngleY, float aspectRatio, float nearZ, float farZ );
+    Float4x4 MatrixPerspectiveFovRH( float fovAngleY, float aspectRatio, float nearZ, float farZ );
+    Float4x4 MatrixOrthographicOffCenterLH( float viewLeft, float viewRight, float viewBottom, float viewTop, float nearZ, float farZ );
+
+    inline Float4x4 operator*( const Float4x4& a, const Float4x4& b )
+    {
+        return MatrixMultiply( a, b );
+    }
+
+    // Transform a point (w = 1) by a matrix. The result is not divided by w.
+    Float3 TransformPoint( const Float3& v, const Float4x4& m );
+    // Transform a direction vector (w = 0) by a matrix.
+    Float3 TransformNormal( const Float3& v, const Float4x4& m );
+    // Transform a 4D vector by a matrix.
+    Float4 Transform( const Float4& v, const Float4x4& m );
+
+    // Quaternion functions.
+    // All quaternions are stored (x, y, z, w) where w is the scalar part.
+    Float4 QuaternionIdentity();
+    // Returns the rotation q1 followed by the rotation q2 (same as XMQuaternionMultiply).
+    Float4 QuaternionMultiply( const Float4& q1, const Float4& q2 );
+    Float4 QuaternionRotationMatrix( const Float4x4& m );
+    Float4 QuaternionRotationRollPitchYaw( float pitch, float yaw, float roll );
+    Float3 Vector3Rotate( const Float3& v, const Float4& quaternion );
+}
@@ -0,0 +1,18 @@
+// The core library must compile on any platform so it must not include
+// any Windows or DirectX headers.
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+
+// Core includes
+#include <CoreMath.h>
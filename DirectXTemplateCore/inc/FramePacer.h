@@ -0,0 +1,94 @@
+/**
+ * @brief The frame pacing policy of a flip-model swap chain.
+ *
+ * With a frame latency waitable object the game waits until the swap chain can
+ * queue another frame before it reads the input and starts the CPU work of the
+ * frame. The FramePacer decides how long to wait after that: with PredictiveStart
+ * the start of the frame is delayed so that it is expected to finish just before
+ * the vertical blank at which it is displayed, which shortens the time between
+ * reading the input and displaying the result.
+ *
+ * The pacer only does the bookkeeping; it does not depend on DXGI (see
+ * Game::WaitForNextFrame for the Direct3D 11 implementation). Times are in seconds
+ * on any monotonic time base.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct FramePacingSettings
+{
+    FramePacingSettings()
+        : MaxFrameLatency( 1 )
+        , PredictiveStart( false )
+        , SafetyMargin( 0.004 )
+        , NumFrameTimes( 32 )
+        , Percentile( 0.95 )
+    {}
+
+    // The most frames that can be queued for presentation (1 for the lowest latency).
+    uint32_t MaxFrameLatency;
+    // Delay the start of each frame so that it finishes just before the vertical blank
+    // (most useful with a MaxFrameLatency of 1).
+    bool PredictiveStart;
+    // The time (in seconds) that is reserved before the vertical blank for the GPU
+    // and for frames that take longer than predicted.
+    double SafetyMargin;
+    // The number of recent frame times that the prediction is based on.
+    uint32_t NumFrameTimes;
+    // The predicted frame time is this percentile (in [0, 1]) of the recent frame times.
+    double Percentile;
+};
+
+class FramePacer
+{
+public:
+    explicit FramePacer( const FramePacingSettings& settings = FramePacingSettings() );
+
+    const FramePacingSettings& get_Settings() const;
+    // Changing the settings forgets the recent frame times.
+    void set_Settings( const FramePacingSettings& settings );
+
+    /**
+     * Record a vertical blank, for example DXGI_FRAME_STATISTICS::SyncRefreshCount and
+     * SyncQPCTime. The refresh period is estimated from the first and the latest vblank.
+     */
+    void AddVBlank( uint64_t refreshCount, double time );
+    // The estimated refresh period (0 until two different vblanks have been recorded).
+    double get_RefreshPeriod() const;
+    // The first estimated vblank after time (or time if the refresh period is unknown).
+    double GetNextVBlank( double time ) const;
+
+    // Record the CPU time of a frame (from the start of the frame until Present returned).
+    void AddFrameTime( double frameTime );
+    // The predicted CPU time of the next frame (0 if no frame times have been recorded).
+    double get_PredictedFrameTime() const;
+
+    /**
+     * How long to wait before starting a frame at time now (after the latency wait
+     * returned) so that it finishes SafetyMargin before the next vblank. Returns 0 if
+     * PredictiveStart is off, the refresh period is unknown or the frame is not
+     * expected to make the next vblank.
+     */
+    double GetStartDelay( double now ) const;
+
+    // Forget the recorded vblanks and frame times.
+    void Reset();
+
+private:
+    FramePacingSettings m_Settings;
+
+    // The first and the latest vblank.
+    uint64_t m_FirstRefreshCount;
+    double m_FirstVBlankTime;
+    uint64_t m_LastRefreshCount;
+    double m_LastVBlankTime;
+    uint32_t m_NumVBlanks;
+
+    // The recent frame times (a ring buffer).
+    std::vector<double> m_FrameTimes;
+    size_t m_NextFrameTime;
+    double m_PredictedFrameTime;
+};
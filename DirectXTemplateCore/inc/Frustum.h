@@ -0,0 +1,70 @@
+/**
+ * @brief A view frustum described by 6 planes.
+ *
+ * The planes are extracted from a (view-)projection matrix that uses the row-vector
+ * convention of the Math library and the D3D clip-space depth range [0, w]. The
+ * plane normals point into the frustum.
+ *
+ * The batched culling functions test Simd::Width bounding volumes against
+ * all 6 planes at a time and write the indices of the visible volumes.
+ */
+#pragma once
+
+#include <BoundingVolumes.h>
+
+#include <cstdint>
+#include <vector>
+
+class Frustum
+{
+public:
+    enum PlaneIndex
+    {
+        LeftPlane,
+        RightPlane,
+        BottomPlane,
+        TopPlane,
+        NearPlane,
+        FarPlane,
+        NumPlanes
+    };
+
+    // An empty frustum (all planes at the origin).
+    Frustum();
+
+    /**
+     * Extract the frustum planes from a matrix. Use the projection matrix to
+     * get a view-space frustum or the view-projection matrix to get a
+     * world-space frustum.
+     */
+    explicit Frustum( const Math::Float4x4& matrix );
+
+    /**
+     * Get a plane of the frustum. The plane is stored as (normal, distance):
+     * a point p is inside the plane if Dot(normal, p) + distance >= 0.
+     */
+    const Math::Float4& get_Plane( PlaneIndex plane ) const;
+
+    // Returns true if the sphere is inside or intersects the frustum.
+    bool Intersects( const BoundingSphere& sphere ) const;
+    // Returns true if the box is inside or intersects the frustum.
+    bool Intersects( const BoundingBox& box ) const;
+
+    /**
+     * Cull a batch of bounding spheres.
+     * @param visibleIndices The indices of the spheres that are inside or intersect
+     * the frustum (in ascending order). The vector is resized to the number of
+     * visible spheres.
+     * @returns The number of visible spheres.
+     */
+    size_t Cull( const BoundingSphereArrays& spheres, std::vector<uint32_t>& visibleIndices ) const;
+
+    /**
+     * Cull a batch of axis-aligned bounding boxes.
+     * @see Cull( const BoundingSphereArrays&, std::vector<uint32_t>& )
+     */
+    size_t Cull( const BoundingBoxArrays& boxes, std::vector<uint32_t>& visibleIndices ) const;
+
+private:
+    Math::Float4 m_Planes[NumPlanes];
+};
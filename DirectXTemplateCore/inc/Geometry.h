@@ -0,0 +1,139 @@
+/**
+ * @brief Functions to generate the vertices and indices of geometric primitives.
+ *
+ * These functions only produce CPU-side vertex and index data. Use the Mesh class
+ * in the DirectXTemplateLib to upload the geometry to the GPU.
+ *
+ * The bounds of the primitives are known in advance: use the Compute*Bounds
+ * functions instead of computing the bounds from the generated vertices.
+ */
+#pragma once
+
+#include <BoundingVolumes.h>
+#include <CoreMath.h>
+#include <IndexCollection.h>
+
+#include <cstdint>
+#include <vector>
+
+// Vertex struct holding position, normal vector, and texture mapping information.
+struct VertexPositionNormalTexture
+{
+    VertexPositionNormalTexture()
+    { }
+
+    VertexPositionNormalTexture( const Math::Float3& position, const Math::Float3& normal, const Math::Float2& textureCoordinate )
+        : position(position),
+        normal(normal),
+        textureCoordinate(textureCoordinate)
+    { }
+
+    Math::Float3 position;
+    Math::Float3 normal;
+    Math::Float2 textureCoordinate;
+};
+
+typedef std::vector<VertexPositionNormalTexture> VertexCollection;
+
+// A range of the indices of a mesh that is drawn with a single draw call.
+struct SubMesh
+{
+    uint32_t StartIndex;
+    uint32_t IndexCount;
+    // Added to each index before the vertex is read from the vertex buffer.
+    int32_t BaseVertex;
+    uint32_t VertexCount;
+};
+
+typedef std::vector<SubMesh> SubMeshCollection;
+
+// A level of detail of a mesh: a range of the indices over the shared vertices.
+struct MeshLod
+{
+    uint32_t StartIndex;
+    uint32_t IndexCount;
+    // The distance of the simplified surface from the original surface in object
+    // space as estimated by the simplifier (0 for the full-detail mesh).
+    float Error;
+};
+
+typedef std::vector<MeshLod> MeshLodCollection;
+
+/**
+ * Generate the geometry for a cube.
+ * @param size The length of the edges of the cube.
+ * @param rhcoords Generate the geometry for a right-handed coordinate system.
+ */
+void ComputeCube( VertexCollection& vertices, IndexCollection& indices, float size = 1, bool rhcoords = true );
+/**
+ * Generate the geometry for a UV sphere.
+ * @param diameter The diameter of the sphere.
+ * @param tessellation The number of latitude rings. Must be at least 3.
+ * @param rhcoords Generate the geometry for a right-handed coordinate system.
+ */
+void ComputeSphere( VertexCollection& vertices, IndexCollection& indices, float diameter = 1, size_t tessellation = 16, bool rhcoords = true );
+/**
+ * Generate the geometry for a cone.
+ * @param diameter The diameter of the base of the cone.
+ * @param height The height of the cone.
+ * @param tessellation The number of segments around the base. Must be at least 3.
+ * @param rhcoords Generate the geometry for a right-handed coordinate system.
+ */
+void ComputeCone( VertexCollection& vertices, IndexCollection& indices, float diameter = 1, float height = 1, size_t tessellation = 32, bool rhcoords = true );
+/**
+ * Generate the geometry for a torus.
+ * @param diameter The diameter of the ring of the torus.
+ * @param thickness The thickness of the tube of the torus.
+ * @param tessellation The number of segments around the ring and the tube. Must be at least 3.
+ * @param rhcoords Generate the geometry for a right-handed coordinate system.
+ */
+void ComputeTorus( VertexCollection& vertices, IndexCollection& indices, float diameter = 1, float thickness = 0.333f, size_t tessellation = 32, bool rhcoords = true );
+
+// The bounds of the geometry generated by ComputeCube with the same parameters.
+void ComputeCubeBounds( BoundingBox& box, BoundingSphere& sphere, float size = 1 );
+// The bounds of the geometry generated by ComputeSphere with the same parameters.
+void ComputeSphereBounds( BoundingBox& box, BoundingSphere& sphere, float diameter = 1 );
+/**
+ * The bounds of the geometry generated by ComputeCone with the same parameters.
+ * The sphere is the smallest sphere that encloses the apex and the base of the cone.
+ */
+void ComputeConeBounds( BoundingBox& box, BoundingSphere& sphere, float diameter = 1, float height = 1 );
+// The bounds of the geometry generated by ComputeTorus with the same parameters.
+void ComputeTorusBounds( BoundingBox& box, BoundingSphere& sphere, float diameter = 1, float thickness = 0.333f );
+
+/**
+ * Compute the axis-aligned box that tightly encloses the vertex positions.
+ * An empty collection produces an empty box at the origin.
+ */
+BoundingBox ComputeBoundingBox( const VertexCollection& vertices );
+/**
+ * Compute a sphere that encloses the vertex positions. The result is the smaller
+ * of Ritter's sphere and the sphere around the center of the bounding box, which
+ * is typically within a few percent of the minimal enclosing sphere.
+ */
+BoundingSphere ComputeBoundingSphere( const VertexCollection& vertices );
+
+/**
+ * Split a mesh into submeshes that reference at most 65536 vertices each so that
+ * every submesh can be drawn with 16-bit indices and a base vertex offset.
+ * Triangles are assigned to submeshes in order and the vertices that are shared
+ * between submeshes are duplicated. The indices must be a triangle list.
+ * @param splitVertices The vertices of the submeshes. Each submesh starts at its BaseVertex.
+ * @param splitIndices The 16-bit indices of the submeshes relative to their BaseVertex.
+ */
+void SplitMesh16( const VertexCollection& vertices, const IndexCollection& indices,
+                  VertexCollection& splitVertices, IndexCollection& splitIndices, SubMeshCollection& subMeshes );
+
+/**
+ * Returns true if a mesh that was split with SplitMesh16 is expected to render
+ * faster than the original mesh with 32-bit indices. The split halves the index
+ * data but adds the duplicated vertices and one draw call per submesh (see
+ * the Mesh_LargeIndexStrategies benchmark).
+ */
+bool PreferSplitMesh( size_t numIndices, size_t numVertices, size_t numSplitVertices, size_t numSubMeshes );
+
+/**
+ * Flip the winding order of the triangles (and the horizontal texture coordinate)
+ * to convert geometry between right-handed and left-handed coordinates.
+ */
+void ReverseWinding( IndexCollection& indices, VertexCollection& vertices );
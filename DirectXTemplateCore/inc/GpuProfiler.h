@@ -0,0 +1,236 @@
+/**
+ * @brief A GPU profiler for named, nested scopes that never waits for the GPU.
+ *
+ * Every profiled frame uses one slot of a pool of timestamp queries: a disjoint
+ * query around the frame and two timestamps for the frame and for each scope. The
+ * results of a frame are read back a few frames later, when the GPU has finished
+ * it. If every slot is still in flight when a frame starts, the frame is not
+ * profiled instead of waiting for the GPU.
+ *
+ * The queries sit behind the GpuTimestampQueries interface (see
+ * D3D11TimestampQueries in the DirectXTemplateLib), so the pool and the readback
+ * latency can be verified with a simulated GPU (see GpuProfilerTest).
+ *
+ * The read back zones are also recorded on a "GPU" track of the CPU Profiler. The
+ * GPU clock is mapped to the CPU clock with a GpuClockSync.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A pool of timestamp queries, grouped in slots of one frame each.
+class GpuTimestampQueries
+{
+public:
+    virtual ~GpuTimestampQueries() {}
+
+    // The number of frames that can be in flight.
+    virtual uint32_t get_NumSlots() const = 0;
+    // The number of timestamp queries of each slot.
+    virtual uint32_t get_MaxTimestamps() const = 0;
+
+    // Begin and end the disjoint query of a slot.
+    virtual void BeginFrame( uint32_t slot ) = 0;
+    virtual void EndFrame( uint32_t slot ) = 0;
+
+    // Issue a timestamp query.
+    virtual void WriteTimestamp( uint32_t slot, uint32_t index ) = 0;
+
+    /**
+     * Read the results of the disjoint query of a slot without waiting. Returns false
+     * if the GPU has not finished the frame yet. Timestamps of a disjoint frame are
+     * not reliable.
+     */
+    virtual bool GetFrequency( uint32_t slot, uint64_t& frequency, bool& disjoint ) = 0;
+    // Read a timestamp without waiting. Returns false if it is not available yet.
+    virtual bool GetTimestamp( uint32_t slot, uint32_t index, uint64_t& timestamp ) = 0;
+};
+
+/**
+ * Estimates the offset between a GPU clock and a CPU clock from the times at which the
+ * CPU issued commands and the times at which the GPU executed them. A command cannot
+ * execute before it was issued, so every sample is a lower bound of the offset
+ * (cpuTime = gpuTime + offset). The estimate is the largest bound of the recent frames;
+ * it is exact when the GPU was idle when a command was issued, and otherwise too small
+ * by the time that the command waited in the queue.
+ */
+class GpuClockSync
+{
+public:
+    // @param numFrames The number of recent frames whose samples are used, so the
+    // estimate follows a drift between the clocks.
+    explicit GpuClockSync( uint32_t numFrames = 64 );
+
+    // Add a sample of the current frame (the times are in seconds).
+    void AddSample( double cpuTime, double gpuTime );
+    void EndFrame();
+
+    // True if a sample was added since the last reset.
+    bool get_Valid() const;
+    // cpuTime = gpuTime + offset.
+    double get_Offset() const;
+
+    void Reset();
+
+private:
+    // The largest bound of the current and the recent frames.
+    double m_FrameOffset;
+    std::vector<double> m_FrameOffsets;
+    size_t m_NextFrame;
+};
+
+struct GpuProfileZone
+{
+    // The name that was passed to BeginScope.
+    const char* Name;
+    // The number of scopes that contain this scope.
+    uint32_t Depth;
+    // The start of the scope relative to the start of the frame, in seconds.
+    double Begin;
+    double Duration;
+};
+
+struct GpuProfileFrame
+{
+    GpuProfileFrame()
+        : FrameIndex( 0 )
+        , Duration( 0.0 )
+    {}
+
+    // The number of frames that were started before this frame.
+    uint64_t FrameIndex;
+    // The GPU time from the start to the end of the frame, in seconds.
+    double Duration;
+    // Ordered by start time, parents before their children.
+    std::vector<GpuProfileZone> Zones;
+};
+
+class GpuProfiler
+{
+public:
+    // The queries are not owned and must outlive the profiler.
+    explicit GpuProfiler( GpuTimestampQueries& queries );
+
+    // Start and end a frame. EndFrame also reads back the frames that the GPU has finished.
+    void BeginFrame();
+    void EndFrame();
+
+    /**
+     * Begin and end a scope of the current frame (see GPU_PROFILE_SCOPE). Scopes
+     * must be nested. Scopes that do not fit in the timestamps of the slot are not
+     * profiled.
+     */
+    void BeginScope( const char* name );
+    void EndScope();
+
+    // The number of frames that were started.
+    uint64_t get_NumFrames() const;
+    // The number of frames whose results were read back.
+    uint64_t get_NumResolvedFrames() const;
+    // The latest frame whose results were read back.
+    const GpuProfileFrame& get_LatestFrame() const;
+
+    // The frames that were not profiled because every slot was in flight.
+    uint64_t get_NumSkippedFrames() const;
+    // The frames that were discarded because the GPU clock was disjoint.
+    uint64_t get_NumDisjointFrames() const;
+    // The scopes that did not fit in the timestamps of their slot.
+    uint64_t get_NumDroppedScopes() const;
+
+    const GpuClockSync& get_ClockSync() const;
+
+private:
+    GpuProfiler( const GpuProfiler& copy );
+
+    struct Scope
+    {
+        const char* Name;
+        uint32_t Depth;
+        // The indices of the timestamps.
+        uint32_t Begin;
+        uint32_t End;
+    };
+
+    struct Slot
+    {
+        Slot()
+            : Pending( false )
+            , FrameIndex( 0 )
+        {}
+
+        // The frame was ended and its results were not read yet.
+        bool Pending;
+        uint64_t FrameIndex;
+        std::vector<Scope> Scopes;
+        // The profiler timestamps at which the timestamp queries were issued.
+        std::vector<int64_t> IssueTimes;
+    };
+
+    // Read the results of a pending slot. Returns false if they are not available yet.
+    bool Resolve( Slot& slot, uint32_t index );
+    uint32_t WriteTimestamp();
+
+    GpuTimestampQueries& m_Queries;
+    std::vector<Slot> m_Slots;
+    // The slot of the current frame (or m_Slots.size() if the frame is not profiled).
+    uint32_t m_CurrentSlot;
+    // The indices of the open scopes of the current frame (in Slot::Scopes).
+    std::vector<uint32_t> m_OpenScopes;
+    // The number of open scopes that were not profiled.
+    uint32_t m_NumDroppedOpenScopes;
+
+    uint64_t m_NumFrames;
+    uint64_t m_NumResolvedFrames;
+    uint64_t m_NumSkippedFrames;
+    uint64_t m_NumDisjointFrames;
+    uint64_t m_NumDroppedScopes;
+    GpuProfileFrame m_LatestFrame;
+    std::vector<uint64_t> m_Timestamps;
+
+    // The GPU and CPU times are relative to the first frame after the clock was disjoint.
+    GpuClockSync m_ClockSync;
+    bool m_HasReference;
+    uint64_t m_GpuReference;
+    int64_t m_CpuReference;
+    uint32_t m_Track;
+};
+
+// Profiles the GPU commands from construction to destruction (see GPU_PROFILE_SCOPE).
+class GpuProfileScope
+{
+public:
+    // Does nothing if the profiler is null.
+    GpuProfileScope( GpuProfiler* profiler, const char* name )
+        : m_Profiler( profiler )
+    {
+        if ( m_Profiler )
+        {
+            m_Profiler->BeginScope( name );
+        }
+    }
+
+    ~GpuProfileScope()
+    {
+        if ( m_Profiler )
+        {
+            m_Profiler->EndScope();
+        }
+    }
+
+private:
+    GpuProfileScope( const GpuProfileScope& copy );
+    GpuProfileScope& operator=( const GpuProfileScope& other );
+
+    GpuProfiler* m_Profiler;
+};
+
+#if defined(PROFILER_DISABLED)
+#define GPU_PROFILE_SCOPE( profiler, name )
+#else
+#define GPU_PROFILE_CONCAT_( a, b ) a##b
+#define GPU_PROFILE_CONCAT( a, b ) GPU_PROFILE_CONCAT_( a, b )
+#define GPU_PROFILE_SCOPE( profiler, name ) GpuProfileScope GPU_PROFILE_CONCAT( gpuProfileScope, __LINE__ )( profiler, name )
+#endif
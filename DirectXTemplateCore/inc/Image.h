@@ -0,0 +1,18 @@
+/**
+ * @brief Helper functions to write images to disk.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Write an image to an uncompressed 32-bit TGA file.
+ * @param fileName The name of the file to write.
+ * @param width The width of the image in pixels.
+ * @param height The height of the image in pixels.
+ * @param rgbaPixels width * height pixels, 4 bytes per pixel in RGBA order
+ * and the first row is the top of the image.
+ * @returns true if the file was written successfully.
+ */
+bool SaveTGA( const std::string& fileName, uint32_t width, uint32_t height, const uint8_t* rgbaPixels );
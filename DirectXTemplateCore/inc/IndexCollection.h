@@ -0,0 +1,94 @@
+/**
+ * @brief A list of vertex indices that uses the smallest index size that fits.
+ *
+ * Indices are stored as 16-bit values until an index that does not fit in 16 bits
+ * is added, at which point the collection switches to 32-bit storage. Smaller
+ * indices halve the size of the index buffer and the bandwidth needed to fetch
+ * it, so most meshes never pay for 32-bit indices.
+ *
+ * The interface follows std::vector so the collection can be used in place of a
+ * vector of indices. Elements are read by value; use set to modify an index.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class IndexCollection
+{
+public:
+    // The largest index that can be stored in 16 bits.
+    static const uint32_t MaxIndex16 = 0xFFFF;
+
+    IndexCollection();
+
+    // Copy the indices in the range [first, last).
+    template<typename InputIterator>
+    void assign( InputIterator first, InputIterator last )
+    {
+        clear();
+        for ( ; first != last; ++first )
+        {
+            push_back( static_cast<uint32_t>( *first ) );
+        }
+    }
+
+    void push_back( uint32_t index )
+    {
+        if ( m_Is32Bit )
+        {
+            m_Indices32.push_back( index );
+        }
+        else if ( index <= MaxIndex16 )
+        {
+            m_Indices16.push_back( static_cast<uint16_t>( index ) );
+        }
+        else
+        {
+            Widen();
+            m_Indices32.push_back( index );
+        }
+    }
+
+    uint32_t operator[]( size_t i ) const
+    {
+        return m_Is32Bit ? m_Indices32[i] : m_Indices16[i];
+    }
+
+    void set( size_t i, uint32_t index );
+
+    size_t size() const
+    {
+        return m_Is32Bit ? m_Indices32.size() : m_Indices16.size();
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    // Remove all indices and switch back to 16-bit storage.
+    void clear();
+    void reserve( size_t size );
+    // Resize the collection. Call Widen first if the indices will not fit in 16 bits.
+    void resize( size_t size );
+
+    // Switch to 32-bit storage.
+    void Widen();
+
+    // True if the indices are stored as 32-bit values.
+    bool get_Is32Bit() const;
+    // The size of a single index in bytes (2 or 4).
+    size_t get_IndexSize() const;
+    // The size of all indices in bytes.
+    size_t get_SizeInBytes() const;
+    // The index data (get_IndexSize() bytes per index).
+    const void* data() const;
+    void* data();
+
+private:
+    std::vector<uint16_t> m_Indices16;
+    std::vector<uint32_t> m_Indices32;
+    bool m_Is32Bit;
+};
@@ -0,0 +1,175 @@
+/**
+ * @brief A work-stealing job scheduler.
+ *
+ * Every thread of the JobSystem owns a Chase-Lev deque (WorkStealingQueue): it pushes
+ * and pops jobs at the bottom of its own deque, and idle threads steal the oldest jobs
+ * from the top of the deques of other threads. The thread that creates the JobSystem
+ * is thread 0 and takes part in the work while it waits; the other threads sleep when
+ * there is no work.
+ *
+ * Jobs report their completion to a JobCounter. Wait executes jobs until the counter
+ * reaches zero, and RunAfter starts a job when another counter reaches zero, which is
+ * how dependencies between jobs are expressed. ParallelFor splits a range of items
+ * recursively so that idle threads steal large chunks first.
+ *
+ * Jobs can only be started from the threads of the JobSystem (including jobs that
+ * start other jobs). Job functions must not throw.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Job;
+
+/**
+ * A lock-free double-ended queue of jobs with a fixed capacity (Chase and Lev, "Dynamic
+ * Circular Work-Stealing Deque", with the memory orderings of Le et al., "Correct and
+ * Efficient Work-Stealing for Weak Memory Models"). Push and Pop may only be called by
+ * the owner thread, Steal by any thread.
+ */
+class WorkStealingQueue
+{
+public:
+    // @param capacity A power of two.
+    explicit WorkStealingQueue( size_t capacity );
+
+    // Add a job at the bottom. Returns false if the queue is full.
+    bool Push( Job* job );
+    // Remove the newest job from the bottom (or return nullptr).
+    Job* Pop();
+    // Remove the oldest job from the top (or return nullptr if the queue is empty or another thread won the race).
+    Job* Steal();
+
+    // The number of jobs in the queue (only exact if no other thread uses the queue).
+    size_t Size() const;
+
+private:
+    WorkStealingQueue( const WorkStealingQueue& copy );
+    WorkStealingQueue& operator=( const WorkStealingQueue& other );
+
+    std::atomic<int64_t> m_Top;
+    std::atomic<int64_t> m_Bottom;
+    std::unique_ptr< std::atomic<Job*>[] > m_Jobs;
+    int64_t m_Mask;
+};
+
+// The number of unfinished jobs that were started with the counter.
+class JobCounter
+{
+public:
+    JobCounter();
+
+    /**
+     * Returns true if all jobs are done. Call JobSystem::Wait before the counter is
+     * destroyed: the last job may still be using the counter.
+     */
+    bool IsDone() const;
+    uint32_t get_Count() const;
+
+private:
+    friend class JobSystem;
+
+    JobCounter( const JobCounter& copy );
+    JobCounter& operator=( const JobCounter& other );
+
+    std::atomic<uint32_t> m_Count;
+    // The count only reaches zero while the mutex is locked, so the jobs that are
+    // started when the count reaches zero (see JobSystem::RunAfter) are not missed.
+    mutable std::mutex m_Mutex;
+    std::vector<Job*> m_Dependents;
+};
+
+class JobSystem
+{
+public:
+    typedef std::function<void()> JobFunction;
+    // Process the items in the range [begin, end).
+    typedef std::function<void( size_t begin, size_t end )> RangeFunction;
+
+    // The maximum number of unfinished jobs that each thread can start. Beyond that,
+    // jobs are executed immediately on the calling thread.
+    static const size_t MaxJobsPerThread = 4096;
+
+    /**
+     * Start the worker threads. The calling thread becomes thread 0.
+     * @param numThreads The number of threads including the calling thread
+     * (0 for the number of hardware threads).
+     */
+    explicit JobSystem( size_t numThreads = 0 );
+    // Wait for all jobs before the JobSystem is destroyed.
+    virtual ~JobSystem();
+
+    size_t get_NumThreads() const;
+
+    /**
+     * The index of the calling thread in [0, get_NumThreads()), or get_NumThreads()
+     * if the calling thread does not belong to the JobSystem.
+     */
+    size_t get_ThreadIndex() const;
+
+    // Start a job. The counter (optional) is incremented now and decremented when the job is done.
+    void Run( const JobFunction& function, JobCounter* counter = nullptr );
+
+    /**
+     * Start a job once the dependency reaches zero. The counter (optional) is
+     * incremented now and decremented when the job is done.
+     */
+    void RunAfter( JobCounter& dependency, const JobFunction& function, JobCounter* counter = nullptr );
+
+    // Execute jobs on the calling thread until the counter reaches zero.
+    void Wait( const JobCounter& counter );
+
+    /**
+     * Call function( begin, end ) for ranges of at most grainSize items that cover
+     * [begin, end) and return when all of them are done.
+     */
+    void ParallelFor( size_t begin, size_t end, size_t grainSize, const RangeFunction& function );
+
+    struct Statistics
+    {
+        uint64_t JobsExecuted;
+        // The number of jobs that were executed by another thread than the one that started them.
+        uint64_t JobsStolen;
+        // The number of times a worker thread went to sleep because there was no work.
+        uint64_t Sleeps;
+    };
+
+    // The statistics of all threads since the JobSystem was created or the statistics were reset.
+    Statistics get_Statistics() const;
+    void ResetStatistics();
+
+private:
+    JobSystem( const JobSystem& copy );
+    JobSystem& operator=( const JobSystem& other );
+
+    struct ThreadData;
+
+    // The data of the calling thread (throws if the thread does not belong to the JobSystem).
+    ThreadData& GetThreadData() const;
+    Job* AllocateJob( ThreadData& threadData );
+    void Push( Job* job, ThreadData& threadData );
+    // Get a job from the own deque or steal one from another thread.
+    Job* FindJob( ThreadData& threadData );
+    void Execute( Job* job, ThreadData& threadData );
+    void ExecuteRange( const RangeFunction& function, size_t begin, size_t end, size_t grainSize, JobCounter* counter, ThreadData& threadData );
+    void Finish( JobCounter* counter, ThreadData& threadData );
+    void WorkerThread( size_t index );
+
+    std::vector< std::unique_ptr<ThreadData> > m_ThreadData;
+    std::vector<std::thread> m_Threads;
+
+    // Sleeping worker threads wait for m_WakeGeneration to change.
+    std::mutex m_WakeMutex;
+    std::condition_variable m_WakeCondition;
+    uint64_t m_WakeGeneration;
+    std::atomic<uint32_t> m_NumSleeping;
+    bool m_Quit;
+};
@@ -0,0 +1,150 @@
+/**
+ * @brief Clustered forward light culling.
+ *
+ * The view frustum is split into NumTilesX x NumTilesY screen tiles and NumSlices
+ * depth slices. The depth of the slices grows exponentially from the near to the far
+ * plane so that the clusters ("froxels") are roughly as deep as they are wide.
+ * AssignLights finds the clusters that the view-space bounding sphere of each light
+ * intersects and builds a single list of light indices in which the lights of every
+ * cluster are contiguous. The clusters and the index list are uploaded to structured
+ * buffers, and the pixel shader only shades the lights of the cluster of the pixel
+ * (see TexturedLitPixelShader.hlsl).
+ *
+ * A light is in a cluster if its sphere intersects the two planes of the tile column,
+ * the two planes of the tile row and the view-space box of the cluster. The
+ * assignment first computes the range of clusters of Simd::Width lights at a time.
+ * Then every slice tests its lights against Simd::Width clusters of a row at a time,
+ * and the slices run in parallel on a JobSystem (optional).
+ */
+#pragma once
+
+#include <BoundingVolumes.h>
+#include <Camera.h>
+#include <Lighting.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// The lights of a cluster are LightIndices[Offset, Offset + Count).
+struct LightCluster
+{
+    uint32_t Offset;
+    uint32_t Count;
+};
+
+/**
+ * The distance at which the attenuation of a point or spot light falls below
+ * threshold (infinite for a directional light or a light that is never that dim).
+ */
+float AttenuationRange( const Light& light, float threshold = 1.0f / 256.0f );
+
+/**
+ * The bounding sphere of the lit volume of a light (Light::Range around a point
+ * light, or the cone of a spot light). The radius is infinite for a directional light.
+ */
+BoundingSphere LightBounds( const Light& light );
+
+class LightClusters
+{
+public:
+    // The maximum number of tiles in each direction and of slices.
+    static const uint32_t MaxTiles = 1024;
+
+    LightClusters( uint32_t numTilesX = 16, uint32_t numTilesY = 9, uint32_t numSlices = 24 );
+
+    uint32_t get_NumTilesX() const;
+    uint32_t get_NumTilesY() const;
+    uint32_t get_NumSlices() const;
+    uint32_t get_NumClusters() const;
+
+    /**
+     * Set the left-handed perspective projection whose frustum is split
+     * (see Camera::set_Projection).
+     * @param fovy The vertical field of view in degrees.
+     */
+    void SetProjection( float fovy, float aspect, float zNear, float zFar );
+    void SetProjection( const Camera& camera );
+
+    /**
+     * Assign lights to the clusters.
+     * @param lights The view-space bounding spheres of the lights. A light with an
+     * infinite radius is added to every cluster.
+     * @param jobSystem Process the lights and the slices in parallel (optional).
+     * Call AssignLights from a thread of the JobSystem.
+     */
+    void AssignLights( const BoundingSphereArrays& lights, JobSystem* jobSystem = nullptr );
+
+    // The clusters, ordered by slice, row (top to bottom) and column (left to right).
+    const std::vector<LightCluster>& get_Clusters() const;
+    // The light indices of the clusters. The lights of a cluster are in ascending order.
+    const std::vector<uint32_t>& get_LightIndices() const;
+
+    uint32_t GetClusterIndex( uint32_t x, uint32_t y, uint32_t slice ) const;
+    // The slice of a view-space depth (clamped to the slices).
+    uint32_t GetSlice( float depth ) const;
+    // The view-space box of a cluster.
+    BoundingBox GetClusterBounds( uint32_t clusterIndex ) const;
+    // Returns true if a view-space sphere is in a cluster (the test of AssignLights).
+    bool Intersects( const BoundingSphere& sphere, uint32_t clusterIndex ) const;
+
+    // The constants that the pixel shader uses to find the cluster of a pixel.
+    ClusterConstants GetConstants( const Viewport& viewport ) const;
+
+    // The memory used by the clusters, the index list and the work arrays in bytes.
+    size_t get_MemoryUsage() const;
+
+private:
+    LightClusters( const LightClusters& copy );
+    LightClusters& operator=( const LightClusters& other );
+
+    // The clusters that a light may intersect (empty if MinSlice > MaxSlice).
+    struct LightRange
+    {
+        uint16_t MinX, MaxX;
+        uint16_t MinY, MaxY;
+        uint16_t MinSlice, MaxSlice;
+    };
+
+    // A light of a cluster of a slice, before the lists are compacted.
+    struct ClusterLight
+    {
+        uint32_t Cluster;
+        uint32_t Light;
+    };
+
+    void ComputeLightRanges( const BoundingSphereArrays& lights, size_t begin, size_t end );
+    void AssignSlice( const BoundingSphereArrays& lights, uint32_t slice );
+    void CompactSlice( uint32_t slice );
+
+    uint32_t m_NumTilesX;
+    uint32_t m_NumTilesY;
+    uint32_t m_NumSlices;
+
+    float m_zNear;
+    float m_zFar;
+    // slice = log2( depth ) * m_SliceScale + m_SliceBias
+    float m_SliceScale;
+    float m_SliceBias;
+
+    // The planes between the tiles go through the eye. The signed distance of a point
+    // to plane k is x * m_PlaneX[k] + z * m_PlaneXZ[k] (columns) or
+    // y * m_PlaneY[k] + z * m_PlaneYZ[k] (rows), and is positive on the side of the
+    // tiles with the larger index. The arrays are padded with Simd::Width floats.
+    std::vector<float> m_PlaneX, m_PlaneXZ;
+    std::vector<float> m_PlaneY, m_PlaneYZ;
+
+    // The view-space boxes of the clusters: the depth range of each slice, and the
+    // ranges of each column and row in each slice (padded like the planes).
+    std::vector<float> m_SliceDepths;
+    std::vector<float> m_ColumnMin, m_ColumnMax;
+    std::vector<float> m_RowMin, m_RowMax;
+
+    std::vector<LightRange> m_LightRanges;
+    std::vector< std::vector<ClusterLight> > m_SliceLights;
+
+    std::vector<LightCluster> m_Clusters;
+    std::vector<uint32_t> m_LightIndices;
+};
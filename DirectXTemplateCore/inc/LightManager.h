@@ -0,0 +1,135 @@
+/**
+ * @brief A store of lights with stable handles and incremental uploads.
+ *
+ * The lights are stored as structure-of-arrays and are packed: the lights are
+ * always at indices [0, get_NumLights()) in the order of the light buffer that the
+ * shaders read (StructuredBuffer<Light>). Removing a light moves the last light
+ * into its place, so the index of a light may change, but its LightHandle does not.
+ *
+ * Every change marks the index of the light as dirty. GetDirtyRanges returns the
+ * sorted ranges of dirty lights, and WriteLights writes the Light structs of a range,
+ * so only the lights that changed since the last ClearDirty are uploaded (see
+ * LightBuffer in the DirectXTemplateLib). A scene with many static lights only
+ * uploads the lights that move.
+ */
+#pragma once
+
+#include <BoundingVolumes.h>
+#include <Lighting.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A zero-initialized handle is not a valid handle.
+struct LightHandle
+{
+    // The slot of the light in the handle table.
+    uint32_t Slot;
+    // Incremented every time the slot is reused, so an old handle is not valid for the new light.
+    uint32_t Generation;
+};
+
+class LightManager
+{
+public:
+    // A range of lights that changed: [Offset, Offset + Count).
+    struct DirtyRange
+    {
+        uint32_t Offset;
+        uint32_t Count;
+    };
+
+    LightManager();
+
+    LightHandle Add( const Light& light );
+    void Remove( LightHandle handle );
+    // Remove all of the lights. All handles become invalid.
+    void Clear();
+
+    bool IsValid( LightHandle handle ) const;
+    uint32_t get_NumLights() const;
+    // The number of enabled lights of a type (kept up to date by every change).
+    uint32_t GetNumEnabledLights( LightType type ) const;
+
+    // The index of a light in the light buffer. The index changes when another light is removed.
+    uint32_t GetIndex( LightHandle handle ) const;
+
+    Light Get( LightHandle handle ) const;
+    // The light at an index of the light buffer.
+    Light GetAt( uint32_t index ) const;
+
+    void Set( LightHandle handle, const Light& light );
+    void SetPosition( LightHandle handle, const Math::Float3& position );
+    // @param direction A unit vector.
+    void SetDirection( LightHandle handle, const Math::Float3& direction );
+    void SetColor( LightHandle handle, const Math::Float4& color );
+    void SetEnabled( LightHandle handle, bool enabled );
+    // The light is only marked as dirty if the index changed.
+    void SetShadowIndex( LightHandle handle, int shadowIndex );
+
+    /**
+     * The bounding spheres of the lit volumes of the lights (see LightBounds),
+     * transformed by a matrix (the view matrix for LightClusters::AssignLights).
+     */
+    void ComputeBounds( const Math::Float4x4& matrix, BoundingSphereArrays& bounds ) const;
+
+    /**
+     * The sorted ranges of the lights that changed since the last ClearDirty.
+     * @param mergeDistance Ranges that are separated by at most mergeDistance clean
+     * lights are merged, since uploading a few clean lights is cheaper than another copy.
+     */
+    void GetDirtyRanges( std::vector<DirtyRange>& ranges, uint32_t mergeDistance = 4 ) const;
+    // The number of lights that changed since the last ClearDirty.
+    uint32_t get_NumDirtyLights() const;
+
+    // Write the Light structs of the lights [offset, offset + count) to destination.
+    void WriteLights( uint32_t offset, uint32_t count, Light* destination ) const;
+
+    // Call after the dirty lights have been uploaded.
+    void ClearDirty();
+    // Mark every light as dirty (for example after the light buffer was created again).
+    void MarkAllDirty();
+
+private:
+    LightManager( const LightManager& copy );
+    LightManager& operator=( const LightManager& other );
+
+    struct Slot
+    {
+        // The index of the light, or InvalidIndex if the slot is free.
+        uint32_t Index;
+        uint32_t Generation;
+    };
+
+    static const uint32_t InvalidIndex = UINT32_MAX;
+
+    void MarkDirty( uint32_t index );
+    // Add a light to the counts of the enabled lights (count is 1 or -1).
+    void CountLight( int lightType, int enabled, int count );
+
+    std::vector<Slot> m_Slots;
+    std::vector<uint32_t> m_FreeSlots;
+    // The slot of each light.
+    std::vector<uint32_t> m_LightSlots;
+
+    // The lights as structure-of-arrays.
+    std::vector<Math::Float4> m_Positions;
+    std::vector<Math::Float4> m_Directions;
+    std::vector<Math::Float4> m_Colors;
+    std::vector<float> m_SpotAngles;
+    std::vector<float> m_ConstantAttenuations;
+    std::vector<float> m_LinearAttenuations;
+    std::vector<float> m_QuadraticAttenuations;
+    std::vector<float> m_Ranges;
+    std::vector<int> m_LightTypes;
+    std::vector<int> m_Enabled;
+    std::vector<int> m_ShadowIndices;
+
+    uint32_t m_NumEnabledLights[LightTypeCount];
+
+    // A flag for every light and the list of the dirty lights (unsorted).
+    std::vector<uint8_t> m_DirtyFlags;
+    std::vector<uint32_t> m_DirtyLights;
+    bool m_AllDirty;
+};
@@ -0,0 +1,146 @@
+/**
+ * @brief The material and light structures used by the TexturedLitPixelShader.
+ *
+ * The layout of these structures must match the constant buffers and structured
+ * buffers declared in TexturedLitPixelShader.hlsl. LightProperties is the fixed
+ * array of lights of the SoftwareRasterizer; the pixel shader reads the lights of
+ * its cluster from a StructuredBuffer<Light> (see LightClusters.h).
+ */
+#pragma once
+
+#include <CoreMath.h>
+
+#include <cfloat>
+
+#define MAX_LIGHTS 8
+
+struct _Material
+{
+    _Material() 
+        : Emissive( 0.0f, 0.0f, 0.0f, 1.0f )
+        , Ambient( 0.1f, 0.1f, 0.1f, 1.0f )
+        , Diffuse( 1.0f, 1.0f, 1.0f, 1.0f )
+        , Specular( 1.0f, 1.0f, 1.0f, 1.0f )
+        , SpecularPower( 128.0f )
+        , UseTexture( false )
+    {}
+
+    Math::Float4   Emissive;
+    //----------------------------------- (16 byte boundary)
+    Math::Float4   Ambient;
+    //----------------------------------- (16 byte boundary)
+    Math::Float4   Diffuse;
+    //----------------------------------- (16 byte boundary)
+    Math::Float4   Specular;
+    //----------------------------------- (16 byte boundary)
+    float               SpecularPower;
+    // Add some padding complete the 16 byte boundary.
+    int                 UseTexture;
+    // Add some padding to complete the 16 byte boundary.
+    float                 Padding[2];
+    //----------------------------------- (16 byte boundary)
+}; // Total:                                80 bytes (5 * 16)
+
+struct MaterialProperties
+{
+    _Material   Material;
+};
+
+enum LightType
+{
+    DirectionalLight    = 0,
+    PointLight          = 1,
+    SpotLight           = 2,
+    LightTypeCount      = 3
+};
+
+struct Light
+{
+    Light()
+        : Position( 0.0f, 0.0f, 0.0f, 1.0f )
+        , Direction( 0.0f, 0.0f, 1.0f, 0.0f )
+        , Color( 1.0f, 1.0f, 1.0f, 1.0f )
+        , SpotAngle( Math::PiDiv2 )
+        , ConstantAttenuation( 1.0f )
+        , LinearAttenuation( 0.0f )
+        , QuadraticAttenuation( 0.0f )
+        , LightType( DirectionalLight )
+        , Enabled( 0 )
+        , Range( FLT_MAX )
+        , ShadowIndex( -1 )
+    {}
+
+    Math::Float4    Position;
+    //----------------------------------- (16 byte boundary)
+    Math::Float4    Direction;
+    //----------------------------------- (16 byte boundary)
+    Math::Float4    Color;
+    //----------------------------------- (16 byte boundary)
+    float       SpotAngle;
+    float       ConstantAttenuation;
+    float       LinearAttenuation;
+    float       QuadraticAttenuation;
+    //----------------------------------- (16 byte boundary)
+    int         LightType;
+    int         Enabled;
+    // The distance beyond which the light has no effect (see AttenuationRange).
+    float       Range;
+    // The index of the first shadow map of the light in the shadow map buffer, or -1 (see ShadowMaps.h).
+    int         ShadowIndex;
+    //----------------------------------- (16 byte boundary)
+};  // Total:                              80 bytes ( 5 * 16 )
+
+struct LightProperties
+{
+    LightProperties()
+        : EyePosition( 0.0f, 0.0f, 0.0f, 1.0f )
+        , GlobalAmbient( 0.2f, 0.2f, 0.8f, 1.0f )
+    {}
+
+    Math::Float4   EyePosition;
+    //----------------------------------- (16 byte boundary)
+    Math::Float4   GlobalAmbient;
+    //----------------------------------- (16 byte boundary)
+    Light               Lights[MAX_LIGHTS]; // 80 * 8 bytes
+};  // Total:                                  672 bytes (42 * 16)
+
+// The constants that the pixel shader uses to find the cluster of a pixel (see LightClusters::GetConstants).
+struct ClusterConstants
+{
+    // tile = SV_Position.xy * TileScale + TileBias
+    float       TileScaleX;
+    float       TileScaleY;
+    float       TileBiasX;
+    float       TileBiasY;
+    //----------------------------------- (16 byte boundary)
+    // slice = log2( view-space depth ) * SliceScale + SliceBias
+    float       SliceScale;
+    float       SliceBias;
+    int         NumTilesX;
+    int         NumTilesY;
+    //----------------------------------- (16 byte boundary)
+    int         NumSlices;
+    // Add some padding to make this struct size a multiple of 16 bytes.
+    int         Padding[3];
+    //----------------------------------- (16 byte boundary)
+};  // Total:                              48 bytes ( 3 * 16 )
+
+struct ClusteredLightProperties
+{
+    ClusteredLightProperties()
+        : EyePosition( 0.0f, 0.0f, 0.0f, 1.0f )
+        , GlobalAmbient( 0.2f, 0.2f, 0.8f, 1.0f )
+        , Clusters()
+    {}
+
+    Math::Float4   EyePosition;
+    //----------------------------------- (16 byte boundary)
+    Math::Float4   GlobalAmbient;
+    //----------------------------------- (16 byte boundary)
+    ClusterConstants    Clusters;           // 48 bytes
+};  // Total:                                  80 bytes (5 * 16)
+
+static_assert( sizeof(_Material) == 80, "The _Material struct must match the layout in TexturedLitPixelShader.hlsl" );
+static_assert( sizeof(Light) == 80, "The Light struct must match the layout in TexturedLitPixelShader.hlsl" );
+static_assert( sizeof(LightProperties) == 672, "The LightProperties struct must match the layout in SoftwareRasterizer.h" );
+static_assert( sizeof(ClusteredLightProperties) == 80, "The ClusteredLightProperties struct must match the layout in TexturedLitPixelShader.hlsl" );
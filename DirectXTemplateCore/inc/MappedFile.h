@@ -0,0 +1,40 @@
+/**
+ * @brief A read-only memory-mapped file.
+ *
+ * The contents of the file are mapped into the address space of the process
+ * so they can be read in place without copying them into a buffer first. The
+ * pages are read from disk (or the file cache) on first access.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    /**
+     * Map a file. A file that is already mapped is closed first.
+     * @returns false if the file does not exist, is empty or cannot be mapped.
+     */
+    bool Open( const std::string& fileName );
+    void Close();
+
+    bool get_IsOpen() const;
+    // The contents of the file (the address is aligned to the page size).
+    const uint8_t* get_Data() const;
+    size_t get_Size() const;
+
+private:
+    MappedFile( const MappedFile& );
+    MappedFile& operator=( const MappedFile& );
+
+    const uint8_t* m_Data;
+    size_t m_Size;
+    // The handle of the file mapping (only used on Windows).
+    void* m_MappingHandle;
+};
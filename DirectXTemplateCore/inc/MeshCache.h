@@ -0,0 +1,195 @@
+/**
+ * @brief A binary file format and an on-disk cache for GPU-ready meshes.
+ *
+ * A mesh file stores the streams of a mesh exactly as they are uploaded to the
+ * GPU: the (possibly encoded) vertex stream, the 16-bit or 32-bit index stream,
+ * the submesh table, the LOD table, the meshlet table, the vertex layout and the
+ * bounds. Every section starts at a 16-byte aligned offset:
+ *
+ *   MeshFileHeader | vertices | indices | submeshes | LODs | meshlets
+ *
+ * MeshFile memory-maps a file and exposes pointers into the mapping, so the
+ * streams can be passed to the buffer creation functions without copying them.
+ *
+ * MeshCache stores the mesh files in a directory under a name that is derived
+ * from a MeshCacheKey: a hash of the name and the parameters of the generator.
+ * Files with an unknown version or an invalid layout are treated as cache misses.
+ */
+#pragma once
+
+#include <BoundingVolumes.h>
+#include <Geometry.h>
+#include <MappedFile.h>
+#include <Meshlets.h>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// The vertex type of the vertex stream (the values match Mesh::VertexFormat).
+enum MeshVertexLayout
+{
+    // VertexPositionNormalTexture
+    MeshVertexLayoutFullPrecision,
+    // VertexPositionNormalTextureHalf
+    MeshVertexLayoutHalfPrecision,
+    // VertexPositionNormalTextureQuantized
+    MeshVertexLayoutQuantized,
+    MeshVertexLayoutCount,
+};
+
+// The size of a vertex of a layout in bytes.
+uint32_t GetVertexStride( MeshVertexLayout layout );
+
+/**
+ * The streams of a mesh. MeshData does not own the memory it points to.
+ */
+struct MeshData
+{
+    MeshVertexLayout VertexLayout;
+    uint32_t VertexStride;
+    uint32_t VertexCount;
+    const void* Vertices;
+
+    // The size of an index in bytes (2 or 4).
+    uint32_t IndexSize;
+    uint32_t IndexCount;
+    const void* Indices;
+
+    uint32_t SubMeshCount;
+    const SubMesh* SubMeshes;
+
+    // The index ranges of the levels of detail (none if the mesh has no LODs).
+    uint32_t LodCount;
+    const MeshLod* Lods;
+
+    // The meshlets of the first LOD (none if the mesh was not split into meshlets).
+    uint32_t MeshletCount;
+    const Meshlet* Meshlets;
+
+    // The bounds of the mesh in object space.
+    BoundingBox Box;
+    BoundingSphere Sphere;
+};
+
+struct MeshFileHeader
+{
+    // The file identifier 'DXTM'.
+    uint32_t Magic;
+    uint32_t Version;
+
+    uint32_t VertexLayout;
+    uint32_t VertexStride;
+    uint32_t VertexCount;
+    uint32_t IndexSize;
+    uint32_t IndexCount;
+    uint32_t SubMeshCount;
+    uint32_t LodCount;
+    uint32_t MeshletCount;
+
+    BoundingBox Box;
+    BoundingSphere Sphere;
+
+    // The offsets of the sections from the start of the file (multiples of 16).
+    uint64_t VerticesOffset;
+    uint64_t IndicesOffset;
+    uint64_t SubMeshesOffset;
+    uint64_t LodsOffset;
+    uint64_t MeshletsOffset;
+    uint64_t FileSize;
+
+    static const uint32_t FileMagic = 0x4D545844;
+    // Increment the version when the layout of the file or the meaning of its
+    // contents changes. Files with another version are never loaded.
+    static const uint32_t FileVersion = 3;
+    static const uint32_t SectionAlignment = 16;
+};
+
+/**
+ * Write a mesh file. The file is written under a temporary name and renamed when
+ * it is complete so a reader never maps a partially written file.
+ * @returns true if the file was written successfully.
+ */
+bool WriteMeshFile( const std::string& fileName, const MeshData& mesh );
+
+/**
+ * A memory-mapped mesh file. The pointers in the MeshData are valid while the
+ * file is open.
+ */
+class MeshFile
+{
+public:
+    MeshFile();
+
+    /**
+     * Map and validate a mesh file.
+     * @returns false if the file does not exist, has another version or is invalid.
+     */
+    bool Open( const std::string& fileName );
+    void Close();
+
+    bool get_IsOpen() const;
+    const MeshData& get_MeshData() const;
+
+private:
+    MappedFile m_File;
+    MeshData m_MeshData;
+};
+
+/**
+ * Identifies a generated mesh by the name of its generator and the values of
+ * its parameters. Add every parameter that changes the generated mesh.
+ */
+class MeshCacheKey
+{
+public:
+    explicit MeshCacheKey( const std::string& generator );
+
+    template<typename T>
+    MeshCacheKey& Add( T value )
+    {
+        static_assert( std::is_arithmetic<T>::value || std::is_enum<T>::value, "Only numbers can be added to a cache key." );
+        // Normalize -0 to 0 so that equal values have the same hash.
+        if ( value == T( 0 ) ) value = T( 0 );
+        Hash( &value, sizeof( value ) );
+        return *this;
+    }
+
+    uint64_t get_Hash() const;
+    // The name of the cache file: <generator>-<hash>.mesh
+    std::string get_FileName() const;
+
+private:
+    // 64-bit FNV-1a.
+    void Hash( const void* data, size_t size );
+
+    std::string m_Generator;
+    uint64_t m_Hash;
+};
+
+class MeshCache
+{
+public:
+    /**
+     * @param directory The directory of the cache files. It must exist.
+     * An empty string uses the current directory.
+     */
+    explicit MeshCache( const std::string& directory );
+
+    /**
+     * Open the cache file of a key.
+     * @returns false on a cache miss.
+     */
+    bool Load( const MeshCacheKey& key, MeshFile& file ) const;
+    /**
+     * Write the cache file of a key.
+     * @returns false if the file could not be written.
+     */
+    bool Store( const MeshCacheKey& key, const MeshData& mesh ) const;
+
+    // The full path of the cache file of a key.
+    std::string get_FileName( const MeshCacheKey& key ) const;
+
+private:
+    std::string m_Directory;
+};
@@ -0,0 +1,79 @@
+/**
+ * @brief Reorder the triangles and vertices of a mesh to render faster.
+ *
+ * OptimizeMesh runs three passes that are usually applied in this order when a
+ * mesh is generated or loaded:
+ *  1. OptimizeVertexCache reorders the triangles so that vertices are reused
+ *     while they are still in the post-transform vertex cache (Forsyth).
+ *  2. OptimizeOverdraw reorders clusters of triangles so that the triangles that
+ *     face outward are drawn first, which lets the depth test reject more of the
+ *     hidden pixels, without giving up much of the vertex cache efficiency.
+ *  3. OptimizeVertexFetch reorders the vertices in the order in which they are
+ *     first used so that the vertex buffer is read linearly.
+ *
+ * AnalyzeVertexCache simulates a FIFO or LRU post-transform cache on the CPU to
+ * measure the ACMR (average cache miss ratio: vertices transformed per triangle)
+ * and the ATVR (average transform to vertex ratio: vertices transformed per vertex).
+ */
+#pragma once
+
+#include <Geometry.h>
+
+#include <cstddef>
+
+namespace VertexCache
+{
+    enum Type
+    {
+        // Cache hits do not change the order of the cache (most GPUs).
+        FIFO,
+        // Cache hits move the vertex to the front of the cache.
+        LRU,
+    };
+
+    struct Statistics
+    {
+        // The number of vertices that were transformed (cache misses).
+        size_t VerticesTransformed;
+        size_t Triangles;
+        // The number of distinct vertices that are referenced by the indices.
+        size_t Vertices;
+
+        // Vertices transformed per triangle: 3 is the worst case, 0.5 is the best
+        // case for large regular meshes.
+        float ACMR;
+        // Vertices transformed per vertex: 1 is optimal.
+        float ATVR;
+    };
+}
+
+/**
+ * Simulate a post-transform vertex cache.
+ * @param vertexCount The number of vertices in the vertex buffer.
+ * @param cacheSize The number of vertices in the cache.
+ */
+VertexCache::Statistics AnalyzeVertexCache( const IndexCollection& indices, size_t vertexCount, size_t cacheSize = 16, VertexCache::Type cacheType = VertexCache::FIFO );
+
+/**
+ * Reorder the triangles to improve the hit rate of the post-transform vertex cache.
+ * The algorithm does not depend on the exact cache size or type.
+ */
+void OptimizeVertexCache( IndexCollection& indices, size_t vertexCount );
+
+/**
+ * Reorder the triangles to reduce overdraw. The indices should already be optimized
+ * for the vertex cache: the triangles are kept in clusters that are sorted so that
+ * the clusters facing away from the center of the mesh are drawn first.
+ * @param threshold The largest allowed increase of the ACMR (1.05 allows the ACMR
+ * to get 5% worse). Higher values make smaller clusters that can be sorted better.
+ */
+void OptimizeOverdraw( IndexCollection& indices, const VertexCollection& vertices, float threshold = 1.05f );
+
+/**
+ * Reorder the vertices in the order in which they are first referenced by the
+ * indices and remap the indices. Vertices that are not referenced are removed.
+ */
+void OptimizeVertexFetch( VertexCollection& vertices, IndexCollection& indices );
+
+// Run all three optimization passes.
+void OptimizeMesh( VertexCollection& vertices, IndexCollection& indices );
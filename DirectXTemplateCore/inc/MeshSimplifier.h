@@ -0,0 +1,57 @@
+/**
+ * @brief Simplify meshes and select a level of detail by screen-space error.
+ *
+ * SimplifyMesh removes triangles by collapsing edges in the order of the
+ * quadric error metric (Garland and Heckbert). An edge is always collapsed onto
+ * one of its vertices, so a simplified mesh only references vertices of the
+ * original mesh and all levels of detail can share one vertex buffer.
+ *
+ * Vertices on the border of the mesh and on attribute seams (vertices with the
+ * same position but another normal or texture coordinate) are never moved, so
+ * the silhouette of open meshes and the texture mapping stay intact.
+ *
+ * GenerateLods appends a chain of simplified index ranges to the indices of a
+ * mesh. SelectLod picks the coarsest LOD whose error projects to less than a
+ * number of pixels on the screen.
+ */
+#pragma once
+
+#include <BoundingVolumes.h>
+#include <Camera.h>
+#include <Geometry.h>
+
+#include <cstddef>
+
+/**
+ * Simplify a mesh.
+ * @param destination The indices of the simplified mesh (over the same vertices).
+ * @param targetIndexCount Stop when the mesh has this number of indices or less.
+ * @param targetError Do not collapse edges that move the surface further than this
+ * distance in object space.
+ * @param resultError If not null, receives the largest distance of the simplified
+ * surface from the original surface that was estimated by the error metric.
+ */
+void SimplifyMesh( const VertexCollection& vertices, const IndexCollection& indices, IndexCollection& destination,
+                   size_t targetIndexCount, float targetError, float* resultError = nullptr );
+
+/**
+ * Generate a chain of LODs. The indices of the LODs are appended to indices; the
+ * first LOD is the original mesh. Each LOD is simplified from the original mesh
+ * and optimized for the vertex cache.
+ * @param maxLods The largest number of LODs including the original mesh.
+ * @param reduction The fraction of the triangles of the previous LOD to keep.
+ * The chain stops early when the mesh cannot be reduced any further.
+ */
+void GenerateLods( const VertexCollection& vertices, IndexCollection& indices, MeshLodCollection& lods,
+                   size_t maxLods = 4, float reduction = 0.5f );
+
+/**
+ * Select the coarsest LOD whose error is smaller than maxPixelError pixels when it
+ * is drawn with a camera.
+ * @param worldSphere The bounding sphere of the mesh in world space.
+ * @param worldScale The scale from object space to world space (LOD errors are
+ * stored in object space).
+ * @returns The index of the LOD (0 if the camera is inside the bounding sphere).
+ */
+size_t SelectLod( const MeshLodCollection& lods, const Camera& camera, const BoundingSphere& worldSphere,
+                  float worldScale, float maxPixelError = 1.0f );
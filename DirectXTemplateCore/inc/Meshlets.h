@@ -0,0 +1,124 @@
+/**
+ * @brief Split meshes into small clusters of triangles (meshlets) and cull them on the CPU.
+ *
+ * BuildMeshlets reorders the triangles of a mesh so that every meshlet is a
+ * contiguous range of the index buffer with at most MaxMeshletVertices vertices
+ * and MaxMeshletTriangles triangles. The triangles of a meshlet are grown from a
+ * seed triangle over shared vertices and preferably in the direction of the
+ * normals of the meshlet, which keeps both the bounding sphere and the normal cone
+ * of the meshlet tight.
+ *
+ * CullMeshlets removes the meshlets that are outside of the view frustum or that
+ * only contain back-facing triangles (using the normal cone) before they are
+ * drawn. GetIndexRanges merges the index ranges of the visible meshlets that are
+ * adjacent in the index buffer so they can be drawn with fewer draw calls.
+ */
+#pragma once
+
+#include <BoundingVolumes.h>
+#include <Frustum.h>
+#include <Geometry.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The limits of a meshlet (the limits of the mesh shaders of current GPUs).
+const size_t MaxMeshletVertices = 64;
+const size_t MaxMeshletTriangles = 124;
+
+struct Meshlet
+{
+    uint32_t StartIndex;
+    uint32_t IndexCount;
+    // The number of distinct vertices that are referenced by the meshlet.
+    uint32_t VertexCount;
+
+    // The bounding sphere of the meshlet in object space.
+    BoundingSphere Sphere;
+
+    /**
+     * The normal cone of the meshlet: the normals of all triangles are within
+     * acos( sqrt( 1 - ConeCutoff^2 ) ) of ConeAxis. A cutoff of 1 means that the
+     * normals are spread too far and the meshlet is never back-face culled.
+     */
+    Math::Float3 ConeAxis;
+    float ConeCutoff;
+};
+
+typedef std::vector<Meshlet> MeshletCollection;
+
+// The culling data of meshlets in structure-of-arrays layout.
+struct MeshletBoundsArrays
+{
+    BoundingSphereArrays Spheres;
+    std::vector<float> ConeAxisX;
+    std::vector<float> ConeAxisY;
+    std::vector<float> ConeAxisZ;
+    std::vector<float> ConeCutoff;
+
+    void Add( const Meshlet& meshlet )
+    {
+        Spheres.Add( meshlet.Sphere );
+        ConeAxisX.push_back( meshlet.ConeAxis.x );
+        ConeAxisY.push_back( meshlet.ConeAxis.y );
+        ConeAxisZ.push_back( meshlet.ConeAxis.z );
+        ConeCutoff.push_back( meshlet.ConeCutoff );
+    }
+
+    size_t Size() const
+    {
+        return ConeCutoff.size();
+    }
+
+    void Clear()
+    {
+        Spheres.Clear();
+        ConeAxisX.clear();
+        ConeAxisY.clear();
+        ConeAxisZ.clear();
+        ConeCutoff.clear();
+    }
+};
+
+// A range of the index buffer that is drawn with a single draw call.
+struct IndexRange
+{
+    uint32_t StartIndex;
+    uint32_t IndexCount;
+};
+
+typedef std::vector<IndexRange> IndexRangeCollection;
+
+/**
+ * Split a mesh into meshlets. The triangles are reordered so that the triangles
+ * of each meshlet are contiguous; the vertices are not changed. Run
+ * OptimizeVertexCache (see MeshOptimizer.h) first: the seed triangles are taken
+ * in the order of the index buffer.
+ */
+void BuildMeshlets( const VertexCollection& vertices, IndexCollection& indices, MeshletCollection& meshlets,
+                    size_t maxVertices = MaxMeshletVertices, size_t maxTriangles = MaxMeshletTriangles );
+
+/**
+ * Returns true if all triangles of a meshlet face away from the eye.
+ * @param eye The position of the camera in the space of the meshlet.
+ */
+bool IsBackFacing( const Meshlet& meshlet, const Math::Float3& eye );
+
+/**
+ * Cull meshlets against a view frustum and the position of the camera.
+ * Cull in object space: extract the frustum from the world-view-projection matrix
+ * and transform the position of the camera by the inverse world matrix. Whether a
+ * triangle faces the camera does not change under an affine transform.
+ * @param visibleIndices The indices of the visible meshlets (in ascending order).
+ * @returns The number of visible meshlets.
+ */
+size_t CullMeshlets( const MeshletBoundsArrays& bounds, const Frustum& frustum, const Math::Float3& eye,
+                     std::vector<uint32_t>& visibleIndices );
+
+/**
+ * Get the index ranges of the visible meshlets. Ranges that are adjacent in the
+ * index buffer are merged.
+ * @returns The number of indices in the ranges.
+ */
+size_t GetIndexRanges( const MeshletCollection& meshlets, const std::vector<uint32_t>& visibleIndices, IndexRangeCollection& ranges );
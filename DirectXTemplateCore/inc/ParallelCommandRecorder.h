@@ -0,0 +1,113 @@
+/**
+ * @brief Record the draw calls of a frame on several threads and submit them in a fixed order.
+ *
+ * Each recording thread owns a CommandRecorder (a deferred context in Direct3D 11,
+ * see D3D11CommandRecorder in the DirectXTemplateLib). The items of a frame (for
+ * example the sorted draw commands of a RenderQueue) are split into contiguous
+ * ranges, one command list per range. The ranges are recorded in parallel and the
+ * command lists are executed in the order of the ranges, so the result does not
+ * depend on which thread finishes first.
+ *
+ * The recording function only sees the RenderContext interface so the partitioning
+ * and ordering can be verified with a recording mock (see ParallelRecordingTest).
+ */
+#pragma once
+
+#include <RenderContext.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Records commands into a command list that is executed later on the submitting thread.
+class CommandRecorder
+{
+public:
+    virtual ~CommandRecorder() {}
+
+    /**
+     * Start a new command list. Deferred contexts do not inherit any state, so this
+     * is the place to bind the render targets and the viewport.
+     */
+    virtual void BeginCommandList() = 0;
+
+    // The render context that records the commands of the current command list.
+    virtual RenderContext& get_RenderContext() = 0;
+
+    // Close the current command list. The state of the render context is reset.
+    virtual void FinishCommandList() = 0;
+
+    // Execute the finished command list and release it (only on the submitting thread).
+    virtual void ExecuteCommandList() = 0;
+};
+
+class ParallelCommandRecorder
+{
+public:
+    /**
+     * Record the items in the range [begin, end) to the render context.
+     * Called concurrently for disjoint ranges.
+     */
+    typedef std::function<void( RenderContext& renderContext, size_t begin, size_t end )> RecordFunction;
+
+    /**
+     * @param recorders The recorders (not owned). One thread is started for each
+     * recorder except the first, which records on the thread that calls Record.
+     * @param minItemsPerCommandList Fewer command lists are recorded if the ranges
+     * would be smaller (every command list has a fixed cost).
+     */
+    explicit ParallelCommandRecorder( const std::vector<CommandRecorder*>& recorders, size_t minItemsPerCommandList = 64 );
+    virtual ~ParallelCommandRecorder();
+
+    size_t get_NumRecorders() const;
+
+    size_t get_MinItemsPerCommandList() const;
+    void set_MinItemsPerCommandList( size_t minItemsPerCommandList );
+
+    /**
+     * Split the items [0, numItems) into contiguous ranges and record one command list
+     * per range in parallel. Returns when all command lists are finished. Exceptions
+     * thrown by the record function are rethrown on the calling thread.
+     * @returns The number of command lists.
+     */
+    size_t Record( size_t numItems, const RecordFunction& record );
+
+    /**
+     * Execute the command lists of the last call to Record in the order of their ranges.
+     */
+    void Execute();
+
+    // The number of command lists that Record uses for a number of items.
+    static size_t GetNumCommandLists( size_t numItems, size_t numRecorders, size_t minItemsPerCommandList );
+
+    // The range of items of a command list.
+    static void GetRange( size_t numItems, size_t numCommandLists, size_t index, size_t& begin, size_t& end );
+
+private:
+    ParallelCommandRecorder( const ParallelCommandRecorder& copy );
+    ParallelCommandRecorder& operator=( const ParallelCommandRecorder& other );
+
+    void WorkerThread( size_t index );
+    void RecordCommandList( size_t index );
+
+    std::vector<CommandRecorder*> m_Recorders;
+    std::vector<std::thread> m_Threads;
+    size_t m_MinItemsPerCommandList;
+
+    // The work of the current call to Record (protected by m_Mutex).
+    std::mutex m_Mutex;
+    std::condition_variable m_StartCondition;
+    std::condition_variable m_DoneCondition;
+    uint64_t m_Generation;
+    const RecordFunction* m_RecordFunction;
+    size_t m_NumItems;
+    size_t m_NumCommandLists;
+    size_t m_NumPending;
+    std::exception_ptr m_Exception;
+    bool m_Quit;
+};
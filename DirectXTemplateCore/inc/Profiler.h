@@ -0,0 +1,175 @@
+/**
+ * @brief A low-overhead CPU profiler for hierarchical zones.
+ *
+ * PROFILE_SCOPE( "Name" ) records the time from the statement to the end of the
+ * enclosing scope as a zone. Every thread writes its zones into its own ring
+ * buffer without locks, so the zones of job and recording threads are recorded
+ * as well. Profiler::Collect copies the zones that were recorded since the previous
+ * call into a ProfileCapture, which can be written as a Chrome trace (open it in
+ * chrome://tracing or https://ui.perfetto.dev) or in a compact binary format.
+ *
+ * The zone names must be string literals (or strings that are never freed): only
+ * the pointer is recorded. Zones are nested by their times, a zone is a child of
+ * the zones on the same thread that contain it.
+ *
+ * Timestamps are read with RDTSC on x86 and x64 (assuming an invariant TSC, like
+ * every CPU of the last decade) and with the Clock elsewhere. Define
+ * PROFILER_DISABLED to compile the zones out.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && ( defined(_M_X64) || defined(_M_IX86) )
+#include <intrin.h>
+#define PROFILER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_RDTSC 1
+#else
+#include <Clock.h>
+#endif
+
+#if defined(PROFILER_DISABLED)
+#define PROFILE_SCOPE( name )
+#else
+#define PROFILE_CONCAT_( a, b ) a##b
+#define PROFILE_CONCAT( a, b ) PROFILE_CONCAT_( a, b )
+#define PROFILE_SCOPE( name ) ProfileScope PROFILE_CONCAT( profileScope, __LINE__ )( name )
+#endif
+
+struct ProfileZone
+{
+    // The index in ProfileCapture::Names.
+    uint32_t Name;
+    // The index in ProfileCapture::Threads.
+    uint32_t Thread;
+    // The number of zones on the same thread that contain this zone.
+    uint32_t Depth;
+    // The start of the zone in nanoseconds since the profiler was started.
+    int64_t Begin;
+    int64_t Duration;
+};
+
+// The zones that were collected from the profiler.
+class ProfileCapture
+{
+public:
+    ProfileCapture();
+
+    void Clear();
+
+    // Write a Chrome trace event file (JSON).
+    bool WriteChromeTrace( const std::string& fileName ) const;
+
+    /**
+     * Write the capture in a compact binary format: the zones are sorted by thread
+     * and start time and stored as variable-length integers, with the start time
+     * relative to the previous zone.
+     */
+    bool WriteBinary( const std::string& fileName ) const;
+    // Read a file that was written with WriteBinary. Returns false if the file is invalid.
+    bool ReadBinary( const std::string& fileName );
+
+    // The file identifier 'DXTP'.
+    static const uint32_t FileMagic = 0x50545844;
+    static const uint32_t FileVersion = 1;
+
+    std::vector<std::string> Names;
+    // The names of the threads (see Profiler::SetThreadName).
+    std::vector<std::string> Threads;
+    // Sorted by thread and start time.
+    std::vector<ProfileZone> Zones;
+    // The number of zones that were overwritten in the ring buffers before they were collected.
+    uint64_t NumDropped;
+};
+
+class Profiler
+{
+public:
+    // The capacity of the ring buffer of each thread.
+    static const size_t ZonesPerThread = 65536;
+
+    // Recording is enabled by default.
+    static void set_Enabled( bool enabled );
+    static bool get_Enabled();
+
+    // Name the calling thread in the captures (the name is copied).
+    static void SetThreadName( const std::string& name );
+
+    /**
+     * Mark the start of a frame. The previous frame is recorded as a zone named
+     * "Frame" on the calling thread. Call it from one thread only.
+     */
+    static void BeginFrame();
+    static uint64_t get_FrameCount();
+
+    /**
+     * Move the zones that ended since the previous call into the capture (the capture
+     * is cleared first). The depth of a zone only counts the zones of the same
+     * capture, so collect right after BeginFrame to keep the frames whole.
+     */
+    static void Collect( ProfileCapture& capture );
+
+    // The current timestamp in profiler ticks.
+    static int64_t ReadTimestamp()
+    {
+#if defined(PROFILER_RDTSC)
+        return static_cast<int64_t>( __rdtsc() );
+#else
+        return Clock::GetTicks();
+#endif
+    }
+
+    // The number of timestamps per second (measured against the Clock).
+    static double get_TimestampFrequency();
+
+    // Record a zone that started and ended at the timestamps.
+    static void Record( const char* name, int64_t begin, int64_t end );
+
+    /**
+     * Create a track for zones that are not recorded by a thread, for example the zones
+     * of the GPU (see GpuProfiler). Tracks appear as threads in the captures.
+     */
+    static uint32_t CreateTrack( const std::string& name );
+    // Record a zone on a track. Only one thread at a time may record on a track.
+    static void RecordOnTrack( uint32_t track, const char* name, int64_t begin, int64_t end );
+
+private:
+    static std::atomic<bool> ms_Enabled;
+};
+
+// Records a zone from construction to destruction (see PROFILE_SCOPE).
+class ProfileScope
+{
+public:
+    explicit ProfileScope( const char* name )
+        : m_Name( name )
+        , m_Begin( Profiler::get_Enabled() ? Profiler::ReadTimestamp() : 0 )
+    {}
+
+    ~ProfileScope()
+    {
+        // A timestamp of 0 means that the profiler was disabled when the zone started.
+        if ( m_Begin != 0 )
+        {
+            Profiler::Record( m_Name, m_Begin, Profiler::ReadTimestamp() );
+        }
+    }
+
+private:
+    ProfileScope( const ProfileScope& copy );
+    ProfileScope& operator=( const ProfileScope& other );
+
+    const char* m_Name;
+    int64_t m_Begin;
+};
+
+inline bool Profiler::get_Enabled()
+{
+    return ms_Enabled.load( std::memory_order_relaxed );
+}
@@ -0,0 +1,86 @@
+/**
+ * @brief An abstract interface for the pipeline state and draw calls of a device context.
+ *
+ * The interface only covers the state that is used by the demos. Device objects
+ * (shaders, buffers, state objects, shader resource views) are passed as opaque
+ * handles and enumerations (primitive topology, index format) as opaque values so
+ * that the core library does not depend on a graphics API. D3D11RenderContext in
+ * the DirectXTemplateLib forwards the calls to an ID3D11DeviceContext.
+ */
+#pragma once
+
+#include <cstdint>
+
+// An opaque handle to a device object (for example an ID3D11VertexShader*).
+typedef const void* StateHandle;
+
+// A range of a constant buffer.
+struct ConstantBufferBinding
+{
+    StateHandle Buffer;
+    // The offset and size of the range in shader constants (16 bytes).
+    // A size of 0 binds the whole buffer.
+    uint32_t FirstConstant;
+    uint32_t NumConstants;
+};
+
+struct VertexBufferBinding
+{
+    StateHandle Buffer;
+    uint32_t Stride;
+    uint32_t Offset;
+};
+
+class RenderContext
+{
+public:
+    // The number of vertex buffer slots that are tracked.
+    static const uint32_t MaxVertexBuffers = 2;
+    // The number of constant buffer slots that are tracked per shader stage.
+    static const uint32_t MaxConstantBuffers = 4;
+    // The number of pixel shader resource slots that are tracked.
+    static const uint32_t MaxShaderResources = 6;
+
+    virtual ~RenderContext() {}
+
+    virtual void SetInputLayout( StateHandle inputLayout ) = 0;
+    virtual void SetPrimitiveTopology( uint32_t primitiveTopology ) = 0;
+    virtual void SetVertexBuffer( uint32_t slot, const VertexBufferBinding& vertexBuffer ) = 0;
+    virtual void SetIndexBuffer( StateHandle indexBuffer, uint32_t indexFormat ) = 0;
+
+    virtual void SetVertexShader( StateHandle vertexShader ) = 0;
+    virtual void SetVSConstantBuffer( uint32_t slot, const ConstantBufferBinding& constantBuffer ) = 0;
+
+    virtual void SetRasterizerState( StateHandle rasterizerState ) = 0;
+
+    virtual void SetPixelShader( StateHandle pixelShader ) = 0;
+    virtual void SetPSConstantBuffer( uint32_t slot, const ConstantBufferBinding& constantBuffer ) = 0;
+    virtual void SetPSShaderResource( uint32_t slot, StateHandle shaderResourceView ) = 0;
+
+    virtual void SetDepthStencilState( StateHandle depthStencilState ) = 0;
+    virtual void SetBlendState( StateHandle blendState ) = 0;
+
+    virtual void DrawIndexed( uint32_t indexCount, uint32_t startIndex, int32_t baseVertex ) = 0;
+    virtual void DrawIndexedInstanced( uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance ) = 0;
+};
+
+// Returns true if both bindings refer to the same range of the same buffer.
+inline bool operator==( const ConstantBufferBinding& a, const ConstantBufferBinding& b )
+{
+    return a.Buffer == b.Buffer && a.FirstConstant == b.FirstConstant && a.NumConstants == b.NumConstants;
+}
+
+inline bool operator!=( const ConstantBufferBinding& a, const ConstantBufferBinding& b )
+{
+    return !( a == b );
+}
+
+inline bool operator==( const VertexBufferBinding& a, const VertexBufferBinding& b )
+{
+    return a.Buffer == b.Buffer && a.Stride == b.Stride && a.Offset == b.Offset;
+}
+
+inline bool operator!=( const VertexBufferBinding& a, const VertexBufferBinding& b )
+{
+    return !( a == b );
+}
@@ -0,0 +1,136 @@
+/**
+ * @brief A queue of draw commands that is sorted by a 64-bit key before it is executed.
+ *
+ * Draw commands describe all of the state that is required for a draw call. The
+ * commands are submitted with a sort key (see the SortKey functions) and are radix
+ * sorted when the queue is executed. Execute the queue on a StateCache so that only
+ * the state that differs from the previous draw call reaches the device context.
+ */
+#pragma once
+
+#include <RenderContext.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * All of the state needed for a single draw call.
+ * Use value-initialization ( DrawCommand drawCommand = {}; ) to clear the command.
+ */
+struct DrawCommand
+{
+    StateHandle InputLayout;
+    uint32_t PrimitiveTopology;
+    VertexBufferBinding VertexBuffers[RenderContext::MaxVertexBuffers];
+    uint32_t NumVertexBuffers;
+    StateHandle IndexBuffer;
+    uint32_t IndexFormat;
+
+    StateHandle VertexShader;
+    ConstantBufferBinding VSConstantBuffers[RenderContext::MaxConstantBuffers];
+    uint32_t NumVSConstantBuffers;
+
+    StateHandle RasterizerState;
+
+    StateHandle PixelShader;
+    ConstantBufferBinding PSConstantBuffers[RenderContext::MaxConstantBuffers];
+    uint32_t NumPSConstantBuffers;
+    StateHandle PSShaderResources[RenderContext::MaxShaderResources];
+    uint32_t NumPSShaderResources;
+
+    StateHandle DepthStencilState;
+    StateHandle BlendState;
+
+    uint32_t IndexCount;
+    // Use 0 for a non-instanced draw call.
+    uint32_t InstanceCount;
+    uint32_t StartIndex;
+    int32_t BaseVertex;
+    uint32_t StartInstance;
+};
+
+/**
+ * Sort keys are built from small integer IDs that are assigned by the application
+ * (for example the index of the shader in a list of shaders). IDs that do not fit
+ * in the number of bits of the field are truncated.
+ */
+namespace SortKey
+{
+    const int PassBits = 4;
+    const int ShaderBits = 12;
+    const int MaterialBits = 12;
+    const int TextureBits = 12;
+    const int DepthBits = 24;
+
+    // Quantize a depth value in the range [0, 1] to DepthBits bits.
+    uint32_t QuantizeDepth( float depth );
+
+    /**
+     * A key for opaque geometry: sorted by pass, shader, material, and texture
+     * to minimize state changes, then front to back to reduce overdraw.
+     * @param depth The view-space depth normalized to the range [0, 1].
+     */
+    uint64_t Opaque( uint32_t pass, uint32_t shader, uint32_t material, uint32_t texture, float depth );
+
+    /**
+     * A key for translucent geometry: sorted by pass and then back to front
+     * so that it is blended in the correct order.
+     */
+    uint64_t Translucent( uint32_t pass, float depth, uint32_t shader, uint32_t material, uint32_t texture );
+
+    // The pass of a sort key.
+    uint32_t GetPass( uint64_t sortKey );
+}
+
+class RenderQueue
+{
+public:
+    RenderQueue();
+    virtual ~RenderQueue();
+
+    // Add a draw command to the queue.
+    void Submit( uint64_t sortKey, const DrawCommand& drawCommand );
+
+    /**
+     * Sort the draw commands by their sort key. Commands with the
+     * same sort key keep the order in which they were submitted.
+     */
+    void Sort();
+
+    /**
+     * Sort the queue (if it is not already sorted) and issue the draw commands
+     * to the render context. The queue is not cleared.
+     */
+    void Execute( RenderContext& renderContext );
+
+    /**
+     * Issue the sorted draw commands in the range [begin, end) to the render context.
+     * The queue must be sorted. Different ranges may be executed on different
+     * threads (see ParallelCommandRecorder).
+     */
+    void Execute( RenderContext& renderContext, size_t begin, size_t end ) const;
+
+    // Remove all draw commands from the queue.
+    void Clear();
+
+    size_t get_NumCommands() const;
+    // Get the draw command at the position in the sorted order (call Sort first).
+    const DrawCommand& get_SortedCommand( size_t index ) const;
+    uint64_t get_SortedKey( size_t index ) const;
+
+private:
+    struct SortEntry
+    {
+        uint64_t Key;
+        uint32_t Index;
+    };
+
+    static void Execute( RenderContext& renderContext, const DrawCommand& drawCommand );
+
+    std::vector<DrawCommand> m_Commands;
+    std::vector<SortEntry> m_SortEntries;
+    // Scratch space for the radix sort.
+    std::vector<SortEntry> m_ScratchEntries;
+    bool m_Sorted;
+};
@@ -0,0 +1,95 @@
+/**
+ * @brief Offset bookkeeping for a ring buffer that is shared with the GPU.
+ *
+ * The RingAllocator only hands out offsets into a buffer of a fixed size, it
+ * does not own any memory. Allocations made during a frame are tagged with a
+ * fence value when the frame is finished. The memory of a frame is only reused
+ * after the fence value of that frame has been reported as completed.
+ *
+ * The allocator does not depend on a graphics device (see DynamicConstantBuffer
+ * in the DirectXTemplateLib for the D3D11 implementation).
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+class RingAllocator
+{
+public:
+    // Returned by Allocate when there is not enough free space in the ring.
+    static const size_t InvalidOffset = static_cast<size_t>( -1 );
+
+    /**
+     * @param capacity The size of the ring buffer in bytes. The capacity is
+     * rounded down to a multiple of the alignment.
+     * @param alignment The alignment (in bytes) of every allocation. Must be a power of 2.
+     */
+    explicit RingAllocator( size_t capacity, size_t alignment = 256 );
+
+    /**
+     * Allocate a range of the ring buffer.
+     * Allocations are contiguous. If the allocation does not fit at the end
+     * of the buffer, the allocator wraps around to the beginning of the buffer.
+     * @param size The size of the allocation in bytes. It is rounded up to the alignment.
+     * @returns The offset of the allocation or InvalidOffset if the ring is full.
+     */
+    size_t Allocate( size_t size );
+
+    /**
+     * Mark the end of the allocations for the current frame.
+     * @param fenceValue The value that signals that the GPU is done with the frame.
+     * Fence values must increase monotonically.
+     */
+    void FinishFrame( uint64_t fenceValue );
+
+    /**
+     * Release the memory of all frames whose fence value is less than
+     * or equal to the completed fence value.
+     */
+    void ReleaseCompletedFrames( uint64_t completedFenceValue );
+
+    /**
+     * Release all of the memory in the ring.
+     * Only call this when the GPU is no longer using any of the allocations.
+     */
+    void Reset();
+
+    // The fence value of the oldest frame that has not been released.
+    // Returns 0 if there are no frames in flight.
+    uint64_t get_OldestFenceValue() const;
+    size_t get_NumFramesInFlight() const;
+
+    size_t get_Capacity() const;
+    size_t get_Alignment() const;
+    // The number of bytes in use (including the padding that was skipped when wrapping around).
+    size_t get_UsedSize() const;
+    // The number of times the allocator wrapped around to the beginning of the buffer.
+    uint64_t get_WrapCount() const;
+
+    // Round a size up to a multiple of the alignment.
+    size_t AlignUp( size_t size ) const;
+
+private:
+    struct FrameInfo
+    {
+        uint64_t FenceValue;
+        // The number of bytes that were allocated by the frame.
+        size_t Size;
+    };
+
+    size_t m_Capacity;
+    size_t m_Alignment;
+
+    // The offset of the next allocation.
+    size_t m_Head;
+    // The offset of the oldest allocation that is still in use.
+    size_t m_Tail;
+    size_t m_UsedSize;
+    // The number of bytes allocated since the last call to FinishFrame.
+    size_t m_CurrentFrameSize;
+    uint64_t m_WrapCount;
+
+    std::deque<FrameInfo> m_Frames;
+};
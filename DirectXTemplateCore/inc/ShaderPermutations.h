@@ -0,0 +1,181 @@
+/**
+ * @brief Shader variants that are selected by keywords and an on-disk cache of their bytecode.
+ *
+ * A keyword is a define that takes the values [0, NumValues). ShaderPermutations
+ * enumerates every combination of the values of the keywords of a shader and numbers
+ * them, so a variant is found with a few multiplications instead of a lookup by name.
+ *
+ * ShaderCache stores the bytecode of a variant in a directory under a name that is
+ * derived from a hash of its content: the source code, the entry point, the target,
+ * the defines and the identifier of the compiler. A changed shader gets another name,
+ * so stale bytecode is never loaded. On a cache miss the variant is compiled with a
+ * ShaderCompiler and the bytecode is stored. The compiler is an interface, so the
+ * cache does not depend on a graphics API: D3DShaderCompiler in the DirectXTemplateLib
+ * uses D3DCompile.
+ *
+ * The keywords of TexturedLitPixelShader.hlsl replace the dynamic branches on the
+ * material and the light types (see GetTexturedLitVariant).
+ */
+#pragma once
+
+#include <Lighting.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A preprocessor definition that is passed to the shader compiler.
+struct ShaderDefine
+{
+    std::string Name;
+    std::string Value;
+};
+
+// A define that takes the values [0, NumValues) in the variants of a shader.
+struct ShaderKeyword
+{
+    std::string Name;
+    uint32_t NumValues;
+};
+
+/**
+ * The variants of a shader. The index of a variant is the number whose digits are
+ * the values of the keywords, the first keyword being the least significant digit.
+ */
+class ShaderPermutations
+{
+public:
+    // The largest number of variants of a shader.
+    static const uint32_t MaxVariants = 65536;
+
+    explicit ShaderPermutations( const std::vector<ShaderKeyword>& keywords );
+
+    uint32_t get_NumKeywords() const;
+    const ShaderKeyword& GetKeyword( uint32_t keyword ) const;
+    uint32_t get_NumVariants() const;
+
+    // The variant with the value values[i] of every keyword i.
+    uint32_t GetVariant( const uint32_t* values ) const;
+    // The value of a keyword in a variant.
+    uint32_t GetValue( uint32_t variant, uint32_t keyword ) const;
+
+    // The defines of a variant: the value of every keyword.
+    void GetDefines( uint32_t variant, std::vector<ShaderDefine>& defines ) const;
+
+private:
+    std::vector<ShaderKeyword> m_Keywords;
+    // The distance between the variants that differ by one in the value of a keyword.
+    std::vector<uint32_t> m_Strides;
+    uint32_t m_NumVariants;
+};
+
+struct ShaderSource
+{
+    // The name of the source file (for the error messages and the cache file names).
+    std::string Name;
+    std::string Code;
+    std::string EntryPoint;
+    // The shader model, for example "ps_5_0".
+    std::string Target;
+};
+
+class ShaderCompiler
+{
+public:
+    virtual ~ShaderCompiler() {}
+
+    /**
+     * Compile a shader with a set of defines.
+     * @param errors Set to the messages of the compiler.
+     * @returns false if the shader did not compile.
+     */
+    virtual bool Compile( const ShaderSource& source, const std::vector<ShaderDefine>& defines,
+        std::vector<uint8_t>& bytecode, std::string& errors ) = 0;
+
+    /**
+     * Identifies the compiler and its flags. The identifier is part of the cache key,
+     * so bytecode that was compiled by another compiler or with other flags is not loaded.
+     */
+    virtual std::string get_Identifier() const = 0;
+};
+
+// The 64-bit hash of the content of a shader variant that names its cache file.
+uint64_t ComputeShaderHash( const ShaderSource& source, const std::vector<ShaderDefine>& defines, const std::string& compilerIdentifier );
+
+struct ShaderCacheFileHeader
+{
+    // The file identifier 'DXTS'.
+    uint32_t Magic;
+    uint32_t Version;
+    // The hash of the content of the variant (see ComputeShaderHash).
+    uint64_t ShaderHash;
+    // The size and the hash of the bytecode that follows the header.
+    uint64_t BytecodeSize;
+    uint64_t BytecodeHash;
+
+    static const uint32_t FileMagic = 0x53545844;
+    // Increment the version when the layout of the file changes.
+    static const uint32_t FileVersion = 1;
+};
+
+class ShaderCache
+{
+public:
+    struct Statistics
+    {
+        // The variants that were loaded from the cache, compiled, and that failed to compile.
+        uint32_t Loaded;
+        uint32_t Compiled;
+        uint32_t Failed;
+    };
+
+    /**
+     * @param directory The directory of the cache files. It must exist.
+     * An empty string uses the current directory.
+     */
+    ShaderCache( ShaderCompiler& compiler, const std::string& directory );
+
+    /**
+     * Load the bytecode of a variant from its cache file, or compile the variant and
+     * store the bytecode if the file does not exist or is invalid.
+     * @returns false if the variant did not compile (see get_Errors).
+     */
+    bool Load( const ShaderSource& source, const std::vector<ShaderDefine>& defines, std::vector<uint8_t>& bytecode );
+
+    // The full path of the cache file of a variant: <directory>/<name>-<entry point>-<hash>.cso
+    std::string get_FileName( const ShaderSource& source, uint64_t hash ) const;
+
+    // The messages of the compiler for the last variant that failed to compile.
+    const std::string& get_Errors() const;
+    const Statistics& get_Statistics() const;
+
+private:
+    ShaderCache( const ShaderCache& copy );
+    ShaderCache& operator=( const ShaderCache& other );
+
+    ShaderCompiler& m_Compiler;
+    std::string m_Directory;
+    std::string m_Errors;
+    Statistics m_Statistics;
+};
+
+// The keywords of TexturedLitPixelShader.hlsl in the order of their digits.
+enum TexturedLitKeyword
+{
+    // 1 if the material is textured (Material.UseTexture).
+    TexturedLitUseTexture,
+    // 1 if there are enabled lights of a type. The shading of the other types is compiled out.
+    TexturedLitDirectionalLights,
+    TexturedLitPointLights,
+    TexturedLitSpotLights,
+    TexturedLitKeywordCount,
+};
+
+std::vector<ShaderKeyword> GetTexturedLitKeywords();
+
+/**
+ * The variant of TexturedLitPixelShader.hlsl for a material and the numbers of enabled
+ * lights of each type (indexed by LightType, see LightManager::GetNumEnabledLights).
+ * @param permutations The permutations of GetTexturedLitKeywords.
+ */
+uint32_t GetTexturedLitVariant( const ShaderPermutations& permutations, const _Material& material, const uint32_t* numEnabledLights );
@@ -0,0 +1,199 @@
+/**
+ * @brief Shadow maps for spot and directional lights in a shadow atlas.
+ *
+ * All of the shadow maps of a frame are square tiles of one depth texture (the
+ * atlas). ShadowAtlas::Pack gives every shadow map a power-of-two tile that grows
+ * with the screen-space importance of its light (see ShadowImportance) and places
+ * the tiles from the largest to the smallest in Z-order. Every tile then starts at
+ * a multiple of its own size, so the tiles never overlap and there is no space
+ * between them. If the tiles do not fit, the least important shadow maps are made
+ * smaller first, and shadow maps that do not fit at the minimum size are dropped.
+ *
+ * A directional light has one shadow map per cascade. ComputeCascadeSplits splits
+ * the view frustum of the camera between its near and far planes, and
+ * ComputeCascadeView covers each slice with an orthographic projection that fits
+ * the bounding sphere of the slice and moves in whole texels, so the shadows do not
+ * shimmer when the camera moves or turns. A spot light has one perspective shadow
+ * map of its cone (ComputeSpotShadowView).
+ *
+ * The static geometry only needs to be rendered into a shadow map again when the
+ * view of the shadow map or its tile changed, or when static geometry in its view
+ * changed. ShadowCache keeps track of that for every shadow map.
+ */
+#pragma once
+
+#include <BoundingVolumes.h>
+#include <Camera.h>
+#include <Frustum.h>
+#include <Lighting.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// A square tile of the atlas in texels. The Size is 0 if the shadow map did not fit.
+struct ShadowAtlasTile
+{
+    uint32_t X;
+    uint32_t Y;
+    uint32_t Size;
+};
+
+// The matrices that a shadow map is rendered with.
+struct ShadowView
+{
+    Math::Float4x4 ViewMatrix;
+    Math::Float4x4 ProjectionMatrix;
+    Math::Float4x4 ViewProjectionMatrix;
+};
+
+// The layout of the ShadowMap struct in TexturedLitPixelShader.hlsl and TiledDeferredComputeShader.hlsl.
+struct ShadowMapConstants
+{
+    // From world space to the texture coordinates of the tile in the atlas (xy) and the depth (z).
+    Math::Float4x4 ShadowMatrix;
+    //----------------------------------- (16 byte boundary)
+    // The texture coordinates that may be sampled (min xy, max xy), half a texel inside the tile.
+    Math::Float4 TileBounds;
+    //----------------------------------- (16 byte boundary)
+    // The view-space depth up to which a cascade is used (FLT_MAX for the last cascade and spot lights).
+    float SplitDepth;
+    // Subtracted from the depth before it is compared with the shadow map.
+    float DepthBias;
+    float Padding[2];
+    //----------------------------------- (16 byte boundary)
+};  // Total:                              96 bytes ( 6 * 16 )
+
+static_assert( sizeof( ShadowMapConstants ) == 96, "ShadowMapConstants must match the ShadowMap struct in TexturedLitPixelShader.hlsl." );
+
+/**
+ * The importance of the shadow of a light: the fraction of the screen height that
+ * the bounding sphere of its lit volume (see LightBounds) covers, clamped to [0, 1].
+ * The importance is 0 if the sphere is outside the view frustum, and 1 if the camera
+ * is inside the sphere or the light is a directional light.
+ */
+float ShadowImportance( const Light& light, const Camera& camera );
+
+class ShadowAtlas
+{
+public:
+    /**
+     * @param size The width and height of the atlas in texels.
+     * @param minTileSize The size of the least important shadow maps.
+     * @param maxTileSize The size of a shadow map with an importance of 1.
+     * All sizes must be powers of two.
+     */
+    ShadowAtlas( uint32_t size = 4096, uint32_t minTileSize = 128, uint32_t maxTileSize = 2048 );
+
+    uint32_t get_Size() const;
+    uint32_t get_MinTileSize() const;
+    uint32_t get_MaxTileSize() const;
+
+    // The tile size for an importance if the atlas is not full (0 for an importance of 0).
+    uint32_t GetTileSize( float importance ) const;
+
+    /**
+     * Pack shadow maps into the atlas.
+     * @param importance The importance of each shadow map (0 if it is not needed).
+     * @param tiles Set to the tile of each shadow map.
+     * @returns The number of shadow maps that have a tile.
+     */
+    size_t Pack( const std::vector<float>& importance, std::vector<ShadowAtlasTile>& tiles );
+
+private:
+    ShadowAtlas( const ShadowAtlas& copy );
+    ShadowAtlas& operator=( const ShadowAtlas& other );
+
+    uint32_t m_Size;
+    uint32_t m_MinTileSize;
+    uint32_t m_MaxTileSize;
+
+    // The shadow maps by decreasing importance and their tile sizes (reused by Pack).
+    std::vector<uint32_t> m_Order;
+    std::vector<uint32_t> m_TileSizes;
+};
+
+/**
+ * The view-space depths at which the view frustum is split into cascades:
+ * splits[0] = nearZ and splits[numCascades] = farZ.
+ * @param lambda Blends between uniform (0) and logarithmic (1) splits.
+ * @param splits An array of numCascades + 1 depths.
+ */
+void ComputeCascadeSplits( float nearZ, float farZ, uint32_t numCascades, float lambda, float* splits );
+
+/**
+ * The shadow view of the cascade that covers the slice [splitNear, splitFar] of the
+ * view frustum of a camera with a left-handed perspective projection.
+ * @param lightDirection The unit direction of the directional light.
+ * @param resolution The size of the tile of the cascade in texels.
+ * @param casterDistance How far behind the slice (towards the light) shadow casters are rendered.
+ */
+ShadowView ComputeCascadeView( const Camera& camera, const Math::Float3& lightDirection, float splitNear, float splitFar,
+    uint32_t resolution, float casterDistance );
+
+/**
+ * The shadow view of a spot light. The shadow map covers the cone of the light
+ * from nearZ to the range of the light (at most farZ).
+ */
+ShadowView ComputeSpotShadowView( const Light& light, float nearZ, float farZ );
+
+/**
+ * The constants with which the shaders sample a shadow map in a tile of the atlas.
+ * @param splitDepth The view-space depth up to which the shadow map is used.
+ */
+ShadowMapConstants ComputeShadowMapConstants( const ShadowView& view, const ShadowAtlasTile& tile, uint32_t atlasSize,
+    float splitDepth, float depthBias );
+
+class ShadowCache
+{
+public:
+    struct Statistics
+    {
+        // The shadow maps that were still valid and the ones that must be rendered again.
+        uint32_t Hits;
+        uint32_t Misses;
+    };
+
+    ShadowCache();
+
+    /**
+     * Call at the start of every frame before Update. Forgets the shadow maps that
+     * were not updated in the last frame and resets the statistics.
+     */
+    void BeginFrame();
+
+    /**
+     * Returns true if the static geometry must be rendered into a shadow map: the
+     * shadow map is new, its tile or its view changed, another shadow map was rendered
+     * into its tile, or static geometry in its view changed since it was rendered.
+     * @param key A unique value for the shadow map (for example the light and the cascade).
+     */
+    bool Update( uint64_t key, const ShadowAtlasTile& tile, const ShadowView& view );
+
+    // Static geometry inside the world-space bounds was added, removed or moved.
+    void Invalidate( const BoundingSphere& bounds );
+    void InvalidateAll();
+
+    size_t get_NumShadowMaps() const;
+    // Statistics since the last BeginFrame.
+    const Statistics& get_Statistics() const;
+
+private:
+    ShadowCache( const ShadowCache& copy );
+    ShadowCache& operator=( const ShadowCache& other );
+
+    struct Entry
+    {
+        ShadowAtlasTile Tile;
+        Math::Float4x4 ViewProjectionMatrix;
+        // The world-space frustum of the shadow map.
+        Frustum WorldFrustum;
+        bool Valid;
+        uint64_t Frame;
+    };
+
+    std::unordered_map<uint64_t, Entry> m_Entries;
+    uint64_t m_Frame;
+    Statistics m_Statistics;
+};
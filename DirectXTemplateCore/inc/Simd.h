@@ -0,0 +1,376 @@
+/**
+ * @brief A thin wrapper around the SIMD instruction sets supported by the target.
+ *
+ * The Simd::Float type holds Simd::Width single-precision floats. When the
+ * translation unit is compiled with AVX enabled (/arch:AVX or -mavx) the
+ * width is 8, otherwise SSE2 is used and the width is 4. If neither is
+ * available, a portable scalar implementation of the same interface is used
+ * so the algorithms written against it still compile on any platform.
+ */
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX__)
+#define SIMD_AVX 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define SIMD_SSE 1
+#include <emmintrin.h>
+#else
+#define SIMD_SCALAR 1
+#endif
+
+#if defined(_MSC_VER)
+#define SIMD_ALIGN(x) __declspec(align(x))
+#else
+#define SIMD_ALIGN(x) __attribute__((aligned(x)))
+#endif
+
+namespace Simd
+{
+#if defined(SIMD_AVX)
+
+    const int Width = 8;
+    const int Alignment = 32;
+
+    struct Float
+    {
+        Float() = default;
+        Float( __m256 _v ) : v( _v ) {}
+        __m256 v;
+    };
+
+    inline Float Set1( float s ) { return _mm256_set1_ps( s ); }
+    inline Float Zero() { return _mm256_setzero_ps(); }
+    inline Float Load( const float* p ) { return _mm256_load_ps( p ); }
+    inline Float LoadUnaligned( const float* p ) { return _mm256_loadu_ps( p ); }
+    inline void Store( float* p, Float a ) { _mm256_store_ps( p, a.v ); }
+    inline void StoreUnaligned( float* p, Float a ) { _mm256_storeu_ps( p, a.v ); }
+    // Returns { 0, 1, 2, ..., Width - 1 }.
+    inline Float LaneIndex() { return _mm256_setr_ps( 0, 1, 2, 3, 4, 5, 6, 7 ); }
+
+    inline Float operator+( Float a, Float b ) { return _mm256_add_ps( a.v, b.v ); }
+    inline Float operator-( Float a, Float b ) { return _mm256_sub_ps( a.v, b.v ); }
+    inline Float operator*( Float a, Float b ) { return _mm256_mul_ps( a.v, b.v ); }
+    inline Float operator/( Float a, Float b ) { return _mm256_div_ps( a.v, b.v ); }
+    inline Float operator-( Float a ) { return _mm256_xor_ps( a.v, _mm256_set1_ps( -0.0f ) ); }
+
+    inline Float Min( Float a, Float b ) { return _mm256_min_ps( a.v, b.v ); }
+    inline Float Max( Float a, Float b ) { return _mm256_max_ps( a.v, b.v ); }
+    inline Float Sqrt( Float a ) { return _mm256_sqrt_ps( a.v ); }
+    inline Float Floor( Float a ) { return _mm256_floor_ps( a.v ); }
+
+    // Comparisons return a mask with all bits set in the lanes where the comparison is true.
+    inline Float CmpLT( Float a, Float b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_LT_OQ ); }
+    inline Float CmpLE( Float a, Float b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_LE_OQ ); }
+    inline Float CmpGT( Float a, Float b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_GT_OQ ); }
+    inline Float CmpGE( Float a, Float b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_GE_OQ ); }
+    inline Float CmpEQ( Float a, Float b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_EQ_OQ ); }
+
+    inline Float And( Float a, Float b ) { return _mm256_and_ps( a.v, b.v ); }
+    inline Float Or( Float a, Float b ) { return _mm256_or_ps( a.v, b.v ); }
+    inline Float AndNot( Float mask, Float a ) { return _mm256_andnot_ps( mask.v, a.v ); }
+    // Returns a in the lanes where mask is set, b otherwise.
+    inline Float Select( Float mask, Float a, Float b ) { return _mm256_blendv_ps( b.v, a.v, mask.v ); }
+    // Returns one bit per lane of the mask.
+    inline int MoveMask( Float mask ) { return _mm256_movemask_ps( mask.v ); }
+
+    namespace Detail
+    {
+        // AVX (without AVX2) has no 256-bit integer instructions so the
+        // bit manipulation is done on the two 128-bit halves.
+        inline __m128i Exponent( __m128i bits ) { return _mm_sub_epi32( _mm_srli_epi32( bits, 23 ), _mm_set1_epi32( 127 ) ); }
+        inline __m128i Mantissa( __m128i bits ) { return _mm_or_si128( _mm_and_si128( bits, _mm_set1_epi32( 0x007FFFFF ) ), _mm_set1_epi32( 0x3F800000 ) ); }
+        inline __m128i Pow2( __m128i i ) { return _mm_slli_epi32( _mm_add_epi32( i, _mm_set1_epi32( 127 ) ), 23 ); }
+    }
+
+    // Split a positive, normalized float into its unbiased exponent and its mantissa in the range [1, 2).
+    inline void Frexp( Float x, Float& exponent, Float& mantissa )
+    {
+        __m128i lo = _mm_castps_si128( _mm256_castps256_ps128( x.v ) );
+        __m128i hi = _mm_castps_si128( _mm256_extractf128_ps( x.v, 1 ) );
+        exponent = _mm256_cvtepi32_ps( _mm256_insertf128_si256( _mm256_castsi128_si256( Detail::Exponent( lo ) ), Detail::Exponent( hi ), 1 ) );
+        mantissa = _mm256_castsi256_ps( _mm256_insertf128_si256( _mm256_castsi128_si256( Detail::Mantissa( lo ) ), Detail::Mantissa( hi ), 1 ) );
+    }
+
+    // Returns 2^i for integer values of i in the range [-126, 127].
+    inline Float Pow2Int( Float i )
+    {
+        __m256i n = _mm256_cvtps_epi32( i.v );
+        __m128i lo = Detail::Pow2( _mm256_castsi256_si128( n ) );
+        __m128i hi = Detail::Pow2( _mm256_extractf128_si256( n, 1 ) );
+        return _mm256_castsi256_ps( _mm256_insertf128_si256( _mm256_castsi128_si256( lo ), hi, 1 ) );
+    }
+
+#elif defined(SIMD_SSE)
+
+    const int Width = 4;
+    const int Alignment = 16;
+
+    struct Float
+    {
+        Float() = default;
+        Float( __m128 _v ) : v( _v ) {}
+        __m128 v;
+    };
+
+    inline Float Set1( float s ) { return _mm_set1_ps( s ); }
+    inline Float Zero() { return _mm_setzero_ps(); }
+    inline Float Load( const float* p ) { return _mm_load_ps( p ); }
+    inline Float LoadUnaligned( const float* p ) { return _mm_loadu_ps( p ); }
+    inline void Store( float* p, Float a ) { _mm_store_ps( p, a.v ); }
+    inline void StoreUnaligned( float* p, Float a ) { _mm_storeu_ps( p, a.v ); }
+    // Returns { 0, 1, 2, ..., Width - 1 }.
+    inline Float LaneIndex() { return _mm_setr_ps( 0, 1, 2, 3 ); }
+
+    inline Float operator+( Float a, Float b ) { return _mm_add_ps( a.v, b.v ); }
+    inline Float operator-( Float a, Float b ) { return _mm_sub_ps( a.v, b.v ); }
+    inline Float operator*( Float a, Float b ) { return _mm_mul_ps( a.v, b.v ); }
+    inline Float operator/( Float a, Float b ) { return _mm_div_ps( a.v, b.v ); }
+    inline Float operator-( Float a ) { return _mm_xor_ps( a.v, _mm_set1_ps( -0.0f ) ); }
+
+    inline Float Min( Float a, Float b ) { return _mm_min_ps( a.v, b.v ); }
+    inline Float Max( Float a, Float b ) { return _mm_max_ps( a.v, b.v ); }
+    inline Float Sqrt( Float a ) { return _mm_sqrt_ps( a.v ); }
+
+    // Comparisons return a mask with all bits set in the lanes where the comparison is true.
+    inline Float CmpLT( Float a, Float b ) { return _mm_cmplt_ps( a.v, b.v ); }
+    inline Float CmpLE( Float a, Float b ) { return _mm_cmple_ps( a.v, b.v ); }
+    inline Float CmpGT( Float a, Float b ) { return _mm_cmpgt_ps( a.v, b.v ); }
+    inline Float CmpGE( Float a, Float b ) { return _mm_cmpge_ps( a.v, b.v ); }
+    inline Float CmpEQ( Float a, Float b ) { return _mm_cmpeq_ps( a.v, b.v ); }
+
+    inline Float And( Float a, Float b ) { return _mm_and_ps( a.v, b.v ); }
+    inline Float Or( Float a, Float b ) { return _mm_or_ps( a.v, b.v ); }
+    inline Float AndNot( Float mask, Float a ) { return _mm_andnot_ps( mask.v, a.v ); }
+    // Returns a in the lanes where mask is set, b otherwise.
+    inline Float Select( Float mask, Float a, Float b ) { return _mm_or_ps( _mm_and_ps( mask.v, a.v ), _mm_andnot_ps( mask.v, b.v ) ); }
+    // Returns one bit per lane of the mask.
+    inline int MoveMask( Float mask ) { return _mm_movemask_ps( mask.v ); }
+
+    // SSE2 has no floor instruction (that was added in SSE4.1).
+    inline Float Floor( Float a )
+    {
+        __m128 t = _mm_cvtepi32_ps( _mm_cvttps_epi32( a.v ) );
+        // Truncation rounds towards zero, subtract one where that rounded up.
+        return _mm_sub_ps( t, _mm_and_ps( _mm_cmpgt_ps( t, a.v ), _mm_set1_ps( 1.0f ) ) );
+    }
+
+    // Split a positive, normalized float into its unbiased exponent and its mantissa in the range [1, 2).
+    inline void Frexp( Float x, Float& exponent, Float& mantissa )
+    {
+        __m128i bits = _mm_castps_si128( x.v );
+        exponent = _mm_cvtepi32_ps( _mm_sub_epi32( _mm_srli_epi32( bits, 23 ), _mm_set1_epi32( 127 ) ) );
+        mantissa = _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( bits, _mm_set1_epi32( 0x007FFFFF ) ), _mm_set1_epi32( 0x3F800000 ) ) );
+    }
+
+    // Returns 2^i for integer values of i in the range [-126, 127].
+    inline Float Pow2Int( Float i )
+    {
+        return _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( _mm_cvtps_epi32( i.v ), _mm_set1_epi32( 127 ) ), 23 ) );
+    }
+
+#else
+
+    const int Width = 4;
+    const int Alignment = 16;
+
+    struct Float
+    {
+        float v[4];
+    };
+
+    namespace Detail
+    {
+        inline float AsFloat( uint32_t u ) { union { uint32_t u; float f; } c; c.u = u; return c.f; }
+        inline uint32_t AsUInt( float f ) { union { uint32_t u; float f; } c; c.f = f; return c.u; }
+        inline float Bool( bool b ) { return AsFloat( b ? 0xFFFFFFFFu : 0u ); }
+    }
+
+#define SIMD_SCALAR_OP(expr) Float r; for ( int i = 0; i < 4; ++i ) { r.v[i] = ( expr ); } return r
+
+    inline Float Set1( float s ) { SIMD_SCALAR_OP( s ); }
+    inline Float Zero() { SIMD_SCALAR_OP( 0.0f ); }
+    inline Float Load( const float* p ) { SIMD_SCALAR_OP( p[i] ); }
+    inline Float LoadUnaligned( const float* p ) { SIMD_SCALAR_OP( p[i] ); }
+    inline void Store( float* p, Float a ) { for ( int i = 0; i < 4; ++i ) p[i] = a.v[i]; }
+    inline void StoreUnaligned( float* p, Float a ) { for ( int i = 0; i < 4; ++i ) p[i] = a.v[i]; }
+    inline Float LaneIndex() { SIMD_SCALAR_OP( static_cast<float>( i ) ); }
+
+    inline Float operator+( Float a, Float b ) { SIMD_SCALAR_OP( a.v[i] + b.v[i] ); }
+    inline Float operator-( Float a, Float b ) { SIMD_SCALAR_OP( a.v[i] - b.v[i] ); }
+    inline Float operator*( Float a, Float b ) { SIMD_SCALAR_OP( a.v[i] * b.v[i] ); }
+    inline Float operator/( Float a, Float b ) { SIMD_SCALAR_OP( a.v[i] / b.v[i] ); }
+    inline Float operator-( Float a ) { SIMD_SCALAR_OP( -a.v[i] ); }
+
+    inline Float Min( Float a, Float b ) { SIMD_SCALAR_OP( a.v[i] < b.v[i] ? a.v[i] : b.v[i] ); }
+    inline Float Max( Float a, Float b ) { SIMD_SCALAR_OP( a.v[i] > b.v[i] ? a.v[i] : b.v[i] ); }
+    inline Float Sqrt( Float a ) { SIMD_SCALAR_OP( std::sqrt( a.v[i] ) ); }
+    inline Float Floor( Float a ) { SIMD_SCALAR_OP( std::floor( a.v[i] ) ); }
+
+    inline Float CmpLT( Float a, Float b ) { SIMD_SCALAR_OP( Detail::Bool( a.v[i] < b.v[i] ) ); }
+    inline Float CmpLE( Float a, Float b ) { SIMD_SCALAR_OP( Detail::Bool( a.v[i] <= b.v[i] ) ); }
+    inline Float CmpGT( Float a, Float b ) { SIMD_SCALAR_OP( Detail::Bool( a.v[i] > b.v[i] ) ); }
+    inline Float CmpGE( Float a, Float b ) { SIMD_SCALAR_OP( Detail::Bool( a.v[i] >= b.v[i] ) ); }
+    inline Float CmpEQ( Float a, Float b ) { SIMD_SCALAR_OP( Detail::Bool( a.v[i] == b.v[i] ) ); }
+
+    inline Float And( Float a, Float b ) { SIMD_SCALAR_OP( Detail::AsFloat( Detail::AsUInt( a.v[i] ) & Detail::AsUInt( b.v[i] ) ) ); }
+    inline Float Or( Float a, Float b ) { SIMD_SCALAR_OP( Detail::AsFloat( Detail::AsUInt( a.v[i] ) | Detail::AsUInt( b.v[i] ) ) ); }
+    inline Float AndNot( Float mask, Float a ) { SIMD_SCALAR_OP( Detail::AsFloat( ~Detail::AsUInt( mask.v[i] ) & Detail::AsUInt( a.v[i] ) ) ); }
+    inline Float Select( Float mask, Float a, Float b ) { SIMD_SCALAR_OP( Detail::AsUInt( mask.v[i] ) ? a.v[i] : b.v[i] ); }
+    inline int MoveMask( Float mask )
+    {
+        int bits = 0;
+        for ( int i = 0; i < 4; ++i ) bits |= ( Detail::AsUInt( mask.v[i] ) >> 31 ) << i;
+        return bits;
+    }
+
+    // Split a positive, normalized float into its unbiased exponent and its mantissa in the range [1, 2).
+    inline void Frexp( Float x, Float& exponent, Float& mantissa )
+    {
+        for ( int i = 0; i < 4; ++i )
+        {
+            int e;
+            mantissa.v[i] = std::frexp( x.v[i], &e ) * 2.0f;
+            exponent.v[i] = static_cast<float>( e - 1 );
+        }
+    }
+
+    // Returns 2^i for integer values of i in the range [-126, 127].
+    inline Float Pow2Int( Float n ) { SIMD_SCALAR_OP( std::ldexp( 1.0f, static_cast<int>( n.v[i] ) ) ); }
+
+#undef SIMD_SCALAR_OP
+
+#endif
+
+    // A mask with every lane set.
+    const int AllLanes = ( 1 << Width ) - 1;
+
+    inline Float operator+=( Float& a, Float b ) { a = a + b; return a; }
+    inline Float operator*=( Float& a, Float b ) { a = a * b; return a; }
+
+    // Clamp to the range [0, 1] (like HLSL's saturate).
+    inline Float Saturate( Float a ) { return Min( Max( a, Zero() ), Set1( 1.0f ) ); }
+
+    inline Float MultiplyAdd( Float a, Float b, Float c ) { return a * b + c; }
+
+    // Reciprocal square root with full precision.
+    inline Float RSqrt( Float a ) { return Set1( 1.0f ) / Sqrt( a ); }
+
+    /**
+     * Hermite interpolation between 0 and 1 (like HLSL's smoothstep).
+     */
+    inline Float SmoothStep( Float edge0, Float edge1, Float x )
+    {
+        Float t = Saturate( ( x - edge0 ) / ( edge1 - edge0 ) );
+        return t * t * ( Set1( 3.0f ) - Set1( 2.0f ) * t );
+    }
+
+    /**
+     * Base 2 logarithm of positive values.
+     * The absolute error is less than 1e-6 for normalized inputs.
+     */
+    inline Float Log2( Float x )
+    {
+        Float exponent, m;
+        Frexp( x, exponent, m );
+
+        // log2(m) = 2 / ln(2) * atanh( (m - 1) / (m + 1) ) for m in [1, 2).
+        Float t = ( m - Set1( 1.0f ) ) / ( m + Set1( 1.0f ) );
+        Float t2 = t * t;
+        Float series = Set1( 1.0f / 11.0f );
+        series = MultiplyAdd( series, t2, Set1( 1.0f / 9.0f ) );
+        series = MultiplyAdd( series, t2, Set1( 1.0f / 7.0f ) );
+        series = MultiplyAdd( series, t2, Set1( 1.0f / 5.0f ) );
+        series = MultiplyAdd( series, t2, Set1( 1.0f / 3.0f ) );
+        series = MultiplyAdd( series, t2, Set1( 1.0f ) );
+
+        return exponent + Set1( 2.8853900817779268f ) * t * series;
+    }
+
+    /**
+     * Base 2 exponential. The input is clamped to [-126, 127] so the result
+     * is always a normalized float. The relative error is less than 2e-6.
+     */
+    inline Float Exp2( Float x )
+    {
+        x = Min( Max( x, Set1( -126.0f ) ), Set1( 127.0f ) );
+        Float i = Floor( x );
+        Float f = ( x - i ) * Set1( 0.6931471805599453f );
+
+        // Taylor series of e^f for f in [0, ln(2)).
+        Float series = Set1( 1.0f / 5040.0f );
+        series = MultiplyAdd( series, f, Set1( 1.0f / 720.0f ) );
+        series = MultiplyAdd( series, f, Set1( 1.0f / 120.0f ) );
+        series = MultiplyAdd( series, f, Set1( 1.0f / 24.0f ) );
+        series = MultiplyAdd( series, f, Set1( 1.0f / 6.0f ) );
+        series = MultiplyAdd( series, f, Set1( 0.5f ) );
+        series = MultiplyAdd( series, f, Set1( 1.0f ) );
+        series = MultiplyAdd( series, f, Set1( 1.0f ) );
+
+        return series * Pow2Int( i );
+    }
+
+    /**
+     * Raise non-negative values to the power p (like HLSL's pow which is
+     * also implemented as exp2( p * log2( x ) ) ). Returns 0 where x is 0.
+     */
+    inline Float Pow( Float x, float p )
+    {
+        return And( CmpGT( x, Zero() ), Exp2( Set1( p ) * Log2( x ) ) );
+    }
+
+    /**
+     * Sine and cosine of any angle in radians (like XMVectorSinCos).
+     * The absolute error is less than 1e-6 for angles in [-100, 100].
+     */
+    inline void SinCos( Float x, Float& sin, Float& cos )
+    {
+        // Reduce the angle to [-pi, pi] (2 pi is split in two constants to keep the precision).
+        Float quotient = Floor( x * Set1( 0.159154943f ) + Set1( 0.5f ) );
+        x = x - quotient * Set1( 6.28318548f );
+        x = x - quotient * Set1( -1.74845553e-7f );
+
+        // Reflect to [-pi/2, pi/2] where sin( pi - x ) = sin( x ) and cos( pi - x ) = -cos( x ).
+        Float inRange = CmpLE( Max( x, -x ), Set1( 1.57079637f ) );
+        Float reflected = Select( CmpLT( x, Zero() ), Set1( -3.14159274f ), Set1( 3.14159274f ) ) - x;
+        x = Select( inRange, x, reflected );
+        Float cosSign = Select( inRange, Set1( 1.0f ), Set1( -1.0f ) );
+
+        // Minimax polynomials (11th degree for sine, 10th degree for cosine).
+        Float x2 = x * x;
+        Float s = Set1( -2.3889859e-08f );
+        s = MultiplyAdd( s, x2, Set1( 2.7525562e-06f ) );
+        s = MultiplyAdd( s, x2, Set1( -0.00019840874f ) );
+        s = MultiplyAdd( s, x2, Set1( 0.0083333310f ) );
+        s = MultiplyAdd( s, x2, Set1( -0.16666667f ) );
+        s = MultiplyAdd( s, x2, Set1( 1.0f ) );
+        sin = s * x;
+
+        Float c = Set1( -2.6051615e-07f );
+        c = MultiplyAdd( c, x2, Set1( 2.4760495e-05f ) );
+        c = MultiplyAdd( c, x2, Set1( -0.0013888378f ) );
+        c = MultiplyAdd( c, x2, Set1( 0.041666638f ) );
+        c = MultiplyAdd( c, x2, Set1( -0.5f ) );
+        c = MultiplyAdd( c, x2, Set1( 1.0f ) );
+        cos = c * cosSign;
+    }
+
+    // A 3-component vector of SIMD registers (one vector per lane).
+    struct Float3
+    {
+        Float3() = default;
+        Float3( Float _x, Float _y, Float _z ) : x( _x ), y( _y ), z( _z ) {}
+        Float x, y, z;
+    };
+
+    inline Float3 operator+( const Float3& a, const Float3& b ) { return Float3( a.x + b.x, a.y + b.y, a.z + b.z ); }
+    inline Float3 operator-( const Float3& a, const Float3& b ) { return Float3( a.x - b.x, a.y - b.y, a.z - b.z ); }
+    inline Float3 operator*( const Float3& a, Float s ) { return Float3( a.x * s, a.y * s, a.z * s ); }
+    inline Float3 operator-( const Float3& a ) { return Float3( -a.x, -a.y, -a.z ); }
+
+    inline Float Dot( const Float3& a, const Float3& b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    inline Float3 Normalize( const Float3& a ) { return a * RSqrt( Dot( a, a ) ); }
+}
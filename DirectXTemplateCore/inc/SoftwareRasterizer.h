@@ -0,0 +1,241 @@
+/**
+ * @brief A multithreaded CPU implementation of the TextureAndLighting pipeline.
+ *
+ * The software rasterizer runs the same transforms as the SimpleVertexShader
+ * and InstancedVertexShader and the same lighting as the TexturedLitPixelShader.
+ * It consumes the VertexPositionNormalTexture geometry and the _Material and
+ * LightProperties constant buffer structs without modification so that it can
+ * be used as a golden-image reference for the D3D11 renderer and as a benchmark
+ * on platforms without a GPU.
+ *
+ * Triangles are transformed and set up on the thread that submits the draw call
+ * and binned into screen-space tiles. Flush() rasterizes and shades the tiles in
+ * parallel. The pixel shader is evaluated Simd::Width pixels at a time.
+ */
+#pragma once
+
+#include <Geometry.h>
+#include <Lighting.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// The layout of the PerObject constant buffer in SimpleVertexShader.hlsl.
+struct PerObjectConstants
+{
+    Math::Float4x4 WorldMatrix;
+    Math::Float4x4 InverseTransposeWorldMatrix;
+    Math::Float4x4 WorldViewProjectionMatrix;
+};
+
+// The per-instance vertex data consumed by InstancedVertexShader.hlsl.
+struct PerInstanceData
+{
+    Math::Float4x4 WorldMatrix;
+    Math::Float4x4 InverseTransposeWorldMatrix;
+};
+
+/**
+ * A 32-bit RGBA texture that is sampled with a bilinear filter and wrap addressing
+ * (the sampler state used by the TextureAndLighting demo).
+ */
+class SoftwareTexture
+{
+public:
+    /**
+     * @param width The width of the texture in texels.
+     * @param height The height of the texture in texels.
+     * @param rgbaTexels width * height texels, 4 bytes per texel in RGBA order.
+     */
+    SoftwareTexture( uint32_t width, uint32_t height, const uint8_t* rgbaTexels );
+
+    uint32_t get_Width() const;
+    uint32_t get_Height() const;
+
+    /**
+     * Sample the texture at the texture coordinate (u, v).
+     * @param rgba The filtered color in the range [0, 1].
+     */
+    void Sample( float u, float v, float rgba[4] ) const;
+
+private:
+    uint32_t m_Width;
+    uint32_t m_Height;
+    // The texels converted to floating-point (4 floats per texel).
+    std::vector<float> m_Texels;
+};
+
+class SoftwareRasterizer
+{
+public:
+    // The size of the screen-space tiles (in pixels) that are rasterized in parallel.
+    static const uint32_t TileSize = 64;
+
+    /**
+     * @param width The width of the render target.
+     * @param height The height of the render target.
+     * @param numThreads The number of threads used to rasterize the tiles.
+     * Use 0 to use all of the hardware threads.
+     */
+    SoftwareRasterizer( uint32_t width, uint32_t height, uint32_t numThreads = 0 );
+    virtual ~SoftwareRasterizer();
+
+    uint32_t get_Width() const;
+    uint32_t get_Height() const;
+
+    void set_NumThreads( uint32_t numThreads );
+    uint32_t get_NumThreads() const;
+
+    /**
+     * Clear the render target and the depth buffer.
+     * Any triangles that have not been flushed yet are discarded.
+     */
+    void Clear( const Math::Float4& color, float depth );
+
+    // Bind the MaterialProperties constant buffer (register b0).
+    void set_MaterialProperties( const MaterialProperties& materialProperties );
+    // Bind the LightProperties constant buffer (register b1).
+    void set_LightProperties( const LightProperties& lightProperties );
+    // Bind the texture (register t0). Use nullptr to unbind the texture.
+    void set_Texture( const SoftwareTexture* texture );
+
+    /**
+     * Draw indexed geometry using the SimpleVertexShader.
+     */
+    void DrawIndexed( const VertexCollection& vertices, const IndexCollection& indices, const PerObjectConstants& perObject );
+
+    /**
+     * Draw instanced geometry using the InstancedVertexShader.
+     * @param viewProjectionMatrix The PerFrame constant buffer.
+     */
+    void DrawIndexedInstanced( const VertexCollection& vertices, const IndexCollection& indices,
+        const PerInstanceData* instances, size_t numInstances, const Math::Float4x4& viewProjectionMatrix );
+
+    /**
+     * Rasterize all of the triangles that were submitted since the last flush.
+     */
+    void Flush();
+
+    /**
+     * The color buffer in R8G8B8A8_UNORM format (the same format as the
+     * buffer returned by Game::ReadBackBuffer).
+     */
+    const std::vector<uint8_t>& get_ColorBuffer() const;
+    /**
+     * The depth buffer. The rows of the depth buffer are padded to a multiple
+     * of the tile size. Use get_DepthPitch to get the number of floats per row.
+     */
+    const std::vector<float>& get_DepthBuffer() const;
+    uint32_t get_DepthPitch() const;
+
+    struct Statistics
+    {
+        // The number of triangles submitted in draw calls.
+        uint64_t TrianglesSubmitted;
+        // The number of triangles that survived clipping and back-face culling.
+        uint64_t TrianglesRasterized;
+        // The number of pixels that passed the depth test and were shaded.
+        uint64_t PixelsShaded;
+    };
+
+    const Statistics& get_Statistics() const;
+    void ResetStatistics();
+
+protected:
+    // A post-transform vertex (the output of the vertex shader).
+    struct ShadedVertex
+    {
+        Math::Float4 Position;      // SV_Position (clip-space)
+        Math::Float3 PositionWS;    // TEXCOORD1
+        Math::Float3 NormalWS;      // TEXCOORD2
+        Math::Float2 TexCoord;      // TEXCOORD0
+    };
+
+    // The number of interpolated attributes: PositionWS, NormalWS, and TexCoord.
+    static const int NumAttributes = 8;
+
+    // The plane equation a * x + b * y + c of a value that is interpolated in screen-space.
+    struct Plane
+    {
+        float a, b, c;
+    };
+
+    // A triangle that has been clipped, culled, and set up for rasterization.
+    struct Triangle
+    {
+        // The edge equations. A pixel is inside the triangle if all of the edge functions are positive.
+        Plane Edges[3];
+        // Edges that are not a top or left edge exclude the pixels that lie exactly on the edge.
+        bool Inclusive[3];
+        // The post-projection depth.
+        Plane Depth;
+        // 1 / w for perspective-correct interpolation.
+        Plane InvW;
+        // The vertex attributes divided by w.
+        Plane Attributes[NumAttributes];
+        // Screen-space bounds (in pixels) clamped to the render target.
+        int MinX, MinY, MaxX, MaxY;
+        // Index of the pipeline state that was bound when the triangle was submitted.
+        uint32_t StateIndex;
+    };
+
+    // The light properties that were bound when a draw call was issued
+    // together with the terms that are the same for every pixel.
+    struct LightingState
+    {
+        LightProperties Properties;
+        // The cosine of the spotlight angles (the smoothstep range of DoSpotCone).
+        float SpotMinCos[MAX_LIGHTS];
+        float SpotMaxCos[MAX_LIGHTS];
+    };
+
+    // The pixel shader state that was bound when a draw call was issued.
+    struct PipelineState
+    {
+        MaterialProperties Material;
+        uint32_t LightingStateIndex;
+        const SoftwareTexture* Texture;
+    };
+
+    // Run the vertex shader output through the fixed-function pipeline
+    // (clipping, culling, triangle setup, and binning).
+    void SubmitTriangles( const std::vector<ShadedVertex>& vertices, const IndexCollection& indices );
+    void SetupTriangle( const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2 );
+    void RasterizeTile( uint32_t tileIndex );
+    void ShadePixels( const PipelineState& state, const Triangle& triangle, int x, int y, int laneMask );
+
+    // Get the index of the pipeline state for the current bindings.
+    uint32_t GetPipelineState();
+
+private:
+    uint32_t m_Width;
+    uint32_t m_Height;
+    uint32_t m_NumThreads;
+
+    uint32_t m_TilesX;
+    uint32_t m_TilesY;
+
+    std::vector<uint8_t> m_ColorBuffer;
+    std::vector<float> m_DepthBuffer;
+
+    // Currently bound state.
+    MaterialProperties m_MaterialProperties;
+    LightProperties m_LightProperties;
+    const SoftwareTexture* m_Texture;
+    bool m_StateDirty;
+    bool m_LightPropertiesDirty;
+
+    // State captured for the triangles that are waiting to be flushed.
+    std::vector<PipelineState> m_PipelineStates;
+    std::vector<LightingState> m_LightingStates;
+    std::vector<Triangle> m_Triangles;
+    // The indices of the triangles that overlap each tile (in submission order).
+    std::vector< std::vector<uint32_t> > m_TileBins;
+
+    // Scratch space for the vertex shader output.
+    std::vector<ShadedVertex> m_ShadedVertices;
+
+    Statistics m_Statistics;
+    std::atomic<uint64_t> m_PixelsShaded;
+};
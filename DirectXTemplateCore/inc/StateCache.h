@@ -0,0 +1,99 @@
+/**
+ * @brief A shadow copy of the pipeline state in front of a RenderContext.
+ *
+ * The StateCache remembers the state that was last set on the wrapped context and
+ * only forwards the calls that change the state. Redundant calls are counted so that
+ * the number of state changes that were avoided can be reported per frame.
+ *
+ * If the wrapped context is used directly (bypassing the cache), call Invalidate
+ * before using the cache again.
+ */
+#pragma once
+
+#include <RenderContext.h>
+
+class StateCache : public RenderContext
+{
+public:
+    explicit StateCache( RenderContext& renderContext );
+    virtual ~StateCache();
+
+    /**
+     * Forget the shadow state. The next call to each of the Set
+     * functions is forwarded to the wrapped context.
+     */
+    void Invalidate();
+
+    virtual void SetInputLayout( StateHandle inputLayout );
+    virtual void SetPrimitiveTopology( uint32_t primitiveTopology );
+    virtual void SetVertexBuffer( uint32_t slot, const VertexBufferBinding& vertexBuffer );
+    virtual void SetIndexBuffer( StateHandle indexBuffer, uint32_t indexFormat );
+
+    virtual void SetVertexShader( StateHandle vertexShader );
+    virtual void SetVSConstantBuffer( uint32_t slot, const ConstantBufferBinding& constantBuffer );
+
+    virtual void SetRasterizerState( StateHandle rasterizerState );
+
+    virtual void SetPixelShader( StateHandle pixelShader );
+    virtual void SetPSConstantBuffer( uint32_t slot, const ConstantBufferBinding& constantBuffer );
+    virtual void SetPSShaderResource( uint32_t slot, StateHandle shaderResourceView );
+
+    virtual void SetDepthStencilState( StateHandle depthStencilState );
+    virtual void SetBlendState( StateHandle blendState );
+
+    virtual void DrawIndexed( uint32_t indexCount, uint32_t startIndex, int32_t baseVertex );
+    virtual void DrawIndexedInstanced( uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance );
+
+    struct Statistics
+    {
+        // The number of state changes that were forwarded to the wrapped context.
+        uint32_t StateChanges;
+        // The number of redundant state changes that were filtered out.
+        uint32_t StateChangesAvoided;
+        uint32_t DrawCalls;
+    };
+
+    const Statistics& get_Statistics() const;
+    void ResetStatistics();
+
+private:
+    StateCache( const StateCache& copy );
+    StateCache& operator=( const StateCache& other );
+
+    // Returns true (and updates the shadow copy) if the value differs from the shadow copy.
+    template<typename T>
+    bool Update( T& shadowValue, bool& valid, const T& value );
+
+    RenderContext& m_RenderContext;
+
+    // The shadow copy of the state of the wrapped context and a flag that
+    // indicates whether the shadow copy of each state is known.
+    StateHandle m_InputLayout;
+    uint32_t m_PrimitiveTopology;
+    VertexBufferBinding m_VertexBuffers[MaxVertexBuffers];
+    StateHandle m_IndexBuffer;
+    uint32_t m_IndexFormat;
+    StateHandle m_VertexShader;
+    ConstantBufferBinding m_VSConstantBuffers[MaxConstantBuffers];
+    StateHandle m_RasterizerState;
+    StateHandle m_PixelShader;
+    ConstantBufferBinding m_PSConstantBuffers[MaxConstantBuffers];
+    StateHandle m_PSShaderResources[MaxShaderResources];
+    StateHandle m_DepthStencilState;
+    StateHandle m_BlendState;
+
+    bool m_InputLayoutValid;
+    bool m_PrimitiveTopologyValid;
+    bool m_VertexBuffersValid[MaxVertexBuffers];
+    bool m_IndexBufferValid;
+    bool m_VertexShaderValid;
+    bool m_VSConstantBuffersValid[MaxConstantBuffers];
+    bool m_RasterizerStateValid;
+    bool m_PixelShaderValid;
+    bool m_PSConstantBuffersValid[MaxConstantBuffers];
+    bool m_PSShaderResourcesValid[MaxShaderResources];
+    bool m_DepthStencilStateValid;
+    bool m_BlendStateValid;
+
+    Statistics m_Statistics;
+};
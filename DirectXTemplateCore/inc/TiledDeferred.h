@@ -0,0 +1,210 @@
+/**
+ * @brief The CPU reference of the tiled deferred shading path.
+ *
+ * The G-buffer pass (GBufferPixelShader.hlsl) writes four render targets:
+ *
+ *   0 Albedo    R8G8B8A8_UNORM  Material.Diffuse * texture, the specular power in alpha
+ *   1 Specular  R8G8B8A8_UNORM  Material.Specular * texture
+ *   2 Normal    R16G16_SNORM    The world-space normal (octahedral, see VertexFormats.h)
+ *   3 Ambient   R8G8B8A8_UNORM  ( Material.Emissive + Material.Ambient * GlobalAmbient ) * texture
+ *
+ * The lighting pass (TiledDeferredComputeShader.hlsl) runs one thread group per
+ * TileSize x TileSize pixels. The group finds the depth bounds of its tile, culls the
+ * view-space bounding spheres of the lights against the four planes of the tile and
+ * the depth bounds, and shades its pixels with the lights that are left. Each pixel
+ * is shaded once, however many objects overlap it.
+ *
+ * EncodeGBuffer, DecodeGBuffer, ShadeGBuffer and TiledLightCulling do the same
+ * arithmetic as the shaders so the deferred path can be checked and measured
+ * without a GPU. ShadeForward is the lighting of TexturedLitPixelShader.hlsl. The
+ * shadows are left out of both (they are checked by the ShadowMaps tests).
+ */
+#pragma once
+
+#include <BoundingVolumes.h>
+#include <Camera.h>
+#include <LightClusters.h>
+#include <Lighting.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// The specular power is stored as log2( power ) / log2( MaxSpecularPower ) in 8 bits.
+const float MaxSpecularPower = 1024.0f;
+
+// The G-buffer of one pixel, in the formats of the render targets.
+struct GBufferTexel
+{
+    uint32_t Albedo;
+    uint32_t Specular;
+    int16_t Normal[2];
+    uint32_t Ambient;
+};
+
+// A decoded G-buffer texel.
+struct GBufferSample
+{
+    Math::Float3 Albedo;
+    Math::Float3 Specular;
+    float SpecularPower;
+    Math::Float3 Normal;
+    Math::Float3 Ambient;
+};
+
+// The largest errors of a decoded G-buffer texel (checked by the TiledDeferred tests).
+namespace GBufferErrorBounds
+{
+    // The absolute error of a color channel in [0, 1].
+    const float Color = 0.5f / 255.0f + 1e-6f;
+    // The relative error of the specular power (half an 8-bit step of the exponent).
+    const float SpecularPowerRelative = 0.014f;
+    // The angle between a normal and the decoded normal in radians.
+    const float NormalAngle = 1e-4f;
+}
+
+/**
+ * Encode the outputs of the G-buffer pass for one pixel.
+ * @param texColor The texture color (1 if the material is not textured).
+ * @param normal The unit world-space normal.
+ */
+GBufferTexel EncodeGBuffer( const _Material& material, const Math::Float4& texColor, const Math::Float3& normal, const Math::Float4& globalAmbient );
+GBufferSample DecodeGBuffer( const GBufferTexel& texel );
+
+/**
+ * The color of the TexturedLitPixelShader for a pixel that is lit by all of the
+ * lights (the alpha channel is ignored).
+ */
+Math::Float3 ShadeForward( const _Material& material, const Math::Float4& texColor, const Math::Float3& position,
+    const Math::Float3& normal, const Math::Float3& eyePosition, const Math::Float4& globalAmbient, const std::vector<Light>& lights );
+
+/**
+ * The color of the lighting pass for a G-buffer sample and the lights of its tile.
+ */
+Math::Float3 ShadeGBuffer( const GBufferSample& sample, const Math::Float3& position, const Math::Float3& eyePosition,
+    const std::vector<Light>& lights, const uint32_t* lightIndices, size_t numLightIndices );
+
+// The layout of the TiledDeferredConstants constant buffer in TiledDeferredComputeShader.hlsl.
+struct TiledDeferredConstants
+{
+    Math::Float4x4 InverseViewMatrix;
+    //----------------------------------- (16 byte boundary)
+    Math::Float4 EyePosition;
+    //----------------------------------- (16 byte boundary)
+    // view x = ndc x * z / ProjectionScaleX, view y = ndc y * z / ProjectionScaleY
+    float ProjectionScaleX;
+    float ProjectionScaleY;
+    // view z = DepthScale / ( depth - DepthBias )
+    float DepthScale;
+    float DepthBias;
+    //----------------------------------- (16 byte boundary)
+    uint32_t ScreenWidth;
+    uint32_t ScreenHeight;
+    uint32_t NumLights;
+    uint32_t Padding;
+    //----------------------------------- (16 byte boundary)
+};  // Total:                           112 bytes (7 * 16)
+
+static_assert( sizeof( TiledDeferredConstants ) == 112, "TiledDeferredConstants must match the constant buffer in TiledDeferredComputeShader.hlsl." );
+
+// The constants of the lighting pass for a camera with a left-handed perspective projection.
+TiledDeferredConstants ComputeTiledDeferredConstants( const Camera& camera, uint32_t screenWidth, uint32_t screenHeight, uint32_t numLights );
+
+class TiledLightCulling
+{
+public:
+    // The size of the tiles in pixels (the thread group size of the compute shader).
+    static const uint32_t TileSize = 16;
+    // The size of the light list of a tile in the compute shader. Lights beyond it are dropped.
+    static const uint32_t MaxLightsPerTile = 512;
+
+    TiledLightCulling( uint32_t width = 1280, uint32_t height = 720 );
+
+    void Resize( uint32_t width, uint32_t height );
+
+    uint32_t get_Width() const;
+    uint32_t get_Height() const;
+    uint32_t get_NumTilesX() const;
+    uint32_t get_NumTilesY() const;
+    uint32_t get_NumTiles() const;
+
+    /**
+     * Set the left-handed perspective projection of the depth buffer (see
+     * Camera::set_Projection).
+     */
+    void SetProjection( const Math::Float4x4& projectionMatrix );
+    void SetProjection( const Camera& camera );
+
+    // The view-space depth of a post-projection depth.
+    float ViewDepth( float depth ) const;
+
+    /**
+     * Cull the lights against every tile.
+     * @param depthBuffer The post-projection depths of the pixels. Pixels with a depth
+     * of 1 (the clear value) are not part of any object and do not extend the depth
+     * bounds of their tile.
+     * @param depthPitch The number of floats per row of the depth buffer.
+     * @param lights The view-space bounding spheres of the lights.
+     * @param jobSystem Cull the rows of tiles in parallel (optional). Call
+     * CullLights from a thread of the JobSystem.
+     */
+    void CullLights( const float* depthBuffer, uint32_t depthPitch, const BoundingSphereArrays& lights, JobSystem* jobSystem = nullptr );
+
+    // The lights of the tiles, ordered by row (top to bottom) and column (left to right).
+    const std::vector<LightCluster>& get_Tiles() const;
+    // The light indices of the tiles. The lights of a tile are in ascending order.
+    const std::vector<uint32_t>& get_LightIndices() const;
+
+    uint32_t GetTileIndex( uint32_t x, uint32_t y ) const;
+    /**
+     * The view-space depth bounds of a tile after CullLights. The minimum is larger
+     * than the maximum if no pixel of the tile has any geometry.
+     */
+    void GetTileDepthBounds( uint32_t tileIndex, float& minDepth, float& maxDepth ) const;
+    // Returns true if a view-space sphere is in a tile (the test of CullLights).
+    bool Intersects( const BoundingSphere& sphere, uint32_t tileIndex ) const;
+
+    // The number of tiles with more than MaxLightsPerTile lights in the last CullLights.
+    uint32_t get_NumOverflowTiles() const;
+
+    // The memory used by the tile lists and the work arrays in bytes.
+    size_t get_MemoryUsage() const;
+
+private:
+    TiledLightCulling( const TiledLightCulling& copy );
+    TiledLightCulling& operator=( const TiledLightCulling& other );
+
+    void UpdatePlanes();
+    void ComputeDepthBounds( const float* depthBuffer, uint32_t depthPitch, uint32_t row );
+    void CullRow( uint32_t row );
+
+    uint32_t m_Width;
+    uint32_t m_Height;
+    uint32_t m_NumTilesX;
+    uint32_t m_NumTilesY;
+
+    Math::Float4x4 m_ProjectionMatrix;
+
+    // The planes between the tiles go through the eye (see LightClusters). The signed
+    // distance of a point to plane k is x * m_PlaneX[k] + z * m_PlaneXZ[k] (columns) or
+    // y * m_PlaneY[k] + z * m_PlaneYZ[k] (rows), and is positive on the side of the
+    // tiles with the larger index.
+    std::vector<float> m_PlaneX, m_PlaneXZ;
+    std::vector<float> m_PlaneY, m_PlaneYZ;
+
+    std::vector<float> m_TileMinDepth;
+    std::vector<float> m_TileMaxDepth;
+
+    // The lights, padded with empty spheres to a multiple of Simd::Width.
+    std::vector<float> m_CenterX, m_CenterY, m_CenterZ, m_Radius;
+    size_t m_NumLights;
+
+    // The light lists of each row of tiles before they are concatenated.
+    std::vector< std::vector<uint32_t> > m_RowIndices;
+
+    std::vector<LightCluster> m_Tiles;
+    std::vector<uint32_t> m_LightIndices;
+    uint32_t m_NumOverflowTiles;
+};
@@ -0,0 +1,93 @@
+/**
+ * @brief Compact vertex formats that can be used instead of VertexPositionNormalTexture.
+ *
+ * VertexPositionNormalTexture stores 32 bytes of floats per vertex. The formats in
+ * this file store the same attributes in 16 bytes to halve the vertex fetch
+ * bandwidth:
+ *
+ *  - VertexPositionNormalTextureHalf stores the position as half floats.
+ *  - VertexPositionNormalTextureQuantized stores the position as 16-bit unsigned
+ *    normalized values relative to the bounding box of the mesh. Multiply the
+ *    world matrix by PositionDequantizationMatrix( box ) to undo the quantization.
+ *
+ * Both formats store the normal octahedral-encoded in 2 x 16-bit SNORM and the
+ * texture coordinates as 2 x 16-bit UNORM (texture coordinates must be in the
+ * range [0, 1]). The w component of the position is 1 so that the shaders can
+ * transform the position without expanding it.
+ *
+ * The error bounds below are the largest errors of a decoded attribute and are
+ * checked by the VertexFormat tests.
+ */
+#pragma once
+
+#include <BoundingVolumes.h>
+#include <Geometry.h>
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+struct VertexPositionNormalTextureHalf
+{
+    // DXGI_FORMAT_R16G16B16A16_FLOAT
+    uint16_t position[4];
+    // DXGI_FORMAT_R16G16_SNORM (octahedral)
+    int16_t normal[2];
+    // DXGI_FORMAT_R16G16_UNORM
+    uint16_t textureCoordinate[2];
+};
+
+struct VertexPositionNormalTextureQuantized
+{
+    // DXGI_FORMAT_R16G16B16A16_UNORM (relative to the bounding box of the mesh)
+    uint16_t position[4];
+    // DXGI_FORMAT_R16G16_SNORM (octahedral)
+    int16_t normal[2];
+    // DXGI_FORMAT_R16G16_UNORM
+    uint16_t textureCoordinate[2];
+};
+
+typedef std::vector<VertexPositionNormalTextureHalf> HalfVertexCollection;
+typedef std::vector<VertexPositionNormalTextureQuantized> QuantizedVertexCollection;
+
+namespace VertexErrorBounds
+{
+    // The relative error of a half-float position (half a unit in the last place).
+    const float HalfPositionRelative = 1.0f / 2048.0f;
+    // The error of a quantized position relative to the size of the bounding box
+    // (half a quantization step plus the rounding of the float arithmetic).
+    const float QuantizedPositionRelative = 0.5f / 65535.0f + 2.0f * FLT_EPSILON;
+    // The angle between a normal and the decoded normal in radians.
+    const float NormalAngle = 1e-4f;
+    // The absolute error of a texture coordinate.
+    const float TextureCoordinate = 0.5f / 65535.0f;
+}
+
+// Convert to and from IEEE half floats (round to nearest even).
+uint16_t FloatToHalf( float value );
+float HalfToFloat( uint16_t value );
+
+// Encode a unit vector with the octahedral mapping in 2 x 16-bit SNORM.
+void EncodeOctahedral( const Math::Float3& normal, int16_t encoded[2] );
+Math::Float3 DecodeOctahedral( const int16_t encoded[2] );
+
+/**
+ * Encode vertices in the half-precision format. The normals and texture coordinates
+ * are encoded Simd::Width vertices at a time.
+ */
+void EncodeVertices( const VertexCollection& vertices, HalfVertexCollection& encodedVertices );
+void DecodeVertices( const HalfVertexCollection& encodedVertices, VertexCollection& vertices );
+
+/**
+ * Encode vertices in the quantized format.
+ * @param box The bounding box of the vertices (see ComputeBoundingBox). Positions
+ * outside of the box are clamped.
+ */
+void EncodeVertices( const VertexCollection& vertices, const BoundingBox& box, QuantizedVertexCollection& encodedVertices );
+void DecodeVertices( const QuantizedVertexCollection& encodedVertices, const BoundingBox& box, VertexCollection& vertices );
+
+/**
+ * The matrix that transforms the quantized positions in the range [0, 1] back to
+ * object space. Multiply it with the world matrix ( dequantization * world ).
+ */
+Math::Float4x4 PositionDequantizationMatrix( const BoundingBox& box );
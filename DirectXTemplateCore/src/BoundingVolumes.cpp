@@ -0,0 +1,26 @@
+#include <DirectXTemplateCorePCH.h>
+#include <BoundingVolumes.h>
+
+using namespace Math;
+
+BoundingSphere Transform( const BoundingSphere& sphere, const Float4x4& matrix )
+{
+    float scaleSq = std::max( std::max(
+        LengthSq( Float3( matrix.m[0][0], matrix.m[0][1], matrix.m[0][2] ) ),
+        LengthSq( Float3( matrix.m[1][0], matrix.m[1][1], matrix.m[1][2] ) ) ),
+        LengthSq( Float3( matrix.m[2][0], matrix.m[2][1], matrix.m[2][2] ) ) );
+
+    return BoundingSphere( TransformPoint( sphere.Center, matrix ), sphere.Radius * std::sqrt( scaleSq ) );
+}
+
+BoundingBox Transform( const BoundingBox& box, const Float4x4& matrix )
+{
+    // Each extent of the new box is the sum of the absolute values of the
+    // transformed axes of the original box projected onto that axis.
+    Float3 extents;
+    extents.x = std::abs( matrix.m[0][0] ) * box.Extents.x + std::abs( matrix.m[1][0] ) * box.Extents.y + std::abs( matrix.m[2][0] ) * box.Extents.z;
+    extents.y = std::abs( matrix.m[0][1] ) * box.Extents.x + std::abs( matrix.m[1][1] ) * box.Extents.y + std::abs( matrix.m[2][1] ) * box.Extents.z;
+    extents.z = std::abs( matrix.m[0][2] ) * box.Extents.x + std::abs( matrix.m[1][2] ) * box.Extents.y + std::abs( matrix.m[2][2] ) * box.Extents.z;
+
+    return BoundingBox( TransformPoint( box.Center, matrix ), extents );
+}
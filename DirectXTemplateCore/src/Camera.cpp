@@ -0,0 +1,263 @@
+#include <DirectXTemplateCorePCH.h>
+#include <Camera.h>
+
+using namespace Math;
+
+Camera::Camera( Handedness handedness )
+    : m_Translation( 0.0f, 0.0f, 0.0f )
+    , m_Rotation( QuaternionIdentity() )
+    , m_vFoV( 45.0f )
+    , m_AspectRatio( 1.0f )
+    , m_zNear( 0.1f )
+    , m_zFar( 100.0f )
+    , m_ViewDirty( true )
+    , m_InverseViewDirty( true )
+    , m_ProjectionDirty( true )
+    , m_InverseProjectionDirty( true )
+    , m_FrustumDirty( true )
+    , m_Handedness( handedness )
+{
+    Viewport viewport = { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+    m_Viewport = viewport;
+}
+
+Camera::~Camera()
+{}
+
+void Camera::set_Viewport( const Viewport& viewport )
+{
+    m_Viewport = viewport;
+}
+
+const Viewport& Camera::get_Viewport() const
+{
+    return m_Viewport;
+}
+
+void Camera::set_LookAt( const Float3& eye, const Float3& target, const Float3& up )
+{
+    switch ( m_Handedness )
+    {
+    case LeftHanded:
+        {
+            m_ViewMatrix = MatrixLookAtLH( eye, target, up );
+        }
+        break;
+    case RightHanded:
+        {
+            m_ViewMatrix = MatrixLookAtRH( eye, target, up );
+        }
+        break;
+    }
+
+    m_Translation = eye;
+    m_Rotation = QuaternionRotationMatrix( MatrixTranspose(m_ViewMatrix) );
+
+    m_InverseViewDirty = true;
+    m_FrustumDirty = true;
+    m_ViewDirty = false;
+}
+
+const Float4x4& Camera::get_ViewMatrix() const
+{
+    if ( m_ViewDirty )
+    {
+        UpdateViewMatrix();
+    }
+    return m_ViewMatrix;
+}
+
+const Float4x4& Camera::get_InverseViewMatrix() const
+{
+    if ( m_InverseViewDirty )
+    {
+        UpdateInverseViewMatrix();
+    }
+
+    return m_InverseViewMatrix;
+}
+
+void Camera::set_Projection( float fovy, float aspect, float zNear, float zFar )
+{
+    m_vFoV = fovy;
+    m_AspectRatio = aspect;
+    m_zNear = zNear;
+    m_zFar = zFar;
+
+    m_ProjectionDirty = true;
+    m_InverseProjectionDirty = true;
+    m_FrustumDirty = true;
+}
+
+const Float4x4& Camera::get_ProjectionMatrix() const
+{
+    if ( m_ProjectionDirty )
+    {
+        UpdateProjectionMatrix();
+    }
+
+    return m_ProjectionMatrix;
+}
+
+const Float4x4& Camera::get_InverseProjectionMatrix() const
+{
+    if ( m_InverseProjectionDirty )
+    {
+        UpdateInverseProjectionMatrix();
+    }
+
+    return m_InverseProjectionMatrix;
+}
+
+float Camera::get_VerticalFieldOfView() const
+{
+    return m_vFoV;
+}
+
+float Camera::get_AspectRatio() const
+{
+    return m_AspectRatio;
+}
+
+float Camera::get_NearClipPlane() const
+{
+    return m_zNear;
+}
+
+float Camera::get_FarClipPlane() const
+{
+    return m_zFar;
+}
+
+float Camera::ProjectedSize( float size, float distance ) const
+{
+    float tanHalfFoV = tanf( ConvertToRadians( m_vFoV ) * 0.5f );
+    return size * m_Viewport.Height / ( 2.0f * tanHalfFoV * distance );
+}
+
+const Frustum& Camera::get_Frustum() const
+{
+    if ( m_FrustumDirty )
+    {
+        UpdateFrustum();
+    }
+
+    return m_Frustum;
+}
+
+void Camera::set_Translation( const Float3& translation )
+{
+    m_Translation = translation;
+
+    m_ViewDirty = true;
+    m_InverseViewDirty = true;
+    m_FrustumDirty = true;
+}
+
+const Float3& Camera::get_Translation() const
+{
+    return m_Translation;
+}
+
+void Camera::set_Rotation( const Float4& rotation )
+{
+    m_Rotation = rotation;
+
+    m_ViewDirty = true;
+    m_InverseViewDirty = true;
+    m_FrustumDirty = true;
+}
+
+const Float4& Camera::get_Rotation() const
+{
+    return m_Rotation;
+}
+
+void Camera::Translate( const Float3& translation, Space space )
+{
+    switch ( space )
+    {
+    case LocalSpace:
+        {
+            m_Translation += Vector3Rotate( translation, m_Rotation );
+        }
+        break;
+    case WorldSpace:
+        {
+            m_Translation += translation;
+        }
+        break;
+    }
+
+    m_ViewDirty = true;
+    m_InverseViewDirty = true;
+    m_FrustumDirty = true;
+}
+
+void Camera::Rotate( const Float4& quaternion )
+{
+    m_Rotation = QuaternionMultiply( m_Rotation, quaternion );
+
+    m_ViewDirty = true;
+    m_InverseViewDirty = true;
+    m_FrustumDirty = true;
+}
+
+void Camera::UpdateViewMatrix() const
+{
+    Float4x4 rotationMatrix = MatrixTranspose( MatrixRotationQuaternion( m_Rotation ) );
+    Float4x4 translationMatrix = MatrixTranslation( -m_Translation );
+
+    m_ViewMatrix = translationMatrix * rotationMatrix;
+
+    m_InverseViewDirty = true;
+    m_ViewDirty = false;
+}
+
+void Camera::UpdateInverseViewMatrix() const
+{
+    if ( m_ViewDirty )
+    {
+        UpdateViewMatrix();
+    }
+
+    m_InverseViewMatrix = MatrixInverse( m_ViewMatrix );
+    m_InverseViewDirty = false;
+}
+
+void Camera::UpdateProjectionMatrix() const
+{
+    switch( m_Handedness )
+    {
+    case LeftHanded:
+        {
+            m_ProjectionMatrix = MatrixPerspectiveFovLH( ConvertToRadians(m_vFoV), m_AspectRatio, m_zNear, m_zFar );
+        }
+        break;
+    case RightHanded:
+        {
+            m_ProjectionMatrix = MatrixPerspectiveFovRH( ConvertToRadians(m_vFoV), m_AspectRatio, m_zNear, m_zFar );
+        }
+        break;
+    }
+
+    m_ProjectionDirty = false;
+    m_InverseProjectionDirty = true;
+}
+
+void Camera::UpdateInverseProjectionMatrix() const
+{
+    if ( m_ProjectionDirty )
+    {
+        UpdateProjectionMatrix();
+    }
+
+    m_InverseProjectionMatrix = MatrixInverse( m_ProjectionMatrix );
+    m_InverseProjectionDirty = false;
+}
+
+void Camera::UpdateFrustum() const
+{
+    m_Frustum = Frustum( get_ViewMatrix() * get_ProjectionMatrix() );
+    m_FrustumDirty = false;
+}
@@ -0,0 +1,207 @@
+#include <DirectXTemplateCorePCH.h>
+#include <Clock.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(_WIN32)
+
+int64_t Clock::GetTicks()
+{
+    LARGE_INTEGER ticks;
+    QueryPerformanceCounter( &ticks );
+    return ticks.QuadPart;
+}
+
+int64_t Clock::GetFrequency()
+{
+    // The frequency is fixed at boot.
+    static const int64_t frequency = []()
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency( &frequency );
+        return frequency.QuadPart;
+    }();
+    return frequency;
+}
+
+#else
+
+int64_t Clock::GetTicks()
+{
+    timespec time;
+    clock_gettime( CLOCK_MONOTONIC, &time );
+    return static_cast<int64_t>( time.tv_sec ) * 1000000000 + time.tv_nsec;
+}
+
+int64_t Clock::GetFrequency()
+{
+    return 1000000000;
+}
+
+#endif
+
+double Clock::TicksToSeconds( int64_t ticks )
+{
+    return static_cast<double>( ticks ) / static_cast<double>( GetFrequency() );
+}
+
+int64_t Clock::SecondsToTicks( double seconds )
+{
+    return static_cast<int64_t>( std::llround( seconds * static_cast<double>( GetFrequency() ) ) );
+}
+
+Clock::Clock()
+    : m_PreviousTicks( GetTicks() )
+    , m_MaxDeltaTicks( 0 )
+    , m_DeltaTicks( 0 )
+    , m_TotalTicks( 0 )
+    , m_FrameCount( 0 )
+{}
+
+void Clock::Tick()
+{
+    int64_t ticks = GetTicks();
+    int64_t deltaTicks = std::max<int64_t>( ticks - m_PreviousTicks, 0 );
+    m_PreviousTicks = ticks;
+
+    if ( m_MaxDeltaTicks > 0 )
+    {
+        deltaTicks = std::min( deltaTicks, m_MaxDeltaTicks );
+    }
+    Advance( deltaTicks );
+}
+
+void Clock::Advance( int64_t deltaTicks )
+{
+    m_DeltaTicks = deltaTicks;
+    m_TotalTicks += deltaTicks;
+    ++m_FrameCount;
+}
+
+void Clock::Reset()
+{
+    m_PreviousTicks = GetTicks();
+    m_DeltaTicks = 0;
+    m_TotalTicks = 0;
+    m_FrameCount = 0;
+}
+
+int64_t Clock::get_MaxDeltaTicks() const
+{
+    return m_MaxDeltaTicks;
+}
+
+void Clock::set_MaxDeltaTicks( int64_t maxDeltaTicks )
+{
+    m_MaxDeltaTicks = std::max<int64_t>( maxDeltaTicks, 0 );
+}
+
+int64_t Clock::get_DeltaTicks() const
+{
+    return m_DeltaTicks;
+}
+
+int64_t Clock::get_TotalTicks() const
+{
+    return m_TotalTicks;
+}
+
+double Clock::get_DeltaSeconds() const
+{
+    return TicksToSeconds( m_DeltaTicks );
+}
+
+double Clock::get_TotalSeconds() const
+{
+    return TicksToSeconds( m_TotalTicks );
+}
+
+uint64_t Clock::get_FrameCount() const
+{
+    return m_FrameCount;
+}
+
+FixedTimestep::FixedTimestep( uint32_t stepsPerSecond, int64_t frequency, uint32_t maxStepsPerAdvance )
+    : m_StepsPerSecond( stepsPerSecond )
+    , m_Frequency( frequency )
+    , m_MaxStepsPerAdvance( maxStepsPerAdvance )
+    , m_Accumulator( 0 )
+    , m_NumSteps( 0 )
+    , m_DroppedTicks( 0 )
+{
+    if ( stepsPerSecond == 0 || frequency <= 0 || maxStepsPerAdvance == 0 )
+    {
+        throw std::invalid_argument( "The steps per second, the frequency and the steps per advance must be positive." );
+    }
+}
+
+uint32_t FixedTimestep::Advance( int64_t deltaTicks )
+{
+    m_Accumulator += std::max<int64_t>( deltaTicks, 0 ) * m_StepsPerSecond;
+
+    uint64_t numSteps = static_cast<uint64_t>( m_Accumulator / m_Frequency );
+    if ( numSteps > m_MaxStepsPerAdvance )
+    {
+        // Drop the whole steps beyond the limit but keep the fraction of the next step.
+        uint64_t numDropped = numSteps - m_MaxStepsPerAdvance;
+        m_DroppedTicks += static_cast<int64_t>( numDropped ) * m_Frequency / m_StepsPerSecond;
+        numSteps = m_MaxStepsPerAdvance;
+        m_Accumulator -= static_cast<int64_t>( numDropped ) * m_Frequency;
+    }
+
+    m_Accumulator -= static_cast<int64_t>( numSteps ) * m_Frequency;
+    m_NumSteps += numSteps;
+    return static_cast<uint32_t>( numSteps );
+}
+
+void FixedTimestep::Reset()
+{
+    m_Accumulator = 0;
+    m_NumSteps = 0;
+    m_DroppedTicks = 0;
+}
+
+uint32_t FixedTimestep::get_StepsPerSecond() const
+{
+    return m_StepsPerSecond;
+}
+
+double FixedTimestep::get_StepSeconds() const
+{
+    return 1.0 / m_StepsPerSecond;
+}
+
+uint64_t FixedTimestep::get_NumSteps() const
+{
+    return m_NumSteps;
+}
+
+double FixedTimestep::get_TotalSeconds() const
+{
+    return static_cast<double>( m_NumSteps ) / m_StepsPerSecond;
+}
+
+double FixedTimestep::get_Alpha() const
+{
+    return static_cast<double>( m_Accumulator ) / static_cast<double>( m_Frequency );
+}
+
+double FixedTimestep::get_InterpolatedSeconds() const
+{
+    if ( m_NumSteps == 0 )
+    {
+        return 0.0;
+    }
+    return ( static_cast<double>( m_NumSteps - 1 ) + get_Alpha() ) / m_StepsPerSecond;
+}
+
+int64_t FixedTimestep::get_DroppedTicks() const
+{
+    return m_DroppedTicks;
+}
@@ -0,0 +1,319 @@
+#include <DirectXTemplateCorePCH.h>
+#include <CoreMath.h>
+
+namespace Math
+{
+
+Float4x4::Float4x4( float m00, float m01, float m02, float m03,
+                    float m10, float m11, float m12, float m13,
+                    float m20, float m21, float m22, float m23,
+                    float m30, float m31, float m32, float m33 )
+{
+    m[0][0] = m00; m[0][1] = m01; m[0][2] = m02; m[0][3] = m03;
+    m[1][0] = m10; m[1][1] = m11; m[1][2] = m12; m[1][3] = m13;
+    m[2][0] = m20; m[2][1] = m21; m[2][2] = m22; m[2][3] = m23;
+    m[3][0] = m30; m[3][1] = m31; m[3][2] = m32; m[3][3] = m33;
+}
+
+Float4x4 MatrixIdentity()
+{
+    return Float4x4( 1, 0, 0, 0,
+                     0, 1, 0, 0,
+                     0, 0, 1, 0,
+                     0, 0, 0, 1 );
+}
+
+Float4x4 MatrixMultiply( const Float4x4& a, const Float4x4& b )
+{
+    Float4x4 result;
+    for ( int i = 0; i < 4; ++i )
+    {
+        for ( int j = 0; j < 4; ++j )
+        {
+            result.m[i][j] = a.m[i][0] * b.m[0][j]
+                           + a.m[i][1] * b.m[1][j]
+                           + a.m[i][2] * b.m[2][j]
+                           + a.m[i][3] * b.m[3][j];
+        }
+    }
+    return result;
+}
+
+Float4x4 MatrixTranspose( const Float4x4& m )
+{
+    return Float4x4( m.m[0][0], m.m[1][0], m.m[2][0], m.m[3][0],
+                     m.m[0][1], m.m[1][1], m.m[2][1], m.m[3][1],
+                     m.m[0][2], m.m[1][2], m.m[2][2], m.m[3][2],
+                     m.m[0][3], m.m[1][3], m.m[2][3], m.m[3][3] );
+}
+
+// General 4x4 inverse using the cofactor expansion.
+// Returns the identity matrix if the matrix is singular.
+Float4x4 MatrixInverse( const Float4x4& mat )
+{
+    const float* m = &mat.m[0][0];
+    float inv[16];
+
+    inv[0]  =  m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4]  = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8]  =  m[4] * m[9]  * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9]  * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1]  = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5]  =  m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9]  = -m[0] * m[9]  * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] =  m[0] * m[9]  * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2]  =  m[1] * m[6]  * m[15] - m[1] * m[7]  * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7]  - m[13] * m[3] * m[6];
+    inv[6]  = -m[0] * m[6]  * m[15] + m[0] * m[7]  * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7]  + m[12] * m[3] * m[6];
+    inv[10] =  m[0] * m[5]  * m[15] - m[0] * m[7]  * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7]  - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5]  * m[14] + m[0] * m[6]  * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6]  + m[12] * m[2] * m[5];
+    inv[3]  = -m[1] * m[6]  * m[11] + m[1] * m[7]  * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9]  * m[2] * m[7]  + m[9]  * m[3] * m[6];
+    inv[7]  =  m[0] * m[6]  * m[11] - m[0] * m[7]  * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8]  * m[2] * m[7]  - m[8]  * m[3] * m[6];
+    inv[11] = -m[0] * m[5]  * m[11] + m[0] * m[7]  * m[9]  + m[4] * m[1] * m[11] - m[4] * m[3] * m[9]  - m[8]  * m[1] * m[7]  + m[8]  * m[3] * m[5];
+    inv[15] =  m[0] * m[5]  * m[10] - m[0] * m[6]  * m[9]  - m[4] * m[1] * m[10] + m[4] * m[2] * m[9]  + m[8]  * m[1] * m[6]  - m[8]  * m[2] * m[5];
+
+    float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if ( det == 0.0f )
+    {
+        return MatrixIdentity();
+    }
+
+    float invDet = 1.0f / det;
+
+    Float4x4 result;
+    float* r = &result.m[0][0];
+    for ( int i = 0; i < 16; ++i )
+    {
+        r[i] = inv[i] * invDet;
+    }
+
+    return result;
+}
+
+Float4x4 MatrixTranslation( float x, float y, float z )
+{
+    return Float4x4( 1, 0, 0, 0,
+                     0, 1, 0, 0,
+                     0, 0, 1, 0,
+                     x, y, z, 1 );
+}
+
+Float4x4 MatrixTranslation( const Float3& translation )
+{
+    return MatrixTranslation( translation.x, translation.y, translation.z );
+}
+
+Float4x4 MatrixScaling( float x, float y, float z )
+{
+    return Float4x4( x, 0, 0, 0,
+                     0, y, 0, 0,
+                     0, 0, z, 0,
+                     0, 0, 0, 1 );
+}
+
+Float4x4 MatrixRotationX( float angle )
+{
+    float s, c;
+    ScalarSinCos( &s, &c, angle );
+
+    return Float4x4( 1,  0, 0, 0,
+                     0,  c, s, 0,
+                     0, -s, c, 0,
+                     0,  0, 0, 1 );
+}
+
+Float4x4 MatrixRotationY( float angle )
+{
+    float s, c;
+    ScalarSinCos( &s, &c, angle );
+
+    return Float4x4( c, 0, -s, 0,
+                     0, 1,  0, 0,
+                     s, 0,  c, 0,
+                     0, 0,  0, 1 );
+}
+
+Float4x4 MatrixRotationZ( float angle )
+{
+    float s, c;
+    ScalarSinCos( &s, &c, angle );
+
+    return Float4x4(  c, s, 0, 0,
+                     -s, c, 0, 0,
+                      0, 0, 1, 0,
+                      0, 0, 0, 1 );
+}
+
+Float4x4 MatrixRotationQuaternion( const Float4& q )
+{
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    return Float4x4( 1.0f - 2.0f * ( yy + zz ), 2.0f * ( xy + wz ),        2.0f * ( xz - wy ),        0,
+                     2.0f * ( xy - wz ),        1.0f - 2.0f * ( xx + zz ), 2.0f * ( yz + wx ),        0,
+                     2.0f * ( xz + wy ),        2.0f * ( yz - wx ),        1.0f - 2.0f * ( xx + yy ), 0,
+                     0,                         0,                         0,                         1 );
+}
+
+// Build a left-handed view matrix from an eye position and a view direction.
+static Float4x4 MatrixLookToLH( const Float3& eye, const Float3& direction, const Float3& up )
+{
+    Float3 r2 = Normalize( direction );
+    Float3 r0 = Normalize( Cross( up, r2 ) );
+    Float3 r1 = Cross( r2, r0 );
+
+    Float3 negEye = -eye;
+
+    return Float4x4( r0.x, r1.x, r2.x, 0,
+                     r0.y, r1.y, r2.y, 0,
+                     r0.z, r1.z, r2.z, 0,
+                     Dot( r0, negEye ), Dot( r1, negEye ), Dot( r2, negEye ), 1 );
+}
+
+Float4x4 MatrixLookAtLH( const Float3& eye, const Float3& target, const Float3& up )
+{
+    return MatrixLookToLH( eye, target - eye, up );
+}
+
+Float4x4 MatrixLookAtRH( const Float3& eye, const Float3& target, const Float3& up )
+{
+    return MatrixLookToLH( eye, eye - target, up );
+}
+
+Float4x4 MatrixPerspectiveFovLH( float fovAngleY, float aspectRatio, float nearZ, float farZ )
+{
+    float sinFov, cosFov;
+    ScalarSinCos( &sinFov, &cosFov, 0.5f * fovAngleY );
+
+    float height = cosFov / sinFov;
+    float width = height / aspectRatio;
+    float range = farZ / ( farZ - nearZ );
+
+    return Float4x4( width, 0,      0,               0,
+                     0,     height, 0,               0,
+                     0,     0,      range,           1,
+                     0,     0,      -range * nearZ,  0 );
+}
+
+Float4x4 MatrixPerspectiveFovRH( float fovAngleY, float aspectRatio, float nearZ, float farZ )
+{
+    float sinFov, cosFov;
+    ScalarSinCos( &sinFov, &cosFov, 0.5f * fovAngleY );
+
+    float height = cosFov / sinFov;
+    float width = height / aspectRatio;
+    float range = farZ / ( nearZ - farZ );
+
+    return Float4x4( width, 0,      0,              0,
+                     0,     height, 0,              0,
+                     0,     0,      range,          -1,
+                     0,     0,      range * nearZ,  0 );
+}
+
+Float4x4 MatrixOrthographicOffCenterLH( float viewLeft, float viewRight, float viewBottom, float viewTop, float nearZ, float farZ )
+{
+    float width = 1.0f / ( viewRight - viewLeft );
+    float height = 1.0f / ( viewTop - viewBottom );
+    float range = 1.0f / ( farZ - nearZ );
+
+    return Float4x4( 2.0f * width,                      0,                                 0,               0,
+                     0,                                 2.0f * height,                     0,               0,
+                     0,                                 0,                                 range,           0,
+                     -( viewLeft + viewRight ) * width, -( viewTop + viewBottom ) * height, -range * nearZ, 1 );
+}
+
+Float3 TransformPoint( const Float3& v, const Float4x4& m )
+{
+    return Float3( v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + m.m[3][0],
+                   v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + m.m[3][1],
+                   v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + m.m[3][2] );
+}
+
+Float3 TransformNormal( const Float3& v, const Float4x4& m )
+{
+    return Float3( v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0],
+                   v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1],
+                   v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] );
+}
+
+Float4 Transform( const Float4& v, const Float4x4& m )
+{
+    return Float4( v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + v.w * m.m[3][0],
+                   v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + v.w * m.m[3][1],
+                   v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + v.w * m.m[3][2],
+                   v.x * m.m[0][3] + v.y * m.m[1][3] + v.z * m.m[2][3] + v.w * m.m[3][3] );
+}
+
+Float4 QuaternionIdentity()
+{
+    return Float4( 0, 0, 0, 1 );
+}
+
+Float4 QuaternionMultiply( const Float4& q1, const Float4& q2 )
+{
+    return Float4( q2.w * q1.x + q2.x * q1.w + q2.y * q1.z - q2.z * q1.y,
+                   q2.w * q1.y - q2.x * q1.z + q2.y * q1.w + q2.z * q1.x,
+                   q2.w * q1.z + q2.x * q1.y - q2.y * q1.x + q2.z * q1.w,
+                   q2.w * q1.w - q2.x * q1.x - q2.y * q1.y - q2.z * q1.z );
+}
+
+Float4 QuaternionRotationMatrix( const Float4x4& mat )
+{
+    const float ( &m )[4][4] = mat.m;
+
+    float r22 = m[2][2];
+    if ( r22 <= 0.0f ) // x^2 + y^2 >= z^2 + w^2
+    {
+        float dif10 = m[1][1] - m[0][0];
+        float omr22 = 1.0f - r22;
+        if ( dif10 <= 0.0f ) // x^2 >= y^2
+        {
+            float fourXSqr = omr22 - dif10;
+            float inv4x = 0.5f / std::sqrt( fourXSqr );
+            return Float4( fourXSqr * inv4x, ( m[0][1] + m[1][0] ) * inv4x, ( m[0][2] + m[2][0] ) * inv4x, ( m[1][2] - m[2][1] ) * inv4x );
+        }
+        else // y^2 >= x^2
+        {
+            float fourYSqr = omr22 + dif10;
+            float inv4y = 0.5f / std::sqrt( fourYSqr );
+            return Float4( ( m[0][1] + m[1][0] ) * inv4y, fourYSqr * inv4y, ( m[1][2] + m[2][1] ) * inv4y, ( m[2][0] - m[0][2] ) * inv4y );
+        }
+    }
+    else // z^2 + w^2 >= x^2 + y^2
+    {
+        float sum10 = m[1][1] + m[0][0];
+        float opr22 = 1.0f + r22;
+        if ( sum10 <= 0.0f ) // z^2 >= w^2
+        {
+            float fourZSqr = opr22 - sum10;
+            float inv4z = 0.5f / std::sqrt( fourZSqr );
+            return Float4( ( m[0][2] + m[2][0] ) * inv4z, ( m[1][2] + m[2][1] ) * inv4z, fourZSqr * inv4z, ( m[0][1] - m[1][0] ) * inv4z );
+        }
+        else // w^2 >= z^2
+        {
+            float fourWSqr = opr22 + sum10;
+            float inv4w = 0.5f / std::sqrt( fourWSqr );
+            return Float4( ( m[1][2] - m[2][1] ) * inv4w, ( m[2][0] - m[0][2] ) * inv4w, ( m[0][1] - m[1][0] ) * inv4w, fourWSqr * inv4w );
+        }
+    }
+}
+
+Float4 QuaternionRotationRollPitchYaw( float pitch, float yaw, float roll )
+{
+    float sp, cp, sy, cy, sr, cr;
+    ScalarSinCos( &sp, &cp, pitch * 0.5f );
+    ScalarSinCos( &sy, &cy, yaw * 0.5f );
+    ScalarSinCos( &sr, &cr, roll * 0.5f );
+
+    return Float4( cr * sp * cy + sr * cp * sy,
+                   cr * cp * sy - sr * sp * cy,
+                   sr * cp * cy - cr * sp * sy,
+                   cr * cp * cy + sr * sp * sy );
+}
+
+Float3 Vector3Rotate( const Float3& v, const Float4& quaternion )
+{
+    return TransformNormal( v, MatrixRotationQuaternion( quaternion ) );
+}
+
+}
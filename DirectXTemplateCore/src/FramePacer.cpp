@@ -0,0 +1,119 @@
+#include <DirectXTemplateCorePCH.h>
+#include <FramePacer.h>
+
+FramePacer::FramePacer( const FramePacingSettings& settings )
+{
+    set_Settings( settings );
+}
+
+const FramePacingSettings& FramePacer::get_Settings() const
+{
+    return m_Settings;
+}
+
+void FramePacer::set_Settings( const FramePacingSettings& settings )
+{
+    if ( settings.MaxFrameLatency == 0 || settings.NumFrameTimes == 0 ||
+         settings.Percentile < 0.0 || settings.Percentile > 1.0 || settings.SafetyMargin < 0.0 )
+    {
+        throw std::invalid_argument( "Invalid frame pacing settings." );
+    }
+
+    m_Settings = settings;
+    Reset();
+}
+
+void FramePacer::AddVBlank( uint64_t refreshCount, double time )
+{
+    if ( m_NumVBlanks == 0 || refreshCount < m_LastRefreshCount )
+    {
+        // The first vblank, or the counter was reset (for example by a mode change).
+        m_FirstRefreshCount = refreshCount;
+        m_FirstVBlankTime = time;
+        m_NumVBlanks = 0;
+    }
+    else if ( refreshCount == m_LastRefreshCount )
+    {
+        return;
+    }
+
+    m_LastRefreshCount = refreshCount;
+    m_LastVBlankTime = time;
+    ++m_NumVBlanks;
+}
+
+double FramePacer::get_RefreshPeriod() const
+{
+    if ( m_NumVBlanks < 2 )
+    {
+        return 0.0;
+    }
+
+    // The longest interval gives the most precise estimate.
+    return ( m_LastVBlankTime - m_FirstVBlankTime ) / static_cast<double>( m_LastRefreshCount - m_FirstRefreshCount );
+}
+
+double FramePacer::GetNextVBlank( double time ) const
+{
+    double period = get_RefreshPeriod();
+    if ( period <= 0.0 )
+    {
+        return time;
+    }
+
+    double numPeriods = std::floor( ( time - m_LastVBlankTime ) / period ) + 1.0;
+    return m_LastVBlankTime + numPeriods * period;
+}
+
+void FramePacer::AddFrameTime( double frameTime )
+{
+    if ( m_FrameTimes.size() < m_Settings.NumFrameTimes )
+    {
+        m_FrameTimes.push_back( frameTime );
+    }
+    else
+    {
+        m_FrameTimes[m_NextFrameTime] = frameTime;
+    }
+    m_NextFrameTime = ( m_NextFrameTime + 1 ) % m_Settings.NumFrameTimes;
+
+    // Update the prediction now so GetStartDelay is cheap.
+    std::vector<double> frameTimes( m_FrameTimes );
+    size_t index = static_cast<size_t>( std::ceil( m_Settings.Percentile * ( frameTimes.size() - 1 ) ) );
+    std::nth_element( frameTimes.begin(), frameTimes.begin() + index, frameTimes.end() );
+    m_PredictedFrameTime = frameTimes[index];
+}
+
+double FramePacer::get_PredictedFrameTime() const
+{
+    return m_PredictedFrameTime;
+}
+
+double FramePacer::GetStartDelay( double now ) const
+{
+    double period = get_RefreshPeriod();
+    if ( !m_Settings.PredictiveStart || period <= 0.0 || m_FrameTimes.empty() )
+    {
+        return 0.0;
+    }
+
+    // Finish the frame SafetyMargin before the next vblank. A frame that is not
+    // expected to make the next vblank starts at once: delaying it to a later
+    // vblank would lower the frame rate.
+    double budget = m_PredictedFrameTime + m_Settings.SafetyMargin;
+    double vblank = GetNextVBlank( now );
+    return std::min( std::max( vblank - budget - now, 0.0 ), period );
+}
+
+void FramePacer::Reset()
+{
+    m_FirstRefreshCount = 0;
+    m_FirstVBlankTime = 0.0;
+    m_LastRefreshCount = 0;
+    m_LastVBlankTime = 0.0;
+    m_NumVBlanks = 0;
+
+    m_FrameTimes.clear();
+    m_NextFrameTime = 0;
+    m_PredictedFrameTime = 0.0;
+}
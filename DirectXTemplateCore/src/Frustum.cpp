@@ -0,0 +1,211 @@
+#include <DirectXTemplateCorePCH.h>
+#include <Frustum.h>
+
+#include <Simd.h>
+
+using namespace Math;
+
+namespace
+{
+    Float4 Column( const Float4x4& m, int column )
+    {
+        return Float4( m.m[0][column], m.m[1][column], m.m[2][column], m.m[3][column] );
+    }
+
+    Float4 NormalizePlane( const Float4& plane )
+    {
+        float length = Length( XYZ( plane ) );
+        return ( length > 0.0f ) ? plane * ( 1.0f / length ) : plane;
+    }
+
+    float PlaneDistance( const Float4& plane, const Float3& point )
+    {
+        return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+    }
+
+    // Write the indices of the lanes that are set in the mask to visibleIndices
+    // without branching on the individual lanes.
+    inline size_t Compact( int mask, uint32_t firstIndex, uint32_t* visibleIndices, size_t numVisible )
+    {
+        for ( int lane = 0; lane < Simd::Width; ++lane )
+        {
+            visibleIndices[numVisible] = firstIndex + lane;
+            numVisible += ( mask >> lane ) & 1;
+        }
+        return numVisible;
+    }
+}
+
+Frustum::Frustum()
+{
+    for ( int i = 0; i < NumPlanes; ++i )
+    {
+        m_Planes[i] = Float4( 0.0f, 0.0f, 0.0f, 0.0f );
+    }
+}
+
+Frustum::Frustum( const Float4x4& matrix )
+{
+    // With row vectors, clip = p * M so the clip-space coordinates are the dot
+    // products of p with the columns of M (Gribb and Hartmann).
+    Float4 c0 = Column( matrix, 0 );
+    Float4 c1 = Column( matrix, 1 );
+    Float4 c2 = Column( matrix, 2 );
+    Float4 c3 = Column( matrix, 3 );
+
+    m_Planes[LeftPlane] = NormalizePlane( c3 + c0 );      // -w <= x
+    m_Planes[RightPlane] = NormalizePlane( c3 - c0 );     //  x <= w
+    m_Planes[BottomPlane] = NormalizePlane( c3 + c1 );    // -w <= y
+    m_Planes[TopPlane] = NormalizePlane( c3 - c1 );       //  y <= w
+    m_Planes[NearPlane] = NormalizePlane( c2 );           //  0 <= z
+    m_Planes[FarPlane] = NormalizePlane( c3 - c2 );       //  z <= w
+}
+
+const Float4& Frustum::get_Plane( PlaneIndex plane ) const
+{
+    assert( plane < NumPlanes );
+    return m_Planes[plane];
+}
+
+bool Frustum::Intersects( const BoundingSphere& sphere ) const
+{
+    for ( int i = 0; i < NumPlanes; ++i )
+    {
+        if ( PlaneDistance( m_Planes[i], sphere.Center ) < -sphere.Radius )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::Intersects( const BoundingBox& box ) const
+{
+    for ( int i = 0; i < NumPlanes; ++i )
+    {
+        const Float4& plane = m_Planes[i];
+
+        // The projection of the box extents onto the plane normal.
+        float radius = std::abs( plane.x ) * box.Extents.x + std::abs( plane.y ) * box.Extents.y + std::abs( plane.z ) * box.Extents.z;
+        if ( PlaneDistance( plane, box.Center ) < -radius )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t Frustum::Cull( const BoundingSphereArrays& spheres, std::vector<uint32_t>& visibleIndices ) const
+{
+    size_t count = spheres.Size();
+    visibleIndices.resize( count );
+
+    Simd::Float planeX[NumPlanes], planeY[NumPlanes], planeZ[NumPlanes], planeW[NumPlanes];
+    for ( int i = 0; i < NumPlanes; ++i )
+    {
+        planeX[i] = Simd::Set1( m_Planes[i].x );
+        planeY[i] = Simd::Set1( m_Planes[i].y );
+        planeZ[i] = Simd::Set1( m_Planes[i].z );
+        planeW[i] = Simd::Set1( m_Planes[i].w );
+    }
+
+    const float* centerX = spheres.CenterX.data();
+    const float* centerY = spheres.CenterY.data();
+    const float* centerZ = spheres.CenterZ.data();
+    const float* radius = spheres.Radius.data();
+
+    size_t numVisible = 0;
+    size_t i = 0;
+    for ( ; i + Simd::Width <= count; i += Simd::Width )
+    {
+        Simd::Float x = Simd::LoadUnaligned( centerX + i );
+        Simd::Float y = Simd::LoadUnaligned( centerY + i );
+        Simd::Float z = Simd::LoadUnaligned( centerZ + i );
+        Simd::Float negativeRadius = -Simd::LoadUnaligned( radius + i );
+
+        // A sphere is visible if it is not completely behind any of the planes.
+        Simd::Float inside = Simd::CmpGE( x * planeX[0] + y * planeY[0] + z * planeZ[0] + planeW[0], negativeRadius );
+        for ( int p = 1; p < NumPlanes; ++p )
+        {
+            Simd::Float distance = x * planeX[p] + y * planeY[p] + z * planeZ[p] + planeW[p];
+            inside = Simd::And( inside, Simd::CmpGE( distance, negativeRadius ) );
+        }
+
+        numVisible = Compact( Simd::MoveMask( inside ), static_cast<uint32_t>( i ), visibleIndices.data(), numVisible );
+    }
+
+    // The remaining spheres.
+    for ( ; i < count; ++i )
+    {
+        if ( Intersects( spheres.Get( i ) ) )
+        {
+            visibleIndices[numVisible++] = static_cast<uint32_t>( i );
+        }
+    }
+
+    visibleIndices.resize( numVisible );
+    return numVisible;
+}
+
+size_t Frustum::Cull( const BoundingBoxArrays& boxes, std::vector<uint32_t>& visibleIndices ) const
+{
+    size_t count = boxes.Size();
+    visibleIndices.resize( count );
+
+    Simd::Float planeX[NumPlanes], planeY[NumPlanes], planeZ[NumPlanes], planeW[NumPlanes];
+    Simd::Float absPlaneX[NumPlanes], absPlaneY[NumPlanes], absPlaneZ[NumPlanes];
+    for ( int i = 0; i < NumPlanes; ++i )
+    {
+        planeX[i] = Simd::Set1( m_Planes[i].x );
+        planeY[i] = Simd::Set1( m_Planes[i].y );
+        planeZ[i] = Simd::Set1( m_Planes[i].z );
+        planeW[i] = Simd::Set1( m_Planes[i].w );
+        absPlaneX[i] = Simd::Set1( std::abs( m_Planes[i].x ) );
+        absPlaneY[i] = Simd::Set1( std::abs( m_Planes[i].y ) );
+        absPlaneZ[i] = Simd::Set1( std::abs( m_Planes[i].z ) );
+    }
+
+    const float* centerX = boxes.CenterX.data();
+    const float* centerY = boxes.CenterY.data();
+    const float* centerZ = boxes.CenterZ.data();
+    const float* extentsX = boxes.ExtentsX.data();
+    const float* extentsY = boxes.ExtentsY.data();
+    const float* extentsZ = boxes.ExtentsZ.data();
+
+    size_t numVisible = 0;
+    size_t i = 0;
+    for ( ; i + Simd::Width <= count; i += Simd::Width )
+    {
+        Simd::Float x = Simd::LoadUnaligned( centerX + i );
+        Simd::Float y = Simd::LoadUnaligned( centerY + i );
+        Simd::Float z = Simd::LoadUnaligned( centerZ + i );
+        Simd::Float ex = Simd::LoadUnaligned( extentsX + i );
+        Simd::Float ey = Simd::LoadUnaligned( extentsY + i );
+        Simd::Float ez = Simd::LoadUnaligned( extentsZ + i );
+
+        // A box is visible if the vertex that is furthest along the plane
+        // normal is not behind any of the planes.
+        Simd::Float inside = Simd::CmpGE( x * planeX[0] + y * planeY[0] + z * planeZ[0] + planeW[0],
+            -( ex * absPlaneX[0] + ey * absPlaneY[0] + ez * absPlaneZ[0] ) );
+        for ( int p = 1; p < NumPlanes; ++p )
+        {
+            Simd::Float distance = x * planeX[p] + y * planeY[p] + z * planeZ[p] + planeW[p];
+            Simd::Float radius = ex * absPlaneX[p] + ey * absPlaneY[p] + ez * absPlaneZ[p];
+            inside = Simd::And( inside, Simd::CmpGE( distance, -radius ) );
+        }
+
+        numVisible = Compact( Simd::MoveMask( inside ), static_cast<uint32_t>( i ), visibleIndices.data(), numVisible );
+    }
+
+    // The remaining boxes.
+    for ( ; i < count; ++i )
+    {
+        if ( Intersects( boxes.Get( i ) ) )
+        {
+            visibleIndices[numVisible++] = static_cast<uint32_t>( i );
+        }
+    }
+
+    visibleIndices.resize( numVisible );
+    return numVisible;
+}
@@ -0,0 +1,678 @@
+#include <DirectXTemplateCorePCH.h>
+#include <Geometry.h>
+
+#include <Simd.h>
+
+#include <thread>
+
+using namespace Math;
+
+// Helper for pushing an index.
+static inline void PushIndex( IndexCollection& indices, size_t index )
+{
+    indices.push_back( static_cast<uint32_t>( index ) );
+}
+
+// Rings with fewer vertices than this in total are generated on the calling thread
+// because starting a thread costs more than generating a few thousand vertices.
+static const size_t MinVerticesPerThread = 16384;
+
+/**
+ * Call function( firstRing, lastRing ) for ranges of the rings [0, numRings) on
+ * as many threads as there are hardware threads. Each ring writes to its own
+ * range of the pre-sized vertex and index buffers.
+ */
+template<typename Function>
+static void ParallelForRings( size_t numRings, size_t verticesPerRing, const Function& function )
+{
+    size_t numThreads = std::min<size_t>( std::thread::hardware_concurrency(), numRings * verticesPerRing / MinVerticesPerThread );
+    if ( numThreads <= 1 )
+    {
+        function( size_t( 0 ), numRings );
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    for ( size_t i = 1; i < numThreads; ++i )
+    {
+        threads.push_back( std::thread( function, numRings * i / numThreads, numRings * ( i + 1 ) / numThreads ) );
+    }
+    // The calling thread also generates rings.
+    function( size_t( 0 ), numRings / numThreads );
+
+    for ( auto& thread : threads )
+    {
+        thread.join();
+    }
+}
+
+// The sine and cosine of offset + i * step for i in [0, count), Simd::Width angles at a time.
+static void ComputeSinCosTable( std::vector<float>& sines, std::vector<float>& cosines, size_t count, float step, float offset )
+{
+    // Round up so that the last block can be stored without a scalar tail.
+    size_t paddedCount = ( count + Simd::Width - 1 ) / Simd::Width * Simd::Width;
+    sines.resize( paddedCount );
+    cosines.resize( paddedCount );
+
+    for ( size_t i = 0; i < paddedCount; i += Simd::Width )
+    {
+        Simd::Float index = Simd::LaneIndex() + Simd::Set1( static_cast<float>( i ) );
+        Simd::Float sin, cos;
+        Simd::SinCos( index * Simd::Set1( step ) + Simd::Set1( offset ), sin, cos );
+        Simd::StoreUnaligned( &sines[i], sin );
+        Simd::StoreUnaligned( &cosines[i], cos );
+    }
+}
+
+// Write a triangle, or the triangle with the opposite winding order for left-handed coordinates.
+template<typename IndexType>
+static inline void WriteTriangle( IndexType*& indices, size_t i0, size_t i1, size_t i2, bool rhcoords )
+{
+    indices[0] = static_cast<IndexType>( rhcoords ? i0 : i2 );
+    indices[1] = static_cast<IndexType>( i1 );
+    indices[2] = static_cast<IndexType>( rhcoords ? i2 : i0 );
+    indices += 3;
+}
+
+// Size the index buffer for the number of vertices and indices of a mesh.
+static void ResizeIndices( IndexCollection& indices, size_t numVertices, size_t numIndices )
+{
+    if ( numVertices - 1 > IndexCollection::MaxIndex16 )
+    {
+        indices.Widen();
+    }
+    indices.resize( numIndices );
+}
+
+template<typename IndexType>
+static void ComputeSphereIndices( IndexType* indices, size_t firstRing, size_t lastRing, size_t horizontalSegments, bool rhcoords )
+{
+    size_t stride = horizontalSegments + 1;
+    indices += firstRing * stride * 6;
+
+    for (size_t i = firstRing; i < lastRing; i++)
+    {
+        for (size_t j = 0; j <= horizontalSegments; j++)
+        {
+            size_t nextI = i + 1;
+            size_t nextJ = (j + 1) % stride;
+
+            WriteTriangle(indices, i * stride + j, nextI * stride + j, i * stride + nextJ, rhcoords);
+            WriteTriangle(indices, i * stride + nextJ, nextI * stride + j, nextI * stride + nextJ, rhcoords);
+        }
+    }
+}
+
+void ComputeSphere( VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords )
+{
+    vertices.clear();
+    indices.clear();
+
+    if (tessellation < 3)
+        throw std::out_of_range("tessellation parameter out of range");
+
+    float radius = diameter / 2.0f;
+    size_t verticalSegments = tessellation;
+    size_t horizontalSegments = tessellation * 2;
+    size_t stride = horizontalSegments + 1;
+
+    // The sine and cosine of every latitude and longitude are computed once.
+    std::vector<float> latitudeSin, latitudeCos, longitudeSin, longitudeCos;
+    ComputeSinCosTable( latitudeSin, latitudeCos, verticalSegments + 1, Pi / verticalSegments, -PiDiv2 );
+    ComputeSinCosTable( longitudeSin, longitudeCos, horizontalSegments + 1, TwoPi / horizontalSegments, 0.0f );
+
+    vertices.resize( ( verticalSegments + 1 ) * stride );
+    ResizeIndices( indices, vertices.size(), verticalSegments * stride * 6 );
+
+    auto computeRings = [&]( size_t firstRing, size_t lastRing )
+    {
+        // Create rings of vertices at progressively higher latitudes.
+        for (size_t i = firstRing; i < lastRing; i++)
+        {
+            float v = 1 - (float)i / verticalSegments;
+            float dy = latitudeSin[i];
+            float dxz = latitudeCos[i];
+
+            // Create a single ring of vertices at this latitude.
+            VertexPositionNormalTexture* ring = &vertices[i * stride];
+            for (size_t j = 0; j <= horizontalSegments; j++)
+            {
+                float u = (float)j / horizontalSegments;
+
+                Float3 normal(longitudeSin[j] * dxz, dy, longitudeCos[j] * dxz);
+                Float2 textureCoordinate(rhcoords ? u : 1 - u, v);
+
+                ring[j] = VertexPositionNormalTexture(normal * radius, normal, textureCoordinate);
+            }
+        }
+
+        // Fill the index buffer with triangles joining each pair of latitude rings
+        // (there is one ring of triangles less than there are rings of vertices).
+        lastRing = std::min(lastRing, verticalSegments);
+        if ( indices.get_Is32Bit() )
+            ComputeSphereIndices( static_cast<uint32_t*>( indices.data() ), firstRing, lastRing, horizontalSegments, rhcoords );
+        else
+            ComputeSphereIndices( static_cast<uint16_t*>( indices.data() ), firstRing, lastRing, horizontalSegments, rhcoords );
+    };
+
+    ParallelForRings( verticalSegments + 1, stride, computeRings );
+}
+
+void ComputeCube( VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords )
+{
+    // A cube has six faces, each one pointing in a different direction.
+    const int FaceCount = 6;
+
+    static const Float3 faceNormals[FaceCount] =
+    {
+        Float3(  0,  0,  1 ),
+        Float3(  0,  0, -1 ),
+        Float3(  1,  0,  0 ),
+        Float3( -1,  0,  0 ),
+        Float3(  0,  1,  0 ),
+        Float3(  0, -1,  0 ),
+    };
+
+    static const Float2 textureCoordinates[4] =
+    {
+        Float2( 1, 0 ),
+        Float2( 1, 1 ),
+        Float2( 0, 1 ),
+        Float2( 0, 0 ),
+    };
+
+    vertices.clear();
+    indices.clear();
+
+    size /= 2;
+
+    // Create each face in turn.
+    for (int i = 0; i < FaceCount; i++)
+    {
+        Float3 normal = faceNormals[i];
+
+        // Get two vectors perpendicular both to the face normal and to each other.
+        Float3 basis = (i >= 4) ? Float3(0, 0, 1) : Float3(0, 1, 0);
+
+        Float3 side1 = Cross(normal, basis);
+        Float3 side2 = Cross(normal, side1);
+
+        // Six indices (two triangles) per face.
+        size_t vbase = vertices.size();
+        PushIndex(indices, vbase + 0);
+        PushIndex(indices, vbase + 1);
+        PushIndex(indices, vbase + 2);
+
+        PushIndex(indices, vbase + 0);
+        PushIndex(indices, vbase + 2);
+        PushIndex(indices, vbase + 3);
+
+        // Four vertices per face.
+        vertices.push_back(VertexPositionNormalTexture((normal - side1 - side2) * size, normal, textureCoordinates[0]));
+        vertices.push_back(VertexPositionNormalTexture((normal - side1 + side2) * size, normal, textureCoordinates[1]));
+        vertices.push_back(VertexPositionNormalTexture((normal + side1 + side2) * size, normal, textureCoordinates[2]));
+        vertices.push_back(VertexPositionNormalTexture((normal + side1 - side2) * size, normal, textureCoordinates[3]));
+    }
+
+    if ( !rhcoords )
+        ReverseWinding( indices, vertices );
+}
+
+// Helper computes a point on a unit circle, aligned to the x/z plane and centered on the origin.
+static inline Float3 GetCircleVector(size_t i, size_t tessellation)
+{
+    float angle = i * TwoPi / tessellation;
+    float dx, dz;
+
+    ScalarSinCos(&dx, &dz, angle);
+
+    return Float3( dx, 0, dz );
+}
+
+static inline Float3 GetCircleTangent(size_t i, size_t tessellation)
+{
+    float angle = ( i * TwoPi / tessellation ) + PiDiv2;
+    float dx, dz;
+
+    ScalarSinCos(&dx, &dz, angle);
+
+    return Float3( dx, 0, dz );
+}
+
+// Helper creates a triangle fan to close the end of a cylinder / cone
+static void CreateCylinderCap(VertexCollection& vertices, IndexCollection& indices, size_t tessellation, float height, float radius, bool isTop)
+{
+    // Create cap indices.
+    for (size_t i = 0; i < tessellation - 2; i++)
+    {
+        size_t i1 = (i + 1) % tessellation;
+        size_t i2 = (i + 2) % tessellation;
+
+        if (isTop)
+        {
+            std::swap(i1, i2);
+        }
+
+        size_t vbase = vertices.size();
+        PushIndex(indices, vbase);
+        PushIndex(indices, vbase + i1);
+        PushIndex(indices, vbase + i2);
+    }
+
+    // Which end of the cylinder is this?
+    Float3 normal(0, 1, 0);
+    Float2 textureScale(-0.5f, -0.5f);
+
+    if (!isTop)
+    {
+        normal = -normal;
+        textureScale.x = -textureScale.x;
+    }
+
+    // Create cap vertices.
+    for (size_t i = 0; i < tessellation; i++)
+    {
+        Float3 circleVector = GetCircleVector(i, tessellation);
+
+        Float3 position = (circleVector * radius) + (normal * height);
+
+        Float2 textureCoordinate( circleVector.x * textureScale.x + 0.5f, circleVector.z * textureScale.y + 0.5f );
+
+        vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
+    }
+}
+
+void ComputeCone( VertexCollection& vertices, IndexCollection& indices, float diameter, float height, size_t tessellation, bool rhcoords )
+{
+    vertices.clear();
+    indices.clear();
+
+    if (tessellation < 3)
+        throw std::out_of_range("tessellation parameter out of range");
+
+    height /= 2;
+
+    Float3 topOffset = Float3(0, 1, 0) * height;
+
+    float radius = diameter / 2;
+    size_t stride = tessellation + 1;
+
+    // Create a ring of triangles around the outside of the cone.
+    for (size_t i = 0; i <= tessellation; i++)
+    {
+        Float3 circlevec = GetCircleVector(i, tessellation);
+
+        Float3 sideOffset = circlevec * radius;
+
+        float u = (float)i / tessellation;
+
+        Float2 textureCoordinate(u, 1);
+
+        Float3 pt = sideOffset - topOffset;
+
+        Float3 normal = Cross( GetCircleTangent( i, tessellation ), topOffset - pt );
+        normal = Normalize( normal );
+
+        // Duplicate the top vertex for distinct normals
+        vertices.push_back(VertexPositionNormalTexture(topOffset, normal, Float2(0, 0)));
+        vertices.push_back(VertexPositionNormalTexture(pt, normal, textureCoordinate));
+
+        PushIndex(indices, i * 2);
+        PushIndex(indices, (i * 2 + 3) % (stride * 2));
+        PushIndex(indices, (i * 2 + 1) % (stride * 2));
+    }
+
+    // Create flat triangle fan caps to seal the bottom.
+    CreateCylinderCap(vertices, indices, tessellation, height, radius, false);
+
+    if ( !rhcoords )
+        ReverseWinding( indices, vertices );
+}
+
+template<typename IndexType>
+static void ComputeTorusIndices( IndexType* indices, size_t firstRing, size_t lastRing, size_t tessellation, bool rhcoords )
+{
+    size_t stride = tessellation + 1;
+    indices += firstRing * stride * 6;
+
+    for (size_t i = firstRing; i < lastRing; i++)
+    {
+        for (size_t j = 0; j <= tessellation; j++)
+        {
+            size_t nextI = (i + 1) % stride;
+            size_t nextJ = (j + 1) % stride;
+
+            WriteTriangle(indices, i * stride + j, i * stride + nextJ, nextI * stride + j, rhcoords);
+            WriteTriangle(indices, i * stride + nextJ, nextI * stride + nextJ, nextI * stride + j, rhcoords);
+        }
+    }
+}
+
+void ComputeTorus( VertexCollection& vertices, IndexCollection& indices, float diameter, float thickness, size_t tessellation, bool rhcoords )
+{
+    vertices.clear();
+    indices.clear();
+
+    if (tessellation < 3)
+        throw std::out_of_range("tesselation parameter out of range");
+
+    size_t stride = tessellation + 1;
+
+    // The sine and cosine of every angle around the ring and the tube are computed once.
+    std::vector<float> outerSin, outerCos, innerSin, innerCos;
+    ComputeSinCosTable( outerSin, outerCos, stride, TwoPi / tessellation, -PiDiv2 );
+    ComputeSinCosTable( innerSin, innerCos, stride, TwoPi / tessellation, Pi );
+
+    vertices.resize( stride * stride );
+    ResizeIndices( indices, vertices.size(), stride * stride * 6 );
+
+    auto computeRings = [&]( size_t firstRing, size_t lastRing )
+    {
+        // First we loop around the main ring of the torus.
+        for (size_t i = firstRing; i < lastRing; i++)
+        {
+            float u = (float)i / tessellation;
+
+            // Rotating the slice of the tube around the Y axis is the same as
+            // transforming it by MatrixTranslation(diameter / 2, 0, 0) * MatrixRotationY(outerAngle).
+            float s = outerSin[i];
+            float c = outerCos[i];
+
+            // Now we loop along the other axis, around the side of the tube.
+            VertexPositionNormalTexture* ring = &vertices[i * stride];
+            for (size_t j = 0; j <= tessellation; j++)
+            {
+                float v = 1 - (float)j / tessellation;
+                float dx = innerCos[j];
+                float dy = innerSin[j];
+
+                // Create a vertex.
+                float x = dx * thickness / 2 + diameter / 2;
+                Float3 position(x * c, dy * thickness / 2, -x * s);
+                Float3 normal(dx * c, dy, -dx * s);
+                Float2 textureCoordinate(rhcoords ? u : 1 - u, v);
+
+                ring[j] = VertexPositionNormalTexture(position, normal, textureCoordinate);
+            }
+        }
+
+        // And create indices for two triangles per vertex.
+        if ( indices.get_Is32Bit() )
+            ComputeTorusIndices( static_cast<uint32_t*>( indices.data() ), firstRing, lastRing, tessellation, rhcoords );
+        else
+            ComputeTorusIndices( static_cast<uint16_t*>( indices.data() ), firstRing, lastRing, tessellation, rhcoords );
+    };
+
+    ParallelForRings( stride, stride, computeRings );
+}
+
+void ComputeCubeBounds( BoundingBox& box, BoundingSphere& sphere, float size )
+{
+    float halfSize = size / 2;
+
+    box = BoundingBox( Float3( 0, 0, 0 ), Float3( halfSize, halfSize, halfSize ) );
+    sphere = BoundingSphere( Float3( 0, 0, 0 ), halfSize * std::sqrt( 3.0f ) );
+}
+
+void ComputeSphereBounds( BoundingBox& box, BoundingSphere& sphere, float diameter )
+{
+    float radius = diameter / 2;
+
+    box = BoundingBox( Float3( 0, 0, 0 ), Float3( radius, radius, radius ) );
+    sphere = BoundingSphere( Float3( 0, 0, 0 ), radius );
+}
+
+void ComputeConeBounds( BoundingBox& box, BoundingSphere& sphere, float diameter, float height )
+{
+    // The cone is centered on the origin with the apex at +height / 2.
+    float radius = diameter / 2;
+    float halfHeight = height / 2;
+
+    box = BoundingBox( Float3( 0, 0, 0 ), Float3( radius, halfHeight, radius ) );
+
+    if ( radius < height )
+    {
+        // The sphere through the apex and the rim of the base.
+        float centerY = -( radius * radius ) / ( 2 * height );
+        sphere = BoundingSphere( Float3( 0, centerY, 0 ), halfHeight - centerY );
+    }
+    else
+    {
+        // A wide cone fits in the sphere around the base.
+        sphere = BoundingSphere( Float3( 0, -halfHeight, 0 ), radius );
+    }
+}
+
+void ComputeTorusBounds( BoundingBox& box, BoundingSphere& sphere, float diameter, float thickness )
+{
+    float outerRadius = ( diameter + thickness ) / 2;
+
+    box = BoundingBox( Float3( 0, 0, 0 ), Float3( outerRadius, thickness / 2, outerRadius ) );
+    sphere = BoundingSphere( Float3( 0, 0, 0 ), outerRadius );
+}
+
+BoundingBox ComputeBoundingBox( const VertexCollection& vertices )
+{
+    if ( vertices.empty() )
+        return BoundingBox( Float3( 0, 0, 0 ), Float3( 0, 0, 0 ) );
+
+    // Load the position of each vertex into the first 3 lanes of a SIMD register.
+    // The remaining lanes read the rest of the vertex and are ignored.
+    static_assert( sizeof( VertexPositionNormalTexture ) - offsetof( VertexPositionNormalTexture, position ) >= Simd::Width * sizeof( float ),
+        "A SIMD load from the vertex position must not read past the end of the vertex." );
+
+    const VertexPositionNormalTexture* vertex = vertices.data();
+    size_t count = vertices.size();
+
+    // Two sets of accumulators to hide the latency of the min and max instructions.
+    Simd::Float minimum0 = Simd::LoadUnaligned( &vertex[0].position.x );
+    Simd::Float maximum0 = minimum0;
+    Simd::Float minimum1 = minimum0;
+    Simd::Float maximum1 = minimum0;
+
+    size_t i = 1;
+    for ( ; i + 2 <= count; i += 2 )
+    {
+        Simd::Float p0 = Simd::LoadUnaligned( &vertex[i].position.x );
+        Simd::Float p1 = Simd::LoadUnaligned( &vertex[i + 1].position.x );
+        minimum0 = Simd::Min( minimum0, p0 );
+        maximum0 = Simd::Max( maximum0, p0 );
+        minimum1 = Simd::Min( minimum1, p1 );
+        maximum1 = Simd::Max( maximum1, p1 );
+    }
+    if ( i < count )
+    {
+        Simd::Float p = Simd::LoadUnaligned( &vertex[i].position.x );
+        minimum0 = Simd::Min( minimum0, p );
+        maximum0 = Simd::Max( maximum0, p );
+    }
+
+    float minimum[Simd::Width];
+    float maximum[Simd::Width];
+    Simd::StoreUnaligned( minimum, Simd::Min( minimum0, minimum1 ) );
+    Simd::StoreUnaligned( maximum, Simd::Max( maximum0, maximum1 ) );
+
+    Float3 boxMin( minimum[0], minimum[1], minimum[2] );
+    Float3 boxMax( maximum[0], maximum[1], maximum[2] );
+
+    return BoundingBox( ( boxMin + boxMax ) * 0.5f, ( boxMax - boxMin ) * 0.5f );
+}
+
+// The largest distance from the center to any of the vertices.
+static float MaxDistance( const VertexCollection& vertices, const Float3& center )
+{
+    float maxDistanceSq = 0.0f;
+    for ( const VertexPositionNormalTexture& vertex : vertices )
+    {
+        maxDistanceSq = std::max( maxDistanceSq, LengthSq( vertex.position - center ) );
+    }
+    return std::sqrt( maxDistanceSq );
+}
+
+BoundingSphere ComputeBoundingSphere( const VertexCollection& vertices )
+{
+    if ( vertices.empty() )
+        return BoundingSphere( Float3( 0, 0, 0 ), 0 );
+
+    // Find the vertices with the smallest and largest coordinate along each axis.
+    size_t minX = 0, maxX = 0, minY = 0, maxY = 0, minZ = 0, maxZ = 0;
+    Float3 minimum = vertices[0].position;
+    Float3 maximum = vertices[0].position;
+    for ( size_t i = 1; i < vertices.size(); ++i )
+    {
+        const Float3& p = vertices[i].position;
+        if ( p.x < minimum.x ) { minimum.x = p.x; minX = i; }
+        if ( p.x > maximum.x ) { maximum.x = p.x; maxX = i; }
+        if ( p.y < minimum.y ) { minimum.y = p.y; minY = i; }
+        if ( p.y > maximum.y ) { maximum.y = p.y; maxY = i; }
+        if ( p.z < minimum.z ) { minimum.z = p.z; minZ = i; }
+        if ( p.z > maximum.z ) { maximum.z = p.z; maxZ = i; }
+    }
+
+    // Ritter: start with the sphere around the pair that is furthest apart...
+    Float3 a = vertices[minX].position;
+    Float3 b = vertices[maxX].position;
+    if ( LengthSq( vertices[maxY].position - vertices[minY].position ) > LengthSq( b - a ) )
+    {
+        a = vertices[minY].position;
+        b = vertices[maxY].position;
+    }
+    if ( LengthSq( vertices[maxZ].position - vertices[minZ].position ) > LengthSq( b - a ) )
+    {
+        a = vertices[minZ].position;
+        b = vertices[maxZ].position;
+    }
+
+    Float3 center = ( a + b ) * 0.5f;
+    float radius = Length( b - a ) * 0.5f;
+
+    // ...and grow it to include the vertices that are outside of it.
+    for ( const VertexPositionNormalTexture& vertex : vertices )
+    {
+        Float3 offset = vertex.position - center;
+        float distanceSq = LengthSq( offset );
+        if ( distanceSq > radius * radius )
+        {
+            float distance = std::sqrt( distanceSq );
+            float newRadius = ( radius + distance ) * 0.5f;
+            center += offset * ( ( newRadius - radius ) / distance );
+            radius = newRadius;
+        }
+    }
+
+    // Rounding in the growing step can leave vertices just outside of the sphere
+    // and the final sphere is often larger than it has to be around its center.
+    radius = MaxDistance( vertices, center );
+
+    // The sphere around the center of the bounding box is smaller for shapes
+    // like boxes and cylinders where Ritter's initial guess is poor.
+    Float3 boxCenter = ( minimum + maximum ) * 0.5f;
+    float boxRadius = MaxDistance( vertices, boxCenter );
+    if ( boxRadius < radius )
+    {
+        return BoundingSphere( boxCenter, boxRadius );
+    }
+
+    return BoundingSphere( center, radius );
+}
+
+void SplitMesh16( const VertexCollection& vertices, const IndexCollection& indices,
+                  VertexCollection& splitVertices, IndexCollection& splitIndices, SubMeshCollection& subMeshes )
+{
+    assert( (indices.size() % 3) == 0 );
+
+    const uint32_t MaxVertices = IndexCollection::MaxIndex16 + 1;
+    const uint32_t NotMapped = UINT32_MAX;
+
+    splitVertices.clear();
+    splitIndices.clear();
+    subMeshes.clear();
+
+    splitIndices.reserve( indices.size() );
+    splitVertices.reserve( vertices.size() );
+
+    // The submesh that a vertex was last copied to and its index in that submesh.
+    std::vector<uint32_t> vertexSubMesh( vertices.size(), NotMapped );
+    std::vector<uint32_t> vertexIndex( vertices.size() );
+
+    SubMesh subMesh = { 0, 0, 0, 0 };
+    uint32_t subMeshIndex = 0;
+
+    for ( size_t i = 0; i < indices.size(); i += 3 )
+    {
+        uint32_t triangle[3] = { indices[i], indices[i + 1], indices[i + 2] };
+
+        // The number of vertices of the triangle that are not in the submesh yet.
+        uint32_t newVertices = 0;
+        for ( int v = 0; v < 3; ++v )
+        {
+            bool repeated = ( v > 0 && triangle[v] == triangle[0] ) || ( v > 1 && triangle[v] == triangle[1] );
+            if ( !repeated && vertexSubMesh[triangle[v]] != subMeshIndex )
+            {
+                ++newVertices;
+            }
+        }
+
+        if ( subMesh.VertexCount + newVertices > MaxVertices )
+        {
+            subMeshes.push_back( subMesh );
+            ++subMeshIndex;
+
+            subMesh.StartIndex = static_cast<uint32_t>( splitIndices.size() );
+            subMesh.IndexCount = 0;
+            subMesh.BaseVertex = static_cast<int32_t>( splitVertices.size() );
+            subMesh.VertexCount = 0;
+        }
+
+        for ( int v = 0; v < 3; ++v )
+        {
+            uint32_t vertex = triangle[v];
+            if ( vertexSubMesh[vertex] != subMeshIndex )
+            {
+                vertexSubMesh[vertex] = subMeshIndex;
+                vertexIndex[vertex] = subMesh.VertexCount++;
+                splitVertices.push_back( vertices[vertex] );
+            }
+            splitIndices.push_back( vertexIndex[vertex] );
+        }
+        subMesh.IndexCount += 3;
+    }
+
+    if ( subMesh.IndexCount > 0 )
+    {
+        subMeshes.push_back( subMesh );
+    }
+
+    assert( !splitIndices.get_Is32Bit() );
+}
+
+bool PreferSplitMesh( size_t numIndices, size_t numVertices, size_t numSplitVertices, size_t numSubMeshes )
+{
+    // The cost of a draw call expressed as the number of bytes of vertex and index
+    // data that can be fetched in the same time. Splitting only pays off if the
+    // vertices are local enough that few of them have to be duplicated.
+    const double DrawCallCost = 16.0 * 1024.0;
+    const double VertexSize = sizeof( VertexPositionNormalTexture );
+
+    double cost32 = numIndices * sizeof( uint32_t ) + numVertices * VertexSize + DrawCallCost;
+    double cost16 = numIndices * sizeof( uint16_t ) + numSplitVertices * VertexSize + numSubMeshes * DrawCallCost;
+
+    return cost16 < cost32;
+}
+
+// Helper for flipping winding of geometric primitives for LH vs. RH coords
+void ReverseWinding( IndexCollection& indices, VertexCollection& vertices )
+{
+    assert( (indices.size() % 3) == 0 );
+    for( size_t i = 0; i < indices.size(); i += 3 )
+    {
+        uint32_t index = indices[i];
+        indices.set( i, indices[i + 2] );
+        indices.set( i + 2, index );
+    }
+
+    for( auto it = vertices.begin(); it != vertices.end(); ++it )
+    {
+        it->textureCoordinate.x = ( 1.f - it->textureCoordinate.x );
+    }
+}
@@ -0,0 +1,286 @@
+#include <DirectXTemplateCorePCH.h>
+#include <GpuProfiler.h>
+#include <Profiler.h>
+
+#include <limits>
+
+GpuClockSync::GpuClockSync( uint32_t numFrames )
+    : m_FrameOffsets( std::max<uint32_t>( numFrames, 1 ) )
+{
+    Reset();
+}
+
+void GpuClockSync::AddSample( double cpuTime, double gpuTime )
+{
+    m_FrameOffset = std::max( m_FrameOffset, cpuTime - gpuTime );
+}
+
+void GpuClockSync::EndFrame()
+{
+    m_FrameOffsets[m_NextFrame] = m_FrameOffset;
+    m_NextFrame = ( m_NextFrame + 1 ) % m_FrameOffsets.size();
+    m_FrameOffset = -std::numeric_limits<double>::infinity();
+}
+
+bool GpuClockSync::get_Valid() const
+{
+    return get_Offset() != -std::numeric_limits<double>::infinity();
+}
+
+double GpuClockSync::get_Offset() const
+{
+    return std::max( m_FrameOffset, *std::max_element( m_FrameOffsets.begin(), m_FrameOffsets.end() ) );
+}
+
+void GpuClockSync::Reset()
+{
+    m_FrameOffset = -std::numeric_limits<double>::infinity();
+    std::fill( m_FrameOffsets.begin(), m_FrameOffsets.end(), m_FrameOffset );
+    m_NextFrame = 0;
+}
+
+GpuProfiler::GpuProfiler( GpuTimestampQueries& queries )
+    : m_Queries( queries )
+    , m_Slots( queries.get_NumSlots() )
+    , m_CurrentSlot( queries.get_NumSlots() )
+    , m_NumDroppedOpenScopes( 0 )
+    , m_NumFrames( 0 )
+    , m_NumResolvedFrames( 0 )
+    , m_NumSkippedFrames( 0 )
+    , m_NumDisjointFrames( 0 )
+    , m_NumDroppedScopes( 0 )
+    , m_HasReference( false )
+    , m_GpuReference( 0 )
+    , m_CpuReference( 0 )
+    , m_Track( std::numeric_limits<uint32_t>::max() )
+{
+    // A frame needs a timestamp at its start and at its end.
+    if ( queries.get_NumSlots() == 0 || queries.get_MaxTimestamps() < 2 )
+    {
+        throw std::invalid_argument( "The GPU profiler needs at least one slot with two timestamps." );
+    }
+}
+
+void GpuProfiler::BeginFrame()
+{
+    assert( m_CurrentSlot == m_Slots.size() && "EndFrame was not called." );
+
+    uint32_t index = static_cast<uint32_t>( m_NumFrames % m_Slots.size() );
+    Slot& slot = m_Slots[index];
+    uint64_t frameIndex = m_NumFrames++;
+
+    // The GPU finishes the frames in order, so this is the oldest frame in flight.
+    if ( slot.Pending && !Resolve( slot, index ) )
+    {
+        ++m_NumSkippedFrames;
+        return;
+    }
+
+    slot.FrameIndex = frameIndex;
+    slot.Scopes.clear();
+    slot.IssueTimes.clear();
+    m_OpenScopes.clear();
+    m_NumDroppedOpenScopes = 0;
+
+    m_CurrentSlot = index;
+    m_Queries.BeginFrame( index );
+    WriteTimestamp();
+}
+
+void GpuProfiler::EndFrame()
+{
+    if ( m_CurrentSlot < m_Slots.size() )
+    {
+        assert( m_OpenScopes.empty() && m_NumDroppedOpenScopes == 0 && "A GPU scope was not ended." );
+
+        Slot& slot = m_Slots[m_CurrentSlot];
+        WriteTimestamp();
+        m_Queries.EndFrame( m_CurrentSlot );
+        slot.Pending = true;
+        m_CurrentSlot = static_cast<uint32_t>( m_Slots.size() );
+    }
+
+    // Read back the finished frames, oldest first.
+    for ( ;; )
+    {
+        uint32_t oldest = static_cast<uint32_t>( m_Slots.size() );
+        for ( uint32_t i = 0; i < m_Slots.size(); ++i )
+        {
+            if ( m_Slots[i].Pending && ( oldest == m_Slots.size() || m_Slots[i].FrameIndex < m_Slots[oldest].FrameIndex ) )
+            {
+                oldest = i;
+            }
+        }
+
+        if ( oldest == m_Slots.size() || !Resolve( m_Slots[oldest], oldest ) )
+        {
+            break;
+        }
+    }
+}
+
+void GpuProfiler::BeginScope( const char* name )
+{
+    if ( m_CurrentSlot == m_Slots.size() )
+    {
+        return;
+    }
+
+    // Keep a timestamp for the end of each open scope and for the end of the frame.
+    const Slot& slot = m_Slots[m_CurrentSlot];
+    if ( m_NumDroppedOpenScopes > 0 || slot.IssueTimes.size() + m_OpenScopes.size() + 3 > m_Queries.get_MaxTimestamps() )
+    {
+        ++m_NumDroppedOpenScopes;
+        ++m_NumDroppedScopes;
+        return;
+    }
+
+    Scope scope = { name, static_cast<uint32_t>( m_OpenScopes.size() ), WriteTimestamp(), 0 };
+    m_OpenScopes.push_back( static_cast<uint32_t>( slot.Scopes.size() ) );
+    m_Slots[m_CurrentSlot].Scopes.push_back( scope );
+}
+
+void GpuProfiler::EndScope()
+{
+    if ( m_CurrentSlot == m_Slots.size() )
+    {
+        return;
+    }
+
+    // Scopes that were not profiled are always the innermost ones.
+    if ( m_NumDroppedOpenScopes > 0 )
+    {
+        --m_NumDroppedOpenScopes;
+        return;
+    }
+
+    assert( !m_OpenScopes.empty() && "EndScope without BeginScope." );
+    m_Slots[m_CurrentSlot].Scopes[m_OpenScopes.back()].End = WriteTimestamp();
+    m_OpenScopes.pop_back();
+}
+
+uint64_t GpuProfiler::get_NumFrames() const
+{
+    return m_NumFrames;
+}
+
+uint64_t GpuProfiler::get_NumResolvedFrames() const
+{
+    return m_NumResolvedFrames;
+}
+
+const GpuProfileFrame& GpuProfiler::get_LatestFrame() const
+{
+    return m_LatestFrame;
+}
+
+uint64_t GpuProfiler::get_NumSkippedFrames() const
+{
+    return m_NumSkippedFrames;
+}
+
+uint64_t GpuProfiler::get_NumDisjointFrames() const
+{
+    return m_NumDisjointFrames;
+}
+
+uint64_t GpuProfiler::get_NumDroppedScopes() const
+{
+    return m_NumDroppedScopes;
+}
+
+const GpuClockSync& GpuProfiler::get_ClockSync() const
+{
+    return m_ClockSync;
+}
+
+uint32_t GpuProfiler::WriteTimestamp()
+{
+    Slot& slot = m_Slots[m_CurrentSlot];
+    uint32_t index = static_cast<uint32_t>( slot.IssueTimes.size() );
+    slot.IssueTimes.push_back( Profiler::ReadTimestamp() );
+    m_Queries.WriteTimestamp( m_CurrentSlot, index );
+    return index;
+}
+
+bool GpuProfiler::Resolve( Slot& slot, uint32_t index )
+{
+    uint64_t frequency;
+    bool disjoint;
+    if ( !m_Queries.GetFrequency( index, frequency, disjoint ) )
+    {
+        return false;
+    }
+
+    m_Timestamps.resize( slot.IssueTimes.size() );
+    for ( uint32_t i = 0; i < m_Timestamps.size(); ++i )
+    {
+        if ( !m_Queries.GetTimestamp( index, i, m_Timestamps[i] ) )
+        {
+            return false;
+        }
+    }
+    slot.Pending = false;
+
+    if ( disjoint || frequency == 0 )
+    {
+        // The GPU clock may have jumped, so the clocks are synchronized again.
+        ++m_NumDisjointFrames;
+        m_HasReference = false;
+        m_ClockSync.Reset();
+        return true;
+    }
+
+    if ( !m_HasReference )
+    {
+        m_GpuReference = m_Timestamps[0];
+        m_CpuReference = slot.IssueTimes[0];
+        m_HasReference = true;
+    }
+
+    // The times relative to the references, in seconds.
+    double cpuFrequency = Profiler::get_TimestampFrequency();
+    double gpuPeriod = 1.0 / static_cast<double>( frequency );
+    for ( size_t i = 0; i < m_Timestamps.size(); ++i )
+    {
+        double gpuTime = static_cast<int64_t>( m_Timestamps[i] - m_GpuReference ) * gpuPeriod;
+        double cpuTime = ( slot.IssueTimes[i] - m_CpuReference ) / cpuFrequency;
+        m_ClockSync.AddSample( cpuTime, gpuTime );
+    }
+    m_ClockSync.EndFrame();
+
+    uint64_t frameBegin = m_Timestamps.front();
+    m_LatestFrame.FrameIndex = slot.FrameIndex;
+    m_LatestFrame.Duration = static_cast<int64_t>( m_Timestamps.back() - frameBegin ) * gpuPeriod;
+    m_LatestFrame.Zones.clear();
+    for ( const Scope& scope : slot.Scopes )
+    {
+        GpuProfileZone zone;
+        zone.Name = scope.Name;
+        zone.Depth = scope.Depth;
+        zone.Begin = static_cast<int64_t>( m_Timestamps[scope.Begin] - frameBegin ) * gpuPeriod;
+        zone.Duration = static_cast<int64_t>( m_Timestamps[scope.End] - m_Timestamps[scope.Begin] ) * gpuPeriod;
+        m_LatestFrame.Zones.push_back( zone );
+    }
+    ++m_NumResolvedFrames;
+
+    if ( Profiler::get_Enabled() )
+    {
+        if ( m_Track == std::numeric_limits<uint32_t>::max() )
+        {
+            m_Track = Profiler::CreateTrack( "GPU" );
+        }
+
+        // Map the GPU times to profiler timestamps.
+        double frameTime = static_cast<int64_t>( frameBegin - m_GpuReference ) * gpuPeriod + m_ClockSync.get_Offset();
+        int64_t begin = m_CpuReference + static_cast<int64_t>( frameTime * cpuFrequency );
+        Profiler::RecordOnTrack( m_Track, "GPU Frame", begin, begin + static_cast<int64_t>( m_LatestFrame.Duration * cpuFrequency ) );
+        for ( const GpuProfileZone& zone : m_LatestFrame.Zones )
+        {
+            int64_t zoneBegin = begin + static_cast<int64_t>( zone.Begin * cpuFrequency );
+            Profiler::RecordOnTrack( m_Track, zone.Name, zoneBegin, zoneBegin + static_cast<int64_t>( zone.Duration * cpuFrequency ) );
+        }
+    }
+
+    return true;
+}
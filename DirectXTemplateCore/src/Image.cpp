@@ -0,0 +1,47 @@
+#include <DirectXTemplateCorePCH.h>
+#include <Image.h>
+
+#include <fstream>
+
+bool SaveTGA( const std::string& fileName, uint32_t width, uint32_t height, const uint8_t* rgbaPixels )
+{
+    if ( width > 0xFFFF || height > 0xFFFF )
+    {
+        return false;
+    }
+
+    std::ofstream file( fileName.c_str(), std::ios::out | std::ios::binary );
+    if ( !file )
+    {
+        return false;
+    }
+
+    // Uncompressed 32-bit true-color TGA with a top-left origin.
+    uint8_t header[18] = { 0 };
+    header[2] = 2;
+    header[12] = static_cast<uint8_t>( width & 0xFF );
+    header[13] = static_cast<uint8_t>( ( width >> 8 ) & 0xFF );
+    header[14] = static_cast<uint8_t>( height & 0xFF );
+    header[15] = static_cast<uint8_t>( ( height >> 8 ) & 0xFF );
+    header[16] = 32;
+    header[17] = 0x28; // 8 bits of alpha, top-left origin.
+
+    file.write( reinterpret_cast<const char*>( header ), sizeof(header) );
+
+    // TGA stores the pixels in BGRA order.
+    std::vector<uint8_t> row( width * 4 );
+    for ( uint32_t y = 0; y < height; ++y )
+    {
+        const uint8_t* src = rgbaPixels + static_cast<size_t>( y ) * width * 4;
+        for ( uint32_t x = 0; x < width * 4; x += 4 )
+        {
+            row[x + 0] = src[x + 2];
+            row[x + 1] = src[x + 1];
+            row[x + 2] = src[x + 0];
+            row[x + 3] = src[x + 3];
+        }
+        file.write( reinterpret_cast<const char*>( row.data() ), row.size() );
+    }
+
+    return file.good();
+}
@@ -0,0 +1,91 @@
+#include <DirectXTemplateCorePCH.h>
+#include <IndexCollection.h>
+
+IndexCollection::IndexCollection()
+    : m_Is32Bit( false )
+{}
+
+void IndexCollection::set( size_t i, uint32_t index )
+{
+    if ( !m_Is32Bit && index > MaxIndex16 )
+    {
+        Widen();
+    }
+
+    if ( m_Is32Bit )
+    {
+        m_Indices32[i] = index;
+    }
+    else
+    {
+        m_Indices16[i] = static_cast<uint16_t>( index );
+    }
+}
+
+void IndexCollection::clear()
+{
+    m_Indices16.clear();
+    m_Indices32.clear();
+    m_Is32Bit = false;
+}
+
+void IndexCollection::reserve( size_t size )
+{
+    if ( m_Is32Bit )
+    {
+        m_Indices32.reserve( size );
+    }
+    else
+    {
+        m_Indices16.reserve( size );
+    }
+}
+
+void IndexCollection::resize( size_t size )
+{
+    if ( m_Is32Bit )
+    {
+        m_Indices32.resize( size );
+    }
+    else
+    {
+        m_Indices16.resize( size );
+    }
+}
+
+void IndexCollection::Widen()
+{
+    if ( m_Is32Bit ) return;
+
+    m_Indices32.reserve( std::max( m_Indices16.capacity(), m_Indices16.size() + 1 ) );
+    m_Indices32.assign( m_Indices16.begin(), m_Indices16.end() );
+
+    // Release the 16-bit storage.
+    std::vector<uint16_t>().swap( m_Indices16 );
+    m_Is32Bit = true;
+}
+
+bool IndexCollection::get_Is32Bit() const
+{
+    return m_Is32Bit;
+}
+
+size_t IndexCollection::get_IndexSize() const
+{
+    return m_Is32Bit ? sizeof( uint32_t ) : sizeof( uint16_t );
+}
+
+size_t IndexCollection::get_SizeInBytes() const
+{
+    return size() * get_IndexSize();
+}
+
+const void* IndexCollection::data() const
+{
+    return m_Is32Bit ? static_cast<const void*>( m_Indices32.data() ) : static_cast<const void*>( m_Indices16.data() );
+}
+
+void* IndexCollection::data()
+{
+    return m_Is32Bit ? static_cast<void*>( m_Indices32.data() ) : static_cast<void*>( m_Indices16.data() );
+}
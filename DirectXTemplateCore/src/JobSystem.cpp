@@ -0,0 +1,567 @@
+#include <DirectXTemplateCorePCH.h>
+#include <JobSystem.h>
+#include <Profiler.h>
+
+struct Job
+{
+    Job()
+        : Range( nullptr )
+        , Begin( 0 )
+        , End( 0 )
+        , GrainSize( 0 )
+        , Counter( nullptr )
+        , Owner( 0 )
+        , InUse( false )
+    {}
+
+    // Either a function or a range of a ParallelFor.
+    JobSystem::JobFunction Function;
+    const JobSystem::RangeFunction* Range;
+    size_t Begin;
+    size_t End;
+    size_t GrainSize;
+
+    JobCounter* Counter;
+    // The index of the thread that allocated the job.
+    size_t Owner;
+    // Set from allocation until the job is done.
+    std::atomic<bool> InUse;
+};
+
+struct JobSystem::ThreadData
+{
+    explicit ThreadData( size_t index )
+        : Queue( MaxJobsPerThread )
+        , Jobs( new Job[MaxJobsPerThread] )
+        , NextJob( 0 )
+        , NumJobsInUse( 0 )
+        , Index( index )
+        , Random( static_cast<uint32_t>( index * 2654435761u + 1 ) )
+        , JobsExecuted( 0 )
+        , JobsStolen( 0 )
+        , Sleeps( 0 )
+    {}
+
+    WorkStealingQueue Queue;
+    // The jobs that are allocated by this thread, reused in round-robin order.
+    std::unique_ptr<Job[]> Jobs;
+    size_t NextJob;
+    // Decremented by the thread that finishes the job.
+    std::atomic<size_t> NumJobsInUse;
+    size_t Index;
+    // The state of the random number generator that picks the thread to steal from.
+    uint32_t Random;
+
+    std::atomic<uint64_t> JobsExecuted;
+    std::atomic<uint64_t> JobsStolen;
+    std::atomic<uint64_t> Sleeps;
+};
+
+// The JobSystem that the calling thread belongs to and the index of the thread.
+static thread_local const JobSystem* t_JobSystem = nullptr;
+static thread_local size_t t_ThreadIndex = 0;
+
+// The number of times an idle worker looks for work before it goes to sleep.
+static const int SpinCount = 64;
+
+WorkStealingQueue::WorkStealingQueue( size_t capacity )
+    : m_Top( 0 )
+    , m_Bottom( 0 )
+    , m_Jobs( new std::atomic<Job*>[capacity] )
+    , m_Mask( static_cast<int64_t>( capacity ) - 1 )
+{
+    if ( capacity == 0 || ( capacity & ( capacity - 1 ) ) != 0 )
+    {
+        throw std::invalid_argument( "The capacity of a WorkStealingQueue must be a power of two." );
+    }
+}
+
+bool WorkStealingQueue::Push( Job* job )
+{
+    int64_t bottom = m_Bottom.load( std::memory_order_relaxed );
+    int64_t top = m_Top.load( std::memory_order_acquire );
+    if ( bottom - top > m_Mask )
+    {
+        return false;
+    }
+
+    m_Jobs[bottom & m_Mask].store( job, std::memory_order_relaxed );
+    // Publish the job before the new bottom.
+    std::atomic_thread_fence( std::memory_order_release );
+    m_Bottom.store( bottom + 1, std::memory_order_relaxed );
+    return true;
+}
+
+Job* WorkStealingQueue::Pop()
+{
+    int64_t bottom = m_Bottom.load( std::memory_order_relaxed ) - 1;
+    m_Bottom.store( bottom, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    int64_t top = m_Top.load( std::memory_order_relaxed );
+
+    if ( top > bottom )
+    {
+        // Empty.
+        m_Bottom.store( bottom + 1, std::memory_order_relaxed );
+        return nullptr;
+    }
+
+    Job* job = m_Jobs[bottom & m_Mask].load( std::memory_order_relaxed );
+    if ( top == bottom )
+    {
+        // The last job: race against the thieves for it.
+        if ( !m_Top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+        {
+            job = nullptr;
+        }
+        m_Bottom.store( bottom + 1, std::memory_order_relaxed );
+    }
+    return job;
+}
+
+Job* WorkStealingQueue::Steal()
+{
+    int64_t top = m_Top.load( std::memory_order_acquire );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    int64_t bottom = m_Bottom.load( std::memory_order_acquire );
+
+    if ( top >= bottom )
+    {
+        return nullptr;
+    }
+
+    Job* job = m_Jobs[top & m_Mask].load( std::memory_order_relaxed );
+    if ( !m_Top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+    {
+        // Another thread took the job.
+        return nullptr;
+    }
+    return job;
+}
+
+size_t WorkStealingQueue::Size() const
+{
+    int64_t size = m_Bottom.load( std::memory_order_relaxed ) - m_Top.load( std::memory_order_relaxed );
+    return static_cast<size_t>( std::max<int64_t>( size, 0 ) );
+}
+
+JobCounter::JobCounter()
+    : m_Count( 0 )
+{}
+
+bool JobCounter::IsDone() const
+{
+    return m_Count.load( std::memory_order_acquire ) == 0;
+}
+
+uint32_t JobCounter::get_Count() const
+{
+    return m_Count.load( std::memory_order_acquire );
+}
+
+JobSystem::JobSystem( size_t numThreads )
+    : m_WakeGeneration( 0 )
+    , m_NumSleeping( 0 )
+    , m_Quit( false )
+{
+    if ( t_JobSystem )
+    {
+        throw std::logic_error( "The thread already belongs to a JobSystem." );
+    }
+
+    if ( numThreads == 0 )
+    {
+        numThreads = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+    }
+
+    for ( size_t i = 0; i < numThreads; ++i )
+    {
+        m_ThreadData.push_back( std::unique_ptr<ThreadData>( new ThreadData( i ) ) );
+    }
+
+    t_JobSystem = this;
+    t_ThreadIndex = 0;
+
+    for ( size_t i = 1; i < numThreads; ++i )
+    {
+        m_Threads.push_back( std::thread( &JobSystem::WorkerThread, this, i ) );
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_WakeMutex );
+        m_Quit = true;
+        ++m_WakeGeneration;
+    }
+    m_WakeCondition.notify_all();
+
+    for ( std::thread& thread : m_Threads )
+    {
+        thread.join();
+    }
+
+    if ( t_JobSystem == this )
+    {
+        t_JobSystem = nullptr;
+    }
+}
+
+size_t JobSystem::get_NumThreads() const
+{
+    return m_ThreadData.size();
+}
+
+size_t JobSystem::get_ThreadIndex() const
+{
+    return ( t_JobSystem == this ) ? t_ThreadIndex : m_ThreadData.size();
+}
+
+JobSystem::ThreadData& JobSystem::GetThreadData() const
+{
+    size_t index = get_ThreadIndex();
+    if ( index >= m_ThreadData.size() )
+    {
+        throw std::logic_error( "Jobs can only be started and waited for on the threads of the JobSystem." );
+    }
+    return *m_ThreadData[index];
+}
+
+void JobSystem::Run( const JobFunction& function, JobCounter* counter )
+{
+    ThreadData& threadData = GetThreadData();
+
+    Job* job = AllocateJob( threadData );
+    if ( !job )
+    {
+        // Too many unfinished jobs: execute the job now.
+        function();
+        return;
+    }
+
+    job->Function = function;
+    job->Counter = counter;
+    if ( counter )
+    {
+        counter->m_Count.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    Push( job, threadData );
+}
+
+void JobSystem::RunAfter( JobCounter& dependency, const JobFunction& function, JobCounter* counter )
+{
+    ThreadData& threadData = GetThreadData();
+
+    Job* job = AllocateJob( threadData );
+    if ( !job )
+    {
+        // Too many unfinished jobs: wait for the dependency and execute the job now.
+        Wait( dependency );
+        function();
+        return;
+    }
+
+    job->Function = function;
+    job->Counter = counter;
+    if ( counter )
+    {
+        counter->m_Count.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( dependency.m_Mutex );
+        if ( dependency.m_Count.load( std::memory_order_acquire ) != 0 )
+        {
+            // Started by the job that brings the count to zero (see Finish).
+            dependency.m_Dependents.push_back( job );
+            return;
+        }
+    }
+
+    Push( job, threadData );
+}
+
+void JobSystem::Wait( const JobCounter& counter )
+{
+    ThreadData& threadData = GetThreadData();
+
+    while ( counter.m_Count.load( std::memory_order_acquire ) != 0 )
+    {
+        Job* job = FindJob( threadData );
+        if ( job )
+        {
+            Execute( job, threadData );
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // The last job brings the count to zero while it holds the lock. Wait until it
+    // has released the lock so the counter can be destroyed.
+    std::lock_guard<std::mutex> lock( counter.m_Mutex );
+}
+
+void JobSystem::ParallelFor( size_t begin, size_t end, size_t grainSize, const RangeFunction& function )
+{
+    if ( begin >= end )
+    {
+        return;
+    }
+
+    ThreadData& threadData = GetThreadData();
+
+    JobCounter counter;
+    ExecuteRange( function, begin, end, std::max<size_t>( grainSize, 1 ), &counter, threadData );
+    Wait( counter );
+}
+
+JobSystem::Statistics JobSystem::get_Statistics() const
+{
+    Statistics statistics = { 0, 0, 0 };
+    for ( const std::unique_ptr<ThreadData>& threadData : m_ThreadData )
+    {
+        statistics.JobsExecuted += threadData->JobsExecuted.load( std::memory_order_relaxed );
+        statistics.JobsStolen += threadData->JobsStolen.load( std::memory_order_relaxed );
+        statistics.Sleeps += threadData->Sleeps.load( std::memory_order_relaxed );
+    }
+    return statistics;
+}
+
+void JobSystem::ResetStatistics()
+{
+    for ( std::unique_ptr<ThreadData>& threadData : m_ThreadData )
+    {
+        threadData->JobsExecuted.store( 0, std::memory_order_relaxed );
+        threadData->JobsStolen.store( 0, std::memory_order_relaxed );
+        threadData->Sleeps.store( 0, std::memory_order_relaxed );
+    }
+}
+
+Job* JobSystem::AllocateJob( ThreadData& threadData )
+{
+    if ( threadData.NumJobsInUse.load( std::memory_order_relaxed ) >= MaxJobsPerThread )
+    {
+        return nullptr;
+    }
+
+    // Skip the jobs that are still pending or running. Waiting for them here could
+    // deadlock if one of them is executing further up the stack of this thread.
+    for ( size_t i = 0; i < MaxJobsPerThread; ++i )
+    {
+        Job* job = &threadData.Jobs[threadData.NextJob++ & ( MaxJobsPerThread - 1 )];
+        if ( !job->InUse.load( std::memory_order_acquire ) )
+        {
+            threadData.NumJobsInUse.fetch_add( 1, std::memory_order_relaxed );
+            job->InUse.store( true, std::memory_order_relaxed );
+            job->Range = nullptr;
+            job->Counter = nullptr;
+            job->Owner = threadData.Index;
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::Push( Job* job, ThreadData& threadData )
+{
+    if ( !threadData.Queue.Push( job ) )
+    {
+        // The deque is full (only possible for the dependents of a counter).
+        Execute( job, threadData );
+        return;
+    }
+
+    // Wake a sleeping worker. The fence orders the push before the load of m_NumSleeping,
+    // and a worker increments m_NumSleeping before it looks for work a last time, so
+    // either the worker finds the job or it is woken here.
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( m_NumSleeping.load( std::memory_order_seq_cst ) > 0 )
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_WakeMutex );
+            ++m_WakeGeneration;
+        }
+        m_WakeCondition.notify_one();
+    }
+}
+
+Job* JobSystem::FindJob( ThreadData& threadData )
+{
+    Job* job = threadData.Queue.Pop();
+    if ( job )
+    {
+        return job;
+    }
+
+    size_t numThreads = m_ThreadData.size();
+    if ( numThreads == 1 )
+    {
+        return nullptr;
+    }
+
+    // Start at a random thread so the thieves don't all compete for the same deque (xorshift32).
+    uint32_t random = threadData.Random;
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    threadData.Random = random;
+
+    size_t start = random % numThreads;
+    for ( size_t i = 0; i < numThreads; ++i )
+    {
+        size_t victim = ( start + i ) % numThreads;
+        if ( victim == threadData.Index )
+        {
+            continue;
+        }
+
+        job = m_ThreadData[victim]->Queue.Steal();
+        if ( job )
+        {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::Execute( Job* job, ThreadData& threadData )
+{
+    if ( job->Range )
+    {
+        ExecuteRange( *job->Range, job->Begin, job->End, job->GrainSize, job->Counter, threadData );
+    }
+    else
+    {
+        job->Function();
+    }
+
+    threadData.JobsExecuted.fetch_add( 1, std::memory_order_relaxed );
+    if ( job->Owner != threadData.Index )
+    {
+        threadData.JobsStolen.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    JobCounter* counter = job->Counter;
+
+    // Release the captured state before the job can be reused.
+    job->Function = nullptr;
+    job->InUse.store( false, std::memory_order_release );
+    m_ThreadData[job->Owner]->NumJobsInUse.fetch_sub( 1, std::memory_order_relaxed );
+
+    Finish( counter, threadData );
+}
+
+void JobSystem::ExecuteRange( const RangeFunction& function, size_t begin, size_t end, size_t grainSize, JobCounter* counter, ThreadData& threadData )
+{
+    // Split off the upper half as a job until the range is small enough. Thieves take
+    // the oldest (largest) halves from the top of the deque.
+    while ( end - begin > grainSize )
+    {
+        size_t middle = begin + ( end - begin ) / 2;
+
+        Job* job = AllocateJob( threadData );
+        if ( !job )
+        {
+            // Too many unfinished jobs: process the rest of the range on this thread.
+            break;
+        }
+
+        job->Range = &function;
+        job->Begin = middle;
+        job->End = end;
+        job->GrainSize = grainSize;
+        job->Counter = counter;
+        counter->m_Count.fetch_add( 1, std::memory_order_relaxed );
+
+        Push( job, threadData );
+        end = middle;
+    }
+
+    for ( ; begin < end; begin += grainSize )
+    {
+        function( begin, std::min<size_t>( begin + grainSize, end ) );
+    }
+}
+
+void JobSystem::Finish( JobCounter* counter, ThreadData& threadData )
+{
+    if ( !counter )
+    {
+        return;
+    }
+
+    // Decrement without the lock unless this could be the last job.
+    uint32_t count = counter->m_Count.load( std::memory_order_relaxed );
+    while ( count > 1 )
+    {
+        if ( counter->m_Count.compare_exchange_weak( count, count - 1, std::memory_order_acq_rel, std::memory_order_relaxed ) )
+        {
+            return;
+        }
+    }
+
+    std::vector<Job*> dependents;
+    {
+        std::lock_guard<std::mutex> lock( counter->m_Mutex );
+        if ( counter->m_Count.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+        {
+            dependents.swap( counter->m_Dependents );
+        }
+    }
+
+    // The counter may be destroyed by now.
+    for ( Job* job : dependents )
+    {
+        Push( job, threadData );
+    }
+}
+
+void JobSystem::WorkerThread( size_t index )
+{
+    t_JobSystem = this;
+    t_ThreadIndex = index;
+    Profiler::SetThreadName( "Job " + std::to_string( index ) );
+
+    ThreadData& threadData = *m_ThreadData[index];
+    for ( ;; )
+    {
+        Job* job = FindJob( threadData );
+        for ( int i = 0; !job && i < SpinCount; ++i )
+        {
+            std::this_thread::yield();
+            job = FindJob( threadData );
+        }
+
+        if ( !job )
+        {
+            std::unique_lock<std::mutex> lock( m_WakeMutex );
+            if ( m_Quit )
+            {
+                return;
+            }
+
+            // Announce that this thread is going to sleep, then look for work a last time.
+            uint64_t generation = m_WakeGeneration;
+            m_NumSleeping.fetch_add( 1, std::memory_order_seq_cst );
+            lock.unlock();
+            job = FindJob( threadData );
+            lock.lock();
+
+            if ( !job )
+            {
+                threadData.Sleeps.fetch_add( 1, std::memory_order_relaxed );
+                m_WakeCondition.wait( lock, [this, generation]() { return m_Quit || m_WakeGeneration != generation; } );
+            }
+            m_NumSleeping.fetch_sub( 1, std::memory_order_seq_cst );
+        }
+
+        if ( job )
+        {
+            Execute( job, threadData );
+        }
+    }
+}
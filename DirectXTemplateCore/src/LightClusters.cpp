@@ -0,0 +1,520 @@
+#include <DirectXTemplateCorePCH.h>
+#include <LightClusters.h>
+
+#include <JobSystem.h>
+#include <Simd.h>
+
+#include <cfloat>
+#include <limits>
+
+using namespace Math;
+
+namespace
+{
+    const float Infinity = std::numeric_limits<float>::infinity();
+
+    // The slice ranges of the lights are widened by a fraction of a slice because
+    // Simd::Log2 is not exact. The box test of the clusters is exact.
+    const float SliceMargin = 1.0f / 1024.0f;
+
+    // The number of lights whose cluster ranges are computed in one job.
+    const size_t LightsPerJob = 1024;
+
+    // The distance from a value to a range (0 inside the range).
+    inline float RangeDistance( float value, float minimum, float maximum )
+    {
+        return std::max( std::max( minimum - value, value - maximum ), 0.0f );
+    }
+}
+
+float AttenuationRange( const Light& light, float threshold )
+{
+    if ( light.LightType == DirectionalLight )
+    {
+        return Infinity;
+    }
+
+    // Solve ConstantAttenuation + LinearAttenuation * d + QuadraticAttenuation * d^2 = 1 / threshold.
+    float c = light.ConstantAttenuation - 1.0f / threshold;
+    float l = light.LinearAttenuation;
+    float q = light.QuadraticAttenuation;
+    if ( c >= 0.0f )
+    {
+        return 0.0f;
+    }
+    if ( q > 0.0f )
+    {
+        return ( -l + std::sqrt( l * l - 4.0f * q * c ) ) / ( 2.0f * q );
+    }
+    if ( l > 0.0f )
+    {
+        return -c / l;
+    }
+    return Infinity;
+}
+
+BoundingSphere LightBounds( const Light& light )
+{
+    Float3 position = XYZ( light.Position );
+    if ( light.LightType == DirectionalLight || !( light.Range < FLT_MAX ) )
+    {
+        return BoundingSphere( position, Infinity );
+    }
+
+    if ( light.LightType == SpotLight && light.SpotAngle < PiDiv2 )
+    {
+        Float3 direction = Normalize( XYZ( light.Direction ) );
+        if ( light.SpotAngle > PiDiv4 )
+        {
+            // The sphere around the base of the cone also contains the apex.
+            return BoundingSphere( position + direction * ( light.Range * std::cos( light.SpotAngle ) ), light.Range * std::sin( light.SpotAngle ) );
+        }
+
+        // The sphere through the apex and the rim of the base.
+        float radius = light.Range / ( 2.0f * std::cos( light.SpotAngle ) );
+        return BoundingSphere( position + direction * radius, radius );
+    }
+
+    return BoundingSphere( position, light.Range );
+}
+
+LightClusters::LightClusters( uint32_t numTilesX, uint32_t numTilesY, uint32_t numSlices )
+    : m_NumTilesX( numTilesX )
+    , m_NumTilesY( numTilesY )
+    , m_NumSlices( numSlices )
+{
+    if ( numTilesX == 0 || numTilesY == 0 || numSlices == 0 ||
+         numTilesX > MaxTiles || numTilesY > MaxTiles || numSlices > MaxTiles )
+    {
+        throw std::invalid_argument( "The number of tiles and slices must be between 1 and LightClusters::MaxTiles." );
+    }
+
+    m_SliceLights.resize( numSlices );
+    m_Clusters.resize( get_NumClusters() );
+    SetProjection( 45.0f, 16.0f / 9.0f, 0.1f, 100.0f );
+}
+
+uint32_t LightClusters::get_NumTilesX() const
+{
+    return m_NumTilesX;
+}
+
+uint32_t LightClusters::get_NumTilesY() const
+{
+    return m_NumTilesY;
+}
+
+uint32_t LightClusters::get_NumSlices() const
+{
+    return m_NumSlices;
+}
+
+uint32_t LightClusters::get_NumClusters() const
+{
+    return m_NumTilesX * m_NumTilesY * m_NumSlices;
+}
+
+void LightClusters::SetProjection( float fovy, float aspect, float zNear, float zFar )
+{
+    if ( !( fovy > 0.0f && fovy < 180.0f ) || !( aspect > 0.0f ) || !( zNear > 0.0f ) || !( zFar > zNear ) )
+    {
+        throw std::invalid_argument( "The clusters need a perspective projection with 0 < zNear < zFar." );
+    }
+
+    m_zNear = zNear;
+    m_zFar = zFar;
+
+    float log2Range = std::log2( zFar / zNear );
+    m_SliceScale = m_NumSlices / log2Range;
+    m_SliceBias = -std::log2( zNear ) * m_SliceScale;
+
+    m_SliceDepths.resize( m_NumSlices + 1 );
+    for ( uint32_t s = 0; s <= m_NumSlices; ++s )
+    {
+        m_SliceDepths[s] = zNear * std::pow( zFar / zNear, static_cast<float>( s ) / m_NumSlices );
+    }
+    m_SliceDepths[m_NumSlices] = zFar;
+
+    // The slopes (x / z and y / z) of the planes between the tiles. Row 0 is at the top.
+    float tanY = std::tan( ConvertToRadians( fovy ) * 0.5f );
+    float tanX = tanY * aspect;
+    std::vector<float> slopesX( m_NumTilesX + 1 );
+    std::vector<float> slopesY( m_NumTilesY + 1 );
+
+    m_PlaneX.assign( m_NumTilesX + 1 + Simd::Width, 0.0f );
+    m_PlaneXZ.assign( m_NumTilesX + 1 + Simd::Width, 0.0f );
+    for ( uint32_t k = 0; k <= m_NumTilesX; ++k )
+    {
+        slopesX[k] = ( 2.0f * k / m_NumTilesX - 1.0f ) * tanX;
+        float length = std::sqrt( 1.0f + slopesX[k] * slopesX[k] );
+        m_PlaneX[k] = 1.0f / length;
+        m_PlaneXZ[k] = -slopesX[k] / length;
+    }
+
+    m_PlaneY.assign( m_NumTilesY + 1 + Simd::Width, 0.0f );
+    m_PlaneYZ.assign( m_NumTilesY + 1 + Simd::Width, 0.0f );
+    for ( uint32_t k = 0; k <= m_NumTilesY; ++k )
+    {
+        slopesY[k] = ( 1.0f - 2.0f * k / m_NumTilesY ) * tanY;
+        float length = std::sqrt( 1.0f + slopesY[k] * slopesY[k] );
+        m_PlaneY[k] = -1.0f / length;
+        m_PlaneYZ[k] = slopesY[k] / length;
+    }
+
+    // The boxes of the columns and rows of each slice.
+    m_ColumnMin.assign( m_NumSlices * m_NumTilesX + Simd::Width, 0.0f );
+    m_ColumnMax.assign( m_NumSlices * m_NumTilesX + Simd::Width, 0.0f );
+    m_RowMin.assign( m_NumSlices * m_NumTilesY, 0.0f );
+    m_RowMax.assign( m_NumSlices * m_NumTilesY, 0.0f );
+    for ( uint32_t s = 0; s < m_NumSlices; ++s )
+    {
+        float zn = m_SliceDepths[s];
+        float zf = m_SliceDepths[s + 1];
+        for ( uint32_t x = 0; x < m_NumTilesX; ++x )
+        {
+            m_ColumnMin[s * m_NumTilesX + x] = std::min( slopesX[x] * zn, slopesX[x] * zf );
+            m_ColumnMax[s * m_NumTilesX + x] = std::max( slopesX[x + 1] * zn, slopesX[x + 1] * zf );
+        }
+        for ( uint32_t y = 0; y < m_NumTilesY; ++y )
+        {
+            m_RowMin[s * m_NumTilesY + y] = std::min( slopesY[y + 1] * zn, slopesY[y + 1] * zf );
+            m_RowMax[s * m_NumTilesY + y] = std::max( slopesY[y] * zn, slopesY[y] * zf );
+        }
+    }
+}
+
+void LightClusters::SetProjection( const Camera& camera )
+{
+    SetProjection( camera.get_VerticalFieldOfView(), camera.get_AspectRatio(), camera.get_NearClipPlane(), camera.get_FarClipPlane() );
+}
+
+void LightClusters::AssignLights( const BoundingSphereArrays& lights, JobSystem* jobSystem )
+{
+    size_t numLights = lights.Size();
+    m_LightRanges.resize( numLights );
+
+    if ( jobSystem )
+    {
+        jobSystem->ParallelFor( 0, numLights, LightsPerJob, [&]( size_t begin, size_t end )
+        {
+            ComputeLightRanges( lights, begin, end );
+        } );
+        jobSystem->ParallelFor( 0, m_NumSlices, 1, [&]( size_t begin, size_t end )
+        {
+            for ( size_t s = begin; s < end; ++s )
+            {
+                AssignSlice( lights, static_cast<uint32_t>( s ) );
+            }
+        } );
+    }
+    else
+    {
+        ComputeLightRanges( lights, 0, numLights );
+        for ( uint32_t s = 0; s < m_NumSlices; ++s )
+        {
+            AssignSlice( lights, s );
+        }
+    }
+
+    // The offsets of the lists. The counts are incremented again when the lists are compacted.
+    uint32_t offset = 0;
+    for ( LightCluster& cluster : m_Clusters )
+    {
+        cluster.Offset = offset;
+        offset += cluster.Count;
+        cluster.Count = 0;
+    }
+    m_LightIndices.resize( offset );
+
+    if ( jobSystem )
+    {
+        jobSystem->ParallelFor( 0, m_NumSlices, 1, [&]( size_t begin, size_t end )
+        {
+            for ( size_t s = begin; s < end; ++s )
+            {
+                CompactSlice( static_cast<uint32_t>( s ) );
+            }
+        } );
+    }
+    else
+    {
+        for ( uint32_t s = 0; s < m_NumSlices; ++s )
+        {
+            CompactSlice( s );
+        }
+    }
+}
+
+void LightClusters::ComputeLightRanges( const BoundingSphereArrays& lights, size_t begin, size_t end )
+{
+    using namespace Simd;
+
+    SIMD_ALIGN(32) float values[4][Width];
+    SIMD_ALIGN(32) float ranges[6][Width];
+
+    const Float zNear = Set1( m_zNear );
+    const Float zFar = Set1( m_zFar );
+    const Float sliceScale = Set1( m_SliceScale );
+
+    for ( size_t i = begin; i < end; i += Width )
+    {
+        // The last lights are copied so that every lane can be loaded.
+        size_t count = std::min<size_t>( Width, end - i );
+        const std::vector<float>* arrays[4] = { &lights.CenterX, &lights.CenterY, &lights.CenterZ, &lights.Radius };
+        for ( int a = 0; a < 4; ++a )
+        {
+            for ( int lane = 0; lane < Width; ++lane )
+            {
+                values[a][lane] = ( static_cast<size_t>( lane ) < count ) ? ( *arrays[a] )[i + lane] : 0.0f;
+            }
+        }
+
+        Float cx = Load( values[0] );
+        Float cy = Load( values[1] );
+        Float cz = Load( values[2] );
+        Float radius = Load( values[3] );
+        Float negativeRadius = -radius;
+
+        // The first and the last column whose planes do not have the sphere on the outside.
+        Float minX = Set1( static_cast<float>( m_NumTilesX ) );
+        Float maxX = Set1( -1.0f );
+        Float distance = cx * Set1( m_PlaneX[0] ) + cz * Set1( m_PlaneXZ[0] );
+        for ( uint32_t t = 0; t < m_NumTilesX; ++t )
+        {
+            Float nextDistance = cx * Set1( m_PlaneX[t + 1] ) + cz * Set1( m_PlaneXZ[t + 1] );
+            Float inside = And( CmpGE( distance, negativeRadius ), CmpLE( nextDistance, radius ) );
+            minX = Min( minX, Select( inside, Set1( static_cast<float>( t ) ), minX ) );
+            maxX = Select( inside, Set1( static_cast<float>( t ) ), maxX );
+            distance = nextDistance;
+        }
+
+        Float minY = Set1( static_cast<float>( m_NumTilesY ) );
+        Float maxY = Set1( -1.0f );
+        distance = cy * Set1( m_PlaneY[0] ) + cz * Set1( m_PlaneYZ[0] );
+        for ( uint32_t t = 0; t < m_NumTilesY; ++t )
+        {
+            Float nextDistance = cy * Set1( m_PlaneY[t + 1] ) + cz * Set1( m_PlaneYZ[t + 1] );
+            Float inside = And( CmpGE( distance, negativeRadius ), CmpLE( nextDistance, radius ) );
+            minY = Min( minY, Select( inside, Set1( static_cast<float>( t ) ), minY ) );
+            maxY = Select( inside, Set1( static_cast<float>( t ) ), maxY );
+            distance = nextDistance;
+        }
+
+        // The slices of the depth range of the sphere.
+        Float visible = And( CmpGE( cz + radius, zNear ), CmpLE( cz - radius, zFar ) );
+        visible = And( visible, And( CmpLE( minX, maxX ), CmpLE( minY, maxY ) ) );
+        Float minSlice = Floor( Log2( Max( cz - radius, zNear ) ) * sliceScale + Set1( m_SliceBias - SliceMargin ) );
+        Float maxSlice = Floor( Log2( Min( cz + radius, zFar ) ) * sliceScale + Set1( m_SliceBias + SliceMargin ) );
+        minSlice = Select( visible, Max( minSlice, Zero() ), Set1( 1.0f ) );
+        maxSlice = Select( visible, Min( maxSlice, Set1( static_cast<float>( m_NumSlices - 1 ) ) ), Zero() );
+
+        Store( ranges[0], minX );
+        Store( ranges[1], maxX );
+        Store( ranges[2], minY );
+        Store( ranges[3], maxY );
+        Store( ranges[4], minSlice );
+        Store( ranges[5], maxSlice );
+        for ( size_t lane = 0; lane < count; ++lane )
+        {
+            LightRange& range = m_LightRanges[i + lane];
+            range.MinX = static_cast<uint16_t>( ranges[0][lane] );
+            range.MaxX = static_cast<uint16_t>( ranges[1][lane] );
+            range.MinY = static_cast<uint16_t>( ranges[2][lane] );
+            range.MaxY = static_cast<uint16_t>( ranges[3][lane] );
+            range.MinSlice = static_cast<uint16_t>( ranges[4][lane] );
+            range.MaxSlice = static_cast<uint16_t>( ranges[5][lane] );
+        }
+    }
+}
+
+void LightClusters::AssignSlice( const BoundingSphereArrays& lights, uint32_t slice )
+{
+    using namespace Simd;
+
+    std::vector<ClusterLight>& sliceLights = m_SliceLights[slice];
+    sliceLights.clear();
+
+    LightCluster* clusters = &m_Clusters[slice * m_NumTilesX * m_NumTilesY];
+    for ( uint32_t i = 0; i < m_NumTilesX * m_NumTilesY; ++i )
+    {
+        clusters[i].Count = 0;
+    }
+
+    float zn = m_SliceDepths[slice];
+    float zf = m_SliceDepths[slice + 1];
+    const float* columnMin = &m_ColumnMin[slice * m_NumTilesX];
+    const float* columnMax = &m_ColumnMax[slice * m_NumTilesX];
+    const float* rowMin = &m_RowMin[slice * m_NumTilesY];
+    const float* rowMax = &m_RowMax[slice * m_NumTilesY];
+
+    for ( size_t l = 0; l < m_LightRanges.size(); ++l )
+    {
+        const LightRange& range = m_LightRanges[l];
+        if ( slice < range.MinSlice || slice > range.MaxSlice )
+        {
+            continue;
+        }
+
+        float cx = lights.CenterX[l];
+        float cy = lights.CenterY[l];
+        float cz = lights.CenterZ[l];
+        float r = lights.Radius[l];
+        float radiusSq = r * r;
+
+        float dz = RangeDistance( cz, zn, zf );
+        float dzSq = dz * dz;
+        if ( dzSq > radiusSq )
+        {
+            continue;
+        }
+
+        Float x = Set1( cx );
+        Float z = Set1( cz );
+        Float radius = Set1( r );
+        Float negativeRadius = Set1( -r );
+        Float radiusSqV = Set1( radiusSq );
+
+        for ( uint32_t ty = range.MinY; ty <= range.MaxY; ++ty )
+        {
+            float rowDistance = cy * m_PlaneY[ty] + cz * m_PlaneYZ[ty];
+            float nextRowDistance = cy * m_PlaneY[ty + 1] + cz * m_PlaneYZ[ty + 1];
+            float dy = RangeDistance( cy, rowMin[ty], rowMax[ty] );
+            float dyzSq = dy * dy + dzSq;
+            if ( !( rowDistance >= -r && nextRowDistance <= r ) || dyzSq > radiusSq )
+            {
+                continue;
+            }
+
+            // Test Simd::Width clusters of the row at a time.
+            Float dyz = Set1( dyzSq );
+            for ( uint32_t tx = range.MinX; tx <= range.MaxX; tx += Width )
+            {
+                Float columnDistance = x * LoadUnaligned( &m_PlaneX[tx] ) + z * LoadUnaligned( &m_PlaneXZ[tx] );
+                Float nextColumnDistance = x * LoadUnaligned( &m_PlaneX[tx + 1] ) + z * LoadUnaligned( &m_PlaneXZ[tx + 1] );
+                Float dx = Max( Max( LoadUnaligned( columnMin + tx ) - x, x - LoadUnaligned( columnMax + tx ) ), Zero() );
+                Float inside = And( And( CmpGE( columnDistance, negativeRadius ), CmpLE( nextColumnDistance, radius ) ), CmpLE( dx * dx + dyz, radiusSqV ) );
+
+                uint32_t numColumns = std::min<uint32_t>( Width, range.MaxX + 1 - tx );
+                int mask = MoveMask( inside ) & ( ( 1 << numColumns ) - 1 );
+                for ( uint32_t lane = 0; mask != 0; ++lane, mask >>= 1 )
+                {
+                    if ( mask & 1 )
+                    {
+                        uint32_t cluster = ty * m_NumTilesX + tx + lane;
+                        ++clusters[cluster].Count;
+                        ClusterLight clusterLight = { cluster, static_cast<uint32_t>( l ) };
+                        sliceLights.push_back( clusterLight );
+                    }
+                }
+            }
+        }
+    }
+}
+
+void LightClusters::CompactSlice( uint32_t slice )
+{
+    LightCluster* clusters = &m_Clusters[slice * m_NumTilesX * m_NumTilesY];
+    for ( const ClusterLight& clusterLight : m_SliceLights[slice] )
+    {
+        LightCluster& cluster = clusters[clusterLight.Cluster];
+        m_LightIndices[cluster.Offset + cluster.Count++] = clusterLight.Light;
+    }
+}
+
+const std::vector<LightCluster>& LightClusters::get_Clusters() const
+{
+    return m_Clusters;
+}
+
+const std::vector<uint32_t>& LightClusters::get_LightIndices() const
+{
+    return m_LightIndices;
+}
+
+uint32_t LightClusters::GetClusterIndex( uint32_t x, uint32_t y, uint32_t slice ) const
+{
+    assert( x < m_NumTilesX && y < m_NumTilesY && slice < m_NumSlices );
+    return ( slice * m_NumTilesY + y ) * m_NumTilesX + x;
+}
+
+uint32_t LightClusters::GetSlice( float depth ) const
+{
+    if ( !( depth > m_zNear ) )
+    {
+        return 0;
+    }
+
+    float slice = std::floor( std::log2( depth ) * m_SliceScale + m_SliceBias );
+    return static_cast<uint32_t>( std::min( std::max( slice, 0.0f ), static_cast<float>( m_NumSlices - 1 ) ) );
+}
+
+BoundingBox LightClusters::GetClusterBounds( uint32_t clusterIndex ) const
+{
+    assert( clusterIndex < get_NumClusters() );
+
+    uint32_t x = clusterIndex % m_NumTilesX;
+    uint32_t y = ( clusterIndex / m_NumTilesX ) % m_NumTilesY;
+    uint32_t slice = clusterIndex / ( m_NumTilesX * m_NumTilesY );
+
+    Float3 minimum( m_ColumnMin[slice * m_NumTilesX + x], m_RowMin[slice * m_NumTilesY + y], m_SliceDepths[slice] );
+    Float3 maximum( m_ColumnMax[slice * m_NumTilesX + x], m_RowMax[slice * m_NumTilesY + y], m_SliceDepths[slice + 1] );
+    return BoundingBox( ( minimum + maximum ) * 0.5f, ( maximum - minimum ) * 0.5f );
+}
+
+bool LightClusters::Intersects( const BoundingSphere& sphere, uint32_t clusterIndex ) const
+{
+    assert( clusterIndex < get_NumClusters() );
+
+    uint32_t x = clusterIndex % m_NumTilesX;
+    uint32_t y = ( clusterIndex / m_NumTilesX ) % m_NumTilesY;
+    uint32_t slice = clusterIndex / ( m_NumTilesX * m_NumTilesY );
+
+    const Float3& c = sphere.Center;
+    float r = sphere.Radius;
+
+    // The same operations as AssignLights so that the results are identical.
+    float columnDistance = c.x * m_PlaneX[x] + c.z * m_PlaneXZ[x];
+    float nextColumnDistance = c.x * m_PlaneX[x + 1] + c.z * m_PlaneXZ[x + 1];
+    float rowDistance = c.y * m_PlaneY[y] + c.z * m_PlaneYZ[y];
+    float nextRowDistance = c.y * m_PlaneY[y + 1] + c.z * m_PlaneYZ[y + 1];
+    if ( !( columnDistance >= -r && nextColumnDistance <= r && rowDistance >= -r && nextRowDistance <= r ) )
+    {
+        return false;
+    }
+
+    float dx = RangeDistance( c.x, m_ColumnMin[slice * m_NumTilesX + x], m_ColumnMax[slice * m_NumTilesX + x] );
+    float dy = RangeDistance( c.y, m_RowMin[slice * m_NumTilesY + y], m_RowMax[slice * m_NumTilesY + y] );
+    float dz = RangeDistance( c.z, m_SliceDepths[slice], m_SliceDepths[slice + 1] );
+    return dx * dx + ( dy * dy + dz * dz ) <= r * r;
+}
+
+ClusterConstants LightClusters::GetConstants( const Viewport& viewport ) const
+{
+    ClusterConstants constants = {};
+    constants.TileScaleX = m_NumTilesX / viewport.Width;
+    constants.TileScaleY = m_NumTilesY / viewport.Height;
+    constants.TileBiasX = -viewport.TopLeftX * constants.TileScaleX;
+    constants.TileBiasY = -viewport.TopLeftY * constants.TileScaleY;
+    constants.SliceScale = m_SliceScale;
+    constants.SliceBias = m_SliceBias;
+    constants.NumTilesX = static_cast<int>( m_NumTilesX );
+    constants.NumTilesY = static_cast<int>( m_NumTilesY );
+    constants.NumSlices = static_cast<int>( m_NumSlices );
+    return constants;
+}
+
+size_t LightClusters::get_MemoryUsage() const
+{
+    size_t size = sizeof( LightClusters );
+    size += ( m_PlaneX.capacity() + m_PlaneXZ.capacity() + m_PlaneY.capacity() + m_PlaneYZ.capacity() ) * sizeof( float );
+    size += ( m_SliceDepths.capacity() + m_ColumnMin.capacity() + m_ColumnMax.capacity() + m_RowMin.capacity() + m_RowMax.capacity() ) * sizeof( float );
+    size += m_LightRanges.capacity() * sizeof( LightRange );
+    size += m_SliceLights.capacity() * sizeof( std::vector<ClusterLight> );
+    for ( const std::vector<ClusterLight>& sliceLights : m_SliceLights )
+    {
+        size += sliceLights.capacity() * sizeof( ClusterLight );
+    }
+    size += m_Clusters.capacity() * sizeof( LightCluster );
+    size += m_LightIndices.capacity() * sizeof( uint32_t );
+    return size;
+}
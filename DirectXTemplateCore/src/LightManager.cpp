@@ -0,0 +1,324 @@
+#include <DirectXTemplateCorePCH.h>
+#include <LightManager.h>
+
+#include <LightClusters.h>
+
+using namespace Math;
+
+LightManager::LightManager()
+    : m_AllDirty( false )
+{
+    std::fill( m_NumEnabledLights, m_NumEnabledLights + LightTypeCount, 0 );
+}
+
+LightHandle LightManager::Add( const Light& light )
+{
+    uint32_t index = get_NumLights();
+
+    uint32_t slot;
+    if ( !m_FreeSlots.empty() )
+    {
+        slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>( m_Slots.size() );
+        Slot newSlot = { InvalidIndex, 0 };
+        m_Slots.push_back( newSlot );
+    }
+    m_Slots[slot].Index = index;
+    m_Slots[slot].Generation++;
+
+    m_LightSlots.push_back( slot );
+    m_Positions.push_back( light.Position );
+    m_Directions.push_back( light.Direction );
+    m_Colors.push_back( light.Color );
+    m_SpotAngles.push_back( light.SpotAngle );
+    m_ConstantAttenuations.push_back( light.ConstantAttenuation );
+    m_LinearAttenuations.push_back( light.LinearAttenuation );
+    m_QuadraticAttenuations.push_back( light.QuadraticAttenuation );
+    m_Ranges.push_back( light.Range );
+    m_LightTypes.push_back( light.LightType );
+    m_Enabled.push_back( light.Enabled );
+    m_ShadowIndices.push_back( light.ShadowIndex );
+    m_DirtyFlags.push_back( 0 );
+
+    CountLight( light.LightType, light.Enabled, 1 );
+    MarkDirty( index );
+
+    LightHandle handle = { slot, m_Slots[slot].Generation };
+    return handle;
+}
+
+void LightManager::Remove( LightHandle handle )
+{
+    assert( IsValid( handle ) );
+
+    uint32_t index = m_Slots[handle.Slot].Index;
+    uint32_t last = get_NumLights() - 1;
+
+    m_Slots[handle.Slot].Index = InvalidIndex;
+    m_FreeSlots.push_back( handle.Slot );
+    CountLight( m_LightTypes[index], m_Enabled[index], -1 );
+
+    // Move the last light into the hole so that the lights stay packed.
+    if ( index != last )
+    {
+        m_LightSlots[index] = m_LightSlots[last];
+        m_Slots[m_LightSlots[index]].Index = index;
+        m_Positions[index] = m_Positions[last];
+        m_Directions[index] = m_Directions[last];
+        m_Colors[index] = m_Colors[last];
+        m_SpotAngles[index] = m_SpotAngles[last];
+        m_ConstantAttenuations[index] = m_ConstantAttenuations[last];
+        m_LinearAttenuations[index] = m_LinearAttenuations[last];
+        m_QuadraticAttenuations[index] = m_QuadraticAttenuations[last];
+        m_Ranges[index] = m_Ranges[last];
+        m_LightTypes[index] = m_LightTypes[last];
+        m_Enabled[index] = m_Enabled[last];
+        m_ShadowIndices[index] = m_ShadowIndices[last];
+        MarkDirty( index );
+    }
+
+    // The last light no longer exists, so it does not need to be uploaded.
+    if ( m_DirtyFlags[last] )
+    {
+        m_DirtyLights.erase( std::find( m_DirtyLights.begin(), m_DirtyLights.end(), last ) );
+    }
+
+    m_LightSlots.pop_back();
+    m_Positions.pop_back();
+    m_Directions.pop_back();
+    m_Colors.pop_back();
+    m_SpotAngles.pop_back();
+    m_ConstantAttenuations.pop_back();
+    m_LinearAttenuations.pop_back();
+    m_QuadraticAttenuations.pop_back();
+    m_Ranges.pop_back();
+    m_LightTypes.pop_back();
+    m_Enabled.pop_back();
+    m_ShadowIndices.pop_back();
+    m_DirtyFlags.pop_back();
+}
+
+void LightManager::Clear()
+{
+    // Keep the generations of the slots so that the old handles stay invalid.
+    m_FreeSlots.clear();
+    for ( uint32_t slot = 0; slot < m_Slots.size(); ++slot )
+    {
+        m_Slots[slot].Index = InvalidIndex;
+        m_FreeSlots.push_back( slot );
+    }
+
+    m_LightSlots.clear();
+    m_Positions.clear();
+    m_Directions.clear();
+    m_Colors.clear();
+    m_SpotAngles.clear();
+    m_ConstantAttenuations.clear();
+    m_LinearAttenuations.clear();
+    m_QuadraticAttenuations.clear();
+    m_Ranges.clear();
+    m_LightTypes.clear();
+    m_Enabled.clear();
+    m_ShadowIndices.clear();
+    m_DirtyFlags.clear();
+    m_DirtyLights.clear();
+    m_AllDirty = false;
+    std::fill( m_NumEnabledLights, m_NumEnabledLights + LightTypeCount, 0 );
+}
+
+bool LightManager::IsValid( LightHandle handle ) const
+{
+    return handle.Slot < m_Slots.size() && handle.Generation != 0 &&
+           m_Slots[handle.Slot].Generation == handle.Generation && m_Slots[handle.Slot].Index != InvalidIndex;
+}
+
+uint32_t LightManager::get_NumLights() const
+{
+    return static_cast<uint32_t>( m_LightSlots.size() );
+}
+
+uint32_t LightManager::GetNumEnabledLights( LightType type ) const
+{
+    assert( type < LightTypeCount );
+    return m_NumEnabledLights[type];
+}
+
+uint32_t LightManager::GetIndex( LightHandle handle ) const
+{
+    assert( IsValid( handle ) );
+    return m_Slots[handle.Slot].Index;
+}
+
+Light LightManager::Get( LightHandle handle ) const
+{
+    return GetAt( GetIndex( handle ) );
+}
+
+Light LightManager::GetAt( uint32_t index ) const
+{
+    Light light;
+    WriteLights( index, 1, &light );
+    return light;
+}
+
+void LightManager::Set( LightHandle handle, const Light& light )
+{
+    uint32_t index = GetIndex( handle );
+    CountLight( m_LightTypes[index], m_Enabled[index], -1 );
+    CountLight( light.LightType, light.Enabled, 1 );
+    m_Positions[index] = light.Position;
+    m_Directions[index] = light.Direction;
+    m_Colors[index] = light.Color;
+    m_SpotAngles[index] = light.SpotAngle;
+    m_ConstantAttenuations[index] = light.ConstantAttenuation;
+    m_LinearAttenuations[index] = light.LinearAttenuation;
+    m_QuadraticAttenuations[index] = light.QuadraticAttenuation;
+    m_Ranges[index] = light.Range;
+    m_LightTypes[index] = light.LightType;
+    m_Enabled[index] = light.Enabled;
+    m_ShadowIndices[index] = light.ShadowIndex;
+    MarkDirty( index );
+}
+
+void LightManager::SetPosition( LightHandle handle, const Float3& position )
+{
+    uint32_t index = GetIndex( handle );
+    m_Positions[index] = Float4( position, 1.0f );
+    MarkDirty( index );
+}
+
+void LightManager::SetDirection( LightHandle handle, const Float3& direction )
+{
+    uint32_t index = GetIndex( handle );
+    m_Directions[index] = Float4( direction, 0.0f );
+    MarkDirty( index );
+}
+
+void LightManager::SetColor( LightHandle handle, const Float4& color )
+{
+    uint32_t index = GetIndex( handle );
+    m_Colors[index] = color;
+    MarkDirty( index );
+}
+
+void LightManager::SetEnabled( LightHandle handle, bool enabled )
+{
+    uint32_t index = GetIndex( handle );
+    CountLight( m_LightTypes[index], m_Enabled[index], -1 );
+    m_Enabled[index] = enabled ? 1 : 0;
+    CountLight( m_LightTypes[index], m_Enabled[index], 1 );
+    MarkDirty( index );
+}
+
+void LightManager::SetShadowIndex( LightHandle handle, int shadowIndex )
+{
+    uint32_t index = GetIndex( handle );
+    if ( m_ShadowIndices[index] != shadowIndex )
+    {
+        m_ShadowIndices[index] = shadowIndex;
+        MarkDirty( index );
+    }
+}
+
+void LightManager::ComputeBounds( const Float4x4& matrix, BoundingSphereArrays& bounds ) const
+{
+    bounds.Clear();
+    bounds.Reserve( get_NumLights() );
+    for ( uint32_t i = 0; i < get_NumLights(); ++i )
+    {
+        bounds.Add( Transform( LightBounds( GetAt( i ) ), matrix ) );
+    }
+}
+
+void LightManager::CountLight( int lightType, int enabled, int count )
+{
+    assert( lightType >= 0 && lightType < LightTypeCount );
+    if ( enabled )
+    {
+        m_NumEnabledLights[lightType] += count;
+    }
+}
+
+void LightManager::MarkDirty( uint32_t index )
+{
+    if ( !m_DirtyFlags[index] )
+    {
+        m_DirtyFlags[index] = 1;
+        m_DirtyLights.push_back( index );
+    }
+}
+
+void LightManager::GetDirtyRanges( std::vector<DirtyRange>& ranges, uint32_t mergeDistance ) const
+{
+    ranges.clear();
+
+    if ( m_AllDirty )
+    {
+        if ( get_NumLights() > 0 )
+        {
+            DirtyRange range = { 0, get_NumLights() };
+            ranges.push_back( range );
+        }
+        return;
+    }
+
+    std::vector<uint32_t> dirtyLights( m_DirtyLights );
+    std::sort( dirtyLights.begin(), dirtyLights.end() );
+
+    for ( uint32_t index : dirtyLights )
+    {
+        if ( !ranges.empty() && index - ( ranges.back().Offset + ranges.back().Count ) <= mergeDistance )
+        {
+            ranges.back().Count = index + 1 - ranges.back().Offset;
+        }
+        else
+        {
+            DirtyRange range = { index, 1 };
+            ranges.push_back( range );
+        }
+    }
+}
+
+uint32_t LightManager::get_NumDirtyLights() const
+{
+    return m_AllDirty ? get_NumLights() : static_cast<uint32_t>( m_DirtyLights.size() );
+}
+
+void LightManager::WriteLights( uint32_t offset, uint32_t count, Light* destination ) const
+{
+    assert( offset + count <= get_NumLights() );
+
+    for ( uint32_t i = offset; i < offset + count; ++i, ++destination )
+    {
+        destination->Position = m_Positions[i];
+        destination->Direction = m_Directions[i];
+        destination->Color = m_Colors[i];
+        destination->SpotAngle = m_SpotAngles[i];
+        destination->ConstantAttenuation = m_ConstantAttenuations[i];
+        destination->LinearAttenuation = m_LinearAttenuations[i];
+        destination->QuadraticAttenuation = m_QuadraticAttenuations[i];
+        destination->LightType = m_LightTypes[i];
+        destination->Enabled = m_Enabled[i];
+        destination->Range = m_Ranges[i];
+        destination->ShadowIndex = m_ShadowIndices[i];
+    }
+}
+
+void LightManager::ClearDirty()
+{
+    for ( uint32_t index : m_DirtyLights )
+    {
+        m_DirtyFlags[index] = 0;
+    }
+    m_DirtyLights.clear();
+    m_AllDirty = false;
+}
+
+void LightManager::MarkAllDirty()
+{
+    m_AllDirty = true;
+}
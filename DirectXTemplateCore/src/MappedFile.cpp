@@ -0,0 +1,139 @@
+#include <DirectXTemplateCorePCH.h>
+#include <MappedFile.h>
+
+// Memory mapping is not part of the standard library so this file has a
+// platform-specific implementation (like Clock.cpp).
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : m_Data( nullptr )
+    , m_Size( 0 )
+    , m_MappingHandle( nullptr )
+{}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open( const std::string& fileName )
+{
+    Close();
+
+    HANDLE file = CreateFileA( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+    if ( file == INVALID_HANDLE_VALUE )
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if ( GetFileSizeEx( file, &fileSize ) && fileSize.QuadPart > 0 )
+    {
+        mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    }
+    // The mapping keeps the file open.
+    CloseHandle( file );
+
+    if ( !mapping )
+    {
+        return false;
+    }
+
+    void* data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+    if ( !data )
+    {
+        CloseHandle( mapping );
+        return false;
+    }
+
+    m_Data = static_cast<const uint8_t*>( data );
+    m_Size = static_cast<size_t>( fileSize.QuadPart );
+    m_MappingHandle = mapping;
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if ( m_Data )
+    {
+        UnmapViewOfFile( m_Data );
+        CloseHandle( m_MappingHandle );
+    }
+
+    m_Data = nullptr;
+    m_Size = 0;
+    m_MappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::Open( const std::string& fileName )
+{
+    Close();
+
+    int file = open( fileName.c_str(), O_RDONLY );
+    if ( file < 0 )
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    void* data = MAP_FAILED;
+    if ( fstat( file, &fileStat ) == 0 && fileStat.st_size > 0 )
+    {
+        data = mmap( nullptr, static_cast<size_t>( fileStat.st_size ), PROT_READ, MAP_PRIVATE, file, 0 );
+    }
+    // The mapping keeps the file open.
+    close( file );
+
+    if ( data == MAP_FAILED )
+    {
+        return false;
+    }
+
+    m_Data = static_cast<const uint8_t*>( data );
+    m_Size = static_cast<size_t>( fileStat.st_size );
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if ( m_Data )
+    {
+        munmap( const_cast<uint8_t*>( m_Data ), m_Size );
+    }
+
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+#endif
+
+bool MappedFile::get_IsOpen() const
+{
+    return m_Data != nullptr;
+}
+
+const uint8_t* MappedFile::get_Data() const
+{
+    return m_Data;
+}
+
+size_t MappedFile::get_Size() const
+{
+    return m_Size;
+}
@@ -0,0 +1,296 @@
+#include <DirectXTemplateCorePCH.h>
+#include <MeshCache.h>
+
+#include <VertexFormats.h>
+
+#include <cstdio>
+#include <fstream>
+
+static_assert( std::is_trivially_copyable<MeshFileHeader>::value, "MeshFileHeader is read and written as raw bytes." );
+static_assert( sizeof( SubMesh ) == 16, "The submesh table is read in place." );
+static_assert( sizeof( MeshLod ) == 12, "The LOD table is read in place." );
+static_assert( sizeof( Meshlet ) == 44, "The meshlet table is read in place." );
+
+namespace
+{
+    uint64_t AlignOffset( uint64_t offset )
+    {
+        const uint64_t alignment = MeshFileHeader::SectionAlignment;
+        return ( offset + alignment - 1 ) & ~( alignment - 1 );
+    }
+
+    // Returns true if a section of count elements of elementSize bytes fits in the file.
+    bool IsValidSection( uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize )
+    {
+        return offset % MeshFileHeader::SectionAlignment == 0 && offset <= fileSize &&
+               count <= ( fileSize - offset ) / elementSize;
+    }
+
+    // Returns true if a range of count indices starting at start is inside the index buffer.
+    bool IsValidRange( const MeshFileHeader& header, uint32_t start, uint32_t count )
+    {
+        return start <= header.IndexCount && count <= header.IndexCount - start;
+    }
+
+    bool IsValidMesh( const MeshFileHeader& header, const SubMesh* subMeshes, const MeshLod* lods, const Meshlet* meshlets )
+    {
+        if ( header.VertexLayout >= MeshVertexLayoutCount ||
+             header.VertexStride != GetVertexStride( static_cast<MeshVertexLayout>( header.VertexLayout ) ) ||
+             ( header.IndexSize != sizeof( uint16_t ) && header.IndexSize != sizeof( uint32_t ) ) )
+        {
+            return false;
+        }
+
+        for ( uint32_t i = 0; i < header.SubMeshCount; ++i )
+        {
+            const SubMesh& subMesh = subMeshes[i];
+            if ( !IsValidRange( header, subMesh.StartIndex, subMesh.IndexCount ) ||
+                 subMesh.BaseVertex < 0 || static_cast<uint64_t>( subMesh.BaseVertex ) + subMesh.VertexCount > header.VertexCount )
+            {
+                return false;
+            }
+        }
+
+        // The LODs and the meshlets index the whole vertex buffer.
+        for ( uint32_t i = 0; i < header.LodCount; ++i )
+        {
+            if ( !IsValidRange( header, lods[i].StartIndex, lods[i].IndexCount ) )
+            {
+                return false;
+            }
+        }
+        for ( uint32_t i = 0; i < header.MeshletCount; ++i )
+        {
+            if ( !IsValidRange( header, meshlets[i].StartIndex, meshlets[i].IndexCount ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void WritePadding( std::ofstream& file, uint64_t offset )
+    {
+        const char zeros[MeshFileHeader::SectionAlignment] = {};
+        file.write( zeros, static_cast<std::streamsize>( AlignOffset( offset ) - offset ) );
+    }
+}
+
+uint32_t GetVertexStride( MeshVertexLayout layout )
+{
+    switch ( layout )
+    {
+    case MeshVertexLayoutHalfPrecision:
+        return sizeof( VertexPositionNormalTextureHalf );
+    case MeshVertexLayoutQuantized:
+        return sizeof( VertexPositionNormalTextureQuantized );
+    default:
+        return sizeof( VertexPositionNormalTexture );
+    }
+}
+
+bool WriteMeshFile( const std::string& fileName, const MeshData& mesh )
+{
+    // Clear the padding of the header as well, the whole header is written.
+    MeshFileHeader header;
+    memset( &header, 0, sizeof( header ) );
+    header.Magic = MeshFileHeader::FileMagic;
+    header.Version = MeshFileHeader::FileVersion;
+    header.VertexLayout = mesh.VertexLayout;
+    header.VertexStride = mesh.VertexStride;
+    header.VertexCount = mesh.VertexCount;
+    header.IndexSize = mesh.IndexSize;
+    header.IndexCount = mesh.IndexCount;
+    header.SubMeshCount = mesh.SubMeshCount;
+    header.LodCount = mesh.LodCount;
+    header.MeshletCount = mesh.MeshletCount;
+    header.Box = mesh.Box;
+    header.Sphere = mesh.Sphere;
+
+    uint64_t verticesSize = static_cast<uint64_t>( mesh.VertexCount ) * mesh.VertexStride;
+    uint64_t indicesSize = static_cast<uint64_t>( mesh.IndexCount ) * mesh.IndexSize;
+    uint64_t subMeshesSize = static_cast<uint64_t>( mesh.SubMeshCount ) * sizeof( SubMesh );
+    uint64_t lodsSize = static_cast<uint64_t>( mesh.LodCount ) * sizeof( MeshLod );
+    uint64_t meshletsSize = static_cast<uint64_t>( mesh.MeshletCount ) * sizeof( Meshlet );
+
+    header.VerticesOffset = AlignOffset( sizeof( MeshFileHeader ) );
+    header.IndicesOffset = AlignOffset( header.VerticesOffset + verticesSize );
+    header.SubMeshesOffset = AlignOffset( header.IndicesOffset + indicesSize );
+    header.LodsOffset = AlignOffset( header.SubMeshesOffset + subMeshesSize );
+    header.MeshletsOffset = AlignOffset( header.LodsOffset + lodsSize );
+    header.FileSize = header.MeshletsOffset + meshletsSize;
+
+    if ( !IsValidMesh( header, mesh.SubMeshes, mesh.Lods, mesh.Meshlets ) )
+    {
+        return false;
+    }
+
+    std::string temporaryFileName = fileName + ".tmp";
+    {
+        std::ofstream file( temporaryFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+        if ( !file )
+        {
+            return false;
+        }
+
+        file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+        WritePadding( file, sizeof( header ) );
+        file.write( static_cast<const char*>( mesh.Vertices ), static_cast<std::streamsize>( verticesSize ) );
+        WritePadding( file, header.VerticesOffset + verticesSize );
+        file.write( static_cast<const char*>( mesh.Indices ), static_cast<std::streamsize>( indicesSize ) );
+        WritePadding( file, header.IndicesOffset + indicesSize );
+        file.write( reinterpret_cast<const char*>( mesh.SubMeshes ), static_cast<std::streamsize>( subMeshesSize ) );
+        WritePadding( file, header.SubMeshesOffset + subMeshesSize );
+        file.write( reinterpret_cast<const char*>( mesh.Lods ), static_cast<std::streamsize>( lodsSize ) );
+        WritePadding( file, header.LodsOffset + lodsSize );
+        file.write( reinterpret_cast<const char*>( mesh.Meshlets ), static_cast<std::streamsize>( meshletsSize ) );
+
+        file.close();
+        if ( !file )
+        {
+            std::remove( temporaryFileName.c_str() );
+            return false;
+        }
+    }
+
+#if defined(_WIN32)
+    // rename does not replace an existing file on Windows.
+    std::remove( fileName.c_str() );
+#endif
+    if ( std::rename( temporaryFileName.c_str(), fileName.c_str() ) != 0 )
+    {
+        std::remove( temporaryFileName.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+MeshFile::MeshFile()
+    : m_MeshData()
+{}
+
+bool MeshFile::Open( const std::string& fileName )
+{
+    Close();
+
+    if ( !m_File.Open( fileName ) )
+    {
+        return false;
+    }
+
+    const uint8_t* data = m_File.get_Data();
+    uint64_t fileSize = m_File.get_Size();
+
+    MeshFileHeader header;
+    if ( fileSize < sizeof( header ) )
+    {
+        Close();
+        return false;
+    }
+    memcpy( &header, data, sizeof( header ) );
+
+    if ( header.Magic != MeshFileHeader::FileMagic || header.Version != MeshFileHeader::FileVersion || header.FileSize != fileSize ||
+         header.VertexStride == 0 ||
+         !IsValidSection( header.VerticesOffset, header.VertexCount, header.VertexStride, fileSize ) ||
+         !IsValidSection( header.IndicesOffset, header.IndexCount, std::max( header.IndexSize, 1u ), fileSize ) ||
+         !IsValidSection( header.SubMeshesOffset, header.SubMeshCount, sizeof( SubMesh ), fileSize ) ||
+         !IsValidSection( header.LodsOffset, header.LodCount, sizeof( MeshLod ), fileSize ) ||
+         !IsValidSection( header.MeshletsOffset, header.MeshletCount, sizeof( Meshlet ), fileSize ) ||
+         !IsValidMesh( header, reinterpret_cast<const SubMesh*>( data + header.SubMeshesOffset ),
+                       reinterpret_cast<const MeshLod*>( data + header.LodsOffset ),
+                       reinterpret_cast<const Meshlet*>( data + header.MeshletsOffset ) ) )
+    {
+        Close();
+        return false;
+    }
+
+    m_MeshData.VertexLayout = static_cast<MeshVertexLayout>( header.VertexLayout );
+    m_MeshData.VertexStride = header.VertexStride;
+    m_MeshData.VertexCount = header.VertexCount;
+    m_MeshData.Vertices = data + header.VerticesOffset;
+    m_MeshData.IndexSize = header.IndexSize;
+    m_MeshData.IndexCount = header.IndexCount;
+    m_MeshData.Indices = data + header.IndicesOffset;
+    m_MeshData.SubMeshCount = header.SubMeshCount;
+    m_MeshData.SubMeshes = reinterpret_cast<const SubMesh*>( data + header.SubMeshesOffset );
+    m_MeshData.LodCount = header.LodCount;
+    m_MeshData.Lods = reinterpret_cast<const MeshLod*>( data + header.LodsOffset );
+    m_MeshData.MeshletCount = header.MeshletCount;
+    m_MeshData.Meshlets = reinterpret_cast<const Meshlet*>( data + header.MeshletsOffset );
+    m_MeshData.Box = header.Box;
+    m_MeshData.Sphere = header.Sphere;
+
+    return true;
+}
+
+void MeshFile::Close()
+{
+    m_File.Close();
+    m_MeshData = MeshData();
+}
+
+bool MeshFile::get_IsOpen() const
+{
+    return m_File.get_IsOpen();
+}
+
+const MeshData& MeshFile::get_MeshData() const
+{
+    return m_MeshData;
+}
+
+MeshCacheKey::MeshCacheKey( const std::string& generator )
+    : m_Generator( generator )
+    , m_Hash( 14695981039346656037ull )
+{
+    Hash( generator.data(), generator.size() );
+
+    // Files written with another version of the format get another name.
+    uint32_t version = MeshFileHeader::FileVersion;
+    Hash( &version, sizeof( version ) );
+}
+
+void MeshCacheKey::Hash( const void* data, size_t size )
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>( data );
+    for ( size_t i = 0; i < size; ++i )
+    {
+        m_Hash = ( m_Hash ^ bytes[i] ) * 1099511628211ull;
+    }
+}
+
+uint64_t MeshCacheKey::get_Hash() const
+{
+    return m_Hash;
+}
+
+std::string MeshCacheKey::get_FileName() const
+{
+    char hash[17];
+    snprintf( hash, sizeof( hash ), "%016llx", static_cast<unsigned long long>( m_Hash ) );
+    return m_Generator + "-" + hash + ".mesh";
+}
+
+MeshCache::MeshCache( const std::string& directory )
+    : m_Directory( directory )
+{}
+
+bool MeshCache::Load( const MeshCacheKey& key, MeshFile& file ) const
+{
+    return file.Open( get_FileName( key ) );
+}
+
+bool MeshCache::Store( const MeshCacheKey& key, const MeshData& mesh ) const
+{
+    return WriteMeshFile( get_FileName( key ), mesh );
+}
+
+std::string MeshCache::get_FileName( const MeshCacheKey& key ) const
+{
+    if ( m_Directory.empty() )
+    {
+        return key.get_FileName();
+    }
+    return m_Directory + "/" + key.get_FileName();
+}
@@ -0,0 +1,475 @@
+#include <DirectXTemplateCorePCH.h>
+#include <MeshOptimizer.h>
+
+using namespace Math;
+
+namespace
+{
+    // The parameters of the vertex scores from Tom Forsyth's "Linear-Speed Vertex
+    // Cache Optimisation".
+    const int MaxCacheSize = 32;
+    const float CacheDecayPower = 1.5f;
+    const float LastTriangleScore = 0.75f;
+    const float ValenceBoostScale = 2.0f;
+    const float ValenceBoostPower = 0.5f;
+    const uint32_t MaxValence = 64;
+
+    // The vertex scores are precomputed for each cache position and valence.
+    struct VertexScoreTable
+    {
+        float Cache[MaxCacheSize];
+        float Valence[MaxValence];
+
+        VertexScoreTable()
+        {
+            for ( int i = 0; i < MaxCacheSize; ++i )
+            {
+                if ( i < 3 )
+                {
+                    // The vertices of the last triangle get a fixed score so that the
+                    // next triangle does not simply reuse the same edge (no strips).
+                    Cache[i] = LastTriangleScore;
+                }
+                else
+                {
+                    Cache[i] = std::pow( 1.0f - ( i - 3 ) / static_cast<float>( MaxCacheSize - 3 ), CacheDecayPower );
+                }
+            }
+
+            Valence[0] = 0.0f;
+            for ( uint32_t i = 1; i < MaxValence; ++i )
+            {
+                Valence[i] = ValenceBoostScale * std::pow( static_cast<float>( i ), -ValenceBoostPower );
+            }
+        }
+    };
+
+    /**
+     * The score of a vertex: vertices that were used recently are likely to still be
+     * in the cache, and vertices with few remaining triangles are preferred so that
+     * no lone triangles are left behind.
+     * @param cachePosition The position of the vertex in the cache or -1.
+     */
+    float VertexScore( const VertexScoreTable& table, int cachePosition, uint32_t remainingTriangles )
+    {
+        if ( remainingTriangles == 0 )
+        {
+            return -1.0f;
+        }
+
+        float score = ( cachePosition >= 0 ) ? table.Cache[cachePosition] : 0.0f;
+        score += ( remainingTriangles < MaxValence ) ? table.Valence[remainingTriangles]
+                                                     : ValenceBoostScale * std::pow( static_cast<float>( remainingTriangles ), -ValenceBoostPower );
+        return score;
+    }
+
+    // A FIFO cache simulation that uses a timestamp per vertex (resetting the cache is free).
+    class FifoCache
+    {
+    public:
+        FifoCache( size_t vertexCount, size_t cacheSize )
+            : m_Timestamps( vertexCount, 0 )
+            , m_Timestamp( static_cast<uint32_t>( cacheSize ) + 1 )
+            , m_CacheSize( static_cast<uint32_t>( cacheSize ) )
+        {}
+
+        // Returns true if the vertex was not in the cache.
+        bool Access( uint32_t vertex )
+        {
+            if ( m_Timestamp - m_Timestamps[vertex] > m_CacheSize )
+            {
+                m_Timestamps[vertex] = m_Timestamp++;
+                return true;
+            }
+            return false;
+        }
+
+        // The number of vertices of a triangle that were not in the cache.
+        uint32_t AccessTriangle( const IndexCollection& indices, size_t triangle )
+        {
+            uint32_t misses = Access( indices[triangle * 3] );
+            misses += Access( indices[triangle * 3 + 1] );
+            misses += Access( indices[triangle * 3 + 2] );
+            return misses;
+        }
+
+        void Reset()
+        {
+            m_Timestamp += m_CacheSize + 1;
+        }
+
+    private:
+        std::vector<uint32_t> m_Timestamps;
+        uint32_t m_Timestamp;
+        uint32_t m_CacheSize;
+    };
+
+    // The cache size used to find the clusters for the overdraw optimization.
+    const size_t OverdrawCacheSize = 16;
+
+    struct Cluster
+    {
+        uint32_t StartTriangle;
+        uint32_t NumTriangles;
+        float SortKey;
+    };
+}
+
+VertexCache::Statistics AnalyzeVertexCache( const IndexCollection& indices, size_t vertexCount, size_t cacheSize, VertexCache::Type cacheType )
+{
+    assert( cacheSize > 0 );
+
+    VertexCache::Statistics statistics = {};
+    statistics.Triangles = indices.size() / 3;
+
+    std::vector<uint8_t> referenced( vertexCount, 0 );
+
+    if ( cacheType == VertexCache::FIFO )
+    {
+        FifoCache cache( vertexCount, cacheSize );
+        for ( size_t i = 0; i < indices.size(); ++i )
+        {
+            uint32_t vertex = indices[i];
+            assert( vertex < vertexCount );
+
+            statistics.VerticesTransformed += cache.Access( vertex );
+            statistics.Vertices += 1 - referenced[vertex];
+            referenced[vertex] = 1;
+        }
+    }
+    else
+    {
+        // The most recently used vertex is at the front of the cache.
+        std::vector<uint32_t> cache;
+        cache.reserve( cacheSize + 1 );
+        for ( size_t i = 0; i < indices.size(); ++i )
+        {
+            uint32_t vertex = indices[i];
+            assert( vertex < vertexCount );
+
+            auto it = std::find( cache.begin(), cache.end(), vertex );
+            if ( it != cache.end() )
+            {
+                cache.erase( it );
+            }
+            else
+            {
+                ++statistics.VerticesTransformed;
+                if ( cache.size() == cacheSize )
+                {
+                    cache.pop_back();
+                }
+            }
+            cache.insert( cache.begin(), vertex );
+
+            statistics.Vertices += 1 - referenced[vertex];
+            referenced[vertex] = 1;
+        }
+    }
+
+    statistics.ACMR = statistics.Triangles ? statistics.VerticesTransformed / static_cast<float>( statistics.Triangles ) : 0.0f;
+    statistics.ATVR = statistics.Vertices ? statistics.VerticesTransformed / static_cast<float>( statistics.Vertices ) : 0.0f;
+
+    return statistics;
+}
+
+void OptimizeVertexCache( IndexCollection& indices, size_t vertexCount )
+{
+    assert( ( indices.size() % 3 ) == 0 );
+
+    size_t numTriangles = indices.size() / 3;
+    if ( numTriangles == 0 ) return;
+
+    static const VertexScoreTable scoreTable;
+
+    // The triangles that use each vertex. The first RemainingTriangles[v] entries of
+    // the list of a vertex are the triangles that have not been emitted yet.
+    std::vector<uint32_t> remainingTriangles( vertexCount, 0 );
+    for ( size_t i = 0; i < indices.size(); ++i )
+    {
+        assert( indices[i] < vertexCount );
+        ++remainingTriangles[indices[i]];
+    }
+
+    std::vector<uint32_t> adjacencyOffsets( vertexCount );
+    uint32_t offset = 0;
+    for ( size_t v = 0; v < vertexCount; ++v )
+    {
+        adjacencyOffsets[v] = offset;
+        offset += remainingTriangles[v];
+    }
+
+    std::vector<uint32_t> adjacency( indices.size() );
+    std::vector<uint32_t> adjacencyCount( vertexCount, 0 );
+    for ( size_t i = 0; i < indices.size(); ++i )
+    {
+        uint32_t vertex = indices[i];
+        adjacency[adjacencyOffsets[vertex] + adjacencyCount[vertex]++] = static_cast<uint32_t>( i / 3 );
+    }
+
+    std::vector<float> vertexScores( vertexCount );
+    for ( size_t v = 0; v < vertexCount; ++v )
+    {
+        vertexScores[v] = VertexScore( scoreTable, -1, remainingTriangles[v] );
+    }
+
+    std::vector<float> triangleScores( numTriangles );
+    std::vector<uint8_t> emitted( numTriangles, 0 );
+    size_t bestTriangle = 0;
+    for ( size_t t = 0; t < numTriangles; ++t )
+    {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+        if ( triangleScores[t] > triangleScores[bestTriangle] )
+        {
+            bestTriangle = t;
+        }
+    }
+
+    uint32_t cache[MaxCacheSize + 3];
+    size_t cacheCount = 0;
+
+    IndexCollection result;
+    result.reserve( indices.size() );
+
+    const size_t NoTriangle = SIZE_MAX;
+    size_t nextUnemitted = 0;
+
+    for ( size_t numEmitted = 0; numEmitted < numTriangles; ++numEmitted )
+    {
+        if ( bestTriangle == NoTriangle )
+        {
+            // None of the vertices in the cache have triangles left. Continue with the
+            // next triangle in the original order instead of searching all triangles.
+            while ( emitted[nextUnemitted] ) ++nextUnemitted;
+            bestTriangle = nextUnemitted;
+        }
+
+        uint32_t triangle[3] = { indices[bestTriangle * 3], indices[bestTriangle * 3 + 1], indices[bestTriangle * 3 + 2] };
+        result.push_back( triangle[0] );
+        result.push_back( triangle[1] );
+        result.push_back( triangle[2] );
+        emitted[bestTriangle] = 1;
+
+        // Move the triangle out of the remaining triangles of its vertices.
+        for ( int i = 0; i < 3; ++i )
+        {
+            uint32_t vertex = triangle[i];
+            uint32_t* triangles = &adjacency[adjacencyOffsets[vertex]];
+            uint32_t count = remainingTriangles[vertex];
+            for ( uint32_t j = 0; j < count; ++j )
+            {
+                if ( triangles[j] == bestTriangle )
+                {
+                    std::swap( triangles[j], triangles[count - 1] );
+                    --remainingTriangles[vertex];
+                    break;
+                }
+            }
+        }
+
+        // The vertices of the triangle move to the front of the cache.
+        uint32_t newCache[MaxCacheSize + 3];
+        size_t newCacheCount = 0;
+        for ( int i = 0; i < 3; ++i )
+        {
+            if ( std::find( newCache, newCache + newCacheCount, triangle[i] ) == newCache + newCacheCount )
+            {
+                newCache[newCacheCount++] = triangle[i];
+            }
+        }
+        for ( size_t i = 0; i < cacheCount; ++i )
+        {
+            uint32_t vertex = cache[i];
+            if ( vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2] )
+            {
+                newCache[newCacheCount++] = vertex;
+            }
+        }
+
+        // Update the scores of the vertices in the cache (including the vertices that
+        // were pushed out) and of their triangles.
+        bestTriangle = NoTriangle;
+        float bestScore = -1.0f;
+        for ( size_t i = 0; i < newCacheCount; ++i )
+        {
+            uint32_t vertex = newCache[i];
+            int cachePosition = ( i < MaxCacheSize ) ? static_cast<int>( i ) : -1;
+
+            float score = VertexScore( scoreTable, cachePosition, remainingTriangles[vertex] );
+            float scoreDelta = score - vertexScores[vertex];
+            vertexScores[vertex] = score;
+
+            const uint32_t* triangles = &adjacency[adjacencyOffsets[vertex]];
+            for ( uint32_t j = 0; j < remainingTriangles[vertex]; ++j )
+            {
+                uint32_t t = triangles[j];
+                triangleScores[t] += scoreDelta;
+                if ( triangleScores[t] > bestScore )
+                {
+                    bestScore = triangleScores[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        cacheCount = std::min( newCacheCount, static_cast<size_t>( MaxCacheSize ) );
+        std::copy( newCache, newCache + cacheCount, cache );
+    }
+
+    indices = std::move( result );
+}
+
+void OptimizeOverdraw( IndexCollection& indices, const VertexCollection& vertices, float threshold )
+{
+    assert( ( indices.size() % 3 ) == 0 );
+
+    size_t numTriangles = indices.size() / 3;
+    if ( numTriangles == 0 ) return;
+
+    FifoCache cache( vertices.size(), OverdrawCacheSize );
+
+    // Hard boundaries: the triangles where the vertex cache optimizer jumped to a
+    // new part of the mesh (none of the vertices are in the cache).
+    std::vector<uint32_t> hardBoundaries;
+    for ( size_t t = 0; t < numTriangles; ++t )
+    {
+        if ( cache.AccessTriangle( indices, t ) == 3 )
+        {
+            hardBoundaries.push_back( static_cast<uint32_t>( t ) );
+        }
+    }
+    hardBoundaries.push_back( static_cast<uint32_t>( numTriangles ) );
+
+    // Soft boundaries: split each cluster as soon as the ACMR of the part that was
+    // split off is within the threshold of the ACMR of the whole cluster. Each
+    // cluster starts with an empty cache because the clusters will be reordered.
+    std::vector<Cluster> clusters;
+    for ( size_t c = 0; c + 1 < hardBoundaries.size(); ++c )
+    {
+        uint32_t start = hardBoundaries[c];
+        uint32_t end = hardBoundaries[c + 1];
+
+        cache.Reset();
+        uint32_t clusterMisses = 0;
+        for ( uint32_t t = start; t < end; ++t )
+        {
+            clusterMisses += cache.AccessTriangle( indices, t );
+        }
+        float clusterThreshold = threshold * clusterMisses / ( end - start );
+
+        cache.Reset();
+        Cluster cluster = { start, 0, 0.0f };
+        uint32_t misses = 0;
+        for ( uint32_t t = start; t < end; ++t )
+        {
+            misses += cache.AccessTriangle( indices, t );
+            ++cluster.NumTriangles;
+
+            if ( t + 1 < end && misses <= clusterThreshold * cluster.NumTriangles )
+            {
+                clusters.push_back( cluster );
+                cluster.StartTriangle = t + 1;
+                cluster.NumTriangles = 0;
+                misses = 0;
+                cache.Reset();
+            }
+        }
+        clusters.push_back( cluster );
+    }
+
+    // Sort the clusters by how much they face away from the center of the mesh.
+    // The vertex normals are used instead of the face normals so that the result
+    // does not depend on the winding order.
+    std::vector<Float3> centroids( clusters.size() );
+    std::vector<Float3> normals( clusters.size() );
+    Float3 meshCentroid( 0, 0, 0 );
+    float meshArea = 0.0f;
+
+    for ( size_t c = 0; c < clusters.size(); ++c )
+    {
+        Float3 centroid( 0, 0, 0 );
+        Float3 normal( 0, 0, 0 );
+        float clusterArea = 0.0f;
+
+        for ( uint32_t t = clusters[c].StartTriangle; t < clusters[c].StartTriangle + clusters[c].NumTriangles; ++t )
+        {
+            const VertexPositionNormalTexture& v0 = vertices[indices[t * 3]];
+            const VertexPositionNormalTexture& v1 = vertices[indices[t * 3 + 1]];
+            const VertexPositionNormalTexture& v2 = vertices[indices[t * 3 + 2]];
+
+            float area = Length( Cross( v1.position - v0.position, v2.position - v0.position ) ) * 0.5f;
+            centroid += ( v0.position + v1.position + v2.position ) * ( area / 3.0f );
+            normal += ( v0.normal + v1.normal + v2.normal ) * area;
+            clusterArea += area;
+        }
+
+        meshCentroid += centroid;
+        meshArea += clusterArea;
+
+        centroids[c] = ( clusterArea > 0.0f ) ? centroid / clusterArea : centroid;
+        normals[c] = ( LengthSq( normal ) > 0.0f ) ? Normalize( normal ) : normal;
+    }
+
+    if ( meshArea > 0.0f )
+    {
+        meshCentroid = meshCentroid / meshArea;
+    }
+
+    for ( size_t c = 0; c < clusters.size(); ++c )
+    {
+        clusters[c].SortKey = Dot( centroids[c] - meshCentroid, normals[c] );
+    }
+
+    std::stable_sort( clusters.begin(), clusters.end(), []( const Cluster& a, const Cluster& b )
+    {
+        return a.SortKey > b.SortKey;
+    } );
+
+    IndexCollection result;
+    result.reserve( indices.size() );
+    for ( const Cluster& cluster : clusters )
+    {
+        for ( uint32_t i = cluster.StartTriangle * 3; i < ( cluster.StartTriangle + cluster.NumTriangles ) * 3; ++i )
+        {
+            result.push_back( indices[i] );
+        }
+    }
+
+    indices = std::move( result );
+}
+
+void OptimizeVertexFetch( VertexCollection& vertices, IndexCollection& indices )
+{
+    const uint32_t NotMapped = UINT32_MAX;
+
+    std::vector<uint32_t> remap( vertices.size(), NotMapped );
+
+    VertexCollection newVertices;
+    newVertices.reserve( vertices.size() );
+
+    IndexCollection newIndices;
+    newIndices.reserve( indices.size() );
+
+    for ( size_t i = 0; i < indices.size(); ++i )
+    {
+        uint32_t vertex = indices[i];
+        assert( vertex < vertices.size() );
+
+        if ( remap[vertex] == NotMapped )
+        {
+            remap[vertex] = static_cast<uint32_t>( newVertices.size() );
+            newVertices.push_back( vertices[vertex] );
+        }
+        newIndices.push_back( remap[vertex] );
+    }
+
+    vertices.swap( newVertices );
+    indices = std::move( newIndices );
+}
+
+void OptimizeMesh( VertexCollection& vertices, IndexCollection& indices )
+{
+    OptimizeVertexCache( indices, vertices.size() );
+    OptimizeOverdraw( indices, vertices );
+    OptimizeVertexFetch( vertices, indices );
+}
@@ -0,0 +1,405 @@
+#include <DirectXTemplateCorePCH.h>
+#include <MeshSimplifier.h>
+
+#include <MeshOptimizer.h>
+
+#include <cfloat>
+
+using namespace Math;
+
+namespace
+{
+    /**
+     * The sum of the squared distances of a point to a set of planes, weighted by
+     * the area of the triangles that the planes were taken from:
+     *   E(p) = p^T A p + 2 b^T p + c
+     * Double precision keeps the error of flat regions (where E is almost 0) stable.
+     */
+    struct Quadric
+    {
+        double a00, a11, a22, a01, a02, a12;
+        double b0, b1, b2;
+        double c;
+        // The total area of the planes.
+        double Weight;
+    };
+
+    Quadric PlaneQuadric( const Float3& normal, float distance, float weight )
+    {
+        Quadric q;
+        q.a00 = weight * normal.x * normal.x;
+        q.a11 = weight * normal.y * normal.y;
+        q.a22 = weight * normal.z * normal.z;
+        q.a01 = weight * normal.x * normal.y;
+        q.a02 = weight * normal.x * normal.z;
+        q.a12 = weight * normal.y * normal.z;
+        q.b0 = weight * normal.x * distance;
+        q.b1 = weight * normal.y * distance;
+        q.b2 = weight * normal.z * distance;
+        q.c = weight * static_cast<double>( distance ) * distance;
+        q.Weight = weight;
+        return q;
+    }
+
+    void AddQuadric( Quadric& q, const Quadric& other )
+    {
+        q.a00 += other.a00; q.a11 += other.a11; q.a22 += other.a22;
+        q.a01 += other.a01; q.a02 += other.a02; q.a12 += other.a12;
+        q.b0 += other.b0; q.b1 += other.b1; q.b2 += other.b2;
+        q.c += other.c;
+        q.Weight += other.Weight;
+    }
+
+    // The mean squared distance of a point to the planes of two quadrics.
+    double QuadricError( const Quadric& q0, const Quadric& q1, const Float3& p )
+    {
+        Quadric q = q0;
+        AddQuadric( q, q1 );
+        if ( q.Weight <= 0.0 ) return 0.0;
+
+        double x = p.x, y = p.y, z = p.z;
+        double e = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z +
+                   2.0 * ( q.a01 * x * y + q.a02 * x * z + q.a12 * y * z ) +
+                   2.0 * ( q.b0 * x + q.b1 * y + q.b2 * z ) + q.c;
+        return std::max( e, 0.0 ) / q.Weight;
+    }
+
+    struct Collapse
+    {
+        uint32_t From;
+        uint32_t To;
+        float Cost;
+
+        bool operator<( const Collapse& other ) const
+        {
+            return Cost < other.Cost;
+        }
+    };
+
+    /**
+     * Map every vertex to the first vertex with the same position. Vertices that share
+     * a position with another vertex lie on an attribute seam.
+     */
+    std::vector<uint32_t> WeldPositions( const VertexCollection& vertices )
+    {
+        std::vector<uint32_t> order( vertices.size() );
+        for ( size_t i = 0; i < order.size(); ++i ) order[i] = static_cast<uint32_t>( i );
+
+        auto less = [&vertices]( uint32_t a, uint32_t b )
+        {
+            const Float3& pa = vertices[a].position;
+            const Float3& pb = vertices[b].position;
+            if ( pa.x != pb.x ) return pa.x < pb.x;
+            if ( pa.y != pb.y ) return pa.y < pb.y;
+            if ( pa.z != pb.z ) return pa.z < pb.z;
+            return a < b;
+        };
+        std::sort( order.begin(), order.end(), less );
+
+        std::vector<uint32_t> weld( vertices.size() );
+        for ( size_t i = 0; i < order.size(); ++i )
+        {
+            const Float3& p = vertices[order[i]].position;
+            bool samePosition = i > 0 && vertices[order[i - 1]].position.x == p.x &&
+                                vertices[order[i - 1]].position.y == p.y && vertices[order[i - 1]].position.z == p.z;
+            weld[order[i]] = samePosition ? weld[order[i - 1]] : order[i];
+        }
+        return weld;
+    }
+
+    /**
+     * Lock the vertices that must not move: vertices on attribute seams and vertices
+     * on the border of the mesh (an edge without an opposite edge).
+     */
+    std::vector<bool> FindLockedVertices( const std::vector<uint32_t>& indices, const std::vector<uint32_t>& weld )
+    {
+        size_t vertexCount = weld.size();
+        std::vector<bool> locked( vertexCount, false );
+
+        std::vector<uint32_t> weldCount( vertexCount, 0 );
+        for ( size_t v = 0; v < vertexCount; ++v ) ++weldCount[weld[v]];
+
+        std::vector<uint64_t> edges;
+        edges.reserve( indices.size() );
+        for ( size_t i = 0; i < indices.size(); i += 3 )
+        {
+            for ( int e = 0; e < 3; ++e )
+            {
+                uint64_t a = weld[indices[i + e]];
+                uint64_t b = weld[indices[i + ( e + 1 ) % 3]];
+                edges.push_back( ( a << 32 ) | b );
+            }
+        }
+        std::sort( edges.begin(), edges.end() );
+
+        std::vector<bool> border( vertexCount, false );
+        for ( uint64_t edge : edges )
+        {
+            uint64_t opposite = ( edge << 32 ) | ( edge >> 32 );
+            if ( !std::binary_search( edges.begin(), edges.end(), opposite ) )
+            {
+                border[edge >> 32] = true;
+                border[edge & 0xFFFFFFFF] = true;
+            }
+        }
+
+        for ( size_t v = 0; v < vertexCount; ++v )
+        {
+            locked[v] = weldCount[weld[v]] > 1 || border[weld[v]];
+        }
+        return locked;
+    }
+
+    // Returns true if moving vertex from to the position of vertex to flips or
+    // collapses one of the remaining triangles around from.
+    bool FlipsTriangle( const std::vector<Float3>& positions, const std::vector<uint32_t>& indices,
+                        const uint32_t* triangles, uint32_t triangleCount, uint32_t from, uint32_t to )
+    {
+        for ( uint32_t t = 0; t < triangleCount; ++t )
+        {
+            const uint32_t* triangle = &indices[triangles[t] * 3];
+            if ( triangle[0] == to || triangle[1] == to || triangle[2] == to ) continue;
+
+            // Rotate the triangle so that from is the first vertex.
+            int k = ( triangle[0] == from ) ? 0 : ( triangle[1] == from ) ? 1 : 2;
+            const Float3& p1 = positions[triangle[( k + 1 ) % 3]];
+            const Float3& p2 = positions[triangle[( k + 2 ) % 3]];
+
+            Float3 oldNormal = Cross( p1 - positions[from], p2 - positions[from] );
+            Float3 newNormal = Cross( p1 - positions[to], p2 - positions[to] );
+            if ( Dot( oldNormal, newNormal ) <= 1e-2f * Length( oldNormal ) * Length( newNormal ) )
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+void SimplifyMesh( const VertexCollection& vertices, const IndexCollection& sourceIndices, IndexCollection& destination,
+                   size_t targetIndexCount, float targetError, float* resultError )
+{
+    assert( ( sourceIndices.size() % 3 ) == 0 );
+
+    std::vector<uint32_t> indices( sourceIndices.size() );
+    for ( size_t i = 0; i < indices.size(); ++i )
+    {
+        indices[i] = sourceIndices[i];
+        assert( indices[i] < vertices.size() );
+    }
+
+    size_t vertexCount = vertices.size();
+    float maxError = 0.0f;
+
+    if ( indices.size() > targetIndexCount && vertexCount > 0 )
+    {
+        // Compute the error in a unit box so the precision does not depend on the
+        // size of the mesh.
+        BoundingBox box = ComputeBoundingBox( vertices );
+        float extent = 2.0f * std::max( std::max( box.Extents.x, box.Extents.y ), std::max( box.Extents.z, FLT_MIN ) );
+        float scale = 1.0f / extent;
+
+        std::vector<Float3> positions( vertexCount );
+        for ( size_t v = 0; v < vertexCount; ++v )
+        {
+            positions[v] = ( vertices[v].position - box.Center ) * scale;
+        }
+
+        std::vector<uint32_t> weld = WeldPositions( vertices );
+        std::vector<bool> locked = FindLockedVertices( indices, weld );
+
+        std::vector<Quadric> quadrics( vertexCount, Quadric() );
+        for ( size_t i = 0; i < indices.size(); i += 3 )
+        {
+            const Float3& p0 = positions[indices[i + 0]];
+            Float3 normal = Cross( positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0 );
+            float area = Length( normal );
+            if ( area == 0.0f ) continue;
+
+            normal = normal / area;
+            Quadric q = PlaneQuadric( normal, -Dot( normal, p0 ), area * 0.5f );
+            for ( int k = 0; k < 3; ++k )
+            {
+                AddQuadric( quadrics[indices[i + k]], q );
+            }
+        }
+
+        double maxCost = static_cast<double>( targetError ) * scale;
+        maxCost = ( targetError == FLT_MAX ) ? DBL_MAX : maxCost * maxCost;
+        double resultCost = 0.0;
+
+        std::vector<uint32_t> triangleOffsets( vertexCount + 1 );
+        std::vector<uint32_t> vertexTriangles;
+        std::vector<Collapse> collapses;
+        std::vector<uint32_t> collapseTarget( vertexCount );
+        std::vector<bool> passLocked( vertexCount );
+
+        // Every pass collapses the cheapest edges whose neighborhoods do not overlap.
+        while ( indices.size() > targetIndexCount )
+        {
+            uint32_t triangleCount = static_cast<uint32_t>( indices.size() / 3 );
+
+            // The triangles around each vertex.
+            std::fill( triangleOffsets.begin(), triangleOffsets.end(), 0 );
+            for ( uint32_t index : indices ) ++triangleOffsets[index + 1];
+            for ( size_t v = 0; v < vertexCount; ++v ) triangleOffsets[v + 1] += triangleOffsets[v];
+
+            vertexTriangles.resize( indices.size() );
+            std::vector<uint32_t> fill( triangleOffsets.begin(), triangleOffsets.end() - 1 );
+            for ( size_t i = 0; i < indices.size(); ++i )
+            {
+                vertexTriangles[fill[indices[i]]++] = static_cast<uint32_t>( i / 3 );
+            }
+
+            // Each interior edge is shared by two triangles, once as (a, b) with a < b.
+            collapses.clear();
+            for ( size_t i = 0; i < indices.size(); i += 3 )
+            {
+                for ( int e = 0; e < 3; ++e )
+                {
+                    uint32_t a = indices[i + e];
+                    uint32_t b = indices[i + ( e + 1 ) % 3];
+                    if ( a >= b ) continue;
+
+                    if ( !locked[a] )
+                    {
+                        Collapse collapse = { a, b, static_cast<float>( QuadricError( quadrics[a], quadrics[b], positions[b] ) ) };
+                        collapses.push_back( collapse );
+                    }
+                    if ( !locked[b] )
+                    {
+                        Collapse collapse = { b, a, static_cast<float>( QuadricError( quadrics[a], quadrics[b], positions[a] ) ) };
+                        collapses.push_back( collapse );
+                    }
+                }
+            }
+            std::sort( collapses.begin(), collapses.end() );
+
+            for ( size_t v = 0; v < vertexCount; ++v ) collapseTarget[v] = static_cast<uint32_t>( v );
+            std::fill( passLocked.begin(), passLocked.end(), false );
+
+            size_t remainingIndices = indices.size();
+            size_t numCollapses = 0;
+
+            for ( const Collapse& collapse : collapses )
+            {
+                if ( collapse.Cost > maxCost || remainingIndices <= targetIndexCount ) break;
+
+                uint32_t from = collapse.From;
+                uint32_t to = collapse.To;
+                if ( passLocked[from] || passLocked[to] ) continue;
+
+                const uint32_t* triangles = &vertexTriangles[triangleOffsets[from]];
+                uint32_t numTriangles = triangleOffsets[from + 1] - triangleOffsets[from];
+                if ( FlipsTriangle( positions, indices, triangles, numTriangles, from, to ) ) continue;
+
+                // The triangles around from move, so their vertices cannot be collapsed
+                // again in this pass (the flip test would be out of date).
+                for ( uint32_t t = 0; t < numTriangles; ++t )
+                {
+                    const uint32_t* triangle = &indices[triangles[t] * 3];
+                    passLocked[triangle[0]] = passLocked[triangle[1]] = passLocked[triangle[2]] = true;
+                    if ( triangle[0] == to || triangle[1] == to || triangle[2] == to )
+                    {
+                        remainingIndices -= 3;
+                    }
+                }
+
+                collapseTarget[from] = to;
+                AddQuadric( quadrics[to], quadrics[from] );
+                resultCost = std::max( resultCost, static_cast<double>( collapse.Cost ) );
+                ++numCollapses;
+            }
+
+            if ( numCollapses == 0 ) break;
+
+            // Move the collapsed vertices and remove the degenerate triangles.
+            size_t writeIndex = 0;
+            for ( uint32_t t = 0; t < triangleCount; ++t )
+            {
+                uint32_t i0 = collapseTarget[indices[t * 3 + 0]];
+                uint32_t i1 = collapseTarget[indices[t * 3 + 1]];
+                uint32_t i2 = collapseTarget[indices[t * 3 + 2]];
+                if ( weld[i0] == weld[i1] || weld[i1] == weld[i2] || weld[i0] == weld[i2] ) continue;
+
+                indices[writeIndex++] = i0;
+                indices[writeIndex++] = i1;
+                indices[writeIndex++] = i2;
+            }
+            indices.resize( writeIndex );
+        }
+
+        maxError = static_cast<float>( std::sqrt( resultCost ) ) * extent;
+    }
+
+    destination.assign( indices.begin(), indices.end() );
+    if ( resultError )
+    {
+        *resultError = maxError;
+    }
+}
+
+void GenerateLods( const VertexCollection& vertices, IndexCollection& indices, MeshLodCollection& lods,
+                   size_t maxLods, float reduction )
+{
+    assert( reduction > 0.0f && reduction < 1.0f );
+
+    const IndexCollection original( indices );
+    MeshLod lod0 = { 0, static_cast<uint32_t>( indices.size() ), 0.0f };
+
+    lods.clear();
+    lods.push_back( lod0 );
+
+    size_t targetIndexCount = indices.size();
+    IndexCollection lodIndices;
+
+    while ( lods.size() < maxLods )
+    {
+        targetIndexCount = static_cast<size_t>( targetIndexCount / 3 * reduction ) * 3;
+
+        // Simplify from the original mesh so the error is measured against the
+        // original surface.
+        float error;
+        SimplifyMesh( vertices, original, lodIndices, targetIndexCount, FLT_MAX, &error );
+
+        // Stop when the locked vertices keep the mesh from getting much smaller.
+        const MeshLod& previous = lods.back();
+        if ( lodIndices.empty() || lodIndices.size() > previous.IndexCount * ( 1.0f + reduction ) * 0.5f )
+        {
+            break;
+        }
+
+        OptimizeVertexCache( lodIndices, vertices.size() );
+
+        // The errors of a chain never decrease so the selection can stop at the
+        // first LOD that is too coarse.
+        MeshLod lod = { static_cast<uint32_t>( indices.size() ), static_cast<uint32_t>( lodIndices.size() ), std::max( error, previous.Error ) };
+        for ( size_t i = 0; i < lodIndices.size(); ++i )
+        {
+            indices.push_back( lodIndices[i] );
+        }
+        lods.push_back( lod );
+    }
+}
+
+size_t SelectLod( const MeshLodCollection& lods, const Camera& camera, const BoundingSphere& worldSphere,
+                  float worldScale, float maxPixelError )
+{
+    // The distance to the closest point of the bounding sphere.
+    float distance = Length( worldSphere.Center - camera.get_Translation() ) - worldSphere.Radius;
+    if ( distance <= 0.0f )
+    {
+        return 0;
+    }
+
+    size_t lod = 0;
+    for ( size_t i = 1; i < lods.size(); ++i )
+    {
+        if ( camera.ProjectedSize( lods[i].Error * worldScale, distance ) > maxPixelError )
+        {
+            break;
+        }
+        lod = i;
+    }
+    return lod;
+}
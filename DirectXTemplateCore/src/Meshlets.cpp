@@ -0,0 +1,334 @@
+#include <DirectXTemplateCorePCH.h>
+#include <Meshlets.h>
+
+#include <Simd.h>
+
+#include <cfloat>
+
+using namespace Math;
+
+namespace
+{
+    // Meshlets with normals that are spread further than this are never back-face
+    // culled (the cone would only be culled from a narrow range of directions).
+    const float MinConeDot = 0.1f;
+
+    /**
+     * The unit normal of a triangle. The normal is oriented like the vertex normals
+     * so that it points out of the surface regardless of the winding order of the
+     * coordinate system.
+     */
+    Float3 TriangleNormal( const VertexCollection& vertices, const uint32_t* triangle )
+    {
+        const VertexPositionNormalTexture& v0 = vertices[triangle[0]];
+        const VertexPositionNormalTexture& v1 = vertices[triangle[1]];
+        const VertexPositionNormalTexture& v2 = vertices[triangle[2]];
+
+        Float3 normal = Cross( v1.position - v0.position, v2.position - v0.position );
+        float length = Length( normal );
+        if ( length == 0.0f )
+        {
+            return Float3( 0, 0, 0 );
+        }
+
+        if ( Dot( normal, v0.normal + v1.normal + v2.normal ) < 0.0f )
+        {
+            length = -length;
+        }
+        return normal / length;
+    }
+
+    // Compute the bounding sphere and the normal cone of a meshlet.
+    void ComputeMeshletBounds( const VertexCollection& vertices, const uint32_t* indices, const std::vector<Float3>& normals, Meshlet& meshlet )
+    {
+        const uint32_t* meshletIndices = indices + meshlet.StartIndex;
+
+        Float3 minimum = vertices[meshletIndices[0]].position;
+        Float3 maximum = minimum;
+        for ( uint32_t i = 1; i < meshlet.IndexCount; ++i )
+        {
+            minimum = Min( minimum, vertices[meshletIndices[i]].position );
+            maximum = Max( maximum, vertices[meshletIndices[i]].position );
+        }
+
+        Float3 center = ( minimum + maximum ) * 0.5f;
+        float radiusSq = 0.0f;
+        for ( uint32_t i = 0; i < meshlet.IndexCount; ++i )
+        {
+            radiusSq = std::max( radiusSq, LengthSq( vertices[meshletIndices[i]].position - center ) );
+        }
+        meshlet.Sphere = BoundingSphere( center, std::sqrt( radiusSq ) );
+
+        Float3 axis( 0, 0, 0 );
+        uint32_t firstTriangle = meshlet.StartIndex / 3;
+        uint32_t numTriangles = meshlet.IndexCount / 3;
+        for ( uint32_t t = 0; t < numTriangles; ++t )
+        {
+            axis += normals[firstTriangle + t];
+        }
+
+        meshlet.ConeAxis = Float3( 0, 0, 0 );
+        meshlet.ConeCutoff = 1.0f;
+
+        float axisLength = Length( axis );
+        if ( axisLength == 0.0f ) return;
+        axis = axis / axisLength;
+
+        float minDot = 1.0f;
+        for ( uint32_t t = 0; t < numTriangles; ++t )
+        {
+            const Float3& normal = normals[firstTriangle + t];
+            // Degenerate triangles cannot be seen and do not widen the cone.
+            if ( LengthSq( normal ) > 0.0f )
+            {
+                minDot = std::min( minDot, Dot( normal, axis ) );
+            }
+        }
+
+        meshlet.ConeAxis = axis;
+        if ( minDot > MinConeDot )
+        {
+            // The sine of the half-angle of the cone.
+            meshlet.ConeCutoff = std::sqrt( 1.0f - minDot * minDot );
+        }
+    }
+}
+
+void BuildMeshlets( const VertexCollection& vertices, IndexCollection& indices, MeshletCollection& meshlets,
+                    size_t maxVertices, size_t maxTriangles )
+{
+    assert( ( indices.size() % 3 ) == 0 );
+    assert( maxVertices >= 3 && maxTriangles >= 1 );
+
+    meshlets.clear();
+
+    size_t vertexCount = vertices.size();
+    uint32_t numTriangles = static_cast<uint32_t>( indices.size() / 3 );
+    if ( numTriangles == 0 ) return;
+
+    std::vector<uint32_t> sourceIndices( indices.size() );
+    for ( size_t i = 0; i < indices.size(); ++i )
+    {
+        sourceIndices[i] = indices[i];
+        assert( sourceIndices[i] < vertexCount );
+    }
+
+    std::vector<Float3> sourceNormals( numTriangles );
+    for ( uint32_t t = 0; t < numTriangles; ++t )
+    {
+        sourceNormals[t] = TriangleNormal( vertices, &sourceIndices[t * 3] );
+    }
+
+    // The triangles that use each vertex.
+    std::vector<uint32_t> triangleOffsets( vertexCount + 1, 0 );
+    for ( uint32_t index : sourceIndices ) ++triangleOffsets[index + 1];
+    for ( size_t v = 0; v < vertexCount; ++v ) triangleOffsets[v + 1] += triangleOffsets[v];
+
+    std::vector<uint32_t> vertexTriangles( sourceIndices.size() );
+    {
+        std::vector<uint32_t> fill( triangleOffsets.begin(), triangleOffsets.end() - 1 );
+        for ( size_t i = 0; i < sourceIndices.size(); ++i )
+        {
+            vertexTriangles[fill[sourceIndices[i]]++] = static_cast<uint32_t>( i / 3 );
+        }
+    }
+
+    std::vector<bool> emitted( numTriangles, false );
+    // The meshlet that last used each vertex (the current meshlet if the vertex is in it).
+    std::vector<uint32_t> vertexMeshlet( vertexCount, UINT32_MAX );
+
+    std::vector<uint32_t> meshletIndices;
+    meshletIndices.reserve( sourceIndices.size() );
+    std::vector<Float3> meshletNormals;
+    meshletNormals.reserve( numTriangles );
+
+    // The triangles that share a vertex with the current meshlet.
+    std::vector<uint32_t> candidates;
+    uint32_t nextSeed = 0;
+
+    while ( true )
+    {
+        while ( nextSeed < numTriangles && emitted[nextSeed] ) ++nextSeed;
+        if ( nextSeed == numTriangles ) break;
+
+        uint32_t meshletIndex = static_cast<uint32_t>( meshlets.size() );
+        Meshlet meshlet = {};
+        meshlet.StartIndex = static_cast<uint32_t>( meshletIndices.size() );
+
+        Float3 normalSum( 0, 0, 0 );
+        uint32_t triangle = nextSeed;
+        candidates.clear();
+
+        while ( true )
+        {
+            // Add the triangle to the meshlet.
+            const uint32_t* vertexIndices = &sourceIndices[triangle * 3];
+            for ( int k = 0; k < 3; ++k )
+            {
+                uint32_t vertex = vertexIndices[k];
+                meshletIndices.push_back( vertex );
+                if ( vertexMeshlet[vertex] != meshletIndex )
+                {
+                    vertexMeshlet[vertex] = meshletIndex;
+                    ++meshlet.VertexCount;
+
+                    for ( uint32_t i = triangleOffsets[vertex]; i < triangleOffsets[vertex + 1]; ++i )
+                    {
+                        if ( !emitted[vertexTriangles[i]] ) candidates.push_back( vertexTriangles[i] );
+                    }
+                }
+            }
+            meshletNormals.push_back( sourceNormals[triangle] );
+            normalSum += sourceNormals[triangle];
+            emitted[triangle] = true;
+            meshlet.IndexCount += 3;
+
+            if ( meshlet.IndexCount / 3 >= maxTriangles ) break;
+
+            // The next triangle adds the fewest vertices to the meshlet and faces in
+            // the direction of the meshlet.
+            Float3 axis = ( LengthSq( normalSum ) > 0.0f ) ? Normalize( normalSum ) : normalSum;
+            float bestScore = FLT_MAX;
+            uint32_t bestNewVertices = 0;
+            uint32_t best = UINT32_MAX;
+
+            size_t numCandidates = 0;
+            for ( uint32_t candidate : candidates )
+            {
+                if ( emitted[candidate] ) continue;
+                candidates[numCandidates++] = candidate;
+
+                const uint32_t* candidateIndices = &sourceIndices[candidate * 3];
+                uint32_t newVertices = ( vertexMeshlet[candidateIndices[0]] != meshletIndex ) +
+                                       ( vertexMeshlet[candidateIndices[1]] != meshletIndex ) +
+                                       ( vertexMeshlet[candidateIndices[2]] != meshletIndex );
+                float score = newVertices + ( 1.0f - Dot( sourceNormals[candidate], axis ) ) * 0.5f;
+                if ( score < bestScore )
+                {
+                    bestScore = score;
+                    bestNewVertices = newVertices;
+                    best = candidate;
+                }
+            }
+            candidates.resize( numCandidates );
+
+            if ( best == UINT32_MAX || meshlet.VertexCount + bestNewVertices > maxVertices ) break;
+            triangle = best;
+        }
+
+        meshlets.push_back( meshlet );
+    }
+
+    indices.assign( meshletIndices.begin(), meshletIndices.end() );
+    for ( Meshlet& meshlet : meshlets )
+    {
+        ComputeMeshletBounds( vertices, meshletIndices.data(), meshletNormals, meshlet );
+    }
+}
+
+bool IsBackFacing( const Meshlet& meshlet, const Float3& eye )
+{
+    // The cone is back-facing if the direction to every point of the bounding
+    // sphere is within 90 degrees minus the half-angle of the cone of the axis.
+    Float3 direction = meshlet.Sphere.Center - eye;
+    return Dot( direction, meshlet.ConeAxis ) >= meshlet.ConeCutoff * Length( direction ) + meshlet.Sphere.Radius;
+}
+
+size_t CullMeshlets( const MeshletBoundsArrays& bounds, const Frustum& frustum, const Float3& eye,
+                     std::vector<uint32_t>& visibleIndices )
+{
+    const int NumPlanes = Frustum::NumPlanes;
+    size_t count = bounds.Size();
+    visibleIndices.resize( count );
+
+    Simd::Float planeX[NumPlanes], planeY[NumPlanes], planeZ[NumPlanes], planeW[NumPlanes];
+    for ( int i = 0; i < NumPlanes; ++i )
+    {
+        const Float4& plane = frustum.get_Plane( static_cast<Frustum::PlaneIndex>( i ) );
+        planeX[i] = Simd::Set1( plane.x );
+        planeY[i] = Simd::Set1( plane.y );
+        planeZ[i] = Simd::Set1( plane.z );
+        planeW[i] = Simd::Set1( plane.w );
+    }
+
+    Simd::Float eyeX = Simd::Set1( eye.x );
+    Simd::Float eyeY = Simd::Set1( eye.y );
+    Simd::Float eyeZ = Simd::Set1( eye.z );
+
+    const BoundingSphereArrays& spheres = bounds.Spheres;
+
+    size_t numVisible = 0;
+    size_t i = 0;
+    for ( ; i + Simd::Width <= count; i += Simd::Width )
+    {
+        Simd::Float x = Simd::LoadUnaligned( spheres.CenterX.data() + i );
+        Simd::Float y = Simd::LoadUnaligned( spheres.CenterY.data() + i );
+        Simd::Float z = Simd::LoadUnaligned( spheres.CenterZ.data() + i );
+        Simd::Float radius = Simd::LoadUnaligned( spheres.Radius.data() + i );
+        Simd::Float negativeRadius = -radius;
+
+        Simd::Float inside = Simd::CmpGE( x * planeX[0] + y * planeY[0] + z * planeZ[0] + planeW[0], negativeRadius );
+        for ( int p = 1; p < NumPlanes; ++p )
+        {
+            Simd::Float distance = x * planeX[p] + y * planeY[p] + z * planeZ[p] + planeW[p];
+            inside = Simd::And( inside, Simd::CmpGE( distance, negativeRadius ) );
+        }
+
+        // See IsBackFacing.
+        Simd::Float dx = x - eyeX;
+        Simd::Float dy = y - eyeY;
+        Simd::Float dz = z - eyeZ;
+        Simd::Float distance = Simd::Sqrt( dx * dx + dy * dy + dz * dz );
+        Simd::Float coneDot = dx * Simd::LoadUnaligned( bounds.ConeAxisX.data() + i ) +
+                              dy * Simd::LoadUnaligned( bounds.ConeAxisY.data() + i ) +
+                              dz * Simd::LoadUnaligned( bounds.ConeAxisZ.data() + i );
+        Simd::Float backFacing = Simd::CmpGE( coneDot, Simd::LoadUnaligned( bounds.ConeCutoff.data() + i ) * distance + radius );
+
+        int mask = Simd::MoveMask( Simd::AndNot( backFacing, inside ) );
+        for ( int lane = 0; lane < Simd::Width; ++lane )
+        {
+            visibleIndices[numVisible] = static_cast<uint32_t>( i + lane );
+            numVisible += ( mask >> lane ) & 1;
+        }
+    }
+
+    // The remaining meshlets.
+    for ( ; i < count; ++i )
+    {
+        Meshlet meshlet = {};
+        meshlet.Sphere = spheres.Get( i );
+        meshlet.ConeAxis = Float3( bounds.ConeAxisX[i], bounds.ConeAxisY[i], bounds.ConeAxisZ[i] );
+        meshlet.ConeCutoff = bounds.ConeCutoff[i];
+
+        if ( frustum.Intersects( meshlet.Sphere ) && !IsBackFacing( meshlet, eye ) )
+        {
+            visibleIndices[numVisible++] = static_cast<uint32_t>( i );
+        }
+    }
+
+    visibleIndices.resize( numVisible );
+    return numVisible;
+}
+
+size_t GetIndexRanges( const MeshletCollection& meshlets, const std::vector<uint32_t>& visibleIndices, IndexRangeCollection& ranges )
+{
+    ranges.clear();
+
+    size_t indexCount = 0;
+    for ( uint32_t meshletIndex : visibleIndices )
+    {
+        const Meshlet& meshlet = meshlets[meshletIndex];
+        indexCount += meshlet.IndexCount;
+
+        if ( !ranges.empty() && ranges.back().StartIndex + ranges.back().IndexCount == meshlet.StartIndex )
+        {
+            ranges.back().IndexCount += meshlet.IndexCount;
+        }
+        else
+        {
+            IndexRange range = { meshlet.StartIndex, meshlet.IndexCount };
+            ranges.push_back( range );
+        }
+    }
+    return indexCount;
+}
@@ -0,0 +1,178 @@
+#include <DirectXTemplateCorePCH.h>
+#include <ParallelCommandRecorder.h>
+#include <Profiler.h>
+
+ParallelCommandRecorder::ParallelCommandRecorder( const std::vector<CommandRecorder*>& recorders, size_t minItemsPerCommandList )
+    : m_Recorders( recorders )
+    , m_MinItemsPerCommandList( std::max<size_t>( minItemsPerCommandList, 1 ) )
+    , m_Generation( 0 )
+    , m_RecordFunction( nullptr )
+    , m_NumItems( 0 )
+    , m_NumCommandLists( 0 )
+    , m_NumPending( 0 )
+    , m_Quit( false )
+{
+    if ( m_Recorders.empty() )
+    {
+        throw std::invalid_argument( "ParallelCommandRecorder requires at least one recorder." );
+    }
+
+    for ( size_t i = 1; i < m_Recorders.size(); ++i )
+    {
+        m_Threads.push_back( std::thread( &ParallelCommandRecorder::WorkerThread, this, i ) );
+    }
+}
+
+ParallelCommandRecorder::~ParallelCommandRecorder()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_Quit = true;
+    }
+    m_StartCondition.notify_all();
+
+    for ( std::thread& thread : m_Threads )
+    {
+        thread.join();
+    }
+}
+
+size_t ParallelCommandRecorder::get_NumRecorders() const
+{
+    return m_Recorders.size();
+}
+
+size_t ParallelCommandRecorder::get_MinItemsPerCommandList() const
+{
+    return m_MinItemsPerCommandList;
+}
+
+void ParallelCommandRecorder::set_MinItemsPerCommandList( size_t minItemsPerCommandList )
+{
+    m_MinItemsPerCommandList = std::max<size_t>( minItemsPerCommandList, 1 );
+}
+
+size_t ParallelCommandRecorder::GetNumCommandLists( size_t numItems, size_t numRecorders, size_t minItemsPerCommandList )
+{
+    if ( numItems == 0 ) return 0;
+
+    size_t numCommandLists = numItems / std::max<size_t>( minItemsPerCommandList, 1 );
+    return std::min( std::max<size_t>( numCommandLists, 1 ), numRecorders );
+}
+
+void ParallelCommandRecorder::GetRange( size_t numItems, size_t numCommandLists, size_t index, size_t& begin, size_t& end )
+{
+    assert( index < numCommandLists );
+
+    // The ranges differ in size by at most one item.
+    begin = numItems * index / numCommandLists;
+    end = numItems * ( index + 1 ) / numCommandLists;
+}
+
+size_t ParallelCommandRecorder::Record( size_t numItems, const RecordFunction& record )
+{
+    size_t numCommandLists = GetNumCommandLists( numItems, m_Recorders.size(), m_MinItemsPerCommandList );
+
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_RecordFunction = &record;
+        m_NumItems = numItems;
+        m_NumCommandLists = numCommandLists;
+        m_NumPending = ( numCommandLists > 1 ) ? numCommandLists - 1 : 0;
+        m_Exception = nullptr;
+        ++m_Generation;
+    }
+
+    if ( numCommandLists > 1 )
+    {
+        m_StartCondition.notify_all();
+    }
+
+    // The first range is recorded on this thread.
+    if ( numCommandLists > 0 )
+    {
+        RecordCommandList( 0 );
+    }
+
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    m_DoneCondition.wait( lock, [this]() { return m_NumPending == 0; } );
+    m_RecordFunction = nullptr;
+
+    if ( m_Exception )
+    {
+        // Don't execute partially recorded frames.
+        m_NumCommandLists = 0;
+
+        std::exception_ptr exception = m_Exception;
+        m_Exception = nullptr;
+        std::rethrow_exception( exception );
+    }
+
+    return numCommandLists;
+}
+
+void ParallelCommandRecorder::Execute()
+{
+    // Always in the order of the ranges, no matter which thread finished first.
+    for ( size_t i = 0; i < m_NumCommandLists; ++i )
+    {
+        m_Recorders[i]->ExecuteCommandList();
+    }
+    m_NumCommandLists = 0;
+}
+
+void ParallelCommandRecorder::WorkerThread( size_t index )
+{
+    uint64_t generation = 0;
+    Profiler::SetThreadName( "Recorder " + std::to_string( index ) );
+
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    for ( ;; )
+    {
+        m_StartCondition.wait( lock, [this, generation]() { return m_Quit || m_Generation != generation; } );
+        if ( m_Quit )
+        {
+            return;
+        }
+
+        generation = m_Generation;
+        if ( index >= m_NumCommandLists )
+        {
+            // Not enough items for this recorder.
+            continue;
+        }
+
+        lock.unlock();
+        RecordCommandList( index );
+        lock.lock();
+
+        if ( --m_NumPending == 0 )
+        {
+            m_DoneCondition.notify_one();
+        }
+    }
+}
+
+void ParallelCommandRecorder::RecordCommandList( size_t index )
+{
+    PROFILE_SCOPE( "RecordCommandList" );
+
+    size_t begin, end;
+    GetRange( m_NumItems, m_NumCommandLists, index, begin, end );
+
+    CommandRecorder& recorder = *m_Recorders[index];
+    try
+    {
+        recorder.BeginCommandList();
+        ( *m_RecordFunction )( recorder.get_RenderContext(), begin, end );
+        recorder.FinishCommandList();
+    }
+    catch ( ... )
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        if ( !m_Exception )
+        {
+            m_Exception = std::current_exception();
+        }
+    }
+}
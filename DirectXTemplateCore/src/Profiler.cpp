@@ -0,0 +1,590 @@
+#include <DirectXTemplateCorePCH.h>
+#include <Profiler.h>
+#include <Clock.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+
+std::atomic<bool> Profiler::ms_Enabled( true );
+
+namespace
+{
+    // The fields are atomic because Collect may read an event while the thread
+    // overwrites it. Such events are detected and dropped.
+    struct ProfileEvent
+    {
+        std::atomic<const char*> Name;
+        std::atomic<int64_t> Begin;
+        std::atomic<int64_t> End;
+    };
+
+    struct ThreadBuffer
+    {
+        ThreadBuffer()
+            : Events( new ProfileEvent[Profiler::ZonesPerThread] )
+            , WriteIndex( 0 )
+            , ReadIndex( 0 )
+            , Exited( false )
+        {}
+
+        std::unique_ptr<ProfileEvent[]> Events;
+        // The number of events that the thread has written.
+        std::atomic<uint64_t> WriteIndex;
+        // The number of events that were collected (only used by Collect).
+        uint64_t ReadIndex;
+        std::string Name;
+        // The buffer of a thread that exited is given to the next new thread (tracks never exit).
+        bool Exited;
+    };
+
+    struct Registry
+    {
+        Registry()
+            : StartTimestamp( Profiler::ReadTimestamp() )
+            , StartClockTicks( Clock::GetTicks() )
+            , NumDropped( 0 )
+        {}
+
+        // Protects the list of threads and their names.
+        std::mutex Mutex;
+        // The buffers are kept after their threads exit so their zones can still be collected.
+        std::vector< std::unique_ptr<ThreadBuffer> > Threads;
+
+        // The timestamps are converted to nanoseconds with the rate at which they
+        // advanced relative to the Clock since the profiler was started.
+        int64_t StartTimestamp;
+        int64_t StartClockTicks;
+
+        // The zones of exited threads that were discarded before they were collected.
+        uint64_t NumDropped;
+    };
+
+    Registry& GetRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    // Marks the buffer of the thread as exited when the thread exits. It is separate from
+    // t_ThreadBuffer so that recording a zone does not check whether it was constructed.
+    struct ThreadExit
+    {
+        ThreadExit()
+            : Buffer( nullptr )
+        {}
+
+        ~ThreadExit()
+        {
+            if ( Buffer )
+            {
+                std::lock_guard<std::mutex> lock( GetRegistry().Mutex );
+                Buffer->Exited = true;
+            }
+        }
+
+        ThreadBuffer* Buffer;
+    };
+
+    thread_local ThreadBuffer* t_ThreadBuffer = nullptr;
+    thread_local ThreadExit t_ThreadExit;
+
+    ThreadBuffer& GetThreadBuffer()
+    {
+        if ( !t_ThreadBuffer )
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock( registry.Mutex );
+
+            // Reuse the buffer of an exited thread (preferably one that was collected) so
+            // the memory does not grow with the number of threads that were ever started.
+            size_t index = registry.Threads.size();
+            for ( size_t i = 0; i < registry.Threads.size(); ++i )
+            {
+                ThreadBuffer& buffer = *registry.Threads[i];
+                if ( buffer.Exited && ( index == registry.Threads.size() ||
+                     buffer.ReadIndex == buffer.WriteIndex.load( std::memory_order_relaxed ) ) )
+                {
+                    index = i;
+                }
+            }
+
+            if ( index == registry.Threads.size() )
+            {
+                registry.Threads.push_back( std::unique_ptr<ThreadBuffer>( new ThreadBuffer() ) );
+            }
+
+            ThreadBuffer& buffer = *registry.Threads[index];
+            uint64_t writeIndex = buffer.WriteIndex.load( std::memory_order_relaxed );
+            registry.NumDropped += writeIndex - buffer.ReadIndex;
+            buffer.ReadIndex = writeIndex;
+            buffer.Name = "Thread " + std::to_string( index );
+            buffer.Exited = false;
+
+            t_ThreadBuffer = &buffer;
+            t_ThreadExit.Buffer = &buffer;
+        }
+        return *t_ThreadBuffer;
+    }
+
+    // Measure the rate of the timestamps over at least 10 ms.
+    double GetTimestampFrequency( const Registry& registry )
+    {
+        int64_t minCalibrationTicks = Clock::GetFrequency() / 100;
+        int64_t clockTicks = Clock::GetTicks();
+        while ( clockTicks - registry.StartClockTicks < minCalibrationTicks )
+        {
+            clockTicks = Clock::GetTicks();
+        }
+        int64_t timestamp = Profiler::ReadTimestamp();
+        return static_cast<double>( timestamp - registry.StartTimestamp ) / Clock::TicksToSeconds( clockTicks - registry.StartClockTicks );
+    }
+
+    void RecordEvent( ThreadBuffer& buffer, const char* name, int64_t begin, int64_t end )
+    {
+        uint64_t index = buffer.WriteIndex.load( std::memory_order_relaxed );
+        // Make sure the previous index is visible before the event is overwritten (see Collect).
+        std::atomic_thread_fence( std::memory_order_release );
+
+        ProfileEvent& event = buffer.Events[index & ( Profiler::ZonesPerThread - 1 )];
+        event.Name.store( name, std::memory_order_relaxed );
+        event.Begin.store( begin, std::memory_order_relaxed );
+        event.End.store( end, std::memory_order_relaxed );
+
+        buffer.WriteIndex.store( index + 1, std::memory_order_release );
+    }
+
+    // BeginFrame is only called from one thread.
+    int64_t g_FrameBegin = 0;
+    std::atomic<uint64_t> g_FrameCount( 0 );
+
+    void WriteVarint( std::string& buffer, uint64_t value )
+    {
+        while ( value >= 0x80 )
+        {
+            buffer.push_back( static_cast<char>( ( value & 0x7F ) | 0x80 ) );
+            value >>= 7;
+        }
+        buffer.push_back( static_cast<char>( value ) );
+    }
+
+    bool ReadVarint( const std::vector<char>& buffer, size_t& offset, uint64_t& value )
+    {
+        value = 0;
+        for ( int shift = 0; shift < 64; shift += 7 )
+        {
+            if ( offset >= buffer.size() )
+            {
+                return false;
+            }
+
+            uint8_t byte = static_cast<uint8_t>( buffer[offset++] );
+            value |= static_cast<uint64_t>( byte & 0x7F ) << shift;
+            if ( ( byte & 0x80 ) == 0 )
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Map signed values to unsigned values with small magnitudes first (0, -1, 1, -2, ...).
+    uint64_t ZigZagEncode( int64_t value )
+    {
+        return ( static_cast<uint64_t>( value ) << 1 ) ^ static_cast<uint64_t>( value >> 63 );
+    }
+
+    int64_t ZigZagDecode( uint64_t value )
+    {
+        return static_cast<int64_t>( value >> 1 ) ^ -static_cast<int64_t>( value & 1 );
+    }
+
+    void WriteString( std::string& buffer, const std::string& string )
+    {
+        WriteVarint( buffer, string.size() );
+        buffer.append( string );
+    }
+
+    bool ReadString( const std::vector<char>& buffer, size_t& offset, std::string& string )
+    {
+        uint64_t length;
+        if ( !ReadVarint( buffer, offset, length ) || length > buffer.size() - offset )
+        {
+            return false;
+        }
+        string.assign( buffer.data() + offset, static_cast<size_t>( length ) );
+        offset += static_cast<size_t>( length );
+        return true;
+    }
+
+    std::string EscapeJson( const std::string& string )
+    {
+        std::string escaped;
+        for ( char c : string )
+        {
+            if ( c == '"' || c == '\\' )
+            {
+                escaped.push_back( '\\' );
+                escaped.push_back( c );
+            }
+            else if ( static_cast<unsigned char>( c ) < 0x20 )
+            {
+                char code[8];
+                snprintf( code, sizeof( code ), "\\u%04x", c );
+                escaped.append( code );
+            }
+            else
+            {
+                escaped.push_back( c );
+            }
+        }
+        return escaped;
+    }
+}
+
+ProfileCapture::ProfileCapture()
+    : NumDropped( 0 )
+{}
+
+void ProfileCapture::Clear()
+{
+    Names.clear();
+    Threads.clear();
+    Zones.clear();
+    NumDropped = 0;
+}
+
+bool ProfileCapture::WriteChromeTrace( const std::string& fileName ) const
+{
+    std::ofstream file( fileName.c_str(), std::ios::out | std::ios::trunc );
+    if ( !file )
+    {
+        return false;
+    }
+
+    // The records are separated by commas, so a separator goes before every record but the first.
+    const char* separator = "\n";
+    file << "{\"traceEvents\":[";
+    for ( size_t i = 0; i < Threads.size(); ++i )
+    {
+        file << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i
+             << ",\"args\":{\"name\":\"" << EscapeJson( Threads[i] ) << "\"}}";
+        separator = ",\n";
+    }
+
+    std::vector<std::string> names;
+    for ( const std::string& name : Names )
+    {
+        names.push_back( EscapeJson( name ) );
+    }
+
+    // Complete events ("X") with the times in microseconds.
+    char times[64];
+    for ( size_t i = 0; i < Zones.size(); ++i )
+    {
+        const ProfileZone& zone = Zones[i];
+        snprintf( times, sizeof( times ), "%.3f,\"dur\":%.3f", zone.Begin * 1e-3, zone.Duration * 1e-3 );
+        file << separator << "{\"name\":\"" << names[zone.Name] << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.Thread
+             << ",\"ts\":" << times << "}";
+        separator = ",\n";
+    }
+    file << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+    return file.good();
+}
+
+bool ProfileCapture::WriteBinary( const std::string& fileName ) const
+{
+    const uint32_t header[2] = { FileMagic, FileVersion };
+
+    std::string buffer;
+    buffer.append( reinterpret_cast<const char*>( header ), sizeof( header ) );
+
+    WriteVarint( buffer, Names.size() );
+    for ( const std::string& name : Names )
+    {
+        WriteString( buffer, name );
+    }
+    WriteVarint( buffer, Threads.size() );
+    for ( const std::string& thread : Threads )
+    {
+        WriteString( buffer, thread );
+    }
+    WriteVarint( buffer, NumDropped );
+
+    WriteVarint( buffer, Zones.size() );
+    int64_t previousBegin = 0;
+    uint32_t previousThread = 0;
+    for ( const ProfileZone& zone : Zones )
+    {
+        if ( zone.Thread != previousThread )
+        {
+            previousBegin = 0;
+            previousThread = zone.Thread;
+        }
+
+        WriteVarint( buffer, zone.Thread );
+        WriteVarint( buffer, zone.Name );
+        WriteVarint( buffer, zone.Depth );
+        WriteVarint( buffer, ZigZagEncode( zone.Begin - previousBegin ) );
+        WriteVarint( buffer, static_cast<uint64_t>( std::max<int64_t>( zone.Duration, 0 ) ) );
+        previousBegin = zone.Begin;
+    }
+
+    std::ofstream file( fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+    file.write( buffer.data(), buffer.size() );
+    return file.good();
+}
+
+bool ProfileCapture::ReadBinary( const std::string& fileName )
+{
+    Clear();
+
+    std::ifstream file( fileName.c_str(), std::ios::in | std::ios::binary );
+    if ( !file )
+    {
+        return false;
+    }
+    std::vector<char> buffer( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+
+    uint32_t magic, version;
+    if ( buffer.size() < sizeof( magic ) + sizeof( version ) )
+    {
+        return false;
+    }
+    memcpy( &magic, buffer.data(), sizeof( magic ) );
+    memcpy( &version, buffer.data() + sizeof( magic ), sizeof( version ) );
+    if ( magic != FileMagic || version != FileVersion )
+    {
+        return false;
+    }
+
+    size_t offset = sizeof( magic ) + sizeof( version );
+    uint64_t numNames, numThreads, numZones;
+    bool valid = ReadVarint( buffer, offset, numNames ) && numNames <= buffer.size();
+    for ( uint64_t i = 0; valid && i < numNames; ++i )
+    {
+        Names.push_back( std::string() );
+        valid = ReadString( buffer, offset, Names.back() );
+    }
+    valid = valid && ReadVarint( buffer, offset, numThreads ) && numThreads <= buffer.size();
+    for ( uint64_t i = 0; valid && i < numThreads; ++i )
+    {
+        Threads.push_back( std::string() );
+        valid = ReadString( buffer, offset, Threads.back() );
+    }
+    valid = valid && ReadVarint( buffer, offset, NumDropped );
+
+    // Every zone takes at least 5 bytes.
+    valid = valid && ReadVarint( buffer, offset, numZones ) && numZones <= buffer.size() / 5;
+    if ( valid )
+    {
+        Zones.reserve( static_cast<size_t>( numZones ) );
+    }
+
+    int64_t previousBegin = 0;
+    uint32_t previousThread = 0;
+    for ( uint64_t i = 0; valid && i < numZones; ++i )
+    {
+        uint64_t thread, name, depth, begin, duration;
+        valid = ReadVarint( buffer, offset, thread ) && ReadVarint( buffer, offset, name ) &&
+                ReadVarint( buffer, offset, depth ) && ReadVarint( buffer, offset, begin ) &&
+                ReadVarint( buffer, offset, duration ) && thread < numThreads && name < numNames;
+        if ( valid )
+        {
+            if ( thread != previousThread )
+            {
+                previousBegin = 0;
+                previousThread = static_cast<uint32_t>( thread );
+            }
+
+            ProfileZone zone;
+            zone.Name = static_cast<uint32_t>( name );
+            zone.Thread = static_cast<uint32_t>( thread );
+            zone.Depth = static_cast<uint32_t>( depth );
+            zone.Begin = previousBegin + ZigZagDecode( begin );
+            zone.Duration = static_cast<int64_t>( duration );
+            Zones.push_back( zone );
+            previousBegin = zone.Begin;
+        }
+    }
+
+    if ( !valid || offset != buffer.size() )
+    {
+        Clear();
+        return false;
+    }
+    return true;
+}
+
+void Profiler::set_Enabled( bool enabled )
+{
+    ms_Enabled.store( enabled, std::memory_order_relaxed );
+}
+
+void Profiler::SetThreadName( const std::string& name )
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+
+    std::lock_guard<std::mutex> lock( GetRegistry().Mutex );
+    buffer.Name = name;
+}
+
+void Profiler::BeginFrame()
+{
+    int64_t now = ReadTimestamp();
+    if ( g_FrameCount.load( std::memory_order_relaxed ) > 0 && get_Enabled() )
+    {
+        Record( "Frame", g_FrameBegin, now );
+    }
+
+    g_FrameBegin = now;
+    g_FrameCount.fetch_add( 1, std::memory_order_relaxed );
+}
+
+uint64_t Profiler::get_FrameCount()
+{
+    return g_FrameCount.load( std::memory_order_relaxed );
+}
+
+double Profiler::get_TimestampFrequency()
+{
+    return GetTimestampFrequency( GetRegistry() );
+}
+
+void Profiler::Record( const char* name, int64_t begin, int64_t end )
+{
+    RecordEvent( GetThreadBuffer(), name, begin, end );
+}
+
+uint32_t Profiler::CreateTrack( const std::string& name )
+{
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock( registry.Mutex );
+
+    registry.Threads.push_back( std::unique_ptr<ThreadBuffer>( new ThreadBuffer() ) );
+    registry.Threads.back()->Name = name;
+    return static_cast<uint32_t>( registry.Threads.size() - 1 );
+}
+
+void Profiler::RecordOnTrack( uint32_t track, const char* name, int64_t begin, int64_t end )
+{
+    ThreadBuffer* buffer;
+    {
+        // The list of buffers may grow while it is read.
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock( registry.Mutex );
+        if ( track >= registry.Threads.size() )
+        {
+            throw std::invalid_argument( "Invalid profiler track." );
+        }
+        buffer = registry.Threads[track].get();
+    }
+    RecordEvent( *buffer, name, begin, end );
+}
+
+void Profiler::Collect( ProfileCapture& capture )
+{
+    capture.Clear();
+
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock( registry.Mutex );
+
+    double nanosecondsPerTick = 1e9 / GetTimestampFrequency( registry );
+
+    capture.NumDropped = registry.NumDropped;
+    registry.NumDropped = 0;
+
+    std::unordered_map<const char*, uint32_t> nameByPointer;
+    std::map<std::string, uint32_t> nameByString;
+
+    struct Event
+    {
+        const char* Name;
+        int64_t Begin;
+        int64_t End;
+    };
+    std::vector<Event> events;
+    std::vector<int64_t> openZones;
+
+    for ( uint32_t thread = 0; thread < registry.Threads.size(); ++thread )
+    {
+        ThreadBuffer& buffer = *registry.Threads[thread];
+        capture.Threads.push_back( buffer.Name );
+
+        uint64_t end = buffer.WriteIndex.load( std::memory_order_acquire );
+        uint64_t begin = std::max<uint64_t>( buffer.ReadIndex, end > ZonesPerThread ? end - ZonesPerThread : 0 );
+        capture.NumDropped += begin - buffer.ReadIndex;
+        buffer.ReadIndex = end;
+
+        events.clear();
+        for ( uint64_t i = begin; i < end; ++i )
+        {
+            const ProfileEvent& event = buffer.Events[i & ( ZonesPerThread - 1 )];
+            Event copy = { event.Name.load( std::memory_order_relaxed ), event.Begin.load( std::memory_order_relaxed ), event.End.load( std::memory_order_relaxed ) };
+            events.push_back( copy );
+        }
+
+        // The event that the thread is writing now overwrites the index end - ZonesPerThread.
+        // Drop the events that may have been overwritten while they were copied.
+        std::atomic_thread_fence( std::memory_order_acquire );
+        uint64_t writeIndex = buffer.WriteIndex.load( std::memory_order_relaxed );
+        uint64_t firstValid = writeIndex >= ZonesPerThread ? writeIndex - ZonesPerThread + 1 : 0;
+        size_t numOverwritten = static_cast<size_t>( std::min<uint64_t>( firstValid > begin ? firstValid - begin : 0, events.size() ) );
+        capture.NumDropped += numOverwritten;
+
+        size_t firstZone = capture.Zones.size();
+        for ( size_t i = numOverwritten; i < events.size(); ++i )
+        {
+            const Event& event = events[i];
+
+            uint32_t name;
+            std::unordered_map<const char*, uint32_t>::iterator pointer = nameByPointer.find( event.Name );
+            if ( pointer != nameByPointer.end() )
+            {
+                name = pointer->second;
+            }
+            else
+            {
+                // Equal names at different addresses are one name.
+                std::map<std::string, uint32_t>::iterator string = nameByString.find( event.Name );
+                if ( string == nameByString.end() )
+                {
+                    string = nameByString.insert( std::make_pair( std::string( event.Name ), static_cast<uint32_t>( capture.Names.size() ) ) ).first;
+                    capture.Names.push_back( event.Name );
+                }
+                name = string->second;
+                nameByPointer[event.Name] = name;
+            }
+
+            ProfileZone zone;
+            zone.Name = name;
+            zone.Thread = thread;
+            zone.Depth = 0;
+            zone.Begin = static_cast<int64_t>( ( event.Begin - registry.StartTimestamp ) * nanosecondsPerTick );
+            zone.Duration = std::max<int64_t>( static_cast<int64_t>( ( event.End - event.Begin ) * nanosecondsPerTick ), 0 );
+            capture.Zones.push_back( zone );
+        }
+
+        // The zones are recorded when they end (children before their parents).
+        // Sort them by start time, parents first, and count the open zones.
+        std::sort( capture.Zones.begin() + firstZone, capture.Zones.end(), []( const ProfileZone& a, const ProfileZone& b )
+        {
+            return a.Begin < b.Begin || ( a.Begin == b.Begin && a.Duration > b.Duration );
+        } );
+
+        openZones.clear();
+        for ( size_t i = firstZone; i < capture.Zones.size(); ++i )
+        {
+            ProfileZone& zone = capture.Zones[i];
+            while ( !openZones.empty() && openZones.back() <= zone.Begin )
+            {
+                openZones.pop_back();
+            }
+            zone.Depth = static_cast<uint32_t>( openZones.size() );
+            openZones.push_back( zone.Begin + zone.Duration );
+        }
+    }
+}
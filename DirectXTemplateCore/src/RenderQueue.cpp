@@ -0,0 +1,211 @@
+#include <DirectXTemplateCorePCH.h>
+#include <RenderQueue.h>
+
+namespace SortKey
+{
+    static uint64_t Field( uint32_t value, int bits, int shift )
+    {
+        return ( static_cast<uint64_t>( value ) & ( ( 1ull << bits ) - 1 ) ) << shift;
+    }
+
+    uint32_t QuantizeDepth( float depth )
+    {
+        const uint32_t maxDepth = ( 1u << DepthBits ) - 1;
+
+        // Also handles NaN (sorted to the front).
+        if ( !( depth > 0.0f ) ) return 0;
+        if ( depth >= 1.0f ) return maxDepth;
+
+        return static_cast<uint32_t>( depth * maxDepth );
+    }
+
+    uint64_t Opaque( uint32_t pass, uint32_t shader, uint32_t material, uint32_t texture, float depth )
+    {
+        return Field( pass, PassBits, 60 ) |
+            Field( shader, ShaderBits, 48 ) |
+            Field( material, MaterialBits, 36 ) |
+            Field( texture, TextureBits, 24 ) |
+            Field( QuantizeDepth( depth ), DepthBits, 0 );
+    }
+
+    uint64_t Translucent( uint32_t pass, float depth, uint32_t shader, uint32_t material, uint32_t texture )
+    {
+        // Invert the depth to sort back to front.
+        uint32_t invertedDepth = ( ( 1u << DepthBits ) - 1 ) - QuantizeDepth( depth );
+
+        return Field( pass, PassBits, 60 ) |
+            Field( invertedDepth, DepthBits, 36 ) |
+            Field( shader, ShaderBits, 24 ) |
+            Field( material, MaterialBits, 12 ) |
+            Field( texture, TextureBits, 0 );
+    }
+
+    uint32_t GetPass( uint64_t sortKey )
+    {
+        return static_cast<uint32_t>( sortKey >> 60 );
+    }
+}
+
+RenderQueue::RenderQueue()
+    : m_Sorted( true )
+{}
+
+RenderQueue::~RenderQueue()
+{}
+
+void RenderQueue::Submit( uint64_t sortKey, const DrawCommand& drawCommand )
+{
+    assert( drawCommand.NumVertexBuffers <= RenderContext::MaxVertexBuffers );
+    assert( drawCommand.NumVSConstantBuffers <= RenderContext::MaxConstantBuffers );
+    assert( drawCommand.NumPSConstantBuffers <= RenderContext::MaxConstantBuffers );
+    assert( drawCommand.NumPSShaderResources <= RenderContext::MaxShaderResources );
+
+    SortEntry sortEntry = { sortKey, static_cast<uint32_t>( m_Commands.size() ) };
+
+    m_Commands.push_back( drawCommand );
+    m_SortEntries.push_back( sortEntry );
+    m_Sorted = false;
+}
+
+void RenderQueue::Sort()
+{
+    if ( m_Sorted ) return;
+    m_Sorted = true;
+
+    // LSD radix sort with 8-bit digits. The histograms for all of the digits
+    // are computed in a single pass over the keys. Digits that are the same
+    // for all keys (for example unused passes or IDs) are skipped.
+    const int NumDigits = 8;
+    const int NumBuckets = 256;
+
+    size_t numEntries = m_SortEntries.size();
+    if ( numEntries == 0 ) return;
+
+    m_ScratchEntries.resize( numEntries );
+
+    std::vector<uint32_t> histograms( NumDigits * NumBuckets, 0 );
+    for ( size_t i = 0; i < numEntries; ++i )
+    {
+        uint64_t key = m_SortEntries[i].Key;
+        for ( int digit = 0; digit < NumDigits; ++digit )
+        {
+            histograms[digit * NumBuckets + ( ( key >> ( digit * 8 ) ) & 0xff )]++;
+        }
+    }
+
+    SortEntry* source = m_SortEntries.data();
+    SortEntry* destination = m_ScratchEntries.data();
+
+    for ( int digit = 0; digit < NumDigits; ++digit )
+    {
+        uint32_t* histogram = &histograms[digit * NumBuckets];
+
+        // Skip the digit if all of the keys fall into the same bucket.
+        uint32_t firstBucket = static_cast<uint32_t>( ( source[0].Key >> ( digit * 8 ) ) & 0xff );
+        if ( histogram[firstBucket] == numEntries ) continue;
+
+        // Convert the histogram to the offset of each bucket.
+        uint32_t offset = 0;
+        for ( int bucket = 0; bucket < NumBuckets; ++bucket )
+        {
+            uint32_t count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += count;
+        }
+
+        for ( size_t i = 0; i < numEntries; ++i )
+        {
+            uint32_t bucket = static_cast<uint32_t>( ( source[i].Key >> ( digit * 8 ) ) & 0xff );
+            destination[histogram[bucket]++] = source[i];
+        }
+
+        std::swap( source, destination );
+    }
+
+    if ( source != m_SortEntries.data() )
+    {
+        m_SortEntries.swap( m_ScratchEntries );
+    }
+}
+
+void RenderQueue::Execute( RenderContext& renderContext )
+{
+    Sort();
+    Execute( renderContext, 0, m_SortEntries.size() );
+}
+
+void RenderQueue::Execute( RenderContext& renderContext, size_t begin, size_t end ) const
+{
+    assert( m_Sorted );
+    assert( begin <= end && end <= m_SortEntries.size() );
+
+    for ( size_t i = begin; i < end; ++i )
+    {
+        Execute( renderContext, m_Commands[m_SortEntries[i].Index] );
+    }
+}
+
+void RenderQueue::Execute( RenderContext& renderContext, const DrawCommand& drawCommand )
+{
+    renderContext.SetInputLayout( drawCommand.InputLayout );
+    renderContext.SetPrimitiveTopology( drawCommand.PrimitiveTopology );
+    for ( uint32_t slot = 0; slot < drawCommand.NumVertexBuffers; ++slot )
+    {
+        renderContext.SetVertexBuffer( slot, drawCommand.VertexBuffers[slot] );
+    }
+    renderContext.SetIndexBuffer( drawCommand.IndexBuffer, drawCommand.IndexFormat );
+
+    renderContext.SetVertexShader( drawCommand.VertexShader );
+    for ( uint32_t slot = 0; slot < drawCommand.NumVSConstantBuffers; ++slot )
+    {
+        renderContext.SetVSConstantBuffer( slot, drawCommand.VSConstantBuffers[slot] );
+    }
+
+    renderContext.SetRasterizerState( drawCommand.RasterizerState );
+
+    renderContext.SetPixelShader( drawCommand.PixelShader );
+    for ( uint32_t slot = 0; slot < drawCommand.NumPSConstantBuffers; ++slot )
+    {
+        renderContext.SetPSConstantBuffer( slot, drawCommand.PSConstantBuffers[slot] );
+    }
+    for ( uint32_t slot = 0; slot < drawCommand.NumPSShaderResources; ++slot )
+    {
+        renderContext.SetPSShaderResource( slot, drawCommand.PSShaderResources[slot] );
+    }
+
+    renderContext.SetDepthStencilState( drawCommand.DepthStencilState );
+    renderContext.SetBlendState( drawCommand.BlendState );
+
+    if ( drawCommand.InstanceCount > 0 )
+    {
+        renderContext.DrawIndexedInstanced( drawCommand.IndexCount, drawCommand.InstanceCount, drawCommand.StartIndex, drawCommand.BaseVertex, drawCommand.StartInstance );
+    }
+    else
+    {
+        renderContext.DrawIndexed( drawCommand.IndexCount, drawCommand.StartIndex, drawCommand.BaseVertex );
+    }
+}
+
+void RenderQueue::Clear()
+{
+    m_Commands.clear();
+    m_SortEntries.clear();
+    m_Sorted = true;
+}
+
+size_t RenderQueue::get_NumCommands() const
+{
+    return m_Commands.size();
+}
+
+const DrawCommand& RenderQueue::get_SortedCommand( size_t index ) const
+{
+    assert( m_Sorted );
+    return m_Commands[m_SortEntries[index].Index];
+}
+
+uint64_t RenderQueue::get_SortedKey( size_t index ) const
+{
+    assert( m_Sorted );
+    return m_SortEntries[index].Key;
+}
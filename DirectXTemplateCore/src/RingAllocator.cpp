@@ -0,0 +1,135 @@
+#include <DirectXTemplateCorePCH.h>
+#include <RingAllocator.h>
+
+RingAllocator::RingAllocator( size_t capacity, size_t alignment )
+    : m_Capacity( 0 )
+    , m_Alignment( alignment )
+    , m_Head( 0 )
+    , m_Tail( 0 )
+    , m_UsedSize( 0 )
+    , m_CurrentFrameSize( 0 )
+    , m_WrapCount( 0 )
+{
+    if ( alignment == 0 || ( alignment & ( alignment - 1 ) ) != 0 )
+        throw std::invalid_argument( "Alignment must be a power of 2." );
+
+    m_Capacity = capacity & ~( alignment - 1 );
+
+    if ( m_Capacity == 0 )
+        throw std::invalid_argument( "Capacity must be at least the size of the alignment." );
+}
+
+size_t RingAllocator::AlignUp( size_t size ) const
+{
+    return ( size + m_Alignment - 1 ) & ~( m_Alignment - 1 );
+}
+
+size_t RingAllocator::Allocate( size_t size )
+{
+    size_t alignedSize = AlignUp( std::max<size_t>( size, 1 ) );
+    if ( alignedSize > m_Capacity )
+    {
+        return InvalidOffset;
+    }
+
+    assert( ( m_Tail + m_UsedSize ) % m_Capacity == m_Head );
+
+    // Start at the beginning of the buffer when the ring is empty
+    // to avoid skipping the end of the buffer unnecessarily.
+    if ( m_UsedSize == 0 )
+    {
+        m_Head = m_Tail = 0;
+    }
+
+    size_t freeSize = m_Capacity - m_UsedSize;
+
+    // If the allocation does not fit at the end of the buffer, the
+    // remainder of the buffer is skipped and counted as used memory.
+    size_t padding = 0;
+    if ( m_Head + alignedSize > m_Capacity )
+    {
+        padding = m_Capacity - m_Head;
+    }
+
+    if ( padding + alignedSize > freeSize )
+    {
+        return InvalidOffset;
+    }
+
+    if ( padding > 0 )
+    {
+        m_Head = 0;
+        m_WrapCount++;
+    }
+
+    size_t offset = m_Head;
+    m_Head += alignedSize;
+    if ( m_Head == m_Capacity )
+    {
+        m_Head = 0;
+        m_WrapCount++;
+    }
+    m_UsedSize += padding + alignedSize;
+    m_CurrentFrameSize += padding + alignedSize;
+
+    return offset;
+}
+
+void RingAllocator::FinishFrame( uint64_t fenceValue )
+{
+    assert( m_Frames.empty() || m_Frames.back().FenceValue <= fenceValue );
+
+    FrameInfo frame = { fenceValue, m_CurrentFrameSize };
+    m_Frames.push_back( frame );
+    m_CurrentFrameSize = 0;
+}
+
+void RingAllocator::ReleaseCompletedFrames( uint64_t completedFenceValue )
+{
+    while ( !m_Frames.empty() && m_Frames.front().FenceValue <= completedFenceValue )
+    {
+        const FrameInfo& frame = m_Frames.front();
+        m_Tail = ( m_Tail + frame.Size ) % m_Capacity;
+        m_UsedSize -= frame.Size;
+        m_Frames.pop_front();
+    }
+}
+
+void RingAllocator::Reset()
+{
+    m_Frames.clear();
+    m_Head = 0;
+    m_Tail = 0;
+    m_UsedSize = 0;
+    m_CurrentFrameSize = 0;
+}
+
+uint64_t RingAllocator::get_OldestFenceValue() const
+{
+    return m_Frames.empty() ? 0 : m_Frames.front().FenceValue;
+}
+
+size_t RingAllocator::get_NumFramesInFlight() const
+{
+    return m_Frames.size();
+}
+
+size_t RingAllocator::get_Capacity() const
+{
+    return m_Capacity;
+}
+
+size_t RingAllocator::get_Alignment() const
+{
+    return m_Alignment;
+}
+
+size_t RingAllocator::get_UsedSize() const
+{
+    return m_UsedSize;
+}
+
+uint64_t RingAllocator::get_WrapCount() const
+{
+    return m_WrapCount;
+}
@@ -0,0 +1,284 @@
+#include <DirectXTemplateCorePCH.h>
+#include <ShaderPermutations.h>
+
+#include <cstdio>
+#include <fstream>
+#include <type_traits>
+
+static_assert( std::is_trivially_copyable<ShaderCacheFileHeader>::value, "ShaderCacheFileHeader is read and written as raw bytes." );
+
+namespace
+{
+    const uint64_t HashOffsetBasis = 14695981039346656037ull;
+
+    // 64-bit FNV-1a.
+    uint64_t Hash( uint64_t hash, const void* data, size_t size )
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>( data );
+        for ( size_t i = 0; i < size; ++i )
+        {
+            hash = ( hash ^ bytes[i] ) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // The length is hashed as well, so "ab" + "c" and "a" + "bc" have different hashes.
+    uint64_t Hash( uint64_t hash, const std::string& text )
+    {
+        uint64_t size = text.size();
+        hash = Hash( hash, &size, sizeof( size ) );
+        return Hash( hash, text.data(), text.size() );
+    }
+
+    bool ReadCacheFile( const std::string& fileName, uint64_t shaderHash, std::vector<uint8_t>& bytecode )
+    {
+        std::ifstream file( fileName.c_str(), std::ios::in | std::ios::binary );
+        if ( !file )
+        {
+            return false;
+        }
+
+        ShaderCacheFileHeader header;
+        if ( !file.read( reinterpret_cast<char*>( &header ), sizeof( header ) ) ||
+             header.Magic != ShaderCacheFileHeader::FileMagic || header.Version != ShaderCacheFileHeader::FileVersion ||
+             header.ShaderHash != shaderHash || header.BytecodeSize == 0 )
+        {
+            return false;
+        }
+
+        // The size in the header must match the file, so a truncated file is a miss.
+        file.seekg( 0, std::ios::end );
+        uint64_t fileSize = static_cast<uint64_t>( file.tellg() );
+        if ( fileSize != sizeof( header ) + header.BytecodeSize )
+        {
+            return false;
+        }
+        file.seekg( sizeof( header ), std::ios::beg );
+
+        bytecode.resize( static_cast<size_t>( header.BytecodeSize ) );
+        if ( !file.read( reinterpret_cast<char*>( bytecode.data() ), static_cast<std::streamsize>( bytecode.size() ) ) ||
+             Hash( HashOffsetBasis, bytecode.data(), bytecode.size() ) != header.BytecodeHash )
+        {
+            bytecode.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    // Written under a temporary name and renamed like the mesh files (see WriteMeshFile).
+    bool WriteCacheFile( const std::string& fileName, uint64_t shaderHash, const std::vector<uint8_t>& bytecode )
+    {
+        ShaderCacheFileHeader header;
+        memset( &header, 0, sizeof( header ) );
+        header.Magic = ShaderCacheFileHeader::FileMagic;
+        header.Version = ShaderCacheFileHeader::FileVersion;
+        header.ShaderHash = shaderHash;
+        header.BytecodeSize = bytecode.size();
+        header.BytecodeHash = Hash( HashOffsetBasis, bytecode.data(), bytecode.size() );
+
+        std::string temporaryFileName = fileName + ".tmp";
+        {
+            std::ofstream file( temporaryFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+            if ( !file )
+            {
+                return false;
+            }
+
+            file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+            file.write( reinterpret_cast<const char*>( bytecode.data() ), static_cast<std::streamsize>( bytecode.size() ) );
+
+            file.close();
+            if ( !file )
+            {
+                std::remove( temporaryFileName.c_str() );
+                return false;
+            }
+        }
+
+#if defined(_WIN32)
+        // rename does not replace an existing file on Windows.
+        std::remove( fileName.c_str() );
+#endif
+        if ( std::rename( temporaryFileName.c_str(), fileName.c_str() ) != 0 )
+        {
+            std::remove( temporaryFileName.c_str() );
+            return false;
+        }
+
+        return true;
+    }
+}
+
+ShaderPermutations::ShaderPermutations( const std::vector<ShaderKeyword>& keywords )
+    : m_Keywords( keywords )
+    , m_NumVariants( 1 )
+{
+    for ( const ShaderKeyword& keyword : m_Keywords )
+    {
+        if ( keyword.Name.empty() || keyword.NumValues == 0 || keyword.NumValues > MaxVariants / m_NumVariants )
+        {
+            throw std::invalid_argument( "Every shader keyword needs a name and a value, and a shader can have at most 65536 variants." );
+        }
+        m_Strides.push_back( m_NumVariants );
+        m_NumVariants *= keyword.NumValues;
+    }
+}
+
+uint32_t ShaderPermutations::get_NumKeywords() const
+{
+    return static_cast<uint32_t>( m_Keywords.size() );
+}
+
+const ShaderKeyword& ShaderPermutations::GetKeyword( uint32_t keyword ) const
+{
+    assert( keyword < m_Keywords.size() );
+    return m_Keywords[keyword];
+}
+
+uint32_t ShaderPermutations::get_NumVariants() const
+{
+    return m_NumVariants;
+}
+
+uint32_t ShaderPermutations::GetVariant( const uint32_t* values ) const
+{
+    uint32_t variant = 0;
+    for ( size_t i = 0; i < m_Keywords.size(); ++i )
+    {
+        assert( values[i] < m_Keywords[i].NumValues );
+        variant += values[i] * m_Strides[i];
+    }
+    return variant;
+}
+
+uint32_t ShaderPermutations::GetValue( uint32_t variant, uint32_t keyword ) const
+{
+    assert( variant < m_NumVariants && keyword < m_Keywords.size() );
+    return ( variant / m_Strides[keyword] ) % m_Keywords[keyword].NumValues;
+}
+
+void ShaderPermutations::GetDefines( uint32_t variant, std::vector<ShaderDefine>& defines ) const
+{
+    defines.resize( m_Keywords.size() );
+    for ( uint32_t i = 0; i < m_Keywords.size(); ++i )
+    {
+        defines[i].Name = m_Keywords[i].Name;
+        defines[i].Value = std::to_string( GetValue( variant, i ) );
+    }
+}
+
+uint64_t ComputeShaderHash( const ShaderSource& source, const std::vector<ShaderDefine>& defines, const std::string& compilerIdentifier )
+{
+    uint64_t hash = HashOffsetBasis;
+
+    // Files written with another version of the format get another name.
+    uint32_t version = ShaderCacheFileHeader::FileVersion;
+    hash = Hash( hash, &version, sizeof( version ) );
+
+    hash = Hash( hash, compilerIdentifier );
+    hash = Hash( hash, source.Code );
+    hash = Hash( hash, source.EntryPoint );
+    hash = Hash( hash, source.Target );
+
+    uint64_t numDefines = defines.size();
+    hash = Hash( hash, &numDefines, sizeof( numDefines ) );
+    for ( const ShaderDefine& define : defines )
+    {
+        hash = Hash( hash, define.Name );
+        hash = Hash( hash, define.Value );
+    }
+    return hash;
+}
+
+ShaderCache::ShaderCache( ShaderCompiler& compiler, const std::string& directory )
+    : m_Compiler( compiler )
+    , m_Directory( directory )
+{
+    memset( &m_Statistics, 0, sizeof( m_Statistics ) );
+}
+
+bool ShaderCache::Load( const ShaderSource& source, const std::vector<ShaderDefine>& defines, std::vector<uint8_t>& bytecode )
+{
+    uint64_t hash = ComputeShaderHash( source, defines, m_Compiler.get_Identifier() );
+    std::string fileName = get_FileName( source, hash );
+
+    if ( ReadCacheFile( fileName, hash, bytecode ) )
+    {
+        ++m_Statistics.Loaded;
+        return true;
+    }
+
+    std::string errors;
+    bytecode.clear();
+    if ( !m_Compiler.Compile( source, defines, bytecode, errors ) || bytecode.empty() )
+    {
+        ++m_Statistics.Failed;
+        m_Errors = errors;
+        bytecode.clear();
+        return false;
+    }
+    ++m_Statistics.Compiled;
+
+    // The bytecode is still valid if it cannot be stored, the variant is compiled again next time.
+    WriteCacheFile( fileName, hash, bytecode );
+    return true;
+}
+
+std::string ShaderCache::get_FileName( const ShaderSource& source, uint64_t hash ) const
+{
+    // The name of the source file without its directory and extension.
+    std::string name = source.Name;
+    size_t separator = name.find_last_of( "/\\" );
+    if ( separator != std::string::npos )
+    {
+        name = name.substr( separator + 1 );
+    }
+    name = name.substr( 0, name.find( '.' ) );
+
+    char hashText[17];
+    snprintf( hashText, sizeof( hashText ), "%016llx", static_cast<unsigned long long>( hash ) );
+    std::string baseName = name + "-" + source.EntryPoint + "-" + hashText + ".cso";
+
+    if ( m_Directory.empty() )
+    {
+        return baseName;
+    }
+    return m_Directory + "/" + baseName;
+}
+
+const std::string& ShaderCache::get_Errors() const
+{
+    return m_Errors;
+}
+
+const ShaderCache::Statistics& ShaderCache::get_Statistics() const
+{
+    return m_Statistics;
+}
+
+std::vector<ShaderKeyword> GetTexturedLitKeywords()
+{
+    std::vector<ShaderKeyword> keywords( TexturedLitKeywordCount );
+    keywords[TexturedLitUseTexture].Name = "USE_TEXTURE";
+    keywords[TexturedLitDirectionalLights].Name = "DIRECTIONAL_LIGHTS";
+    keywords[TexturedLitPointLights].Name = "POINT_LIGHTS";
+    keywords[TexturedLitSpotLights].Name = "SPOT_LIGHTS";
+    for ( ShaderKeyword& keyword : keywords )
+    {
+        keyword.NumValues = 2;
+    }
+    return keywords;
+}
+
+uint32_t GetTexturedLitVariant( const ShaderPermutations& permutations, const _Material& material, const uint32_t* numEnabledLights )
+{
+    assert( permutations.get_NumKeywords() == TexturedLitKeywordCount );
+
+    uint32_t values[TexturedLitKeywordCount];
+    values[TexturedLitUseTexture] = material.UseTexture ? 1 : 0;
+    values[TexturedLitDirectionalLights] = numEnabledLights[DirectionalLight] > 0 ? 1 : 0;
+    values[TexturedLitPointLights] = numEnabledLights[PointLight] > 0 ? 1 : 0;
+    values[TexturedLitSpotLights] = numEnabledLights[SpotLight] > 0 ? 1 : 0;
+    return permutations.GetVariant( values );
+}
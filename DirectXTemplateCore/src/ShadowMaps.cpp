@@ -0,0 +1,370 @@
+#include <DirectXTemplateCorePCH.h>
+#include <ShadowMaps.h>
+
+#include <LightClusters.h>
+
+#include <cfloat>
+
+using namespace Math;
+
+static bool IsPowerOfTwo( uint32_t x )
+{
+    return x != 0 && ( x & ( x - 1 ) ) == 0;
+}
+
+// The largest power of two that is not greater than x (x >= 1).
+static uint32_t FloorPowerOfTwo( uint32_t x )
+{
+    uint32_t power = 1;
+    while ( power <= x / 2 )
+    {
+        power *= 2;
+    }
+    return power;
+}
+
+// The even bits of a Z-order index.
+static uint32_t CompactBits( uint32_t x )
+{
+    x &= 0x55555555;
+    x = ( x | ( x >> 1 ) ) & 0x33333333;
+    x = ( x | ( x >> 2 ) ) & 0x0F0F0F0F;
+    x = ( x | ( x >> 4 ) ) & 0x00FF00FF;
+    x = ( x | ( x >> 8 ) ) & 0x0000FFFF;
+    return x;
+}
+
+float ShadowImportance( const Light& light, const Camera& camera )
+{
+    BoundingSphere bounds = LightBounds( light );
+    if ( !( bounds.Radius < FLT_MAX ) )
+    {
+        return 1.0f;
+    }
+
+    if ( !camera.get_Frustum().Intersects( bounds ) )
+    {
+        return 0.0f;
+    }
+
+    float distance = Length( TransformPoint( bounds.Center, camera.get_ViewMatrix() ) );
+    if ( distance <= bounds.Radius )
+    {
+        return 1.0f;
+    }
+
+    // The tangent of the angle of the sphere relative to the tangent of the half field of view.
+    float tanSphere = bounds.Radius / std::sqrt( distance * distance - bounds.Radius * bounds.Radius );
+    float tanFov = std::tan( 0.5f * ConvertToRadians( camera.get_VerticalFieldOfView() ) );
+    return std::min( tanSphere / tanFov, 1.0f );
+}
+
+ShadowAtlas::ShadowAtlas( uint32_t size, uint32_t minTileSize, uint32_t maxTileSize )
+    : m_Size( size )
+    , m_MinTileSize( minTileSize )
+    , m_MaxTileSize( maxTileSize )
+{
+    if ( !IsPowerOfTwo( size ) || !IsPowerOfTwo( minTileSize ) || !IsPowerOfTwo( maxTileSize ) )
+    {
+        throw std::invalid_argument( "The size of the shadow atlas and its tiles must be powers of two." );
+    }
+    if ( minTileSize > maxTileSize || maxTileSize > size || size / minTileSize > 65536 )
+    {
+        throw std::invalid_argument( "The tiles of the shadow atlas must fit in the atlas and have at most 65536 tiles in a row." );
+    }
+}
+
+uint32_t ShadowAtlas::get_Size() const
+{
+    return m_Size;
+}
+
+uint32_t ShadowAtlas::get_MinTileSize() const
+{
+    return m_MinTileSize;
+}
+
+uint32_t ShadowAtlas::get_MaxTileSize() const
+{
+    return m_MaxTileSize;
+}
+
+uint32_t ShadowAtlas::GetTileSize( float importance ) const
+{
+    if ( !( importance > 0.0f ) )
+    {
+        return 0;
+    }
+
+    float size = std::min( importance, 1.0f ) * m_MaxTileSize;
+    return std::max( FloorPowerOfTwo( static_cast<uint32_t>( std::max( size, 1.0f ) ) ), m_MinTileSize );
+}
+
+size_t ShadowAtlas::Pack( const std::vector<float>& importance, std::vector<ShadowAtlasTile>& tiles )
+{
+    ShadowAtlasTile noTile = { 0, 0, 0 };
+    tiles.assign( importance.size(), noTile );
+
+    m_Order.clear();
+    for ( uint32_t i = 0; i < importance.size(); ++i )
+    {
+        if ( importance[i] > 0.0f )
+        {
+            m_Order.push_back( i );
+        }
+    }
+
+    // The most important shadow maps first (and the lowest index first for the same
+    // importance, so the tiles do not change between frames with the same importance).
+    std::sort( m_Order.begin(), m_Order.end(), [&importance]( uint32_t a, uint32_t b )
+    {
+        return importance[a] > importance[b] || ( importance[a] == importance[b] && a < b );
+    } );
+
+    // The tile sizes do not increase along the order.
+    uint64_t area = 0;
+    m_TileSizes.resize( m_Order.size() );
+    for ( size_t i = 0; i < m_Order.size(); ++i )
+    {
+        m_TileSizes[i] = GetTileSize( importance[m_Order[i]] );
+        area += static_cast<uint64_t>( m_TileSizes[i] ) * m_TileSizes[i];
+    }
+
+    // Halve the least important tiles until they fit. The tiles after shrink are
+    // already at the minimum size, so the sizes still do not increase.
+    const uint64_t atlasArea = static_cast<uint64_t>( m_Size ) * m_Size;
+    size_t count = m_Order.size();
+    size_t shrink = count;
+    while ( area > atlasArea && shrink > 0 )
+    {
+        uint32_t& size = m_TileSizes[shrink - 1];
+        if ( size > m_MinTileSize )
+        {
+            area -= static_cast<uint64_t>( size ) * size - static_cast<uint64_t>( size / 2 ) * ( size / 2 );
+            size /= 2;
+        }
+        else
+        {
+            --shrink;
+        }
+    }
+
+    // Drop the least important shadow maps that do not fit at the minimum size.
+    while ( area > atlasArea )
+    {
+        --count;
+        area -= static_cast<uint64_t>( m_TileSizes[count] ) * m_TileSizes[count];
+    }
+
+    // Place the tiles in Z-order of the minimum tiles. The offset is always a
+    // multiple of the area of the tile because all of the tiles before it are larger.
+    uint32_t offset = 0;
+    for ( size_t i = 0; i < count; ++i )
+    {
+        ShadowAtlasTile& tile = tiles[m_Order[i]];
+        tile.X = CompactBits( offset ) * m_MinTileSize;
+        tile.Y = CompactBits( offset >> 1 ) * m_MinTileSize;
+        tile.Size = m_TileSizes[i];
+
+        uint32_t cells = m_TileSizes[i] / m_MinTileSize;
+        offset += cells * cells;
+    }
+
+    return count;
+}
+
+void ComputeCascadeSplits( float nearZ, float farZ, uint32_t numCascades, float lambda, float* splits )
+{
+    assert( nearZ > 0.0f && farZ > nearZ && numCascades > 0 );
+
+    splits[0] = nearZ;
+    for ( uint32_t i = 1; i < numCascades; ++i )
+    {
+        float t = static_cast<float>( i ) / numCascades;
+        float logarithmic = nearZ * std::pow( farZ / nearZ, t );
+        float uniform = nearZ + ( farZ - nearZ ) * t;
+        splits[i] = lambda * logarithmic + ( 1.0f - lambda ) * uniform;
+    }
+    splits[numCascades] = farZ;
+}
+
+// An up vector that is not parallel to the direction.
+static Float3 UpVector( const Float3& direction )
+{
+    return ( std::abs( direction.y ) > 0.99f ) ? Float3( 0.0f, 0.0f, 1.0f ) : Float3( 0.0f, 1.0f, 0.0f );
+}
+
+ShadowView ComputeCascadeView( const Camera& camera, const Float3& lightDirection, float splitNear, float splitFar,
+    uint32_t resolution, float casterDistance )
+{
+    assert( resolution > 2 );
+
+    // The bounding sphere of the slice is centered on the view axis. Its radius only
+    // depends on the projection, so the cascade does not change size when the camera turns.
+    float tanY = std::tan( 0.5f * ConvertToRadians( camera.get_VerticalFieldOfView() ) );
+    float tanX = tanY * camera.get_AspectRatio();
+    float tanSq = tanX * tanX + tanY * tanY;
+
+    float center = std::min( 0.5f * ( splitNear + splitFar ) * ( 1.0f + tanSq ), splitFar );
+    float nearDistanceSq = splitNear * splitNear * tanSq + ( center - splitNear ) * ( center - splitNear );
+    float farDistanceSq = splitFar * splitFar * tanSq + ( splitFar - center ) * ( splitFar - center );
+    float radius = std::sqrt( std::max( nearDistanceSq, farDistanceSq ) );
+
+    // Round the radius up so that rounding errors do not change the size of the texels.
+    radius = std::ceil( radius * 16.0f ) / 16.0f;
+
+    // The light view only rotates, so a world-space point keeps its texel as long as
+    // the projection moves in whole texels.
+    ShadowView view;
+    view.ViewMatrix = MatrixLookAtLH( Float3( 0.0f, 0.0f, 0.0f ), lightDirection, UpVector( lightDirection ) );
+
+    Float3 sliceCenter = TransformPoint( TransformPoint( Float3( 0.0f, 0.0f, center ), camera.get_InverseViewMatrix() ), view.ViewMatrix );
+
+    // The sphere stays inside the tile if the center moves by up to a texel.
+    float texelSize = 2.0f * radius / ( resolution - 2 );
+    float extent = radius + texelSize;
+    float x = std::floor( sliceCenter.x / texelSize ) * texelSize;
+    float y = std::floor( sliceCenter.y / texelSize ) * texelSize;
+
+    view.ProjectionMatrix = MatrixOrthographicOffCenterLH( x - extent, x + extent, y - extent, y + extent,
+        sliceCenter.z - radius - casterDistance, sliceCenter.z + radius );
+    view.ViewProjectionMatrix = view.ViewMatrix * view.ProjectionMatrix;
+
+    return view;
+}
+
+ShadowView ComputeSpotShadowView( const Light& light, float nearZ, float farZ )
+{
+    // The field of view of a perspective projection must be less than 180 degrees.
+    float spotAngle = std::min( light.SpotAngle, ConvertToRadians( 85.0f ) );
+    float range = std::min( light.Range, farZ );
+    assert( range > nearZ );
+
+    Float3 position = XYZ( light.Position );
+    Float3 direction = Normalize( XYZ( light.Direction ) );
+
+    ShadowView view;
+    view.ViewMatrix = MatrixLookAtLH( position, position + direction, UpVector( direction ) );
+    view.ProjectionMatrix = MatrixPerspectiveFovLH( 2.0f * spotAngle, 1.0f, nearZ, range );
+    view.ViewProjectionMatrix = view.ViewMatrix * view.ProjectionMatrix;
+
+    return view;
+}
+
+ShadowMapConstants ComputeShadowMapConstants( const ShadowView& view, const ShadowAtlasTile& tile, uint32_t atlasSize,
+    float splitDepth, float depthBias )
+{
+    // Clip space [-1, 1] to the texture coordinates of the tile (y points down in texture space).
+    float scale = 0.5f * tile.Size / atlasSize;
+    float offsetX = ( tile.X + 0.5f * tile.Size ) / atlasSize;
+    float offsetY = ( tile.Y + 0.5f * tile.Size ) / atlasSize;
+    Float4x4 tileMatrix( scale,   0,       0, 0,
+                         0,       -scale,  0, 0,
+                         0,       0,       1, 0,
+                         offsetX, offsetY, 0, 1 );
+
+    float halfTexel = 0.5f / atlasSize;
+
+    ShadowMapConstants constants;
+    constants.ShadowMatrix = view.ViewProjectionMatrix * tileMatrix;
+    constants.TileBounds = Float4( static_cast<float>( tile.X ) / atlasSize + halfTexel, static_cast<float>( tile.Y ) / atlasSize + halfTexel,
+        static_cast<float>( tile.X + tile.Size ) / atlasSize - halfTexel, static_cast<float>( tile.Y + tile.Size ) / atlasSize - halfTexel );
+    constants.SplitDepth = splitDepth;
+    constants.DepthBias = depthBias;
+    constants.Padding[0] = 0.0f;
+    constants.Padding[1] = 0.0f;
+
+    return constants;
+}
+
+ShadowCache::ShadowCache()
+    : m_Frame( 0 )
+{
+    m_Statistics.Hits = 0;
+    m_Statistics.Misses = 0;
+}
+
+void ShadowCache::BeginFrame()
+{
+    for ( std::unordered_map<uint64_t, Entry>::iterator entry = m_Entries.begin(); entry != m_Entries.end(); )
+    {
+        if ( entry->second.Frame < m_Frame )
+        {
+            entry = m_Entries.erase( entry );
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+
+    ++m_Frame;
+    m_Statistics.Hits = 0;
+    m_Statistics.Misses = 0;
+}
+
+static bool Overlaps( const ShadowAtlasTile& a, const ShadowAtlasTile& b )
+{
+    return a.X < b.X + b.Size && b.X < a.X + a.Size && a.Y < b.Y + b.Size && b.Y < a.Y + a.Size;
+}
+
+bool ShadowCache::Update( uint64_t key, const ShadowAtlasTile& tile, const ShadowView& view )
+{
+    std::unordered_map<uint64_t, Entry>::iterator found = m_Entries.find( key );
+    if ( found != m_Entries.end() && found->second.Valid &&
+         memcmp( &found->second.Tile, &tile, sizeof( ShadowAtlasTile ) ) == 0 &&
+         memcmp( &found->second.ViewProjectionMatrix, &view.ViewProjectionMatrix, sizeof( Float4x4 ) ) == 0 )
+    {
+        found->second.Frame = m_Frame;
+        m_Statistics.Hits++;
+        return false;
+    }
+
+    Entry& entry = m_Entries[key];
+    entry.Frame = m_Frame;
+    entry.Tile = tile;
+    entry.ViewProjectionMatrix = view.ViewProjectionMatrix;
+    entry.WorldFrustum = Frustum( view.ViewProjectionMatrix );
+    entry.Valid = true;
+    m_Statistics.Misses++;
+
+    // The shadow maps that were in the tile are overwritten.
+    for ( std::unordered_map<uint64_t, Entry>::iterator other = m_Entries.begin(); other != m_Entries.end(); ++other )
+    {
+        if ( other->first != key && other->second.Valid && Overlaps( other->second.Tile, tile ) )
+        {
+            other->second.Valid = false;
+        }
+    }
+
+    return true;
+}
+
+void ShadowCache::Invalidate( const BoundingSphere& bounds )
+{
+    for ( std::unordered_map<uint64_t, Entry>::iterator entry = m_Entries.begin(); entry != m_Entries.end(); ++entry )
+    {
+        if ( entry->second.Valid && entry->second.WorldFrustum.Intersects( bounds ) )
+        {
+            entry->second.Valid = false;
+        }
+    }
+}
+
+void ShadowCache::InvalidateAll()
+{
+    for ( std::unordered_map<uint64_t, Entry>::iterator entry = m_Entries.begin(); entry != m_Entries.end(); ++entry )
+    {
+        entry->second.Valid = false;
+    }
+}
+
+size_t ShadowCache::get_NumShadowMaps() const
+{
+    return m_Entries.size();
+}
+
+const ShadowCache::Statistics& ShadowCache::get_Statistics() const
+{
+    return m_Statistics;
+}
@@ -0,0 +1,704 @@
+#include <DirectXTemplateCorePCH.h>
+#include <SoftwareRasterizer.h>
+
+#include <Simd.h>
+
+#include <thread>
+
+using namespace Math;
+
+// Convert a floating-point color value to an 8-bit UNORM value (following the D3D conversion rules).
+static inline uint8_t FloatToUNorm8( float f )
+{
+    f = ( f > 0.0f ) ? ( ( f < 1.0f ) ? f : 1.0f ) : 0.0f;
+    return static_cast<uint8_t>( f * 255.0f + 0.5f );
+}
+
+SoftwareTexture::SoftwareTexture( uint32_t width, uint32_t height, const uint8_t* rgbaTexels )
+    : m_Width( width )
+    , m_Height( height )
+{
+    if ( width == 0 || height == 0 )
+        throw std::invalid_argument( "Texture dimensions must be greater than 0." );
+
+    size_t numValues = static_cast<size_t>( width ) * height * 4;
+    m_Texels.resize( numValues );
+    for ( size_t i = 0; i < numValues; ++i )
+    {
+        m_Texels[i] = rgbaTexels[i] / 255.0f;
+    }
+}
+
+uint32_t SoftwareTexture::get_Width() const
+{
+    return m_Width;
+}
+
+uint32_t SoftwareTexture::get_Height() const
+{
+    return m_Height;
+}
+
+void SoftwareTexture::Sample( float u, float v, float rgba[4] ) const
+{
+    // Texel centers are at half-texel offsets.
+    float x = u * m_Width - 0.5f;
+    float y = v * m_Height - 0.5f;
+    float x0 = std::floor( x );
+    float y0 = std::floor( y );
+    float fx = x - x0;
+    float fy = y - y0;
+
+    // Wrap addressing mode.
+    int w = static_cast<int>( m_Width );
+    int h = static_cast<int>( m_Height );
+    int ix0 = static_cast<int>( std::fmod( x0, static_cast<float>( w ) ) );
+    int iy0 = static_cast<int>( std::fmod( y0, static_cast<float>( h ) ) );
+    if ( ix0 < 0 ) ix0 += w;
+    if ( iy0 < 0 ) iy0 += h;
+    int ix1 = ( ix0 + 1 ) % w;
+    int iy1 = ( iy0 + 1 ) % h;
+
+    const float* t00 = &m_Texels[( iy0 * w + ix0 ) * 4];
+    const float* t10 = &m_Texels[( iy0 * w + ix1 ) * 4];
+    const float* t01 = &m_Texels[( iy1 * w + ix0 ) * 4];
+    const float* t11 = &m_Texels[( iy1 * w + ix1 ) * 4];
+
+    for ( int c = 0; c < 4; ++c )
+    {
+        float top = t00[c] + ( t10[c] - t00[c] ) * fx;
+        float bottom = t01[c] + ( t11[c] - t01[c] ) * fx;
+        rgba[c] = top + ( bottom - top ) * fy;
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer( uint32_t width, uint32_t height, uint32_t numThreads )
+    : m_Width( width )
+    , m_Height( height )
+    , m_NumThreads( 1 )
+    , m_Texture( nullptr )
+    , m_StateDirty( true )
+    , m_LightPropertiesDirty( true )
+    , m_PixelsShaded( 0 )
+{
+    if ( width == 0 || height == 0 )
+        throw std::invalid_argument( "Render target dimensions must be greater than 0." );
+
+    m_TilesX = ( width + TileSize - 1 ) / TileSize;
+    m_TilesY = ( height + TileSize - 1 ) / TileSize;
+
+    m_ColorBuffer.resize( static_cast<size_t>( width ) * height * 4 );
+    // The depth buffer is padded to a whole number of tiles so that the
+    // SIMD loads and stores never cross into a tile owned by another thread.
+    m_DepthBuffer.resize( static_cast<size_t>( get_DepthPitch() ) * height );
+    m_TileBins.resize( m_TilesX * m_TilesY );
+
+    set_NumThreads( numThreads );
+    ResetStatistics();
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{}
+
+uint32_t SoftwareRasterizer::get_Width() const
+{
+    return m_Width;
+}
+
+uint32_t SoftwareRasterizer::get_Height() const
+{
+    return m_Height;
+}
+
+void SoftwareRasterizer::set_NumThreads( uint32_t numThreads )
+{
+    if ( numThreads == 0 )
+    {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    m_NumThreads = std::max<uint32_t>( numThreads, 1 );
+}
+
+uint32_t SoftwareRasterizer::get_NumThreads() const
+{
+    return m_NumThreads;
+}
+
+void SoftwareRasterizer::Clear( const Float4& color, float depth )
+{
+    uint8_t rgba[4] = { FloatToUNorm8( color.x ), FloatToUNorm8( color.y ), FloatToUNorm8( color.z ), FloatToUNorm8( color.w ) };
+    for ( size_t i = 0; i < m_ColorBuffer.size(); i += 4 )
+    {
+        memcpy( &m_ColorBuffer[i], rgba, 4 );
+    }
+    std::fill( m_DepthBuffer.begin(), m_DepthBuffer.end(), depth );
+
+    m_Triangles.clear();
+    for ( auto& bin : m_TileBins )
+    {
+        bin.clear();
+    }
+    m_PipelineStates.clear();
+    m_LightingStates.clear();
+    m_StateDirty = true;
+    m_LightPropertiesDirty = true;
+}
+
+void SoftwareRasterizer::set_MaterialProperties( const MaterialProperties& materialProperties )
+{
+    m_MaterialProperties = materialProperties;
+    m_StateDirty = true;
+}
+
+void SoftwareRasterizer::set_LightProperties( const LightProperties& lightProperties )
+{
+    m_LightProperties = lightProperties;
+    m_LightPropertiesDirty = true;
+}
+
+void SoftwareRasterizer::set_Texture( const SoftwareTexture* texture )
+{
+    m_Texture = texture;
+    m_StateDirty = true;
+}
+
+uint32_t SoftwareRasterizer::GetPipelineState()
+{
+    if ( m_LightPropertiesDirty )
+    {
+        LightingState lightingState;
+        lightingState.Properties = m_LightProperties;
+        for ( int i = 0; i < MAX_LIGHTS; ++i )
+        {
+            lightingState.SpotMinCos[i] = std::cos( m_LightProperties.Lights[i].SpotAngle );
+            lightingState.SpotMaxCos[i] = ( lightingState.SpotMinCos[i] + 1.0f ) / 2.0f;
+        }
+        m_LightingStates.push_back( lightingState );
+        m_LightPropertiesDirty = false;
+        m_StateDirty = true;
+    }
+
+    if ( m_StateDirty )
+    {
+        PipelineState state;
+        state.Material = m_MaterialProperties;
+        state.LightingStateIndex = static_cast<uint32_t>( m_LightingStates.size() - 1 );
+        state.Texture = m_Texture;
+        m_PipelineStates.push_back( state );
+        m_StateDirty = false;
+    }
+
+    return static_cast<uint32_t>( m_PipelineStates.size() - 1 );
+}
+
+void SoftwareRasterizer::DrawIndexed( const VertexCollection& vertices, const IndexCollection& indices, const PerObjectConstants& perObject )
+{
+    // SimpleVertexShader
+    m_ShadedVertices.resize( vertices.size() );
+    for ( size_t i = 0; i < vertices.size(); ++i )
+    {
+        const VertexPositionNormalTexture& in = vertices[i];
+        ShadedVertex& out = m_ShadedVertices[i];
+
+        out.Position = Transform( Float4( in.position, 1.0f ), perObject.WorldViewProjectionMatrix );
+        out.PositionWS = TransformPoint( in.position, perObject.WorldMatrix );
+        out.NormalWS = TransformNormal( in.normal, perObject.InverseTransposeWorldMatrix );
+        out.TexCoord = in.textureCoordinate;
+    }
+
+    SubmitTriangles( m_ShadedVertices, indices );
+}
+
+void SoftwareRasterizer::DrawIndexedInstanced( const VertexCollection& vertices, const IndexCollection& indices,
+    const PerInstanceData* instances, size_t numInstances, const Float4x4& viewProjectionMatrix )
+{
+    // InstancedVertexShader
+    m_ShadedVertices.resize( vertices.size() );
+    for ( size_t instance = 0; instance < numInstances; ++instance )
+    {
+        const PerInstanceData& instanceData = instances[instance];
+        Float4x4 mvp = instanceData.WorldMatrix * viewProjectionMatrix;
+
+        for ( size_t i = 0; i < vertices.size(); ++i )
+        {
+            const VertexPositionNormalTexture& in = vertices[i];
+            ShadedVertex& out = m_ShadedVertices[i];
+
+            out.Position = Transform( Float4( in.position, 1.0f ), mvp );
+            out.PositionWS = TransformPoint( in.position, instanceData.WorldMatrix );
+            out.NormalWS = TransformNormal( in.normal, instanceData.InverseTransposeWorldMatrix );
+            out.TexCoord = in.textureCoordinate;
+        }
+
+        SubmitTriangles( m_ShadedVertices, indices );
+    }
+}
+
+// Linearly interpolate all of the outputs of the vertex shader.
+static inline void LerpVertex( const float* a, const float* b, float t, float* result, size_t numFloats )
+{
+    for ( size_t i = 0; i < numFloats; ++i )
+    {
+        result[i] = a[i] + ( b[i] - a[i] ) * t;
+    }
+}
+
+void SoftwareRasterizer::SubmitTriangles( const std::vector<ShadedVertex>& vertices, const IndexCollection& indices )
+{
+    static_assert( sizeof(ShadedVertex) == 12 * sizeof(float), "ShadedVertex must only contain floats." );
+    const size_t numFloats = sizeof(ShadedVertex) / sizeof(float);
+
+    uint32_t stateIndex = GetPipelineState();
+    m_Statistics.TrianglesSubmitted += indices.size() / 3;
+
+    for ( size_t i = 0; i + 2 < indices.size(); i += 3 )
+    {
+        const ShadedVertex* tri[3] = { &vertices[indices[i]], &vertices[indices[i + 1]], &vertices[indices[i + 2]] };
+
+        // Trivially reject triangles that are completely outside one of the clip planes.
+        bool outside = false;
+        for ( int axis = 0; axis < 3 && !outside; ++axis )
+        {
+            const float* p0 = &tri[0]->Position.x;
+            const float* p1 = &tri[1]->Position.x;
+            const float* p2 = &tri[2]->Position.x;
+            if ( p0[axis] > p0[3] && p1[axis] > p1[3] && p2[axis] > p2[3] ) outside = true;
+            float minimum = ( axis == 2 ) ? 0.0f : -1.0f;
+            if ( p0[axis] < minimum * p0[3] && p1[axis] < minimum * p1[3] && p2[axis] < minimum * p2[3] ) outside = true;
+        }
+        if ( outside ) continue;
+
+        size_t triangleIndex = m_Triangles.size();
+
+        bool needsClipping = false;
+        for ( int v = 0; v < 3; ++v )
+        {
+            const Float4& p = tri[v]->Position;
+            needsClipping |= ( p.z < 0.0f || p.z > p.w );
+        }
+
+        if ( !needsClipping )
+        {
+            SetupTriangle( *tri[0], *tri[1], *tri[2] );
+        }
+        else
+        {
+            // Clip the triangle against the near ( z >= 0 ) and far ( z <= w ) planes.
+            // Each plane can add at most one vertex to the polygon.
+            ShadedVertex polygon[2][5];
+            int count = 3;
+            for ( int v = 0; v < 3; ++v ) polygon[0][v] = *tri[v];
+
+            int src = 0;
+            for ( int plane = 0; plane < 2 && count > 0; ++plane )
+            {
+                int dst = 1 - src;
+                int newCount = 0;
+                for ( int v = 0; v < count; ++v )
+                {
+                    const ShadedVertex& a = polygon[src][v];
+                    const ShadedVertex& b = polygon[src][( v + 1 ) % count];
+                    float da = ( plane == 0 ) ? a.Position.z : a.Position.w - a.Position.z;
+                    float db = ( plane == 0 ) ? b.Position.z : b.Position.w - b.Position.z;
+
+                    if ( da >= 0.0f )
+                    {
+                        polygon[dst][newCount++] = a;
+                    }
+                    if ( ( da >= 0.0f ) != ( db >= 0.0f ) )
+                    {
+                        LerpVertex( &a.Position.x, &b.Position.x, da / ( da - db ), &polygon[dst][newCount++].Position.x, numFloats );
+                    }
+                }
+                count = newCount;
+                src = dst;
+            }
+
+            for ( int v = 1; v + 1 < count; ++v )
+            {
+                SetupTriangle( polygon[src][0], polygon[src][v], polygon[src][v + 1] );
+            }
+        }
+
+        for ( size_t t = triangleIndex; t < m_Triangles.size(); ++t )
+        {
+            m_Triangles[t].StateIndex = stateIndex;
+        }
+    }
+}
+
+void SoftwareRasterizer::SetupTriangle( const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2 )
+{
+    const ShadedVertex* v[3] = { &v0, &v1, &v2 };
+    float x[3], y[3], z[3], invW[3];
+
+    // Perspective divide and viewport transform.
+    for ( int i = 0; i < 3; ++i )
+    {
+        invW[i] = 1.0f / v[i]->Position.w;
+        x[i] = ( v[i]->Position.x * invW[i] * 0.5f + 0.5f ) * m_Width;
+        y[i] = ( 0.5f - v[i]->Position.y * invW[i] * 0.5f ) * m_Height;
+        z[i] = v[i]->Position.z * invW[i];
+    }
+
+    // Clockwise triangles (in render target space) are front facing. Cull the back faces.
+    float area = ( x[1] - x[0] ) * ( y[2] - y[0] ) - ( x[2] - x[0] ) * ( y[1] - y[0] );
+    if ( !( area > 0.0f ) ) return;
+
+    float minX = std::max( std::min( std::min( x[0], x[1] ), x[2] ), 0.0f );
+    float minY = std::max( std::min( std::min( y[0], y[1] ), y[2] ), 0.0f );
+    float maxX = std::min( std::max( std::max( x[0], x[1] ), x[2] ), static_cast<float>( m_Width - 1 ) );
+    float maxY = std::min( std::max( std::max( y[0], y[1] ), y[2] ), static_cast<float>( m_Height - 1 ) );
+    if ( minX > maxX || minY > maxY ) return;
+
+    Triangle triangle;
+    triangle.MinX = static_cast<int>( minX );
+    triangle.MinY = static_cast<int>( minY );
+    triangle.MaxX = static_cast<int>( std::ceil( maxX ) );
+    triangle.MaxY = static_cast<int>( std::ceil( maxY ) );
+    triangle.StateIndex = 0;
+
+    // Edge i goes from vertex i to vertex i + 1.
+    for ( int i = 0; i < 3; ++i )
+    {
+        int j = ( i + 1 ) % 3;
+        Plane& edge = triangle.Edges[i];
+        edge.a = y[i] - y[j];
+        edge.b = x[j] - x[i];
+        edge.c = -( edge.a * x[i] + edge.b * y[i] );
+
+        // Top-left fill rule.
+        triangle.Inclusive[i] = ( edge.a > 0.0f ) || ( edge.a == 0.0f && edge.b > 0.0f );
+    }
+
+    // The barycentric weight of a vertex is the edge function of the opposite edge divided by the area.
+    float invArea = 1.0f / area;
+    const Plane& e0 = triangle.Edges[1];
+    const Plane& e1 = triangle.Edges[2];
+    const Plane& e2 = triangle.Edges[0];
+
+    auto makePlane = [&]( float f0, float f1, float f2 )
+    {
+        Plane p;
+        p.a = ( f0 * e0.a + f1 * e1.a + f2 * e2.a ) * invArea;
+        p.b = ( f0 * e0.b + f1 * e1.b + f2 * e2.b ) * invArea;
+        p.c = ( f0 * e0.c + f1 * e1.c + f2 * e2.c ) * invArea;
+        return p;
+    };
+
+    triangle.Depth = makePlane( z[0], z[1], z[2] );
+    triangle.InvW = makePlane( invW[0], invW[1], invW[2] );
+    for ( int a = 0; a < NumAttributes; ++a )
+    {
+        const float* a0 = &v0.PositionWS.x;
+        const float* a1 = &v1.PositionWS.x;
+        const float* a2 = &v2.PositionWS.x;
+        triangle.Attributes[a] = makePlane( a0[a] * invW[0], a1[a] * invW[1], a2[a] * invW[2] );
+    }
+
+    uint32_t triangleIndex = static_cast<uint32_t>( m_Triangles.size() );
+    m_Triangles.push_back( triangle );
+    m_Statistics.TrianglesRasterized++;
+
+    // Bin the triangle into the tiles that are overlapped by its bounding box.
+    uint32_t tileMinX = triangle.MinX / TileSize;
+    uint32_t tileMinY = triangle.MinY / TileSize;
+    uint32_t tileMaxX = triangle.MaxX / TileSize;
+    uint32_t tileMaxY = triangle.MaxY / TileSize;
+    for ( uint32_t ty = tileMinY; ty <= tileMaxY; ++ty )
+    {
+        for ( uint32_t tx = tileMinX; tx <= tileMaxX; ++tx )
+        {
+            m_TileBins[ty * m_TilesX + tx].push_back( triangleIndex );
+        }
+    }
+}
+
+void SoftwareRasterizer::Flush()
+{
+    if ( m_Triangles.empty() ) return;
+
+    uint32_t numTiles = m_TilesX * m_TilesY;
+    std::atomic<uint32_t> nextTile( 0 );
+
+    auto worker = [&]()
+    {
+        uint32_t tileIndex;
+        while ( ( tileIndex = nextTile.fetch_add( 1 ) ) < numTiles )
+        {
+            RasterizeTile( tileIndex );
+        }
+    };
+
+    std::vector<std::thread> threads;
+    uint32_t numThreads = std::min( m_NumThreads, numTiles );
+    for ( uint32_t i = 1; i < numThreads; ++i )
+    {
+        threads.push_back( std::thread( worker ) );
+    }
+    // The calling thread also rasterizes tiles.
+    worker();
+
+    for ( auto& thread : threads )
+    {
+        thread.join();
+    }
+
+    m_Statistics.PixelsShaded += m_PixelsShaded.exchange( 0 );
+
+    m_Triangles.clear();
+    for ( auto& bin : m_TileBins )
+    {
+        bin.clear();
+    }
+    m_PipelineStates.clear();
+    m_LightingStates.clear();
+    m_StateDirty = true;
+    m_LightPropertiesDirty = true;
+}
+
+void SoftwareRasterizer::RasterizeTile( uint32_t tileIndex )
+{
+    using namespace Simd;
+
+    const std::vector<uint32_t>& bin = m_TileBins[tileIndex];
+    if ( bin.empty() ) return;
+
+    int tileX = static_cast<int>( ( tileIndex % m_TilesX ) * TileSize );
+    int tileY = static_cast<int>( ( tileIndex / m_TilesX ) * TileSize );
+    int tileMaxX = tileX + TileSize - 1;
+    int tileMaxY = std::min<int>( tileY + TileSize, m_Height ) - 1;
+
+    const Float zero = Zero();
+    const Float laneIndex = LaneIndex();
+    const Float width = Set1( static_cast<float>( m_Width ) );
+    const uint32_t depthPitch = get_DepthPitch();
+    uint64_t pixelsShaded = 0;
+
+    for ( uint32_t triangleIndex : bin )
+    {
+        const Triangle& triangle = m_Triangles[triangleIndex];
+        const PipelineState& state = m_PipelineStates[triangle.StateIndex];
+
+        // Start on a SIMD aligned column so the vectors never cross a tile boundary.
+        int minX = std::max( triangle.MinX, tileX ) & ~( Simd::Width - 1 );
+        int maxX = std::min( triangle.MaxX, tileMaxX );
+        int minY = std::max( triangle.MinY, tileY );
+        int maxY = std::min( triangle.MaxY, tileMaxY );
+
+        for ( int y = minY; y <= maxY; ++y )
+        {
+            Float py = Set1( y + 0.5f );
+            float* depthRow = &m_DepthBuffer[y * depthPitch];
+
+            for ( int x = minX; x <= maxX; x += Simd::Width )
+            {
+                Float px = Set1( x + 0.5f ) + laneIndex;
+
+                // Inside test.
+                Float mask = CmpLT( px, width );
+                for ( int e = 0; e < 3; ++e )
+                {
+                    const Plane& edge = triangle.Edges[e];
+                    Float value = Set1( edge.a ) * px + Set1( edge.b ) * py + Set1( edge.c );
+                    mask = And( mask, triangle.Inclusive[e] ? CmpGE( value, zero ) : CmpGT( value, zero ) );
+                }
+                if ( MoveMask( mask ) == 0 ) continue;
+
+                // Depth test (D3D11_COMPARISON_LESS).
+                Float z = Set1( triangle.Depth.a ) * px + Set1( triangle.Depth.b ) * py + Set1( triangle.Depth.c );
+                Float depth = LoadUnaligned( depthRow + x );
+                mask = And( mask, CmpLT( z, depth ) );
+
+                int laneMask = MoveMask( mask );
+                if ( laneMask == 0 ) continue;
+
+                StoreUnaligned( depthRow + x, Select( mask, z, depth ) );
+
+                ShadePixels( state, triangle, x, y, laneMask );
+
+                for ( int bits = laneMask; bits; bits &= bits - 1 )
+                {
+                    ++pixelsShaded;
+                }
+            }
+        }
+    }
+
+    m_PixelsShaded.fetch_add( pixelsShaded );
+}
+
+void SoftwareRasterizer::ShadePixels( const PipelineState& state, const Triangle& triangle, int x, int y, int laneMask )
+{
+    using namespace Simd;
+
+    Float px = Set1( x + 0.5f ) + LaneIndex();
+    Float py = Set1( y + 0.5f );
+    const Float zero = Zero();
+
+    // Perspective-correct interpolation of the vertex attributes.
+    Float w = Set1( 1.0f ) / ( Set1( triangle.InvW.a ) * px + Set1( triangle.InvW.b ) * py + Set1( triangle.InvW.c ) );
+    Float attributes[NumAttributes];
+    for ( int a = 0; a < NumAttributes; ++a )
+    {
+        const Plane& plane = triangle.Attributes[a];
+        attributes[a] = ( Set1( plane.a ) * px + Set1( plane.b ) * py + Set1( plane.c ) ) * w;
+    }
+
+    Simd::Float3 P( attributes[0], attributes[1], attributes[2] );
+    Simd::Float3 N = Normalize( Simd::Float3( attributes[3], attributes[4], attributes[5] ) );
+
+    const _Material& material = state.Material.Material;
+    const LightingState& lightingState = m_LightingStates[state.LightingStateIndex];
+    const LightProperties& lightProperties = lightingState.Properties;
+
+    // ComputeLighting
+    Simd::Float3 eye( Set1( lightProperties.EyePosition.x ), Set1( lightProperties.EyePosition.y ), Set1( lightProperties.EyePosition.z ) );
+    Simd::Float3 V = Normalize( eye - P );
+
+    Float diffuse[4] = { zero, zero, zero, zero };
+    Float specular[4] = { zero, zero, zero, zero };
+
+    for ( int i = 0; i < MAX_LIGHTS; ++i )
+    {
+        const Light& light = lightProperties.Lights[i];
+        if ( !light.Enabled ) continue;
+
+        Simd::Float3 L;
+        Float intensity = Set1( 1.0f );
+
+        switch ( light.LightType )
+        {
+        case DirectionalLight:
+            {
+                L = Simd::Float3( Set1( -light.Direction.x ), Set1( -light.Direction.y ), Set1( -light.Direction.z ) );
+            }
+            break;
+        case PointLight:
+        case SpotLight:
+            {
+                L = Simd::Float3( Set1( light.Position.x ), Set1( light.Position.y ), Set1( light.Position.z ) ) - P;
+                Float distance = Sqrt( Dot( L, L ) );
+                L = L * ( Set1( 1.0f ) / distance );
+
+                // DoAttenuation
+                intensity = Set1( 1.0f ) / ( Set1( light.ConstantAttenuation ) + Set1( light.LinearAttenuation ) * distance
+                    + Set1( light.QuadraticAttenuation ) * distance * distance );
+                intensity = And( CmpLE( distance, Set1( light.Range ) ), intensity );
+
+                if ( light.LightType == SpotLight )
+                {
+                    // DoSpotCone
+                    Simd::Float3 direction( Set1( light.Direction.x ), Set1( light.Direction.y ), Set1( light.Direction.z ) );
+                    Float cosAngle = Dot( direction, -L );
+                    intensity = intensity * SmoothStep( Set1( lightingState.SpotMinCos[i] ), Set1( lightingState.SpotMaxCos[i] ), cosAngle );
+                }
+            }
+            break;
+        default:
+            continue;
+        }
+
+        // DoDiffuse
+        Float NdotL = Dot( N, L );
+        Float diffuseIntensity = Max( zero, NdotL ) * intensity;
+
+        // DoSpecular (Phong): R = reflect( -L, N ).
+        Simd::Float3 R = Normalize( N * ( NdotL + NdotL ) - L );
+        Float RdotV = Max( zero, Dot( R, V ) );
+        Float specularIntensity = Pow( RdotV, material.SpecularPower ) * intensity;
+
+        const float* color = &light.Color.x;
+        for ( int c = 0; c < 4; ++c )
+        {
+            diffuse[c] += Set1( color[c] ) * diffuseIntensity;
+            specular[c] += Set1( color[c] ) * specularIntensity;
+        }
+    }
+
+    // Sample the texture.
+    Float texColor[4] = { Set1( 1.0f ), Set1( 1.0f ), Set1( 1.0f ), Set1( 1.0f ) };
+    if ( material.UseTexture )
+    {
+        SIMD_ALIGN(32) float u[Simd::Width];
+        SIMD_ALIGN(32) float v[Simd::Width];
+        SIMD_ALIGN(32) float texels[4][Simd::Width] = {};
+        Store( u, attributes[6] );
+        Store( v, attributes[7] );
+
+        // An unbound texture returns 0 (like D3D11).
+        if ( state.Texture )
+        {
+            for ( int lane = 0; lane < Simd::Width; ++lane )
+            {
+                if ( ( laneMask & ( 1 << lane ) ) == 0 ) continue;
+
+                float rgba[4];
+                state.Texture->Sample( u[lane], v[lane], rgba );
+                for ( int c = 0; c < 4; ++c )
+                {
+                    texels[c][lane] = rgba[c];
+                }
+            }
+        }
+
+        for ( int c = 0; c < 4; ++c )
+        {
+            texColor[c] = Load( texels[c] );
+        }
+    }
+
+    const float* emissive = &material.Emissive.x;
+    const float* ambient = &material.Ambient.x;
+    const float* materialDiffuse = &material.Diffuse.x;
+    const float* materialSpecular = &material.Specular.x;
+    const float* globalAmbient = &lightProperties.GlobalAmbient.x;
+
+    SIMD_ALIGN(32) float finalColor[4][Simd::Width];
+    for ( int c = 0; c < 4; ++c )
+    {
+        Float color = Set1( emissive[c] + ambient[c] * globalAmbient[c] )
+            + Set1( materialDiffuse[c] ) * Saturate( diffuse[c] )
+            + Set1( materialSpecular[c] ) * Saturate( specular[c] );
+        Store( finalColor[c], color * texColor[c] );
+    }
+
+    uint8_t* row = &m_ColorBuffer[( static_cast<size_t>( y ) * m_Width + x ) * 4];
+    for ( int lane = 0; lane < Simd::Width; ++lane )
+    {
+        if ( ( laneMask & ( 1 << lane ) ) == 0 ) continue;
+
+        uint8_t* pixel = row + lane * 4;
+        for ( int c = 0; c < 4; ++c )
+        {
+            pixel[c] = FloatToUNorm8( finalColor[c][lane] );
+        }
+    }
+}
+
+const std::vector<uint8_t>& SoftwareRasterizer::get_ColorBuffer() const
+{
+    return m_ColorBuffer;
+}
+
+const std::vector<float>& SoftwareRasterizer::get_DepthBuffer() const
+{
+    return m_DepthBuffer;
+}
+
+uint32_t SoftwareRasterizer::get_DepthPitch() const
+{
+    return m_TilesX * TileSize;
+}
+
+const SoftwareRasterizer::Statistics& SoftwareRasterizer::get_Statistics() const
+{
+    return m_Statistics;
+}
+
+void SoftwareRasterizer::ResetStatistics()
+{
+    m_Statistics.TrianglesSubmitted = 0;
+    m_Statistics.TrianglesRasterized = 0;
+    m_Statistics.PixelsShaded = 0;
+}
@@ -0,0 +1,178 @@
+#include <DirectXTemplateCorePCH.h>
+#include <StateCache.h>
+
+StateCache::StateCache( RenderContext& renderContext )
+    : m_RenderContext( renderContext )
+{
+    Invalidate();
+    ResetStatistics();
+}
+
+StateCache::~StateCache()
+{}
+
+void StateCache::Invalidate()
+{
+    m_InputLayoutValid = false;
+    m_PrimitiveTopologyValid = false;
+    m_IndexBufferValid = false;
+    m_VertexShaderValid = false;
+    m_RasterizerStateValid = false;
+    m_PixelShaderValid = false;
+    m_DepthStencilStateValid = false;
+    m_BlendStateValid = false;
+
+    std::fill( m_VertexBuffersValid, m_VertexBuffersValid + MaxVertexBuffers, false );
+    std::fill( m_VSConstantBuffersValid, m_VSConstantBuffersValid + MaxConstantBuffers, false );
+    std::fill( m_PSConstantBuffersValid, m_PSConstantBuffersValid + MaxConstantBuffers, false );
+    std::fill( m_PSShaderResourcesValid, m_PSShaderResourcesValid + MaxShaderResources, false );
+}
+
+template<typename T>
+bool StateCache::Update( T& shadowValue, bool& valid, const T& value )
+{
+    if ( valid && shadowValue == value )
+    {
+        m_Statistics.StateChangesAvoided++;
+        return false;
+    }
+
+    shadowValue = value;
+    valid = true;
+    m_Statistics.StateChanges++;
+    return true;
+}
+
+void StateCache::SetInputLayout( StateHandle inputLayout )
+{
+    if ( Update( m_InputLayout, m_InputLayoutValid, inputLayout ) )
+    {
+        m_RenderContext.SetInputLayout( inputLayout );
+    }
+}
+
+void StateCache::SetPrimitiveTopology( uint32_t primitiveTopology )
+{
+    if ( Update( m_PrimitiveTopology, m_PrimitiveTopologyValid, primitiveTopology ) )
+    {
+        m_RenderContext.SetPrimitiveTopology( primitiveTopology );
+    }
+}
+
+void StateCache::SetVertexBuffer( uint32_t slot, const VertexBufferBinding& vertexBuffer )
+{
+    assert( slot < MaxVertexBuffers );
+
+    if ( Update( m_VertexBuffers[slot], m_VertexBuffersValid[slot], vertexBuffer ) )
+    {
+        m_RenderContext.SetVertexBuffer( slot, vertexBuffer );
+    }
+}
+
+void StateCache::SetIndexBuffer( StateHandle indexBuffer, uint32_t indexFormat )
+{
+    if ( m_IndexBufferValid && m_IndexBuffer == indexBuffer && m_IndexFormat == indexFormat )
+    {
+        m_Statistics.StateChangesAvoided++;
+        return;
+    }
+
+    m_IndexBuffer = indexBuffer;
+    m_IndexFormat = indexFormat;
+    m_IndexBufferValid = true;
+    m_Statistics.StateChanges++;
+
+    m_RenderContext.SetIndexBuffer( indexBuffer, indexFormat );
+}
+
+void StateCache::SetVertexShader( StateHandle vertexShader )
+{
+    if ( Update( m_VertexShader, m_VertexShaderValid, vertexShader ) )
+    {
+        m_RenderContext.SetVertexShader( vertexShader );
+    }
+}
+
+void StateCache::SetVSConstantBuffer( uint32_t slot, const ConstantBufferBinding& constantBuffer )
+{
+    assert( slot < MaxConstantBuffers );
+
+    if ( Update( m_VSConstantBuffers[slot], m_VSConstantBuffersValid[slot], constantBuffer ) )
+    {
+        m_RenderContext.SetVSConstantBuffer( slot, constantBuffer );
+    }
+}
+
+void StateCache::SetRasterizerState( StateHandle rasterizerState )
+{
+    if ( Update( m_RasterizerState, m_RasterizerStateValid, rasterizerState ) )
+    {
+        m_RenderContext.SetRasterizerState( rasterizerState );
+    }
+}
+
+void StateCache::SetPixelShader( StateHandle pixelShader )
+{
+    if ( Update( m_PixelShader, m_PixelShaderValid, pixelShader ) )
+    {
+        m_RenderContext.SetPixelShader( pixelShader );
+    }
+}
+
+void StateCache::SetPSConstantBuffer( uint32_t slot, const ConstantBufferBinding& constantBuffer )
+{
+    assert( slot < MaxConstantBuffers );
+
+    if ( Update( m_PSConstantBuffers[slot], m_PSConstantBuffersValid[slot], constantBuffer ) )
+    {
+        m_RenderContext.SetPSConstantBuffer( slot, constantBuffer );
+    }
+}
+
+void StateCache::SetPSShaderResource( uint32_t slot, StateHandle shaderResourceView )
+{
+    assert( slot < MaxShaderResources );
+
+    if ( Update( m_PSShaderResources[slot], m_PSShaderResourcesValid[slot], shaderResourceView ) )
+    {
+        m_RenderContext.SetPSShaderResource( slot, shaderResourceView );
+    }
+}
+
+void StateCache::SetDepthStencilState( StateHandle depthStencilState )
+{
+    if ( Update( m_DepthStencilState, m_DepthStencilStateValid, depthStencilState ) )
+    {
+        m_RenderContext.SetDepthStencilState( depthStencilState );
+    }
+}
+
+void StateCache::SetBlendState( StateHandle blendState )
+{
+    if ( Update( m_BlendState, m_BlendStateValid, blendState ) )
+    {
+        m_RenderContext.SetBlendState( blendState );
+    }
+}
+
+void StateCache::DrawIndexed( uint32_t indexCount, uint32_t startIndex, int32_t baseVertex )
+{
+    m_Statistics.DrawCalls++;
+    m_RenderContext.DrawIndexed( indexCount, startIndex, baseVertex );
+}
+
+void StateCache::DrawIndexedInstanced( uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance )
+{
+    m_Statistics.DrawCalls++;
+    m_RenderContext.DrawIndexedInstanced( indexCount, instanceCount, startIndex, baseVertex, startInstance );
+}
+
+const StateCache::Statistics& StateCache::get_Statistics() const
+{
+    return m_Statistics;
+}
+
+void StateCache::ResetStatistics()
+{
+    memset( &m_Statistics, 0, sizeof(Statistics) );
+}
@@ -0,0 +1,538 @@
+#include <DirectXTemplateCorePCH.h>
+#include <TiledDeferred.h>
+
+#include <JobSystem.h>
+#include <Simd.h>
+#include <VertexFormats.h>
+
+#include <limits>
+
+using namespace Math;
+
+namespace
+{
+    const float Infinity = std::numeric_limits<float>::infinity();
+
+    inline float Saturate( float value )
+    {
+        return std::min( std::max( value, 0.0f ), 1.0f );
+    }
+
+    // The DXGI float to UNORM conversion (round to nearest).
+    inline uint32_t EncodeUnorm8( float value )
+    {
+        return static_cast<uint32_t>( Saturate( value ) * 255.0f + 0.5f );
+    }
+
+    inline float DecodeUnorm8( uint32_t value )
+    {
+        return ( value & 0xFF ) / 255.0f;
+    }
+
+    // R8G8B8A8_UNORM (R in the lowest byte).
+    uint32_t EncodeColor( const Float3& color, float alpha )
+    {
+        return EncodeUnorm8( color.x ) | ( EncodeUnorm8( color.y ) << 8 ) | ( EncodeUnorm8( color.z ) << 16 ) | ( EncodeUnorm8( alpha ) << 24 );
+    }
+
+    Float3 DecodeColor( uint32_t color )
+    {
+        return Float3( DecodeUnorm8( color ), DecodeUnorm8( color >> 8 ), DecodeUnorm8( color >> 16 ) );
+    }
+
+    inline Float3 Saturate( const Float3& value )
+    {
+        return Float3( Saturate( value.x ), Saturate( value.y ), Saturate( value.z ) );
+    }
+
+    struct LightingResult
+    {
+        Float3 Diffuse;
+        Float3 Specular;
+    };
+
+    // The lighting functions of TexturedLitPixelShader.hlsl for one light.
+    bool DoLight( const Light& light, const Float3& V, const Float3& P, const Float3& N, float specularPower, LightingResult& result )
+    {
+        Float3 L;
+        float intensity = 1.0f;
+
+        switch ( light.LightType )
+        {
+        case DirectionalLight:
+            {
+                L = -XYZ( light.Direction );
+            }
+            break;
+        case PointLight:
+        case SpotLight:
+            {
+                L = XYZ( light.Position ) - P;
+                float distance = Length( L );
+                L = L / distance;
+
+                // DoAttenuation
+                intensity = ( distance <= light.Range ) ? 1.0f / ( light.ConstantAttenuation + light.LinearAttenuation * distance
+                    + light.QuadraticAttenuation * distance * distance ) : 0.0f;
+
+                if ( light.LightType == SpotLight )
+                {
+                    // DoSpotCone
+                    float minCos = std::cos( light.SpotAngle );
+                    float maxCos = ( minCos + 1.0f ) / 2.0f;
+                    float t = Saturate( ( Dot( XYZ( light.Direction ), -L ) - minCos ) / ( maxCos - minCos ) );
+                    intensity *= t * t * ( 3.0f - 2.0f * t );
+                }
+            }
+            break;
+        default:
+            return false;
+        }
+
+        // DoDiffuse
+        float NdotL = Dot( N, L );
+        float diffuseIntensity = std::max( 0.0f, NdotL ) * intensity;
+
+        // DoSpecular (Phong): R = reflect( -L, N ).
+        Float3 R = Normalize( N * ( NdotL + NdotL ) - L );
+        float RdotV = std::max( 0.0f, Dot( R, V ) );
+        float specularIntensity = std::pow( RdotV, specularPower ) * intensity;
+
+        Float3 color = XYZ( light.Color );
+        result.Diffuse = color * diffuseIntensity;
+        result.Specular = color * specularIntensity;
+        return true;
+    }
+}
+
+GBufferTexel EncodeGBuffer( const _Material& material, const Float4& texColor, const Float3& normal, const Float4& globalAmbient )
+{
+    Float3 color = XYZ( texColor );
+    float specularPower = std::log2( std::max( material.SpecularPower, 1.0f ) ) / std::log2( MaxSpecularPower );
+
+    GBufferTexel texel;
+    texel.Albedo = EncodeColor( XYZ( material.Diffuse ) * color, specularPower );
+    texel.Specular = EncodeColor( XYZ( material.Specular ) * color, 0.0f );
+    EncodeOctahedral( normal, texel.Normal );
+    texel.Ambient = EncodeColor( ( XYZ( material.Emissive ) + XYZ( material.Ambient ) * XYZ( globalAmbient ) ) * color, 1.0f );
+    return texel;
+}
+
+GBufferSample DecodeGBuffer( const GBufferTexel& texel )
+{
+    GBufferSample sample;
+    sample.Albedo = DecodeColor( texel.Albedo );
+    sample.Specular = DecodeColor( texel.Specular );
+    sample.SpecularPower = std::exp2( DecodeUnorm8( texel.Albedo >> 24 ) * std::log2( MaxSpecularPower ) );
+    sample.Normal = DecodeOctahedral( texel.Normal );
+    sample.Ambient = DecodeColor( texel.Ambient );
+    return sample;
+}
+
+Float3 ShadeForward( const _Material& material, const Float4& texColor, const Float3& position,
+    const Float3& normal, const Float3& eyePosition, const Float4& globalAmbient, const std::vector<Light>& lights )
+{
+    Float3 V = Normalize( eyePosition - position );
+
+    LightingResult total = { Float3( 0.0f, 0.0f, 0.0f ), Float3( 0.0f, 0.0f, 0.0f ) };
+    for ( const Light& light : lights )
+    {
+        LightingResult result;
+        if ( light.Enabled && DoLight( light, V, position, normal, material.SpecularPower, result ) )
+        {
+            total.Diffuse += result.Diffuse;
+            total.Specular += result.Specular;
+        }
+    }
+
+    Float3 color = XYZ( material.Emissive ) + XYZ( material.Ambient ) * XYZ( globalAmbient ) +
+        XYZ( material.Diffuse ) * Saturate( total.Diffuse ) + XYZ( material.Specular ) * Saturate( total.Specular );
+    return color * XYZ( texColor );
+}
+
+Float3 ShadeGBuffer( const GBufferSample& sample, const Float3& position, const Float3& eyePosition,
+    const std::vector<Light>& lights, const uint32_t* lightIndices, size_t numLightIndices )
+{
+    Float3 V = Normalize( eyePosition - position );
+
+    LightingResult total = { Float3( 0.0f, 0.0f, 0.0f ), Float3( 0.0f, 0.0f, 0.0f ) };
+    for ( size_t i = 0; i < numLightIndices; ++i )
+    {
+        const Light& light = lights[lightIndices[i]];
+        LightingResult result;
+        if ( light.Enabled && DoLight( light, V, position, sample.Normal, sample.SpecularPower, result ) )
+        {
+            total.Diffuse += result.Diffuse;
+            total.Specular += result.Specular;
+        }
+    }
+
+    return sample.Ambient + sample.Albedo * Saturate( total.Diffuse ) + sample.Specular * Saturate( total.Specular );
+}
+
+TiledDeferredConstants ComputeTiledDeferredConstants( const Camera& camera, uint32_t screenWidth, uint32_t screenHeight, uint32_t numLights )
+{
+    const Float4x4& projectionMatrix = camera.get_ProjectionMatrix();
+
+    TiledDeferredConstants constants = {};
+    constants.InverseViewMatrix = camera.get_InverseViewMatrix();
+    constants.EyePosition = Float4( camera.get_Translation(), 1.0f );
+    constants.ProjectionScaleX = projectionMatrix.m[0][0];
+    constants.ProjectionScaleY = projectionMatrix.m[1][1];
+    constants.DepthScale = projectionMatrix.m[3][2];
+    constants.DepthBias = projectionMatrix.m[2][2];
+    constants.ScreenWidth = screenWidth;
+    constants.ScreenHeight = screenHeight;
+    constants.NumLights = numLights;
+    return constants;
+}
+
+TiledLightCulling::TiledLightCulling( uint32_t width, uint32_t height )
+    : m_Width( 0 )
+    , m_Height( 0 )
+    , m_NumTilesX( 0 )
+    , m_NumTilesY( 0 )
+    , m_ProjectionMatrix( MatrixPerspectiveFovLH( ConvertToRadians( 45.0f ), 16.0f / 9.0f, 0.1f, 100.0f ) )
+    , m_NumLights( 0 )
+    , m_NumOverflowTiles( 0 )
+{
+    Resize( width, height );
+}
+
+void TiledLightCulling::Resize( uint32_t width, uint32_t height )
+{
+    if ( width == 0 || height == 0 )
+    {
+        throw std::invalid_argument( "The screen must be at least one pixel wide and high." );
+    }
+
+    m_Width = width;
+    m_Height = height;
+    m_NumTilesX = ( width + TileSize - 1 ) / TileSize;
+    m_NumTilesY = ( height + TileSize - 1 ) / TileSize;
+
+    m_TileMinDepth.assign( get_NumTiles(), Infinity );
+    m_TileMaxDepth.assign( get_NumTiles(), -Infinity );
+    m_RowIndices.resize( m_NumTilesY );
+    m_Tiles.assign( get_NumTiles(), LightCluster() );
+    m_LightIndices.clear();
+
+    UpdatePlanes();
+}
+
+uint32_t TiledLightCulling::get_Width() const
+{
+    return m_Width;
+}
+
+uint32_t TiledLightCulling::get_Height() const
+{
+    return m_Height;
+}
+
+uint32_t TiledLightCulling::get_NumTilesX() const
+{
+    return m_NumTilesX;
+}
+
+uint32_t TiledLightCulling::get_NumTilesY() const
+{
+    return m_NumTilesY;
+}
+
+uint32_t TiledLightCulling::get_NumTiles() const
+{
+    return m_NumTilesX * m_NumTilesY;
+}
+
+void TiledLightCulling::SetProjection( const Float4x4& projectionMatrix )
+{
+    if ( !( projectionMatrix.m[0][0] > 0.0f && projectionMatrix.m[1][1] > 0.0f && projectionMatrix.m[2][3] == 1.0f ) )
+    {
+        throw std::invalid_argument( "The tiles need a left-handed perspective projection." );
+    }
+
+    m_ProjectionMatrix = projectionMatrix;
+    UpdatePlanes();
+}
+
+void TiledLightCulling::SetProjection( const Camera& camera )
+{
+    SetProjection( camera.get_ProjectionMatrix() );
+}
+
+void TiledLightCulling::UpdatePlanes()
+{
+    // The slopes (x / z and y / z) of the planes at the pixel edges of the tiles. Row 0 is at the top.
+    float tanX = 1.0f / m_ProjectionMatrix.m[0][0];
+    float tanY = 1.0f / m_ProjectionMatrix.m[1][1];
+
+    m_PlaneX.resize( m_NumTilesX + 1 );
+    m_PlaneXZ.resize( m_NumTilesX + 1 );
+    for ( uint32_t k = 0; k <= m_NumTilesX; ++k )
+    {
+        float slope = ( 2.0f * std::min( k * TileSize, m_Width ) / m_Width - 1.0f ) * tanX;
+        float length = std::sqrt( 1.0f + slope * slope );
+        m_PlaneX[k] = 1.0f / length;
+        m_PlaneXZ[k] = -slope / length;
+    }
+
+    m_PlaneY.resize( m_NumTilesY + 1 );
+    m_PlaneYZ.resize( m_NumTilesY + 1 );
+    for ( uint32_t k = 0; k <= m_NumTilesY; ++k )
+    {
+        float slope = ( 1.0f - 2.0f * std::min( k * TileSize, m_Height ) / m_Height ) * tanY;
+        float length = std::sqrt( 1.0f + slope * slope );
+        m_PlaneY[k] = -1.0f / length;
+        m_PlaneYZ[k] = slope / length;
+    }
+}
+
+float TiledLightCulling::ViewDepth( float depth ) const
+{
+    return m_ProjectionMatrix.m[3][2] / ( depth - m_ProjectionMatrix.m[2][2] );
+}
+
+void TiledLightCulling::CullLights( const float* depthBuffer, uint32_t depthPitch, const BoundingSphereArrays& lights, JobSystem* jobSystem )
+{
+    assert( depthBuffer && depthPitch >= m_Width );
+
+    // Copy the lights to arrays that can be loaded Simd::Width lights at a time. The
+    // padding spheres have a radius of -infinity so they are never inside a tile.
+    m_NumLights = lights.Size();
+    size_t paddedSize = ( m_NumLights + Simd::Width - 1 ) / Simd::Width * Simd::Width;
+    m_CenterX.assign( lights.CenterX.begin(), lights.CenterX.end() );
+    m_CenterY.assign( lights.CenterY.begin(), lights.CenterY.end() );
+    m_CenterZ.assign( lights.CenterZ.begin(), lights.CenterZ.end() );
+    m_Radius.assign( lights.Radius.begin(), lights.Radius.end() );
+    m_CenterX.resize( paddedSize, 0.0f );
+    m_CenterY.resize( paddedSize, 0.0f );
+    m_CenterZ.resize( paddedSize, 0.0f );
+    m_Radius.resize( paddedSize, -Infinity );
+
+    if ( jobSystem )
+    {
+        jobSystem->ParallelFor( 0, m_NumTilesY, 1, [&]( size_t begin, size_t end )
+        {
+            for ( size_t row = begin; row < end; ++row )
+            {
+                ComputeDepthBounds( depthBuffer, depthPitch, static_cast<uint32_t>( row ) );
+                CullRow( static_cast<uint32_t>( row ) );
+            }
+        } );
+    }
+    else
+    {
+        for ( uint32_t row = 0; row < m_NumTilesY; ++row )
+        {
+            ComputeDepthBounds( depthBuffer, depthPitch, row );
+            CullRow( row );
+        }
+    }
+
+    // Concatenate the lists of the rows. The offsets of the tiles are relative to their row.
+    size_t numIndices = 0;
+    for ( const std::vector<uint32_t>& rowIndices : m_RowIndices )
+    {
+        numIndices += rowIndices.size();
+    }
+    m_LightIndices.resize( numIndices );
+
+    uint32_t offset = 0;
+    m_NumOverflowTiles = 0;
+    for ( uint32_t row = 0; row < m_NumTilesY; ++row )
+    {
+        std::copy( m_RowIndices[row].begin(), m_RowIndices[row].end(), m_LightIndices.begin() + offset );
+        for ( uint32_t x = 0; x < m_NumTilesX; ++x )
+        {
+            LightCluster& tile = m_Tiles[row * m_NumTilesX + x];
+            tile.Offset += offset;
+            m_NumOverflowTiles += ( tile.Count > MaxLightsPerTile ) ? 1 : 0;
+        }
+        offset += static_cast<uint32_t>( m_RowIndices[row].size() );
+    }
+}
+
+void TiledLightCulling::ComputeDepthBounds( const float* depthBuffer, uint32_t depthPitch, uint32_t row )
+{
+    using namespace Simd;
+
+    SIMD_ALIGN(32) float minimum[Width];
+    SIMD_ALIGN(32) float maximum[Width];
+
+    const Float one = Set1( 1.0f );
+    const Float positiveInfinity = Set1( Infinity );
+    const Float negativeInfinity = Set1( -Infinity );
+
+    uint32_t firstY = row * TileSize;
+    uint32_t lastY = std::min( firstY + TileSize, m_Height );
+    for ( uint32_t tx = 0; tx < m_NumTilesX; ++tx )
+    {
+        uint32_t firstX = tx * TileSize;
+        uint32_t lastX = std::min( firstX + TileSize, m_Width );
+        uint32_t lastSimdX = firstX + ( lastX - firstX ) / Width * Width;
+
+        // The clear depth of 1 does not extend the bounds.
+        Float minDepth = positiveInfinity;
+        Float maxDepth = negativeInfinity;
+        float scalarMin = Infinity;
+        float scalarMax = -Infinity;
+        for ( uint32_t y = firstY; y < lastY; ++y )
+        {
+            const float* depths = depthBuffer + static_cast<size_t>( y ) * depthPitch;
+            for ( uint32_t x = firstX; x < lastSimdX; x += Width )
+            {
+                Float depth = LoadUnaligned( depths + x );
+                Float geometry = CmpLT( depth, one );
+                minDepth = Min( minDepth, Select( geometry, depth, positiveInfinity ) );
+                maxDepth = Max( maxDepth, Select( geometry, depth, negativeInfinity ) );
+            }
+            for ( uint32_t x = lastSimdX; x < lastX; ++x )
+            {
+                if ( depths[x] < 1.0f )
+                {
+                    scalarMin = std::min( scalarMin, depths[x] );
+                    scalarMax = std::max( scalarMax, depths[x] );
+                }
+            }
+        }
+
+        Store( minimum, minDepth );
+        Store( maximum, maxDepth );
+        for ( int lane = 0; lane < Width; ++lane )
+        {
+            scalarMin = std::min( scalarMin, minimum[lane] );
+            scalarMax = std::max( scalarMax, maximum[lane] );
+        }
+
+        uint32_t tile = row * m_NumTilesX + tx;
+        if ( scalarMin <= scalarMax )
+        {
+            m_TileMinDepth[tile] = ViewDepth( scalarMin );
+            m_TileMaxDepth[tile] = ViewDepth( scalarMax );
+        }
+        else
+        {
+            m_TileMinDepth[tile] = Infinity;
+            m_TileMaxDepth[tile] = -Infinity;
+        }
+    }
+}
+
+void TiledLightCulling::CullRow( uint32_t row )
+{
+    using namespace Simd;
+
+    std::vector<uint32_t>& rowIndices = m_RowIndices[row];
+    rowIndices.clear();
+
+    const Float top = Set1( m_PlaneY[row] );
+    const Float topZ = Set1( m_PlaneYZ[row] );
+    const Float bottom = Set1( m_PlaneY[row + 1] );
+    const Float bottomZ = Set1( m_PlaneYZ[row + 1] );
+
+    for ( uint32_t tx = 0; tx < m_NumTilesX; ++tx )
+    {
+        uint32_t tileIndex = row * m_NumTilesX + tx;
+        LightCluster& tile = m_Tiles[tileIndex];
+        tile.Offset = static_cast<uint32_t>( rowIndices.size() );
+
+        // A tile without geometry has no lights.
+        if ( m_TileMinDepth[tileIndex] <= m_TileMaxDepth[tileIndex] )
+        {
+            const Float left = Set1( m_PlaneX[tx] );
+            const Float leftZ = Set1( m_PlaneXZ[tx] );
+            const Float right = Set1( m_PlaneX[tx + 1] );
+            const Float rightZ = Set1( m_PlaneXZ[tx + 1] );
+            const Float minDepth = Set1( m_TileMinDepth[tileIndex] );
+            const Float maxDepth = Set1( m_TileMaxDepth[tileIndex] );
+
+            for ( size_t l = 0; l < m_Radius.size(); l += Width )
+            {
+                Float cx = LoadUnaligned( &m_CenterX[l] );
+                Float cy = LoadUnaligned( &m_CenterY[l] );
+                Float cz = LoadUnaligned( &m_CenterZ[l] );
+                Float radius = LoadUnaligned( &m_Radius[l] );
+                Float negativeRadius = -radius;
+
+                Float inside = And( CmpGE( cx * left + cz * leftZ, negativeRadius ), CmpLE( cx * right + cz * rightZ, radius ) );
+                inside = And( inside, And( CmpGE( cy * top + cz * topZ, negativeRadius ), CmpLE( cy * bottom + cz * bottomZ, radius ) ) );
+                inside = And( inside, And( CmpGE( cz + radius, minDepth ), CmpLE( cz - radius, maxDepth ) ) );
+
+                int mask = MoveMask( inside );
+                for ( uint32_t lane = 0; mask != 0; ++lane, mask >>= 1 )
+                {
+                    if ( mask & 1 )
+                    {
+                        rowIndices.push_back( static_cast<uint32_t>( l + lane ) );
+                    }
+                }
+            }
+        }
+
+        tile.Count = static_cast<uint32_t>( rowIndices.size() ) - tile.Offset;
+    }
+}
+
+const std::vector<LightCluster>& TiledLightCulling::get_Tiles() const
+{
+    return m_Tiles;
+}
+
+const std::vector<uint32_t>& TiledLightCulling::get_LightIndices() const
+{
+    return m_LightIndices;
+}
+
+uint32_t TiledLightCulling::GetTileIndex( uint32_t x, uint32_t y ) const
+{
+    assert( x < m_NumTilesX && y < m_NumTilesY );
+    return y * m_NumTilesX + x;
+}
+
+void TiledLightCulling::GetTileDepthBounds( uint32_t tileIndex, float& minDepth, float& maxDepth ) const
+{
+    assert( tileIndex < get_NumTiles() );
+    minDepth = m_TileMinDepth[tileIndex];
+    maxDepth = m_TileMaxDepth[tileIndex];
+}
+
+bool TiledLightCulling::Intersects( const BoundingSphere& sphere, uint32_t tileIndex ) const
+{
+    assert( tileIndex < get_NumTiles() );
+
+    uint32_t x = tileIndex % m_NumTilesX;
+    uint32_t y = tileIndex / m_NumTilesX;
+    if ( !( m_TileMinDepth[tileIndex] <= m_TileMaxDepth[tileIndex] ) )
+    {
+        return false;
+    }
+
+    // The same operations as CullLights so that the results are identical.
+    const Float3& c = sphere.Center;
+    float r = sphere.Radius;
+    return c.x * m_PlaneX[x] + c.z * m_PlaneXZ[x] >= -r && c.x * m_PlaneX[x + 1] + c.z * m_PlaneXZ[x + 1] <= r &&
+           c.y * m_PlaneY[y] + c.z * m_PlaneYZ[y] >= -r && c.y * m_PlaneY[y + 1] + c.z * m_PlaneYZ[y + 1] <= r &&
+           c.z + r >= m_TileMinDepth[tileIndex] && c.z - r <= m_TileMaxDepth[tileIndex];
+}
+
+uint32_t TiledLightCulling::get_NumOverflowTiles() const
+{
+    return m_NumOverflowTiles;
+}
+
+size_t TiledLightCulling::get_MemoryUsage() const
+{
+    size_t size = sizeof( TiledLightCulling );
+    size += ( m_PlaneX.capacity() + m_PlaneXZ.capacity() + m_PlaneY.capacity() + m_PlaneYZ.capacity() ) * sizeof( float );
+    size += ( m_TileMinDepth.capacity() + m_TileMaxDepth.capacity() ) * sizeof( float );
+    size += ( m_CenterX.capacity() + m_CenterY.capacity() + m_CenterZ.capacity() + m_Radius.capacity() ) * sizeof( float );
+    size += m_RowIndices.capacity() * sizeof( std::vector<uint32_t> );
+    for ( const std::vector<uint32_t>& rowIndices : m_RowIndices )
+    {
+        size += rowIndices.capacity() * sizeof( uint32_t );
+    }
+    size += m_Tiles.capacity() * sizeof( LightCluster );
+    size += m_LightIndices.capacity() * sizeof( uint32_t );
+    return size;
+}
@@ -0,0 +1,372 @@
+#include <DirectXTemplateCorePCH.h>
+#include <VertexFormats.h>
+
+#include <Simd.h>
+
+using namespace Math;
+
+static_assert( sizeof( VertexPositionNormalTextureHalf ) == 16, "VertexPositionNormalTextureHalf must be 16 bytes." );
+static_assert( sizeof( VertexPositionNormalTextureQuantized ) == 16, "VertexPositionNormalTextureQuantized must be 16 bytes." );
+
+namespace
+{
+    const float SnormScale = 32767.0f;
+    const float UnormScale = 65535.0f;
+    const uint16_t HalfOne = 0x3C00;
+    const uint16_t UnormOne = 0xFFFF;
+
+    uint32_t AsUInt( float f )
+    {
+        uint32_t u;
+        memcpy( &u, &f, sizeof( u ) );
+        return u;
+    }
+
+    float AsFloat( uint32_t u )
+    {
+        float f;
+        memcpy( &f, &u, sizeof( f ) );
+        return f;
+    }
+
+    Simd::Float Abs( Simd::Float x )
+    {
+        return Simd::Max( x, -x );
+    }
+
+    // 1 for x >= 0 and -1 for x < 0.
+    Simd::Float SignNotZero( Simd::Float x )
+    {
+        return Simd::Select( Simd::CmpGE( x, Simd::Zero() ), Simd::Set1( 1.0f ), Simd::Set1( -1.0f ) );
+    }
+
+    Simd::Float Round( Simd::Float x )
+    {
+        return Simd::Floor( x + Simd::Set1( 0.5f ) );
+    }
+
+    // Map a unit vector to the octahedron and unfold the lower half onto the square [-1, 1]^2.
+    void EncodeOctahedral( Simd::Float x, Simd::Float y, Simd::Float z, Simd::Float& u, Simd::Float& v )
+    {
+        Simd::Float invL1 = Simd::Set1( 1.0f ) / ( Abs( x ) + Abs( y ) + Abs( z ) );
+        u = x * invL1;
+        v = y * invL1;
+
+        Simd::Float lowerHalf = Simd::CmpLT( z, Simd::Zero() );
+        Simd::Float foldedU = ( Simd::Set1( 1.0f ) - Abs( v ) ) * SignNotZero( u );
+        Simd::Float foldedV = ( Simd::Set1( 1.0f ) - Abs( u ) ) * SignNotZero( v );
+        u = Simd::Select( lowerHalf, foldedU, u );
+        v = Simd::Select( lowerHalf, foldedV, v );
+    }
+
+    void DecodeOctahedral( Simd::Float u, Simd::Float v, Simd::Float& x, Simd::Float& y, Simd::Float& z )
+    {
+        z = Simd::Set1( 1.0f ) - Abs( u ) - Abs( v );
+        Simd::Float t = Simd::Max( -z, Simd::Zero() );
+        x = u - t * SignNotZero( u );
+        y = v - t * SignNotZero( v );
+
+        Simd::Float invLength = Simd::Set1( 1.0f ) / Simd::Sqrt( x * x + y * y + z * z );
+        x = x * invLength;
+        y = y * invLength;
+        z = z * invLength;
+    }
+
+    /**
+     * Encode the attributes that both compact formats have in common. Simd::Width
+     * vertices are transposed to structure-of-arrays layout and encoded at a time.
+     * The remaining vertices are encoded one at a time.
+     */
+    template<typename EncodedVertex>
+    void EncodeNormalsAndTextureCoordinates( const VertexCollection& vertices, std::vector<EncodedVertex>& encodedVertices )
+    {
+        SIMD_ALIGN( 32 ) float nx[Simd::Width], ny[Simd::Width], nz[Simd::Width], tu[Simd::Width], tv[Simd::Width];
+
+        size_t count = vertices.size();
+        size_t i = 0;
+        for ( ; i + Simd::Width <= count; i += Simd::Width )
+        {
+            for ( int lane = 0; lane < Simd::Width; ++lane )
+            {
+                const VertexPositionNormalTexture& vertex = vertices[i + lane];
+                nx[lane] = vertex.normal.x;
+                ny[lane] = vertex.normal.y;
+                nz[lane] = vertex.normal.z;
+                tu[lane] = vertex.textureCoordinate.x;
+                tv[lane] = vertex.textureCoordinate.y;
+            }
+
+            Simd::Float u, v;
+            EncodeOctahedral( Simd::Load( nx ), Simd::Load( ny ), Simd::Load( nz ), u, v );
+
+            Simd::Store( nx, Round( u * Simd::Set1( SnormScale ) ) );
+            Simd::Store( ny, Round( v * Simd::Set1( SnormScale ) ) );
+            Simd::Store( tu, Round( Simd::Saturate( Simd::Load( tu ) ) * Simd::Set1( UnormScale ) ) );
+            Simd::Store( tv, Round( Simd::Saturate( Simd::Load( tv ) ) * Simd::Set1( UnormScale ) ) );
+
+            for ( int lane = 0; lane < Simd::Width; ++lane )
+            {
+                EncodedVertex& encoded = encodedVertices[i + lane];
+                encoded.normal[0] = static_cast<int16_t>( nx[lane] );
+                encoded.normal[1] = static_cast<int16_t>( ny[lane] );
+                encoded.textureCoordinate[0] = static_cast<uint16_t>( tu[lane] );
+                encoded.textureCoordinate[1] = static_cast<uint16_t>( tv[lane] );
+            }
+        }
+
+        for ( ; i < count; ++i )
+        {
+            const VertexPositionNormalTexture& vertex = vertices[i];
+            EncodedVertex& encoded = encodedVertices[i];
+
+            ::EncodeOctahedral( vertex.normal, encoded.normal );
+            encoded.textureCoordinate[0] = static_cast<uint16_t>( std::floor( std::min( std::max( vertex.textureCoordinate.x, 0.0f ), 1.0f ) * UnormScale + 0.5f ) );
+            encoded.textureCoordinate[1] = static_cast<uint16_t>( std::floor( std::min( std::max( vertex.textureCoordinate.y, 0.0f ), 1.0f ) * UnormScale + 0.5f ) );
+        }
+    }
+
+    template<typename EncodedVertex>
+    void DecodeNormalsAndTextureCoordinates( const std::vector<EncodedVertex>& encodedVertices, VertexCollection& vertices )
+    {
+        SIMD_ALIGN( 32 ) float nx[Simd::Width], ny[Simd::Width], nz[Simd::Width], tu[Simd::Width], tv[Simd::Width];
+
+        size_t count = encodedVertices.size();
+        size_t i = 0;
+        for ( ; i + Simd::Width <= count; i += Simd::Width )
+        {
+            for ( int lane = 0; lane < Simd::Width; ++lane )
+            {
+                const EncodedVertex& encoded = encodedVertices[i + lane];
+                nx[lane] = encoded.normal[0];
+                ny[lane] = encoded.normal[1];
+                tu[lane] = encoded.textureCoordinate[0];
+                tv[lane] = encoded.textureCoordinate[1];
+            }
+
+            // SNORM decoding clamps -32768 to -1.
+            Simd::Float u = Simd::Max( Simd::Load( nx ) * Simd::Set1( 1.0f / SnormScale ), Simd::Set1( -1.0f ) );
+            Simd::Float v = Simd::Max( Simd::Load( ny ) * Simd::Set1( 1.0f / SnormScale ), Simd::Set1( -1.0f ) );
+
+            Simd::Float x, y, z;
+            DecodeOctahedral( u, v, x, y, z );
+
+            Simd::Store( nx, x );
+            Simd::Store( ny, y );
+            Simd::Store( nz, z );
+            Simd::Store( tu, Simd::Load( tu ) * Simd::Set1( 1.0f / UnormScale ) );
+            Simd::Store( tv, Simd::Load( tv ) * Simd::Set1( 1.0f / UnormScale ) );
+
+            for ( int lane = 0; lane < Simd::Width; ++lane )
+            {
+                VertexPositionNormalTexture& vertex = vertices[i + lane];
+                vertex.normal = Float3( nx[lane], ny[lane], nz[lane] );
+                vertex.textureCoordinate = Float2( tu[lane], tv[lane] );
+            }
+        }
+
+        for ( ; i < count; ++i )
+        {
+            const EncodedVertex& encoded = encodedVertices[i];
+            VertexPositionNormalTexture& vertex = vertices[i];
+
+            vertex.normal = ::DecodeOctahedral( encoded.normal );
+            vertex.textureCoordinate = Float2( encoded.textureCoordinate[0] / UnormScale, encoded.textureCoordinate[1] / UnormScale );
+        }
+    }
+}
+
+uint16_t FloatToHalf( float value )
+{
+    // Based on Fabian Giesen's float_to_half_fast3_rtne.
+    const uint32_t f32Infinity = 255u << 23;
+    const uint32_t f16Max = ( 127u + 16u ) << 23;
+    const uint32_t denormMagic = ( ( 127u - 15u ) + ( 23u - 10u ) + 1u ) << 23;
+
+    uint32_t f = AsUInt( value );
+    uint32_t sign = f & 0x80000000u;
+    f ^= sign;
+
+    uint16_t result;
+    if ( f >= f16Max )
+    {
+        // Infinity or NaN (NaN becomes a quiet NaN).
+        result = ( f > f32Infinity ) ? 0x7E00 : 0x7C00;
+    }
+    else if ( f < ( 113u << 23 ) )
+    {
+        // The result is a denormal or zero: let the FPU do the rounding.
+        result = static_cast<uint16_t>( AsUInt( AsFloat( f ) + AsFloat( denormMagic ) ) - denormMagic );
+    }
+    else
+    {
+        uint32_t mantissaOdd = ( f >> 13 ) & 1;
+        f += ( static_cast<uint32_t>( 15 - 127 ) << 23 ) + 0xFFF;
+        f += mantissaOdd;
+        result = static_cast<uint16_t>( f >> 13 );
+    }
+
+    return static_cast<uint16_t>( result | ( sign >> 16 ) );
+}
+
+float HalfToFloat( uint16_t value )
+{
+    const uint32_t shiftedExponent = 0x7C00u << 13;
+    const float magic = AsFloat( 113u << 23 );
+
+    uint32_t f = ( value & 0x7FFFu ) << 13;
+    uint32_t exponent = f & shiftedExponent;
+    f += ( 127u - 15u ) << 23;
+
+    if ( exponent == shiftedExponent )
+    {
+        // Infinity or NaN.
+        f += ( 128u - 16u ) << 23;
+    }
+    else if ( exponent == 0 )
+    {
+        // Zero or denormal.
+        f = AsUInt( AsFloat( f + ( 1u << 23 ) ) - magic );
+    }
+
+    return AsFloat( f | ( ( value & 0x8000u ) << 16 ) );
+}
+
+void EncodeOctahedral( const Float3& normal, int16_t encoded[2] )
+{
+    float invL1 = 1.0f / ( std::abs( normal.x ) + std::abs( normal.y ) + std::abs( normal.z ) );
+    float u = normal.x * invL1;
+    float v = normal.y * invL1;
+
+    if ( normal.z < 0.0f )
+    {
+        float foldedU = ( 1.0f - std::abs( v ) ) * ( u >= 0.0f ? 1.0f : -1.0f );
+        float foldedV = ( 1.0f - std::abs( u ) ) * ( v >= 0.0f ? 1.0f : -1.0f );
+        u = foldedU;
+        v = foldedV;
+    }
+
+    encoded[0] = static_cast<int16_t>( std::floor( u * SnormScale + 0.5f ) );
+    encoded[1] = static_cast<int16_t>( std::floor( v * SnormScale + 0.5f ) );
+}
+
+Float3 DecodeOctahedral( const int16_t encoded[2] )
+{
+    float u = std::max( encoded[0] / SnormScale, -1.0f );
+    float v = std::max( encoded[1] / SnormScale, -1.0f );
+
+    Float3 normal( u, v, 1.0f - std::abs( u ) - std::abs( v ) );
+    float t = std::max( -normal.z, 0.0f );
+    normal.x -= t * ( u >= 0.0f ? 1.0f : -1.0f );
+    normal.y -= t * ( v >= 0.0f ? 1.0f : -1.0f );
+
+    return Normalize( normal );
+}
+
+void EncodeVertices( const VertexCollection& vertices, HalfVertexCollection& encodedVertices )
+{
+    encodedVertices.resize( vertices.size() );
+
+    for ( size_t i = 0; i < vertices.size(); ++i )
+    {
+        const Float3& position = vertices[i].position;
+        VertexPositionNormalTextureHalf& encoded = encodedVertices[i];
+
+        encoded.position[0] = FloatToHalf( position.x );
+        encoded.position[1] = FloatToHalf( position.y );
+        encoded.position[2] = FloatToHalf( position.z );
+        encoded.position[3] = HalfOne;
+    }
+
+    EncodeNormalsAndTextureCoordinates( vertices, encodedVertices );
+}
+
+void DecodeVertices( const HalfVertexCollection& encodedVertices, VertexCollection& vertices )
+{
+    vertices.resize( encodedVertices.size() );
+
+    for ( size_t i = 0; i < encodedVertices.size(); ++i )
+    {
+        const VertexPositionNormalTextureHalf& encoded = encodedVertices[i];
+        vertices[i].position = Float3( HalfToFloat( encoded.position[0] ), HalfToFloat( encoded.position[1] ), HalfToFloat( encoded.position[2] ) );
+    }
+
+    DecodeNormalsAndTextureCoordinates( encodedVertices, vertices );
+}
+
+void EncodeVertices( const VertexCollection& vertices, const BoundingBox& box, QuantizedVertexCollection& encodedVertices )
+{
+    encodedVertices.resize( vertices.size() );
+
+    Float3 boxMin = box.Center - box.Extents;
+    Float3 size = box.Extents * 2.0f;
+    Float3 scale( size.x > 0.0f ? UnormScale / size.x : 0.0f,
+                  size.y > 0.0f ? UnormScale / size.y : 0.0f,
+                  size.z > 0.0f ? UnormScale / size.z : 0.0f );
+
+    SIMD_ALIGN( 32 ) float px[Simd::Width], py[Simd::Width], pz[Simd::Width];
+    Simd::Float minX = Simd::Set1( boxMin.x ), minY = Simd::Set1( boxMin.y ), minZ = Simd::Set1( boxMin.z );
+    Simd::Float scaleX = Simd::Set1( scale.x ), scaleY = Simd::Set1( scale.y ), scaleZ = Simd::Set1( scale.z );
+    Simd::Float maximum = Simd::Set1( UnormScale );
+
+    size_t count = vertices.size();
+    size_t i = 0;
+    for ( ; i + Simd::Width <= count; i += Simd::Width )
+    {
+        for ( int lane = 0; lane < Simd::Width; ++lane )
+        {
+            const Float3& position = vertices[i + lane].position;
+            px[lane] = position.x;
+            py[lane] = position.y;
+            pz[lane] = position.z;
+        }
+
+        Simd::Store( px, Round( Simd::Min( Simd::Max( ( Simd::Load( px ) - minX ) * scaleX, Simd::Zero() ), maximum ) ) );
+        Simd::Store( py, Round( Simd::Min( Simd::Max( ( Simd::Load( py ) - minY ) * scaleY, Simd::Zero() ), maximum ) ) );
+        Simd::Store( pz, Round( Simd::Min( Simd::Max( ( Simd::Load( pz ) - minZ ) * scaleZ, Simd::Zero() ), maximum ) ) );
+
+        for ( int lane = 0; lane < Simd::Width; ++lane )
+        {
+            VertexPositionNormalTextureQuantized& encoded = encodedVertices[i + lane];
+            encoded.position[0] = static_cast<uint16_t>( px[lane] );
+            encoded.position[1] = static_cast<uint16_t>( py[lane] );
+            encoded.position[2] = static_cast<uint16_t>( pz[lane] );
+            encoded.position[3] = UnormOne;
+        }
+    }
+
+    for ( ; i < count; ++i )
+    {
+        Float3 position = ( vertices[i].position - boxMin ) * scale;
+        VertexPositionNormalTextureQuantized& encoded = encodedVertices[i];
+
+        encoded.position[0] = static_cast<uint16_t>( std::floor( std::min( std::max( position.x, 0.0f ), UnormScale ) + 0.5f ) );
+        encoded.position[1] = static_cast<uint16_t>( std::floor( std::min( std::max( position.y, 0.0f ), UnormScale ) + 0.5f ) );
+        encoded.position[2] = static_cast<uint16_t>( std::floor( std::min( std::max( position.z, 0.0f ), UnormScale ) + 0.5f ) );
+        encoded.position[3] = UnormOne;
+    }
+
+    EncodeNormalsAndTextureCoordinates( vertices, encodedVertices );
+}
+
+void DecodeVertices( const QuantizedVertexCollection& encodedVertices, const BoundingBox& box, VertexCollection& vertices )
+{
+    vertices.resize( encodedVertices.size() );
+
+    Float3 boxMin = box.Center - box.Extents;
+    Float3 scale = box.Extents * ( 2.0f / UnormScale );
+
+    for ( size_t i = 0; i < encodedVertices.size(); ++i )
+    {
+        const VertexPositionNormalTextureQuantized& encoded = encodedVertices[i];
+        Float3 position( encoded.position[0], encoded.position[1], encoded.position[2] );
+        vertices[i].position = boxMin + position * scale;
+    }
+
+    DecodeNormalsAndTextureCoordinates( encodedVertices, vertices );
+}
+
+Float4x4 PositionDequantizationMatrix( const BoundingBox& box )
+{
+    Float3 size = box.Extents * 2.0f;
+    return MatrixScaling( size.x, size.y, size.z ) * MatrixTranslation( box.Center - box.Extents );
+}
@@ -0,0 +1,118 @@
+#include <Test.h>
+
+#include <Geometry.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Math;
+
+namespace
+{
+    BoundingBox ComputeBoundingBoxScalar( const VertexCollection& vertices )
+    {
+        Float3 boxMin = vertices[0].position;
+        Float3 boxMax = vertices[0].position;
+        for ( const VertexPositionNormalTexture& vertex : vertices )
+        {
+            boxMin = Min( boxMin, vertex.position );
+            boxMax = Max( boxMax, vertex.position );
+        }
+        return BoundingBox( ( boxMin + boxMax ) * 0.5f, ( boxMax - boxMin ) * 0.5f );
+    }
+
+    // The largest difference between the corners of two boxes.
+    float BoxError( const BoundingBox& a, const BoundingBox& b )
+    {
+        Float3 minError = ( a.Center - a.Extents ) - ( b.Center - b.Extents );
+        Float3 maxError = ( a.Center + a.Extents ) - ( b.Center + b.Extents );
+        return std::max( { std::abs( minError.x ), std::abs( minError.y ), std::abs( minError.z ),
+                           std::abs( maxError.x ), std::abs( maxError.y ), std::abs( maxError.z ) } );
+    }
+
+    // Returns true if all of the vertices are inside the sphere.
+    bool Encloses( const BoundingSphere& sphere, const VertexCollection& vertices )
+    {
+        const float tolerance = 1e-5f;
+        for ( const VertexPositionNormalTexture& vertex : vertices )
+        {
+            if ( Length( vertex.position - sphere.Center ) > sphere.Radius + tolerance )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Encloses( const BoundingBox& box, const Float3& point )
+    {
+        const float tolerance = 1e-4f;
+        Float3 d = point - box.Center;
+        return std::abs( d.x ) <= box.Extents.x + tolerance &&
+               std::abs( d.y ) <= box.Extents.y + tolerance &&
+               std::abs( d.z ) <= box.Extents.z + tolerance;
+    }
+
+    void CheckBounds( const VertexCollection& vertices, const BoundingBox& analyticBox, const BoundingSphere& analyticSphere )
+    {
+        BoundingBox box = ComputeBoundingBox( vertices );
+        BoundingSphere sphere = ComputeBoundingSphere( vertices );
+
+        // The SIMD box is exact.
+        CHECK( BoxError( box, ComputeBoundingBoxScalar( vertices ) ) == 0.0f );
+        CHECK( Encloses( sphere, vertices ) );
+        // The analytic bounds enclose the tessellated mesh.
+        CHECK( Encloses( analyticSphere, vertices ) );
+        CHECK( BoxError( box, analyticBox ) < 1e-3f );
+        // The computed sphere is not minimal (the cone is 13% larger) but it is close.
+        CHECK( sphere.Radius <= analyticSphere.Radius * 1.2f );
+    }
+}
+
+TEST( BoundingVolume, ComputeMatchesAnalyticBounds )
+{
+    VertexCollection vertices;
+    IndexCollection indices;
+    BoundingBox box;
+    BoundingSphere sphere;
+
+    ComputeCube( vertices, indices );
+    ComputeCubeBounds( box, sphere );
+    CheckBounds( vertices, box, sphere );
+
+    ComputeSphere( vertices, indices, 1, 32 );
+    ComputeSphereBounds( box, sphere );
+    CheckBounds( vertices, box, sphere );
+
+    ComputeCone( vertices, indices, 1, 1, 32 );
+    ComputeConeBounds( box, sphere );
+    CheckBounds( vertices, box, sphere );
+
+    // A tessellation that is a multiple of 4 puts vertices on the extremes of the torus.
+    ComputeTorus( vertices, indices, 1, 0.333f, 32 );
+    ComputeTorusBounds( box, sphere );
+    CheckBounds( vertices, box, sphere );
+}
+
+TEST( BoundingVolume, Transform )
+{
+    BoundingBox box( Float3( 1.0f, 0.0f, 0.0f ), Float3( 1.0f, 2.0f, 3.0f ) );
+    BoundingSphere sphere( Float3( 1.0f, 0.0f, 0.0f ), 2.0f );
+
+    Float4x4 matrix = MatrixScaling( 1.0f, 2.0f, 1.0f ) * MatrixRotationY( ConvertToRadians( 30.0f ) ) * MatrixTranslation( 5.0f, -2.0f, 3.0f );
+    BoundingBox transformedBox = Transform( box, matrix );
+    BoundingSphere transformedSphere = Transform( sphere, matrix );
+
+    // The transformed corners of the box are inside the transformed box.
+    for ( int corner = 0; corner < 8; ++corner )
+    {
+        Float3 point( box.Center.x + ( ( corner & 1 ) ? box.Extents.x : -box.Extents.x ),
+                      box.Center.y + ( ( corner & 2 ) ? box.Extents.y : -box.Extents.y ),
+                      box.Center.z + ( ( corner & 4 ) ? box.Extents.z : -box.Extents.z ) );
+        CHECK( Encloses( transformedBox, TransformPoint( point, matrix ) ) );
+    }
+
+    // The radius is scaled by the largest scale of the matrix.
+    CHECK( std::abs( transformedSphere.Radius - 4.0f ) < 1e-4f );
+    CHECK( Length( transformedSphere.Center - TransformPoint( sphere.Center, matrix ) ) < 1e-4f );
+}
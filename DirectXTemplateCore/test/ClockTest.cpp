@@ -0,0 +1,114 @@
+#include <Test.h>
+
+#include <Clock.h>
+
+#include <cmath>
+#include <random>
+
+namespace
+{
+    // The frequency of QueryPerformanceCounter on most Windows 10 machines.
+    const int64_t QpcFrequency = 10000000;
+
+    // Jittery frame times between 14 and 19 ms.
+    int64_t NextFrameTicks( std::mt19937& random, int64_t frequency )
+    {
+        return frequency * 14 / 1000 + static_cast<int64_t>( random() % static_cast<uint32_t>( frequency * 5 / 1000 ) );
+    }
+}
+
+TEST( Clock, TicksAreMonotonic )
+{
+    CHECK( Clock::GetFrequency() > 0 );
+    CHECK( Clock::SecondsToTicks( 1.0 ) == Clock::GetFrequency() );
+    CHECK( Clock::TicksToSeconds( Clock::GetFrequency() * 3 ) == 3.0 );
+
+    int64_t previous = Clock::GetTicks();
+    for ( int i = 0; i < 100000; ++i )
+    {
+        int64_t ticks = Clock::GetTicks();
+        REQUIRE( ticks >= previous );
+        previous = ticks;
+    }
+
+    Clock clock;
+    clock.set_MaxDeltaTicks( 1 );
+    clock.Tick();
+    CHECK( clock.get_DeltaTicks() >= 0 && clock.get_DeltaTicks() <= 1 );
+    CHECK( clock.get_FrameCount() == 1 );
+    clock.Reset();
+    CHECK( clock.get_TotalTicks() == 0 && clock.get_FrameCount() == 0 );
+}
+
+// A day of jittery frames: the totals must be exact.
+TEST( Clock, LongRunIsExact )
+{
+    const uint32_t stepsPerSecond = 60;
+
+    for ( int64_t frequency : { QpcFrequency, Clock::GetFrequency() } )
+    {
+        std::mt19937 random( 42 );
+        const int64_t endTicks = static_cast<int64_t>( 86400 ) * frequency;
+
+        Clock clock;
+        clock.Reset();
+        FixedTimestep timestep( stepsPerSecond, frequency, 1000 );
+
+        int64_t exactTicks = 0;
+        uint64_t numFrames = 0;
+        while ( exactTicks < endTicks )
+        {
+            int64_t deltaTicks = NextFrameTicks( random, frequency );
+            exactTicks += deltaTicks;
+            ++numFrames;
+
+            clock.Advance( deltaTicks );
+            timestep.Advance( deltaTicks );
+            double alpha = timestep.get_Alpha();
+            REQUIRE( alpha >= 0.0 && alpha < 1.0 );
+        }
+
+        uint64_t exactSteps = static_cast<uint64_t>( exactTicks / frequency ) * stepsPerSecond + static_cast<uint64_t>( exactTicks % frequency ) * stepsPerSecond / frequency;
+        CHECK( clock.get_TotalTicks() == exactTicks );
+        CHECK( clock.get_FrameCount() == numFrames );
+        CHECK( timestep.get_NumSteps() == exactSteps );
+        CHECK( timestep.get_DroppedTicks() == 0 );
+    }
+}
+
+TEST( Clock, FixedTimestepIsClamped )
+{
+    const uint32_t stepsPerSecond = 60;
+
+    // A frame that takes too long is simulated with at most maxStepsPerAdvance steps.
+    FixedTimestep timestep( stepsPerSecond, QpcFrequency, 8 );
+    CHECK( timestep.Advance( QpcFrequency ) == 8 );
+    CHECK( timestep.get_DroppedTicks() == QpcFrequency * 52 / stepsPerSecond );
+    CHECK( timestep.Advance( QpcFrequency / stepsPerSecond + 1 ) == 1 );
+
+    timestep.Reset();
+    CHECK( timestep.get_NumSteps() == 0 && timestep.get_DroppedTicks() == 0 );
+}
+
+// The render time is between the previous and the current step.
+TEST( Clock, InterpolatedTimeIsBetweenTheLastTwoSteps )
+{
+    // A frequency that is a multiple of four steps, so that the fractions are exact.
+    const uint32_t stepsPerSecond = 60;
+    const int64_t frequency = stepsPerSecond * 4 * 1000;
+    FixedTimestep timestep( stepsPerSecond, frequency );
+    CHECK( timestep.get_InterpolatedSeconds() == 0.0 );
+
+    // A quarter step: nothing is simulated yet.
+    timestep.Advance( frequency / stepsPerSecond / 4 );
+    CHECK( timestep.get_NumSteps() == 0 );
+    CHECK( timestep.get_InterpolatedSeconds() == 0.0 );
+
+    // 2.5 steps in total: halfway between step 1 and step 2.
+    timestep.Advance( frequency / stepsPerSecond * 9 / 4 );
+    CHECK( timestep.get_NumSteps() == 2 );
+    CHECK( std::abs( timestep.get_Alpha() - 0.5 ) < 1e-9 );
+    CHECK( std::abs( timestep.get_InterpolatedSeconds() - 1.5 / stepsPerSecond ) < 1e-9 );
+    CHECK( timestep.get_InterpolatedSeconds() <= timestep.get_TotalSeconds() );
+    CHECK( timestep.get_InterpolatedSeconds() >= timestep.get_TotalSeconds() - timestep.get_StepSeconds() );
+}
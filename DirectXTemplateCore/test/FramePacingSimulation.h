@@ -0,0 +1,191 @@
+/**
+ * @brief A simulated frame loop for the FramePacing tests and benchmarks.
+ *
+ * Simulate runs a synthetic trace of CPU and GPU frame times through the frame loop
+ * of a pacing policy at 60 Hz and returns the latency, the frame rate, the repeated
+ * vblanks and the queued frames.
+ */
+#pragma once
+
+#include <FramePacer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace FramePacingSimulation
+{
+    const double RefreshPeriod = 1.0 / 60.0;
+
+    struct FrameCost
+    {
+        double Cpu;
+        double Gpu;
+    };
+
+    // A synthetic trace of CPU and GPU frame times (in seconds).
+    inline std::vector<FrameCost> CreateTrace( size_t numFrames, double cpu, double gpu, double jitter, double spikeProbability, double spike, unsigned int seed )
+    {
+        std::mt19937 random( seed );
+        std::uniform_real_distribution<double> uniform( -1.0, 1.0 );
+        std::uniform_real_distribution<double> probability( 0.0, 1.0 );
+
+        std::vector<FrameCost> trace( numFrames );
+        for ( FrameCost& frame : trace )
+        {
+            frame.Cpu = cpu + jitter * uniform( random );
+            frame.Gpu = gpu + jitter * uniform( random );
+            if ( probability( random ) < spikeProbability )
+            {
+                frame.Cpu += spike;
+            }
+        }
+        return trace;
+    }
+
+    struct Policy
+    {
+        const char* Name;
+        // The blt-model loop without a waitable object: Present blocks when 3 frames are queued.
+        bool Legacy;
+        FramePacingSettings Settings;
+    };
+
+    struct Trace
+    {
+        const char* Name;
+        std::vector<FrameCost> Frames;
+    };
+
+    // A light load, a CPU-heavy load, a GPU-bound load and a light load with CPU spikes.
+    inline std::vector<Trace> CreateTraces( size_t numFrames )
+    {
+        std::vector<Trace> traces;
+        Trace light = { "light", CreateTrace( numFrames, 0.004, 0.003, 0.001, 0.0, 0.0, 1 ) };
+        Trace cpuHeavy = { "cpu heavy", CreateTrace( numFrames, 0.011, 0.004, 0.002, 0.0, 0.0, 2 ) };
+        Trace gpuBound = { "gpu bound", CreateTrace( numFrames, 0.005, 0.014, 0.001, 0.0, 0.0, 3 ) };
+        Trace spikes = { "spikes", CreateTrace( numFrames, 0.005, 0.003, 0.001, 0.02, 0.02, 4 ) };
+        traces.push_back( light );
+        traces.push_back( cpuHeavy );
+        traces.push_back( gpuBound );
+        traces.push_back( spikes );
+        return traces;
+    }
+
+    enum PolicyIndex
+    {
+        LegacyPolicy,
+        Latency2Policy,
+        Latency1Policy,
+        PredictivePolicy,
+        NumPolicies
+    };
+
+    // The pacing policies in the order of PolicyIndex.
+    inline std::vector<Policy> CreatePolicies()
+    {
+        FramePacingSettings latency1;
+        FramePacingSettings latency2;
+        latency2.MaxFrameLatency = 2;
+        FramePacingSettings predictive;
+        predictive.PredictiveStart = true;
+        predictive.SafetyMargin = 0.006;
+
+        const Policy policies[NumPolicies] = {
+            { "blt, 3 queued", true, FramePacingSettings() },
+            { "waitable, latency 2", false, latency2 },
+            { "waitable, latency 1", false, latency1 },
+            { "latency 1, predictive", false, predictive },
+        };
+        return std::vector<Policy>( policies, policies + NumPolicies );
+    }
+
+    struct PacingResult
+    {
+        double MeanLatency;
+        double MaxLatency;
+        double FramesPerSecond;
+        // The fraction of the vblanks that repeated the previous frame.
+        double RepeatedVBlanks;
+        // The most frames that were queued for presentation.
+        uint32_t MaxQueuedFrames;
+    };
+
+    // The first vblank at or after time.
+    inline double VBlankAtOrAfter( double time )
+    {
+        return std::ceil( time / RefreshPeriod - 1e-9 ) * RefreshPeriod;
+    }
+
+    /**
+     * Simulate the frame loop. The CPU waits (for the latency waitable object or in Present),
+     * reads the input, records the frame and presents it. The GPU renders the frame after
+     * it was presented and the frame is displayed at the first vblank after the GPU is done,
+     * one frame per vblank. The latency is the time from reading the input to the vblank.
+     */
+    inline PacingResult Simulate( const Policy& policy, const std::vector<FrameCost>& trace )
+    {
+        const uint32_t maxLatency = policy.Legacy ? 3 : policy.Settings.MaxFrameLatency;
+
+        FramePacer pacer( policy.Settings );
+        std::vector<double> displayTimes( trace.size() );
+
+        PacingResult result = { 0.0, 0.0, 0.0, 0.0, 0 };
+        double cpuTime = 0.0;
+        double gpuTime = 0.0;
+        for ( size_t i = 0; i < trace.size(); ++i )
+        {
+            double start = cpuTime;
+            if ( !policy.Legacy )
+            {
+                // The waitable object is signaled when frame i - maxLatency is displayed.
+                if ( i >= maxLatency )
+                {
+                    start = std::max( start, displayTimes[i - maxLatency] );
+                }
+
+                // The frame statistics report the latest vblank.
+                uint64_t refreshCount = static_cast<uint64_t>( std::floor( start / RefreshPeriod + 1e-9 ) );
+                pacer.AddVBlank( refreshCount, refreshCount * RefreshPeriod );
+                start += pacer.GetStartDelay( start );
+            }
+
+            double present = start + trace[i].Cpu;
+            double presentReturned = present;
+            if ( policy.Legacy && i >= maxLatency )
+            {
+                presentReturned = std::max( present, displayTimes[i - maxLatency] );
+            }
+            pacer.AddFrameTime( presentReturned - start );
+            cpuTime = presentReturned;
+
+            // The frames that are queued but not displayed yet when Present returns, including this one.
+            uint32_t numQueued = 1;
+            for ( size_t j = ( i >= 8 ? i - 8 : 0 ); j < i; ++j )
+            {
+                numQueued += displayTimes[j] > presentReturned ? 1 : 0;
+            }
+            result.MaxQueuedFrames = std::max( result.MaxQueuedFrames, numQueued );
+
+            gpuTime = std::max( gpuTime, present ) + trace[i].Gpu;
+            double display = VBlankAtOrAfter( gpuTime );
+            if ( i > 0 )
+            {
+                display = std::max( display, displayTimes[i - 1] + RefreshPeriod );
+            }
+            displayTimes[i] = display;
+
+            double latency = display - start;
+            result.MeanLatency += latency;
+            result.MaxLatency = std::max( result.MaxLatency, latency );
+        }
+
+        double duration = displayTimes.back() - displayTimes.front();
+        double numVBlanks = std::floor( duration / RefreshPeriod + 0.5 ) + 1.0;
+        result.MeanLatency /= trace.size();
+        result.FramesPerSecond = ( trace.size() - 1 ) / duration;
+        result.RepeatedVBlanks = 1.0 - trace.size() / numVBlanks;
+        return result;
+    }
+}
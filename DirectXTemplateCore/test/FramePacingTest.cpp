@@ -0,0 +1,107 @@
+#include <Test.h>
+
+#include <FramePacer.h>
+#include <FramePacingSimulation.h>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+using namespace FramePacingSimulation;
+
+TEST( FramePacing, Estimates )
+{
+    FramePacingSettings settings;
+    settings.PredictiveStart = true;
+    settings.SafetyMargin = 0.002;
+    FramePacer pacer( settings );
+
+    // Nothing is known yet.
+    CHECK( pacer.get_RefreshPeriod() == 0.0 );
+    CHECK( pacer.GetStartDelay( 1.0 ) == 0.0 );
+    CHECK( pacer.get_PredictedFrameTime() == 0.0 );
+
+    // Vblanks with 0.1 ms of jitter at 144 Hz, some of them missed.
+    std::mt19937 random( 3 );
+    std::uniform_real_distribution<double> jitter( -0.0001, 0.0001 );
+    const double period = 1.0 / 144.0;
+    for ( uint64_t refresh = 100; refresh < 1100; refresh += 1 + random() % 3 )
+    {
+        pacer.AddVBlank( refresh, refresh * period + jitter( random ) );
+    }
+    CHECK( std::abs( pacer.get_RefreshPeriod() - period ) < 1e-6 );
+    CHECK( std::abs( pacer.GetNextVBlank( 1200.3 * period ) - 1201.0 * period ) < 0.0002 );
+
+    // The 95th percentile of 0.04 to 4 ms (only the last 32 frame times are kept).
+    for ( int i = 1; i <= 100; ++i )
+    {
+        pacer.AddFrameTime( i * 0.00004 );
+    }
+    CHECK( std::abs( pacer.get_PredictedFrameTime() - 0.00396 ) < 1e-9 );
+
+    // The frame finishes SafetyMargin before the next vblank, or starts at once if it
+    // is not expected to make it.
+    for ( int i = 0; i < 100; ++i )
+    {
+        double now = 1300.0 * period + i * 0.0001;
+        double delay = pacer.GetStartDelay( now );
+        double end = now + delay + pacer.get_PredictedFrameTime() + settings.SafetyMargin;
+        double nextVBlank = pacer.GetNextVBlank( now );
+        REQUIRE( delay >= 0.0 && delay < period );
+        REQUIRE( delay > 0.0 ? std::abs( end - nextVBlank ) < 1e-9 : end >= nextVBlank - 1e-9 );
+    }
+
+    // Going back in time restarts the estimate.
+    pacer.AddVBlank( 5, 10.0 );
+    CHECK( pacer.get_RefreshPeriod() == 0.0 );
+
+    // Without PredictiveStart the frame starts at once.
+    settings.PredictiveStart = false;
+    pacer.set_Settings( settings );
+    pacer.AddVBlank( 0, 0.0 );
+    pacer.AddVBlank( 1, period );
+    CHECK( pacer.GetStartDelay( 1.5 * period ) == 0.0 );
+
+    bool thrown = false;
+    try
+    {
+        settings.MaxFrameLatency = 0;
+        pacer.set_Settings( settings );
+    }
+    catch ( const std::invalid_argument& )
+    {
+        thrown = true;
+    }
+    CHECK( thrown );
+}
+
+// Simulate the frame loop on synthetic traces at 60 Hz and compare the pacing policies.
+TEST( FramePacing, Policies )
+{
+    const size_t numFrames = 2000;
+    const std::vector<Policy> policies = CreatePolicies();
+
+    for ( const Trace& trace : CreateTraces( numFrames ) )
+    {
+        PacingResult legacy = Simulate( policies[LegacyPolicy], trace.Frames );
+        PacingResult waitable2 = Simulate( policies[Latency2Policy], trace.Frames );
+        PacingResult waitable1 = Simulate( policies[Latency1Policy], trace.Frames );
+        PacingResult predicted = Simulate( policies[PredictivePolicy], trace.Frames );
+
+        // The waitable object never lets more frames queue than the latency allows, and
+        // it does not add latency to the loop that blocks in Present.
+        CHECK( legacy.MaxQueuedFrames <= 3 );
+        CHECK( waitable2.MaxQueuedFrames <= 2 );
+        CHECK( waitable1.MaxQueuedFrames <= 1 );
+        CHECK( predicted.MaxQueuedFrames <= 1 );
+        CHECK( waitable2.MeanLatency <= legacy.MeanLatency + 1e-9 );
+        CHECK( waitable1.MeanLatency <= legacy.MeanLatency + 1e-9 );
+
+        // Two queued frames keep the frame rate of the blt loop.
+        CHECK( waitable2.FramesPerSecond >= legacy.FramesPerSecond * 0.99 );
+
+        // Predictive start lowers the latency of latency 1 without repeating more than 1% more vblanks.
+        CHECK( predicted.MeanLatency <= waitable1.MeanLatency + 1e-9 );
+        CHECK( predicted.RepeatedVBlanks <= waitable1.RepeatedVBlanks + 0.01 );
+    }
+}
@@ -0,0 +1,77 @@
+#include <Test.h>
+
+#include <Camera.h>
+#include <Frustum.h>
+
+#include <random>
+
+using namespace Math;
+
+namespace
+{
+    // A camera at the origin that looks down the positive z-axis.
+    Camera CreateCamera()
+    {
+        Camera camera( Camera::LeftHanded );
+        camera.set_Projection( 45.0f, 16.0f / 9.0f, 0.1f, 100.0f );
+        camera.set_LookAt( Float3( 0.0f, 0.0f, 0.0f ), Float3( 0.0f, 0.0f, 1.0f ), Float3( 0.0f, 1.0f, 0.0f ) );
+        return camera;
+    }
+}
+
+TEST( Frustum, SpheresAndBoxes )
+{
+    Camera camera = CreateCamera();
+    const Frustum& frustum = camera.get_Frustum();
+
+    CHECK( frustum.Intersects( BoundingSphere( Float3( 0.0f, 0.0f, 10.0f ), 1.0f ) ) );
+    // Behind the camera, beyond the far plane, and outside the left and top planes.
+    CHECK( !frustum.Intersects( BoundingSphere( Float3( 0.0f, 0.0f, -10.0f ), 1.0f ) ) );
+    CHECK( !frustum.Intersects( BoundingSphere( Float3( 0.0f, 0.0f, 110.0f ), 1.0f ) ) );
+    CHECK( !frustum.Intersects( BoundingSphere( Float3( -50.0f, 0.0f, 10.0f ), 1.0f ) ) );
+    CHECK( !frustum.Intersects( BoundingSphere( Float3( 0.0f, 50.0f, 10.0f ), 1.0f ) ) );
+    // Intersects the far plane.
+    CHECK( frustum.Intersects( BoundingSphere( Float3( 0.0f, 0.0f, 100.5f ), 1.0f ) ) );
+
+    CHECK( frustum.Intersects( BoundingBox( Float3( 0.0f, 0.0f, 10.0f ), Float3( 1.0f, 1.0f, 1.0f ) ) ) );
+    CHECK( !frustum.Intersects( BoundingBox( Float3( 0.0f, 0.0f, -10.0f ), Float3( 1.0f, 1.0f, 1.0f ) ) ) );
+    // A large box that contains the camera.
+    CHECK( frustum.Intersects( BoundingBox( Float3( 0.0f, 0.0f, 0.0f ), Float3( 500.0f, 500.0f, 500.0f ) ) ) );
+}
+
+TEST( Frustum, BatchedCullingMatchesScalar )
+{
+    Camera camera = CreateCamera();
+    camera.set_LookAt( Float3( 0.0f, 0.0f, 0.0f ), Float3( 1.0f, 0.2f, 1.0f ), Float3( 0.0f, 1.0f, 0.0f ) );
+    const Frustum& frustum = camera.get_Frustum();
+
+    std::mt19937 random( 1234 );
+    std::uniform_real_distribution<float> position( -100.0f, 100.0f );
+    std::uniform_real_distribution<float> size( 0.1f, 2.0f );
+
+    // An odd number of objects so the last SIMD batch is partially filled.
+    const size_t numObjects = 10007;
+    BoundingSphereArrays spheres;
+    BoundingBoxArrays boxes;
+    for ( size_t i = 0; i < numObjects; ++i )
+    {
+        Float3 center( position( random ), position( random ), position( random ) );
+        Float3 extents( size( random ), size( random ), size( random ) );
+        boxes.Add( BoundingBox( center, extents ) );
+        spheres.Add( BoundingSphere( center, Length( extents ) ) );
+    }
+
+    std::vector<uint32_t> expectedSpheres, expectedBoxes;
+    for ( size_t i = 0; i < numObjects; ++i )
+    {
+        if ( frustum.Intersects( spheres.Get( i ) ) ) expectedSpheres.push_back( static_cast<uint32_t>( i ) );
+        if ( frustum.Intersects( boxes.Get( i ) ) ) expectedBoxes.push_back( static_cast<uint32_t>( i ) );
+    }
+    CHECK( !expectedSpheres.empty() && expectedSpheres.size() < numObjects );
+
+    std::vector<uint32_t> visible;
+    CHECK( frustum.Cull( spheres, visible ) == expectedSpheres.size() );
+    CHECK( visible == expectedSpheres );
+    CHECK( frustum.Cull( boxes, visible ) == expectedBoxes.size() );
+    CHECK( visible == expectedBoxes );
+}
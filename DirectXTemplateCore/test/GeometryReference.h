@@ -0,0 +1,178 @@
+/**
+ * @brief The reference meshes of the Geometry tests and benchmarks.
+ *
+ * ComputeSphereReference and ComputeTorusReference are the generators before they
+ * were vectorized and parallelized, and MeshDifference compares their meshes with
+ * those of ComputeSphere and ComputeTorus.
+ */
+#pragma once
+
+#include <Geometry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace GeometryReference
+{
+    inline void PushIndex( IndexCollection& indices, size_t index )
+    {
+        indices.push_back( static_cast<uint32_t>( index ) );
+    }
+
+    // The generators before they were vectorized and parallelized: one sin and cos
+    // per vertex and buffers that grow with push_back.
+    inline void ComputeSphereReference( VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords )
+    {
+        vertices.clear();
+        indices.clear();
+
+        if (tessellation < 3)
+            throw std::out_of_range("tessellation parameter out of range");
+
+        float radius = diameter / 2.0f;
+        size_t verticalSegments = tessellation;
+        size_t horizontalSegments = tessellation * 2;
+
+        // Create rings of vertices at progressively higher latitudes.
+        for (size_t i = 0; i <= verticalSegments; i++)
+        {
+            float v = 1 - (float)i / verticalSegments;
+
+            float latitude = (i * Math::Pi / verticalSegments) - Math::PiDiv2;
+            float dy, dxz;
+
+            Math::ScalarSinCos(&dy, &dxz, latitude);
+
+            // Create a single ring of vertices at this latitude.
+            for (size_t j = 0; j <= horizontalSegments; j++)
+            {
+                float u = (float)j / horizontalSegments;
+
+                float longitude = j * Math::TwoPi / horizontalSegments;
+                float dx, dz;
+
+                Math::ScalarSinCos(&dx, &dz, longitude);
+
+                dx *= dxz;
+                dz *= dxz;
+
+                Math::Float3 normal(dx, dy, dz);
+                Math::Float2 textureCoordinate(u, v);
+
+                vertices.push_back(VertexPositionNormalTexture(normal * radius, normal, textureCoordinate));
+            }
+        }
+
+        // Fill the index buffer with triangles joining each pair of latitude rings.
+        size_t stride = horizontalSegments + 1;
+
+        for (size_t i = 0; i < verticalSegments; i++)
+        {
+            for (size_t j = 0; j <= horizontalSegments; j++)
+            {
+                size_t nextI = i + 1;
+                size_t nextJ = (j + 1) % stride;
+
+                PushIndex(indices, i * stride + j);
+                PushIndex(indices, nextI * stride + j);
+                PushIndex(indices, i * stride + nextJ);
+
+                PushIndex(indices, i * stride + nextJ);
+                PushIndex(indices, nextI * stride + j);
+                PushIndex(indices, nextI * stride + nextJ);
+            }
+        }
+
+        if ( !rhcoords )
+            ReverseWinding( indices, vertices );
+    }
+
+    inline void ComputeTorusReference( VertexCollection& vertices, IndexCollection& indices, float diameter, float thickness, size_t tessellation, bool rhcoords )
+    {
+        vertices.clear();
+        indices.clear();
+
+        if (tessellation < 3)
+            throw std::out_of_range("tesselation parameter out of range");
+
+        size_t stride = tessellation + 1;
+
+        // First we loop around the main ring of the torus.
+        for (size_t i = 0; i <= tessellation; i++)
+        {
+            float u = (float)i / tessellation;
+
+            float outerAngle = i * Math::TwoPi / tessellation - Math::PiDiv2;
+
+            // Create a transform matrix that will align geometry to
+            // slice perpendicularly though the current ring position.
+            Math::Float4x4 transform = Math::MatrixTranslation(diameter / 2, 0, 0) * Math::MatrixRotationY(outerAngle);
+
+            // Now we loop along the other axis, around the side of the tube.
+            for (size_t j = 0; j <= tessellation; j++)
+            {
+                float v = 1 - (float)j / tessellation;
+
+                float innerAngle = j * Math::TwoPi / tessellation + Math::Pi;
+                float dx, dy;
+
+                Math::ScalarSinCos(&dy, &dx, innerAngle);
+
+                // Create a vertex.
+                Math::Float3 normal(dx, dy, 0);
+                Math::Float3 position = normal * thickness / 2;
+                Math::Float2 textureCoordinate(u, v);
+
+                position = Math::TransformPoint(position, transform);
+                normal = Math::TransformNormal(normal, transform);
+
+                vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
+
+                // And create indices for two triangles.
+                size_t nextI = (i + 1) % stride;
+                size_t nextJ = (j + 1) % stride;
+
+                PushIndex(indices, i * stride + j);
+                PushIndex(indices, i * stride + nextJ);
+                PushIndex(indices, nextI * stride + j);
+
+                PushIndex(indices, i * stride + nextJ);
+                PushIndex(indices, nextI * stride + nextJ);
+                PushIndex(indices, nextI * stride + j);
+            }
+        }
+
+        if ( !rhcoords )
+            ReverseWinding( indices, vertices );
+    }
+
+    // The largest difference between the attributes of two meshes, or infinity if the
+    // indices or the number of vertices are different.
+    inline float MeshDifference( const VertexCollection& verticesA, const IndexCollection& indicesA,
+                          const VertexCollection& verticesB, const IndexCollection& indicesB )
+    {
+        if ( verticesA.size() != verticesB.size() || indicesA.size() != indicesB.size() )
+        {
+            return INFINITY;
+        }
+        for ( size_t i = 0; i < indicesA.size(); ++i )
+        {
+            if ( indicesA[i] != indicesB[i] )
+            {
+                return INFINITY;
+            }
+        }
+
+        float difference = 0.0f;
+        for ( size_t i = 0; i < verticesA.size(); ++i )
+        {
+            const VertexPositionNormalTexture& a = verticesA[i];
+            const VertexPositionNormalTexture& b = verticesB[i];
+            difference = std::max( { difference, Math::Length( a.position - b.position ), Math::Length( a.normal - b.normal ),
+                                     std::abs( a.textureCoordinate.x - b.textureCoordinate.x ),
+                                     std::abs( a.textureCoordinate.y - b.textureCoordinate.y ) } );
+        }
+        return difference;
+    }
+}
@@ -0,0 +1,71 @@
+#include <Test.h>
+
+#include <Geometry.h>
+#include <GeometryReference.h>
+
+#include <stdexcept>
+
+using namespace GeometryReference;
+
+TEST( Geometry, SphereMatchesReference )
+{
+    VertexCollection referenceVertices, vertices;
+    IndexCollection referenceIndices, indices;
+
+    // Large tessellations are generated on several threads.
+    for ( size_t tessellation = 3; tessellation <= 384; tessellation = tessellation * 2 + 1 )
+    {
+        ComputeSphereReference( referenceVertices, referenceIndices, 1.0f, tessellation, false );
+        ComputeSphere( vertices, indices, 1.0f, tessellation, false );
+        CHECK( MeshDifference( referenceVertices, referenceIndices, vertices, indices ) < 1e-5f );
+
+        ComputeSphereReference( referenceVertices, referenceIndices, 2.0f, tessellation, true );
+        ComputeSphere( vertices, indices, 2.0f, tessellation, true );
+        CHECK( MeshDifference( referenceVertices, referenceIndices, vertices, indices ) < 1e-5f );
+    }
+}
+
+TEST( Geometry, TorusMatchesReference )
+{
+    VertexCollection referenceVertices, vertices;
+    IndexCollection referenceIndices, indices;
+
+    for ( size_t tessellation = 3; tessellation <= 384; tessellation = tessellation * 2 + 1 )
+    {
+        ComputeTorusReference( referenceVertices, referenceIndices, 1.0f, 0.333f, tessellation, false );
+        ComputeTorus( vertices, indices, 1.0f, 0.333f, tessellation, false );
+        CHECK( MeshDifference( referenceVertices, referenceIndices, vertices, indices ) < 1e-5f );
+
+        ComputeTorusReference( referenceVertices, referenceIndices, 2.0f, 0.5f, tessellation, true );
+        ComputeTorus( vertices, indices, 2.0f, 0.5f, tessellation, true );
+        CHECK( MeshDifference( referenceVertices, referenceIndices, vertices, indices ) < 1e-5f );
+    }
+}
+
+TEST( Geometry, InvalidTessellationThrows )
+{
+    VertexCollection vertices;
+    IndexCollection indices;
+
+    bool threw = false;
+    try
+    {
+        ComputeSphere( vertices, indices, 1.0f, 2 );
+    }
+    catch ( const std::out_of_range& )
+    {
+        threw = true;
+    }
+    CHECK( threw );
+
+    threw = false;
+    try
+    {
+        ComputeTorus( vertices, indices, 1.0f, 0.333f, 2 );
+    }
+    catch ( const std::out_of_range& )
+    {
+        threw = true;
+    }
+    CHECK( threw );
+}
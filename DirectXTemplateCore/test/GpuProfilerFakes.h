@@ -0,0 +1,324 @@
+/**
+ * @brief A simulated GPU for the GpuProfiler tests and benchmarks.
+ *
+ * SimulatedGpu implements GpuTimestampQueries with the timing of a GPU that runs
+ * behind the CPU, and RunProfiler and RunClockSync drive the profiler and the clock
+ * synchronization through a frame loop that is throttled like Present.
+ */
+#pragma once
+
+#include <GpuProfiler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace GpuProfilerFakes
+{
+    /**
+     * A GPU that executes the commands in order. A command starts when the previous
+     * command is done, but not earlier than SubmitLatency after the CPU issued it.
+     * The results of a frame are available once the simulated CPU time has passed
+     * the end of the frame on the GPU.
+     */
+    class SimulatedGpu : public GpuTimestampQueries
+    {
+    public:
+        static const uint64_t Frequency = 27000000;
+        static const uint64_t ClockBase = 123456789012345ull;
+
+        SimulatedGpu( uint32_t numSlots, uint32_t maxTimestamps, double submitLatency )
+            : m_Slots( numSlots )
+            , m_MaxTimestamps( maxTimestamps )
+            , m_SubmitLatency( submitLatency )
+            , m_CpuTime( 0.0 )
+            , m_GpuTime( 0.0 )
+            , m_NextDisjoint( false )
+            , m_NumDisjointFrames( 0 )
+            , m_NumErrors( 0 )
+        {}
+
+        // The time at which the CPU issues the next commands.
+        void set_CpuTime( double time )
+        {
+            m_CpuTime = time;
+        }
+
+        // Issue GPU work that takes duration seconds.
+        void Draw( double duration )
+        {
+            m_GpuTime = std::max( m_GpuTime, m_CpuTime + m_SubmitLatency ) + duration;
+        }
+
+        // The time at which the GPU finishes the issued commands.
+        double get_GpuTime() const
+        {
+            return m_GpuTime;
+        }
+
+        // The clock of the next frame that is ended is disjoint.
+        void SetDisjoint()
+        {
+            m_NextDisjoint = true;
+        }
+
+        uint32_t get_NumDisjointFrames() const
+        {
+            return m_NumDisjointFrames;
+        }
+
+        // The number of slots that were reused before their results were read, and
+        // of results that were read before they were available.
+        uint32_t get_NumErrors() const
+        {
+            return m_NumErrors;
+        }
+
+        virtual uint32_t get_NumSlots() const
+        {
+            return static_cast<uint32_t>( m_Slots.size() );
+        }
+
+        virtual uint32_t get_MaxTimestamps() const
+        {
+            return m_MaxTimestamps;
+        }
+
+        virtual void BeginFrame( uint32_t slot )
+        {
+            Slot& s = m_Slots[slot];
+            m_NumErrors += s.Ended && !s.Read ? 1 : 0;
+            s.Times.assign( m_MaxTimestamps, -1.0 );
+            s.Ended = false;
+            s.Read = false;
+        }
+
+        virtual void EndFrame( uint32_t slot )
+        {
+            Slot& s = m_Slots[slot];
+            s.EndTime = std::max( m_GpuTime, m_CpuTime + m_SubmitLatency );
+            s.Disjoint = m_NextDisjoint;
+            s.Ended = true;
+            m_NumDisjointFrames += m_NextDisjoint ? 1 : 0;
+            m_NextDisjoint = false;
+        }
+
+        virtual void WriteTimestamp( uint32_t slot, uint32_t index )
+        {
+            m_GpuTime = std::max( m_GpuTime, m_CpuTime + m_SubmitLatency );
+            m_Slots[slot].Times[index] = m_GpuTime;
+        }
+
+        virtual bool GetFrequency( uint32_t slot, uint64_t& frequency, bool& disjoint )
+        {
+            const Slot& s = m_Slots[slot];
+            if ( !s.Ended || m_CpuTime < s.EndTime )
+            {
+                return false;
+            }
+
+            frequency = Frequency;
+            disjoint = s.Disjoint;
+            return true;
+        }
+
+        virtual bool GetTimestamp( uint32_t slot, uint32_t index, uint64_t& timestamp )
+        {
+            Slot& s = m_Slots[slot];
+            if ( !s.Ended || m_CpuTime < s.EndTime || s.Times[index] < 0.0 )
+            {
+                ++m_NumErrors;
+                return false;
+            }
+
+            s.Read = true;
+            timestamp = ClockBase + static_cast<uint64_t>( std::llround( s.Times[index] * Frequency ) );
+            return true;
+        }
+
+    private:
+        struct Slot
+        {
+            Slot()
+                : EndTime( 0.0 )
+                , Disjoint( false )
+                , Ended( false )
+                , Read( false )
+            {}
+
+            std::vector<double> Times;
+            double EndTime;
+            bool Disjoint;
+            bool Ended;
+            bool Read;
+        };
+
+        std::vector<Slot> m_Slots;
+        uint32_t m_MaxTimestamps;
+        double m_SubmitLatency;
+        double m_CpuTime;
+        double m_GpuTime;
+        bool m_NextDisjoint;
+        uint32_t m_NumDisjointFrames;
+        uint32_t m_NumErrors;
+    };
+
+    struct Workload
+    {
+        const char* Name;
+        double CpuFrameTime;
+        double GpuFrameTime;
+        // The number of frames between frames with a disjoint clock (0 for none).
+        uint32_t DisjointInterval;
+        uint32_t MaxTimestamps;
+    };
+
+    struct FrameWork
+    {
+        double Opaque;
+        double Transparent;
+        double Post;
+    };
+
+    struct ProfilerResult
+    {
+        uint64_t NumResolved;
+        uint64_t NumSkipped;
+        uint64_t NumDisjoint;
+        uint64_t NumDropped;
+        // The most frames between the end of a frame and the readback of its results.
+        uint64_t MaxLatency;
+        // The errors of the simulated GPU (see SimulatedGpu::get_NumErrors) and the frames it made disjoint.
+        uint32_t NumGpuErrors;
+        uint32_t NumGpuDisjointFrames;
+    };
+
+    // Called with every frame that is read back and the work that was issued in it.
+    typedef std::function<void( const GpuProfileFrame& frame, const FrameWork& work )> ResolvedFrameFunction;
+
+    /**
+     * Run the frame loop against the simulated GPU. Like DXGI, the CPU waits in Present
+     * while three frames are queued. Every frame issues the scopes Scene (Opaque,
+     * Transparent) and Post.
+     */
+    inline ProfilerResult RunProfiler( const Workload& workload, uint32_t numSlots, size_t numFrames,
+        const ResolvedFrameFunction& resolvedFrame = ResolvedFrameFunction() )
+    {
+        SimulatedGpu gpu( numSlots, workload.MaxTimestamps, 0.0005 );
+        GpuProfiler profiler( gpu );
+
+        std::mt19937 random( 7 );
+        std::uniform_real_distribution<double> jitter( 0.8, 1.2 );
+
+        std::vector<FrameWork> work( numFrames );
+        std::vector<double> frameEnds( numFrames );
+        ProfilerResult result = { 0, 0, 0, 0, 0, 0, 0 };
+        uint64_t lastResolved = 0;
+        double cpuTime = 0.0;
+        for ( size_t i = 0; i < numFrames; ++i )
+        {
+            gpu.set_CpuTime( cpuTime );
+
+            double gpuTime = workload.GpuFrameTime * jitter( random );
+            work[i].Opaque = gpuTime * 0.5;
+            work[i].Transparent = gpuTime * 0.2;
+            work[i].Post = gpuTime * 0.3;
+
+            profiler.BeginFrame();
+            {
+                GpuProfileScope scene( &profiler, "Scene" );
+                {
+                    GpuProfileScope opaque( &profiler, "Opaque" );
+                    gpu.Draw( work[i].Opaque );
+                }
+                {
+                    GpuProfileScope transparent( &profiler, "Transparent" );
+                    gpu.Draw( work[i].Transparent );
+                }
+            }
+            {
+                GpuProfileScope post( &profiler, "Post" );
+                gpu.Draw( work[i].Post );
+            }
+            if ( workload.DisjointInterval > 0 && i % workload.DisjointInterval == 0 )
+            {
+                gpu.SetDisjoint();
+            }
+
+            // The commands are issued at the end of the CPU work of the frame, right before
+            // Present, which blocks until the GPU has finished the frame three frames back.
+            profiler.EndFrame();
+
+            cpuTime += workload.CpuFrameTime * jitter( random );
+            frameEnds[i] = gpu.get_GpuTime();
+            if ( i >= 3 )
+            {
+                cpuTime = std::max( cpuTime, frameEnds[i - 3] );
+            }
+
+            if ( profiler.get_NumResolvedFrames() > lastResolved )
+            {
+                lastResolved = profiler.get_NumResolvedFrames();
+                const GpuProfileFrame& frame = profiler.get_LatestFrame();
+                result.MaxLatency = std::max<uint64_t>( result.MaxLatency, i - frame.FrameIndex );
+                if ( resolvedFrame )
+                {
+                    resolvedFrame( frame, work[static_cast<size_t>( frame.FrameIndex )] );
+                }
+            }
+        }
+
+        result.NumResolved = profiler.get_NumResolvedFrames();
+        result.NumSkipped = profiler.get_NumSkippedFrames();
+        result.NumDisjoint = profiler.get_NumDisjointFrames();
+        result.NumDropped = profiler.get_NumDroppedScopes();
+        result.NumGpuErrors = gpu.get_NumErrors();
+        result.NumGpuDisjointFrames = gpu.get_NumDisjointFrames();
+        return result;
+    }
+
+    /**
+     * Feed the clock synchronization with the commands of a GPU whose clock drifts
+     * against the CPU clock. Returns the largest error of the estimated offset after
+     * the first second.
+     */
+    inline double RunClockSync( uint32_t numFrames, double gpuFrameTime, double drift, double submitLatency, uint32_t window )
+    {
+        const double cpuFrameTime = 0.010;
+        const double gpuClockOffset = 1234.5;
+
+        GpuClockSync sync( window );
+        double cpuTime = 0.0;
+        double gpuTime = 0.0;
+        std::vector<double> frameEnds( numFrames );
+        double maxError = 0.0;
+        for ( uint32_t i = 0; i < numFrames; ++i )
+        {
+            // Ten commands per frame.
+            for ( int c = 0; c < 10; ++c )
+            {
+                gpuTime = std::max( gpuTime, cpuTime + submitLatency );
+                sync.AddSample( cpuTime, gpuTime * ( 1.0 + drift ) + gpuClockOffset );
+                gpuTime += gpuFrameTime / 10.0;
+            }
+            sync.EndFrame();
+            frameEnds[i] = gpuTime;
+
+            // The true offset now: cpuTime = gpuClock + offset.
+            double trueOffset = cpuTime - ( cpuTime * ( 1.0 + drift ) + gpuClockOffset );
+            if ( cpuTime > 1.0 )
+            {
+                maxError = std::max( maxError, std::abs( sync.get_Offset() - trueOffset ) );
+            }
+
+            cpuTime += cpuFrameTime;
+            if ( i >= 3 )
+            {
+                cpuTime = std::max( cpuTime, frameEnds[i - 3] );
+            }
+        }
+        return maxError;
+    }
+}
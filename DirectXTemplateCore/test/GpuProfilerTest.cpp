@@ -0,0 +1,128 @@
+#include <Test.h>
+
+#include <GpuProfiler.h>
+#include <GpuProfilerFakes.h>
+#include <Profiler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace GpuProfilerFakes;
+
+namespace
+{
+    // Check the zones of a frame against the work that was issued.
+    bool CheckFrame( const GpuProfileFrame& frame, const FrameWork& work, bool allScopes )
+    {
+        // One tick of rounding for each timestamp.
+        const double tolerance = 2.0 / SimulatedGpu::Frequency;
+
+        static const char* names[] = { "Scene", "Opaque", "Transparent", "Post" };
+        static const uint32_t depths[] = { 0, 1, 1, 0 };
+        const double durations[] = { work.Opaque + work.Transparent, work.Opaque, work.Transparent, work.Post };
+        if ( allScopes ? frame.Zones.size() != 4 : frame.Zones.size() > 4 )
+        {
+            return false;
+        }
+
+        bool valid = std::abs( frame.Duration - ( durations[0] + durations[3] ) ) < tolerance;
+        double previousBegin = 0.0;
+        for ( size_t i = 0; i < frame.Zones.size(); ++i )
+        {
+            const GpuProfileZone& zone = frame.Zones[i];
+            size_t n = allScopes ? i : std::find_if( names, names + 4, [&zone]( const char* name ) { return strcmp( name, zone.Name ) == 0; } ) - names;
+            valid = valid && n < 4 && strcmp( zone.Name, names[n] ) == 0 && zone.Depth == depths[n] &&
+                std::abs( zone.Duration - durations[n] ) < tolerance && zone.Begin >= previousBegin - tolerance;
+            previousBegin = zone.Begin;
+        }
+        return valid;
+    }
+}
+
+// Run the GPU profiler against a simulated GPU: the results are read back without
+// waiting, match the issued work and account for every frame.
+TEST( GpuProfiler, Readback )
+{
+    const size_t numFrames = 2000;
+
+    // The profiler records the read back zones on the CPU profiler; the simulated times are meaningless there.
+    Profiler::set_Enabled( false );
+
+    const Workload workloads[] = {
+        { "light", 0.010, 0.004, 0, 64 },
+        { "gpu bound", 0.010, 0.015, 0, 64 },
+        { "disjoint", 0.010, 0.004, 50, 64 },
+        { "few queries", 0.010, 0.004, 0, 6 },
+    };
+
+    for ( const Workload& workload : workloads )
+    {
+        for ( uint32_t numSlots = 2; numSlots <= 5; ++numSlots )
+        {
+            bool allScopes = workload.MaxTimestamps >= 10;
+            bool framesMatch = true;
+            ProfilerResult result = RunProfiler( workload, numSlots, numFrames,
+                [&]( const GpuProfileFrame& frame, const FrameWork& work ) { framesMatch = framesMatch && CheckFrame( frame, work, allScopes ); } );
+            CHECK( framesMatch );
+            CHECK( result.NumResolved > 0 );
+            CHECK( result.NumGpuErrors == 0 );
+            CHECK( result.NumGpuDisjointFrames == result.NumDisjoint );
+
+            // Every frame was read back, skipped, disjoint or is still in flight.
+            uint64_t numAccounted = result.NumResolved + result.NumSkipped + result.NumDisjoint;
+            CHECK( numAccounted <= numFrames && numAccounted + numSlots >= numFrames );
+
+            if ( workload.MaxTimestamps >= 10 )
+            {
+                CHECK( result.NumDropped == 0 );
+            }
+            else
+            {
+                // Only Scene and Opaque fit: Transparent and Post are dropped in every profiled frame.
+                CHECK( result.NumDropped == 2 * ( numFrames - result.NumSkipped ) );
+            }
+            if ( workload.DisjointInterval > 0 )
+            {
+                CHECK( result.NumDisjoint > 0 );
+            }
+            // With one more slot than the frames that Present lets queue, every frame is
+            // profiled. When the GPU finishes each frame before the CPU finishes the next
+            // one, two slots are enough.
+            if ( numSlots > 3 || workload.GpuFrameTime < workload.CpuFrameTime )
+            {
+                CHECK( result.NumSkipped == 0 );
+            }
+            CHECK( result.MaxLatency <= 4 );
+        }
+    }
+
+    Profiler::set_Enabled( true );
+}
+
+// The offset of a GPU clock that drifts by 100 ppm follows the drift when the GPU is idle at times.
+TEST( GpuProfiler, ClockSync )
+{
+    const uint32_t numFrames = 2000;
+    const double submitLatency = 0.0005;
+    const double drift = 0.0001;
+
+    // The error is the submit latency plus the drift over the window.
+    double windowError = RunClockSync( numFrames, 0.004, drift, submitLatency, 64 );
+    CHECK( windowError < submitLatency + 64 * 0.010 * drift * 2.0 );
+    // Without a window the drift accumulates.
+    double unboundedError = RunClockSync( numFrames, 0.004, drift, submitLatency, numFrames );
+    CHECK( unboundedError > windowError );
+
+    GpuClockSync sync;
+    CHECK( !sync.get_Valid() );
+    sync.AddSample( 2.0, 1.5 );
+    sync.AddSample( 2.5, 1.75 );
+    sync.EndFrame();
+    CHECK( sync.get_Valid() );
+    // The largest lower bound of the offset.
+    CHECK( sync.get_Offset() == 0.75 );
+    sync.Reset();
+    CHECK( !sync.get_Valid() );
+}
@@ -0,0 +1,107 @@
+#include <Test.h>
+
+#include <Geometry.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+using namespace Math;
+
+namespace
+{
+    // A grid of ( size + 1 ) x ( size + 1 ) vertices with shuffled triangles.
+    void ComputeShuffledGrid( VertexCollection& vertices, IndexCollection& indices, size_t size )
+    {
+        size_t stride = size + 1;
+        for ( size_t z = 0; z <= size; ++z )
+        {
+            for ( size_t x = 0; x <= size; ++x )
+            {
+                float u = static_cast<float>( x ) / size;
+                float v = static_cast<float>( z ) / size;
+                vertices.push_back( VertexPositionNormalTexture( Float3( u, 0.0f, v ), Float3( 0, 1, 0 ), Float2( u, v ) ) );
+            }
+        }
+
+        std::vector<uint32_t> cells( size * size );
+        std::iota( cells.begin(), cells.end(), 0 );
+        std::shuffle( cells.begin(), cells.end(), std::mt19937( 1234 ) );
+
+        for ( uint32_t cell : cells )
+        {
+            uint32_t i0 = static_cast<uint32_t>( ( cell / size ) * stride + cell % size );
+            uint32_t i1 = i0 + 1;
+            uint32_t i2 = i0 + static_cast<uint32_t>( stride );
+            uint32_t i3 = i2 + 1;
+
+            indices.push_back( i0 ); indices.push_back( i2 ); indices.push_back( i1 );
+            indices.push_back( i1 ); indices.push_back( i2 ); indices.push_back( i3 );
+        }
+    }
+
+    bool operator==( const VertexPositionNormalTexture& a, const VertexPositionNormalTexture& b )
+    {
+        return a.position.x == b.position.x && a.position.y == b.position.y && a.position.z == b.position.z &&
+               a.textureCoordinate.x == b.textureCoordinate.x && a.textureCoordinate.y == b.textureCoordinate.y;
+    }
+}
+
+TEST( IndexCollection, WidensOnLargeIndex )
+{
+    IndexCollection indices;
+    indices.push_back( 1 );
+    indices.push_back( IndexCollection::MaxIndex16 );
+    CHECK( !indices.get_Is32Bit() );
+    CHECK( indices.get_IndexSize() == 2 );
+    CHECK( indices.get_SizeInBytes() == 4 );
+
+    indices.push_back( IndexCollection::MaxIndex16 + 1 );
+    CHECK( indices.get_Is32Bit() );
+    CHECK( indices.get_IndexSize() == 4 );
+    REQUIRE( indices.size() == 3 );
+    CHECK( indices[0] == 1 );
+    CHECK( indices[1] == IndexCollection::MaxIndex16 );
+    CHECK( indices[2] == IndexCollection::MaxIndex16 + 1 );
+
+    indices.set( 0, 100000 );
+    CHECK( indices[0] == 100000 );
+
+    indices.clear();
+    CHECK( indices.empty() );
+    CHECK( !indices.get_Is32Bit() );
+}
+
+TEST( IndexCollection, SplitMesh16PreservesTriangles )
+{
+    VertexCollection vertices;
+    IndexCollection indices;
+    ComputeShuffledGrid( vertices, indices, 300 );
+    REQUIRE( indices.get_Is32Bit() );
+
+    VertexCollection splitVertices;
+    IndexCollection splitIndices;
+    SubMeshCollection subMeshes;
+    SplitMesh16( vertices, indices, splitVertices, splitIndices, subMeshes );
+
+    CHECK( !splitIndices.get_Is32Bit() );
+    CHECK( subMeshes.size() > 1 );
+    REQUIRE( splitIndices.size() == indices.size() );
+
+    // Every triangle of the submeshes references the same vertices as the original
+    // triangle, and the submeshes cover the indices in order.
+    uint32_t nextIndex = 0;
+    for ( const SubMesh& subMesh : subMeshes )
+    {
+        CHECK( subMesh.StartIndex == nextIndex );
+        CHECK( subMesh.VertexCount <= IndexCollection::MaxIndex16 + 1 );
+        for ( uint32_t i = subMesh.StartIndex; i < subMesh.StartIndex + subMesh.IndexCount; ++i )
+        {
+            uint32_t index = splitIndices[i];
+            REQUIRE( index < subMesh.VertexCount );
+            REQUIRE( splitVertices[subMesh.BaseVertex + index] == vertices[indices[i]] );
+        }
+        nextIndex += subMesh.IndexCount;
+    }
+    CHECK( nextIndex == indices.size() );
+}
@@ -0,0 +1,70 @@
+/**
+ * @brief The deque stress of the JobSystem tests and benchmarks.
+ *
+ * StressQueue pushes and pops tokens on a WorkStealingQueue while other threads
+ * steal from it, and counts how often each token was taken.
+ */
+#pragma once
+
+#include <JobSystem.h>
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace JobSystemStress
+{
+    // The owner pushes and pops while the other threads steal. Returns the number of
+    // times each token (1 to numTokens) was taken.
+    inline std::vector<uint32_t> StressQueue( size_t numThieves, size_t numTokens )
+    {
+        WorkStealingQueue queue( 256 );
+        std::vector< std::atomic<uint32_t> > taken( numTokens + 1 );
+        for ( std::atomic<uint32_t>& count : taken ) count.store( 0 );
+
+        std::atomic<bool> done( false );
+        std::vector<std::thread> thieves;
+        for ( size_t i = 0; i < numThieves; ++i )
+        {
+            thieves.push_back( std::thread( [&]()
+            {
+                while ( !done.load() )
+                {
+                    Job* job = queue.Steal();
+                    if ( job ) taken[reinterpret_cast<uintptr_t>( job )].fetch_add( 1 );
+                }
+            } ) );
+        }
+
+        // Tokens are fake job pointers; they are never dereferenced.
+        std::mt19937 random( 7 );
+        for ( uintptr_t token = 1; token <= numTokens; ++token )
+        {
+            while ( !queue.Push( reinterpret_cast<Job*>( token ) ) )
+            {
+                Job* job = queue.Pop();
+                if ( job ) taken[reinterpret_cast<uintptr_t>( job )].fetch_add( 1 );
+            }
+            if ( random() % 3 == 0 )
+            {
+                Job* job = queue.Pop();
+                if ( job ) taken[reinterpret_cast<uintptr_t>( job )].fetch_add( 1 );
+            }
+        }
+        while ( Job* job = queue.Pop() )
+        {
+            taken[reinterpret_cast<uintptr_t>( job )].fetch_add( 1 );
+        }
+        // Wait for the thieves that are still in the middle of a steal.
+        done.store( true );
+        for ( std::thread& thief : thieves ) thief.join();
+
+        std::vector<uint32_t> counts;
+        for ( size_t token = 1; token <= numTokens; ++token )
+        {
+            counts.push_back( taken[token].load() );
+        }
+        return counts;
+    }
+}
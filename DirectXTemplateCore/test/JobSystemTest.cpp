@@ -0,0 +1,225 @@
+#include <Test.h>
+
+#include <JobSystem.h>
+#include <JobSystemStress.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace JobSystemStress;
+
+namespace
+{
+    // The thread counts to test (more threads than cores so that stealing and
+    // sleeping are also tested on small machines).
+    const size_t ThreadCounts[] = { 1, 2, 4 };
+}
+
+TEST( JobSystem, QueueTakesEveryJobOnce )
+{
+    WorkStealingQueue queue( 4 );
+    for ( uintptr_t token = 1; token <= 4; ++token )
+    {
+        CHECK( queue.Push( reinterpret_cast<Job*>( token ) ) );
+    }
+    CHECK( !queue.Push( reinterpret_cast<Job*>( 5 ) ) );
+    CHECK( queue.Size() == 4 );
+    // The owner takes the newest job, thieves take the oldest.
+    CHECK( queue.Pop() == reinterpret_cast<Job*>( 4 ) );
+    CHECK( queue.Steal() == reinterpret_cast<Job*>( 1 ) );
+    CHECK( queue.Size() == 2 );
+
+    for ( size_t numThieves = 0; numThieves <= 3; ++numThieves )
+    {
+        std::vector<uint32_t> counts = StressQueue( numThieves, 100000 );
+        for ( size_t token = 0; token < counts.size(); ++token )
+        {
+            REQUIRE( counts[token] == 1 );
+        }
+    }
+}
+
+TEST( JobSystem, Jobs )
+{
+    for ( size_t numThreads : ThreadCounts )
+    {
+        JobSystem jobSystem( numThreads );
+        CHECK( jobSystem.get_NumThreads() == numThreads );
+        CHECK( jobSystem.get_ThreadIndex() == 0 );
+
+        const int numJobs = 20000;
+        std::atomic<int> sum( 0 );
+        JobCounter counter;
+        for ( int i = 0; i < numJobs; ++i )
+        {
+            jobSystem.Run( [&sum, i]() { sum.fetch_add( i ); }, &counter );
+        }
+        jobSystem.Wait( counter );
+        CHECK( counter.IsDone() );
+        CHECK( sum.load() == numJobs * ( numJobs - 1 ) / 2 );
+
+        // A tree of jobs: every job starts two children until the depth is reached.
+        std::atomic<int> numNodes( 0 );
+        JobCounter treeCounter;
+        std::function<void( int )> node = [&]( int depth )
+        {
+            numNodes.fetch_add( 1 );
+            if ( depth == 0 ) return;
+            jobSystem.Run( [&node, depth]() { node( depth - 1 ); }, &treeCounter );
+            jobSystem.Run( [&node, depth]() { node( depth - 1 ); }, &treeCounter );
+        };
+        jobSystem.Run( [&node]() { node( 12 ); }, &treeCounter );
+        jobSystem.Wait( treeCounter );
+        CHECK( numNodes.load() == ( 1 << 13 ) - 1 );
+
+        // Jobs that wait for their own child jobs.
+        std::atomic<int> nested( 0 );
+        JobCounter outerCounter;
+        for ( int i = 0; i < 64; ++i )
+        {
+            jobSystem.Run( [&jobSystem, &nested]()
+            {
+                JobCounter innerCounter;
+                for ( int j = 0; j < 16; ++j )
+                {
+                    jobSystem.Run( [&nested]() { nested.fetch_add( 1 ); }, &innerCounter );
+                }
+                jobSystem.Wait( innerCounter );
+            }, &outerCounter );
+        }
+        jobSystem.Wait( outerCounter );
+        CHECK( nested.load() == 64 * 16 );
+    }
+}
+
+TEST( JobSystem, RunAfterStartsDependents )
+{
+    for ( size_t numThreads : ThreadCounts )
+    {
+        JobSystem jobSystem( numThreads );
+        for ( int iteration = 0; iteration < 500; ++iteration )
+        {
+            // A diamond: A before B and C, both before D.
+            std::atomic<int> a( 0 ), b( 0 ), c( 0 ), d( 0 );
+            JobCounter aCounter, bcCounter, dCounter;
+            jobSystem.Run( [&]() { a.store( 1 ); }, &aCounter );
+            jobSystem.RunAfter( aCounter, [&]() { b.store( a.load() + 1 ); }, &bcCounter );
+            jobSystem.RunAfter( aCounter, [&]() { c.store( a.load() + 2 ); }, &bcCounter );
+            jobSystem.RunAfter( bcCounter, [&]() { d.store( b.load() + c.load() ); }, &dCounter );
+            jobSystem.Wait( dCounter );
+            jobSystem.Wait( aCounter );
+            jobSystem.Wait( bcCounter );
+            REQUIRE( d.load() == 5 );
+
+            // Each stage of a chain starts after the previous one.
+            const int numStages = 16;
+            std::vector<int> order;
+            std::mutex mutex;
+            JobCounter stages[numStages];
+            jobSystem.Run( [&]() { std::lock_guard<std::mutex> lock( mutex ); order.push_back( 0 ); }, &stages[0] );
+            for ( int stage = 1; stage < numStages; ++stage )
+            {
+                jobSystem.RunAfter( stages[stage - 1], [&, stage]() { std::lock_guard<std::mutex> lock( mutex ); order.push_back( stage ); }, &stages[stage] );
+            }
+            for ( JobCounter& stage : stages ) jobSystem.Wait( stage );
+            REQUIRE( order.size() == numStages );
+            for ( int stage = 0; stage < numStages; ++stage )
+            {
+                REQUIRE( order[stage] == stage );
+            }
+        }
+
+        // A dependency that is already done starts the job immediately.
+        JobCounter done, counter;
+        std::atomic<bool> executed( false );
+        jobSystem.RunAfter( done, [&]() { executed.store( true ); }, &counter );
+        jobSystem.Wait( counter );
+        CHECK( executed.load() );
+    }
+}
+
+TEST( JobSystem, ParallelForVisitsEveryIndexOnce )
+{
+    std::mt19937 random( 11 );
+    for ( size_t numThreads : ThreadCounts )
+    {
+        JobSystem jobSystem( numThreads );
+        for ( int iteration = 0; iteration < 300; ++iteration )
+        {
+            // Includes empty ranges and ranges that are smaller than the grain size.
+            size_t begin = random() % 100;
+            size_t end = begin + random() % 20000 * ( iteration % 10 != 0 );
+            size_t grainSize = 1 + random() % 500;
+
+            std::vector< std::atomic<uint32_t> > visits( end + 1 );
+            for ( std::atomic<uint32_t>& count : visits ) count.store( 0 );
+            std::atomic<bool> validRanges( true );
+            jobSystem.ParallelFor( begin, end, grainSize, [&]( size_t rangeBegin, size_t rangeEnd )
+            {
+                if ( rangeEnd <= rangeBegin || rangeEnd - rangeBegin > grainSize ) validRanges.store( false );
+                for ( size_t i = rangeBegin; i < rangeEnd; ++i ) visits[i].fetch_add( 1 );
+            } );
+
+            REQUIRE( validRanges.load() );
+            for ( size_t i = 0; i < visits.size(); ++i )
+            {
+                REQUIRE( visits[i].load() == ( i >= begin && i < end ? 1u : 0u ) );
+            }
+        }
+    }
+}
+
+// Workers go to sleep between bursts of work and must wake up for the next burst
+// without losing a job.
+TEST( JobSystem, WorkersSleepAndWake )
+{
+    for ( size_t numThreads : ThreadCounts )
+    {
+        JobSystem jobSystem( numThreads );
+        for ( int burst = 0; burst < 200; ++burst )
+        {
+            // Give the workers time to run out of work and sleep (every few bursts),
+            // or start the next burst while they are falling asleep.
+            if ( burst % 4 == 0 )
+            {
+                std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+            }
+
+            const int numJobs = 1 + burst % 64;
+            std::atomic<int> executed( 0 );
+            JobCounter counter;
+            for ( int i = 0; i < numJobs; ++i )
+            {
+                jobSystem.Run( [&executed]() { executed.fetch_add( 1 ); }, &counter );
+            }
+            jobSystem.Wait( counter );
+            REQUIRE( executed.load() == numJobs );
+        }
+
+        JobSystem::Statistics statistics = jobSystem.get_Statistics();
+        if ( numThreads > 1 )
+        {
+            CHECK( statistics.Sleeps > 0 );
+        }
+        jobSystem.ResetStatistics();
+        CHECK( jobSystem.get_Statistics().JobsExecuted == 0 );
+    }
+
+    // Starting and stopping the threads while they sleep or work.
+    for ( int i = 0; i < 50; ++i )
+    {
+        JobSystem jobSystem( 4 );
+        JobCounter counter;
+        std::atomic<int> executed( 0 );
+        for ( int j = 0; j < i; ++j )
+        {
+            jobSystem.Run( [&executed]() { executed.fetch_add( 1 ); }, &counter );
+        }
+        jobSystem.Wait( counter );
+        REQUIRE( executed.load() == i );
+    }
+}
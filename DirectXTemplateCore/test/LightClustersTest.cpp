@@ -0,0 +1,151 @@
+#include <Test.h>
+
+#include <Camera.h>
+#include <JobSystem.h>
+#include <LightClusters.h>
+#include <VenueScene.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace Math;
+using namespace VenueScene;
+
+namespace
+{
+    bool MatchesBruteForce( const LightClusters& clusters, const std::vector< std::vector<uint32_t> >& clusterLights )
+    {
+        const std::vector<LightCluster>& grid = clusters.get_Clusters();
+        const std::vector<uint32_t>& indices = clusters.get_LightIndices();
+        for ( size_t c = 0; c < grid.size(); ++c )
+        {
+            if ( grid[c].Count != clusterLights[c].size() ||
+                 !std::equal( clusterLights[c].begin(), clusterLights[c].end(), indices.begin() + grid[c].Offset ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Every light that contains a point in the view frustum must be in the cluster of the point.
+    bool IsConservative( const LightClusters& clusters, const BoundingSphereArrays& lights, int numPoints )
+    {
+        std::mt19937 random( 5678 );
+        std::uniform_real_distribution<float> ndc( -0.999f, 0.999f );
+        std::uniform_real_distribution<float> depth( 0.1f, 250.0f );
+
+        const std::vector<LightCluster>& grid = clusters.get_Clusters();
+        const std::vector<uint32_t>& indices = clusters.get_LightIndices();
+        for ( int i = 0; i < numPoints; ++i )
+        {
+            float ndcX = ndc( random );
+            float ndcY = ndc( random );
+            float z = depth( random );
+            Float3 point( ndcX * z * TanHalfFoV * AspectRatio, ndcY * z * TanHalfFoV, z );
+
+            uint32_t x = static_cast<uint32_t>( ( ndcX + 1.0f ) * 0.5f * clusters.get_NumTilesX() );
+            uint32_t y = static_cast<uint32_t>( ( 1.0f - ndcY ) * 0.5f * clusters.get_NumTilesY() );
+            const LightCluster& cluster = grid[clusters.GetClusterIndex( x, y, clusters.GetSlice( z ) )];
+            const uint32_t* first = indices.data() + cluster.Offset;
+            const uint32_t* last = first + cluster.Count;
+
+            for ( size_t l = 0; l < lights.Size(); ++l )
+            {
+                BoundingSphere sphere = lights.Get( l );
+                if ( LengthSq( point - sphere.Center ) < sphere.Radius * sphere.Radius * 0.999f && !std::binary_search( first, last, static_cast<uint32_t>( l ) ) )
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+TEST( LightClusters, AttenuationRange )
+{
+    Light light;
+    light.LightType = PointLight;
+    light.ConstantAttenuation = 1.0f;
+    light.LinearAttenuation = 0.0f;
+    light.QuadraticAttenuation = 1.0f;
+
+    // 1 / ( 1 + d^2 ) = 1 / 256 at d = sqrt( 255 ).
+    light.Range = AttenuationRange( light );
+    CHECK( std::abs( light.Range - std::sqrt( 255.0f ) ) < 1e-3f );
+    CHECK( LightBounds( light ).Radius == light.Range );
+
+    // The cone of a narrow spot light is bounded by a sphere through its apex and its rim.
+    light.LightType = SpotLight;
+    light.Direction = Float4( 0.0f, 0.0f, 1.0f, 0.0f );
+    light.SpotAngle = ConvertToRadians( 30.0f );
+    BoundingSphere cone = LightBounds( light );
+    CHECK( cone.Radius < light.Range );
+    CHECK( Length( cone.Center - XYZ( light.Position ) ) <= cone.Radius + 1e-4f );
+    Float3 rim( light.Range * std::sin( light.SpotAngle ), 0.0f, light.Range * std::cos( light.SpotAngle ) );
+    CHECK( Length( rim - cone.Center ) <= cone.Radius + 1e-4f );
+
+    light.LightType = DirectionalLight;
+    CHECK( std::isinf( AttenuationRange( light ) ) );
+    CHECK( std::isinf( LightBounds( light ).Radius ) );
+}
+
+// The assignment matches a brute-force test of every cluster, on one and on several
+// threads, and every light that lights a point is in the cluster of the point.
+TEST( LightClusters, AssignMatchesBruteForce )
+{
+    Camera camera = CreateCamera();
+    LightClusters clusters;
+    clusters.SetProjection( camera );
+    LightClusters parallelClusters;
+    parallelClusters.SetProjection( camera );
+    JobSystem jobSystem( 4 );
+
+    BoundingSphereArrays bounds;
+    std::vector< std::vector<uint32_t> > bruteForce;
+    for ( size_t numLights = 1; numLights <= 1024; numLights *= 4 )
+    {
+        ViewSpaceBounds( GenerateLights( numLights ), camera.get_ViewMatrix(), bounds );
+        clusters.AssignLights( bounds );
+        parallelClusters.AssignLights( bounds, &jobSystem );
+
+        CHECK( clusters.get_LightIndices() == parallelClusters.get_LightIndices() );
+        for ( size_t c = 0; c < clusters.get_NumClusters(); ++c )
+        {
+            REQUIRE( clusters.get_Clusters()[c].Offset == parallelClusters.get_Clusters()[c].Offset );
+            REQUIRE( clusters.get_Clusters()[c].Count == parallelClusters.get_Clusters()[c].Count );
+        }
+
+        AssignBruteForce( clusters, bounds, bruteForce );
+        CHECK( MatchesBruteForce( clusters, bruteForce ) );
+        CHECK( IsConservative( clusters, bounds, 2000 ) );
+
+        // The directional light is in every cluster.
+        for ( const LightCluster& cluster : clusters.get_Clusters() )
+        {
+            REQUIRE( cluster.Count > 0 && clusters.get_LightIndices()[cluster.Offset] == 0 );
+        }
+    }
+}
+
+TEST( LightClusters, Slices )
+{
+    LightClusters clusters( 16, 9, 24 );
+    clusters.SetProjection( 60.0f, AspectRatio, 0.1f, 250.0f );
+    CHECK( clusters.get_NumClusters() == 16 * 9 * 24 );
+
+    // The slices cover the depth range in order and are clamped outside of it.
+    CHECK( clusters.GetSlice( 0.01f ) == 0 );
+    CHECK( clusters.GetSlice( 1000.0f ) == 23 );
+    uint32_t previous = 0;
+    for ( float depth = 0.1f; depth < 250.0f; depth *= 1.1f )
+    {
+        uint32_t slice = clusters.GetSlice( depth );
+        REQUIRE( slice >= previous );
+        BoundingBox box = clusters.GetClusterBounds( clusters.GetClusterIndex( 0, 0, slice ) );
+        REQUIRE( depth >= box.Center.z - box.Extents.z - 1e-3f && depth <= box.Center.z + box.Extents.z + 1e-3f );
+        previous = slice;
+    }
+}
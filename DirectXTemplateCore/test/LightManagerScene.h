@@ -0,0 +1,179 @@
+/**
+ * @brief The lights of the LightManager tests and benchmarks.
+ *
+ * The animated and static lights of the demo, and SimulatedLightBuffer, which uploads
+ * the dirty lights of a LightManager like LightBuffer does to a simulated GPU.
+ */
+#pragma once
+
+#include <LightClusters.h>
+#include <LightManager.h>
+#include <RingAllocator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace LightManagerScene
+{
+    const int NumAnimatedLights = 8;
+
+    // Small static point lights that are scattered around the room (like the -lights option of the demo).
+    inline Light CreateStaticLight( std::mt19937& random )
+    {
+        std::uniform_real_distribution<float> positionXZ( -9.5f, 9.5f );
+        std::uniform_real_distribution<float> positionY( 0.25f, 6.0f );
+        std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+
+        Light light;
+        light.Enabled = 1;
+        light.LightType = PointLight;
+        light.Color = Math::Float4( unit( random ), unit( random ), unit( random ), 1.0f );
+        light.Position = Math::Float4( positionXZ( random ), positionY( random ), positionXZ( random ), 1.0f );
+        light.QuadraticAttenuation = 16.0f + 48.0f * unit( random );
+        light.Range = AttenuationRange( light );
+        return light;
+    }
+
+    // The lights that circle the room.
+    inline Math::Float3 AnimatedLightPosition( int i, float time )
+    {
+        float angle = time + Math::TwoPi * i / NumAnimatedLights;
+        return Math::Float3( std::sin( angle ) * 8.0f, 9.0f, std::cos( angle ) * 8.0f );
+    }
+
+    /**
+     * Add the animated lights of the demo followed by numStaticLights static lights
+     * and return the handles of the animated lights.
+     */
+    inline void AddLights( LightManager& lights, uint32_t numStaticLights, std::mt19937& random, LightHandle animated[NumAnimatedLights] )
+    {
+        for ( int i = 0; i < NumAnimatedLights; ++i )
+        {
+            Light light;
+            light.Enabled = 1;
+            light.LightType = ( i == 3 || i == 7 ) ? PointLight : SpotLight;
+            light.Position = Math::Float4( AnimatedLightPosition( i, 0.0f ), 1.0f );
+            light.LinearAttenuation = 0.08f;
+            animated[i] = lights.Add( light );
+        }
+        for ( uint32_t i = 0; i < numStaticLights; ++i )
+        {
+            lights.Add( CreateStaticLight( random ) );
+        }
+    }
+
+    // Move the animated lights to their positions at time.
+    inline void AnimateLights( LightManager& lights, const LightHandle animated[NumAnimatedLights], float time )
+    {
+        for ( int i = 0; i < NumAnimatedLights; ++i )
+        {
+            lights.SetPosition( animated[i], AnimatedLightPosition( i, time ) );
+        }
+    }
+
+    /**
+     * Uploads the dirty lights like LightBuffer: the dirty ranges are written one after
+     * the other to a staging ring, and each range is copied to the light buffer. The
+     * GPU is simulated and finishes a frame framesInFlight frames after the CPU.
+     */
+    class SimulatedLightBuffer
+    {
+    public:
+        SimulatedLightBuffer( size_t stagingSize )
+            : m_Ring( stagingSize - stagingSize % sizeof( Light ), 16 )
+            , m_Staging( m_Ring.get_Capacity() )
+            , m_Stalls( 0 )
+        {}
+
+        // Returns the number of bytes that were uploaded.
+        size_t Update( LightManager& lights )
+        {
+            if ( lights.get_NumLights() > m_Lights.size() )
+            {
+                m_Lights.resize( std::max<size_t>( lights.get_NumLights(), 2 * m_Lights.size() ) );
+                lights.MarkAllDirty();
+            }
+
+            lights.GetDirtyRanges( m_Ranges );
+            size_t numLights = 0;
+            for ( const LightManager::DirtyRange& range : m_Ranges )
+            {
+                numLights += range.Count;
+            }
+
+            size_t size = numLights * sizeof( Light );
+            if ( size > 0 )
+            {
+                size_t offset = m_Ring.Allocate( size );
+                while ( offset == RingAllocator::InvalidOffset && m_Ring.get_NumFramesInFlight() > 0 )
+                {
+                    ++m_Stalls;
+                    m_Ring.ReleaseCompletedFrames( m_Ring.get_OldestFenceValue() );
+                    offset = m_Ring.Allocate( size );
+                }
+
+                if ( offset != RingAllocator::InvalidOffset )
+                {
+                    Light* staging = reinterpret_cast<Light*>( &m_Staging[offset] );
+                    for ( const LightManager::DirtyRange& range : m_Ranges )
+                    {
+                        lights.WriteLights( range.Offset, range.Count, staging );
+                        memcpy( &m_Lights[range.Offset], staging, range.Count * sizeof( Light ) );
+                        staging += range.Count;
+                    }
+                }
+                else
+                {
+                    // The ranges do not fit in the ring (UpdateSubresource).
+                    for ( const LightManager::DirtyRange& range : m_Ranges )
+                    {
+                        lights.WriteLights( range.Offset, range.Count, &m_Lights[range.Offset] );
+                    }
+                }
+            }
+
+            lights.ClearDirty();
+            return size;
+        }
+
+        void EndFrame( uint64_t frame, uint64_t framesInFlight )
+        {
+            m_Ring.FinishFrame( frame );
+            if ( frame > framesInFlight )
+            {
+                m_Ring.ReleaseCompletedFrames( frame - framesInFlight );
+            }
+        }
+
+        // Returns true if the buffer holds the lights of the LightManager.
+        bool Matches( const LightManager& lights ) const
+        {
+            std::vector<Light> expected( lights.get_NumLights() );
+            if ( !expected.empty() )
+            {
+                lights.WriteLights( 0, lights.get_NumLights(), expected.data() );
+            }
+            return memcmp( expected.data(), m_Lights.data(), expected.size() * sizeof( Light ) ) == 0;
+        }
+
+        const std::vector<LightManager::DirtyRange>& get_Ranges() const
+        {
+            return m_Ranges;
+        }
+
+        uint64_t get_Stalls() const
+        {
+            return m_Stalls;
+        }
+
+    private:
+        RingAllocator m_Ring;
+        std::vector<uint8_t> m_Staging;
+        std::vector<Light> m_Lights;
+        std::vector<LightManager::DirtyRange> m_Ranges;
+        uint64_t m_Stalls;
+    };
+}
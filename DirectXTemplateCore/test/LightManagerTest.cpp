@@ -0,0 +1,166 @@
+#include <Test.h>
+
+#include <LightManager.h>
+#include <LightManagerScene.h>
+
+#include <cstring>
+#include <random>
+
+using namespace Math;
+using namespace LightManagerScene;
+
+TEST( LightManager, Handles )
+{
+    LightManager lights;
+    LightHandle invalid = {};
+    CHECK( !lights.IsValid( invalid ) );
+
+    std::mt19937 random( 1234 );
+    LightHandle a = lights.Add( CreateStaticLight( random ) );
+    LightHandle b = lights.Add( CreateStaticLight( random ) );
+    LightHandle c = lights.Add( CreateStaticLight( random ) );
+    CHECK( lights.get_NumLights() == 3 );
+    CHECK( lights.GetIndex( c ) == 2 );
+
+    // The last light moves into the place of the removed light.
+    Light lightC = lights.Get( c );
+    lights.Remove( a );
+    CHECK( !lights.IsValid( a ) );
+    CHECK( lights.IsValid( b ) && lights.IsValid( c ) );
+    CHECK( lights.get_NumLights() == 2 );
+    CHECK( lights.GetIndex( c ) == 0 );
+    Light moved = lights.GetAt( 0 );
+    CHECK( memcmp( &moved, &lightC, sizeof( Light ) ) == 0 );
+
+    // A reused slot does not make the old handle valid again.
+    LightHandle d = lights.Add( CreateStaticLight( random ) );
+    CHECK( d.Slot == a.Slot && d.Generation != a.Generation );
+    CHECK( !lights.IsValid( a ) );
+
+    lights.Clear();
+    CHECK( lights.get_NumLights() == 0 );
+    CHECK( !lights.IsValid( b ) && !lights.IsValid( c ) && !lights.IsValid( d ) );
+}
+
+TEST( LightManager, DirtyRanges )
+{
+    LightManager lights;
+    std::mt19937 random( 1234 );
+    std::vector<LightHandle> handles;
+    for ( int i = 0; i < 100; ++i )
+    {
+        handles.push_back( lights.Add( CreateStaticLight( random ) ) );
+    }
+    lights.ClearDirty();
+
+    std::vector<LightManager::DirtyRange> ranges;
+    lights.GetDirtyRanges( ranges );
+    CHECK( ranges.empty() );
+    CHECK( lights.get_NumDirtyLights() == 0 );
+
+    // Lights that are close together are merged, the others are not.
+    lights.SetColor( handles[50], Float4( 1, 0, 0, 1 ) );
+    lights.SetColor( handles[10], Float4( 1, 0, 0, 1 ) );
+    lights.SetColor( handles[12], Float4( 1, 0, 0, 1 ) );
+    lights.SetColor( handles[10], Float4( 0, 1, 0, 1 ) );
+    CHECK( lights.get_NumDirtyLights() == 3 );
+    lights.GetDirtyRanges( ranges, 4 );
+    REQUIRE( ranges.size() == 2 );
+    CHECK( ranges[0].Offset == 10 && ranges[0].Count == 3 );
+    CHECK( ranges[1].Offset == 50 && ranges[1].Count == 1 );
+    lights.GetDirtyRanges( ranges, 0 );
+    CHECK( ranges.size() == 3 );
+
+    // Setting the same shadow index does not mark the light as dirty.
+    lights.ClearDirty();
+    lights.SetShadowIndex( handles[5], lights.Get( handles[5] ).ShadowIndex );
+    CHECK( lights.get_NumDirtyLights() == 0 );
+
+    lights.MarkAllDirty();
+    lights.GetDirtyRanges( ranges );
+    REQUIRE( ranges.size() == 1 );
+    CHECK( ranges[0].Offset == 0 && ranges[0].Count == 100 );
+}
+
+// Upload only the dirty lights through a staging ring for a scene with static lights
+// and eight animated lights. The simulated light buffer must always hold the lights.
+TEST( LightManager, Upload )
+{
+    const int numFrames = 50;
+    const uint64_t framesInFlight = 3;
+
+    for ( uint32_t numStaticLights = 16; numStaticLights <= 4096; numStaticLights *= 16 )
+    {
+        std::mt19937 random( 1234 );
+
+        LightManager lights;
+        LightHandle animated[NumAnimatedLights];
+        AddLights( lights, numStaticLights, random, animated );
+
+        SimulatedLightBuffer buffer( 1024 * 1024 );
+        lights.MarkAllDirty();
+        buffer.Update( lights );
+        CHECK( buffer.Matches( lights ) );
+
+        // Only the animated lights are uploaded after the first frame.
+        for ( int frame = 0; frame < numFrames; ++frame )
+        {
+            AnimateLights( lights, animated, frame * 0.01f );
+            CHECK( buffer.Update( lights ) == NumAnimatedLights * sizeof( Light ) );
+            buffer.EndFrame( frame + 1, framesInFlight );
+        }
+        CHECK( buffer.Matches( lights ) );
+
+        // Remove every third static light and move some of the others. The handles of
+        // the lights that are left must still find them, and the removed handles must
+        // be invalid.
+        std::vector<LightHandle> handles;
+        for ( uint32_t i = 0; i < numStaticLights; ++i )
+        {
+            handles.push_back( lights.Add( CreateStaticLight( random ) ) );
+        }
+        std::vector<Light> expected;
+        for ( size_t i = 0; i < handles.size(); ++i )
+        {
+            expected.push_back( lights.Get( handles[i] ) );
+        }
+        for ( size_t i = 0; i < handles.size(); i += 3 )
+        {
+            lights.Remove( handles[i] );
+        }
+        for ( size_t i = 1; i < handles.size(); i += 7 )
+        {
+            if ( lights.IsValid( handles[i] ) )
+            {
+                expected[i].Position = Float4( 0.0f, static_cast<float>( i ), 0.0f, 1.0f );
+                lights.SetPosition( handles[i], XYZ( expected[i].Position ) );
+            }
+        }
+        for ( size_t i = 0; i < handles.size(); ++i )
+        {
+            bool removed = ( i % 3 == 0 );
+            REQUIRE( lights.IsValid( handles[i] ) != removed );
+            if ( !removed )
+            {
+                Light light = lights.Get( handles[i] );
+                REQUIRE( memcmp( &expected[i], &light, sizeof( Light ) ) == 0 );
+            }
+        }
+        buffer.Update( lights );
+        CHECK( buffer.Matches( lights ) );
+        CHECK( lights.get_NumDirtyLights() == 0 );
+
+        // The counts of the enabled lights of each type (for the shader variants) follow the changes.
+        lights.SetEnabled( animated[0], false );
+        uint32_t numEnabledLights[LightTypeCount] = {};
+        for ( uint32_t i = 0; i < lights.get_NumLights(); ++i )
+        {
+            Light light = lights.GetAt( i );
+            numEnabledLights[light.LightType] += light.Enabled ? 1 : 0;
+        }
+        for ( int type = 0; type < LightTypeCount; ++type )
+        {
+            CHECK( lights.GetNumEnabledLights( static_cast<LightType>( type ) ) == numEnabledLights[type] );
+        }
+    }
+}
@@ -0,0 +1,170 @@
+#include <Test.h>
+
+#include <Geometry.h>
+#include <MeshCache.h>
+#include <Meshlets.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    // A sphere with a full-detail LOD and meshlets, stored in the working directory.
+    struct TestMesh
+    {
+        TestMesh()
+        {
+            ComputeSphere( Vertices, Indices, 1.0f, 32, false );
+            BuildMeshlets( Vertices, Indices, Meshlets );
+
+            SubMesh subMesh = { 0, static_cast<uint32_t>( Indices.size() ), 0, static_cast<uint32_t>( Vertices.size() ) };
+            SubMeshes.push_back( subMesh );
+            MeshLod lod = { 0, static_cast<uint32_t>( Indices.size() ), 0.0f };
+            Lods.push_back( lod );
+        }
+
+        MeshData GetMeshData() const
+        {
+            MeshData mesh = {};
+            mesh.VertexLayout = MeshVertexLayoutFullPrecision;
+            mesh.VertexStride = GetVertexStride( MeshVertexLayoutFullPrecision );
+            mesh.VertexCount = static_cast<uint32_t>( Vertices.size() );
+            mesh.Vertices = Vertices.data();
+            mesh.IndexSize = static_cast<uint32_t>( Indices.get_IndexSize() );
+            mesh.IndexCount = static_cast<uint32_t>( Indices.size() );
+            mesh.Indices = Indices.data();
+            mesh.SubMeshCount = static_cast<uint32_t>( SubMeshes.size() );
+            mesh.SubMeshes = SubMeshes.data();
+            mesh.LodCount = static_cast<uint32_t>( Lods.size() );
+            mesh.Lods = Lods.data();
+            mesh.MeshletCount = static_cast<uint32_t>( Meshlets.size() );
+            mesh.Meshlets = Meshlets.data();
+            mesh.Box = ComputeBoundingBox( Vertices );
+            mesh.Sphere = ComputeBoundingSphere( Vertices );
+            return mesh;
+        }
+
+        VertexCollection Vertices;
+        IndexCollection Indices;
+        SubMeshCollection SubMeshes;
+        MeshLodCollection Lods;
+        MeshletCollection Meshlets;
+    };
+
+    bool IsEqual( const MeshData& a, const MeshData& b )
+    {
+        return a.VertexLayout == b.VertexLayout && a.VertexCount == b.VertexCount && a.IndexSize == b.IndexSize &&
+               a.IndexCount == b.IndexCount && a.SubMeshCount == b.SubMeshCount && a.LodCount == b.LodCount &&
+               a.MeshletCount == b.MeshletCount &&
+               memcmp( a.Vertices, b.Vertices, static_cast<size_t>( a.VertexCount ) * a.VertexStride ) == 0 &&
+               memcmp( a.Indices, b.Indices, static_cast<size_t>( a.IndexCount ) * a.IndexSize ) == 0 &&
+               memcmp( a.SubMeshes, b.SubMeshes, a.SubMeshCount * sizeof( SubMesh ) ) == 0 &&
+               memcmp( a.Lods, b.Lods, a.LodCount * sizeof( MeshLod ) ) == 0 &&
+               memcmp( a.Meshlets, b.Meshlets, a.MeshletCount * sizeof( Meshlet ) ) == 0 &&
+               memcmp( &a.Box, &b.Box, sizeof( BoundingBox ) ) == 0 &&
+               memcmp( &a.Sphere, &b.Sphere, sizeof( BoundingSphere ) ) == 0;
+    }
+
+    // Overwrite part of a file.
+    bool PatchFile( const std::string& fileName, long offset, const void* data, size_t size )
+    {
+        FILE* file = fopen( fileName.c_str(), "r+b" );
+        if ( !file ) return false;
+        fseek( file, offset, SEEK_SET );
+        bool written = fwrite( data, size, 1, file ) == 1;
+        fclose( file );
+        return written;
+    }
+
+    // Copy the first size bytes of a file to another file.
+    bool TruncateFile( const std::string& fileName, const std::string& truncatedFileName, size_t size )
+    {
+        FILE* file = fopen( fileName.c_str(), "rb" );
+        if ( !file ) return false;
+        std::vector<char> data( size );
+        bool read = fread( data.data(), size, 1, file ) == 1;
+        fclose( file );
+
+        FILE* truncatedFile = fopen( truncatedFileName.c_str(), "wb" );
+        if ( !read || !truncatedFile ) return false;
+        bool written = fwrite( data.data(), size, 1, truncatedFile ) == 1;
+        fclose( truncatedFile );
+        return written;
+    }
+}
+
+TEST( MeshCache, KeyHash )
+{
+    CHECK( MeshCacheKey( "Sphere" ).Add( 1.0f ).Add( 32 ).get_Hash() == MeshCacheKey( "Sphere" ).Add( 1.0f ).Add( 32 ).get_Hash() );
+    CHECK( MeshCacheKey( "Sphere" ).Add( 1.0f ).Add( 32 ).get_Hash() != MeshCacheKey( "Sphere" ).Add( 1.0f ).Add( 33 ).get_Hash() );
+    CHECK( MeshCacheKey( "Sphere" ).Add( 1.0f ).get_Hash() != MeshCacheKey( "Torus" ).Add( 1.0f ).get_Hash() );
+    CHECK( MeshCacheKey( "Sphere" ).Add( 0.0f ).get_Hash() == MeshCacheKey( "Sphere" ).Add( -0.0f ).get_Hash() );
+
+    std::string fileName = MeshCacheKey( "Sphere" ).Add( 1.0f ).get_FileName();
+    CHECK( fileName.compare( 0, 7, "Sphere-" ) == 0 );
+    CHECK( fileName.size() > 5 && fileName.compare( fileName.size() - 5, 5, ".mesh" ) == 0 );
+}
+
+TEST( MeshCache, StoreAndLoad )
+{
+    TestMesh testMesh;
+    MeshData mesh = testMesh.GetMeshData();
+
+    MeshCache cache( "" );
+    MeshCacheKey key( "MeshCacheTest" );
+    key.Add( 1.0f ).Add( 32 );
+
+    MeshFile file;
+    std::remove( cache.get_FileName( key ).c_str() );
+    CHECK( !cache.Load( key, file ) );
+
+    REQUIRE( cache.Store( key, mesh ) );
+    REQUIRE( cache.Load( key, file ) );
+    CHECK( file.get_IsOpen() );
+    CHECK( IsEqual( mesh, file.get_MeshData() ) );
+
+    // The streams are 16-byte aligned in the mapping.
+    CHECK( reinterpret_cast<uintptr_t>( file.get_MeshData().Vertices ) % MeshFileHeader::SectionAlignment == 0 );
+    CHECK( reinterpret_cast<uintptr_t>( file.get_MeshData().Indices ) % MeshFileHeader::SectionAlignment == 0 );
+
+    file.Close();
+    CHECK( !file.get_IsOpen() );
+    std::remove( cache.get_FileName( key ).c_str() );
+}
+
+TEST( MeshCache, InvalidFilesAreRejected )
+{
+    TestMesh testMesh;
+    MeshCache cache( "" );
+    MeshCacheKey key( "MeshCacheTestInvalid" );
+    std::string fileName = cache.get_FileName( key );
+    std::string truncatedFileName = fileName + ".truncated";
+    MeshFile file;
+
+    // A file with another version.
+    REQUIRE( cache.Store( key, testMesh.GetMeshData() ) );
+    uint32_t version = MeshFileHeader::FileVersion + 1;
+    REQUIRE( PatchFile( fileName, offsetof( MeshFileHeader, Version ), &version, sizeof( version ) ) );
+    CHECK( !cache.Load( key, file ) );
+
+    // A file with another magic number.
+    REQUIRE( cache.Store( key, testMesh.GetMeshData() ) );
+    uint32_t magic = 0;
+    REQUIRE( PatchFile( fileName, offsetof( MeshFileHeader, Magic ), &magic, sizeof( magic ) ) );
+    CHECK( !cache.Load( key, file ) );
+
+    // A section that points past the end of the file.
+    REQUIRE( cache.Store( key, testMesh.GetMeshData() ) );
+    uint32_t indexCount = 0x7FFFFFFF;
+    REQUIRE( PatchFile( fileName, offsetof( MeshFileHeader, IndexCount ), &indexCount, sizeof( indexCount ) ) );
+    CHECK( !cache.Load( key, file ) );
+
+    // A truncated file.
+    REQUIRE( cache.Store( key, testMesh.GetMeshData() ) );
+    REQUIRE( TruncateFile( fileName, truncatedFileName, sizeof( MeshFileHeader ) + 64 ) );
+    CHECK( !file.Open( truncatedFileName ) );
+
+    std::remove( fileName.c_str() );
+    std::remove( truncatedFileName.c_str() );
+}
@@ -0,0 +1,66 @@
+/**
+ * @brief The meshes of the MeshOptimizer tests and benchmarks.
+ *
+ * ShuffleTriangles turns a mesh of Geometry.h into a mesh that was never optimized,
+ * and ComputeSphereBlock makes a mesh whose draw order decides the overdraw.
+ */
+#pragma once
+
+#include <Geometry.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace MeshOptimizerMeshes
+{
+    // Shuffle the order of the triangles (a mesh that was never optimized).
+    inline void ShuffleTriangles( IndexCollection& indices )
+    {
+        std::vector<uint32_t> triangles( indices.size() / 3 );
+        std::iota( triangles.begin(), triangles.end(), 0 );
+        std::shuffle( triangles.begin(), triangles.end(), std::mt19937( 1234 ) );
+
+        IndexCollection shuffled;
+        shuffled.reserve( indices.size() );
+        for ( uint32_t triangle : triangles )
+        {
+            shuffled.push_back( indices[triangle * 3] );
+            shuffled.push_back( indices[triangle * 3 + 1] );
+            shuffled.push_back( indices[triangle * 3 + 2] );
+        }
+        indices = shuffled;
+    }
+
+    // A 3 x 3 x 3 block of spheres in a single mesh: the inner spheres are hidden
+    // by the outer spheres, so the draw order of the triangles matters.
+    inline void ComputeSphereBlock( VertexCollection& vertices, IndexCollection& indices, size_t tessellation )
+    {
+        VertexCollection sphereVertices;
+        IndexCollection sphereIndices;
+        ComputeSphere( sphereVertices, sphereIndices, 0.4f, tessellation, false );
+
+        vertices.clear();
+        indices.clear();
+        for ( int z = -1; z <= 1; ++z )
+        {
+            for ( int y = -1; y <= 1; ++y )
+            {
+                for ( int x = -1; x <= 1; ++x )
+                {
+                    uint32_t baseVertex = static_cast<uint32_t>( vertices.size() );
+                    for ( VertexPositionNormalTexture vertex : sphereVertices )
+                    {
+                        vertex.position += Math::Float3( x * 0.3f, y * 0.3f, z * 0.3f );
+                        vertices.push_back( vertex );
+                    }
+                    for ( size_t i = 0; i < sphereIndices.size(); ++i )
+                    {
+                        indices.push_back( baseVertex + sphereIndices[i] );
+                    }
+                }
+            }
+        }
+    }
+}
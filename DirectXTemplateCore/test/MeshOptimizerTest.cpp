@@ -0,0 +1,111 @@
+#include <Test.h>
+
+#include <Geometry.h>
+#include <MeshOptimizer.h>
+#include <MeshOptimizerMeshes.h>
+
+#include <algorithm>
+#include <array>
+
+using namespace Math;
+using namespace MeshOptimizerMeshes;
+
+namespace
+{
+    typedef std::array<float, 9> TrianglePositions;
+
+    /**
+     * The positions of the triangles, each rotated so that it starts at its smallest
+     * vertex (which keeps the winding order) and sorted. Two meshes with the same
+     * triangles have the same list, regardless of the order of the triangles and vertices.
+     */
+    std::vector<TrianglePositions> GetTriangles( const VertexCollection& vertices, const IndexCollection& indices )
+    {
+        std::vector<TrianglePositions> triangles;
+        for ( size_t i = 0; i + 2 < indices.size(); i += 3 )
+        {
+            std::array<std::array<float, 3>, 3> corners;
+            for ( int c = 0; c < 3; ++c )
+            {
+                const Float3& p = vertices[indices[i + c]].position;
+                corners[c] = { { p.x, p.y, p.z } };
+            }
+            int first = static_cast<int>( std::min_element( corners.begin(), corners.end() ) - corners.begin() );
+
+            TrianglePositions triangle;
+            for ( int c = 0; c < 3; ++c )
+            {
+                const std::array<float, 3>& corner = corners[( first + c ) % 3];
+                std::copy( corner.begin(), corner.end(), triangle.begin() + c * 3 );
+            }
+            triangles.push_back( triangle );
+        }
+        std::sort( triangles.begin(), triangles.end() );
+        return triangles;
+    }
+}
+
+TEST( MeshOptimizer, AnalyzeVertexCache )
+{
+    // Two triangles that share an edge: 4 vertices are transformed.
+    IndexCollection indices;
+    const uint32_t quad[6] = { 0, 1, 2, 2, 1, 3 };
+    indices.assign( quad, quad + 6 );
+
+    VertexCache::Statistics statistics = AnalyzeVertexCache( indices, 4, 16, VertexCache::FIFO );
+    CHECK( statistics.Triangles == 2 );
+    CHECK( statistics.VerticesTransformed == 4 );
+    CHECK( statistics.Vertices == 4 );
+    CHECK( statistics.ACMR == 2.0f );
+    CHECK( statistics.ATVR == 1.0f );
+}
+
+TEST( MeshOptimizer, PassesKeepTheTrianglesAndImproveTheCache )
+{
+    VertexCollection vertices;
+    IndexCollection indices;
+    ComputeTorus( vertices, indices, 1.0f, 0.333f, 64, false );
+    ShuffleTriangles( indices );
+
+    std::vector<TrianglePositions> original = GetTriangles( vertices, indices );
+    VertexCache::Statistics before = AnalyzeVertexCache( indices, vertices.size() );
+
+    OptimizeVertexCache( indices, vertices.size() );
+    VertexCache::Statistics cache = AnalyzeVertexCache( indices, vertices.size() );
+    CHECK( GetTriangles( vertices, indices ) == original );
+    CHECK( cache.ACMR < before.ACMR * 0.5f );
+
+    OptimizeOverdraw( indices, vertices, 1.05f );
+    VertexCache::Statistics overdraw = AnalyzeVertexCache( indices, vertices.size() );
+    CHECK( GetTriangles( vertices, indices ) == original );
+    CHECK( overdraw.ACMR <= cache.ACMR * 1.05f + 1e-3f );
+
+    OptimizeVertexFetch( vertices, indices );
+    CHECK( GetTriangles( vertices, indices ) == original );
+
+    // The vertices are in the order in which they are first referenced.
+    uint32_t nextVertex = 0;
+    for ( size_t i = 0; i < indices.size(); ++i )
+    {
+        REQUIRE( indices[i] <= nextVertex );
+        if ( indices[i] == nextVertex ) ++nextVertex;
+    }
+    CHECK( nextVertex == vertices.size() );
+}
+
+TEST( MeshOptimizer, UnreferencedVerticesAreRemoved )
+{
+    VertexCollection vertices;
+    for ( int i = 0; i < 5; ++i )
+    {
+        vertices.push_back( VertexPositionNormalTexture( Float3( static_cast<float>( i ), 0, 0 ), Float3( 0, 1, 0 ), Float2( 0, 0 ) ) );
+    }
+    IndexCollection indices;
+    const uint32_t triangle[3] = { 4, 2, 0 };
+    indices.assign( triangle, triangle + 3 );
+
+    OptimizeVertexFetch( vertices, indices );
+    REQUIRE( vertices.size() == 3 );
+    CHECK( indices[0] == 0 && indices[1] == 1 && indices[2] == 2 );
+    CHECK( vertices[0].position.x == 4.0f && vertices[1].position.x == 2.0f && vertices[2].position.x == 0.0f );
+}
@@ -0,0 +1,112 @@
+/**
+ * @brief The meshes and the deviation measurement of the MeshSimplifier tests and benchmarks.
+ *
+ * ComputeTerrain makes a terrain patch whose border the simplifier locks, and
+ * MeasureDeviation measures how far the surface of a LOD is from the original surface.
+ */
+#pragma once
+
+#include <Geometry.h>
+#include <MeshSimplifier.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace MeshSimplifierMeshes
+{
+    // A rolling terrain patch: the kind of mesh that is drawn far away in large
+    // outdoor scenes. The border of the patch is locked by the simplifier.
+    inline void ComputeTerrain( VertexCollection& vertices, IndexCollection& indices, float size, size_t tessellation )
+    {
+        vertices.clear();
+        indices.clear();
+
+        size_t stride = tessellation + 1;
+        for ( size_t z = 0; z <= tessellation; ++z )
+        {
+            for ( size_t x = 0; x <= tessellation; ++x )
+            {
+                float u = static_cast<float>( x ) / tessellation;
+                float v = static_cast<float>( z ) / tessellation;
+                float height = 0.08f * sinf( u * 7.0f ) * cosf( v * 5.0f ) + 0.02f * sinf( u * 23.0f + v * 17.0f );
+                Math::Float3 position( ( u - 0.5f ) * size, height * size, ( v - 0.5f ) * size );
+                vertices.push_back( VertexPositionNormalTexture( position, Math::Float3( 0, 1, 0 ), Math::Float2( u, v ) ) );
+            }
+        }
+
+        for ( size_t z = 0; z < tessellation; ++z )
+        {
+            for ( size_t x = 0; x < tessellation; ++x )
+            {
+                uint32_t i0 = static_cast<uint32_t>( z * stride + x );
+                uint32_t i1 = i0 + 1;
+                uint32_t i2 = static_cast<uint32_t>( i0 + stride );
+                uint32_t i3 = i2 + 1;
+
+                indices.push_back( i0 ); indices.push_back( i2 ); indices.push_back( i1 );
+                indices.push_back( i1 ); indices.push_back( i2 ); indices.push_back( i3 );
+            }
+        }
+    }
+
+    // The distance of a point to a triangle (Ericson, Real-Time Collision Detection 5.1.5).
+    inline float DistanceToTriangle( const Math::Float3& p, const Math::Float3& a, const Math::Float3& b, const Math::Float3& c )
+    {
+        Math::Float3 ab = b - a, ac = c - a, ap = p - a;
+        float d1 = Math::Dot( ab, ap ), d2 = Math::Dot( ac, ap );
+        if ( d1 <= 0 && d2 <= 0 ) return Math::Length( p - a );
+
+        Math::Float3 bp = p - b;
+        float d3 = Math::Dot( ab, bp ), d4 = Math::Dot( ac, bp );
+        if ( d3 >= 0 && d4 <= d3 ) return Math::Length( p - b );
+
+        float vc = d1 * d4 - d3 * d2;
+        if ( vc <= 0 && d1 >= 0 && d3 <= 0 ) return Math::Length( p - ( a + ab * ( d1 / ( d1 - d3 ) ) ) );
+
+        Math::Float3 cp = p - c;
+        float d5 = Math::Dot( ab, cp ), d6 = Math::Dot( ac, cp );
+        if ( d6 >= 0 && d5 <= d6 ) return Math::Length( p - c );
+
+        float vb = d5 * d2 - d1 * d6;
+        if ( vb <= 0 && d2 >= 0 && d6 <= 0 ) return Math::Length( p - ( a + ac * ( d2 / ( d2 - d6 ) ) ) );
+
+        float va = d3 * d6 - d5 * d4;
+        if ( va <= 0 && ( d4 - d3 ) >= 0 && ( d5 - d6 ) >= 0 )
+        {
+            return Math::Length( p - ( b + ( c - b ) * ( ( d4 - d3 ) / ( ( d4 - d3 ) + ( d5 - d6 ) ) ) ) );
+        }
+
+        float denom = 1.0f / ( va + vb + vc );
+        return Math::Length( p - ( a + ab * ( vb * denom ) + ac * ( vc * denom ) ) );
+    }
+
+    /**
+     * The largest distance of the simplified surface from the original surface,
+     * sampled at the edge midpoints and centers of the simplified triangles
+     * (brute force, so only use it on small meshes).
+     */
+    inline float MeasureDeviation( const VertexCollection& vertices, const IndexCollection& indices, const MeshLod& original, const MeshLod& lod )
+    {
+        float maxDistance = 0.0f;
+        for ( uint32_t i = lod.StartIndex; i < lod.StartIndex + lod.IndexCount; i += 3 )
+        {
+            const Math::Float3& a = vertices[indices[i]].position;
+            const Math::Float3& b = vertices[indices[i + 1]].position;
+            const Math::Float3& c = vertices[indices[i + 2]].position;
+            const Math::Float3 samples[] = { ( a + b ) * 0.5f, ( b + c ) * 0.5f, ( a + c ) * 0.5f, ( a + b + c ) * ( 1.0f / 3.0f ) };
+
+            for ( const Math::Float3& sample : samples )
+            {
+                float distance = FLT_MAX;
+                for ( uint32_t j = original.StartIndex; j < original.StartIndex + original.IndexCount && distance > maxDistance; j += 3 )
+                {
+                    distance = std::min( distance, DistanceToTriangle( sample, vertices[indices[j]].position,
+                        vertices[indices[j + 1]].position, vertices[indices[j + 2]].position ) );
+                }
+                maxDistance = std::max( maxDistance, distance );
+            }
+        }
+        return maxDistance;
+    }
+}
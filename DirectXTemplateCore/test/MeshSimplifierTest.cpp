@@ -0,0 +1,133 @@
+#include <Test.h>
+
+#include <Camera.h>
+#include <Geometry.h>
+#include <MeshSimplifier.h>
+#include <MeshSimplifierMeshes.h>
+
+#include <cfloat>
+
+using namespace Math;
+using namespace MeshSimplifierMeshes;
+
+namespace
+{
+    // Returns true if every LOD of the chain is smaller and not more accurate than
+    // the previous LOD, and every index range is inside the index buffer.
+    bool IsValidChain( const VertexCollection& vertices, const IndexCollection& indices, const MeshLodCollection& lods )
+    {
+        for ( size_t i = 0; i < lods.size(); ++i )
+        {
+            const MeshLod& lod = lods[i];
+            if ( lod.IndexCount % 3 != 0 || lod.StartIndex + lod.IndexCount > indices.size() ) return false;
+            if ( i > 0 && ( lod.IndexCount >= lods[i - 1].IndexCount || lod.Error < lods[i - 1].Error ) ) return false;
+
+            for ( uint32_t j = lod.StartIndex; j < lod.StartIndex + lod.IndexCount; ++j )
+            {
+                if ( indices[j] >= vertices.size() ) return false;
+            }
+        }
+        return true;
+    }
+
+    void CheckLodChain( const VertexCollection& vertices, const IndexCollection& sourceIndices )
+    {
+        IndexCollection indices = sourceIndices;
+        MeshLodCollection lods;
+        GenerateLods( vertices, indices, lods, 5, 0.5f );
+
+        REQUIRE( lods.size() == 5 );
+        REQUIRE( IsValidChain( vertices, indices, lods ) );
+        CHECK( lods[0].StartIndex == 0 && lods[0].IndexCount == sourceIndices.size() && lods[0].Error == 0.0f );
+
+        Camera camera( Camera::LeftHanded );
+        Viewport viewport = { 0.0f, 0.0f, 1920.0f, 1080.0f, 0.0f, 1.0f };
+        camera.set_Viewport( viewport );
+        camera.set_Projection( 60.0f, 1920.0f / 1080.0f, 0.1f, 1000.0f );
+
+        BoundingSphere sphere = ComputeBoundingSphere( vertices );
+
+        for ( size_t i = 1; i < lods.size(); ++i )
+        {
+            const MeshLod& lod = lods[i];
+
+            // Each LOD keeps about half of the triangles of the previous LOD.
+            CHECK( lod.IndexCount <= lods[i - 1].IndexCount / 2 + 3 );
+            CHECK( lod.Error > 0.0f );
+
+            // The error metric is an estimate; the measured deviation stays close to it.
+            CHECK( MeasureDeviation( vertices, indices, lods[0], lod ) <= lod.Error * 2.0f );
+
+            // Just beyond the distance at which the error of the LOD projects to 1 pixel
+            // the LOD (or a coarser one) is selected, just before it a finer one.
+            float distance = camera.ProjectedSize( lod.Error, 1.0f );
+            camera.set_Translation( sphere.Center - Float3( 0, 0, sphere.Radius + distance * 1.01f ) );
+            CHECK( SelectLod( lods, camera, sphere, 1.0f ) >= i );
+            camera.set_Translation( sphere.Center - Float3( 0, 0, sphere.Radius + distance * 0.99f ) );
+            CHECK( SelectLod( lods, camera, sphere, 1.0f ) < i );
+        }
+
+        // Inside the bounding sphere the full-detail mesh is drawn.
+        camera.set_Translation( sphere.Center );
+        CHECK( SelectLod( lods, camera, sphere, 1.0f ) == 0 );
+    }
+}
+
+TEST( MeshSimplifier, LodChain )
+{
+    VertexCollection vertices;
+    IndexCollection indices;
+
+    ComputeSphere( vertices, indices, 1.0f, 24, false );
+    CheckLodChain( vertices, indices );
+
+    ComputeTorus( vertices, indices, 1.0f, 0.333f, 32, false );
+    CheckLodChain( vertices, indices );
+
+    ComputeTerrain( vertices, indices, 100.0f, 48 );
+    CheckLodChain( vertices, indices );
+}
+
+TEST( MeshSimplifier, BorderIsLocked )
+{
+    const size_t tessellation = 32;
+    VertexCollection vertices;
+    IndexCollection indices;
+    ComputeTerrain( vertices, indices, 100.0f, tessellation );
+
+    IndexCollection simplified;
+    SimplifyMesh( vertices, indices, simplified, indices.size() / 8, FLT_MAX );
+    CHECK( simplified.size() < indices.size() / 4 );
+
+    // Every vertex on the border of the patch is still referenced.
+    std::vector<bool> referenced( vertices.size(), false );
+    for ( size_t i = 0; i < simplified.size(); ++i )
+    {
+        referenced[simplified[i]] = true;
+    }
+
+    size_t stride = tessellation + 1;
+    for ( size_t i = 0; i <= tessellation; ++i )
+    {
+        CHECK( referenced[i] );
+        CHECK( referenced[tessellation * stride + i] );
+        CHECK( referenced[i * stride] );
+        CHECK( referenced[i * stride + tessellation] );
+    }
+}
+
+TEST( MeshSimplifier, TargetErrorIsRespected )
+{
+    VertexCollection vertices;
+    IndexCollection indices;
+    ComputeSphere( vertices, indices, 1.0f, 24, false );
+
+    // A flat target error stops the simplification early.
+    const float targetError = 0.01f;
+    IndexCollection simplified;
+    float resultError = 0.0f;
+    SimplifyMesh( vertices, indices, simplified, 0, targetError, &resultError );
+
+    CHECK( simplified.size() > 0 && simplified.size() < indices.size() );
+    CHECK( resultError <= targetError );
+}
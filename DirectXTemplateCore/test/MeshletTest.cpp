@@ -0,0 +1,101 @@
+#include <Test.h>
+
+#include <Camera.h>
+#include <Geometry.h>
+#include <MeshOptimizer.h>
+#include <Meshlets.h>
+#include <MeshletVisibility.h>
+
+#include <cmath>
+
+using namespace Math;
+using namespace MeshletVisibility;
+
+namespace
+{
+    // Build the meshlets of a mesh and check that culling never removes a visible triangle.
+    void CheckMeshlets( const VertexCollection& vertices, IndexCollection indices )
+    {
+        OptimizeVertexCache( indices, vertices.size() );
+        IndexCollection originalIndices = indices;
+
+        MeshletCollection meshlets;
+        BuildMeshlets( vertices, indices, meshlets );
+        REQUIRE( !meshlets.empty() );
+        REQUIRE( indices.size() == originalIndices.size() );
+
+        // The meshlets cover the index buffer in order and respect the limits.
+        MeshletBoundsArrays bounds;
+        uint32_t nextIndex = 0;
+        size_t numCullable = 0;
+        for ( const Meshlet& meshlet : meshlets )
+        {
+            CHECK( meshlet.StartIndex == nextIndex );
+            CHECK( meshlet.IndexCount % 3 == 0 );
+            CHECK( meshlet.VertexCount <= MaxMeshletVertices );
+            CHECK( meshlet.IndexCount / 3 <= MaxMeshletTriangles );
+
+            // The bounding sphere contains the vertices of the meshlet.
+            for ( uint32_t i = meshlet.StartIndex; i < meshlet.StartIndex + meshlet.IndexCount; ++i )
+            {
+                REQUIRE( Length( vertices[indices[i]].position - meshlet.Sphere.Center ) <= meshlet.Sphere.Radius * 1.0001f + 1e-6f );
+            }
+
+            nextIndex += meshlet.IndexCount;
+            numCullable += ( meshlet.ConeCutoff < 1.0f );
+            bounds.Add( meshlet );
+        }
+        CHECK( nextIndex == indices.size() );
+        CHECK( numCullable > meshlets.size() / 2 );
+
+        // The triangles are only reordered: every index is still used as often.
+        std::vector<uint32_t> originalCounts( vertices.size(), 0 ), counts( vertices.size(), 0 );
+        for ( size_t i = 0; i < indices.size(); ++i )
+        {
+            ++originalCounts[originalIndices[i]];
+            ++counts[indices[i]];
+        }
+        CHECK( counts == originalCounts );
+
+        Camera camera( Camera::LeftHanded );
+        camera.set_Projection( 45.0f, 16.0f / 9.0f, 0.1f, 100.0f );
+
+        std::vector<uint32_t> visibleMeshlets;
+        IndexRangeCollection ranges;
+        const float viewDistances[] = { 3.0f, 0.9f };
+        for ( float viewDistance : viewDistances )
+        {
+            for ( int direction = 0; direction < 8; ++direction )
+            {
+                float angle = direction * TwoPi / 8;
+                Float3 eye( std::sin( angle ) * viewDistance, 0.4f * viewDistance, std::cos( angle ) * viewDistance );
+                camera.set_LookAt( eye, Float3( 0, 0, 0 ), Float3( 0, 1, 0 ) );
+                const Frustum& frustum = camera.get_Frustum();
+
+                CullMeshlets( bounds, frustum, eye, visibleMeshlets );
+                CHECK( visibleMeshlets.size() < meshlets.size() );
+
+                TriangleCounts counts = CountVisibleTriangles( vertices, indices, meshlets, visibleMeshlets, frustum, eye );
+                CHECK( counts.WronglyCulled == 0 );
+
+                // The merged ranges cover exactly the indices of the visible meshlets.
+                size_t numIndices = 0;
+                for ( uint32_t meshlet : visibleMeshlets ) numIndices += meshlets[meshlet].IndexCount;
+                CHECK( GetIndexRanges( meshlets, visibleMeshlets, ranges ) == numIndices );
+                CHECK( ranges.size() <= visibleMeshlets.size() );
+            }
+        }
+    }
+}
+
+TEST( Meshlets, BuildAndCull )
+{
+    VertexCollection vertices;
+    IndexCollection indices;
+
+    ComputeSphere( vertices, indices, 1.0f, 64, false );
+    CheckMeshlets( vertices, indices );
+
+    ComputeTorus( vertices, indices, 1.0f, 0.333f, 64, false );
+    CheckMeshlets( vertices, indices );
+}
@@ -0,0 +1,74 @@
+/**
+ * @brief The reference culling of the Meshlets tests and benchmarks.
+ *
+ * CountVisibleTriangles culls every triangle of a mesh against the frustum and by
+ * its facing, the ideal that meshlet culling is compared with.
+ */
+#pragma once
+
+#include <Frustum.h>
+#include <Geometry.h>
+#include <Meshlets.h>
+
+#include <vector>
+
+namespace MeshletVisibility
+{
+    struct TriangleCounts
+    {
+        // Triangles that face the camera and are not completely outside of the frustum.
+        size_t Visible;
+        // Triangles of culled meshlets that are front-facing and inside the frustum
+        // (culling errors: this must be 0).
+        size_t WronglyCulled;
+    };
+
+    // Returns true if the vertices of a triangle are all behind the same plane of the frustum.
+    inline bool IsOutside( const Frustum& frustum, const Math::Float3& p0, const Math::Float3& p1, const Math::Float3& p2 )
+    {
+        for ( int i = 0; i < Frustum::NumPlanes; ++i )
+        {
+            const Math::Float4& plane = frustum.get_Plane( static_cast<Frustum::PlaneIndex>( i ) );
+            Math::Float3 normal( plane.x, plane.y, plane.z );
+            if ( Math::Dot( normal, p0 ) + plane.w < 0.0f && Math::Dot( normal, p1 ) + plane.w < 0.0f && Math::Dot( normal, p2 ) + plane.w < 0.0f )
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Count the triangles that a perfect per-triangle cull would keep.
+    inline TriangleCounts CountVisibleTriangles( const VertexCollection& vertices, const IndexCollection& indices,
+                                                 const MeshletCollection& meshlets, const std::vector<uint32_t>& visibleMeshlets,
+                                                 const Frustum& frustum, const Math::Float3& eye )
+    {
+        std::vector<bool> meshletVisible( meshlets.size(), false );
+        for ( uint32_t meshlet : visibleMeshlets ) meshletVisible[meshlet] = true;
+
+        TriangleCounts counts = { 0, 0 };
+        for ( size_t m = 0; m < meshlets.size(); ++m )
+        {
+            const Meshlet& meshlet = meshlets[m];
+            for ( uint32_t i = meshlet.StartIndex; i < meshlet.StartIndex + meshlet.IndexCount; i += 3 )
+            {
+                const VertexPositionNormalTexture& v0 = vertices[indices[i]];
+                const VertexPositionNormalTexture& v1 = vertices[indices[i + 1]];
+                const VertexPositionNormalTexture& v2 = vertices[indices[i + 2]];
+
+                // The normal is oriented like the vertex normals (see Meshlets.cpp).
+                Math::Float3 normal = Math::Cross( v1.position - v0.position, v2.position - v0.position );
+                if ( Math::Dot( normal, v0.normal + v1.normal + v2.normal ) < 0.0f ) normal = -normal;
+
+                bool frontFacing = Math::Dot( normal, v0.position - eye ) < 0.0f || Math::Dot( normal, v1.position - eye ) < 0.0f ||
+                                   Math::Dot( normal, v2.position - eye ) < 0.0f;
+                if ( frontFacing && !IsOutside( frustum, v0.position, v1.position, v2.position ) )
+                {
+                    ++counts.Visible;
+                    if ( !meshletVisible[m] ) ++counts.WronglyCulled;
+                }
+            }
+        }
+        return counts;
+    }
+}
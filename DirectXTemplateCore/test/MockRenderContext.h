@@ -0,0 +1,241 @@
+/**
+ * @brief A mock render context for the RenderQueue and ParallelRecording tests and benchmarks.
+ *
+ * RecordingRenderContext encodes the calls that reach the device into a command list,
+ * MockCommandRecorder plays the part of a deferred context, and SubmitScene fills a
+ * render queue with the draw commands of a scene of fake device objects.
+ */
+#pragma once
+
+#include <ParallelCommandRecorder.h>
+#include <RenderContext.h>
+#include <RenderQueue.h>
+#include <StateCache.h>
+
+#include <random>
+#include <vector>
+
+namespace MockRenderContext
+{
+    /**
+     * A render context that encodes the calls into a command list, like a deferred
+     * context does. Each call is stored as its opcode and five arguments.
+     */
+    class RecordingRenderContext : public RenderContext
+    {
+    public:
+        enum Opcode
+        {
+            SetInputLayoutOpcode,
+            SetPrimitiveTopologyOpcode,
+            SetVertexBufferOpcode,
+            SetIndexBufferOpcode,
+            SetVertexShaderOpcode,
+            SetVSConstantBufferOpcode,
+            SetRasterizerStateOpcode,
+            SetPixelShaderOpcode,
+            SetPSConstantBufferOpcode,
+            SetPSShaderResourceOpcode,
+            SetDepthStencilStateOpcode,
+            SetBlendStateOpcode,
+            DrawIndexedOpcode,
+            DrawIndexedInstancedOpcode,
+        };
+
+        static const size_t CommandSize = 6;
+
+        RecordingRenderContext()
+            : StateChanges( 0 )
+            , DrawCalls( 0 )
+        {}
+
+        virtual void SetInputLayout( StateHandle inputLayout ) { Encode( SetInputLayoutOpcode, Handle( inputLayout ) ); }
+        virtual void SetPrimitiveTopology( uint32_t primitiveTopology ) { Encode( SetPrimitiveTopologyOpcode, primitiveTopology ); }
+        virtual void SetVertexBuffer( uint32_t slot, const VertexBufferBinding& vertexBuffer ) { Encode( SetVertexBufferOpcode, slot, Handle( vertexBuffer.Buffer ), vertexBuffer.Stride, vertexBuffer.Offset ); }
+        virtual void SetIndexBuffer( StateHandle indexBuffer, uint32_t indexFormat ) { Encode( SetIndexBufferOpcode, Handle( indexBuffer ), indexFormat ); }
+        virtual void SetVertexShader( StateHandle vertexShader ) { Encode( SetVertexShaderOpcode, Handle( vertexShader ) ); }
+        virtual void SetVSConstantBuffer( uint32_t slot, const ConstantBufferBinding& constantBuffer ) { Encode( SetVSConstantBufferOpcode, slot, Handle( constantBuffer.Buffer ), constantBuffer.FirstConstant, constantBuffer.NumConstants ); }
+        virtual void SetRasterizerState( StateHandle rasterizerState ) { Encode( SetRasterizerStateOpcode, Handle( rasterizerState ) ); }
+        virtual void SetPixelShader( StateHandle pixelShader ) { Encode( SetPixelShaderOpcode, Handle( pixelShader ) ); }
+        virtual void SetPSConstantBuffer( uint32_t slot, const ConstantBufferBinding& constantBuffer ) { Encode( SetPSConstantBufferOpcode, slot, Handle( constantBuffer.Buffer ), constantBuffer.FirstConstant, constantBuffer.NumConstants ); }
+        virtual void SetPSShaderResource( uint32_t slot, StateHandle shaderResourceView ) { Encode( SetPSShaderResourceOpcode, slot, Handle( shaderResourceView ) ); }
+        virtual void SetDepthStencilState( StateHandle depthStencilState ) { Encode( SetDepthStencilStateOpcode, Handle( depthStencilState ) ); }
+        virtual void SetBlendState( StateHandle blendState ) { Encode( SetBlendStateOpcode, Handle( blendState ) ); }
+        virtual void DrawIndexed( uint32_t indexCount, uint32_t startIndex, int32_t baseVertex ) { Encode( DrawIndexedOpcode, indexCount, startIndex, static_cast<uint32_t>( baseVertex ) ); }
+        virtual void DrawIndexedInstanced( uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance )
+        {
+            Encode( DrawIndexedInstancedOpcode, indexCount, instanceCount, startIndex, static_cast<uint32_t>( baseVertex ), startInstance );
+        }
+
+        // One argument of every recorded call with the given opcode, in the order of the calls.
+        std::vector<uint64_t> GetArguments( Opcode opcode, size_t argument ) const
+        {
+            std::vector<uint64_t> arguments;
+            for ( size_t i = 0; i < Commands.size(); i += CommandSize )
+            {
+                if ( Commands[i] == static_cast<uint64_t>( opcode ) )
+                {
+                    arguments.push_back( Commands[i + 1 + argument] );
+                }
+            }
+            return arguments;
+        }
+
+        static uint64_t Handle( StateHandle handle )
+        {
+            return reinterpret_cast<uintptr_t>( handle );
+        }
+
+        std::vector<uint64_t> Commands;
+        uint64_t StateChanges;
+        uint64_t DrawCalls;
+
+    private:
+        void Encode( Opcode opcode, uint64_t a = 0, uint64_t b = 0, uint64_t c = 0, uint64_t d = 0, uint64_t e = 0 )
+        {
+            const uint64_t command[CommandSize] = { static_cast<uint64_t>( opcode ), a, b, c, d, e };
+            Commands.insert( Commands.end(), command, command + CommandSize );
+            if ( opcode < DrawIndexedOpcode )
+            {
+                ++StateChanges;
+            }
+            else
+            {
+                ++DrawCalls;
+            }
+        }
+    };
+
+    /**
+     * A mock of a deferred context. Executing a command list appends it to the
+     * stream of the (shared) immediate context.
+     */
+    class MockCommandRecorder : public CommandRecorder
+    {
+    public:
+        explicit MockCommandRecorder( std::vector<uint64_t>& immediateContext )
+            : m_ImmediateContext( immediateContext )
+            , m_NumBegin( 0 )
+        {}
+
+        virtual void BeginCommandList()
+        {
+            // A marker for the state that is bound at the start of every command list.
+            ++m_NumBegin;
+            m_Context.Commands.clear();
+            m_Context.SetPrimitiveTopology( 0 );
+        }
+
+        virtual RenderContext& get_RenderContext()
+        {
+            return m_Context;
+        }
+
+        virtual void FinishCommandList()
+        {
+            m_CommandList.swap( m_Context.Commands );
+            m_Context.Commands.clear();
+        }
+
+        virtual void ExecuteCommandList()
+        {
+            m_ImmediateContext.insert( m_ImmediateContext.end(), m_CommandList.begin(), m_CommandList.end() );
+            m_CommandList.clear();
+        }
+
+        size_t get_NumBegin() const
+        {
+            return m_NumBegin;
+        }
+
+    private:
+        std::vector<uint64_t>& m_ImmediateContext;
+        RecordingRenderContext m_Context;
+        std::vector<uint64_t> m_CommandList;
+        size_t m_NumBegin;
+    };
+
+    // Fake device objects (only the addresses are used).
+    struct FakeObjects
+    {
+        char Shaders[8];
+        char Meshes[16];
+        char Materials[64];
+        char Textures[32];
+        char Shared[4];
+    };
+
+    // Fill the queue with draw calls for random combinations of shaders, meshes, materials and textures.
+    // If useSortKeys is false, all draw calls get the same key (they are executed in submission order).
+    inline void SubmitScene( RenderQueue& renderQueue, const FakeObjects& objects, int numDraws, bool useSortKeys = true )
+    {
+        std::mt19937 random( 42 );
+        std::uniform_int_distribution<int> shaderDistribution( 0, 7 );
+        std::uniform_int_distribution<int> meshDistribution( 0, 15 );
+        std::uniform_int_distribution<int> materialDistribution( 0, 63 );
+        std::uniform_int_distribution<int> textureDistribution( 0, 31 );
+        std::uniform_real_distribution<float> depthDistribution( 0.0f, 1.0f );
+
+        for ( int i = 0; i < numDraws; ++i )
+        {
+            int shader = shaderDistribution( random );
+            int mesh = meshDistribution( random );
+            int material = materialDistribution( random );
+            int texture = textureDistribution( random );
+            float depth = depthDistribution( random );
+
+            DrawCommand drawCommand = {};
+            drawCommand.InputLayout = &objects.Shared[0];
+            drawCommand.PrimitiveTopology = 4;
+            VertexBufferBinding vertexBuffer = { &objects.Meshes[mesh], 32, 0 };
+            drawCommand.VertexBuffers[0] = vertexBuffer;
+            drawCommand.NumVertexBuffers = 1;
+            drawCommand.IndexBuffer = &objects.Meshes[mesh];
+            drawCommand.IndexFormat = 57;
+            drawCommand.VertexShader = &objects.Shaders[shader];
+            // Per-object constants are different for every draw call.
+            ConstantBufferBinding perObject = { &objects.Shared[1], static_cast<uint32_t>( i * 16 ), 16 };
+            drawCommand.VSConstantBuffers[0] = perObject;
+            drawCommand.NumVSConstantBuffers = 1;
+            drawCommand.RasterizerState = &objects.Shared[2];
+            drawCommand.PixelShader = &objects.Shaders[shader];
+            ConstantBufferBinding materialConstants = { &objects.Materials[material], 0, 0 };
+            drawCommand.PSConstantBuffers[0] = materialConstants;
+            drawCommand.NumPSConstantBuffers = 1;
+            drawCommand.PSShaderResources[0] = &objects.Textures[texture];
+            drawCommand.NumPSShaderResources = 1;
+            drawCommand.DepthStencilState = &objects.Shared[3];
+            drawCommand.IndexCount = 36;
+
+            uint64_t sortKey = useSortKeys ? SortKey::Opaque( 0, shader, material, texture, depth ) : 0;
+            renderQueue.Submit( sortKey, drawCommand );
+        }
+    }
+
+    // Record a sorted queue. Each range starts with an empty state cache because
+    // deferred contexts do not inherit the state of the immediate context.
+    inline void RecordQueue( const RenderQueue& renderQueue, RenderContext& renderContext, size_t begin, size_t end )
+    {
+        StateCache stateCache( renderContext );
+        renderQueue.Execute( stateCache, begin, end );
+    }
+
+    // What a single thread submits: the same ranges recorded one after the other.
+    inline std::vector<uint64_t> RecordSerial( const RenderQueue& renderQueue, size_t numCommandLists )
+    {
+        std::vector<uint64_t> immediateContext;
+        MockCommandRecorder recorder( immediateContext );
+
+        size_t numItems = renderQueue.get_NumCommands();
+        for ( size_t i = 0; i < numCommandLists; ++i )
+        {
+            size_t begin, end;
+            ParallelCommandRecorder::GetRange( numItems, numCommandLists, i, begin, end );
+            recorder.BeginCommandList();
+            RecordQueue( renderQueue, recorder.get_RenderContext(), begin, end );
+            recorder.FinishCommandList();
+            recorder.ExecuteCommandList();
+        }
+        return immediateContext;
+    }
+}
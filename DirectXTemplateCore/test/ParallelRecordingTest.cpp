@@ -0,0 +1,131 @@
+#include <Test.h>
+
+#include <MockRenderContext.h>
+#include <ParallelCommandRecorder.h>
+#include <RenderQueue.h>
+
+#include <memory>
+#include <stdexcept>
+
+using namespace MockRenderContext;
+
+namespace
+{
+    // Returns true if the ranges of the command lists cover all items exactly once in order.
+    bool IsValidPartition( size_t numItems, size_t numRecorders, size_t minItemsPerCommandList )
+    {
+        size_t numCommandLists = ParallelCommandRecorder::GetNumCommandLists( numItems, numRecorders, minItemsPerCommandList );
+        if ( numCommandLists > numRecorders || ( numItems > 0 && numCommandLists == 0 ) ) return false;
+
+        size_t next = 0;
+        for ( size_t i = 0; i < numCommandLists; ++i )
+        {
+            size_t begin, end;
+            ParallelCommandRecorder::GetRange( numItems, numCommandLists, i, begin, end );
+            if ( begin != next || end <= begin ) return false;
+            if ( numCommandLists > 1 && end - begin < minItemsPerCommandList ) return false;
+            next = end;
+        }
+        return next == numItems;
+    }
+}
+
+TEST( ParallelRecording, RangesCoverEveryItemOnce )
+{
+    for ( size_t numItems = 0; numItems < 300; ++numItems )
+    {
+        for ( size_t numRecorders = 1; numRecorders <= 9; ++numRecorders )
+        {
+            REQUIRE( IsValidPartition( numItems, numRecorders, 1 ) );
+            REQUIRE( IsValidPartition( numItems, numRecorders, 16 ) );
+        }
+    }
+}
+
+// The submitted stream must be identical to recording the same ranges on one
+// thread, every frame, for every number of threads.
+TEST( ParallelRecording, SubmissionIsDeterministic )
+{
+    const int numDraws = 4000;
+    const int numFrames = 20;
+
+    FakeObjects objects;
+    RenderQueue renderQueue;
+    SubmitScene( renderQueue, objects, numDraws );
+    renderQueue.Sort();
+
+    for ( size_t numThreads = 1; numThreads <= 8; numThreads *= 2 )
+    {
+        std::vector<uint64_t> immediateContext;
+        std::vector<std::unique_ptr<MockCommandRecorder>> recorders;
+        std::vector<CommandRecorder*> recorderPointers;
+        for ( size_t i = 0; i < numThreads; ++i )
+        {
+            recorders.push_back( std::unique_ptr<MockCommandRecorder>( new MockCommandRecorder( immediateContext ) ) );
+            recorderPointers.push_back( recorders.back().get() );
+        }
+
+        ParallelCommandRecorder parallelRecorder( recorderPointers );
+        ParallelCommandRecorder::RecordFunction record = [&renderQueue]( RenderContext& renderContext, size_t begin, size_t end )
+        {
+            RecordQueue( renderQueue, renderContext, begin, end );
+        };
+
+        size_t numCommandLists = ParallelCommandRecorder::GetNumCommandLists( numDraws, numThreads, parallelRecorder.get_MinItemsPerCommandList() );
+        CHECK( numCommandLists == numThreads );
+        std::vector<uint64_t> expected = RecordSerial( renderQueue, numCommandLists );
+
+        for ( int frame = 0; frame < numFrames; ++frame )
+        {
+            immediateContext.clear();
+            CHECK( parallelRecorder.Record( numDraws, record ) == numCommandLists );
+            parallelRecorder.Execute();
+            REQUIRE( immediateContext == expected );
+        }
+
+        for ( size_t i = 0; i < numThreads; ++i )
+        {
+            CHECK( recorders[i]->get_NumBegin() == ( i < numCommandLists ? static_cast<size_t>( numFrames ) : 0 ) );
+        }
+
+        // Nothing is recorded for an empty frame.
+        immediateContext.clear();
+        CHECK( parallelRecorder.Record( 0, record ) == 0 );
+        parallelRecorder.Execute();
+        CHECK( immediateContext.empty() );
+    }
+}
+
+// Exceptions on a worker thread are rethrown by Record and nothing is executed.
+TEST( ParallelRecording, ExceptionsAreRethrown )
+{
+    std::vector<uint64_t> immediateContext;
+    MockCommandRecorder recorder0( immediateContext ), recorder1( immediateContext );
+    std::vector<CommandRecorder*> recorderPointers = { &recorder0, &recorder1 };
+    ParallelCommandRecorder parallelRecorder( recorderPointers, 1 );
+
+    ParallelCommandRecorder::RecordFunction record = []( RenderContext& renderContext, size_t begin, size_t end )
+    {
+        renderContext.DrawIndexed( 3, 0, 0 );
+        if ( begin == 1 ) throw std::runtime_error( "Recording failed." );
+    };
+
+    bool rethrown = false;
+    try
+    {
+        parallelRecorder.Record( 2, record );
+    }
+    catch ( const std::runtime_error& )
+    {
+        rethrown = true;
+    }
+    parallelRecorder.Execute();
+
+    CHECK( rethrown );
+    CHECK( immediateContext.empty() );
+
+    // The recorder can be used again after an exception.
+    CHECK( parallelRecorder.Record( 1, []( RenderContext& renderContext, size_t, size_t ) { renderContext.DrawIndexed( 3, 0, 0 ); } ) == 1 );
+    parallelRecorder.Execute();
+    CHECK( !immediateContext.empty() );
+}
@@ -0,0 +1,271 @@
+#include <Test.h>
+
+#include <Profiler.h>
+#include <ProfilerWorkloads.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+using namespace ProfilerWorkloads;
+
+namespace
+{
+    bool EqualCaptures( const ProfileCapture& a, const ProfileCapture& b )
+    {
+        if ( a.Names != b.Names || a.Threads != b.Threads || a.NumDropped != b.NumDropped || a.Zones.size() != b.Zones.size() )
+        {
+            return false;
+        }
+        for ( size_t i = 0; i < a.Zones.size(); ++i )
+        {
+            const ProfileZone& za = a.Zones[i];
+            const ProfileZone& zb = b.Zones[i];
+            if ( za.Name != zb.Name || za.Thread != zb.Thread || za.Depth != zb.Depth || za.Begin != zb.Begin || za.Duration != zb.Duration )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The index of the name in the capture (or the number of names if it is missing).
+    uint32_t FindName( const ProfileCapture& capture, const char* name )
+    {
+        return static_cast<uint32_t>( std::find( capture.Names.begin(), capture.Names.end(), name ) - capture.Names.begin() );
+    }
+
+    // Copy the first half of a file over the file.
+    bool TruncateFile( const std::string& fileName )
+    {
+        FILE* file = fopen( fileName.c_str(), "rb" );
+        if ( !file ) return false;
+        std::vector<char> bytes( 1 << 20 );
+        size_t numRead = fread( bytes.data(), 1, bytes.size(), file );
+        fclose( file );
+
+        file = fopen( fileName.c_str(), "wb" );
+        if ( !file ) return false;
+        bool written = fwrite( bytes.data(), 1, numRead / 2, file ) == numRead / 2;
+        fclose( file );
+        return written;
+    }
+
+    std::string ReadFile( const std::string& fileName )
+    {
+        std::string text;
+        FILE* file = fopen( fileName.c_str(), "rb" );
+        if ( !file ) return text;
+        char buffer[4096];
+        for ( size_t numRead; ( numRead = fread( buffer, 1, sizeof( buffer ), file ) ) > 0; )
+        {
+            text.append( buffer, numRead );
+        }
+        fclose( file );
+        return text;
+    }
+
+    // The records of the trace are separated by commas, without a comma after the last record.
+    bool IsSeparated( const std::string& trace )
+    {
+        return trace.find( ",\n]" ) == std::string::npos && trace.find( "}\n{" ) == std::string::npos &&
+            trace.find( "[," ) == std::string::npos && trace.compare( 0, 16, "{\"traceEvents\":[" ) == 0;
+    }
+}
+
+// Only the latest zones are kept in the ring buffer, the others are counted as dropped.
+TEST( Profiler, RingBufferWraps )
+{
+    const int numZones = static_cast<int>( Profiler::ZonesPerThread ) * 3;
+
+    ProfileCapture capture;
+    Profiler::Collect( capture );
+
+    // Zones are not recorded while the profiler is disabled.
+    Profiler::set_Enabled( false );
+    {
+        PROFILE_SCOPE( "Disabled" );
+    }
+    Profiler::set_Enabled( true );
+    Profiler::Collect( capture );
+    CHECK( capture.Zones.empty() );
+
+    uint32_t value = 0;
+    for ( int i = 0; i < numZones; ++i )
+    {
+        PROFILE_SCOPE( "Zone" );
+        value = Work( value, 1 );
+    }
+    CHECK( value != 1 );
+
+    // Collect also drops the oldest zone because the thread could be overwriting it.
+    Profiler::Collect( capture );
+    CHECK( capture.Zones.size() + 1 >= Profiler::ZonesPerThread );
+    CHECK( capture.Zones.size() + capture.NumDropped == static_cast<size_t>( numZones ) );
+}
+
+// Threads record nested zones while the main thread collects them. Every zone is
+// collected exactly once or counted as dropped.
+TEST( Profiler, CollectWhileThreadsRecord )
+{
+    const int numThreads = 4;
+    const int numFrames = 20000;
+
+    ProfileCapture capture;
+    Profiler::Collect( capture );
+
+    std::atomic<int> numRunning( numThreads );
+    std::vector<std::thread> threads;
+    for ( int t = 0; t < numThreads; ++t )
+    {
+        threads.push_back( std::thread( [&numRunning, numFrames, t]()
+        {
+            Profiler::SetThreadName( "Worker " + std::to_string( t ) );
+            uint32_t value = RecordNestedZones( t, numFrames );
+            if ( value == 0 ) Profiler::SetThreadName( "Unlikely" );
+            --numRunning;
+        } ) );
+    }
+
+    size_t numCollected = 0;
+    uint64_t numDropped = 0;
+    for ( bool running = true; running; )
+    {
+        running = numRunning > 0;
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+        Profiler::Collect( capture );
+
+        uint32_t outer = FindName( capture, "Outer" );
+        uint32_t inner = FindName( capture, "Inner" );
+        for ( size_t i = 0; i < capture.Zones.size(); ++i )
+        {
+            const ProfileZone& zone = capture.Zones[i];
+            CHECK( capture.Threads[zone.Thread].compare( 0, 7, "Worker " ) == 0 );
+            CHECK( zone.Duration >= 0 );
+            // An Outer zone is never nested. An Inner zone is nested in its Outer zone unless
+            // the Outer zone ended after the capture.
+            CHECK( zone.Name == outer ? zone.Depth == 0 : zone.Name == inner && zone.Depth <= 1 );
+            if ( i > 0 && capture.Zones[i - 1].Thread == zone.Thread )
+            {
+                CHECK( capture.Zones[i - 1].Begin <= zone.Begin );
+            }
+        }
+        numCollected += capture.Zones.size();
+        numDropped += capture.NumDropped;
+    }
+
+    for ( std::thread& thread : threads )
+    {
+        thread.join();
+    }
+    CHECK( numCollected + numDropped == static_cast<size_t>( numThreads ) * numFrames * 3 );
+
+    // New threads reuse the buffers of the threads that exited.
+    size_t numBuffers = capture.Threads.size();
+    threads.clear();
+    for ( int t = 0; t < numThreads; ++t )
+    {
+        threads.push_back( std::thread( []()
+        {
+            PROFILE_SCOPE( "Outer" );
+        } ) );
+    }
+    for ( std::thread& thread : threads )
+    {
+        thread.join();
+    }
+    Profiler::Collect( capture );
+    CHECK( capture.Threads.size() == numBuffers );
+    CHECK( capture.Zones.size() == static_cast<size_t>( numThreads ) );
+}
+
+// The nesting and the times of the zones, and the export formats.
+TEST( Profiler, NestingAndExport )
+{
+    const int numFrames = 1000;
+
+    ProfileCapture capture;
+    Profiler::Collect( capture );
+
+    // A zone around a sleep lasts at least as long as the sleep.
+    {
+        PROFILE_SCOPE( "Sleep" );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    }
+
+    // Frames with update and render zones and a nested draw zone.
+    uint64_t firstFrame = Profiler::get_FrameCount();
+    RecordFrames( 0, numFrames );
+    CHECK( Profiler::get_FrameCount() == firstFrame + numFrames + 1 );
+
+    Profiler::Collect( capture );
+    REQUIRE( !capture.Threads.empty() );
+
+    size_t numSleeps = 0;
+    size_t counts[4] = { 0, 0, 0, 0 };
+    const char* names[4] = { "Frame", "Update", "Render", "Draw" };
+    for ( const ProfileZone& zone : capture.Zones )
+    {
+        const std::string& name = capture.Names[zone.Name];
+        if ( name == "Sleep" )
+        {
+            ++numSleeps;
+            CHECK( zone.Depth == 0 );
+            CHECK( zone.Duration >= 20000000 );
+        }
+        for ( uint32_t n = 0; n < 4; ++n )
+        {
+            if ( name == names[n] )
+            {
+                ++counts[n];
+                // The frame contains update and render, which contains the draws.
+                CHECK( zone.Depth == ( n == 0 ? 0u : n == 3 ? 2u : 1u ) );
+            }
+        }
+    }
+    CHECK( numSleeps == 1 );
+    CHECK( counts[0] == static_cast<size_t>( numFrames ) );
+    CHECK( counts[1] == static_cast<size_t>( numFrames ) );
+    CHECK( counts[2] == static_cast<size_t>( numFrames ) );
+    CHECK( counts[3] == static_cast<size_t>( numFrames ) * 4 );
+
+    const std::string traceFileName = "ProfilerTest.json";
+    const std::string binaryFileName = "ProfilerTest.dxtp";
+    CHECK( capture.WriteChromeTrace( traceFileName ) );
+    CHECK( IsSeparated( ReadFile( traceFileName ) ) );
+    REQUIRE( capture.WriteBinary( binaryFileName ) );
+
+    ProfileCapture loaded;
+    CHECK( loaded.ReadBinary( binaryFileName ) );
+    CHECK( EqualCaptures( capture, loaded ) );
+
+    // A truncated file is rejected.
+    REQUIRE( TruncateFile( binaryFileName ) );
+    CHECK( !loaded.ReadBinary( binaryFileName ) );
+    CHECK( loaded.Zones.empty() );
+
+    std::remove( traceFileName.c_str() );
+    std::remove( binaryFileName.c_str() );
+}
+
+// A capture without zones (or without threads) is still a valid trace.
+TEST( Profiler, ChromeTraceWithoutZones )
+{
+    const std::string traceFileName = "ProfilerTestEmpty.json";
+
+    ProfileCapture capture;
+    REQUIRE( capture.WriteChromeTrace( traceFileName ) );
+    CHECK( ReadFile( traceFileName ) == "{\"traceEvents\":[\n],\"displayTimeUnit\":\"ns\"}\n" );
+
+    capture.Threads.push_back( "Main" );
+    capture.Threads.push_back( "Worker 0" );
+    REQUIRE( capture.WriteChromeTrace( traceFileName ) );
+    std::string trace = ReadFile( traceFileName );
+    CHECK( IsSeparated( trace ) );
+    CHECK( trace.find( "\"Worker 0\"}}\n]" ) != std::string::npos );
+
+    std::remove( traceFileName.c_str() );
+}
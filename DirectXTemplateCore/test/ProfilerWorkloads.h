@@ -0,0 +1,65 @@
+/**
+ * @brief The workloads of the Profiler tests and benchmarks.
+ *
+ * RecordNestedZones is what each worker thread records while the main thread collects
+ * the zones, and RecordFrames records frames with update, render and nested draw zones.
+ */
+#pragma once
+
+#include <Profiler.h>
+
+#include <cstdint>
+
+namespace ProfilerWorkloads
+{
+    // Some work for the zones to measure.
+    inline uint32_t Work( uint32_t value, int numIterations )
+    {
+        for ( int i = 0; i < numIterations; ++i )
+        {
+            value = value * 1664525u + 1013904223u;
+        }
+        return value;
+    }
+
+    // Frames of an Outer zone with two Inner zones (three zones per frame).
+    inline uint32_t RecordNestedZones( uint32_t value, int numFrames )
+    {
+        for ( int i = 0; i < numFrames; ++i )
+        {
+            PROFILE_SCOPE( "Outer" );
+            {
+                PROFILE_SCOPE( "Inner" );
+                value = Work( value, 100 );
+            }
+            {
+                PROFILE_SCOPE( "Inner" );
+                value = Work( value, 100 );
+            }
+        }
+        return value;
+    }
+
+    // Frames with update and render zones and four draw zones nested in the render zone.
+    inline uint32_t RecordFrames( uint32_t value, int numFrames )
+    {
+        for ( int i = 0; i < numFrames; ++i )
+        {
+            Profiler::BeginFrame();
+            {
+                PROFILE_SCOPE( "Update" );
+                value = Work( value, 200 );
+            }
+            {
+                PROFILE_SCOPE( "Render" );
+                for ( int draw = 0; draw < 4; ++draw )
+                {
+                    PROFILE_SCOPE( "Draw" );
+                    value = Work( value, 100 );
+                }
+            }
+        }
+        Profiler::BeginFrame();
+        return value;
+    }
+}
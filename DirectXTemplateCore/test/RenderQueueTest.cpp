@@ -0,0 +1,116 @@
+#include <Test.h>
+
+#include <MockRenderContext.h>
+#include <RenderQueue.h>
+#include <StateCache.h>
+
+#include <random>
+
+using namespace MockRenderContext;
+
+namespace
+{
+    // A draw command that is identified by its start index.
+    DrawCommand MakeDrawCommand( StateHandle pixelShader, uint32_t id )
+    {
+        DrawCommand drawCommand = {};
+        drawCommand.PixelShader = pixelShader;
+        drawCommand.IndexCount = 36;
+        drawCommand.StartIndex = id;
+        return drawCommand;
+    }
+}
+
+TEST( RenderQueue, SortKeyFieldOrder )
+{
+    // Pass is the most significant field, then shader, material, texture and depth.
+    CHECK( SortKey::Opaque( 0, 5, 5, 5, 1.0f ) < SortKey::Opaque( 1, 0, 0, 0, 0.0f ) );
+    CHECK( SortKey::Opaque( 0, 1, 9, 9, 1.0f ) < SortKey::Opaque( 0, 2, 0, 0, 0.0f ) );
+    CHECK( SortKey::Opaque( 0, 1, 1, 9, 1.0f ) < SortKey::Opaque( 0, 1, 2, 0, 0.0f ) );
+    CHECK( SortKey::Opaque( 0, 1, 1, 1, 0.9f ) < SortKey::Opaque( 0, 1, 1, 2, 0.0f ) );
+    CHECK( SortKey::Opaque( 0, 1, 1, 1, 0.1f ) < SortKey::Opaque( 0, 1, 1, 1, 0.2f ) );
+
+    // Translucent geometry is sorted back to front.
+    CHECK( SortKey::Translucent( 2, 0.8f, 0, 0, 0 ) < SortKey::Translucent( 2, 0.2f, 0, 0, 0 ) );
+
+    CHECK( SortKey::GetPass( SortKey::Opaque( 3, 1, 2, 3, 0.5f ) ) == 3 );
+    CHECK( SortKey::GetPass( SortKey::Translucent( 15, 0.5f, 1, 2, 3 ) ) == 15 );
+
+    CHECK( SortKey::QuantizeDepth( -1.0f ) == 0 );
+    CHECK( SortKey::QuantizeDepth( 2.0f ) == ( 1u << SortKey::DepthBits ) - 1 );
+}
+
+TEST( RenderQueue, SortIsStableAndOrdered )
+{
+    std::mt19937 random( 7 );
+    std::uniform_int_distribution<int> idDistribution( 0, 3 );
+    std::uniform_real_distribution<float> depthDistribution( 0.0f, 1.0f );
+
+    RenderQueue renderQueue;
+    const uint32_t numDraws = 5000;
+    for ( uint32_t i = 0; i < numDraws; ++i )
+    {
+        // Quantize the depth coarsely so that many keys are equal.
+        float depth = static_cast<int>( depthDistribution( random ) * 4.0f ) / 4.0f;
+        uint64_t sortKey = SortKey::Opaque( idDistribution( random ), idDistribution( random ), idDistribution( random ), idDistribution( random ), depth );
+        renderQueue.Submit( sortKey, MakeDrawCommand( nullptr, i ) );
+    }
+
+    renderQueue.Sort();
+    REQUIRE( renderQueue.get_NumCommands() == numDraws );
+
+    std::vector<bool> seen( numDraws, false );
+    for ( size_t i = 0; i < numDraws; ++i )
+    {
+        uint32_t id = renderQueue.get_SortedCommand( i ).StartIndex;
+        CHECK( !seen[id] );
+        seen[id] = true;
+
+        if ( i > 0 )
+        {
+            uint64_t previousKey = renderQueue.get_SortedKey( i - 1 );
+            uint64_t key = renderQueue.get_SortedKey( i );
+            CHECK( previousKey <= key );
+            // Commands with the same key keep the submission order.
+            if ( previousKey == key )
+            {
+                CHECK( renderQueue.get_SortedCommand( i - 1 ).StartIndex < id );
+            }
+        }
+    }
+}
+
+TEST( RenderQueue, StateCacheFiltersRedundantState )
+{
+    char shaders[2];
+
+    RenderQueue renderQueue;
+    // Interleave two pixel shaders in submission order; the shader field of the key groups them.
+    for ( uint32_t i = 0; i < 8; ++i )
+    {
+        uint32_t shader = i % 2;
+        renderQueue.Submit( SortKey::Opaque( 0, shader, 0, 0, 0.5f ), MakeDrawCommand( &shaders[shader], i ) );
+    }
+
+    RecordingRenderContext renderContext;
+    StateCache stateCache( renderContext );
+    renderQueue.Execute( stateCache );
+
+    CHECK( renderContext.DrawCalls == 8 );
+    CHECK( stateCache.get_Statistics().DrawCalls == 8 );
+    // Each pixel shader is bound once.
+    std::vector<uint64_t> pixelShaders = renderContext.GetArguments( RecordingRenderContext::SetPixelShaderOpcode, 0 );
+    REQUIRE( pixelShaders.size() == 2 );
+    CHECK( pixelShaders[0] == RecordingRenderContext::Handle( &shaders[0] ) );
+    CHECK( pixelShaders[1] == RecordingRenderContext::Handle( &shaders[1] ) );
+    CHECK( stateCache.get_Statistics().StateChangesAvoided > 0 );
+    CHECK( stateCache.get_Statistics().StateChanges == renderContext.StateChanges );
+
+    // After Invalidate the state is forwarded again.
+    uint64_t stateChanges = renderContext.StateChanges;
+    stateCache.Invalidate();
+    stateCache.SetPixelShader( &shaders[1] );
+    CHECK( renderContext.StateChanges == stateChanges + 1 );
+    stateCache.SetPixelShader( &shaders[1] );
+    CHECK( renderContext.StateChanges == stateChanges + 1 );
+}
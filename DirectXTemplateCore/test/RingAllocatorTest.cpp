@@ -0,0 +1,130 @@
+#include <Test.h>
+
+#include <RingAllocator.h>
+
+#include <deque>
+#include <stdexcept>
+
+namespace
+{
+    struct Range
+    {
+        size_t Offset;
+        size_t Size;
+    };
+
+    bool Overlaps( const Range& a, const Range& b )
+    {
+        return a.Offset < b.Offset + b.Size && b.Offset < a.Offset + a.Size;
+    }
+}
+
+TEST( RingAllocator, AlignmentAndCapacity )
+{
+    RingAllocator allocator( 1000, 256 );
+    CHECK( allocator.get_Capacity() == 768 );
+    CHECK( allocator.AlignUp( 1 ) == 256 );
+    CHECK( allocator.AlignUp( 256 ) == 256 );
+    CHECK( allocator.AlignUp( 257 ) == 512 );
+
+    CHECK( allocator.Allocate( 10 ) == 0 );
+    CHECK( allocator.Allocate( 300 ) == 256 );
+    CHECK( allocator.get_UsedSize() == 768 );
+    CHECK( allocator.Allocate( 1 ) == RingAllocator::InvalidOffset );
+    CHECK( allocator.Allocate( 1024 ) == RingAllocator::InvalidOffset );
+
+    bool threw = false;
+    try
+    {
+        RingAllocator invalid( 1024, 100 );
+    }
+    catch ( const std::invalid_argument& )
+    {
+        threw = true;
+    }
+    CHECK( threw );
+}
+
+TEST( RingAllocator, MemoryIsReusedAfterTheFence )
+{
+    RingAllocator allocator( 1024, 256 );
+
+    CHECK( allocator.Allocate( 512 ) == 0 );
+    allocator.FinishFrame( 1 );
+    CHECK( allocator.Allocate( 256 ) == 512 );
+    allocator.FinishFrame( 2 );
+
+    // 256 bytes are left at the end of the buffer: a 512 byte allocation must wait for frame 1.
+    CHECK( allocator.Allocate( 512 ) == RingAllocator::InvalidOffset );
+    CHECK( allocator.get_OldestFenceValue() == 1 );
+
+    allocator.ReleaseCompletedFrames( 1 );
+    CHECK( allocator.get_NumFramesInFlight() == 1 );
+    CHECK( allocator.get_OldestFenceValue() == 2 );
+
+    // The end of the buffer is skipped and the allocation wraps around.
+    CHECK( allocator.Allocate( 512 ) == 0 );
+    CHECK( allocator.get_WrapCount() == 1 );
+    CHECK( allocator.get_UsedSize() == 1024 );
+    allocator.FinishFrame( 3 );
+
+    allocator.ReleaseCompletedFrames( 3 );
+    CHECK( allocator.get_UsedSize() == 0 );
+    CHECK( allocator.get_NumFramesInFlight() == 0 );
+    CHECK( allocator.get_OldestFenceValue() == 0 );
+}
+
+// Simulates the traffic of the DynamicConstantBuffer with the GPU lagging a few
+// frames behind. Allocations that are still in flight must never overlap.
+TEST( RingAllocator, InFlightAllocationsDoNotOverlap )
+{
+    const int framesInFlight = 3;
+    RingAllocator allocator( 256 * 1024, 256 );
+
+    std::deque< std::pair< uint64_t, std::vector<Range> > > frames;
+    uint32_t seed = 1;
+
+    for ( uint64_t frame = 1; frame <= 500; ++frame )
+    {
+        if ( frame > framesInFlight )
+        {
+            allocator.ReleaseCompletedFrames( frame - framesInFlight );
+            while ( !frames.empty() && frames.front().first <= frame - framesInFlight )
+            {
+                frames.pop_front();
+            }
+        }
+
+        std::vector<Range> ranges;
+        seed = seed * 1664525u + 1013904223u;
+        int numDraws = 10 + ( seed >> 24 ) % 40;
+        for ( int draw = 0; draw < numDraws; ++draw )
+        {
+            seed = seed * 1664525u + 1013904223u;
+            size_t size = 16 + ( seed >> 20 ) % 400;
+            size_t offset = allocator.Allocate( size );
+            REQUIRE( offset != RingAllocator::InvalidOffset );
+            REQUIRE( offset % allocator.get_Alignment() == 0 );
+            REQUIRE( offset + size <= allocator.get_Capacity() );
+
+            Range range = { offset, size };
+            for ( const Range& other : ranges )
+            {
+                REQUIRE( !Overlaps( range, other ) );
+            }
+            for ( const auto& inFlight : frames )
+            {
+                for ( const Range& other : inFlight.second )
+                {
+                    REQUIRE( !Overlaps( range, other ) );
+                }
+            }
+            ranges.push_back( range );
+        }
+
+        allocator.FinishFrame( frame );
+        frames.push_back( std::make_pair( frame, ranges ) );
+    }
+
+    CHECK( allocator.get_WrapCount() > 0 );
+}
@@ -0,0 +1,114 @@
+/**
+ * @brief A simulated shader compiler for the ShaderPermutations tests and benchmarks.
+ *
+ * SimulatedShaderCompiler stands in for D3DCompile, LoadVariants loads every variant
+ * of a shader through a new shader cache, and RemoveCacheFiles deletes the files the
+ * cache wrote for a source and a compiler.
+ */
+#pragma once
+
+#include <ShaderPermutations.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ShaderPermutationsFakes
+{
+    const char* const TexturedLitCode = "float4 TexturedLitPixelShader( PixelShaderInput IN ) : SV_TARGET { ... }";
+
+    /**
+     * Stands in for D3DCompile: the bytecode is derived from the source and the
+     * defines, so different variants get different bytecode. Counts the compiles,
+     * and fails if the define named FailDefine is set to 1.
+     */
+    class SimulatedShaderCompiler : public ShaderCompiler
+    {
+    public:
+        SimulatedShaderCompiler( const std::string& identifier )
+            : m_Identifier( identifier )
+            , m_NumCompiles( 0 )
+        {}
+
+        virtual bool Compile( const ShaderSource& source, const std::vector<ShaderDefine>& defines,
+            std::vector<uint8_t>& bytecode, std::string& errors )
+        {
+            ++m_NumCompiles;
+            for ( const ShaderDefine& define : defines )
+            {
+                if ( define.Name == m_FailDefine && define.Value == "1" )
+                {
+                    errors = source.Name + ": error X3000: " + define.Name;
+                    return false;
+                }
+            }
+
+            // A few KB like the bytecode of a pixel shader.
+            uint64_t state = ComputeShaderHash( source, defines, m_Identifier );
+            bytecode.resize( 2048 + state % 2048 );
+            for ( size_t i = 0; i < bytecode.size(); ++i )
+            {
+                state = state * 6364136223846793005ull + 1442695040888963407ull;
+                bytecode[i] = static_cast<uint8_t>( state >> 56 );
+            }
+            return true;
+        }
+
+        virtual std::string get_Identifier() const
+        {
+            return m_Identifier;
+        }
+
+        void set_FailDefine( const std::string& name )
+        {
+            m_FailDefine = name;
+        }
+
+        uint32_t get_NumCompiles() const
+        {
+            return m_NumCompiles;
+        }
+
+    private:
+        std::string m_Identifier;
+        std::string m_FailDefine;
+        uint32_t m_NumCompiles;
+    };
+
+    struct CacheRun
+    {
+        ShaderCache::Statistics Statistics;
+        uint32_t NumCompiles;
+    };
+
+    // Load every variant through a new cache (nothing is kept in memory between runs).
+    inline CacheRun LoadVariants( SimulatedShaderCompiler& compiler, const std::string& directory, const ShaderSource& source,
+        const ShaderPermutations& permutations, std::vector<std::vector<uint8_t>>& bytecode )
+    {
+        uint32_t numCompiles = compiler.get_NumCompiles();
+        ShaderCache cache( compiler, directory );
+        std::vector<ShaderDefine> defines;
+        bytecode.resize( permutations.get_NumVariants() );
+        for ( uint32_t variant = 0; variant < permutations.get_NumVariants(); ++variant )
+        {
+            permutations.GetDefines( variant, defines );
+            cache.Load( source, defines, bytecode[variant] );
+        }
+
+        CacheRun run = { cache.get_Statistics(), compiler.get_NumCompiles() - numCompiles };
+        return run;
+    }
+
+    inline void RemoveCacheFiles( const std::string& directory, const ShaderSource& source, const ShaderPermutations& permutations,
+        const std::string& compilerIdentifier )
+    {
+        SimulatedShaderCompiler compiler( compilerIdentifier );
+        ShaderCache cache( compiler, directory );
+        std::vector<ShaderDefine> defines;
+        for ( uint32_t variant = 0; variant < permutations.get_NumVariants(); ++variant )
+        {
+            permutations.GetDefines( variant, defines );
+            std::remove( cache.get_FileName( source, ComputeShaderHash( source, defines, compilerIdentifier ) ).c_str() );
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#include <Test.h>
+
+#include <ShaderPermutations.h>
+#include <ShaderPermutationsFakes.h>
+
+#include <cstdio>
+#include <set>
+
+using namespace ShaderPermutationsFakes;
+
+TEST( ShaderPermutations, VariantsValuesAndDefinesAgree )
+{
+    for ( uint32_t numKeywords = 1; numKeywords <= 10; numKeywords += 3 )
+    {
+        // Alternate between boolean keywords and counts.
+        std::vector<ShaderKeyword> keywords;
+        for ( uint32_t i = 0; i < numKeywords; ++i )
+        {
+            ShaderKeyword keyword = { "KEYWORD_" + std::to_string( i ), ( i % 2 == 0 ) ? 2u : 3u };
+            keywords.push_back( keyword );
+        }
+        ShaderPermutations permutations( keywords );
+        REQUIRE( permutations.get_NumKeywords() == numKeywords );
+
+        uint32_t numVariants = 1;
+        for ( const ShaderKeyword& keyword : keywords )
+        {
+            numVariants *= keyword.NumValues;
+        }
+        REQUIRE( permutations.get_NumVariants() == numVariants );
+
+        // Every variant has its own defines and its own content hash.
+        ShaderSource source = { "Test.hlsl", TexturedLitCode, "main", "ps_5_0" };
+        std::vector<ShaderDefine> defines;
+        std::vector<uint32_t> values( numKeywords );
+        std::set<uint64_t> hashes;
+        for ( uint32_t variant = 0; variant < numVariants; ++variant )
+        {
+            permutations.GetDefines( variant, defines );
+            REQUIRE( defines.size() == numKeywords );
+            for ( uint32_t i = 0; i < numKeywords; ++i )
+            {
+                values[i] = permutations.GetValue( variant, i );
+                REQUIRE( values[i] < keywords[i].NumValues );
+                REQUIRE( defines[i].Name == keywords[i].Name );
+                REQUIRE( defines[i].Value == std::to_string( values[i] ) );
+            }
+            REQUIRE( permutations.GetVariant( values.data() ) == variant );
+            hashes.insert( ComputeShaderHash( source, defines, "Simulated" ) );
+        }
+        CHECK( hashes.size() == numVariants );
+    }
+}
+
+TEST( ShaderPermutations, TexturedLitVariants )
+{
+    ShaderPermutations permutations( GetTexturedLitKeywords() );
+    REQUIRE( permutations.get_NumVariants() == 16 );
+
+    _Material texturedMaterial;
+    texturedMaterial.UseTexture = true;
+    _Material plainMaterial;
+
+    uint32_t spotAndPointLights[LightTypeCount] = { 0, 2, 6 };
+    uint32_t spotLights[LightTypeCount] = { 0, 0, 6 };
+    uint32_t noLights[LightTypeCount] = { 0, 0, 0 };
+    uint32_t allLights[LightTypeCount] = { 1, 4096, 6 };
+
+    std::vector<ShaderDefine> defines;
+    permutations.GetDefines( GetTexturedLitVariant( permutations, texturedMaterial, spotAndPointLights ), defines );
+    CHECK( defines[TexturedLitUseTexture].Value == "1" );
+    CHECK( defines[TexturedLitDirectionalLights].Value == "0" );
+    CHECK( defines[TexturedLitPointLights].Value == "1" );
+    CHECK( defines[TexturedLitSpotLights].Value == "1" );
+
+    permutations.GetDefines( GetTexturedLitVariant( permutations, plainMaterial, spotLights ), defines );
+    CHECK( defines[TexturedLitUseTexture].Value == "0" );
+    CHECK( defines[TexturedLitPointLights].Value == "0" );
+    CHECK( defines[TexturedLitSpotLights].Value == "1" );
+
+    CHECK( GetTexturedLitVariant( permutations, plainMaterial, noLights ) == 0 );
+    CHECK( GetTexturedLitVariant( permutations, texturedMaterial, allLights ) == permutations.get_NumVariants() - 1 );
+}
+
+TEST( ShaderPermutations, CacheOnlyCompilesWhatChanged )
+{
+    ShaderPermutations permutations( GetTexturedLitKeywords() );
+    ShaderSource source = { "ShaderPermutationsTest.hlsl", TexturedLitCode, "TexturedLitPixelShader", "ps_5_0" };
+    ShaderSource changedSource = source;
+    changedSource.Code += "\n// A changed comment.";
+    uint32_t numVariants = permutations.get_NumVariants();
+    RemoveCacheFiles( "", source, permutations, "Simulated 1" );
+
+    // A cold cache compiles and stores every variant, a warm cache loads them all.
+    SimulatedShaderCompiler compiler( "Simulated 1" );
+    std::vector<std::vector<uint8_t>> coldBytecode;
+    CacheRun cold = LoadVariants( compiler, "", source, permutations, coldBytecode );
+    CHECK( cold.Statistics.Compiled == numVariants && cold.NumCompiles == numVariants );
+
+    std::vector<std::vector<uint8_t>> warmBytecode;
+    CacheRun warm = LoadVariants( compiler, "", source, permutations, warmBytecode );
+    CHECK( warm.Statistics.Loaded == numVariants && warm.NumCompiles == 0 );
+    CHECK( warmBytecode == coldBytecode );
+
+    // The changed source has other hashes, so the old files are not loaded.
+    std::vector<std::vector<uint8_t>> changedBytecode;
+    CacheRun changed = LoadVariants( compiler, "", changedSource, permutations, changedBytecode );
+    CHECK( changed.Statistics.Compiled == numVariants );
+    for ( size_t i = 0; i < changedBytecode.size(); ++i )
+    {
+        CHECK( changedBytecode[i] != coldBytecode[i] );
+    }
+    RemoveCacheFiles( "", changedSource, permutations, "Simulated 1" );
+
+    // Another compiler (or other flags) does not load the files of the first one.
+    SimulatedShaderCompiler otherCompiler( "Simulated 2" );
+    std::vector<std::vector<uint8_t>> otherBytecode;
+    CacheRun other = LoadVariants( otherCompiler, "", source, permutations, otherBytecode );
+    CHECK( other.Statistics.Compiled == numVariants );
+    RemoveCacheFiles( "", source, permutations, "Simulated 2" );
+
+    // A damaged file is a cache miss, and only its variant is compiled again.
+    {
+        ShaderCache cache( compiler, "" );
+        std::vector<ShaderDefine> defines;
+        permutations.GetDefines( 5, defines );
+        std::string fileName = cache.get_FileName( source, ComputeShaderHash( source, defines, compiler.get_Identifier() ) );
+        FILE* file = fopen( fileName.c_str(), "r+b" );
+        REQUIRE( file != nullptr );
+        uint8_t byte = 0xFF;
+        fseek( file, sizeof( ShaderCacheFileHeader ) + 100, SEEK_SET );
+        CHECK( fread( &byte, 1, 1, file ) == 1 );
+        byte = static_cast<uint8_t>( ~byte );
+        fseek( file, sizeof( ShaderCacheFileHeader ) + 100, SEEK_SET );
+        fwrite( &byte, 1, 1, file );
+        fclose( file );
+    }
+    std::vector<std::vector<uint8_t>> repairedBytecode;
+    CacheRun repaired = LoadVariants( compiler, "", source, permutations, repairedBytecode );
+    CHECK( repaired.Statistics.Compiled == 1 && repaired.Statistics.Loaded == numVariants - 1 );
+    CHECK( repairedBytecode == coldBytecode );
+    RemoveCacheFiles( "", source, permutations, "Simulated 1" );
+
+    // The variants with spot lights do not compile: they are reported and not stored.
+    SimulatedShaderCompiler failingCompiler( "Simulated 3" );
+    failingCompiler.set_FailDefine( "SPOT_LIGHTS" );
+    std::vector<std::vector<uint8_t>> failedBytecode;
+    CacheRun failed = LoadVariants( failingCompiler, "", source, permutations, failedBytecode );
+    CacheRun retried = LoadVariants( failingCompiler, "", source, permutations, failedBytecode );
+    CHECK( failed.Statistics.Failed == numVariants / 2 );
+    CHECK( retried.Statistics.Loaded == numVariants / 2 && retried.Statistics.Failed == numVariants / 2 );
+    RemoveCacheFiles( "", source, permutations, "Simulated 3" );
+}
@@ -0,0 +1,345 @@
+#include <Test.h>
+
+#include <Camera.h>
+#include <LightClusters.h>
+#include <ShadowMaps.h>
+#include <VenueScene.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace Math;
+using namespace VenueScene;
+
+namespace
+{
+    /**
+     * Returns true if the tiles are inside the atlas and do not overlap, if every
+     * shadow map with an importance has a tile unless the atlas is full, and if a more
+     * important shadow map never has a smaller tile than a less important one.
+     */
+    bool IsValidPacking( const ShadowAtlas& atlas, const std::vector<float>& importance, const std::vector<ShadowAtlasTile>& tiles, size_t numPacked )
+    {
+        uint32_t cellsPerRow = atlas.get_Size() / atlas.get_MinTileSize();
+        std::vector<uint8_t> cells( static_cast<size_t>( cellsPerRow ) * cellsPerRow, 0 );
+
+        size_t count = 0;
+        uint32_t smallestPacked = UINT32_MAX;
+        float largestDropped = 0.0f;
+        for ( size_t i = 0; i < tiles.size(); ++i )
+        {
+            const ShadowAtlasTile& tile = tiles[i];
+            if ( tile.Size == 0 )
+            {
+                if ( importance[i] > 0.0f )
+                {
+                    largestDropped = std::max( largestDropped, importance[i] );
+                }
+                continue;
+            }
+
+            ++count;
+            smallestPacked = std::min( smallestPacked, tile.Size );
+            if ( importance[i] <= 0.0f || tile.Size > atlas.GetTileSize( importance[i] ) ||
+                 tile.X % tile.Size != 0 || tile.Y % tile.Size != 0 || tile.X + tile.Size > atlas.get_Size() || tile.Y + tile.Size > atlas.get_Size() )
+            {
+                return false;
+            }
+
+            for ( uint32_t y = tile.Y / atlas.get_MinTileSize(); y < ( tile.Y + tile.Size ) / atlas.get_MinTileSize(); ++y )
+            {
+                for ( uint32_t x = tile.X / atlas.get_MinTileSize(); x < ( tile.X + tile.Size ) / atlas.get_MinTileSize(); ++x )
+                {
+                    if ( cells[y * cellsPerRow + x]++ != 0 )
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            for ( size_t j = 0; j < tiles.size(); ++j )
+            {
+                if ( importance[j] > importance[i] && tiles[j].Size != 0 && tiles[j].Size < tile.Size )
+                {
+                    return false;
+                }
+            }
+        }
+
+        // Shadow maps are only dropped when the atlas is full of minimum tiles.
+        bool full = count == static_cast<size_t>( cellsPerRow ) * cellsPerRow && smallestPacked == atlas.get_MinTileSize();
+        return count == numPacked && ( largestDropped == 0.0f || full );
+    }
+}
+
+TEST( ShadowMaps, AtlasPacking )
+{
+    ShadowAtlas atlas( 4096, 128, 2048 );
+    Camera camera = CreateCamera();
+    CHECK( atlas.GetTileSize( 0.0f ) == 0 );
+    CHECK( atlas.GetTileSize( 1.0f ) == 2048 );
+    CHECK( atlas.GetTileSize( 1e-6f ) == 128 );
+
+    // From a few lights that all get their tiles to more lights than the atlas holds.
+    for ( size_t numLights = 16; numLights <= 4096; numLights *= 16 )
+    {
+        std::vector<Light> lights = GenerateSpotLights( numLights, 1234 );
+        std::vector<float> importance( numLights );
+        std::vector<ShadowAtlasTile> tiles;
+        for ( int frame = 0; frame < 4; ++frame )
+        {
+            WalkThroughVenue( camera, -100.0f + 50.0f * frame );
+            for ( size_t i = 0; i < numLights; ++i )
+            {
+                importance[i] = ShadowImportance( lights[i], camera );
+            }
+
+            size_t count = atlas.Pack( importance, tiles );
+            REQUIRE( tiles.size() == numLights );
+            CHECK( IsValidPacking( atlas, importance, tiles, count ) );
+        }
+    }
+}
+
+TEST( ShadowMaps, CascadesCoverTheirSlicesAndDoNotShimmer )
+{
+    const uint32_t numCascades = 4;
+    const uint32_t resolution = 2048;
+
+    Camera camera = CreateCamera();
+    Float3 lightDirection = Normalize( Float3( 0.3f, -1.0f, 0.5f ) );
+    Float3 staticPoint( 3.0f, 1.0f, -80.0f );
+
+    float splits[numCascades + 1];
+    ComputeCascadeSplits( camera.get_NearClipPlane(), camera.get_FarClipPlane(), numCascades, 0.8f, splits );
+    CHECK( splits[0] == camera.get_NearClipPlane() );
+    CHECK( splits[numCascades] == camera.get_FarClipPlane() );
+    for ( uint32_t i = 0; i < numCascades; ++i )
+    {
+        CHECK( splits[i] < splits[i + 1] );
+    }
+
+    float tanY = std::tan( ConvertToRadians( 30.0f ) );
+    float tanX = tanY * AspectRatio;
+
+    Float3 firstTexel( 0.0f, 0.0f, 0.0f );
+    const int numFrames = 1000;
+    for ( int frame = 0; frame < numFrames; ++frame )
+    {
+        MoveAndTurn( camera, static_cast<float>( frame ) / numFrames );
+
+        ShadowView views[numCascades];
+        for ( uint32_t i = 0; i < numCascades; ++i )
+        {
+            views[i] = ComputeCascadeView( camera, lightDirection, splits[i], splits[i + 1], resolution, 50.0f );
+        }
+
+        // Every corner of every slice of the view frustum is inside its cascade.
+        for ( uint32_t i = 0; i < numCascades; ++i )
+        {
+            for ( int corner = 0; corner < 8; ++corner )
+            {
+                float z = ( corner & 4 ) ? splits[i + 1] : splits[i];
+                Float3 viewPosition( ( ( corner & 1 ) ? z : -z ) * tanX, ( ( corner & 2 ) ? z : -z ) * tanY, z );
+                Float3 clip = TransformPoint( TransformPoint( viewPosition, camera.get_InverseViewMatrix() ), views[i].ViewProjectionMatrix );
+                const float epsilon = 1e-4f;
+                REQUIRE( std::abs( clip.x ) <= 1.0f + epsilon );
+                REQUIRE( std::abs( clip.y ) <= 1.0f + epsilon );
+                REQUIRE( clip.z >= -epsilon && clip.z <= 1.0f + epsilon );
+            }
+        }
+
+        // A static point stays at the same fraction of a texel: the cascades move in whole texels.
+        Float3 texel = ShadowTexel( views[numCascades - 1], staticPoint, resolution );
+        if ( frame == 0 )
+        {
+            firstTexel = texel;
+        }
+        REQUIRE( std::abs( ( texel.x - firstTexel.x ) - std::round( texel.x - firstTexel.x ) ) < 0.01f );
+        REQUIRE( std::abs( ( texel.y - firstTexel.y ) - std::round( texel.y - firstTexel.y ) ) < 0.01f );
+    }
+}
+
+TEST( ShadowMaps, ShadowMapConstants )
+{
+    Camera camera = CreateCamera();
+    ShadowView view = ComputeCascadeView( camera, Normalize( Float3( 0.3f, -1.0f, 0.5f ) ), 0.1f, 10.0f, 512, 50.0f );
+    ShadowAtlasTile tile = { 1024, 512, 512 };
+    ShadowMapConstants constants = ComputeShadowMapConstants( view, tile, 4096, 10.0f, 0.001f );
+    CHECK( constants.SplitDepth == 10.0f );
+    CHECK( constants.DepthBias == 0.001f );
+
+    // The tile bounds are half a texel inside the tile.
+    const float texel = 1.0f / 4096.0f;
+    CHECK( std::abs( constants.TileBounds.x - ( 1024.5f * texel ) ) < 1e-6f );
+    CHECK( std::abs( constants.TileBounds.y - ( 512.5f * texel ) ) < 1e-6f );
+    CHECK( std::abs( constants.TileBounds.z - ( 1535.5f * texel ) ) < 1e-6f );
+    CHECK( std::abs( constants.TileBounds.w - ( 1023.5f * texel ) ) < 1e-6f );
+
+    // The center of the cascade maps to the center of the tile.
+    Float4x4 inverse = MatrixInverse( view.ViewProjectionMatrix );
+    Float3 center = TransformPoint( Float3( 0.0f, 0.0f, 0.5f ), inverse );
+    Float3 uv = TransformPoint( center, constants.ShadowMatrix );
+    CHECK( std::abs( uv.x - 1280.0f * texel ) < 1e-4f );
+    CHECK( std::abs( uv.y - 768.0f * texel ) < 1e-4f );
+}
+
+TEST( ShadowMaps, CacheRendersOnlyWhatChanged )
+{
+    ShadowCache cache;
+    Light light = GenerateSpotLights( 1, 1234 )[0];
+    ShadowView view = ComputeSpotShadowView( light, 0.1f, 100.0f );
+    ShadowAtlasTile tile = { 0, 0, 512 };
+    ShadowAtlasTile otherTile = { 512, 0, 512 };
+
+    // A new shadow map is rendered, an unchanged one is not.
+    cache.BeginFrame();
+    CHECK( cache.Update( 1, tile, view ) );
+    CHECK( cache.get_Statistics().Misses == 1 );
+    cache.BeginFrame();
+    CHECK( !cache.Update( 1, tile, view ) );
+    CHECK( cache.get_Statistics().Hits == 1 && cache.get_Statistics().Misses == 0 );
+
+    // Another tile or another view.
+    cache.BeginFrame();
+    CHECK( cache.Update( 1, otherTile, view ) );
+    cache.BeginFrame();
+    CHECK( !cache.Update( 1, otherTile, view ) );
+    light.Position.x += 0.5f;
+    ShadowView movedView = ComputeSpotShadowView( light, 0.1f, 100.0f );
+    cache.BeginFrame();
+    CHECK( cache.Update( 1, otherTile, movedView ) );
+
+    // Another shadow map was rendered into the tile.
+    cache.BeginFrame();
+    CHECK( cache.Update( 2, tile, view ) );
+    CHECK( !cache.Update( 1, otherTile, movedView ) );
+    cache.BeginFrame();
+    CHECK( cache.Update( 1, tile, movedView ) );
+    cache.BeginFrame();
+    CHECK( cache.Update( 2, tile, view ) );
+    CHECK( cache.get_NumShadowMaps() == 2 );
+
+    // An object that moved inside the view of a shadow map, and one that moved far away.
+    Float3 lightPosition( light.Position.x, light.Position.y, light.Position.z );
+    Float3 lightDirection( light.Direction.x, light.Direction.y, light.Direction.z );
+    cache.BeginFrame();
+    CHECK( !cache.Update( 2, tile, view ) );
+    cache.Invalidate( BoundingSphere( Float3( 1000.0f, 1000.0f, 1000.0f ), 1.0f ) );
+    cache.BeginFrame();
+    CHECK( !cache.Update( 2, tile, view ) );
+    cache.Invalidate( BoundingSphere( lightPosition + lightDirection, 0.5f ) );
+    cache.BeginFrame();
+    CHECK( cache.Update( 2, tile, view ) );
+
+    cache.InvalidateAll();
+    cache.BeginFrame();
+    CHECK( cache.Update( 2, tile, view ) );
+}
+
+// The static shadow maps of 256 spot lights of which 16 move, while the camera moves
+// through the venue and then stands still. A simulated atlas records which shadow
+// map each tile holds. The cache must ask for every shadow map that is new, moved,
+// changed its tile or had another shadow map rendered into its tile, and for the
+// shadow maps that see an object that moved.
+TEST( ShadowMaps, CacheMatchesSimulatedAtlas )
+{
+    const int numFrames = 100;
+    const size_t numLights = 256;
+    const size_t numMovingLights = 16;
+
+    ShadowAtlas atlas( 8192, 256, 2048 );
+    ShadowCache cache;
+    Camera camera = CreateCamera();
+    std::vector<Light> lights = GenerateSpotLights( numLights, 5678 );
+
+    // The shadow map that each minimum tile of the simulated atlas holds, and the view it was rendered with.
+    uint32_t cellsPerRow = atlas.get_Size() / atlas.get_MinTileSize();
+    struct Cell
+    {
+        uint64_t Key;
+        Float4x4 ViewProjectionMatrix;
+    };
+    Cell emptyCell = { UINT64_MAX, Float4x4() };
+    std::vector<Cell> cells( static_cast<size_t>( cellsPerRow ) * cellsPerRow, emptyCell );
+
+    std::vector<float> importance( numLights );
+    std::vector<ShadowAtlasTile> tiles;
+    std::vector<ShadowView> views( numLights );
+    BoundingSphere movingObject( Float3( 0.0f, 2.0f, 0.0f ), 3.0f );
+    uint64_t numHits = 0;
+    for ( int frame = 0; frame < numFrames; ++frame )
+    {
+        WalkThroughVenue( camera, -100.0f + 100.0f * std::min( frame, numFrames / 2 ) / numFrames );
+        for ( size_t i = 0; i < numMovingLights; ++i )
+        {
+            lights[i].Position.x += 0.1f;
+        }
+        for ( size_t i = 0; i < numLights; ++i )
+        {
+            importance[i] = ShadowImportance( lights[i], camera );
+            views[i] = ComputeSpotShadowView( lights[i], 0.1f, 100.0f );
+        }
+
+        atlas.Pack( importance, tiles );
+        cache.BeginFrame();
+
+        // A static object moves every tenth frame (for example a door that opens).
+        bool objectMoved = ( frame % 10 == 5 );
+        if ( objectMoved )
+        {
+            cache.Invalidate( movingObject );
+        }
+
+        std::vector<bool> render( numLights, false );
+        for ( size_t i = 0; i < numLights; ++i )
+        {
+            if ( tiles[i].Size != 0 )
+            {
+                render[i] = cache.Update( i, tiles[i], views[i] );
+            }
+        }
+        numHits += cache.get_Statistics().Hits;
+
+        // A shadow map may only be skipped if all of its cells still hold it, rendered
+        // with the same view, and the object did not move into its view.
+        uint64_t numRendered = 0;
+        for ( size_t i = 0; i < numLights; ++i )
+        {
+            const ShadowAtlasTile& tile = tiles[i];
+            if ( tile.Size == 0 ) continue;
+
+            bool current = !( objectMoved && Frustum( views[i].ViewProjectionMatrix ).Intersects( movingObject ) );
+            for ( uint32_t y = tile.Y / atlas.get_MinTileSize(); y < ( tile.Y + tile.Size ) / atlas.get_MinTileSize(); ++y )
+            {
+                for ( uint32_t x = tile.X / atlas.get_MinTileSize(); x < ( tile.X + tile.Size ) / atlas.get_MinTileSize(); ++x )
+                {
+                    const Cell& cell = cells[y * cellsPerRow + x];
+                    current = current && cell.Key == i && memcmp( &cell.ViewProjectionMatrix, &views[i].ViewProjectionMatrix, sizeof( Float4x4 ) ) == 0;
+                }
+            }
+            REQUIRE( current || render[i] );
+            numRendered += render[i] ? 1 : 0;
+        }
+        CHECK( cache.get_Statistics().Misses == numRendered );
+
+        // Render the shadow maps into the simulated atlas.
+        for ( size_t i = 0; i < numLights; ++i )
+        {
+            if ( !render[i] ) continue;
+
+            const ShadowAtlasTile& tile = tiles[i];
+            for ( uint32_t y = tile.Y / atlas.get_MinTileSize(); y < ( tile.Y + tile.Size ) / atlas.get_MinTileSize(); ++y )
+            {
+                for ( uint32_t x = tile.X / atlas.get_MinTileSize(); x < ( tile.X + tile.Size ) / atlas.get_MinTileSize(); ++x )
+                {
+                    Cell cell = { i, views[i].ViewProjectionMatrix };
+                    cells[y * cellsPerRow + x] = cell;
+                }
+            }
+        }
+    }
+    CHECK( numHits > 0 );
+}
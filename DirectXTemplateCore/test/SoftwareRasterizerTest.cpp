@@ -0,0 +1,146 @@
+#include <Test.h>
+
+#include <Camera.h>
+#include <Geometry.h>
+#include <SoftwareRasterizer.h>
+
+using namespace Math;
+
+namespace
+{
+    const uint32_t Width = 320;
+    const uint32_t Height = 180;
+
+    PerObjectConstants MakePerObject( const Float4x4& worldMatrix, const Float4x4& viewProjectionMatrix )
+    {
+        PerObjectConstants perObject;
+        perObject.WorldMatrix = worldMatrix;
+        perObject.InverseTransposeWorldMatrix = MatrixTranspose( MatrixInverse( worldMatrix ) );
+        perObject.WorldViewProjectionMatrix = worldMatrix * viewProjectionMatrix;
+        return perObject;
+    }
+
+    Float4x4 GetViewProjectionMatrix()
+    {
+        Camera camera( Camera::LeftHanded );
+        camera.set_LookAt( Float3( 0, 0, -10 ), Float3( 0, 0, 0 ), Float3( 0, 1, 0 ) );
+        camera.set_Projection( 45.0f, Width / static_cast<float>( Height ), 0.1f, 100.0f );
+        return camera.get_ViewMatrix() * camera.get_ProjectionMatrix();
+    }
+
+    // A material that only outputs its emissive color.
+    MaterialProperties EmissiveMaterial( const Float4& color )
+    {
+        MaterialProperties material;
+        material.Material.Emissive = color;
+        material.Material.Ambient = Float4( 0.0f, 0.0f, 0.0f, 1.0f );
+        material.Material.Diffuse = Float4( 0.0f, 0.0f, 0.0f, 1.0f );
+        material.Material.Specular = Float4( 0.0f, 0.0f, 0.0f, 1.0f );
+        return material;
+    }
+
+    const uint8_t* GetPixel( const SoftwareRasterizer& rasterizer, uint32_t x, uint32_t y )
+    {
+        return &rasterizer.get_ColorBuffer()[( y * rasterizer.get_Width() + x ) * 4];
+    }
+
+    // A lit scene with spheres and cubes that overlap many tiles.
+    void RenderLitScene( SoftwareRasterizer& rasterizer )
+    {
+        VertexCollection sphereVertices, cubeVertices;
+        IndexCollection sphereIndices, cubeIndices;
+        ComputeSphere( sphereVertices, sphereIndices, 1.0f, 16, false );
+        ComputeCube( cubeVertices, cubeIndices, 1.0f, false );
+
+        LightProperties lightProperties;
+        lightProperties.EyePosition = Float4( 0, 0, -10, 1 );
+        for ( int i = 0; i < 2; ++i )
+        {
+            Light& light = lightProperties.Lights[i];
+            light.Enabled = 1;
+            light.LightType = PointLight;
+            light.Position = Float4( i ? 5.0f : -5.0f, 3.0f, -5.0f, 1.0f );
+            light.LinearAttenuation = 0.08f;
+        }
+
+        Float4x4 viewProjectionMatrix = GetViewProjectionMatrix();
+
+        rasterizer.Clear( Float4( 0.392f, 0.584f, 0.929f, 1.0f ), 1.0f );
+        rasterizer.set_LightProperties( lightProperties );
+        rasterizer.set_MaterialProperties( MaterialProperties() );
+        for ( int i = 0; i < 16; ++i )
+        {
+            Float4x4 worldMatrix = MatrixScaling( 1.5f, 1.5f, 1.5f ) * MatrixRotationY( i * 0.4f ) *
+                MatrixTranslation( ( i % 4 ) * 2.5f - 3.75f, ( i / 4 ) * 2.0f - 3.0f, ( i % 3 ) * 1.0f );
+            if ( i % 2 )
+            {
+                rasterizer.DrawIndexed( cubeVertices, cubeIndices, MakePerObject( worldMatrix, viewProjectionMatrix ) );
+            }
+            else
+            {
+                rasterizer.DrawIndexed( sphereVertices, sphereIndices, MakePerObject( worldMatrix, viewProjectionMatrix ) );
+            }
+        }
+        rasterizer.Flush();
+    }
+}
+
+TEST( SoftwareRasterizer, ClearAndEmissiveColor )
+{
+    VertexCollection vertices;
+    IndexCollection indices;
+    ComputeCube( vertices, indices, 1.0f, false );
+
+    SoftwareRasterizer rasterizer( Width, Height, 2 );
+    rasterizer.Clear( Float4( 0.0f, 0.0f, 1.0f, 1.0f ), 1.0f );
+    rasterizer.set_MaterialProperties( EmissiveMaterial( Float4( 1.0f, 0.0f, 0.0f, 1.0f ) ) );
+    rasterizer.DrawIndexed( vertices, indices, MakePerObject( MatrixScaling( 2.0f, 2.0f, 2.0f ), GetViewProjectionMatrix() ) );
+    rasterizer.Flush();
+
+    // The cube covers the center of the screen.
+    const uint8_t* center = GetPixel( rasterizer, Width / 2, Height / 2 );
+    CHECK( center[0] == 255 && center[1] == 0 && center[2] == 0 );
+
+    // The corners are not covered.
+    const uint8_t* corner = GetPixel( rasterizer, 0, 0 );
+    CHECK( corner[0] == 0 && corner[1] == 0 && corner[2] == 255 );
+
+    CHECK( rasterizer.get_Statistics().TrianglesSubmitted == 12 );
+    CHECK( rasterizer.get_Statistics().PixelsShaded > 0 );
+}
+
+TEST( SoftwareRasterizer, DepthTest )
+{
+    VertexCollection vertices;
+    IndexCollection indices;
+    ComputeCube( vertices, indices, 1.0f, false );
+
+    Float4x4 viewProjectionMatrix = GetViewProjectionMatrix();
+
+    // Draw the near cube first and the far cube second: the far cube must not overwrite it.
+    SoftwareRasterizer rasterizer( Width, Height, 2 );
+    rasterizer.Clear( Float4( 0.0f, 0.0f, 0.0f, 1.0f ), 1.0f );
+    rasterizer.set_MaterialProperties( EmissiveMaterial( Float4( 0.0f, 1.0f, 0.0f, 1.0f ) ) );
+    rasterizer.DrawIndexed( vertices, indices, MakePerObject( MatrixTranslation( 0.0f, 0.0f, -2.0f ), viewProjectionMatrix ) );
+    rasterizer.set_MaterialProperties( EmissiveMaterial( Float4( 1.0f, 0.0f, 0.0f, 1.0f ) ) );
+    rasterizer.DrawIndexed( vertices, indices, MakePerObject( MatrixScaling( 4.0f, 4.0f, 4.0f ) * MatrixTranslation( 0.0f, 0.0f, 5.0f ), viewProjectionMatrix ) );
+    rasterizer.Flush();
+
+    const uint8_t* center = GetPixel( rasterizer, Width / 2, Height / 2 );
+    CHECK( center[0] == 0 && center[1] == 255 && center[2] == 0 );
+}
+
+TEST( SoftwareRasterizer, ThreadCountDoesNotChangeTheImage )
+{
+    SoftwareRasterizer reference( Width, Height, 1 );
+    RenderLitScene( reference );
+
+    for ( uint32_t numThreads = 2; numThreads <= 8; numThreads *= 2 )
+    {
+        SoftwareRasterizer rasterizer( Width, Height, numThreads );
+        RenderLitScene( rasterizer );
+
+        CHECK( rasterizer.get_ColorBuffer() == reference.get_ColorBuffer() );
+        CHECK( rasterizer.get_DepthBuffer() == reference.get_DepthBuffer() );
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * @brief A minimal test harness for the DirectXTemplateCore library.
+ *
+ * Tests are registered with the TEST macro and are run by the
+ * DirectXTemplateCoreTests executable. Each component (the first argument of
+ * TEST) is registered with CTest as a separate test. Pass the names of the
+ * components on the command line to run only the tests of those components.
+ * The executable returns a nonzero exit code if any CHECK fails.
+ */
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+typedef void (*TestFunction)();
+
+struct TestInfo
+{
+    const char* Component;
+    const char* Name;
+    TestFunction Function;
+};
+
+// The list of registered tests.
+std::vector<TestInfo>& GetTests();
+
+// Record a failed check in the test that is currently running.
+void ReportFailure( const char* file, int line, const char* expression );
+
+struct TestRegistrar
+{
+    TestRegistrar( const char* component, const char* name, TestFunction function )
+    {
+        TestInfo info = { component, name, function };
+        GetTests().push_back( info );
+    }
+};
+
+#define TEST( component, name ) \
+    static void component##_##name(); \
+    static TestRegistrar g_##component##_##name##Registrar( #component, #name, component##_##name ); \
+    static void component##_##name()
+
+// Check a condition. The test continues after a failed check.
+#define CHECK( expression ) \
+    do { if ( !( expression ) ) ReportFailure( __FILE__, __LINE__, #expression ); } while ( false )
+
+// Check a condition and return from the test if it fails.
+#define REQUIRE( expression ) \
+    do { if ( !( expression ) ) { ReportFailure( __FILE__, __LINE__, #expression ); return; } } while ( false )
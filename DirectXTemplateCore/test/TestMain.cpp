@@ -0,0 +1,79 @@
+#include <Test.h>
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    int g_NumFailures = 0;
+}
+
+std::vector<TestInfo>& GetTests()
+{
+    static std::vector<TestInfo> tests;
+    return tests;
+}
+
+void ReportFailure( const char* file, int line, const char* expression )
+{
+    std::cerr << file << "(" << line << "): CHECK( " << expression << " ) failed" << std::endl;
+    ++g_NumFailures;
+}
+
+static void PrintUsage( const char* program )
+{
+    std::cout << "Usage: " << program << " [component...]" << std::endl;
+    std::cout << "Available tests:" << std::endl;
+    for ( const TestInfo& info : GetTests() )
+    {
+        std::cout << "  " << info.Component << "." << info.Name << std::endl;
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    std::vector<std::string> components;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-help" ) == 0 || strcmp( argv[i], "-h" ) == 0 )
+        {
+            PrintUsage( argv[0] );
+            return 0;
+        }
+        components.push_back( argv[i] );
+    }
+
+    int numRun = 0;
+    int numFailed = 0;
+
+    for ( const TestInfo& info : GetTests() )
+    {
+        bool run = components.empty();
+        for ( const std::string& component : components )
+        {
+            run |= ( component == info.Component );
+        }
+        if ( !run ) continue;
+
+        int failures = g_NumFailures;
+        info.Function();
+        bool passed = ( g_NumFailures == failures );
+
+        std::cout << ( passed ? "[  PASSED  ] " : "[  FAILED  ] " ) << info.Component << "." << info.Name << std::endl;
+        ++numRun;
+        if ( !passed ) ++numFailed;
+    }
+
+    // A component without any tests is most likely a typo on the command line or in CMakeLists.txt.
+    if ( numRun == 0 )
+    {
+        std::cerr << "No tests matched the command line." << std::endl;
+        return 1;
+    }
+
+    std::cout << numRun - numFailed << " of " << numRun << " tests passed." << std::endl;
+
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+/**
+ * @brief The scene of the TiledDeferred tests and benchmarks.
+ *
+ * The room of the TextureAndLighting demo as a ray cast depth buffer, the lights
+ * that are culled against its tiles, and the materials, texels and animated lights
+ * that are encoded in and shaded from the G-buffer.
+ */
+#pragma once
+
+#include <Camera.h>
+#include <TiledDeferred.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace TiledDeferredScene
+{
+    const uint32_t ScreenWidth = 1280;
+    const uint32_t ScreenHeight = 720;
+
+    // The room of the TextureAndLighting demo seen from one of its walls.
+    inline Camera CreateCamera()
+    {
+        Camera camera;
+        camera.set_Projection( 45.0f, ScreenWidth / static_cast<float>( ScreenHeight ), 0.1f, 100.0f );
+        camera.set_LookAt( Math::Float3( 0.0f, 5.0f, -9.5f ), Math::Float3( 0.0f, 3.0f, 0.0f ), Math::Float3( 0.0f, 1.0f, 0.0f ) );
+        return camera;
+    }
+
+    // The distance along a ray to the first intersection with a sphere (or infinity).
+    inline float IntersectSphere( const Math::Float3& origin, const Math::Float3& direction, const Math::Float3& center, float radius )
+    {
+        Math::Float3 offset = origin - center;
+        float a = Math::Dot( direction, direction );
+        float b = Math::Dot( offset, direction );
+        float c = Math::Dot( offset, offset ) - radius * radius;
+        float discriminant = b * b - a * c;
+        if ( discriminant < 0.0f )
+        {
+            return std::numeric_limits<float>::infinity();
+        }
+        float t = ( -b - std::sqrt( discriminant ) ) / a;
+        return ( t > 0.0f ) ? t : std::numeric_limits<float>::infinity();
+    }
+
+    /**
+     * Ray cast the depth buffer of the inside of a 20 x 20 x 20 room with three spheres.
+     * The rays are scaled so that the distance along a ray is the view-space depth.
+     */
+    inline void RenderDepth( const Camera& camera, std::vector<float>& depthBuffer )
+    {
+        const Math::Float4x4& projection = camera.get_ProjectionMatrix();
+        const Math::Float4x4& inverseView = camera.get_InverseViewMatrix();
+        Math::Float3 eye = camera.get_Translation();
+
+        depthBuffer.resize( ScreenWidth * ScreenHeight );
+        for ( uint32_t y = 0; y < ScreenHeight; ++y )
+        {
+            for ( uint32_t x = 0; x < ScreenWidth; ++x )
+            {
+                float ndcX = ( x + 0.5f ) / ScreenWidth * 2.0f - 1.0f;
+                float ndcY = 1.0f - ( y + 0.5f ) / ScreenHeight * 2.0f;
+                Math::Float3 direction = Math::TransformNormal( Math::Float3( ndcX / projection.m[0][0], ndcY / projection.m[1][1], 1.0f ), inverseView );
+
+                // The walls, the floor and the ceiling.
+                float z = std::numeric_limits<float>::infinity();
+                const float* origin = &eye.x;
+                const float* d = &direction.x;
+                const float minimum[3] = { -10.0f, 0.0f, -10.0f };
+                const float maximum[3] = { 10.0f, 20.0f, 10.0f };
+                for ( int axis = 0; axis < 3; ++axis )
+                {
+                    if ( d[axis] != 0.0f )
+                    {
+                        float wall = ( d[axis] > 0.0f ) ? maximum[axis] : minimum[axis];
+                        z = std::min( z, ( wall - origin[axis] ) / d[axis] );
+                    }
+                }
+
+                z = std::min( z, IntersectSphere( eye, direction, Math::Float3( -4.0f, 2.0f, -4.0f ), 2.0f ) );
+                z = std::min( z, IntersectSphere( eye, direction, Math::Float3( 4.0f, 4.0f, 4.0f ), 3.0f ) );
+                z = std::min( z, IntersectSphere( eye, direction, Math::Float3( 4.0f, 1.0f, -4.0f ), 1.0f ) );
+
+                // A ray that leaves the depth range keeps the clear depth.
+                depthBuffer[y * ScreenWidth + x] = ( z < 100.0f ) ? projection.m[2][2] + projection.m[3][2] / z : 1.0f;
+            }
+        }
+    }
+
+    // A directional light and small point and spot lights in the room (like the -lights option of the demo).
+    inline std::vector<Light> GenerateLights( size_t numLights )
+    {
+        std::mt19937 random( 1234 );
+        std::uniform_real_distribution<float> positionXZ( -9.5f, 9.5f );
+        std::uniform_real_distribution<float> positionY( 0.25f, 19.5f );
+        std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+
+        std::vector<Light> lights( numLights );
+        for ( size_t i = 0; i < numLights; ++i )
+        {
+            Light& light = lights[i];
+            light.Enabled = 1;
+            light.LightType = ( i == 0 ) ? DirectionalLight : ( i % 8 == 0 ) ? SpotLight : PointLight;
+            light.Color = Math::Float4( unit( random ), unit( random ), unit( random ), 1.0f );
+            light.Position = Math::Float4( positionXZ( random ), positionY( random ), positionXZ( random ), 1.0f );
+            light.Direction = Math::Float4( Math::Normalize( Math::Float3( unit( random ) - 0.5f, -1.0f, unit( random ) - 0.5f ) ), 0.0f );
+            light.SpotAngle = Math::ConvertToRadians( 30.0f );
+            light.QuadraticAttenuation = 16.0f + 48.0f * unit( random );
+            light.Range = AttenuationRange( light );
+        }
+        lights[0].Color = Math::Float4( 0.2f, 0.2f, 0.2f, 1.0f );
+        return lights;
+    }
+
+    // The view-space bounds of the lights.
+    inline void ViewSpaceBounds( const std::vector<Light>& lights, const Camera& camera, BoundingSphereArrays& bounds )
+    {
+        bounds.Clear();
+        for ( const Light& light : lights )
+        {
+            bounds.Add( Transform( LightBounds( light ), camera.get_ViewMatrix() ) );
+        }
+    }
+
+    // Materials with random colors and specular powers from 1 to 1024.
+    inline std::vector<_Material> GenerateMaterials( size_t numMaterials, std::mt19937& random )
+    {
+        std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+        std::uniform_real_distribution<float> logPower( 0.0f, 10.0f );
+
+        std::vector<_Material> materials( numMaterials );
+        for ( _Material& material : materials )
+        {
+            material.Emissive = Math::Float4( 0.1f * unit( random ), 0.1f * unit( random ), 0.1f * unit( random ), 1.0f );
+            material.Ambient = Math::Float4( unit( random ), unit( random ), unit( random ), 1.0f );
+            material.Diffuse = Math::Float4( unit( random ), unit( random ), unit( random ), 1.0f );
+            material.Specular = Math::Float4( unit( random ), unit( random ), unit( random ), 1.0f );
+            material.SpecularPower = std::exp2( logPower( random ) );
+        }
+        return materials;
+    }
+
+    // Random texture colors and unit normals.
+    inline void GenerateTexels( size_t numTexels, std::mt19937& random, std::vector<Math::Float4>& texColors, std::vector<Math::Float3>& normals )
+    {
+        std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+        std::uniform_real_distribution<float> signedUnit( -1.0f, 1.0f );
+
+        texColors.resize( numTexels );
+        normals.resize( numTexels );
+        for ( size_t i = 0; i < numTexels; ++i )
+        {
+            texColors[i] = Math::Float4( unit( random ), unit( random ), unit( random ), 1.0f );
+            normals[i] = Math::Normalize( Math::Float3( signedUnit( random ), signedUnit( random ), signedUnit( random ) + 1e-3f ) );
+        }
+    }
+
+    // The eight animated lights of the demo at one point in time.
+    inline std::vector<Light> CreateDemoLights( std::mt19937& random )
+    {
+        std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+
+        std::vector<Light> lights( 8 );
+        for ( size_t i = 0; i < lights.size(); ++i )
+        {
+            float angle = Math::TwoPi * i / lights.size();
+            Light& light = lights[i];
+            light.Enabled = 1;
+            light.LightType = ( i == 3 || i == 7 ) ? PointLight : SpotLight;
+            light.Color = Math::Float4( unit( random ), unit( random ), unit( random ), 1.0f );
+            light.Position = Math::Float4( std::sin( angle ) * 8.0f, 9.0f, std::cos( angle ) * 8.0f, 1.0f );
+            light.Direction = Math::Float4( Math::Normalize( -Math::XYZ( light.Position ) ), 0.0f );
+            light.SpotAngle = Math::ConvertToRadians( 45.0f );
+            light.LinearAttenuation = 0.08f;
+            light.Range = AttenuationRange( light );
+        }
+        return lights;
+    }
+
+    // The largest errors of the values decoded from the G-buffer.
+    struct GBufferErrors
+    {
+        float Color;
+        float SpecularPower;    // Relative to the specular power of the material.
+        float NormalAngle;      // In radians.
+    };
+
+    // Compare the decoded samples with the materials and texels they were encoded from.
+    inline GBufferErrors MeasureGBufferErrors( const std::vector<_Material>& materials, const std::vector<Math::Float4>& texColors,
+        const std::vector<Math::Float3>& normals, const Math::Float4& globalAmbient, const std::vector<GBufferSample>& samples )
+    {
+        GBufferErrors errors = { 0.0f, 0.0f, 0.0f };
+        for ( size_t i = 0; i < samples.size(); ++i )
+        {
+            const _Material& material = materials[i % materials.size()];
+            const GBufferSample& sample = samples[i];
+            Math::Float3 color = Math::XYZ( texColors[i] );
+            Math::Float3 albedo = Math::XYZ( material.Diffuse ) * color;
+            Math::Float3 specular = Math::XYZ( material.Specular ) * color;
+            Math::Float3 ambient = ( Math::XYZ( material.Emissive ) + Math::XYZ( material.Ambient ) * Math::XYZ( globalAmbient ) ) * color;
+            for ( int c = 0; c < 3; ++c )
+            {
+                errors.Color = std::max( errors.Color, std::abs( ( &sample.Albedo.x )[c] - std::min( ( &albedo.x )[c], 1.0f ) ) );
+                errors.Color = std::max( errors.Color, std::abs( ( &sample.Specular.x )[c] - std::min( ( &specular.x )[c], 1.0f ) ) );
+                errors.Color = std::max( errors.Color, std::abs( ( &sample.Ambient.x )[c] - std::min( ( &ambient.x )[c], 1.0f ) ) );
+            }
+            errors.SpecularPower = std::max( errors.SpecularPower, std::abs( sample.SpecularPower / material.SpecularPower - 1.0f ) );
+            // acos is not accurate enough for small angles.
+            errors.NormalAngle = std::max( errors.NormalAngle,
+                std::atan2( Math::Length( Math::Cross( sample.Normal, normals[i] ) ), Math::Dot( sample.Normal, normals[i] ) ) );
+        }
+        return errors;
+    }
+
+    /**
+     * Shade random points in the room with the eight animated lights of the demo, forward
+     * and from the G-buffer, and return the largest difference of a color channel.
+     */
+    inline float MeasureShadingError( const std::vector<_Material>& materials, const std::vector<Math::Float4>& texColors,
+        const std::vector<Math::Float3>& normals, const Math::Float4& globalAmbient, size_t numShaded, std::mt19937& random )
+    {
+        std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+        std::vector<Light> lights = CreateDemoLights( random );
+        std::vector<uint32_t> allLights = { 0, 1, 2, 3, 4, 5, 6, 7 };
+        Math::Float3 eye( 0.0f, 5.0f, -9.5f );
+
+        float shadingError = 0.0f;
+        for ( size_t i = 0; i < numShaded; ++i )
+        {
+            // Materials whose albedo fits in the UNORM range, like the materials of the demo.
+            _Material material = materials[i % materials.size()];
+            material.Ambient = Math::Float4( 0.5f, 0.5f, 0.5f, 1.0f );
+            Math::Float3 position( 20.0f * unit( random ) - 10.0f, 10.0f * unit( random ), 20.0f * unit( random ) - 10.0f );
+            Math::Float3 forward = ShadeForward( material, texColors[i], position, normals[i], eye, globalAmbient, lights );
+            Math::Float3 deferred = ShadeGBuffer( DecodeGBuffer( EncodeGBuffer( material, texColors[i], normals[i], globalAmbient ) ), position, eye,
+                lights, allLights.data(), allLights.size() );
+            for ( int c = 0; c < 3; ++c )
+            {
+                shadingError = std::max( shadingError, std::abs( std::min( ( &forward.x )[c], 1.0f ) - std::min( ( &deferred.x )[c], 1.0f ) ) );
+            }
+        }
+        return shadingError;
+    }
+}
@@ -0,0 +1,161 @@
+#include <Test.h>
+
+#include <Camera.h>
+#include <JobSystem.h>
+#include <TiledDeferred.h>
+#include <TiledDeferredScene.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace Math;
+using namespace TiledDeferredScene;
+
+namespace
+{
+    // Test every light against every tile.
+    bool MatchesBruteForce( const TiledLightCulling& culling, const BoundingSphereArrays& lights )
+    {
+        const std::vector<LightCluster>& tiles = culling.get_Tiles();
+        const std::vector<uint32_t>& indices = culling.get_LightIndices();
+        std::vector<uint32_t> tileLights;
+        for ( uint32_t t = 0; t < culling.get_NumTiles(); ++t )
+        {
+            tileLights.clear();
+            for ( size_t l = 0; l < lights.Size(); ++l )
+            {
+                if ( culling.Intersects( lights.Get( l ), t ) )
+                {
+                    tileLights.push_back( static_cast<uint32_t>( l ) );
+                }
+            }
+            if ( tiles[t].Count != tileLights.size() || !std::equal( tileLights.begin(), tileLights.end(), indices.begin() + tiles[t].Offset ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Every light that contains the view-space position of a pixel must be in the tile
+     * of the pixel. The positions are reconstructed like the lighting pass does.
+     */
+    bool IsConservative( const TiledLightCulling& culling, const Camera& camera, const std::vector<float>& depthBuffer, const BoundingSphereArrays& lights )
+    {
+        TiledDeferredConstants constants = ComputeTiledDeferredConstants( camera, ScreenWidth, ScreenHeight, static_cast<uint32_t>( lights.Size() ) );
+        const std::vector<LightCluster>& tiles = culling.get_Tiles();
+        const std::vector<uint32_t>& indices = culling.get_LightIndices();
+
+        for ( uint32_t y = 1; y < ScreenHeight; y += 7 )
+        {
+            for ( uint32_t x = 3; x < ScreenWidth; x += 7 )
+            {
+                float depth = depthBuffer[y * ScreenWidth + x];
+                if ( depth >= 1.0f ) continue;
+
+                float z = constants.DepthScale / ( depth - constants.DepthBias );
+                float ndcX = ( x + 0.5f ) / constants.ScreenWidth * 2.0f - 1.0f;
+                float ndcY = 1.0f - ( y + 0.5f ) / constants.ScreenHeight * 2.0f;
+                Float3 point( ndcX * z / constants.ProjectionScaleX, ndcY * z / constants.ProjectionScaleY, z );
+
+                const LightCluster& tile = tiles[culling.GetTileIndex( x / TiledLightCulling::TileSize, y / TiledLightCulling::TileSize )];
+                const uint32_t* first = indices.data() + tile.Offset;
+                const uint32_t* last = first + tile.Count;
+                for ( size_t l = 0; l < lights.Size(); ++l )
+                {
+                    BoundingSphere sphere = lights.Get( l );
+                    if ( LengthSq( point - sphere.Center ) < sphere.Radius * sphere.Radius * 0.999f && !std::binary_search( first, last, static_cast<uint32_t>( l ) ) )
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+}
+
+// The decoded G-buffer is within GBufferErrorBounds, and the deferred lighting of the
+// eight animated lights of the demo matches the forward lighting.
+TEST( TiledDeferred, GBufferRoundTrip )
+{
+    const size_t numTexels = 100000;
+
+    std::mt19937 random( 1234 );
+    std::vector<_Material> materials = GenerateMaterials( 64, random );
+    std::vector<Float4> texColors;
+    std::vector<Float3> normals;
+    GenerateTexels( numTexels, random, texColors, normals );
+    Float4 globalAmbient( 0.2f, 0.2f, 0.2f, 1.0f );
+
+    std::vector<GBufferSample> samples( numTexels );
+    for ( size_t i = 0; i < numTexels; ++i )
+    {
+        samples[i] = DecodeGBuffer( EncodeGBuffer( materials[i % materials.size()], texColors[i], normals[i], globalAmbient ) );
+    }
+    GBufferErrors errors = MeasureGBufferErrors( materials, texColors, normals, globalAmbient, samples );
+    CHECK( errors.Color <= GBufferErrorBounds::Color );
+    CHECK( errors.SpecularPower <= GBufferErrorBounds::SpecularPowerRelative );
+    CHECK( errors.NormalAngle <= GBufferErrorBounds::NormalAngle );
+
+    // The encoded colors, the diffuse and the specular term each add half a step, and
+    // the specular power moves a highlight by less than another step.
+    CHECK( MeasureShadingError( materials, texColors, normals, globalAmbient, numTexels, random ) <= 4.0f / 255.0f );
+}
+
+// The tile lists match a brute-force test of every tile, on one and on several
+// threads, and contain every light that lights a pixel of the tile.
+TEST( TiledDeferred, CullingMatchesBruteForce )
+{
+    Camera camera = CreateCamera();
+    std::vector<float> depthBuffer;
+    RenderDepth( camera, depthBuffer );
+
+    TiledLightCulling culling( ScreenWidth, ScreenHeight );
+    culling.SetProjection( camera );
+    TiledLightCulling parallelCulling( ScreenWidth, ScreenHeight );
+    parallelCulling.SetProjection( camera );
+    JobSystem jobSystem( 4 );
+
+    CHECK( culling.get_NumTilesX() == ( ScreenWidth + TiledLightCulling::TileSize - 1 ) / TiledLightCulling::TileSize );
+    CHECK( culling.get_NumTilesY() == ( ScreenHeight + TiledLightCulling::TileSize - 1 ) / TiledLightCulling::TileSize );
+
+    BoundingSphereArrays bounds;
+    for ( size_t numLights = 16; numLights <= 1024; numLights *= 4 )
+    {
+        ViewSpaceBounds( GenerateLights( numLights ), camera, bounds );
+
+        culling.CullLights( depthBuffer.data(), ScreenWidth, bounds );
+        parallelCulling.CullLights( depthBuffer.data(), ScreenWidth, bounds, &jobSystem );
+
+        CHECK( culling.get_LightIndices() == parallelCulling.get_LightIndices() );
+        for ( uint32_t t = 0; t < culling.get_NumTiles(); ++t )
+        {
+            REQUIRE( culling.get_Tiles()[t].Offset == parallelCulling.get_Tiles()[t].Offset );
+            REQUIRE( culling.get_Tiles()[t].Count == parallelCulling.get_Tiles()[t].Count );
+        }
+        CHECK( MatchesBruteForce( culling, bounds ) );
+        CHECK( IsConservative( culling, camera, depthBuffer, bounds ) );
+        CHECK( culling.get_NumOverflowTiles() == 0 );
+    }
+}
+
+// The view depth of the lighting pass constants matches the projection.
+TEST( TiledDeferred, DepthReconstruction )
+{
+    Camera camera = CreateCamera();
+    TiledDeferredConstants constants = ComputeTiledDeferredConstants( camera, ScreenWidth, ScreenHeight, 3 );
+    TiledLightCulling culling( ScreenWidth, ScreenHeight );
+    culling.SetProjection( camera );
+
+    const Float4x4& projection = camera.get_ProjectionMatrix();
+    for ( float z = 0.1f; z < 100.0f; z *= 1.5f )
+    {
+        float depth = projection.m[2][2] + projection.m[3][2] / z;
+        CHECK( std::abs( constants.DepthScale / ( depth - constants.DepthBias ) - z ) < z * 1e-3f );
+        CHECK( std::abs( culling.ViewDepth( depth ) - z ) < z * 1e-3f );
+    }
+    CHECK( constants.ScreenWidth == ScreenWidth && constants.ScreenHeight == ScreenHeight && constants.NumLights == 3 );
+}
@@ -0,0 +1,126 @@
+/**
+ * @brief The venue of the LightClusters and ShadowMaps tests and benchmarks.
+ *
+ * A camera at the edge of a venue that is 200 x 30 x 200 units, the paths it moves
+ * along, and the lights that are scattered through the venue. AssignBruteForce is
+ * the reference the light clusters are compared with.
+ */
+#pragma once
+
+#include <Camera.h>
+#include <LightClusters.h>
+#include <ShadowMaps.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace VenueScene
+{
+    const float TanHalfFoV = 0.57735027f; // tan( 30 degrees )
+    const float AspectRatio = 16.0f / 9.0f;
+
+    // A camera at the edge of a venue that is 200 x 30 x 200 units.
+    inline Camera CreateCamera()
+    {
+        Camera camera;
+        camera.set_Projection( 60.0f, AspectRatio, 0.1f, 250.0f );
+        camera.set_LookAt( Math::Float3( 0.0f, 10.0f, -100.0f ), Math::Float3( 0.0f, 5.0f, 0.0f ), Math::Float3( 0.0f, 1.0f, 0.0f ) );
+        return camera;
+    }
+
+    // Walk through the venue along the z axis.
+    inline void WalkThroughVenue( Camera& camera, float z )
+    {
+        camera.set_LookAt( Math::Float3( 0.0f, 10.0f, z ), Math::Float3( 0.0f, 5.0f, z + 50.0f ), Math::Float3( 0.0f, 1.0f, 0.0f ) );
+    }
+
+    // Move along a line and turn, for t from 0 to 1.
+    inline void MoveAndTurn( Camera& camera, float t )
+    {
+        Math::Float3 eye( -20.0f + 40.0f * t, 10.0f, -100.0f + 7.3f * t );
+        Math::Float3 target = eye + Math::Float3( std::sin( 6.0f * t ), -0.2f, std::cos( 6.0f * t ) );
+        camera.set_LookAt( eye, target, Math::Float3( 0.0f, 1.0f, 0.0f ) );
+    }
+
+    // Point and spot lights with a range of 2 to 12 units, and a directional light.
+    inline std::vector<Light> GenerateLights( size_t numLights )
+    {
+        std::mt19937 random( 1234 );
+        std::uniform_real_distribution<float> positionXZ( -100.0f, 100.0f );
+        std::uniform_real_distribution<float> positionY( 0.0f, 30.0f );
+        std::uniform_real_distribution<float> direction( -1.0f, 1.0f );
+        std::uniform_real_distribution<float> quadratic( 0.0f, 1.0f );
+
+        std::vector<Light> lights( numLights );
+        for ( size_t i = 0; i < numLights; ++i )
+        {
+            Light& light = lights[i];
+            light.Enabled = 1;
+            light.LightType = ( i == 0 ) ? DirectionalLight : ( i % 3 == 0 ) ? SpotLight : PointLight;
+            light.Position = Math::Float4( positionXZ( random ), positionY( random ), positionXZ( random ), 1.0f );
+            light.Direction = Math::Float4( Math::Normalize( Math::Float3( direction( random ), -1.0f, direction( random ) ) ), 0.0f );
+            light.SpotAngle = Math::ConvertToRadians( 20.0f + 40.0f * quadratic( random ) );
+            light.QuadraticAttenuation = 1.5f + 60.0f * quadratic( random );
+            light.Range = AttenuationRange( light );
+        }
+        return lights;
+    }
+
+    // Spot lights with a range of 2 to 12 units that point down.
+    inline std::vector<Light> GenerateSpotLights( size_t numLights, uint32_t seed )
+    {
+        std::mt19937 random( seed );
+        std::uniform_real_distribution<float> positionXZ( -100.0f, 100.0f );
+        std::uniform_real_distribution<float> positionY( 0.0f, 30.0f );
+        std::uniform_real_distribution<float> direction( -1.0f, 1.0f );
+        std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+
+        std::vector<Light> lights( numLights );
+        for ( size_t i = 0; i < numLights; ++i )
+        {
+            Light& light = lights[i];
+            light.Enabled = 1;
+            light.LightType = SpotLight;
+            light.Position = Math::Float4( positionXZ( random ), positionY( random ), positionXZ( random ), 1.0f );
+            light.Direction = Math::Float4( Math::Normalize( Math::Float3( direction( random ), -1.0f, direction( random ) ) ), 0.0f );
+            light.SpotAngle = Math::ConvertToRadians( 20.0f + 40.0f * unit( random ) );
+            light.QuadraticAttenuation = 1.5f + 60.0f * unit( random );
+            light.Range = AttenuationRange( light );
+        }
+        return lights;
+    }
+
+    inline void ViewSpaceBounds( const std::vector<Light>& lights, const Math::Float4x4& viewMatrix, BoundingSphereArrays& bounds )
+    {
+        bounds.Clear();
+        bounds.Reserve( lights.size() );
+        for ( const Light& light : lights )
+        {
+            bounds.Add( Transform( LightBounds( light ), viewMatrix ) );
+        }
+    }
+
+    // Test every light against every cluster.
+    inline void AssignBruteForce( const LightClusters& clusters, const BoundingSphereArrays& lights, std::vector< std::vector<uint32_t> >& clusterLights )
+    {
+        clusterLights.assign( clusters.get_NumClusters(), std::vector<uint32_t>() );
+        for ( uint32_t c = 0; c < clusters.get_NumClusters(); ++c )
+        {
+            for ( size_t l = 0; l < lights.Size(); ++l )
+            {
+                if ( clusters.Intersects( lights.Get( l ), c ) )
+                {
+                    clusterLights[c].push_back( static_cast<uint32_t>( l ) );
+                }
+            }
+        }
+    }
+
+    // The texel of a world-space point in a cascade.
+    inline Math::Float3 ShadowTexel( const ShadowView& view, const Math::Float3& position, uint32_t resolution )
+    {
+        Math::Float3 clip = Math::TransformPoint( position, view.ViewProjectionMatrix );
+        return Math::Float3( ( clip.x * 0.5f + 0.5f ) * resolution, ( 0.5f - clip.y * 0.5f ) * resolution, clip.z );
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ * @brief The decoding errors of the VertexFormat tests and benchmarks.
+ *
+ * MeasureErrors compares decoded vertices with the vertices they were encoded from,
+ * and ComputeRandomVertices makes vertices that are harder to encode than those of
+ * the meshes of Geometry.h.
+ */
+#pragma once
+
+#include <Geometry.h>
+#include <VertexFormats.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace VertexFormatErrors
+{
+    // Half floats lose relative precision below the smallest normal half.
+    const float SmallestNormalHalf = 1.0f / 16384.0f;
+
+    struct VertexErrors
+    {
+        float Position;
+        float NormalAngle;
+        float TextureCoordinate;
+    };
+
+    /**
+     * The largest errors of the decoded vertices. The position error is relative to
+     * the position itself for the half format and relative to the size of the
+     * bounding box for the quantized format.
+     */
+    inline VertexErrors MeasureErrors( const VertexCollection& vertices, const VertexCollection& decodedVertices, const BoundingBox* box )
+    {
+        VertexErrors errors = { 0.0f, 0.0f, 0.0f };
+        for ( size_t i = 0; i < vertices.size(); ++i )
+        {
+            const VertexPositionNormalTexture& vertex = vertices[i];
+            const VertexPositionNormalTexture& decoded = decodedVertices[i];
+
+            for ( int c = 0; c < 3; ++c )
+            {
+                float expected = ( &vertex.position.x )[c];
+                float error = std::abs( ( &decoded.position.x )[c] - expected );
+                float scale = box ? ( &box->Extents.x )[c] * 2.0f : std::max( std::abs( expected ), SmallestNormalHalf );
+                errors.Position = std::max( errors.Position, scale > 0.0f ? error / scale : error );
+            }
+
+            // acos is not accurate enough for small angles.
+            Math::Float3 normal = Math::Normalize( vertex.normal );
+            float angle = std::atan2( Math::Length( Math::Cross( normal, decoded.normal ) ), Math::Dot( normal, decoded.normal ) );
+            errors.NormalAngle = std::max( errors.NormalAngle, angle );
+
+            errors.TextureCoordinate = std::max( { errors.TextureCoordinate,
+                std::abs( decoded.textureCoordinate.x - vertex.textureCoordinate.x ),
+                std::abs( decoded.textureCoordinate.y - vertex.textureCoordinate.y ) } );
+        }
+        return errors;
+    }
+
+    // Random unit normals (including the poles and the fold of the octahedron) and
+    // random positions over several orders of magnitude.
+    inline VertexCollection ComputeRandomVertices( size_t numVertices )
+    {
+        std::mt19937 random( 1234 );
+        std::normal_distribution<float> normal;
+        std::uniform_real_distribution<float> uniform( 0.0f, 1.0f );
+        std::uniform_real_distribution<float> exponent( -12.0f, 12.0f );
+
+        const Math::Float3 axes[] = {
+            Math::Float3( 1, 0, 0 ), Math::Float3( -1, 0, 0 ), Math::Float3( 0, 1, 0 ),
+            Math::Float3( 0, -1, 0 ), Math::Float3( 0, 0, 1 ), Math::Float3( 0, 0, -1 ),
+        };
+
+        VertexCollection vertices( numVertices );
+        for ( size_t i = 0; i < numVertices; ++i )
+        {
+            VertexPositionNormalTexture& vertex = vertices[i];
+            for ( int c = 0; c < 3; ++c )
+            {
+                float sign = uniform( random ) < 0.5f ? -1.0f : 1.0f;
+                ( &vertex.position.x )[c] = sign * uniform( random ) * std::exp2( exponent( random ) );
+            }
+
+            if ( i < 6 )
+            {
+                vertex.normal = axes[i];
+            }
+            else
+            {
+                vertex.normal = Math::Normalize( Math::Float3( normal( random ), normal( random ), i % 4 == 0 ? 0.0f : normal( random ) ) );
+            }
+
+            vertex.textureCoordinate = Math::Float2( uniform( random ), uniform( random ) );
+        }
+        return vertices;
+    }
+}
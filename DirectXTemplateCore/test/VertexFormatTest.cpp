@@ -0,0 +1,84 @@
+#include <Test.h>
+
+#include <Geometry.h>
+#include <VertexFormats.h>
+#include <VertexFormatErrors.h>
+
+#include <cmath>
+
+using namespace Math;
+using namespace VertexFormatErrors;
+
+namespace
+{
+    void CheckErrorBounds( const VertexCollection& vertices )
+    {
+        BoundingBox box = ComputeBoundingBox( vertices );
+        VertexCollection decodedVertices;
+
+        HalfVertexCollection halfVertices;
+        EncodeVertices( vertices, halfVertices );
+        DecodeVertices( halfVertices, decodedVertices );
+        REQUIRE( decodedVertices.size() == vertices.size() );
+
+        VertexErrors errors = MeasureErrors( vertices, decodedVertices, nullptr );
+        CHECK( errors.Position <= VertexErrorBounds::HalfPositionRelative );
+        CHECK( errors.NormalAngle <= VertexErrorBounds::NormalAngle );
+        CHECK( errors.TextureCoordinate <= VertexErrorBounds::TextureCoordinate );
+
+        QuantizedVertexCollection quantizedVertices;
+        EncodeVertices( vertices, box, quantizedVertices );
+        DecodeVertices( quantizedVertices, box, decodedVertices );
+        REQUIRE( decodedVertices.size() == vertices.size() );
+
+        errors = MeasureErrors( vertices, decodedVertices, &box );
+        CHECK( errors.Position <= VertexErrorBounds::QuantizedPositionRelative );
+        CHECK( errors.NormalAngle <= VertexErrorBounds::NormalAngle );
+        CHECK( errors.TextureCoordinate <= VertexErrorBounds::TextureCoordinate );
+    }
+}
+
+TEST( VertexFormat, HalfFloatConversion )
+{
+    CHECK( FloatToHalf( 0.0f ) == 0x0000 );
+    CHECK( FloatToHalf( -0.0f ) == 0x8000 );
+    CHECK( FloatToHalf( 1.0f ) == 0x3C00 );
+    CHECK( FloatToHalf( -2.0f ) == 0xC000 );
+    CHECK( FloatToHalf( 65504.0f ) == 0x7BFF );
+    CHECK( FloatToHalf( 1e6f ) == 0x7C00 );
+    // Round to nearest even: 1 + 2^-11 is halfway between 1 and the next half.
+    CHECK( FloatToHalf( 1.0f + 1.0f / 2048.0f ) == 0x3C00 );
+
+    // Every finite half converts to a float and back without changes.
+    for ( uint32_t half = 0; half < 0x10000; ++half )
+    {
+        if ( ( half & 0x7C00 ) == 0x7C00 ) continue;
+        REQUIRE( FloatToHalf( HalfToFloat( static_cast<uint16_t>( half ) ) ) == half );
+    }
+}
+
+TEST( VertexFormat, DecodingErrorsAreWithinBounds )
+{
+    VertexCollection vertices;
+    IndexCollection indices;
+
+    ComputeSphere( vertices, indices, 1.0f, 64, false );
+    CheckErrorBounds( vertices );
+
+    ComputeTorus( vertices, indices, 1.0f, 0.333f, 64, false );
+    CheckErrorBounds( vertices );
+
+    // An odd number of vertices so that the last SIMD batch is partially filled.
+    CheckErrorBounds( ComputeRandomVertices( 4099 ) );
+}
+
+TEST( VertexFormat, PositionDequantizationMatrix )
+{
+    BoundingBox box( Float3( 1.0f, -2.0f, 3.0f ), Float3( 2.0f, 0.5f, 4.0f ) );
+    Float4x4 matrix = PositionDequantizationMatrix( box );
+
+    Float3 minCorner = TransformPoint( Float3( 0.0f, 0.0f, 0.0f ), matrix );
+    Float3 maxCorner = TransformPoint( Float3( 1.0f, 1.0f, 1.0f ), matrix );
+    CHECK( Length( minCorner - ( box.Center - box.Extents ) ) < 1e-5f );
+    CHECK( Length( maxCorner - ( box.Center + box.Extents ) ) < 1e-5f );
+}
@@ -3,6 +3,8 @@
  */
 #pragma once
 
+#include <functional>
+
 class Window;
 
 class Application
@@ -36,6 +38,18 @@ public:
      */
     Window& CreateRenderWindow( const std::string& windowName, int clientWidth, int clientHeight, bool vSync = false, bool windowed = true );
 
+    /**
+     * Create a headless render window. A headless window does not create an OS window.
+     * Games that are registered with a headless window render into an offscreen
+     * render target of a fixed size and do not present to the screen.
+     * @param windowName The name of the window. This name should be unique.
+     * @param clientWidth The width (in pixels) of the offscreen render target.
+     * @param clientHeight The height (in pixels) of the offscreen render target.
+     * @returns The created window instance. If a window with the given name already exists, that window will be 
+     * returned.
+     */
+    Window& CreateHeadlessWindow( const std::string& windowName, int clientWidth, int clientHeight );
+
     /**
      * Destroy a window given the window name.
      */
@@ -55,6 +69,31 @@ public:
      * @return The error code if an error occurred.
      */
     int Run();
+
+    // Invoked by RunHeadless after each frame has been rendered.
+    // The arguments are the index of the frame and the CPU time (in seconds) 
+    // that was spent updating and rendering the frame.
+    typedef std::function<void( unsigned int frameIndex, double frameTime )> FrameCallback;
+
+    /**
+     * Update and render all headless windows for a fixed number of frames.
+     * The message pump is not processed and the frames are updated with a 
+     * fixed time step so that the results are reproducible.
+     * @param numFrames The number of frames to update and render.
+     * @param deltaTime The (fixed) time step of each frame in seconds.
+     * @param frameCallback (optional) Invoked after each frame.
+     * @return The error code if an error occurred.
+     */
+    int RunHeadless( unsigned int numFrames, float deltaTime, FrameCallback frameCallback = nullptr );
+
+    /**
+     * Update the games a fixed number of times per second in Run (0 to update once
+     * per frame, the default). Each frame runs as many updates as fit in the elapsed
+     * time and the RenderEventArgs::Alpha is the fraction of the next update that has
+     * elapsed. Time is measured in 64-bit ticks so the rate does not drift.
+     */
+    void set_FixedUpdateRate( unsigned int updatesPerSecond );
+    unsigned int get_FixedUpdateRate() const;
     
     /**
      * Request to quit the application and close all windows.
@@ -72,6 +111,8 @@ protected:
 private:
     // The application instance handle that this application was created with.
     HINSTANCE m_hInstance;
+    // The number of updates per second in Run (0 to update once per frame).
+    unsigned int m_FixedUpdateRate;
 
     // Return this invalid window when either an error occurs when creating a window
     // or the user asks for window by name but no window with that name exists.
@@ -0,0 +1,62 @@
+/**
+ * @brief A CommandRecorder that records into a Direct3D 11 deferred context.
+ *
+ * Deferred contexts start every command list with the default pipeline state.
+ * CopyInitialState copies the render targets, the viewports, the rasterizer and
+ * depth/stencil states and the pixel shader samplers of the immediate context;
+ * BeginCommandList binds them at the start of every command list. All other state
+ * is set by the recorded commands.
+ *
+ * Slices of a DynamicConstantBuffer must be committed on the immediate context
+ * before the commands that bind them are recorded (see D3D11RenderContext).
+ */
+#pragma once
+
+#include <D3D11RenderContext.h>
+#include <ParallelCommandRecorder.h>
+
+#include <memory>
+
+class DynamicConstantBuffer;
+
+class D3D11CommandRecorder : public CommandRecorder
+{
+public:
+    /**
+     * Create a deferred context on the device.
+     * @param immediateContext The context that executes the command lists.
+     * @param dynamicConstantBuffer The dynamic constant buffer that is used for
+     * the constant buffer bindings (optional).
+     */
+    D3D11CommandRecorder( ID3D11Device* device, ID3D11DeviceContext* immediateContext, DynamicConstantBuffer* dynamicConstantBuffer = nullptr );
+    virtual ~D3D11CommandRecorder();
+
+    // Copy the state of a device context that is bound at the start of every command list.
+    void CopyInitialState( ID3D11DeviceContext* deviceContext );
+
+    // The deferred context, for commands that are not part of the RenderContext interface.
+    ID3D11DeviceContext* get_DeviceContext() const;
+
+    virtual void BeginCommandList();
+    virtual RenderContext& get_RenderContext();
+    virtual void FinishCommandList();
+    virtual void ExecuteCommandList();
+
+private:
+    D3D11CommandRecorder( const D3D11CommandRecorder& copy );
+
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_d3dImmediateContext;
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_d3dDeferredContext;
+    Microsoft::WRL::ComPtr<ID3D11CommandList> m_d3dCommandList;
+    std::unique_ptr<D3D11RenderContext> m_RenderContext;
+
+    // The state that is bound at the start of every command list.
+    Microsoft::WRL::ComPtr<ID3D11RenderTargetView> m_d3dRenderTargetViews[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT];
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilView> m_d3dDepthStencilView;
+    Microsoft::WRL::ComPtr<ID3D11RasterizerState> m_d3dRasterizerState;
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilState> m_d3dDepthStencilState;
+    UINT m_StencilRef;
+    D3D11_VIEWPORT m_Viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    UINT m_NumViewports;
+    Microsoft::WRL::ComPtr<ID3D11SamplerState> m_d3dSamplerStates[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT];
+};
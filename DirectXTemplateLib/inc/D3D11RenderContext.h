@@ -0,0 +1,62 @@
+/**
+ * @brief Forwards the RenderContext calls to an ID3D11DeviceContext.
+ *
+ * The StateHandles passed to the context must be pointers to the matching
+ * Direct3D 11 interface (ID3D11InputLayout, ID3D11VertexShader, ID3D11Buffer,
+ * ID3D11ShaderResourceView, ...). The primitive topology is a
+ * D3D11_PRIMITIVE_TOPOLOGY and the index format is a DXGI_FORMAT.
+ *
+ * Constant buffer bindings that were created with DynamicConstantBuffer::GetBinding
+ * are bound through the DynamicConstantBuffer. Other bindings with a non-zero size
+ * are bound with constant buffer offsets (requires the Direct3D 11.1 runtime).
+ * On a deferred context the slices of the DynamicConstantBuffer are bound without
+ * going through the DynamicConstantBuffer, so they must be committed before the
+ * commands are recorded.
+ *
+ * Wrap the D3D11RenderContext in a StateCache to filter out redundant state changes.
+ */
+#pragma once
+
+#include <RenderContext.h>
+
+class DynamicConstantBuffer;
+
+class D3D11RenderContext : public RenderContext
+{
+public:
+    /**
+     * @param dynamicConstantBuffer The dynamic constant buffer that is used for
+     * the constant buffer bindings (optional).
+     */
+    D3D11RenderContext( ID3D11DeviceContext* deviceContext, DynamicConstantBuffer* dynamicConstantBuffer = nullptr );
+    virtual ~D3D11RenderContext();
+
+    virtual void SetInputLayout( StateHandle inputLayout );
+    virtual void SetPrimitiveTopology( uint32_t primitiveTopology );
+    virtual void SetVertexBuffer( uint32_t slot, const VertexBufferBinding& vertexBuffer );
+    virtual void SetIndexBuffer( StateHandle indexBuffer, uint32_t indexFormat );
+
+    virtual void SetVertexShader( StateHandle vertexShader );
+    virtual void SetVSConstantBuffer( uint32_t slot, const ConstantBufferBinding& constantBuffer );
+
+    virtual void SetRasterizerState( StateHandle rasterizerState );
+
+    virtual void SetPixelShader( StateHandle pixelShader );
+    virtual void SetPSConstantBuffer( uint32_t slot, const ConstantBufferBinding& constantBuffer );
+    virtual void SetPSShaderResource( uint32_t slot, StateHandle shaderResourceView );
+
+    virtual void SetDepthStencilState( StateHandle depthStencilState );
+    virtual void SetBlendState( StateHandle blendState );
+
+    virtual void DrawIndexed( uint32_t indexCount, uint32_t startIndex, int32_t baseVertex );
+    virtual void DrawIndexedInstanced( uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance );
+
+private:
+    D3D11RenderContext( const D3D11RenderContext& copy );
+
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_d3dDeviceContext;
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext1> m_d3dDeviceContext1;
+    DynamicConstantBuffer* m_DynamicConstantBuffer;
+    // True if the device context is a deferred context.
+    bool m_Deferred;
+};
@@ -0,0 +1,44 @@
+/**
+ * @brief The GpuTimestampQueries of a GpuProfiler for Direct3D 11.
+ *
+ * Each slot has a D3D11_QUERY_TIMESTAMP_DISJOINT query and maxTimestamps
+ * D3D11_QUERY_TIMESTAMP queries. The results are read with
+ * D3D11_ASYNC_GETDATA_DONOTFLUSH so reading them never waits for the GPU or flushes
+ * the command buffer.
+ */
+#pragma once
+
+#include <GpuProfiler.h>
+
+#include <vector>
+
+class D3D11TimestampQueries : public GpuTimestampQueries
+{
+public:
+    /**
+     * Create the queries on the device.
+     * @param numSlots The number of frames that can be in flight. Present lets up to
+     * three frames queue, so use at least four to profile every frame.
+     */
+    D3D11TimestampQueries( ID3D11Device* device, ID3D11DeviceContext* deviceContext, uint32_t numSlots = 5, uint32_t maxTimestamps = 128 );
+    virtual ~D3D11TimestampQueries();
+
+    virtual uint32_t get_NumSlots() const;
+    virtual uint32_t get_MaxTimestamps() const;
+
+    virtual void BeginFrame( uint32_t slot );
+    virtual void EndFrame( uint32_t slot );
+    virtual void WriteTimestamp( uint32_t slot, uint32_t index );
+
+    virtual bool GetFrequency( uint32_t slot, uint64_t& frequency, bool& disjoint );
+    virtual bool GetTimestamp( uint32_t slot, uint32_t index, uint64_t& timestamp );
+
+private:
+    D3D11TimestampQueries( const D3D11TimestampQueries& copy );
+
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_d3dDeviceContext;
+    std::vector< Microsoft::WRL::ComPtr<ID3D11Query> > m_d3dDisjointQueries;
+    // The timestamp queries of slot s start at s * m_MaxTimestamps.
+    std::vector< Microsoft::WRL::ComPtr<ID3D11Query> > m_d3dTimestampQueries;
+    uint32_t m_MaxTimestamps;
+};
@@ -0,0 +1,26 @@
+/**
+ * @brief Compiles the shader variants of a ShaderCache with D3DCompile.
+ *
+ * The source code is compiled from memory, so the shaders cannot use #include.
+ * The identifier contains the version of the compiler and the compile flags, so
+ * the cache files of another version or of a debug build are not loaded.
+ */
+#pragma once
+
+#include <ShaderPermutations.h>
+
+class D3DShaderCompiler : public ShaderCompiler
+{
+public:
+    // @param flags The D3DCOMPILE flags.
+    explicit D3DShaderCompiler( UINT flags = D3DCOMPILE_ENABLE_STRICTNESS|D3DCOMPILE_OPTIMIZATION_LEVEL3 );
+    virtual ~D3DShaderCompiler();
+
+    virtual bool Compile( const ShaderSource& source, const std::vector<ShaderDefine>& defines,
+        std::vector<uint8_t>& bytecode, std::string& errors );
+
+    virtual std::string get_Identifier() const;
+
+private:
+    UINT m_Flags;
+};
@@ -5,6 +5,7 @@
 
 // DirectX includes
 #include <d3d11_1.h>
+#include <dxgi1_3.h>
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
 #include <DirectXColors.h>
@@ -28,4 +29,3 @@ typedef const DirectX::XMMATRIX& FXMMATRIX;
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "dxgi.lib")
 #pragma comment(lib, "d3dcompiler.lib")
-#pragma comment(lib, "winmm.lib")
@@ -0,0 +1,171 @@
+/**
+ * @brief A large dynamic constant buffer that is sub-allocated every frame.
+ *
+ * Instead of updating a small constant buffer with UpdateSubresource for every
+ * draw call, the constants for all draws are written to 256-byte aligned slices
+ * of a single D3D11_USAGE_DYNAMIC buffer. The slices are uploaded with a single
+ * Map(D3D11_MAP_WRITE_NO_OVERWRITE) and bound with VSSetConstantBuffers1 and
+ * PSSetConstantBuffers1 using the offset of the slice.
+ *
+ * If the device does not support constant buffer offsets (Direct3D 11.0 runtime),
+ * each slice is copied into a small per-slot buffer with Map(D3D11_MAP_WRITE_DISCARD)
+ * when it is bound. A slice that is already in the buffer of the slot is not copied
+ * again, so each slot is mapped at most once per draw and only when its constants
+ * change. The fallback cannot avoid that map, so it does not get the single upload
+ * per frame of the Direct3D 11.1 path.
+ *
+ * The offset bookkeeping is done by the RingAllocator in the core library.
+ * Event queries are used to determine when the GPU is done with a frame.
+ */
+#pragma once
+
+#include <RenderContext.h>
+#include <RingAllocator.h>
+
+class DynamicConstantBuffer
+{
+public:
+    // A slice of the constant buffer.
+    struct Allocation
+    {
+        // Write the constants to this address.
+        void* Data;
+        // The offset of the slice in bytes.
+        UINT Offset;
+        // The offset and size of the slice in shader constants (16 bytes).
+        UINT FirstConstant;
+        UINT NumConstants;
+    };
+
+    struct Statistics
+    {
+        UINT Allocations;
+        UINT BytesAllocated;
+        // The number of times the buffer was mapped.
+        UINT Maps;
+        // The number of times the CPU had to wait for the GPU because the buffer was full.
+        UINT Stalls;
+    };
+
+    /**
+     * @param size The size of the buffer in bytes.
+     */
+    DynamicConstantBuffer( ID3D11Device* device, UINT size = 16 * 1024 * 1024 );
+    virtual ~DynamicConstantBuffer();
+
+    // Returns true if the slices are bound using constant buffer offsets.
+    bool get_SupportsOffsets() const;
+
+    /**
+     * Call at the beginning of the frame before allocating any slices.
+     * Releases the slices of the frames that the GPU has finished.
+     */
+    void BeginFrame( ID3D11DeviceContext* deviceContext );
+
+    /**
+     * Allocate a slice of the buffer.
+     * @param size The size of the constants in bytes.
+     */
+    Allocation Allocate( ID3D11DeviceContext* deviceContext, size_t size );
+
+    // Allocate a slice and copy the constants into it.
+    template<typename T>
+    Allocation Allocate( ID3D11DeviceContext* deviceContext, const T& constants )
+    {
+        Allocation allocation = Allocate( deviceContext, sizeof(T) );
+        memcpy( allocation.Data, &constants, sizeof(T) );
+        return allocation;
+    }
+
+    /**
+     * Upload all of the slices that were allocated since the last commit.
+     * Slices that have not been committed yet are committed automatically
+     * when they are bound. To upload the constants with a single Map, allocate
+     * the slices for all draw calls before binding any of them.
+     */
+    void Commit( ID3D11DeviceContext* deviceContext );
+
+    void VSSetConstantBuffer( ID3D11DeviceContext* deviceContext, UINT slot, const Allocation& allocation );
+    void PSSetConstantBuffer( ID3D11DeviceContext* deviceContext, UINT slot, const Allocation& allocation );
+
+    /**
+     * Get a binding for the slice that can be used with a RenderContext.
+     * The buffer handle of the binding is the DynamicConstantBuffer
+     * (see D3D11RenderContext).
+     */
+    ConstantBufferBinding GetBinding( const Allocation& allocation ) const;
+    // Get the slice that is referenced by a binding that was returned by GetBinding.
+    Allocation GetAllocation( const ConstantBufferBinding& binding );
+
+    /**
+     * Get the binding of the slice in the underlying ID3D11Buffer. Unlike
+     * VSSetConstantBuffer and PSSetConstantBuffer this does not modify the
+     * DynamicConstantBuffer so it can be used from several threads to bind slices
+     * on deferred contexts. Commit the slices before they are recorded.
+     * Requires constant buffer offsets (see get_SupportsOffsets).
+     */
+    ConstantBufferBinding GetBufferBinding( const ConstantBufferBinding& binding ) const;
+
+    /**
+     * Call at the end of the frame after the last draw call that uses the buffer.
+     */
+    void EndFrame( ID3D11DeviceContext* deviceContext );
+
+    // Statistics for the current frame.
+    const Statistics& get_Statistics() const;
+
+private:
+    DynamicConstantBuffer( const DynamicConstantBuffer& copy );
+
+    enum ShaderStage
+    {
+        VertexShaderStage,
+        PixelShaderStage,
+        NumShaderStages
+    };
+
+    void SetConstantBuffer( ID3D11DeviceContext* deviceContext, ShaderStage stage, UINT slot, const Allocation& allocation );
+    void BindFallbackBuffer( ID3D11DeviceContext* deviceContext, ShaderStage stage, UINT slot );
+    // Forget the slices that were copied to the per-slot buffers.
+    void ResetFallbackOffsets();
+    // Wait for the oldest frame in flight to finish on the GPU.
+    void WaitForOldestFrame( ID3D11DeviceContext* deviceContext );
+    void ReleaseCompletedFrames( ID3D11DeviceContext* deviceContext, bool wait );
+
+    Microsoft::WRL::ComPtr<ID3D11Device> m_d3dDevice;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> m_d3dBuffer;
+    bool m_SupportsOffsets;
+
+    // The ID3D11DeviceContext1 interface of the last device context that was used to bind a slice.
+    ID3D11DeviceContext* m_d3dDeviceContext;
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext1> m_d3dDeviceContext1;
+
+    RingAllocator m_Allocator;
+    // A CPU copy of the buffer. Slices are written here and copied to the buffer on commit.
+    std::vector<uint8_t> m_ShadowBuffer;
+
+    // The slices that have not been committed: m_PendingSize bytes starting at m_PendingOffset.
+    size_t m_PendingOffset;
+    size_t m_PendingSize;
+    // True if the buffer must be mapped with D3D11_MAP_WRITE_DISCARD.
+    bool m_Discard;
+
+    // An event query for each frame in flight.
+    struct FrameFence
+    {
+        uint64_t FenceValue;
+        Microsoft::WRL::ComPtr<ID3D11Query> Query;
+    };
+    std::deque<FrameFence> m_FramesInFlight;
+    std::vector< Microsoft::WRL::ComPtr<ID3D11Query> > m_FreeQueries;
+    uint64_t m_FenceValue;
+
+    // Per-slot buffers used when constant buffer offsets are not supported.
+    Microsoft::WRL::ComPtr<ID3D11Buffer> m_FallbackBuffers[NumShaderStages][D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+    UINT m_FallbackBufferSizes[NumShaderStages][D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+    // The offset of the slice that was last copied to each per-slot buffer.
+    static const UINT InvalidFallbackOffset = UINT_MAX;
+    UINT m_FallbackOffsets[NumShaderStages][D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+
+    Statistics m_Statistics;
+};
@@ -0,0 +1,50 @@
+/**
+ * @brief A dynamic structured buffer that is rewritten every frame.
+ *
+ * The buffer is a D3D11_USAGE_DYNAMIC buffer with D3D11_RESOURCE_MISC_BUFFER_STRUCTURED
+ * and a shader resource view, so the shaders can read it as a StructuredBuffer<T>.
+ * Update maps the buffer with D3D11_MAP_WRITE_DISCARD, so the driver renames it
+ * instead of waiting for the GPU to finish the previous frame. If the elements do
+ * not fit, the buffer and the view are created again with twice the capacity.
+ */
+#pragma once
+
+#include <vector>
+
+class DynamicStructuredBuffer
+{
+public:
+    /**
+     * @param elementSize The size of an element in bytes (a multiple of 4).
+     * @param capacity The initial number of elements.
+     */
+    DynamicStructuredBuffer( ID3D11Device* device, UINT elementSize, UINT capacity = 256 );
+    virtual ~DynamicStructuredBuffer();
+
+    UINT get_ElementSize() const;
+    UINT get_Capacity() const;
+
+    // Replace the contents of the buffer with numElements elements.
+    void Update( ID3D11DeviceContext* deviceContext, const void* elements, size_t numElements );
+
+    template<typename T>
+    void Update( ID3D11DeviceContext* deviceContext, const std::vector<T>& elements )
+    {
+        assert( sizeof(T) == m_ElementSize );
+        Update( deviceContext, elements.data(), elements.size() );
+    }
+
+    // The view of the buffer. The view changes when the buffer grows.
+    ID3D11ShaderResourceView* get_ShaderResourceView() const;
+
+private:
+    DynamicStructuredBuffer( const DynamicStructuredBuffer& copy );
+
+    void CreateBuffer( UINT capacity );
+
+    Microsoft::WRL::ComPtr<ID3D11Device> m_d3dDevice;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> m_d3dBuffer;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_d3dShaderResourceView;
+    UINT m_ElementSize;
+    UINT m_Capacity;
+};
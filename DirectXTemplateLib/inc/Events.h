@@ -152,26 +152,36 @@ class UpdateEventArgs : public EventArgs
 {
 public:
     typedef EventArgs base;
-    UpdateEventArgs( float fDeltaTime, float fTotalTime )
+    UpdateEventArgs( float fDeltaTime, double fTotalTime )
         : ElapsedTime( fDeltaTime )
         , TotalTime( fTotalTime )
     {}
 
+    // The time step of the update in seconds.
     float ElapsedTime;
-    float TotalTime;
+    // The simulated time in seconds (converted from 64-bit ticks, see Clock).
+    double TotalTime;
 };
 
 class RenderEventArgs : public EventArgs
 {
 public:
     typedef EventArgs base;
-    RenderEventArgs( float fDeltaTime, float fTotalTime )
+    RenderEventArgs( float fDeltaTime, double fTotalTime, float fAlpha = 1.0f )
         : ElapsedTime( fDeltaTime )
         , TotalTime( fTotalTime )
+        , Alpha( fAlpha )
     {}
 
+    // The time since the previous frame in seconds.
     float ElapsedTime;
-    float TotalTime;
+    // With a fixed update rate, the time between the previous and the current update
+    // that matches Alpha (see FixedTimestep::get_InterpolatedSeconds).
+    double TotalTime;
+    // With a fixed update rate, the fraction of the next update that has elapsed.
+    // Interpolate between the previous and the current state with this value.
+    // Always 1 if the game is updated once per frame.
+    float Alpha;
 };
 
 class UserEventArgs : public EventArgs
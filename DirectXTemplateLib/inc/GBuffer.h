@@ -0,0 +1,79 @@
+/**
+ * @brief The render targets of the tiled deferred path (see TiledDeferred.h).
+ *
+ * The G-buffer pass renders to the four color targets and the depth buffer. The
+ * lighting pass reads them as shader resources and writes the lit image to the
+ * output texture through an unordered access view. The depth buffer is created
+ * with a typeless format so that it can be both a D32_FLOAT depth-stencil view and
+ * an R32_FLOAT shader resource view.
+ */
+#pragma once
+
+class GBuffer
+{
+public:
+    enum Target
+    {
+        Albedo,     // R8G8B8A8_UNORM
+        Specular,   // R8G8B8A8_UNORM
+        Normal,     // R16G16_SNORM
+        Ambient,    // R8G8B8A8_UNORM
+        NumTargets
+    };
+
+    GBuffer( ID3D11Device* device, UINT width, UINT height );
+    virtual ~GBuffer();
+
+    // Create the targets again for a new screen size.
+    void Resize( UINT width, UINT height );
+
+    UINT get_Width() const;
+    UINT get_Height() const;
+
+    /**
+     * Clear the targets and the depth buffer. The ambient target is cleared to
+     * clearColor, which the lighting pass outputs where there is no geometry.
+     */
+    void Clear( ID3D11DeviceContext* deviceContext, const FLOAT clearColor[4] );
+
+    // Bind the color targets and the depth buffer for the G-buffer pass.
+    void SetRenderTargets( ID3D11DeviceContext* deviceContext );
+
+    ID3D11RenderTargetView* get_RenderTargetView( Target target ) const;
+    ID3D11DepthStencilView* get_DepthStencilView() const;
+
+    // The shader resource views of the depth buffer and the color targets.
+    ID3D11ShaderResourceView* get_DepthShaderResourceView() const;
+    ID3D11ShaderResourceView* get_ShaderResourceView( Target target ) const;
+
+    /**
+     * Bind the depth buffer and the color targets to the compute shader slots
+     * startSlot to startSlot + NumTargets (t0 - t4 of the lighting pass).
+     */
+    void SetComputeShaderResources( ID3D11DeviceContext* deviceContext, UINT startSlot = 0 );
+
+    // The lit image (R8G8B8A8_UNORM).
+    ID3D11Texture2D* get_OutputTexture() const;
+    ID3D11UnorderedAccessView* get_OutputUnorderedAccessView() const;
+
+private:
+    GBuffer( const GBuffer& copy );
+
+    void CreateTargets();
+
+    Microsoft::WRL::ComPtr<ID3D11Device> m_d3dDevice;
+
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> m_d3dTargets[NumTargets];
+    Microsoft::WRL::ComPtr<ID3D11RenderTargetView> m_d3dRenderTargetViews[NumTargets];
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_d3dShaderResourceViews[NumTargets];
+
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> m_d3dDepthStencilBuffer;
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilView> m_d3dDepthStencilView;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_d3dDepthShaderResourceView;
+
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> m_d3dOutputTexture;
+    Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> m_d3dOutputUnorderedAccessView;
+
+    UINT m_Width;
+    UINT m_Height;
+};
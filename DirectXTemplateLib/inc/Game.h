@@ -4,8 +4,17 @@
 #pragma once
 
 #include <Events.h>
+#include <FramePacer.h>
+#include <GpuProfiler.h>
+#include <JobSystem.h>
+#include <ParallelCommandRecorder.h>
+
+#include <memory>
 
 class Window;
+class D3D11CommandRecorder;
+class D3D11TimestampQueries;
+class DynamicConstantBuffer;
 
 class Game
 {
@@ -36,6 +45,59 @@ public:
     */
     virtual void Cleanup();
 
+    /**
+     * Copy the contents of the back buffer to CPU memory.
+     * The pixels are tightly packed 8-bit RGBA values starting at the top-left corner.
+     * This function waits for the GPU to finish rendering so it should only be
+     * used for debugging and image comparison tests.
+     */
+    bool ReadBackBuffer( std::vector<uint8_t>& pixels, UINT& width, UINT& height );
+
+    /**
+     * Save the contents of the back buffer to an uncompressed 32-bit TGA file.
+     */
+    bool SaveBackBuffer( const std::string& fileName );
+
+    /**
+     * The number of threads that record command lists in RecordCommandLists
+     * (including the thread that calls it). The default is the number of
+     * hardware threads, but at most 8.
+     */
+    size_t get_NumRecordingThreads() const;
+    void set_NumRecordingThreads( size_t numThreads );
+
+    /**
+     * The number of threads of the job system, including the thread that
+     * creates the game (0 for the number of hardware threads).
+     */
+    size_t get_NumJobThreads() const;
+    void set_NumJobThreads( size_t numThreads );
+
+    /**
+     * Create a flip-model swap chain (DXGI_SWAP_EFFECT_FLIP_DISCARD) with bufferCount
+     * buffers (at least 2) and a frame latency waitable object. Call before Initialize.
+     * By default a bit-block transfer swap chain with one buffer is created.
+     * With the flip model the render targets are unbound by Present, so bind them
+     * again every frame.
+     */
+    void set_FlipModel( bool flipModel, UINT bufferCount = 2 );
+    bool get_FlipModel() const;
+    UINT get_BufferCount() const;
+
+    /**
+     * The maximum frame latency and the predictive start of the flip-model swap chain
+     * (see FramePacer and WaitForNextFrame). The default is a latency of one frame.
+     */
+    const FramePacingSettings& get_FramePacing() const;
+    void set_FramePacing( const FramePacingSettings& settings );
+
+    /**
+     * Profile the GPU with timestamp queries (see get_GpuProfiler). Call before
+     * Initialize. Disabled by default.
+     */
+    void set_GpuProfiling( bool gpuProfiling );
+    bool get_GpuProfiling() const;
+
 protected:
     friend class Window;
 
@@ -53,6 +115,10 @@ protected:
     Microsoft::WRL::ComPtr<ID3D11DepthStencilView> m_d3dDepthStencilView;
     // A texture to associate to the depth stencil view.
     Microsoft::WRL::ComPtr<ID3D11Texture2D> m_d3dDepthStencilBuffer;
+    // In headless mode there is no swap chain and this texture is used as the back buffer.
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> m_d3dOffscreenBuffer;
+    // A CPU readable copy of the back buffer (see ReadBackBuffer).
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> m_d3dStagingBuffer;
 
     // Define the functionality of the depth/stencil stages.
     Microsoft::WRL::ComPtr<ID3D11DepthStencilState> m_d3dDepthStencilState;
@@ -61,6 +127,11 @@ protected:
     // Present parameters used by the IDXGISwapChain1::Present1 method
     DXGI_PRESENT_PARAMETERS m_PresentParameters;
 
+    /**
+     * Report an error to the user in a message box, or on the error stream if
+     * the window is headless.
+     */
+    void ReportError( const char* message ) const;
     /**
      * Clear the contents of the back buffer, depth buffer, and stencil buffer.
      * This function is usually called before anything is rendered to the screen.
@@ -71,6 +142,39 @@ protected:
      * This function is usually called after everything has been rendered.
      */
     void Present();
+    /**
+     * Wait until the swap chain can queue another frame and, with predictive start,
+     * until the frame is expected to finish just before the vertical blank. The
+     * application calls this before it processes the input and updates the game.
+     * Returns at once without a flip-model swap chain.
+     */
+    virtual void WaitForNextFrame();
+
+    /**
+     * Record the items [0, numItems) into deferred contexts on the recording threads
+     * and execute the command lists on the immediate context in the order of the items.
+     * Each command list starts with the render targets, viewports, rasterizer and
+     * depth/stencil states and pixel shader samplers of the immediate context.
+     * The record function is called concurrently for disjoint ranges of items.
+     * @param dynamicConstantBuffer The dynamic constant buffer of the constant buffer
+     * bindings (optional). Commit it before calling this function.
+     */
+    void RecordCommandLists( size_t numItems, const ParallelCommandRecorder::RecordFunction& record,
+                             DynamicConstantBuffer* dynamicConstantBuffer = nullptr );
+
+    /**
+     * The job system for culling, animation, mesh generation and asset decoding
+     * (created on first use). Jobs can be started and waited for on the thread
+     * that runs the game and inside other jobs.
+     */
+    JobSystem& get_JobSystem();
+
+    /**
+     * The GPU profiler, or null if GPU profiling is disabled. Present ends the
+     * profiled frame and begins the next one, so wrap the commands of a frame in
+     * GPU_PROFILE_SCOPE( get_GpuProfiler(), "Name" ) scopes.
+     */
+    GpuProfiler* get_GpuProfiler();
 
     /**
      *  Update the game logic.
@@ -125,9 +229,39 @@ protected:
 
 private:
 
+    // Create the swap chain for the window.
+    bool CreateSwapChain();
     // Resize the front and back buffers associated with the swap chain.
+    // In headless mode this (re)creates the offscreen render target.
     bool ResizeSwapChain( int width, int height );
+    // Create a deferred context for each recording thread.
+    void CreateCommandRecorders( DynamicConstantBuffer* dynamicConstantBuffer );
 
     bool m_bIsInitialized;
 
+    // The deferred contexts and threads used by RecordCommandLists (created on first use).
+    size_t m_NumRecordingThreads;
+    DynamicConstantBuffer* m_RecordingConstantBuffer;
+    std::vector< std::unique_ptr<D3D11CommandRecorder> > m_CommandRecorders;
+    std::unique_ptr<ParallelCommandRecorder> m_ParallelRecorder;
+
+    // The flip-model swap chain and its frame pacing.
+    bool m_bFlipModel;
+    UINT m_BufferCount;
+    // The flags that the swap chain was created with (ResizeBuffers needs them).
+    UINT m_SwapChainFlags;
+    HANDLE m_FrameLatencyWaitableObject;
+    FramePacer m_FramePacer;
+    // The time at which the CPU work of the current frame started.
+    int64_t m_FrameStartTicks;
+
+    // The job system returned by get_JobSystem (created on first use).
+    size_t m_NumJobThreads;
+    std::unique_ptr<JobSystem> m_JobSystem;
+
+    // The GPU profiler and its queries (created by Initialize).
+    bool m_bGpuProfiling;
+    std::unique_ptr<D3D11TimestampQueries> m_TimestampQueries;
+    std::unique_ptr<GpuProfiler> m_GpuProfiler;
+
 };
\ No newline at end of file
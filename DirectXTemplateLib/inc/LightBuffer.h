@@ -0,0 +1,98 @@
+/**
+ * @brief The StructuredBuffer<Light> of a LightManager, updated incrementally.
+ *
+ * The lights live in a D3D11_USAGE_DEFAULT structured buffer. Every frame Update
+ * writes only the dirty lights of the LightManager to a dynamic staging ring
+ * (mapped with D3D11_MAP_WRITE_NO_OVERWRITE) and copies each dirty range to the
+ * light buffer with CopySubresourceRegion. Lights that did not change are not
+ * uploaded again.
+ *
+ * The staging ring is sub-allocated by the RingAllocator in the core library and
+ * event queries are used to determine when the GPU is done with a frame (like
+ * DynamicConstantBuffer). If the device cannot map a dynamic structured buffer
+ * with D3D11_MAP_WRITE_NO_OVERWRITE (Direct3D 11.0 runtime), or the dirty lights
+ * do not fit in the ring, the ranges are uploaded with UpdateSubresource.
+ */
+#pragma once
+
+#include <LightManager.h>
+#include <RingAllocator.h>
+
+class LightBuffer
+{
+public:
+    struct Statistics
+    {
+        // The number of lights and bytes that were uploaded in the last Update.
+        UINT UploadedLights;
+        UINT UploadedBytes;
+        // The number of copies from the staging ring (or UpdateSubresource calls).
+        UINT Copies;
+        // The number of times the CPU had to wait for the GPU because the ring was full.
+        UINT Stalls;
+    };
+
+    /**
+     * @param capacity The initial number of lights of the light buffer.
+     * @param stagingSize The size of the staging ring in bytes.
+     */
+    LightBuffer( ID3D11Device* device, UINT capacity = 256, UINT stagingSize = 1024 * 1024 );
+    virtual ~LightBuffer();
+
+    UINT get_Capacity() const;
+    // Returns true if the lights are uploaded through the staging ring.
+    bool get_SupportsNoOverwrite() const;
+
+    /**
+     * Upload the lights that changed since the last Update and clear the dirty
+     * lights of the LightManager. If the lights do not fit, the buffer is created
+     * again with twice the capacity and all of the lights are uploaded.
+     */
+    void Update( ID3D11DeviceContext* deviceContext, LightManager& lights );
+
+    /**
+     * Call at the end of the frame after the last draw call that reads the lights.
+     */
+    void EndFrame( ID3D11DeviceContext* deviceContext );
+
+    // The view of the buffer. The view changes when the buffer grows.
+    ID3D11ShaderResourceView* get_ShaderResourceView() const;
+
+    // Statistics for the last Update.
+    const Statistics& get_Statistics() const;
+
+private:
+    LightBuffer( const LightBuffer& copy );
+
+    void CreateBuffer( UINT capacity );
+    // Allocate from the staging ring, waiting for the GPU if the ring is full.
+    size_t AllocateStaging( ID3D11DeviceContext* deviceContext, size_t size );
+    void ReleaseCompletedFrames( ID3D11DeviceContext* deviceContext, bool wait );
+
+    Microsoft::WRL::ComPtr<ID3D11Device> m_d3dDevice;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> m_d3dBuffer;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_d3dShaderResourceView;
+    UINT m_Capacity;
+
+    bool m_SupportsNoOverwrite;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> m_d3dStagingBuffer;
+    RingAllocator m_Allocator;
+    // True if the staging buffer must be mapped with D3D11_MAP_WRITE_DISCARD.
+    bool m_Discard;
+
+    // An event query for each frame in flight.
+    struct FrameFence
+    {
+        uint64_t FenceValue;
+        Microsoft::WRL::ComPtr<ID3D11Query> Query;
+    };
+    std::deque<FrameFence> m_FramesInFlight;
+    std::vector< Microsoft::WRL::ComPtr<ID3D11Query> > m_FreeQueries;
+    uint64_t m_FenceValue;
+
+    std::vector<LightManager::DirtyRange> m_DirtyRanges;
+    // The lights of a range for UpdateSubresource.
+    std::vector<Light> m_UploadLights;
+
+    Statistics m_Statistics;
+};
@@ -0,0 +1,73 @@
+/**
+ * @brief Conversions between the core library math types and the DirectX Math library.
+ *
+ * The core math types have the same memory layout as the corresponding
+ * DirectX Math storage types (XMFLOAT3, XMFLOAT4, XMFLOAT4X4).
+ */
+#pragma once
+
+#include <CoreMath.h>
+#include <Camera.h>
+
+inline DirectX::XMVECTOR XM_CALLCONV XMLoad( const Math::Float2& v )
+{
+    return DirectX::XMLoadFloat2( reinterpret_cast<const DirectX::XMFLOAT2*>( &v ) );
+}
+
+inline DirectX::XMVECTOR XM_CALLCONV XMLoad( const Math::Float3& v )
+{
+    return DirectX::XMLoadFloat3( reinterpret_cast<const DirectX::XMFLOAT3*>( &v ) );
+}
+
+inline DirectX::XMVECTOR XM_CALLCONV XMLoad( const Math::Float4& v )
+{
+    return DirectX::XMLoadFloat4( reinterpret_cast<const DirectX::XMFLOAT4*>( &v ) );
+}
+
+inline DirectX::XMMATRIX XM_CALLCONV XMLoad( const Math::Float4x4& m )
+{
+    return DirectX::XMLoadFloat4x4( reinterpret_cast<const DirectX::XMFLOAT4X4*>( &m ) );
+}
+
+inline Math::Float3 XM_CALLCONV ToFloat3( DirectX::FXMVECTOR v )
+{
+    Math::Float3 result;
+    DirectX::XMStoreFloat3( reinterpret_cast<DirectX::XMFLOAT3*>( &result ), v );
+    return result;
+}
+
+inline Math::Float4 XM_CALLCONV ToFloat4( DirectX::FXMVECTOR v )
+{
+    Math::Float4 result;
+    DirectX::XMStoreFloat4( reinterpret_cast<DirectX::XMFLOAT4*>( &result ), v );
+    return result;
+}
+
+inline Math::Float4x4 XM_CALLCONV ToFloat4x4( DirectX::FXMMATRIX m )
+{
+    Math::Float4x4 result;
+    DirectX::XMStoreFloat4x4( reinterpret_cast<DirectX::XMFLOAT4X4*>( &result ), m );
+    return result;
+}
+
+inline D3D11_VIEWPORT ToD3D11Viewport( const Viewport& viewport )
+{
+    D3D11_VIEWPORT d3dViewport = 
+    {
+        viewport.TopLeftX, viewport.TopLeftY,
+        viewport.Width, viewport.Height,
+        viewport.MinDepth, viewport.MaxDepth
+    };
+    return d3dViewport;
+}
+
+inline Viewport FromD3D11Viewport( const D3D11_VIEWPORT& d3dViewport )
+{
+    Viewport viewport = 
+    {
+        d3dViewport.TopLeftX, d3dViewport.TopLeftY,
+        d3dViewport.Width, d3dViewport.Height,
+        d3dViewport.MinDepth, d3dViewport.MaxDepth
+    };
+    return viewport;
+}
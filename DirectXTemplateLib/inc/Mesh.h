@@ -1,50 +1,184 @@
 /**
  *   @brief A mesh class that can be used to draw geometry to the screen.
+ *
+ *   The geometry is generated by the core library (see Geometry.h).
+ *   The Mesh class uploads the geometry to the GPU and draws it. The bounds of
+ *   the geometry are kept on the CPU for culling and picking.
+ *
+ *   A mesh can have a chain of levels of detail (see MeshSimplifier.h). The LODs
+ *   are ranges of the index buffer over the shared vertex buffer; use SelectLod
+ *   to choose the LOD to draw for a camera.
+ *
+ *   The first LOD can be split into meshlets (see Meshlets.h). CullMeshlets
+ *   returns the index ranges of the meshlets that are inside the view frustum
+ *   and face the camera.
  */
 #pragma once
 
-#include <memory>
-
-// Vertex struct holding position, normal vector, and texture mapping information.
-struct VertexPositionNormalTexture
-{
-    VertexPositionNormalTexture()
-    { }
+#include <Geometry.h>
+#include <MeshCache.h>
+#include <Meshlets.h>
+#include <MeshSimplifier.h>
+#include <RenderQueue.h>
+#include <VertexFormats.h>
 
-    VertexPositionNormalTexture( const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& normal, const DirectX::XMFLOAT2& textureCoordinate)
-        : position(position),
-        normal(normal),
-        textureCoordinate(textureCoordinate)
-    { }
+#include <memory>
 
-    VertexPositionNormalTexture( DirectX::FXMVECTOR position, DirectX::FXMVECTOR normal, DirectX::FXMVECTOR textureCoordinate)
-    {
-        XMStoreFloat3(&this->position, position);
-        XMStoreFloat3(&this->normal, normal);
-        XMStoreFloat2(&this->textureCoordinate, textureCoordinate);
-    }
+// Describes the input layout of a vertex type for use with ID3D11Device::CreateInputLayout.
+template<typename VertexType>
+struct VertexInputLayout;
 
-    DirectX::XMFLOAT3 position;
-    DirectX::XMFLOAT3 normal;
-    DirectX::XMFLOAT2 textureCoordinate;
+template<>
+struct VertexInputLayout<VertexPositionNormalTexture>
+{
+    static const int InputElementCount = 3;
+    static const D3D11_INPUT_ELEMENT_DESC InputElements[InputElementCount];
+};
 
+template<>
+struct VertexInputLayout<VertexPositionNormalTextureHalf>
+{
     static const int InputElementCount = 3;
     static const D3D11_INPUT_ELEMENT_DESC InputElements[InputElementCount];
 };
 
-typedef std::vector<VertexPositionNormalTexture> VertexCollection;
-typedef std::vector<uint16_t> IndexCollection;
+template<>
+struct VertexInputLayout<VertexPositionNormalTextureQuantized>
+{
+    static const int InputElementCount = 3;
+    static const D3D11_INPUT_ELEMENT_DESC InputElements[InputElementCount];
+};
 
 class Mesh
 {
 public:
-    
-    void Draw( ID3D11DeviceContext* pDeviceContext );
 
-    static std::unique_ptr<Mesh> CreateCube( ID3D11DeviceContext* deviceContext, float size = 1, bool rhcoords = true);
-    static std::unique_ptr<Mesh> CreateSphere( ID3D11DeviceContext* deviceContext, float diameter = 1, size_t tessellation = 16, bool rhcoords = true);
-    static std::unique_ptr<Mesh> CreateCone( ID3D11DeviceContext* deviceContext, float diameter = 1, float height = 1, size_t tessellation = 32, bool rhcoords = true);
-    static std::unique_ptr<Mesh> CreateTorus( ID3D11DeviceContext* deviceContext, float diameter = 1, float thickness = 0.333f, size_t tessellation = 32, bool rhcoords = true);
+    /**
+     * The format of the vertex buffer. The compact formats need the
+     * SimpleCompactVertexShader or InstancedCompactVertexShader and the
+     * corresponding VertexInputLayout (see VertexFormats.h).
+     */
+    enum VertexFormat
+    {
+        // VertexPositionNormalTexture (32 bytes per vertex).
+        FullPrecisionVertices,
+        // VertexPositionNormalTextureHalf (16 bytes per vertex).
+        HalfPrecisionVertices,
+        // VertexPositionNormalTextureQuantized (16 bytes per vertex).
+        QuantizedVertices,
+    };
+
+    void Draw( ID3D11DeviceContext* pDeviceContext, size_t lod = 0 );
+
+    /**
+     * Set the input assembler state and the draw arguments of a draw command
+     * to draw a submesh of the mesh with a RenderQueue. Meshes with LODs have a
+     * single submesh.
+     */
+    void SetupDrawCommand( DrawCommand& drawCommand, size_t subMesh = 0, size_t lod = 0 ) const;
+
+    // The number of levels of detail (1 if the mesh has no LODs).
+    size_t get_NumLods() const;
+    /**
+     * Select the coarsest LOD whose error is smaller than maxPixelError pixels on
+     * the screen when the mesh is drawn with a world matrix and a camera. The
+     * projection parameters and the viewport of the camera must be set.
+     */
+    size_t SelectLod( const Camera& camera, const Math::Float4x4& worldMatrix, float maxPixelError = 1.0f ) const;
+
+    // The number of meshlets of the first LOD (0 if the mesh has no meshlets).
+    size_t get_NumMeshlets() const;
+    /**
+     * Get the index ranges of the first LOD that are visible from a camera when the
+     * mesh is drawn with a world matrix. The meshlets outside of the view frustum and
+     * the back-facing meshlets are culled. A mesh without meshlets returns the whole
+     * first LOD as a single range.
+     * @returns The number of indices in the ranges.
+     */
+    size_t CullMeshlets( const Camera& camera, const Math::Float4x4& worldMatrix, IndexRangeCollection& ranges ) const;
+    // Draw ranges of the index buffer, for example the ranges returned by CullMeshlets.
+    void Draw( ID3D11DeviceContext* pDeviceContext, const IndexRangeCollection& ranges );
+    // Set up a draw command for a range of the index buffer of a mesh without submeshes.
+    void SetupDrawCommand( DrawCommand& drawCommand, const IndexRange& range ) const;
+
+    /**
+     * The number of draw calls needed to draw the mesh. Meshes with more than
+     * 65536 vertices are either drawn with 32-bit indices in a single draw call
+     * or split into several submeshes with 16-bit indices (see PreferSplitMesh).
+     * Meshes with LODs are never split.
+     */
+    size_t get_NumSubMeshes() const;
+    // The format of the index buffer (DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT).
+    DXGI_FORMAT get_IndexFormat() const;
+
+    VertexFormat get_VertexFormat() const;
+    /**
+     * The matrix that transforms the positions in the vertex buffer to object space.
+     * Multiply it with the world matrix that transforms the positions but not with
+     * the inverse transpose world matrix that transforms the normals. This is the
+     * identity matrix unless the vertex format is QuantizedVertices.
+     */
+    const Math::Float4x4& get_PositionDequantization() const;
+
+    // The bounds of the mesh in object space.
+    const BoundingBox& get_BoundingBox() const;
+    const BoundingSphere& get_BoundingSphere() const;
+
+    /**
+     * Create a mesh from a generator (see Geometry.h). The sphere and the torus
+     * generate a chain of up to maxLods levels of detail. The cube and the cone
+     * cannot be simplified because all of their vertices are on the seams between
+     * the faces (the simplifier does not move seam vertices). The sphere and the
+     * torus can also be split into meshlets for CullMeshlets.
+     */
+    static std::unique_ptr<Mesh> CreateCube( ID3D11DeviceContext* deviceContext, float size = 1, bool rhcoords = true, VertexFormat vertexFormat = FullPrecisionVertices );
+    static std::unique_ptr<Mesh> CreateSphere( ID3D11DeviceContext* deviceContext, float diameter = 1, size_t tessellation = 16, bool rhcoords = true, VertexFormat vertexFormat = FullPrecisionVertices, size_t maxLods = 1, bool buildMeshlets = false );
+    static std::unique_ptr<Mesh> CreateCone( ID3D11DeviceContext* deviceContext, float diameter = 1, float height = 1, size_t tessellation = 32, bool rhcoords = true, VertexFormat vertexFormat = FullPrecisionVertices );
+    static std::unique_ptr<Mesh> CreateTorus( ID3D11DeviceContext* deviceContext, float diameter = 1, float thickness = 0.333f, size_t tessellation = 32, bool rhcoords = true, VertexFormat vertexFormat = FullPrecisionVertices, size_t maxLods = 1, bool buildMeshlets = false );
+
+    /**
+     * Create a mesh from vertices and indices that were generated on the CPU.
+     * The winding order of the indices must already match the coordinate system.
+     * The bounds of the mesh are computed from the vertices. The primitives are
+     * optimized with OptimizeMesh (see MeshOptimizer.h) before they are uploaded;
+     * call it on loaded geometry as well.
+     */
+    static std::unique_ptr<Mesh> CreateFromGeometry( ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices,
+                                                     VertexFormat vertexFormat = FullPrecisionVertices );
+
+    // Create a mesh from geometry with bounds that are already known.
+    static std::unique_ptr<Mesh> CreateFromGeometry( ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices,
+                                                     const BoundingBox& boundingBox, const BoundingSphere& boundingSphere,
+                                                     VertexFormat vertexFormat = FullPrecisionVertices );
+
+    /**
+     * Create a mesh with levels of detail. The indices contain the index ranges of
+     * all LODs as generated by GenerateLods (see MeshSimplifier.h).
+     */
+    static std::unique_ptr<Mesh> CreateFromGeometry( ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices,
+                                                     const MeshLodCollection& lods, VertexFormat vertexFormat = FullPrecisionVertices );
+
+    /**
+     * Create a mesh with meshlets. The indices must be ordered by BuildMeshlets
+     * (see Meshlets.h) and may be followed by the indices of other LODs.
+     */
+    static std::unique_ptr<Mesh> CreateFromGeometry( ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices,
+                                                     const MeshLodCollection& lods, const MeshletCollection& meshlets,
+                                                     VertexFormat vertexFormat = FullPrecisionVertices );
+
+    /**
+     * Create a mesh from streams that are ready to be uploaded, for example the
+     * streams of a memory-mapped MeshFile. The streams are not copied on the CPU.
+     */
+    static std::unique_ptr<Mesh> CreateFromMeshData( ID3D11DeviceContext* deviceContext, const MeshData& meshData );
+
+    /**
+     * The cache of the Create* factories (none by default). The factories load
+     * the mesh from the cache if it has a file for the same parameters. Otherwise
+     * they generate the mesh and write it to the cache. The caller owns the cache.
+     */
+    static void set_Cache( MeshCache* cache );
+    static MeshCache* get_Cache();
 
 protected:
 
@@ -55,10 +189,37 @@ private:
     Mesh( const Mesh& copy );
     virtual ~Mesh();
 
-    void Initialize( ID3D11DeviceContext* deviceContext, VertexCollection& vertices, IndexCollection& indices, bool rhcoords );
+    // Returns null on a cache miss.
+    static std::unique_ptr<Mesh> CreateFromCache( ID3D11DeviceContext* deviceContext, const MeshCacheKey& key );
+    static std::unique_ptr<Mesh> Create( ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices,
+                                         const MeshLodCollection& lods, const MeshletCollection& meshlets,
+                                         const BoundingBox& boundingBox, const BoundingSphere& boundingSphere,
+                                         VertexFormat vertexFormat, const MeshCacheKey* cacheKey );
+
+    void Initialize( ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices,
+                     const MeshLodCollection& lods, const MeshletCollection& meshlets,
+                     VertexFormat vertexFormat, const MeshCacheKey* cacheKey );
+    void Initialize( ID3D11DeviceContext* deviceContext, const MeshData& meshData );
     
     Microsoft::WRL::ComPtr<ID3D11Buffer> m_VertexBuffer;
     Microsoft::WRL::ComPtr<ID3D11Buffer> m_IndexBuffer;
 
-    UINT m_IndexCount;
-};
\ No newline at end of file
+    DXGI_FORMAT m_IndexFormat;
+    SubMeshCollection m_SubMeshes;
+    // Empty if the mesh has no LODs.
+    MeshLodCollection m_Lods;
+    // Empty if the mesh has no meshlets.
+    MeshletCollection m_Meshlets;
+    MeshletBoundsArrays m_MeshletBounds;
+    // Scratch space for CullMeshlets.
+    mutable std::vector<uint32_t> m_VisibleMeshlets;
+
+    VertexFormat m_VertexFormat;
+    UINT m_VertexStride;
+    Math::Float4x4 m_PositionDequantization;
+
+    BoundingBox m_BoundingBox;
+    BoundingSphere m_BoundingSphere;
+
+    static MeshCache* ms_Cache;
+};
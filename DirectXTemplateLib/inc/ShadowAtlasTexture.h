@@ -0,0 +1,55 @@
+/**
+ * @brief The depth texture of a shadow atlas (see ShadowMaps.h in the core library).
+ *
+ * The shadow maps are rendered into tiles of the texture with a viewport per tile
+ * and sampled with a comparison sampler. The texture is created with a typeless
+ * format so that it can be both a D32_FLOAT depth-stencil view and an R32_FLOAT
+ * shader resource view (like the depth buffer of the GBuffer).
+ *
+ * A tile cannot be cleared with ClearDepthStencilView, which clears the whole view.
+ * Before a tile is rendered again, draw a triangle that covers the viewport at the
+ * far plane with get_ClearDepthStencilState, which always writes the depth.
+ */
+#pragma once
+
+#include <ShadowMaps.h>
+
+class ShadowAtlasTexture
+{
+public:
+    // @param size The width and height of the atlas in texels.
+    ShadowAtlasTexture( ID3D11Device* device, UINT size );
+    virtual ~ShadowAtlasTexture();
+
+    UINT get_Size() const;
+
+    // Clear the whole atlas to the far plane.
+    void Clear( ID3D11DeviceContext* deviceContext );
+
+    // Bind the atlas as the depth buffer without a render target.
+    void SetRenderTarget( ID3D11DeviceContext* deviceContext );
+    // Set the viewport to a tile of the atlas.
+    void SetViewport( ID3D11DeviceContext* deviceContext, const ShadowAtlasTile& tile );
+
+    ID3D11DepthStencilView* get_DepthStencilView() const;
+    ID3D11ShaderResourceView* get_ShaderResourceView() const;
+
+    // A comparison sampler with bilinear filtering (2 x 2 percentage closer filtering).
+    ID3D11SamplerState* get_SamplerState() const;
+    // Culls no faces and applies a depth bias and a slope-scaled depth bias.
+    ID3D11RasterizerState* get_RasterizerState() const;
+    // Always writes the depth (to clear a tile).
+    ID3D11DepthStencilState* get_ClearDepthStencilState() const;
+
+private:
+    ShadowAtlasTexture( const ShadowAtlasTexture& copy );
+
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> m_d3dTexture;
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilView> m_d3dDepthStencilView;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_d3dShaderResourceView;
+    Microsoft::WRL::ComPtr<ID3D11SamplerState> m_d3dSamplerState;
+    Microsoft::WRL::ComPtr<ID3D11RasterizerState> m_d3dRasterizerState;
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilState> m_d3dClearDepthStencilState;
+
+    UINT m_Size;
+};
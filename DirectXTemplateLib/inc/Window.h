@@ -29,6 +29,12 @@ public:
      */
     bool IsValid() const;
 
+    /**
+     * A headless window does not have an OS window. Games that are registered
+     * with a headless window render into an offscreen render target.
+     */
+    bool IsHeadless() const;
+
     const std::string& get_WindowName() const;
 
     int get_ClientWidth() const;
@@ -55,6 +61,8 @@ protected:
 
     Window();
     Window( HWND hWnd, const std::string& windowName, int clientWidth, int clientHeight, bool vSync, bool windowed );
+    // Create a headless window.
+    Window( const std::string& windowName, int clientWidth, int clientHeight );
     virtual ~Window();
 
     // Register a DirectXTemplate with this window. This allows
@@ -63,6 +71,8 @@ protected:
     bool RegisterDirectXTemplate( Game* pTemplate );
 
     // Update and Draw can only be called by the application.
+    // WaitForNextFrame is called before the input of a frame is processed.
+    virtual void WaitForNextFrame();
     virtual void OnUpdate( UpdateEventArgs& e );
     virtual void OnRender( RenderEventArgs& e );
 
@@ -94,6 +104,7 @@ private:
     int m_ClientHeight;
     bool m_VSync;
     bool m_bWindowed;
+    bool m_bHeadless;
 
     Game* m_pGame;
 };
\ No newline at end of file
@@ -3,11 +3,16 @@
 #include "..\resource.h"
 
 #include <Window.h>
+#include <Clock.h>
+#include <Profiler.h>
+
+#include <memory>
 
 #define WINDOW_CLASS_NAME "DX11RenderWindowClass"
 
 typedef std::map< HWND, Window* > WindowMap;
 typedef std::map< std::string, Window* > WindowNameMap;
+typedef std::vector< Window* > WindowList;
 
 // An invalid window to return if an error occurred while creating a window.
 Window Application::ms_InvalidWindow;
@@ -15,11 +20,14 @@ Window Application::ms_InvalidWindow;
 static Application* gs_pSingelton = nullptr;
 static WindowMap gs_Windows;
 static WindowNameMap gs_WindowByName;
+// Headless windows don't have a window handle so they are stored in a separate list.
+static WindowList gs_HeadlessWindows;
 
 static LRESULT CALLBACK WndProc (HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
 
 Application::Application( HINSTANCE hInst )
     : m_hInstance( hInst )
+    , m_FixedUpdateRate( 0 )
 {
     WNDCLASSEX wndClass = {0};
 
@@ -70,7 +78,14 @@ Application::~Application()
         window.second->Destroy();
     }
 
+    for ( Window* pWindow : gs_HeadlessWindows )
+    {
+        pWindow->Destroy();
+        delete pWindow;
+    }
+
     gs_Windows.clear();
+    gs_HeadlessWindows.clear();
     gs_WindowByName.clear();
 }
 
@@ -108,6 +123,22 @@ Window& Application::CreateRenderWindow( const std::string& windowName, int clie
     return *pWindow;
 }
 
+Window& Application::CreateHeadlessWindow( const std::string& windowName, int clientWidth, int clientHeight )
+{
+    // First check if a window with the given name already exists.
+    WindowNameMap::iterator windowIter = gs_WindowByName.find(windowName);
+    if ( windowIter != gs_WindowByName.end() )
+    {
+        return *(windowIter->second);
+    }
+
+    Window* pWindow = new Window( windowName, clientWidth, clientHeight );
+    gs_HeadlessWindows.push_back( pWindow );
+    gs_WindowByName.insert( WindowNameMap::value_type( windowName, pWindow ) );
+
+    return *pWindow;
+}
+
 void Application::DestroyWindow( Window& window )
 {
     window.Destroy();
@@ -135,11 +166,25 @@ int Application::Run()
 {
     MSG msg = {0};
 
-    static DWORD previousTime = timeGetTime();
-    static float totalTime = 0.0f;
     static const float targetFramerate = 30.0f;
     static const float maxTimeStep = 1.0f / targetFramerate;
 
+    Clock clock;
+    std::unique_ptr<FixedTimestep> fixedTimestep;
+    if ( m_FixedUpdateRate > 0 )
+    {
+        // The fixed timestep limits the number of updates per frame instead.
+        fixedTimestep.reset( new FixedTimestep( m_FixedUpdateRate ) );
+    }
+    else
+    {
+        // Cap the delta time to the max time step (useful if your 
+        // debugging and you don't want the deltaTime value to explode.
+        clock.set_MaxDeltaTicks( Clock::SecondsToTicks( maxTimeStep ) );
+    }
+
+    Profiler::SetThreadName( "Main" );
+
     while ( msg.message != WM_QUIT )
     {
         if ( PeekMessage( &msg, 0, 0, 0, PM_REMOVE ) )
@@ -149,23 +194,72 @@ int Application::Run()
         }
         else
         {
-            DWORD currentTime = timeGetTime();
-            float deltaTime = ( currentTime - previousTime ) / 1000.0f;
-            previousTime = currentTime;
+            Profiler::BeginFrame();
 
-            // Cap the delta time to the max time step (useful if your 
-            // debugging and you don't want the deltaTime value to explode.
-            deltaTime = std::min<float>(deltaTime, maxTimeStep);
+            // Wait until the swap chains can queue another frame before the input is
+            // processed, so the frame uses the latest input.
+            {
+                PROFILE_SCOPE( "WaitForNextFrame" );
+                for( WindowMap::value_type window : gs_Windows )
+                {
+                    window.second->WaitForNextFrame();
+                }
+            }
 
-            totalTime += deltaTime;
+            while ( msg.message != WM_QUIT && PeekMessage( &msg, 0, 0, 0, PM_REMOVE ) )
+            {
+                TranslateMessage( &msg );
+                DispatchMessage( &msg );
+            }
+            if ( msg.message == WM_QUIT )
+            {
+                break;
+            }
 
-            UpdateEventArgs updateEventArgs( deltaTime, totalTime );
-            RenderEventArgs renderEventArgs( deltaTime, totalTime );
+            clock.Tick();
+            float deltaTime = static_cast<float>( clock.get_DeltaSeconds() );
 
-            for( WindowMap::value_type window : gs_Windows )
+            if ( fixedTimestep )
             {
-                window.second->OnUpdate( updateEventArgs );
-                window.second->OnRender( renderEventArgs );
+                uint32_t numSteps = fixedTimestep->Advance( clock.get_DeltaTicks() );
+                uint64_t firstStep = fixedTimestep->get_NumSteps() - numSteps;
+                float stepTime = static_cast<float>( fixedTimestep->get_StepSeconds() );
+
+                for ( uint32_t step = 0; step < numSteps; ++step )
+                {
+                    PROFILE_SCOPE( "Update" );
+                    UpdateEventArgs updateEventArgs( stepTime, static_cast<double>( firstStep + step + 1 ) / m_FixedUpdateRate );
+                    for( WindowMap::value_type window : gs_Windows )
+                    {
+                        window.second->OnUpdate( updateEventArgs );
+                    }
+                }
+
+                // Render the state between the last two updates.
+                double alpha = fixedTimestep->get_Alpha();
+                RenderEventArgs renderEventArgs( deltaTime, fixedTimestep->get_InterpolatedSeconds(), static_cast<float>( alpha ) );
+                for( WindowMap::value_type window : gs_Windows )
+                {
+                    PROFILE_SCOPE( "Render" );
+                    window.second->OnRender( renderEventArgs );
+                }
+            }
+            else
+            {
+                UpdateEventArgs updateEventArgs( deltaTime, clock.get_TotalSeconds() );
+                RenderEventArgs renderEventArgs( deltaTime, clock.get_TotalSeconds() );
+
+                for( WindowMap::value_type window : gs_Windows )
+                {
+                    {
+                        PROFILE_SCOPE( "Update" );
+                        window.second->OnUpdate( updateEventArgs );
+                    }
+                    {
+                        PROFILE_SCOPE( "Render" );
+                        window.second->OnRender( renderEventArgs );
+                    }
+                }
             }
         }
     }
@@ -173,6 +267,59 @@ int Application::Run()
     return static_cast<int>(msg.wParam);
 }
 
+int Application::RunHeadless( unsigned int numFrames, float deltaTime, FrameCallback frameCallback )
+{
+    Clock clock;
+    int64_t deltaTicks = Clock::SecondsToTicks( deltaTime );
+
+    Profiler::SetThreadName( "Main" );
+
+    for ( unsigned int frame = 0; frame < numFrames; ++frame )
+    {
+        Profiler::BeginFrame();
+        int64_t frameStart = Clock::GetTicks();
+
+        UpdateEventArgs updateEventArgs( deltaTime, clock.get_TotalSeconds() );
+        RenderEventArgs renderEventArgs( deltaTime, clock.get_TotalSeconds() );
+
+        for ( Window* pWindow : gs_HeadlessWindows )
+        {
+            if ( pWindow->IsValid() )
+            {
+                {
+                    PROFILE_SCOPE( "Update" );
+                    pWindow->OnUpdate( updateEventArgs );
+                }
+                {
+                    PROFILE_SCOPE( "Render" );
+                    pWindow->OnRender( renderEventArgs );
+                }
+            }
+        }
+
+        int64_t frameEnd = Clock::GetTicks();
+
+        if ( frameCallback )
+        {
+            frameCallback( frame, Clock::TicksToSeconds( frameEnd - frameStart ) );
+        }
+
+        clock.Advance( deltaTicks );
+    }
+
+    return 0;
+}
+
+void Application::set_FixedUpdateRate( unsigned int updatesPerSecond )
+{
+    m_FixedUpdateRate = updatesPerSecond;
+}
+
+unsigned int Application::get_FixedUpdateRate() const
+{
+    return m_FixedUpdateRate;
+}
+
 void Application::Quit( int exitCode )
 {
     PostQuitMessage( exitCode );
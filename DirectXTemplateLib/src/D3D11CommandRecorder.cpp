@@ -0,0 +1,107 @@
+#include <DirectXTemplateLibPCH.h>
+#include <D3D11CommandRecorder.h>
+
+D3D11CommandRecorder::D3D11CommandRecorder( ID3D11Device* device, ID3D11DeviceContext* immediateContext, DynamicConstantBuffer* dynamicConstantBuffer )
+    : m_d3dImmediateContext( immediateContext )
+    , m_StencilRef( 0 )
+    , m_NumViewports( 0 )
+{
+    assert( device && immediateContext );
+
+    HRESULT hr = device->CreateDeferredContext( 0, &m_d3dDeferredContext );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create a deferred context." );
+    }
+
+    m_RenderContext.reset( new D3D11RenderContext( m_d3dDeferredContext.Get(), dynamicConstantBuffer ) );
+}
+
+D3D11CommandRecorder::~D3D11CommandRecorder()
+{}
+
+void D3D11CommandRecorder::CopyInitialState( ID3D11DeviceContext* deviceContext )
+{
+    assert( deviceContext );
+
+    ID3D11RenderTargetView* renderTargetViews[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
+    ID3D11DepthStencilView* depthStencilView = nullptr;
+    deviceContext->OMGetRenderTargets( D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT, renderTargetViews, &depthStencilView );
+
+    // The Get functions add a reference that is released by the ComPtr.
+    for ( UINT i = 0; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i )
+    {
+        m_d3dRenderTargetViews[i].Attach( renderTargetViews[i] );
+    }
+    m_d3dDepthStencilView.Attach( depthStencilView );
+
+    m_d3dRasterizerState.Reset();
+    deviceContext->RSGetState( &m_d3dRasterizerState );
+    m_d3dDepthStencilState.Reset();
+    deviceContext->OMGetDepthStencilState( &m_d3dDepthStencilState, &m_StencilRef );
+
+    m_NumViewports = D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
+    deviceContext->RSGetViewports( &m_NumViewports, m_Viewports );
+
+    ID3D11SamplerState* samplerStates[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT] = {};
+    deviceContext->PSGetSamplers( 0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, samplerStates );
+    for ( UINT i = 0; i < D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT; ++i )
+    {
+        m_d3dSamplerStates[i].Attach( samplerStates[i] );
+    }
+}
+
+ID3D11DeviceContext* D3D11CommandRecorder::get_DeviceContext() const
+{
+    return m_d3dDeferredContext.Get();
+}
+
+void D3D11CommandRecorder::BeginCommandList()
+{
+    ID3D11RenderTargetView* renderTargetViews[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT];
+    for ( UINT i = 0; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i )
+    {
+        renderTargetViews[i] = m_d3dRenderTargetViews[i].Get();
+    }
+
+    m_d3dDeferredContext->OMSetRenderTargets( D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT, renderTargetViews, m_d3dDepthStencilView.Get() );
+    m_d3dDeferredContext->OMSetDepthStencilState( m_d3dDepthStencilState.Get(), m_StencilRef );
+    m_d3dDeferredContext->RSSetState( m_d3dRasterizerState.Get() );
+    if ( m_NumViewports > 0 )
+    {
+        m_d3dDeferredContext->RSSetViewports( m_NumViewports, m_Viewports );
+    }
+
+    ID3D11SamplerState* samplerStates[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT];
+    for ( UINT i = 0; i < D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT; ++i )
+    {
+        samplerStates[i] = m_d3dSamplerStates[i].Get();
+    }
+    m_d3dDeferredContext->PSSetSamplers( 0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, samplerStates );
+}
+
+RenderContext& D3D11CommandRecorder::get_RenderContext()
+{
+    return *m_RenderContext;
+}
+
+void D3D11CommandRecorder::FinishCommandList()
+{
+    // The state of the deferred context is reset so the next command list starts clean.
+    m_d3dCommandList.Reset();
+    HRESULT hr = m_d3dDeferredContext->FinishCommandList( FALSE, &m_d3dCommandList );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to finish the command list." );
+    }
+}
+
+void D3D11CommandRecorder::ExecuteCommandList()
+{
+    if ( m_d3dCommandList )
+    {
+        // Restore the state of the immediate context after the command list.
+        m_d3dImmediateContext->ExecuteCommandList( m_d3dCommandList.Get(), TRUE );
+        m_d3dCommandList.Reset();
+    }
+}
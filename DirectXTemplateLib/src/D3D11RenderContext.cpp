@@ -0,0 +1,143 @@
+#include <DirectXTemplateLibPCH.h>
+#include <D3D11RenderContext.h>
+
+#include <DynamicConstantBuffer.h>
+
+// Convert an opaque state handle back to the Direct3D 11 interface.
+template<typename T>
+static T* FromHandle( StateHandle handle )
+{
+    return static_cast<T*>( const_cast<void*>( handle ) );
+}
+
+D3D11RenderContext::D3D11RenderContext( ID3D11DeviceContext* deviceContext, DynamicConstantBuffer* dynamicConstantBuffer )
+    : m_d3dDeviceContext( deviceContext )
+    , m_DynamicConstantBuffer( dynamicConstantBuffer )
+    , m_Deferred( false )
+{
+    assert( deviceContext );
+
+    m_Deferred = ( deviceContext->GetType() == D3D11_DEVICE_CONTEXT_DEFERRED );
+
+    // Only required for binding constant buffers with an offset.
+    deviceContext->QueryInterface<ID3D11DeviceContext1>( &m_d3dDeviceContext1 );
+}
+
+D3D11RenderContext::~D3D11RenderContext()
+{}
+
+void D3D11RenderContext::SetInputLayout( StateHandle inputLayout )
+{
+    m_d3dDeviceContext->IASetInputLayout( FromHandle<ID3D11InputLayout>( inputLayout ) );
+}
+
+void D3D11RenderContext::SetPrimitiveTopology( uint32_t primitiveTopology )
+{
+    m_d3dDeviceContext->IASetPrimitiveTopology( static_cast<D3D11_PRIMITIVE_TOPOLOGY>( primitiveTopology ) );
+}
+
+void D3D11RenderContext::SetVertexBuffer( uint32_t slot, const VertexBufferBinding& vertexBuffer )
+{
+    ID3D11Buffer* buffer = FromHandle<ID3D11Buffer>( vertexBuffer.Buffer );
+    m_d3dDeviceContext->IASetVertexBuffers( slot, 1, &buffer, &vertexBuffer.Stride, &vertexBuffer.Offset );
+}
+
+void D3D11RenderContext::SetIndexBuffer( StateHandle indexBuffer, uint32_t indexFormat )
+{
+    m_d3dDeviceContext->IASetIndexBuffer( FromHandle<ID3D11Buffer>( indexBuffer ), static_cast<DXGI_FORMAT>( indexFormat ), 0 );
+}
+
+void D3D11RenderContext::SetVertexShader( StateHandle vertexShader )
+{
+    m_d3dDeviceContext->VSSetShader( FromHandle<ID3D11VertexShader>( vertexShader ), nullptr, 0 );
+}
+
+void D3D11RenderContext::SetVSConstantBuffer( uint32_t slot, const ConstantBufferBinding& constantBuffer )
+{
+    ConstantBufferBinding binding = constantBuffer;
+    if ( m_DynamicConstantBuffer && constantBuffer.Buffer == m_DynamicConstantBuffer )
+    {
+        if ( !m_Deferred )
+        {
+            m_DynamicConstantBuffer->VSSetConstantBuffer( m_d3dDeviceContext.Get(), slot, m_DynamicConstantBuffer->GetAllocation( constantBuffer ) );
+            return;
+        }
+
+        // Deferred contexts are recorded on several threads, so the committed slice is bound directly.
+        binding = m_DynamicConstantBuffer->GetBufferBinding( constantBuffer );
+    }
+
+    ID3D11Buffer* buffer = FromHandle<ID3D11Buffer>( binding.Buffer );
+    if ( binding.NumConstants > 0 )
+    {
+        assert( m_d3dDeviceContext1 );
+        m_d3dDeviceContext1->VSSetConstantBuffers1( slot, 1, &buffer, &binding.FirstConstant, &binding.NumConstants );
+    }
+    else
+    {
+        m_d3dDeviceContext->VSSetConstantBuffers( slot, 1, &buffer );
+    }
+}
+
+void D3D11RenderContext::SetRasterizerState( StateHandle rasterizerState )
+{
+    m_d3dDeviceContext->RSSetState( FromHandle<ID3D11RasterizerState>( rasterizerState ) );
+}
+
+void D3D11RenderContext::SetPixelShader( StateHandle pixelShader )
+{
+    m_d3dDeviceContext->PSSetShader( FromHandle<ID3D11PixelShader>( pixelShader ), nullptr, 0 );
+}
+
+void D3D11RenderContext::SetPSConstantBuffer( uint32_t slot, const ConstantBufferBinding& constantBuffer )
+{
+    ConstantBufferBinding binding = constantBuffer;
+    if ( m_DynamicConstantBuffer && constantBuffer.Buffer == m_DynamicConstantBuffer )
+    {
+        if ( !m_Deferred )
+        {
+            m_DynamicConstantBuffer->PSSetConstantBuffer( m_d3dDeviceContext.Get(), slot, m_DynamicConstantBuffer->GetAllocation( constantBuffer ) );
+            return;
+        }
+
+        // Deferred contexts are recorded on several threads, so the committed slice is bound directly.
+        binding = m_DynamicConstantBuffer->GetBufferBinding( constantBuffer );
+    }
+
+    ID3D11Buffer* buffer = FromHandle<ID3D11Buffer>( binding.Buffer );
+    if ( binding.NumConstants > 0 )
+    {
+        assert( m_d3dDeviceContext1 );
+        m_d3dDeviceContext1->PSSetConstantBuffers1( slot, 1, &buffer, &binding.FirstConstant, &binding.NumConstants );
+    }
+    else
+    {
+        m_d3dDeviceContext->PSSetConstantBuffers( slot, 1, &buffer );
+    }
+}
+
+void D3D11RenderContext::SetPSShaderResource( uint32_t slot, StateHandle shaderResourceView )
+{
+    ID3D11ShaderResourceView* srv = FromHandle<ID3D11ShaderResourceView>( shaderResourceView );
+    m_d3dDeviceContext->PSSetShaderResources( slot, 1, &srv );
+}
+
+void D3D11RenderContext::SetDepthStencilState( StateHandle depthStencilState )
+{
+    m_d3dDeviceContext->OMSetDepthStencilState( FromHandle<ID3D11DepthStencilState>( depthStencilState ), 0 );
+}
+
+void D3D11RenderContext::SetBlendState( StateHandle blendState )
+{
+    m_d3dDeviceContext->OMSetBlendState( FromHandle<ID3D11BlendState>( blendState ), nullptr, 0xffffffff );
+}
+
+void D3D11RenderContext::DrawIndexed( uint32_t indexCount, uint32_t startIndex, int32_t baseVertex )
+{
+    m_d3dDeviceContext->DrawIndexed( indexCount, startIndex, baseVertex );
+}
+
+void D3D11RenderContext::DrawIndexedInstanced( uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance )
+{
+    m_d3dDeviceContext->DrawIndexedInstanced( indexCount, instanceCount, startIndex, baseVertex, startInstance );
+}
@@ -0,0 +1,83 @@
+#include <DirectXTemplateLibPCH.h>
+#include <D3D11TimestampQueries.h>
+
+D3D11TimestampQueries::D3D11TimestampQueries( ID3D11Device* device, ID3D11DeviceContext* deviceContext, uint32_t numSlots, uint32_t maxTimestamps )
+    : m_d3dDeviceContext( deviceContext )
+    , m_d3dDisjointQueries( numSlots )
+    , m_d3dTimestampQueries( numSlots * maxTimestamps )
+    , m_MaxTimestamps( maxTimestamps )
+{
+    assert( device && deviceContext );
+
+    D3D11_QUERY_DESC disjointDesc = { D3D11_QUERY_TIMESTAMP_DISJOINT, 0 };
+    for ( Microsoft::WRL::ComPtr<ID3D11Query>& query : m_d3dDisjointQueries )
+    {
+        if ( FAILED( device->CreateQuery( &disjointDesc, &query ) ) )
+        {
+            throw std::exception( "Failed to create a timestamp disjoint query." );
+        }
+    }
+
+    D3D11_QUERY_DESC timestampDesc = { D3D11_QUERY_TIMESTAMP, 0 };
+    for ( Microsoft::WRL::ComPtr<ID3D11Query>& query : m_d3dTimestampQueries )
+    {
+        if ( FAILED( device->CreateQuery( &timestampDesc, &query ) ) )
+        {
+            throw std::exception( "Failed to create a timestamp query." );
+        }
+    }
+}
+
+D3D11TimestampQueries::~D3D11TimestampQueries()
+{}
+
+uint32_t D3D11TimestampQueries::get_NumSlots() const
+{
+    return static_cast<uint32_t>( m_d3dDisjointQueries.size() );
+}
+
+uint32_t D3D11TimestampQueries::get_MaxTimestamps() const
+{
+    return m_MaxTimestamps;
+}
+
+void D3D11TimestampQueries::BeginFrame( uint32_t slot )
+{
+    m_d3dDeviceContext->Begin( m_d3dDisjointQueries[slot].Get() );
+}
+
+void D3D11TimestampQueries::EndFrame( uint32_t slot )
+{
+    m_d3dDeviceContext->End( m_d3dDisjointQueries[slot].Get() );
+}
+
+void D3D11TimestampQueries::WriteTimestamp( uint32_t slot, uint32_t index )
+{
+    // Timestamp queries only have an end.
+    m_d3dDeviceContext->End( m_d3dTimestampQueries[slot * m_MaxTimestamps + index].Get() );
+}
+
+bool D3D11TimestampQueries::GetFrequency( uint32_t slot, uint64_t& frequency, bool& disjoint )
+{
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT data;
+    if ( m_d3dDeviceContext->GetData( m_d3dDisjointQueries[slot].Get(), &data, sizeof( data ), D3D11_ASYNC_GETDATA_DONOTFLUSH ) != S_OK )
+    {
+        return false;
+    }
+
+    frequency = data.Frequency;
+    disjoint = data.Disjoint != FALSE;
+    return true;
+}
+
+bool D3D11TimestampQueries::GetTimestamp( uint32_t slot, uint32_t index, uint64_t& timestamp )
+{
+    UINT64 data;
+    if ( m_d3dDeviceContext->GetData( m_d3dTimestampQueries[slot * m_MaxTimestamps + index].Get(), &data, sizeof( data ), D3D11_ASYNC_GETDATA_DONOTFLUSH ) != S_OK )
+    {
+        return false;
+    }
+
+    timestamp = data;
+    return true;
+}
@@ -0,0 +1,53 @@
+#include <DirectXTemplateLibPCH.h>
+#include <D3DShaderCompiler.h>
+
+#include <sstream>
+
+D3DShaderCompiler::D3DShaderCompiler( UINT flags )
+    : m_Flags( flags )
+{}
+
+D3DShaderCompiler::~D3DShaderCompiler()
+{}
+
+bool D3DShaderCompiler::Compile( const ShaderSource& source, const std::vector<ShaderDefine>& defines,
+    std::vector<uint8_t>& bytecode, std::string& errors )
+{
+    // The array of macros is terminated by a null macro.
+    std::vector<D3D_SHADER_MACRO> macros;
+    for ( const ShaderDefine& define : defines )
+    {
+        D3D_SHADER_MACRO macro = { define.Name.c_str(), define.Value.c_str() };
+        macros.push_back( macro );
+    }
+    D3D_SHADER_MACRO nullMacro = { nullptr, nullptr };
+    macros.push_back( nullMacro );
+
+    Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob;
+    Microsoft::WRL::ComPtr<ID3DBlob> errorBlob;
+
+    HRESULT hr = D3DCompile( source.Code.data(), source.Code.size(), source.Name.c_str(), macros.data(), nullptr,
+        source.EntryPoint.c_str(), source.Target.c_str(), m_Flags, 0, &shaderBlob, &errorBlob );
+
+    errors.clear();
+    if ( errorBlob )
+    {
+        errors.assign( static_cast<const char*>( errorBlob->GetBufferPointer() ), errorBlob->GetBufferSize() );
+    }
+
+    if ( FAILED(hr) )
+    {
+        return false;
+    }
+
+    const uint8_t* data = static_cast<const uint8_t*>( shaderBlob->GetBufferPointer() );
+    bytecode.assign( data, data + shaderBlob->GetBufferSize() );
+    return true;
+}
+
+std::string D3DShaderCompiler::get_Identifier() const
+{
+    std::ostringstream identifier;
+    identifier << "D3DCompile " << D3D_COMPILER_VERSION << " " << std::hex << m_Flags;
+    return identifier.str();
+}
@@ -0,0 +1,358 @@
+#include <DirectXTemplateLibPCH.h>
+#include <DynamicConstantBuffer.h>
+
+// Constant buffer offsets and sizes must be a multiple of 16 constants (256 bytes).
+static const UINT ConstantBufferAlignment = D3D11_COMMONSHADER_CONSTANT_BUFFER_PARTIAL_UPDATE_EXTENTS_BYTE_ALIGNMENT * 16;
+static const UINT BytesPerConstant = 16;
+
+DynamicConstantBuffer::DynamicConstantBuffer( ID3D11Device* device, UINT size )
+    : m_d3dDevice( device )
+    , m_SupportsOffsets( false )
+    , m_d3dDeviceContext( nullptr )
+    , m_Allocator( size, ConstantBufferAlignment )
+    , m_PendingOffset( 0 )
+    , m_PendingSize( 0 )
+    , m_Discard( true )
+    , m_FenceValue( 0 )
+{
+    assert( device );
+
+    // Binding constant buffers with an offset and mapping dynamic constant buffers
+    // with D3D11_MAP_WRITE_NO_OVERWRITE both require the Direct3D 11.1 runtime.
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    if ( SUCCEEDED( device->CheckFeatureSupport( D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options) ) ) )
+    {
+        m_SupportsOffsets = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+    }
+
+    UINT capacity = static_cast<UINT>( m_Allocator.get_Capacity() );
+    m_ShadowBuffer.resize( capacity );
+
+    if ( m_SupportsOffsets )
+    {
+        D3D11_BUFFER_DESC bufferDesc;
+        ZeroMemory( &bufferDesc, sizeof(D3D11_BUFFER_DESC) );
+
+        bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bufferDesc.ByteWidth = capacity;
+        bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+
+        HRESULT hr = device->CreateBuffer( &bufferDesc, nullptr, &m_d3dBuffer );
+        if ( FAILED(hr) )
+        {
+            throw std::exception( "Failed to create dynamic constant buffer." );
+        }
+    }
+
+    ZeroMemory( m_FallbackBufferSizes, sizeof(m_FallbackBufferSizes) );
+    ResetFallbackOffsets();
+    ZeroMemory( &m_Statistics, sizeof(Statistics) );
+}
+
+DynamicConstantBuffer::~DynamicConstantBuffer()
+{}
+
+bool DynamicConstantBuffer::get_SupportsOffsets() const
+{
+    return m_SupportsOffsets;
+}
+
+void DynamicConstantBuffer::BeginFrame( ID3D11DeviceContext* deviceContext )
+{
+    ZeroMemory( &m_Statistics, sizeof(Statistics) );
+    ReleaseCompletedFrames( deviceContext, false );
+
+    // The slices of the previous frames may be reallocated in this frame.
+    ResetFallbackOffsets();
+}
+
+void DynamicConstantBuffer::ResetFallbackOffsets()
+{
+    for ( UINT stage = 0; stage < NumShaderStages; ++stage )
+    {
+        for ( UINT slot = 0; slot < D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT; ++slot )
+        {
+            m_FallbackOffsets[stage][slot] = InvalidFallbackOffset;
+        }
+    }
+}
+
+void DynamicConstantBuffer::ReleaseCompletedFrames( ID3D11DeviceContext* deviceContext, bool wait )
+{
+    uint64_t completedFenceValue = 0;
+
+    while ( !m_FramesInFlight.empty() )
+    {
+        FrameFence& frame = m_FramesInFlight.front();
+
+        BOOL done = FALSE;
+        HRESULT hr = deviceContext->GetData( frame.Query.Get(), &done, sizeof(BOOL), wait ? 0 : D3D11_ASYNC_GETDATA_DONOTFLUSH );
+        while ( wait && hr == S_FALSE )
+        {
+            YieldProcessor();
+            hr = deviceContext->GetData( frame.Query.Get(), &done, sizeof(BOOL), 0 );
+        }
+
+        if ( hr != S_OK )
+        {
+            break;
+        }
+
+        completedFenceValue = frame.FenceValue;
+        m_FreeQueries.push_back( frame.Query );
+        m_FramesInFlight.pop_front();
+
+        // Only wait for the oldest frame.
+        wait = false;
+    }
+
+    if ( completedFenceValue > 0 )
+    {
+        m_Allocator.ReleaseCompletedFrames( completedFenceValue );
+    }
+}
+
+void DynamicConstantBuffer::WaitForOldestFrame( ID3D11DeviceContext* deviceContext )
+{
+    m_Statistics.Stalls++;
+    ReleaseCompletedFrames( deviceContext, true );
+}
+
+DynamicConstantBuffer::Allocation DynamicConstantBuffer::Allocate( ID3D11DeviceContext* deviceContext, size_t size )
+{
+    size_t usedSize = m_Allocator.get_UsedSize();
+    size_t offset = m_Allocator.Allocate( size );
+
+    while ( offset == RingAllocator::InvalidOffset )
+    {
+        if ( m_FramesInFlight.empty() )
+        {
+            throw std::exception( "The dynamic constant buffer is too small for the constants of a single frame." );
+        }
+
+        WaitForOldestFrame( deviceContext );
+        usedSize = m_Allocator.get_UsedSize();
+        offset = m_Allocator.Allocate( size );
+    }
+
+    size_t alignedSize = m_Allocator.AlignUp( size );
+
+    // The slices that have not been committed are contiguous (the padding
+    // that is skipped when the allocator wraps around is committed with them).
+    if ( m_PendingSize == 0 )
+    {
+        m_PendingOffset = offset;
+        m_PendingSize = alignedSize;
+    }
+    else
+    {
+        m_PendingSize += m_Allocator.get_UsedSize() - usedSize;
+    }
+
+    Allocation allocation;
+    allocation.Data = &m_ShadowBuffer[offset];
+    allocation.Offset = static_cast<UINT>( offset );
+    allocation.FirstConstant = static_cast<UINT>( offset / BytesPerConstant );
+    allocation.NumConstants = static_cast<UINT>( alignedSize / BytesPerConstant );
+
+    m_Statistics.Allocations++;
+    m_Statistics.BytesAllocated += static_cast<UINT>( alignedSize );
+
+    return allocation;
+}
+
+void DynamicConstantBuffer::Commit( ID3D11DeviceContext* deviceContext )
+{
+    if ( m_PendingSize == 0 ) return;
+
+    if ( m_SupportsOffsets )
+    {
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        HRESULT hr = deviceContext->Map( m_d3dBuffer.Get(), 0, m_Discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedResource );
+        if ( FAILED(hr) )
+        {
+            throw std::exception( "Failed to map dynamic constant buffer." );
+        }
+
+        // The pending range may wrap around the end of the buffer.
+        uint8_t* data = static_cast<uint8_t*>( mappedResource.pData );
+        size_t capacity = m_ShadowBuffer.size();
+        size_t firstSize = std::min<size_t>( m_PendingSize, capacity - m_PendingOffset );
+        memcpy( data + m_PendingOffset, &m_ShadowBuffer[m_PendingOffset], firstSize );
+        if ( firstSize < m_PendingSize )
+        {
+            memcpy( data, &m_ShadowBuffer[0], m_PendingSize - firstSize );
+        }
+
+        deviceContext->Unmap( m_d3dBuffer.Get(), 0 );
+
+        m_Discard = false;
+        m_Statistics.Maps++;
+    }
+
+    m_PendingOffset = ( m_PendingOffset + m_PendingSize ) % m_ShadowBuffer.size();
+    m_PendingSize = 0;
+}
+
+void DynamicConstantBuffer::VSSetConstantBuffer( ID3D11DeviceContext* deviceContext, UINT slot, const Allocation& allocation )
+{
+    SetConstantBuffer( deviceContext, VertexShaderStage, slot, allocation );
+}
+
+void DynamicConstantBuffer::PSSetConstantBuffer( ID3D11DeviceContext* deviceContext, UINT slot, const Allocation& allocation )
+{
+    SetConstantBuffer( deviceContext, PixelShaderStage, slot, allocation );
+}
+
+ConstantBufferBinding DynamicConstantBuffer::GetBinding( const Allocation& allocation ) const
+{
+    ConstantBufferBinding binding = { this, allocation.FirstConstant, allocation.NumConstants };
+    return binding;
+}
+
+DynamicConstantBuffer::Allocation DynamicConstantBuffer::GetAllocation( const ConstantBufferBinding& binding )
+{
+    assert( binding.Buffer == this );
+
+    Allocation allocation;
+    allocation.Offset = binding.FirstConstant * BytesPerConstant;
+    allocation.Data = &m_ShadowBuffer[allocation.Offset];
+    allocation.FirstConstant = binding.FirstConstant;
+    allocation.NumConstants = binding.NumConstants;
+
+    return allocation;
+}
+
+ConstantBufferBinding DynamicConstantBuffer::GetBufferBinding( const ConstantBufferBinding& binding ) const
+{
+    assert( binding.Buffer == this );
+    assert( m_SupportsOffsets );
+
+    ConstantBufferBinding bufferBinding = { m_d3dBuffer.Get(), binding.FirstConstant, binding.NumConstants };
+    return bufferBinding;
+}
+
+void DynamicConstantBuffer::SetConstantBuffer( ID3D11DeviceContext* deviceContext, ShaderStage stage, UINT slot, const Allocation& allocation )
+{
+    assert( slot < D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT );
+
+    if ( m_SupportsOffsets )
+    {
+        Commit( deviceContext );
+
+        if ( m_d3dDeviceContext != deviceContext )
+        {
+            m_d3dDeviceContext1.Reset();
+            deviceContext->QueryInterface<ID3D11DeviceContext1>( &m_d3dDeviceContext1 );
+            m_d3dDeviceContext = deviceContext;
+        }
+        ID3D11DeviceContext1* deviceContext1 = m_d3dDeviceContext1.Get();
+
+        ID3D11Buffer* buffer = m_d3dBuffer.Get();
+        switch ( stage )
+        {
+        case VertexShaderStage:
+            deviceContext1->VSSetConstantBuffers1( slot, 1, &buffer, &allocation.FirstConstant, &allocation.NumConstants );
+            break;
+        case PixelShaderStage:
+            deviceContext1->PSSetConstantBuffers1( slot, 1, &buffer, &allocation.FirstConstant, &allocation.NumConstants );
+            break;
+        }
+    }
+    else
+    {
+        // Copy the slice into a buffer that is only used for this slot.
+        Commit( deviceContext );
+
+        UINT size = allocation.NumConstants * BytesPerConstant;
+        Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer = m_FallbackBuffers[stage][slot];
+
+        // The slice is already in the buffer of this slot (for example the per-frame
+        // constants or a material that is shared by consecutive draws). Slices are not
+        // reused within a frame, so the contents of the buffer are still valid.
+        if ( buffer && m_FallbackOffsets[stage][slot] == allocation.Offset )
+        {
+            BindFallbackBuffer( deviceContext, stage, slot );
+            return;
+        }
+
+        if ( !buffer || m_FallbackBufferSizes[stage][slot] < size )
+        {
+            D3D11_BUFFER_DESC bufferDesc;
+            ZeroMemory( &bufferDesc, sizeof(D3D11_BUFFER_DESC) );
+
+            bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+            bufferDesc.ByteWidth = size;
+            bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+            bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+
+            buffer.Reset();
+            HRESULT hr = m_d3dDevice->CreateBuffer( &bufferDesc, nullptr, &buffer );
+            if ( FAILED(hr) )
+            {
+                throw std::exception( "Failed to create constant buffer." );
+            }
+            m_FallbackBufferSizes[stage][slot] = size;
+        }
+
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        HRESULT hr = deviceContext->Map( buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource );
+        if ( FAILED(hr) )
+        {
+            throw std::exception( "Failed to map constant buffer." );
+        }
+        memcpy( mappedResource.pData, allocation.Data, size );
+        deviceContext->Unmap( buffer.Get(), 0 );
+        m_FallbackOffsets[stage][slot] = allocation.Offset;
+        m_Statistics.Maps++;
+
+        BindFallbackBuffer( deviceContext, stage, slot );
+    }
+}
+
+void DynamicConstantBuffer::BindFallbackBuffer( ID3D11DeviceContext* deviceContext, ShaderStage stage, UINT slot )
+{
+    ID3D11Buffer* buffer = m_FallbackBuffers[stage][slot].Get();
+    switch ( stage )
+    {
+    case VertexShaderStage:
+        deviceContext->VSSetConstantBuffers( slot, 1, &buffer );
+        break;
+    case PixelShaderStage:
+        deviceContext->PSSetConstantBuffers( slot, 1, &buffer );
+        break;
+    }
+}
+
+void DynamicConstantBuffer::EndFrame( ID3D11DeviceContext* deviceContext )
+{
+    Commit( deviceContext );
+
+    Microsoft::WRL::ComPtr<ID3D11Query> query;
+    if ( !m_FreeQueries.empty() )
+    {
+        query = m_FreeQueries.back();
+        m_FreeQueries.pop_back();
+    }
+    else
+    {
+        D3D11_QUERY_DESC queryDesc = { D3D11_QUERY_EVENT, 0 };
+        HRESULT hr = m_d3dDevice->CreateQuery( &queryDesc, &query );
+        if ( FAILED(hr) )
+        {
+            throw std::exception( "Failed to create event query." );
+        }
+    }
+
+    deviceContext->End( query.Get() );
+
+    FrameFence frame = { ++m_FenceValue, query };
+    m_FramesInFlight.push_back( frame );
+    m_Allocator.FinishFrame( m_FenceValue );
+}
+
+const DynamicConstantBuffer::Statistics& DynamicConstantBuffer::get_Statistics() const
+{
+    return m_Statistics;
+}
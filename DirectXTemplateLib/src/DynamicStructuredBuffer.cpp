@@ -0,0 +1,92 @@
+#include <DirectXTemplateLibPCH.h>
+#include <DynamicStructuredBuffer.h>
+
+DynamicStructuredBuffer::DynamicStructuredBuffer( ID3D11Device* device, UINT elementSize, UINT capacity )
+    : m_d3dDevice( device )
+    , m_ElementSize( elementSize )
+    , m_Capacity( 0 )
+{
+    assert( device && elementSize % 4 == 0 );
+
+    // A buffer cannot be empty.
+    CreateBuffer( std::max<UINT>( capacity, 1 ) );
+}
+
+DynamicStructuredBuffer::~DynamicStructuredBuffer()
+{}
+
+UINT DynamicStructuredBuffer::get_ElementSize() const
+{
+    return m_ElementSize;
+}
+
+UINT DynamicStructuredBuffer::get_Capacity() const
+{
+    return m_Capacity;
+}
+
+ID3D11ShaderResourceView* DynamicStructuredBuffer::get_ShaderResourceView() const
+{
+    return m_d3dShaderResourceView.Get();
+}
+
+void DynamicStructuredBuffer::CreateBuffer( UINT capacity )
+{
+    D3D11_BUFFER_DESC bufferDesc;
+    ZeroMemory( &bufferDesc, sizeof(D3D11_BUFFER_DESC) );
+
+    bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    bufferDesc.ByteWidth = capacity * m_ElementSize;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    bufferDesc.StructureByteStride = m_ElementSize;
+
+    m_d3dShaderResourceView.Reset();
+    m_d3dBuffer.Reset();
+
+    HRESULT hr = m_d3dDevice->CreateBuffer( &bufferDesc, nullptr, &m_d3dBuffer );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create structured buffer." );
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+    ZeroMemory( &viewDesc, sizeof(D3D11_SHADER_RESOURCE_VIEW_DESC) );
+
+    viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+    viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    viewDesc.Buffer.FirstElement = 0;
+    viewDesc.Buffer.NumElements = capacity;
+
+    hr = m_d3dDevice->CreateShaderResourceView( m_d3dBuffer.Get(), &viewDesc, &m_d3dShaderResourceView );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create structured buffer view." );
+    }
+
+    m_Capacity = capacity;
+}
+
+void DynamicStructuredBuffer::Update( ID3D11DeviceContext* deviceContext, const void* elements, size_t numElements )
+{
+    if ( numElements > m_Capacity )
+    {
+        size_t capacity = std::max<size_t>( numElements, 2 * static_cast<size_t>( m_Capacity ) );
+        CreateBuffer( static_cast<UINT>( capacity ) );
+    }
+
+    if ( numElements == 0 )
+    {
+        return;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    HRESULT hr = deviceContext->Map( m_d3dBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to map structured buffer." );
+    }
+    memcpy( mappedResource.pData, elements, numElements * m_ElementSize );
+    deviceContext->Unmap( m_d3dBuffer.Get(), 0 );
+}
@@ -0,0 +1,206 @@
+#include <DirectXTemplateLibPCH.h>
+#include <GBuffer.h>
+
+namespace
+{
+    const DXGI_FORMAT TargetFormats[GBuffer::NumTargets] =
+    {
+        DXGI_FORMAT_R8G8B8A8_UNORM,     // Albedo
+        DXGI_FORMAT_R8G8B8A8_UNORM,     // Specular
+        DXGI_FORMAT_R16G16_SNORM,       // Normal
+        DXGI_FORMAT_R8G8B8A8_UNORM,     // Ambient
+    };
+
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> CreateTexture( ID3D11Device* device, UINT width, UINT height, DXGI_FORMAT format, UINT bindFlags )
+    {
+        D3D11_TEXTURE2D_DESC textureDesc;
+        ZeroMemory( &textureDesc, sizeof(D3D11_TEXTURE2D_DESC) );
+
+        textureDesc.ArraySize = 1;
+        textureDesc.BindFlags = bindFlags;
+        textureDesc.CPUAccessFlags = 0;
+        textureDesc.Format = format;
+        textureDesc.Width = width;
+        textureDesc.Height = height;
+        textureDesc.MipLevels = 1;
+        textureDesc.SampleDesc.Count = 1;
+        textureDesc.SampleDesc.Quality = 0;
+        textureDesc.Usage = D3D11_USAGE_DEFAULT;
+
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+        HRESULT hr = device->CreateTexture2D( &textureDesc, nullptr, &texture );
+        if ( FAILED(hr) )
+        {
+            throw std::exception( "Failed to create G-buffer texture." );
+        }
+        return texture;
+    }
+}
+
+GBuffer::GBuffer( ID3D11Device* device, UINT width, UINT height )
+    : m_d3dDevice( device )
+    , m_Width( 0 )
+    , m_Height( 0 )
+{
+    assert( device );
+    Resize( width, height );
+}
+
+GBuffer::~GBuffer()
+{}
+
+void GBuffer::Resize( UINT width, UINT height )
+{
+    // A texture cannot be empty.
+    width = std::max<UINT>( width, 1 );
+    height = std::max<UINT>( height, 1 );
+    if ( width == m_Width && height == m_Height )
+    {
+        return;
+    }
+
+    m_Width = width;
+    m_Height = height;
+    CreateTargets();
+}
+
+UINT GBuffer::get_Width() const
+{
+    return m_Width;
+}
+
+UINT GBuffer::get_Height() const
+{
+    return m_Height;
+}
+
+void GBuffer::CreateTargets()
+{
+    HRESULT hr;
+
+    for ( int i = 0; i < NumTargets; ++i )
+    {
+        m_d3dShaderResourceViews[i].Reset();
+        m_d3dRenderTargetViews[i].Reset();
+
+        m_d3dTargets[i] = CreateTexture( m_d3dDevice.Get(), m_Width, m_Height, TargetFormats[i], D3D11_BIND_RENDER_TARGET|D3D11_BIND_SHADER_RESOURCE );
+
+        hr = m_d3dDevice->CreateRenderTargetView( m_d3dTargets[i].Get(), nullptr, &m_d3dRenderTargetViews[i] );
+        if ( FAILED(hr) )
+        {
+            throw std::exception( "Failed to create G-buffer render target view." );
+        }
+
+        hr = m_d3dDevice->CreateShaderResourceView( m_d3dTargets[i].Get(), nullptr, &m_d3dShaderResourceViews[i] );
+        if ( FAILED(hr) )
+        {
+            throw std::exception( "Failed to create G-buffer shader resource view." );
+        }
+    }
+
+    // The depth buffer is typeless so that the lighting pass can read the depths.
+    m_d3dDepthShaderResourceView.Reset();
+    m_d3dDepthStencilView.Reset();
+    m_d3dDepthStencilBuffer = CreateTexture( m_d3dDevice.Get(), m_Width, m_Height, DXGI_FORMAT_R32_TYPELESS, D3D11_BIND_DEPTH_STENCIL|D3D11_BIND_SHADER_RESOURCE );
+
+    D3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc;
+    ZeroMemory( &depthStencilViewDesc, sizeof(D3D11_DEPTH_STENCIL_VIEW_DESC) );
+
+    depthStencilViewDesc.Format = DXGI_FORMAT_D32_FLOAT;
+    depthStencilViewDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+    depthStencilViewDesc.Texture2D.MipSlice = 0;
+
+    hr = m_d3dDevice->CreateDepthStencilView( m_d3dDepthStencilBuffer.Get(), &depthStencilViewDesc, &m_d3dDepthStencilView );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create G-buffer depth stencil view." );
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC depthViewDesc;
+    ZeroMemory( &depthViewDesc, sizeof(D3D11_SHADER_RESOURCE_VIEW_DESC) );
+
+    depthViewDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    depthViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    depthViewDesc.Texture2D.MostDetailedMip = 0;
+    depthViewDesc.Texture2D.MipLevels = 1;
+
+    hr = m_d3dDevice->CreateShaderResourceView( m_d3dDepthStencilBuffer.Get(), &depthViewDesc, &m_d3dDepthShaderResourceView );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create G-buffer depth shader resource view." );
+    }
+
+    // The output of the lighting pass is copied to the back buffer, so it has the same format.
+    m_d3dOutputUnorderedAccessView.Reset();
+    m_d3dOutputTexture = CreateTexture( m_d3dDevice.Get(), m_Width, m_Height, DXGI_FORMAT_R8G8B8A8_UNORM, D3D11_BIND_UNORDERED_ACCESS );
+
+    hr = m_d3dDevice->CreateUnorderedAccessView( m_d3dOutputTexture.Get(), nullptr, &m_d3dOutputUnorderedAccessView );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create G-buffer unordered access view." );
+    }
+}
+
+void GBuffer::Clear( ID3D11DeviceContext* deviceContext, const FLOAT clearColor[4] )
+{
+    const FLOAT black[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    for ( int i = 0; i < NumTargets; ++i )
+    {
+        deviceContext->ClearRenderTargetView( m_d3dRenderTargetViews[i].Get(), ( i == Ambient ) ? clearColor : black );
+    }
+    deviceContext->ClearDepthStencilView( m_d3dDepthStencilView.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0 );
+}
+
+void GBuffer::SetRenderTargets( ID3D11DeviceContext* deviceContext )
+{
+    ID3D11RenderTargetView* renderTargetViews[NumTargets];
+    for ( int i = 0; i < NumTargets; ++i )
+    {
+        renderTargetViews[i] = m_d3dRenderTargetViews[i].Get();
+    }
+    deviceContext->OMSetRenderTargets( NumTargets, renderTargetViews, m_d3dDepthStencilView.Get() );
+}
+
+ID3D11RenderTargetView* GBuffer::get_RenderTargetView( Target target ) const
+{
+    assert( target < NumTargets );
+    return m_d3dRenderTargetViews[target].Get();
+}
+
+ID3D11DepthStencilView* GBuffer::get_DepthStencilView() const
+{
+    return m_d3dDepthStencilView.Get();
+}
+
+ID3D11ShaderResourceView* GBuffer::get_DepthShaderResourceView() const
+{
+    return m_d3dDepthShaderResourceView.Get();
+}
+
+ID3D11ShaderResourceView* GBuffer::get_ShaderResourceView( Target target ) const
+{
+    assert( target < NumTargets );
+    return m_d3dShaderResourceViews[target].Get();
+}
+
+void GBuffer::SetComputeShaderResources( ID3D11DeviceContext* deviceContext, UINT startSlot )
+{
+    ID3D11ShaderResourceView* shaderResourceViews[NumTargets + 1];
+    shaderResourceViews[0] = m_d3dDepthShaderResourceView.Get();
+    for ( int i = 0; i < NumTargets; ++i )
+    {
+        shaderResourceViews[i + 1] = m_d3dShaderResourceViews[i].Get();
+    }
+    deviceContext->CSSetShaderResources( startSlot, NumTargets + 1, shaderResourceViews );
+}
+
+ID3D11Texture2D* GBuffer::get_OutputTexture() const
+{
+    return m_d3dOutputTexture.Get();
+}
+
+ID3D11UnorderedAccessView* GBuffer::get_OutputUnorderedAccessView() const
+{
+    return m_d3dOutputUnorderedAccessView.Get();
+}
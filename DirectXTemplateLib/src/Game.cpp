@@ -1,6 +1,13 @@
 #include <DirectXTemplateLibPCH.h>
 #include <Game.h>
 #include <Window.h>
+#include <Image.h>
+#include <D3D11CommandRecorder.h>
+#include <D3D11TimestampQueries.h>
+#include <Clock.h>
+#include <Profiler.h>
+
+#include <thread>
 
 Game::Game( Window& window )
     : m_Window( window )
@@ -10,9 +17,20 @@ Game::Game( Window& window )
     , m_d3dRenderTargetView(nullptr)
     , m_d3dDepthStencilView(nullptr)
     , m_d3dDepthStencilBuffer(nullptr)
+    , m_d3dOffscreenBuffer(nullptr)
+    , m_d3dStagingBuffer(nullptr)
     , m_d3dDepthStencilState(nullptr)
     , m_d3dRasterizerState(nullptr)
     , m_bIsInitialized( false )
+    , m_NumRecordingThreads( std::min<size_t>( std::max<size_t>( std::thread::hardware_concurrency(), 1 ), 8 ) )
+    , m_RecordingConstantBuffer( nullptr )
+    , m_bFlipModel( false )
+    , m_BufferCount( 1 )
+    , m_SwapChainFlags( 0 )
+    , m_FrameLatencyWaitableObject( nullptr )
+    , m_FrameStartTicks( 0 )
+    , m_NumJobThreads( 0 )
+    , m_bGpuProfiling( false )
 {
     m_Window.RegisterDirectXTemplate(this);
 }
@@ -122,24 +140,64 @@ bool Game::ResizeSwapChain( int width, int height )
     m_d3dRenderTargetView.Reset();
     m_d3dDepthStencilView.Reset();
     m_d3dDepthStencilBuffer.Reset();
+    m_d3dOffscreenBuffer.Reset();
+    m_d3dStagingBuffer.Reset();
 
-    // Resize the swap chain buffers.
-    m_d3dSwapChain->ResizeBuffers( 1, width, height, DXGI_FORMAT_R8G8B8A8_UNORM, 0 );
-
-    // Next initialize the back buffer of the swap chain and associate it to a 
-    // render target view.
+    HRESULT hr = 0;
     Microsoft::WRL::ComPtr<ID3D11Texture2D> backBuffer;
-    HRESULT hr = m_d3dSwapChain->GetBuffer( 0, __uuidof(ID3D11Texture2D), &backBuffer );
-    if ( FAILED( hr ) )
+
+    // The command recorders keep references to the back buffer.
+    m_ParallelRecorder.reset();
+    m_CommandRecorders.clear();
+
+    if ( m_d3dSwapChain )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to retrieve the swap chain back buffer.", "Error", MB_OK|MB_ICONERROR );
-        return false;
+        // Resize the swap chain buffers.
+        m_d3dSwapChain->ResizeBuffers( m_BufferCount, width, height, DXGI_FORMAT_R8G8B8A8_UNORM, m_SwapChainFlags );
+        // The refresh rate may have changed.
+        m_FramePacer.Reset();
+
+        // Next initialize the back buffer of the swap chain and associate it to a 
+        // render target view.
+        hr = m_d3dSwapChain->GetBuffer( 0, __uuidof(ID3D11Texture2D), &backBuffer );
+        if ( FAILED( hr ) )
+        {
+            ReportError( "Failed to retrieve the swap chain back buffer." );
+            return false;
+        }
+    }
+    else
+    {
+        // Without a swap chain (headless mode) we render into an offscreen texture
+        // that takes the place of the back buffer.
+        D3D11_TEXTURE2D_DESC offscreenBufferDesc;
+        ZeroMemory( &offscreenBufferDesc, sizeof(D3D11_TEXTURE2D_DESC) );
+
+        offscreenBufferDesc.ArraySize = 1;
+        offscreenBufferDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+        offscreenBufferDesc.CPUAccessFlags = 0;
+        offscreenBufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        offscreenBufferDesc.Width = width;
+        offscreenBufferDesc.Height = height;
+        offscreenBufferDesc.MipLevels = 1;
+        offscreenBufferDesc.SampleDesc.Count = 1;
+        offscreenBufferDesc.SampleDesc.Quality = 0;
+        offscreenBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+
+        hr = m_d3dDevice->CreateTexture2D( &offscreenBufferDesc, nullptr, &m_d3dOffscreenBuffer );
+        if ( FAILED( hr ) )
+        {
+            ReportError( "Failed to create the offscreen render target texture." );
+            return false;
+        }
+
+        backBuffer = m_d3dOffscreenBuffer;
     }
 
     hr = m_d3dDevice->CreateRenderTargetView( backBuffer.Get(), nullptr, &m_d3dRenderTargetView );
     if ( FAILED( hr ) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create the RenderTargetView.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create the RenderTargetView." );
         return false;
     }
 
@@ -163,14 +221,14 @@ bool Game::ResizeSwapChain( int width, int height )
     hr = m_d3dDevice->CreateTexture2D( &depthStencilBufferDesc, nullptr, &m_d3dDepthStencilBuffer );
     if ( FAILED(hr) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create the Depth/Stencil texture.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create the Depth/Stencil texture." );
         return false;
     }
 
     hr = m_d3dDevice->CreateDepthStencilView( m_d3dDepthStencilBuffer.Get(), nullptr, &m_d3dDepthStencilView );
     if ( FAILED(hr) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create DepthStencilView.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create DepthStencilView." );
         return false;
     }
 
@@ -178,6 +236,78 @@ bool Game::ResizeSwapChain( int width, int height )
 }
 
 
+bool Game::CreateSwapChain()
+{
+    Microsoft::WRL::ComPtr<IDXGIFactory2> factory;
+    HRESULT hr = CreateDXGIFactory( __uuidof(IDXGIFactory2), &factory );
+    if ( FAILED(hr) )
+    {
+        ReportError( "Failed to create IDXGIFactory2." );
+        return false;
+    }
+
+    DXGI_SWAP_CHAIN_DESC1 swapChainDesc;
+    ZeroMemory( &swapChainDesc, sizeof(DXGI_SWAP_CHAIN_DESC1) );
+
+    swapChainDesc.BufferCount = m_BufferCount;
+    swapChainDesc.Width = m_Window.get_ClientWidth();
+    swapChainDesc.Height = m_Window.get_ClientHeight();
+    swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    swapChainDesc.SampleDesc.Count = 1;
+    swapChainDesc.SampleDesc.Quality = 0;
+    if ( m_bFlipModel )
+    {
+        // The game waits on the frame latency waitable object before it starts a frame (see WaitForNextFrame).
+        swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+        swapChainDesc.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH | DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+        m_SwapChainFlags = swapChainDesc.Flags;
+    }
+    else
+    {
+        swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
+        swapChainDesc.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH; // Use Alt-Enter to switch between full screen and windowed mode.
+        m_SwapChainFlags = 0;
+    }
+
+    DXGI_SWAP_CHAIN_FULLSCREEN_DESC swapChainFullScreenDesc;
+    ZeroMemory( &swapChainFullScreenDesc, sizeof(DXGI_SWAP_CHAIN_FULLSCREEN_DESC) );
+
+    swapChainFullScreenDesc.RefreshRate = QueryRefreshRate( m_Window );
+    swapChainFullScreenDesc.Windowed = m_Window.get_Windowed();
+
+    hr = factory->CreateSwapChainForHwnd( m_d3dDevice.Get(), m_Window.get_WindowHandle(), 
+        &swapChainDesc, &swapChainFullScreenDesc, nullptr, &m_d3dSwapChain );
+
+    if ( FAILED(hr) )
+    {
+        ReportError( "Failed to create swap chain." );
+        return false;
+    }
+
+    if ( m_bFlipModel )
+    {
+        Microsoft::WRL::ComPtr<IDXGISwapChain2> swapChain2;
+        hr = m_d3dSwapChain.As( &swapChain2 );
+        if ( FAILED(hr) )
+        {
+            ReportError( "Failed to query the IDXGISwapChain2 interface." );
+            return false;
+        }
+
+        swapChain2->SetMaximumFrameLatency( m_FramePacer.get_Settings().MaxFrameLatency );
+        m_FrameLatencyWaitableObject = swapChain2->GetFrameLatencyWaitableObject();
+    }
+
+    if ( !ResizeSwapChain( m_Window.get_ClientWidth(), m_Window.get_ClientHeight() ) )
+    {
+        ReportError( "Failed to resize the swap chain." );
+        return false;
+    }
+
+    return true;
+}
+
 bool Game::Initialize()
 {
     if ( !m_Window.IsValid() )
@@ -195,7 +325,7 @@ bool Game::Initialize()
     // Check for DirectX Math library support.
     if ( !DirectX::XMVerifyCPUSupport() )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to verify DirectX Math library support.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to verify DirectX Math library support." );
         return false;
     }
 
@@ -233,51 +363,32 @@ bool Game::Initialize()
             D3D11_SDK_VERSION, &m_d3dDevice, &featureLevel, &m_d3dDeviceContext );
     }
 
-    if ( FAILED(hr) )
+    if ( FAILED(hr) && m_Window.IsHeadless() )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create DirectX 11 Device.", "Error", MB_OK|MB_ICONERROR );
-        return false;
+        // Build machines don't always have a GPU. In headless mode fall back
+        // to the WARP software rasterizer.
+        hr = D3D11CreateDevice( nullptr, D3D_DRIVER_TYPE_WARP, 
+            nullptr, createDeviceFlags, &featureLevels[1], _countof(featureLevels) - 1, 
+            D3D11_SDK_VERSION, &m_d3dDevice, &featureLevel, &m_d3dDeviceContext );
     }
 
-    Microsoft::WRL::ComPtr<IDXGIFactory2> factory;
-    hr = CreateDXGIFactory( __uuidof(IDXGIFactory2), &factory );
     if ( FAILED(hr) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create IDXGIFactory2.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create DirectX 11 Device." );
         return false;
     }
 
-    DXGI_SWAP_CHAIN_DESC1 swapChainDesc;
-    ZeroMemory( &swapChainDesc, sizeof(DXGI_SWAP_CHAIN_DESC1) );
-
-    swapChainDesc.BufferCount = 1;
-    swapChainDesc.Width = m_Window.get_ClientWidth();
-    swapChainDesc.Height = m_Window.get_ClientHeight();
-    swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    swapChainDesc.SampleDesc.Count = 1;
-    swapChainDesc.SampleDesc.Quality = 0;
-    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
-    swapChainDesc.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH; // Use Alt-Enter to switch between full screen and windowed mode.
-
-    DXGI_SWAP_CHAIN_FULLSCREEN_DESC swapChainFullScreenDesc;
-    ZeroMemory( &swapChainFullScreenDesc, sizeof(DXGI_SWAP_CHAIN_FULLSCREEN_DESC) );
-
-    swapChainFullScreenDesc.RefreshRate = QueryRefreshRate( m_Window );
-    swapChainFullScreenDesc.Windowed = m_Window.get_Windowed();
-
-    hr = factory->CreateSwapChainForHwnd( m_d3dDevice.Get(), m_Window.get_WindowHandle(), 
-        &swapChainDesc, &swapChainFullScreenDesc, nullptr, &m_d3dSwapChain );
-
-    if ( FAILED(hr) )
+    if ( m_Window.IsHeadless() )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create swap chain.", "Error", MB_OK|MB_ICONERROR );
-        return false;
+        // Headless windows render to an offscreen render target instead of a swap chain.
+        if ( !ResizeSwapChain( m_Window.get_ClientWidth(), m_Window.get_ClientHeight() ) )
+        {
+            ReportError( "Failed to create the offscreen render target." );
+            return false;
+        }
     }
-
-    if ( !ResizeSwapChain( m_Window.get_ClientWidth(), m_Window.get_ClientHeight() ) )
+    else if ( !CreateSwapChain() )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to resize the swap chain.", "Error", MB_OK|MB_ICONERROR );
         return false;
     }
 
@@ -293,7 +404,7 @@ bool Game::Initialize()
     hr = m_d3dDevice->CreateDepthStencilState( &depthStencilStateDesc, &m_d3dDepthStencilState );
     if ( FAILED(hr) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create a DepthStencilState object.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create a DepthStencilState object." );
         return false;
     }
 
@@ -316,17 +427,46 @@ bool Game::Initialize()
     hr = m_d3dDevice->CreateRasterizerState( &rasterizerDesc, &m_d3dRasterizerState );
     if ( FAILED(hr) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create a RasterizerState object.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create a RasterizerState object." );
         return false;
     }
 
     ZeroMemory( &m_PresentParameters, sizeof(DXGI_PRESENT_PARAMETERS) );
 
+    if ( m_bGpuProfiling )
+    {
+        try
+        {
+            m_TimestampQueries.reset( new D3D11TimestampQueries( m_d3dDevice.Get(), m_d3dDeviceContext.Get() ) );
+            m_GpuProfiler.reset( new GpuProfiler( *m_TimestampQueries ) );
+        }
+        catch ( const std::exception& e )
+        {
+            ReportError( e.what() );
+            return false;
+        }
+        m_GpuProfiler->BeginFrame();
+    }
+
     m_bIsInitialized = true;
 
     return true;
 }
 
+void Game::ReportError( const char* message ) const
+{
+    // Headless windows don't have a desktop to display a message box,
+    // so the error is written to the error stream instead.
+    if ( m_Window.IsHeadless() )
+    {
+        std::cerr << "Error: " << message << std::endl;
+    }
+    else
+    {
+        MessageBoxA( m_Window.get_WindowHandle(), message, "Error", MB_OK|MB_ICONERROR );
+    }
+}
+
 void Game::Clear( const FLOAT clearColor[4], FLOAT clearDepth, UINT8 clearStencil )
 {
     assert( m_d3dDeviceContext );
@@ -336,18 +476,305 @@ void Game::Clear( const FLOAT clearColor[4], FLOAT clearDepth, UINT8 clearStenci
 
 void Game::Present()
 {
-    if ( m_Window.get_VSync() )
+    PROFILE_SCOPE( "Present" );
+
+    if ( m_GpuProfiler )
+    {
+        m_GpuProfiler->EndFrame();
+    }
+
+    if ( !m_d3dSwapChain )
     {
-        m_d3dSwapChain->Present1( 1, 0, &m_PresentParameters );
+        // In headless mode there is nothing to present. Submit the
+        // queued commands so the GPU keeps up with the CPU.
+        m_d3dDeviceContext->Flush();
     }
     else
     {
-        m_d3dSwapChain->Present1( 0, 0, &m_PresentParameters  );
+        if ( m_Window.get_VSync() )
+        {
+            m_d3dSwapChain->Present1( 1, 0, &m_PresentParameters );
+        }
+        else
+        {
+            m_d3dSwapChain->Present1( 0, 0, &m_PresentParameters  );
+        }
+
+        if ( m_FrameLatencyWaitableObject )
+        {
+            m_FramePacer.AddFrameTime( Clock::TicksToSeconds( Clock::GetTicks() - m_FrameStartTicks ) );
+        }
+    }
+
+    if ( m_GpuProfiler )
+    {
+        m_GpuProfiler->BeginFrame();
     }
 }
 
+// Sleep until shortly before the time and spin for the rest (Sleep is not precise enough).
+static void WaitUntil( int64_t ticks )
+{
+    const int64_t spinTicks = Clock::SecondsToTicks( 0.002 );
+    for ( int64_t now = Clock::GetTicks(); now < ticks; now = Clock::GetTicks() )
+    {
+        if ( ticks - now > spinTicks )
+        {
+            Sleep( 1 );
+        }
+        else
+        {
+            YieldProcessor();
+        }
+    }
+}
+
+void Game::WaitForNextFrame()
+{
+    if ( !m_FrameLatencyWaitableObject )
+    {
+        return;
+    }
+
+    // Time out so the game does not hang if no frames are displayed.
+    WaitForSingleObjectEx( m_FrameLatencyWaitableObject, 1000, TRUE );
+
+    // SyncQPCTime uses the same time base as the Clock.
+    DXGI_FRAME_STATISTICS frameStatistics;
+    if ( SUCCEEDED( m_d3dSwapChain->GetFrameStatistics( &frameStatistics ) ) )
+    {
+        m_FramePacer.AddVBlank( frameStatistics.SyncRefreshCount, Clock::TicksToSeconds( frameStatistics.SyncQPCTime.QuadPart ) );
+    }
+
+    int64_t now = Clock::GetTicks();
+    double delay = m_FramePacer.GetStartDelay( Clock::TicksToSeconds( now ) );
+    if ( delay > 0.0 )
+    {
+        WaitUntil( now + Clock::SecondsToTicks( delay ) );
+    }
+
+    m_FrameStartTicks = Clock::GetTicks();
+}
+
+void Game::set_FlipModel( bool flipModel, UINT bufferCount )
+{
+    assert( !m_d3dSwapChain && "Set the swap model before the game is initialized." );
+
+    m_bFlipModel = flipModel;
+    m_BufferCount = flipModel ? std::max<UINT>( bufferCount, 2 ) : 1;
+}
+
+bool Game::get_FlipModel() const
+{
+    return m_bFlipModel;
+}
+
+UINT Game::get_BufferCount() const
+{
+    return m_BufferCount;
+}
+
+const FramePacingSettings& Game::get_FramePacing() const
+{
+    return m_FramePacer.get_Settings();
+}
+
+void Game::set_FramePacing( const FramePacingSettings& settings )
+{
+    m_FramePacer.set_Settings( settings );
+
+    Microsoft::WRL::ComPtr<IDXGISwapChain2> swapChain2;
+    if ( m_FrameLatencyWaitableObject && SUCCEEDED( m_d3dSwapChain.As( &swapChain2 ) ) )
+    {
+        swapChain2->SetMaximumFrameLatency( settings.MaxFrameLatency );
+    }
+}
+
+void Game::set_GpuProfiling( bool gpuProfiling )
+{
+    m_bGpuProfiling = gpuProfiling;
+}
+
+bool Game::get_GpuProfiling() const
+{
+    return m_bGpuProfiling;
+}
+
+GpuProfiler* Game::get_GpuProfiler()
+{
+    return m_GpuProfiler.get();
+}
+
+bool Game::ReadBackBuffer( std::vector<uint8_t>& pixels, UINT& width, UINT& height )
+{
+    if ( !m_d3dRenderTargetView )
+    {
+        return false;
+    }
+
+    Microsoft::WRL::ComPtr<ID3D11Resource> backBuffer;
+    m_d3dRenderTargetView->GetResource( &backBuffer );
+
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> backBufferTexture;
+    HRESULT hr = backBuffer.As( &backBufferTexture );
+    if ( FAILED(hr) )
+    {
+        return false;
+    }
+
+    D3D11_TEXTURE2D_DESC textureDesc;
+    backBufferTexture->GetDesc( &textureDesc );
+
+    // The staging texture is created on first use and released when the buffers are resized.
+    if ( !m_d3dStagingBuffer )
+    {
+        D3D11_TEXTURE2D_DESC stagingBufferDesc = textureDesc;
+        stagingBufferDesc.BindFlags = 0;
+        stagingBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        stagingBufferDesc.MiscFlags = 0;
+        stagingBufferDesc.Usage = D3D11_USAGE_STAGING;
+
+        hr = m_d3dDevice->CreateTexture2D( &stagingBufferDesc, nullptr, &m_d3dStagingBuffer );
+        if ( FAILED(hr) )
+        {
+            ReportError( "Failed to create the staging texture for back buffer read back." );
+            return false;
+        }
+    }
+
+    m_d3dDeviceContext->CopyResource( m_d3dStagingBuffer.Get(), backBufferTexture.Get() );
+
+    // Mapping the staging texture waits for the GPU to finish rendering.
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    hr = m_d3dDeviceContext->Map( m_d3dStagingBuffer.Get(), 0, D3D11_MAP_READ, 0, &mappedResource );
+    if ( FAILED(hr) )
+    {
+        return false;
+    }
+
+    width = textureDesc.Width;
+    height = textureDesc.Height;
+
+    const UINT rowPitch = width * 4;
+    pixels.resize( rowPitch * height );
+
+    const uint8_t* pSrc = static_cast<const uint8_t*>( mappedResource.pData );
+    for ( UINT y = 0; y < height; ++y )
+    {
+        memcpy( &pixels[y * rowPitch], pSrc + y * mappedResource.RowPitch, rowPitch );
+    }
+
+    m_d3dDeviceContext->Unmap( m_d3dStagingBuffer.Get(), 0 );
+
+    return true;
+}
+
+bool Game::SaveBackBuffer( const std::string& fileName )
+{
+    std::vector<uint8_t> pixels;
+    UINT width, height;
+    if ( !ReadBackBuffer( pixels, width, height ) )
+    {
+        return false;
+    }
+
+    return SaveTGA( fileName, width, height, pixels.data() );
+}
+
+size_t Game::get_NumRecordingThreads() const
+{
+    return m_NumRecordingThreads;
+}
+
+void Game::set_NumRecordingThreads( size_t numThreads )
+{
+    numThreads = std::max<size_t>( numThreads, 1 );
+    if ( numThreads != m_NumRecordingThreads )
+    {
+        // The recorders are created again on the next call to RecordCommandLists.
+        m_ParallelRecorder.reset();
+        m_CommandRecorders.clear();
+        m_NumRecordingThreads = numThreads;
+    }
+}
+
+void Game::CreateCommandRecorders( DynamicConstantBuffer* dynamicConstantBuffer )
+{
+    assert( m_d3dDevice );
+
+    // Stop the recording threads before their deferred contexts are released.
+    m_ParallelRecorder.reset();
+    m_CommandRecorders.clear();
+
+    std::vector<CommandRecorder*> recorders;
+    for ( size_t i = 0; i < m_NumRecordingThreads; ++i )
+    {
+        m_CommandRecorders.push_back( std::unique_ptr<D3D11CommandRecorder>( new D3D11CommandRecorder( m_d3dDevice.Get(), m_d3dDeviceContext.Get(), dynamicConstantBuffer ) ) );
+        recorders.push_back( m_CommandRecorders.back().get() );
+    }
+
+    m_ParallelRecorder.reset( new ParallelCommandRecorder( recorders ) );
+    m_RecordingConstantBuffer = dynamicConstantBuffer;
+}
+
+void Game::RecordCommandLists( size_t numItems, const ParallelCommandRecorder::RecordFunction& record, DynamicConstantBuffer* dynamicConstantBuffer )
+{
+    PROFILE_SCOPE( "RecordCommandLists" );
+
+    if ( !m_ParallelRecorder || m_RecordingConstantBuffer != dynamicConstantBuffer )
+    {
+        CreateCommandRecorders( dynamicConstantBuffer );
+    }
+
+    for ( std::unique_ptr<D3D11CommandRecorder>& recorder : m_CommandRecorders )
+    {
+        recorder->CopyInitialState( m_d3dDeviceContext.Get() );
+    }
+
+    m_ParallelRecorder->Record( numItems, record );
+
+    PROFILE_SCOPE( "ExecuteCommandLists" );
+    m_ParallelRecorder->Execute();
+}
+
+size_t Game::get_NumJobThreads() const
+{
+    return m_NumJobThreads;
+}
+
+void Game::set_NumJobThreads( size_t numThreads )
+{
+    if ( numThreads != m_NumJobThreads )
+    {
+        // The job system is created again on the next call to get_JobSystem.
+        m_JobSystem.reset();
+        m_NumJobThreads = numThreads;
+    }
+}
+
+JobSystem& Game::get_JobSystem()
+{
+    if ( !m_JobSystem )
+    {
+        m_JobSystem.reset( new JobSystem( m_NumJobThreads ) );
+    }
+    return *m_JobSystem;
+}
+
 void Game::Cleanup()
 {
+    m_ParallelRecorder.reset();
+    m_CommandRecorders.clear();
+    m_JobSystem.reset();
+    m_GpuProfiler.reset();
+    m_TimestampQueries.reset();
+
+    if ( m_FrameLatencyWaitableObject )
+    {
+        CloseHandle( m_FrameLatencyWaitableObject );
+        m_FrameLatencyWaitableObject = nullptr;
+    }
+
     if ( m_d3dSwapChain )
     {
         // Before we shutdown, exit the fullscreen state. If we shutdown while we are 
@@ -398,7 +825,7 @@ void Game::OnMouseWheel( MouseWheelEventArgs& e )
 
 void Game::OnResize( ResizeEventArgs& e )
 {
-    assert( m_d3dSwapChain );
+    assert( m_d3dDevice );
     ResizeSwapChain( e.Width, e.Height );
 }
 
@@ -0,0 +1,266 @@
+#include <DirectXTemplateLibPCH.h>
+#include <LightBuffer.h>
+
+// The staging ring only needs the alignment of the Light struct members.
+static const size_t StagingAlignment = 16;
+static_assert( sizeof(Light) % StagingAlignment == 0, "The staging ring must hold a whole number of lights." );
+
+LightBuffer::LightBuffer( ID3D11Device* device, UINT capacity, UINT stagingSize )
+    : m_d3dDevice( device )
+    , m_Capacity( 0 )
+    , m_SupportsNoOverwrite( false )
+    // The size of a structured buffer must be a multiple of the stride.
+    , m_Allocator( stagingSize - stagingSize % sizeof(Light), StagingAlignment )
+    , m_Discard( true )
+    , m_FenceValue( 0 )
+{
+    assert( device );
+
+    // Mapping a dynamic structured buffer with D3D11_MAP_WRITE_NO_OVERWRITE requires the Direct3D 11.1 runtime.
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    if ( SUCCEEDED( device->CheckFeatureSupport( D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options) ) ) )
+    {
+        m_SupportsNoOverwrite = options.MapNoOverwriteOnDynamicBufferSRV != FALSE;
+    }
+
+    if ( m_SupportsNoOverwrite )
+    {
+        D3D11_BUFFER_DESC bufferDesc;
+        ZeroMemory( &bufferDesc, sizeof(D3D11_BUFFER_DESC) );
+
+        bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        bufferDesc.ByteWidth = static_cast<UINT>( m_Allocator.get_Capacity() );
+        bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+        bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        bufferDesc.StructureByteStride = sizeof(Light);
+
+        HRESULT hr = device->CreateBuffer( &bufferDesc, nullptr, &m_d3dStagingBuffer );
+        if ( FAILED(hr) )
+        {
+            throw std::exception( "Failed to create light staging buffer." );
+        }
+    }
+
+    // A buffer cannot be empty.
+    CreateBuffer( std::max<UINT>( capacity, 1 ) );
+
+    ZeroMemory( &m_Statistics, sizeof(Statistics) );
+}
+
+LightBuffer::~LightBuffer()
+{}
+
+UINT LightBuffer::get_Capacity() const
+{
+    return m_Capacity;
+}
+
+bool LightBuffer::get_SupportsNoOverwrite() const
+{
+    return m_SupportsNoOverwrite;
+}
+
+ID3D11ShaderResourceView* LightBuffer::get_ShaderResourceView() const
+{
+    return m_d3dShaderResourceView.Get();
+}
+
+const LightBuffer::Statistics& LightBuffer::get_Statistics() const
+{
+    return m_Statistics;
+}
+
+void LightBuffer::CreateBuffer( UINT capacity )
+{
+    D3D11_BUFFER_DESC bufferDesc;
+    ZeroMemory( &bufferDesc, sizeof(D3D11_BUFFER_DESC) );
+
+    bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    bufferDesc.ByteWidth = capacity * sizeof(Light);
+    bufferDesc.CPUAccessFlags = 0;
+    bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+    bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    bufferDesc.StructureByteStride = sizeof(Light);
+
+    m_d3dShaderResourceView.Reset();
+    m_d3dBuffer.Reset();
+
+    HRESULT hr = m_d3dDevice->CreateBuffer( &bufferDesc, nullptr, &m_d3dBuffer );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create light buffer." );
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+    ZeroMemory( &viewDesc, sizeof(D3D11_SHADER_RESOURCE_VIEW_DESC) );
+
+    viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+    viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    viewDesc.Buffer.FirstElement = 0;
+    viewDesc.Buffer.NumElements = capacity;
+
+    hr = m_d3dDevice->CreateShaderResourceView( m_d3dBuffer.Get(), &viewDesc, &m_d3dShaderResourceView );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create light buffer view." );
+    }
+
+    m_Capacity = capacity;
+}
+
+void LightBuffer::ReleaseCompletedFrames( ID3D11DeviceContext* deviceContext, bool wait )
+{
+    uint64_t completedFenceValue = 0;
+
+    while ( !m_FramesInFlight.empty() )
+    {
+        FrameFence& frame = m_FramesInFlight.front();
+
+        BOOL done = FALSE;
+        HRESULT hr = deviceContext->GetData( frame.Query.Get(), &done, sizeof(BOOL), wait ? 0 : D3D11_ASYNC_GETDATA_DONOTFLUSH );
+        while ( wait && hr == S_FALSE )
+        {
+            YieldProcessor();
+            hr = deviceContext->GetData( frame.Query.Get(), &done, sizeof(BOOL), 0 );
+        }
+
+        if ( hr != S_OK )
+        {
+            break;
+        }
+
+        completedFenceValue = frame.FenceValue;
+        m_FreeQueries.push_back( frame.Query );
+        m_FramesInFlight.pop_front();
+
+        // Only wait for the oldest frame.
+        wait = false;
+    }
+
+    if ( completedFenceValue > 0 )
+    {
+        m_Allocator.ReleaseCompletedFrames( completedFenceValue );
+    }
+}
+
+size_t LightBuffer::AllocateStaging( ID3D11DeviceContext* deviceContext, size_t size )
+{
+    ReleaseCompletedFrames( deviceContext, false );
+
+    size_t offset = m_Allocator.Allocate( size );
+    while ( offset == RingAllocator::InvalidOffset && !m_FramesInFlight.empty() )
+    {
+        m_Statistics.Stalls++;
+        ReleaseCompletedFrames( deviceContext, true );
+        offset = m_Allocator.Allocate( size );
+    }
+    return offset;
+}
+
+void LightBuffer::Update( ID3D11DeviceContext* deviceContext, LightManager& lights )
+{
+    ZeroMemory( &m_Statistics, sizeof(Statistics) );
+
+    // A new buffer has none of the lights.
+    if ( lights.get_NumLights() > m_Capacity )
+    {
+        CreateBuffer( std::max( lights.get_NumLights(), 2 * m_Capacity ) );
+        lights.MarkAllDirty();
+    }
+
+    lights.GetDirtyRanges( m_DirtyRanges );
+
+    UINT numLights = 0;
+    for ( const LightManager::DirtyRange& range : m_DirtyRanges )
+    {
+        numLights += range.Count;
+    }
+    if ( numLights == 0 )
+    {
+        lights.ClearDirty();
+        return;
+    }
+
+    size_t size = numLights * sizeof(Light);
+    size_t offset = RingAllocator::InvalidOffset;
+    if ( m_SupportsNoOverwrite && m_Allocator.AlignUp( size ) <= m_Allocator.get_Capacity() )
+    {
+        offset = AllocateStaging( deviceContext, size );
+    }
+
+    if ( offset != RingAllocator::InvalidOffset )
+    {
+        // Write the dirty ranges one after the other to the staging ring.
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        HRESULT hr = deviceContext->Map( m_d3dStagingBuffer.Get(), 0, m_Discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedResource );
+        if ( FAILED(hr) )
+        {
+            throw std::exception( "Failed to map light staging buffer." );
+        }
+
+        Light* staging = reinterpret_cast<Light*>( static_cast<uint8_t*>( mappedResource.pData ) + offset );
+        for ( const LightManager::DirtyRange& range : m_DirtyRanges )
+        {
+            lights.WriteLights( range.Offset, range.Count, staging );
+            staging += range.Count;
+        }
+
+        deviceContext->Unmap( m_d3dStagingBuffer.Get(), 0 );
+        m_Discard = false;
+
+        // Copy each range from the ring to its place in the light buffer.
+        UINT sourceOffset = static_cast<UINT>( offset );
+        for ( const LightManager::DirtyRange& range : m_DirtyRanges )
+        {
+            UINT rangeSize = range.Count * static_cast<UINT>( sizeof(Light) );
+            D3D11_BOX sourceBox = { sourceOffset, 0, 0, sourceOffset + rangeSize, 1, 1 };
+            deviceContext->CopySubresourceRegion( m_d3dBuffer.Get(), 0, range.Offset * static_cast<UINT>( sizeof(Light) ), 0, 0, m_d3dStagingBuffer.Get(), 0, &sourceBox );
+            sourceOffset += rangeSize;
+        }
+    }
+    else
+    {
+        for ( const LightManager::DirtyRange& range : m_DirtyRanges )
+        {
+            m_UploadLights.resize( range.Count );
+            lights.WriteLights( range.Offset, range.Count, m_UploadLights.data() );
+
+            D3D11_BOX destinationBox = { range.Offset * static_cast<UINT>( sizeof(Light) ), 0, 0, ( range.Offset + range.Count ) * static_cast<UINT>( sizeof(Light) ), 1, 1 };
+            deviceContext->UpdateSubresource( m_d3dBuffer.Get(), 0, &destinationBox, m_UploadLights.data(), 0, 0 );
+        }
+    }
+
+    m_Statistics.UploadedLights = numLights;
+    m_Statistics.UploadedBytes = static_cast<UINT>( size );
+    m_Statistics.Copies = static_cast<UINT>( m_DirtyRanges.size() );
+
+    lights.ClearDirty();
+}
+
+void LightBuffer::EndFrame( ID3D11DeviceContext* deviceContext )
+{
+    if ( !m_SupportsNoOverwrite ) return;
+
+    Microsoft::WRL::ComPtr<ID3D11Query> query;
+    if ( !m_FreeQueries.empty() )
+    {
+        query = m_FreeQueries.back();
+        m_FreeQueries.pop_back();
+    }
+    else
+    {
+        D3D11_QUERY_DESC queryDesc = { D3D11_QUERY_EVENT, 0 };
+        HRESULT hr = m_d3dDevice->CreateQuery( &queryDesc, &query );
+        if ( FAILED(hr) )
+        {
+            throw std::exception( "Failed to create event query." );
+        }
+    }
+
+    deviceContext->End( query.Get() );
+
+    FrameFence frame = { ++m_FenceValue, query };
+    m_FramesInFlight.push_back( frame );
+    m_Allocator.FinishFrame( m_FenceValue );
+}
@@ -1,18 +1,46 @@
 #include <DirectXTemplateLibPCH.h>
 #include <Mesh.h>
 
-using namespace DirectX;
+#include <MeshOptimizer.h>
+#include <Profiler.h>
+
+static_assert( Mesh::FullPrecisionVertices == static_cast<int>( MeshVertexLayoutFullPrecision ) &&
+               Mesh::HalfPrecisionVertices == static_cast<int>( MeshVertexLayoutHalfPrecision ) &&
+               Mesh::QuantizedVertices == static_cast<int>( MeshVertexLayoutQuantized ),
+               "Mesh::VertexFormat must match MeshVertexLayout." );
+
 using namespace Microsoft::WRL;
 
-const D3D11_INPUT_ELEMENT_DESC VertexPositionNormalTexture::InputElements[] =
+const D3D11_INPUT_ELEMENT_DESC VertexInputLayout<VertexPositionNormalTexture>::InputElements[] =
 {
     { "POSITION",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
     { "NORMAL",     0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
     { "TEXCOORD",   0, DXGI_FORMAT_R32G32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 };
 
+const D3D11_INPUT_ELEMENT_DESC VertexInputLayout<VertexPositionNormalTextureHalf>::InputElements[] =
+{
+    { "POSITION",   0, DXGI_FORMAT_R16G16B16A16_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "NORMAL",     0, DXGI_FORMAT_R16G16_SNORM,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD",   0, DXGI_FORMAT_R16G16_UNORM,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+};
+
+const D3D11_INPUT_ELEMENT_DESC VertexInputLayout<VertexPositionNormalTextureQuantized>::InputElements[] =
+{
+    { "POSITION",   0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "NORMAL",     0, DXGI_FORMAT_R16G16_SNORM,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD",   0, DXGI_FORMAT_R16G16_UNORM,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+};
+
+MeshCache* Mesh::ms_Cache = nullptr;
+
 Mesh::Mesh()
-    : m_IndexCount( 0 )
+    : m_IndexFormat( DXGI_FORMAT_R16_UINT )
+    , m_VertexFormat( FullPrecisionVertices )
+    , m_VertexStride( sizeof(VertexPositionNormalTexture) )
+    , m_PositionDequantization( Math::MatrixIdentity() )
+    , m_BoundingBox( Math::Float3( 0, 0, 0 ), Math::Float3( 0, 0, 0 ) )
+    , m_BoundingSphere( Math::Float3( 0, 0, 0 ), 0 )
 {}
 
 Mesh::~Mesh()
@@ -20,348 +48,385 @@ Mesh::~Mesh()
     // Allocated resources will be cleaned automatically when the pointers go out of scope.
 }
 
-void Mesh::Draw( ID3D11DeviceContext* pDeviceContext )
+void Mesh::Draw( ID3D11DeviceContext* pDeviceContext, size_t lod )
 {
     assert( pDeviceContext );
 
-    const UINT strides[] = { sizeof(VertexPositionNormalTexture) };
+    const UINT strides[] = { m_VertexStride };
     const UINT offsets[] = { 0 };
 
     pDeviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
     pDeviceContext->IASetVertexBuffers( 0, 1, m_VertexBuffer.GetAddressOf(), strides, offsets );
-    pDeviceContext->IASetIndexBuffer( m_IndexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0 );
-    pDeviceContext->DrawIndexed( m_IndexCount, 0, 0 );
-}
+    pDeviceContext->IASetIndexBuffer( m_IndexBuffer.Get(), m_IndexFormat, 0 );
 
-std::unique_ptr<Mesh> Mesh::CreateSphere( ID3D11DeviceContext* pDeviceContext, float diameter, size_t tessellation, bool rhcoords )
-{
-    VertexCollection vertices;
-    IndexCollection indices;
-
-    if (tessellation < 3)
-        throw std::out_of_range("tessellation parameter out of range");
-
-    float radius = diameter / 2.0f;
-    size_t verticalSegments = tessellation;
-    size_t horizontalSegments = tessellation * 2;
-
-    // Create rings of vertices at progressively higher latitudes.
-    for (size_t i = 0; i <= verticalSegments; i++)
+    if ( !m_Lods.empty() )
     {
-        float v = 1 - (float)i / verticalSegments;
-
-        float latitude = (i * XM_PI / verticalSegments) - XM_PIDIV2;
-        float dy, dxz;
-
-        XMScalarSinCos(&dy, &dxz, latitude);
+        assert( lod < m_Lods.size() );
+        pDeviceContext->DrawIndexed( m_Lods[lod].IndexCount, m_Lods[lod].StartIndex, 0 );
+        return;
+    }
 
-        // Create a single ring of vertices at this latitude.
-        for (size_t j = 0; j <= horizontalSegments; j++)
-        {
-            float u = (float)j / horizontalSegments;
+    assert( lod == 0 );
+    for ( const SubMesh& subMesh : m_SubMeshes )
+    {
+        pDeviceContext->DrawIndexed( subMesh.IndexCount, subMesh.StartIndex, subMesh.BaseVertex );
+    }
+}
 
-            float longitude = j * XM_2PI / horizontalSegments;
-            float dx, dz;
+void Mesh::SetupDrawCommand( DrawCommand& drawCommand, size_t subMesh, size_t lod ) const
+{
+    assert( subMesh < m_SubMeshes.size() );
+    assert( lod < get_NumLods() );
 
-            XMScalarSinCos(&dx, &dz, longitude);
+    VertexBufferBinding vertexBuffer = { m_VertexBuffer.Get(), m_VertexStride, 0 };
 
-            dx *= dxz;
-            dz *= dxz;
+    drawCommand.PrimitiveTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    drawCommand.VertexBuffers[0] = vertexBuffer;
+    drawCommand.NumVertexBuffers = 1;
+    drawCommand.IndexBuffer = m_IndexBuffer.Get();
+    drawCommand.IndexFormat = m_IndexFormat;
 
-            XMVECTOR normal = XMVectorSet(dx, dy, dz, 0);
-            XMVECTOR textureCoordinate = XMVectorSet(u, v, 0, 0);
+    drawCommand.IndexCount = m_SubMeshes[subMesh].IndexCount;
+    drawCommand.InstanceCount = 0;
+    drawCommand.StartIndex = m_SubMeshes[subMesh].StartIndex;
+    drawCommand.BaseVertex = m_SubMeshes[subMesh].BaseVertex;
 
-            vertices.push_back(VertexPositionNormalTexture(normal * radius, normal, textureCoordinate));
-        }
+    if ( !m_Lods.empty() )
+    {
+        drawCommand.IndexCount = m_Lods[lod].IndexCount;
+        drawCommand.StartIndex = m_Lods[lod].StartIndex;
     }
+}
 
-    // Fill the index buffer with triangles joining each pair of latitude rings.
-    size_t stride = horizontalSegments + 1;
+size_t Mesh::get_NumLods() const
+{
+    return std::max<size_t>( m_Lods.size(), 1 );
+}
 
-    for (size_t i = 0; i < verticalSegments; i++)
+size_t Mesh::SelectLod( const Camera& camera, const Math::Float4x4& worldMatrix, float maxPixelError ) const
+{
+    if ( m_Lods.size() <= 1 )
     {
-        for (size_t j = 0; j <= horizontalSegments; j++)
-        {
-            size_t nextI = i + 1;
-            size_t nextJ = (j + 1) % stride;
-
-            indices.push_back(i * stride + j);
-            indices.push_back(nextI * stride + j);
-            indices.push_back(i * stride + nextJ);
-
-            indices.push_back(i * stride + nextJ);
-            indices.push_back(nextI * stride + j);
-            indices.push_back(nextI * stride + nextJ);
-        }
+        return 0;
     }
 
-    // Create the primitive object.
-    std::unique_ptr<Mesh> mesh(new Mesh());
+    // The radius of the world-space sphere is scaled by the largest scale of the
+    // world matrix, which is also the largest scale of the errors.
+    BoundingSphere worldSphere = Transform( m_BoundingSphere, worldMatrix );
+    float worldScale = ( m_BoundingSphere.Radius > 0.0f ) ? worldSphere.Radius / m_BoundingSphere.Radius : 1.0f;
 
-    mesh->Initialize( pDeviceContext, vertices, indices, rhcoords );
-
-    return mesh;
+    return ::SelectLod( m_Lods, camera, worldSphere, worldScale, maxPixelError );
 }
 
-std::unique_ptr<Mesh> Mesh::CreateCube( ID3D11DeviceContext* deviceContext, float size, bool rhcoords )
+size_t Mesh::get_NumMeshlets() const
 {
-    // A cube has six faces, each one pointing in a different direction.
-    const int FaceCount = 6;
+    return m_Meshlets.size();
+}
 
-    static const XMVECTORF32 faceNormals[FaceCount] =
-    {
-        {  0,  0,  1 },
-        {  0,  0, -1 },
-        {  1,  0,  0 },
-        { -1,  0,  0 },
-        {  0,  1,  0 },
-        {  0, -1,  0 },
-    };
-
-    static const XMVECTORF32 textureCoordinates[4] =
+size_t Mesh::CullMeshlets( const Camera& camera, const Math::Float4x4& worldMatrix, IndexRangeCollection& ranges ) const
+{
+    if ( m_Meshlets.empty() )
     {
-        { 1, 0 },
-        { 1, 1 },
-        { 0, 1 },
-        { 0, 0 },
-    };
-
-    VertexCollection vertices;
-    IndexCollection indices;
+        // Without meshlets the whole mesh (or its first LOD) is drawn.
+        IndexRange range = { m_SubMeshes[0].StartIndex, m_SubMeshes[0].IndexCount };
+        if ( !m_Lods.empty() )
+        {
+            range.StartIndex = m_Lods[0].StartIndex;
+            range.IndexCount = m_Lods[0].IndexCount;
+        }
+        ranges.assign( 1, range );
+        return range.IndexCount;
+    }
 
-    size /= 2;
+    // Cull in object space so the bounds of the meshlets do not have to be transformed.
+    Frustum frustum( worldMatrix * camera.get_ViewMatrix() * camera.get_ProjectionMatrix() );
+    Math::Float3 eye = Math::TransformPoint( camera.get_Translation(), Math::MatrixInverse( worldMatrix ) );
 
-    // Create each face in turn.
-    for (int i = 0; i < FaceCount; i++)
-    {
-        XMVECTOR normal = faceNormals[i];
-
-        // Get two vectors perpendicular both to the face normal and to each other.
-        XMVECTOR basis = (i >= 4) ? g_XMIdentityR2 : g_XMIdentityR1;
+    ::CullMeshlets( m_MeshletBounds, frustum, eye, m_VisibleMeshlets );
+    return GetIndexRanges( m_Meshlets, m_VisibleMeshlets, ranges );
+}
 
-        XMVECTOR side1 = XMVector3Cross(normal, basis);
-        XMVECTOR side2 = XMVector3Cross(normal, side1);
+void Mesh::Draw( ID3D11DeviceContext* pDeviceContext, const IndexRangeCollection& ranges )
+{
+    assert( pDeviceContext );
+    assert( m_SubMeshes.size() == 1 );
 
-        // Six indices (two triangles) per face.
-        size_t vbase = vertices.size();
-        indices.push_back(vbase + 0);
-        indices.push_back(vbase + 1);
-        indices.push_back(vbase + 2);
+    const UINT strides[] = { m_VertexStride };
+    const UINT offsets[] = { 0 };
 
-        indices.push_back(vbase + 0);
-        indices.push_back(vbase + 2);
-        indices.push_back(vbase + 3);
+    pDeviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+    pDeviceContext->IASetVertexBuffers( 0, 1, m_VertexBuffer.GetAddressOf(), strides, offsets );
+    pDeviceContext->IASetIndexBuffer( m_IndexBuffer.Get(), m_IndexFormat, 0 );
 
-        // Four vertices per face.
-        vertices.push_back(VertexPositionNormalTexture((normal - side1 - side2) * size, normal, textureCoordinates[0]));
-        vertices.push_back(VertexPositionNormalTexture((normal - side1 + side2) * size, normal, textureCoordinates[1]));
-        vertices.push_back(VertexPositionNormalTexture((normal + side1 + side2) * size, normal, textureCoordinates[2]));
-        vertices.push_back(VertexPositionNormalTexture((normal + side1 - side2) * size, normal, textureCoordinates[3]));
+    for ( const IndexRange& range : ranges )
+    {
+        pDeviceContext->DrawIndexed( range.IndexCount, range.StartIndex, 0 );
     }
+}
 
-    // Create the primitive object.
-    std::unique_ptr<Mesh> mesh(new Mesh());
+void Mesh::SetupDrawCommand( DrawCommand& drawCommand, const IndexRange& range ) const
+{
+    assert( m_SubMeshes.size() == 1 );
 
-    mesh->Initialize(deviceContext, vertices, indices, rhcoords);
+    SetupDrawCommand( drawCommand );
+    drawCommand.IndexCount = range.IndexCount;
+    drawCommand.StartIndex = range.StartIndex;
+}
 
-    return mesh;
+size_t Mesh::get_NumSubMeshes() const
+{
+    return m_SubMeshes.size();
 }
 
-// Helper computes a point on a unit circle, aligned to the x/z plane and centered on the origin.
-static inline XMVECTOR GetCircleVector(size_t i, size_t tessellation)
+DXGI_FORMAT Mesh::get_IndexFormat() const
 {
-    float angle = i * XM_2PI / tessellation;
-    float dx, dz;
+    return m_IndexFormat;
+}
 
-    XMScalarSinCos(&dx, &dz, angle);
+Mesh::VertexFormat Mesh::get_VertexFormat() const
+{
+    return m_VertexFormat;
+}
 
-    XMVECTORF32 v = { dx, 0, dz, 0 };
-    return v;
+const Math::Float4x4& Mesh::get_PositionDequantization() const
+{
+    return m_PositionDequantization;
 }
 
-static inline XMVECTOR GetCircleTangent(size_t i, size_t tessellation)
+const BoundingBox& Mesh::get_BoundingBox() const
 {
-    float angle = ( i * XM_2PI / tessellation ) + XM_PIDIV2;
-    float dx, dz;
+    return m_BoundingBox;
+}
 
-    XMScalarSinCos(&dx, &dz, angle);
+const BoundingSphere& Mesh::get_BoundingSphere() const
+{
+    return m_BoundingSphere;
+}
 
-    XMVECTORF32 v = { dx, 0, dz, 0 };
-    return v;
+void Mesh::set_Cache( MeshCache* cache )
+{
+    ms_Cache = cache;
 }
 
-// Helper creates a triangle fan to close the end of a cylinder / cone
-static void CreateCylinderCap(VertexCollection& vertices, IndexCollection& indices, size_t tessellation, float height, float radius, bool isTop)
+MeshCache* Mesh::get_Cache()
 {
-    // Create cap indices.
-    for (size_t i = 0; i < tessellation - 2; i++)
-    {
-        size_t i1 = (i + 1) % tessellation;
-        size_t i2 = (i + 2) % tessellation;
+    return ms_Cache;
+}
 
-        if (isTop)
-        {
-            std::swap(i1, i2);
-        }
+std::unique_ptr<Mesh> Mesh::CreateSphere( ID3D11DeviceContext* deviceContext, float diameter, size_t tessellation, bool rhcoords, VertexFormat vertexFormat, size_t maxLods, bool buildMeshlets )
+{
+    PROFILE_SCOPE( "CreateSphere" );
+
+    MeshCacheKey key( "Sphere" );
+    key.Add( diameter ).Add( tessellation ).Add( rhcoords ).Add( vertexFormat ).Add( maxLods ).Add( buildMeshlets );
 
-        size_t vbase = vertices.size();
-        indices.push_back(vbase);
-        indices.push_back(vbase + i1);
-        indices.push_back(vbase + i2);
+    std::unique_ptr<Mesh> mesh = CreateFromCache( deviceContext, key );
+    if ( mesh )
+    {
+        return mesh;
     }
 
-    // Which end of the cylinder is this?
-    XMVECTOR normal = g_XMIdentityR1;
-    XMVECTOR textureScale = g_XMNegativeOneHalf;
+    VertexCollection vertices;
+    IndexCollection indices;
+
+    BoundingBox boundingBox;
+    BoundingSphere boundingSphere;
+
+    ComputeSphere( vertices, indices, diameter, tessellation, rhcoords );
+    ComputeSphereBounds( boundingBox, boundingSphere, diameter );
+
+    OptimizeMesh( vertices, indices );
 
-    if (!isTop)
+    // The meshlets reorder the triangles of the first LOD so they are built first.
+    MeshletCollection meshlets;
+    if ( buildMeshlets )
     {
-        normal = -normal;
-        textureScale *= g_XMNegateX;
+        BuildMeshlets( vertices, indices, meshlets );
     }
 
-    // Create cap vertices.
-    for (size_t i = 0; i < tessellation; i++)
+    MeshLodCollection lods;
+    if ( maxLods > 1 )
     {
-        XMVECTOR circleVector = GetCircleVector(i, tessellation);
+        GenerateLods( vertices, indices, lods, maxLods );
+    }
 
-        XMVECTOR position = (circleVector * radius) + (normal * height);
+    return Create( deviceContext, vertices, indices, lods, meshlets, boundingBox, boundingSphere, vertexFormat, &key );
+}
 
-        XMVECTOR textureCoordinate = XMVectorMultiplyAdd(XMVectorSwizzle<0, 2, 3, 3>(circleVector), textureScale, g_XMOneHalf);
+std::unique_ptr<Mesh> Mesh::CreateCube( ID3D11DeviceContext* deviceContext, float size, bool rhcoords, VertexFormat vertexFormat )
+{
+    PROFILE_SCOPE( "CreateCube" );
+
+    MeshCacheKey key( "Cube" );
+    key.Add( size ).Add( rhcoords ).Add( vertexFormat );
 
-        vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
+    std::unique_ptr<Mesh> mesh = CreateFromCache( deviceContext, key );
+    if ( mesh )
+    {
+        return mesh;
     }
-}
 
-std::unique_ptr<Mesh> Mesh::CreateCone( ID3D11DeviceContext* deviceContext, float diameter, float height, size_t tessellation, bool rhcoords )
-{
     VertexCollection vertices;
     IndexCollection indices;
 
-    if (tessellation < 3)
-        throw std::out_of_range("tessellation parameter out of range");
+    BoundingBox boundingBox;
+    BoundingSphere boundingSphere;
 
-    height /= 2;
+    ComputeCube( vertices, indices, size, rhcoords );
+    ComputeCubeBounds( boundingBox, boundingSphere, size );
 
-    XMVECTOR topOffset = g_XMIdentityR1 * height;
+    OptimizeMesh( vertices, indices );
 
-    float radius = diameter / 2;
-    size_t stride = tessellation + 1;
-
-    // Create a ring of triangles around the outside of the cone.
-    for (size_t i = 0; i <= tessellation; i++)
-    {
-        XMVECTOR circlevec = GetCircleVector(i, tessellation);
+    return Create( deviceContext, vertices, indices, MeshLodCollection(), MeshletCollection(), boundingBox, boundingSphere, vertexFormat, &key );
+}
 
-        XMVECTOR sideOffset = circlevec * radius;
+std::unique_ptr<Mesh> Mesh::CreateCone( ID3D11DeviceContext* deviceContext, float diameter, float height, size_t tessellation, bool rhcoords, VertexFormat vertexFormat )
+{
+    PROFILE_SCOPE( "CreateCone" );
 
-        float u = (float)i / tessellation;
+    MeshCacheKey key( "Cone" );
+    key.Add( diameter ).Add( height ).Add( tessellation ).Add( rhcoords ).Add( vertexFormat );
 
-        XMVECTOR textureCoordinate = XMLoadFloat(&u);
+    std::unique_ptr<Mesh> mesh = CreateFromCache( deviceContext, key );
+    if ( mesh )
+    {
+        return mesh;
+    }
 
-        XMVECTOR pt = sideOffset - topOffset;
+    VertexCollection vertices;
+    IndexCollection indices;
 
-        XMVECTOR normal = XMVector3Cross( GetCircleTangent( i, tessellation ), topOffset - pt );
-        normal = XMVector3Normalize( normal );
+    BoundingBox boundingBox;
+    BoundingSphere boundingSphere;
 
-        // Duplicate the top vertex for distinct normals
-        vertices.push_back(VertexPositionNormalTexture(topOffset, normal, g_XMZero));
-        vertices.push_back(VertexPositionNormalTexture(pt, normal, textureCoordinate + g_XMIdentityR1 ));
+    ComputeCone( vertices, indices, diameter, height, tessellation, rhcoords );
+    ComputeConeBounds( boundingBox, boundingSphere, diameter, height );
 
-        indices.push_back(i * 2);
-        indices.push_back((i * 2 + 3) % (stride * 2));
-        indices.push_back((i * 2 + 1) % (stride * 2));
-    }
+    OptimizeMesh( vertices, indices );
 
-    // Create flat triangle fan caps to seal the bottom.
-    CreateCylinderCap(vertices, indices, tessellation, height, radius, false);
+    return Create( deviceContext, vertices, indices, MeshLodCollection(), MeshletCollection(), boundingBox, boundingSphere, vertexFormat, &key );
+}
 
-    // Create the primitive object.
-    std::unique_ptr<Mesh> mesh(new Mesh());
+std::unique_ptr<Mesh> Mesh::CreateTorus( ID3D11DeviceContext* deviceContext, float diameter, float thickness, size_t tessellation, bool rhcoords, VertexFormat vertexFormat, size_t maxLods, bool buildMeshlets )
+{
+    PROFILE_SCOPE( "CreateTorus" );
 
-    mesh->Initialize(deviceContext, vertices, indices, rhcoords);
+    MeshCacheKey key( "Torus" );
+    key.Add( diameter ).Add( thickness ).Add( tessellation ).Add( rhcoords ).Add( vertexFormat ).Add( maxLods ).Add( buildMeshlets );
 
-    return mesh;
-}
+    std::unique_ptr<Mesh> mesh = CreateFromCache( deviceContext, key );
+    if ( mesh )
+    {
+        return mesh;
+    }
 
-std::unique_ptr<Mesh> Mesh::CreateTorus(_In_ ID3D11DeviceContext* deviceContext, float diameter, float thickness, size_t tessellation, bool rhcoords)
-{
     VertexCollection vertices;
     IndexCollection indices;
 
-    if (tessellation < 3)
-        throw std::out_of_range("tesselation parameter out of range");
+    BoundingBox boundingBox;
+    BoundingSphere boundingSphere;
 
-    size_t stride = tessellation + 1;
+    ComputeTorus( vertices, indices, diameter, thickness, tessellation, rhcoords );
+    ComputeTorusBounds( boundingBox, boundingSphere, diameter, thickness );
 
-    // First we loop around the main ring of the torus.
-    for (size_t i = 0; i <= tessellation; i++)
-    {
-        float u = (float)i / tessellation;
+    OptimizeMesh( vertices, indices );
 
-        float outerAngle = i * XM_2PI / tessellation - XM_PIDIV2;
+    // The meshlets reorder the triangles of the first LOD so they are built first.
+    MeshletCollection meshlets;
+    if ( buildMeshlets )
+    {
+        BuildMeshlets( vertices, indices, meshlets );
+    }
 
-        // Create a transform matrix that will align geometry to
-        // slice perpendicularly though the current ring position.
-        XMMATRIX transform = XMMatrixTranslation(diameter / 2, 0, 0) * XMMatrixRotationY(outerAngle);
+    MeshLodCollection lods;
+    if ( maxLods > 1 )
+    {
+        GenerateLods( vertices, indices, lods, maxLods );
+    }
 
-        // Now we loop along the other axis, around the side of the tube.
-        for (size_t j = 0; j <= tessellation; j++)
-        {
-            float v = 1 - (float)j / tessellation;
+    return Create( deviceContext, vertices, indices, lods, meshlets, boundingBox, boundingSphere, vertexFormat, &key );
+}
 
-            float innerAngle = j * XM_2PI / tessellation + XM_PI;
-            float dx, dy;
+std::unique_ptr<Mesh> Mesh::CreateFromGeometry( ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices,
+                                                VertexFormat vertexFormat )
+{
+    return CreateFromGeometry( deviceContext, vertices, indices, ComputeBoundingBox( vertices ), ComputeBoundingSphere( vertices ), vertexFormat );
+}
 
-            XMScalarSinCos(&dy, &dx, innerAngle);
+std::unique_ptr<Mesh> Mesh::CreateFromGeometry( ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices,
+                                                const BoundingBox& boundingBox, const BoundingSphere& boundingSphere,
+                                                VertexFormat vertexFormat )
+{
+    return Create( deviceContext, vertices, indices, MeshLodCollection(), MeshletCollection(), boundingBox, boundingSphere, vertexFormat, nullptr );
+}
 
-            // Create a vertex.
-            XMVECTOR normal = XMVectorSet(dx, dy, 0, 0);
-            XMVECTOR position = normal * thickness / 2;
-            XMVECTOR textureCoordinate = XMVectorSet(u, v, 0, 0);
+std::unique_ptr<Mesh> Mesh::CreateFromGeometry( ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices,
+                                                const MeshLodCollection& lods, VertexFormat vertexFormat )
+{
+    return Create( deviceContext, vertices, indices, lods, MeshletCollection(), ComputeBoundingBox( vertices ), ComputeBoundingSphere( vertices ), vertexFormat, nullptr );
+}
 
-            position = XMVector3Transform(position, transform);
-            normal = XMVector3TransformNormal(normal, transform);
+std::unique_ptr<Mesh> Mesh::CreateFromGeometry( ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices,
+                                                const MeshLodCollection& lods, const MeshletCollection& meshlets,
+                                                VertexFormat vertexFormat )
+{
+    return Create( deviceContext, vertices, indices, lods, meshlets, ComputeBoundingBox( vertices ), ComputeBoundingSphere( vertices ), vertexFormat, nullptr );
+}
 
-            vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
+std::unique_ptr<Mesh> Mesh::CreateFromMeshData( ID3D11DeviceContext* deviceContext, const MeshData& meshData )
+{
+    std::unique_ptr<Mesh> mesh(new Mesh());
+    mesh->Initialize( deviceContext, meshData );
 
-            // And create indices for two triangles.
-            size_t nextI = (i + 1) % stride;
-            size_t nextJ = (j + 1) % stride;
+    return mesh;
+}
 
-            indices.push_back(i * stride + j);
-            indices.push_back(i * stride + nextJ);
-            indices.push_back(nextI * stride + j);
+std::unique_ptr<Mesh> Mesh::CreateFromCache( ID3D11DeviceContext* deviceContext, const MeshCacheKey& key )
+{
+    PROFILE_SCOPE( "LoadMesh" );
 
-            indices.push_back(i * stride + nextJ);
-            indices.push_back(nextI * stride + nextJ);
-            indices.push_back(nextI * stride + j);
-        }
+    MeshFile file;
+    if ( !ms_Cache || !ms_Cache->Load( key, file ) )
+    {
+        return nullptr;
     }
 
+    // The buffers are created straight from the memory-mapped file.
+    return CreateFromMeshData( deviceContext, file.get_MeshData() );
+}
+
+std::unique_ptr<Mesh> Mesh::Create( ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices,
+                                    const MeshLodCollection& lods, const MeshletCollection& meshlets,
+                                    const BoundingBox& boundingBox, const BoundingSphere& boundingSphere,
+                                    VertexFormat vertexFormat, const MeshCacheKey* cacheKey )
+{
+    PROFILE_SCOPE( "CreateMesh" );
+
     // Create the primitive object.
     std::unique_ptr<Mesh> mesh(new Mesh());
 
-    mesh->Initialize(deviceContext, vertices, indices, rhcoords);
+    // The quantized vertex format needs the bounding box to encode the positions.
+    mesh->m_BoundingBox = boundingBox;
+    mesh->m_BoundingSphere = boundingSphere;
+    mesh->Initialize( deviceContext, vertices, indices, lods, meshlets, vertexFormat, cacheKey );
 
     return mesh;
 }
 
 // Helper for creating a D3D vertex or index buffer.
-template<typename T>
-static void CreateBuffer(_In_ ID3D11Device* device, T const& data, D3D11_BIND_FLAG bindFlags, _Outptr_ ID3D11Buffer** pBuffer)
+static void CreateBuffer(_In_ ID3D11Device* device, const void* data, size_t sizeInBytes, D3D11_BIND_FLAG bindFlags, _Outptr_ ID3D11Buffer** pBuffer)
 {
     assert( pBuffer != 0 );
 
     D3D11_BUFFER_DESC bufferDesc = { 0 };
 
-    bufferDesc.ByteWidth = (UINT)data.size() * sizeof(T::value_type);
+    bufferDesc.ByteWidth = (UINT)sizeInBytes;
     bufferDesc.BindFlags = bindFlags;
     bufferDesc.Usage = D3D11_USAGE_DEFAULT;
 
     D3D11_SUBRESOURCE_DATA dataDesc = { 0 };
 
-    dataDesc.pSysMem = data.data();
+    dataDesc.pSysMem = data;
 
     HRESULT hr = device->CreateBuffer(&bufferDesc, &dataDesc, pBuffer);
     if ( FAILED(hr) )
@@ -370,35 +435,105 @@ static void CreateBuffer(_In_ ID3D11Device* device, T const& data, D3D11_BIND_FL
     }
 }
 
-// Helper for flipping winding of geometric primitives for LH vs. RH coords
-static void ReverseWinding( IndexCollection& indices, VertexCollection& vertices )
+void Mesh::Initialize( ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices,
+                       const MeshLodCollection& lods, const MeshletCollection& meshlets,
+                       VertexFormat vertexFormat, const MeshCacheKey* cacheKey )
 {
-    assert( (indices.size() % 3) == 0 );
-    for( auto it = indices.begin(); it != indices.end(); it += 3 )
+    const VertexCollection* meshVertices = &vertices;
+    const IndexCollection* meshIndices = &indices;
+
+    // With LODs the submesh is the first (full-detail) LOD.
+    uint32_t indexCount = lods.empty() ? static_cast<uint32_t>( indices.size() ) : lods[0].IndexCount;
+    SubMesh wholeMesh = { 0, indexCount, 0, static_cast<uint32_t>( vertices.size() ) };
+    SubMeshCollection subMeshes( 1, wholeMesh );
+
+    // Meshes that are too large for 16-bit indices are split into submeshes with
+    // 16-bit indices if that is cheaper to draw than a single draw call with 32-bit indices.
+    // The LODs and the meshlets share all vertices so a mesh with LODs or meshlets is never split.
+    VertexCollection splitVertices;
+    IndexCollection splitIndices;
+    if ( indices.get_Is32Bit() && lods.empty() && meshlets.empty() )
+    {
+        SubMeshCollection splitSubMeshes;
+        SplitMesh16( vertices, indices, splitVertices, splitIndices, splitSubMeshes );
+
+        if ( PreferSplitMesh( indices.size(), vertices.size(), splitVertices.size(), splitSubMeshes.size() ) )
+        {
+            meshVertices = &splitVertices;
+            meshIndices = &splitIndices;
+            subMeshes.swap( splitSubMeshes );
+        }
+    }
+
+    MeshData meshData;
+    meshData.VertexLayout = static_cast<MeshVertexLayout>( vertexFormat );
+    meshData.VertexStride = GetVertexStride( meshData.VertexLayout );
+    meshData.VertexCount = static_cast<uint32_t>( meshVertices->size() );
+    meshData.IndexSize = static_cast<uint32_t>( meshIndices->get_IndexSize() );
+    meshData.IndexCount = static_cast<uint32_t>( meshIndices->size() );
+    meshData.Indices = meshIndices->data();
+    meshData.SubMeshCount = static_cast<uint32_t>( subMeshes.size() );
+    meshData.SubMeshes = subMeshes.data();
+    meshData.LodCount = static_cast<uint32_t>( lods.size() );
+    meshData.Lods = lods.data();
+    meshData.MeshletCount = static_cast<uint32_t>( meshlets.size() );
+    meshData.Meshlets = meshlets.data();
+    meshData.Box = m_BoundingBox;
+    meshData.Sphere = m_BoundingSphere;
+
+    HalfVertexCollection halfVertices;
+    QuantizedVertexCollection quantizedVertices;
+    switch ( vertexFormat )
     {
-        std::swap( *it, *(it+2) );
+    case HalfPrecisionVertices:
+        EncodeVertices( *meshVertices, halfVertices );
+        meshData.Vertices = halfVertices.data();
+        break;
+    case QuantizedVertices:
+        EncodeVertices( *meshVertices, m_BoundingBox, quantizedVertices );
+        meshData.Vertices = quantizedVertices.data();
+        break;
+    default:
+        meshData.Vertices = meshVertices->data();
+        break;
     }
 
-    for( auto it = vertices.begin(); it != vertices.end(); ++it )
+    Initialize( deviceContext, meshData );
+
+    // A mesh that could not be written to the cache is generated again the next time.
+    if ( cacheKey && ms_Cache )
     {
-        it->textureCoordinate.x = ( 1.f - it->textureCoordinate.x );
+        ms_Cache->Store( *cacheKey, meshData );
     }
 }
 
-void Mesh::Initialize( ID3D11DeviceContext* deviceContext, VertexCollection& vertices, IndexCollection& indices, bool rhcoords )
+void Mesh::Initialize( ID3D11DeviceContext* deviceContext, const MeshData& meshData )
 {
-    if ( vertices.size() >= USHRT_MAX )
-        throw std::exception("Too many vertices for 16-bit index buffer");
-
-    if ( !rhcoords )
-        ReverseWinding( indices, vertices );
+    if ( meshData.VertexLayout >= MeshVertexLayoutCount || meshData.VertexStride != GetVertexStride( meshData.VertexLayout ) )
+    {
+        throw std::exception("Invalid vertex layout.");
+    }
 
     ComPtr<ID3D11Device> device;
     deviceContext->GetDevice(&device);
 
-    CreateBuffer( device.Get(), vertices, D3D11_BIND_VERTEX_BUFFER, &m_VertexBuffer );
-    CreateBuffer( device.Get(), indices, D3D11_BIND_INDEX_BUFFER, &m_IndexBuffer );
+    m_VertexFormat = static_cast<VertexFormat>( meshData.VertexLayout );
+    m_VertexStride = meshData.VertexStride;
+    m_IndexFormat = ( meshData.IndexSize == sizeof(uint32_t) ) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+    m_SubMeshes.assign( meshData.SubMeshes, meshData.SubMeshes + meshData.SubMeshCount );
+    m_Lods.assign( meshData.Lods, meshData.Lods + meshData.LodCount );
+    m_Meshlets.assign( meshData.Meshlets, meshData.Meshlets + meshData.MeshletCount );
 
-    m_IndexCount = static_cast<UINT>( indices.size() );
-}
+    m_MeshletBounds.Clear();
+    for ( const Meshlet& meshlet : m_Meshlets )
+    {
+        m_MeshletBounds.Add( meshlet );
+    }
 
+    m_BoundingBox = meshData.Box;
+    m_BoundingSphere = meshData.Sphere;
+    m_PositionDequantization = ( m_VertexFormat == QuantizedVertices ) ? PositionDequantizationMatrix( m_BoundingBox ) : Math::MatrixIdentity();
+
+    CreateBuffer( device.Get(), meshData.Vertices, static_cast<size_t>( meshData.VertexCount ) * meshData.VertexStride, D3D11_BIND_VERTEX_BUFFER, &m_VertexBuffer );
+    CreateBuffer( device.Get(), meshData.Indices, static_cast<size_t>( meshData.IndexCount ) * meshData.IndexSize, D3D11_BIND_INDEX_BUFFER, &m_IndexBuffer );
+}
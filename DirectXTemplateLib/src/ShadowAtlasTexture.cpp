@@ -0,0 +1,163 @@
+#include <DirectXTemplateLibPCH.h>
+#include <ShadowAtlasTexture.h>
+
+ShadowAtlasTexture::ShadowAtlasTexture( ID3D11Device* device, UINT size )
+    : m_Size( size )
+{
+    assert( device );
+
+    D3D11_TEXTURE2D_DESC textureDesc;
+    ZeroMemory( &textureDesc, sizeof(D3D11_TEXTURE2D_DESC) );
+
+    textureDesc.ArraySize = 1;
+    textureDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL|D3D11_BIND_SHADER_RESOURCE;
+    textureDesc.CPUAccessFlags = 0;
+    textureDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+    textureDesc.Width = size;
+    textureDesc.Height = size;
+    textureDesc.MipLevels = 1;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.SampleDesc.Quality = 0;
+    textureDesc.Usage = D3D11_USAGE_DEFAULT;
+
+    HRESULT hr = device->CreateTexture2D( &textureDesc, nullptr, &m_d3dTexture );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create shadow atlas texture." );
+    }
+
+    D3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc;
+    ZeroMemory( &depthStencilViewDesc, sizeof(D3D11_DEPTH_STENCIL_VIEW_DESC) );
+
+    depthStencilViewDesc.Format = DXGI_FORMAT_D32_FLOAT;
+    depthStencilViewDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+    depthStencilViewDesc.Texture2D.MipSlice = 0;
+
+    hr = device->CreateDepthStencilView( m_d3dTexture.Get(), &depthStencilViewDesc, &m_d3dDepthStencilView );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create shadow atlas depth stencil view." );
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc;
+    ZeroMemory( &shaderResourceViewDesc, sizeof(D3D11_SHADER_RESOURCE_VIEW_DESC) );
+
+    shaderResourceViewDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    shaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
+    shaderResourceViewDesc.Texture2D.MipLevels = 1;
+
+    hr = device->CreateShaderResourceView( m_d3dTexture.Get(), &shaderResourceViewDesc, &m_d3dShaderResourceView );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create shadow atlas shader resource view." );
+    }
+
+    // Points outside of the shadow map (beyond the far plane) are lit.
+    D3D11_SAMPLER_DESC samplerDesc;
+    ZeroMemory( &samplerDesc, sizeof(D3D11_SAMPLER_DESC) );
+
+    samplerDesc.Filter = D3D11_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT;
+    samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_BORDER;
+    samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_BORDER;
+    samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_BORDER;
+    samplerDesc.MipLODBias = 0.0f;
+    samplerDesc.MaxAnisotropy = 1;
+    samplerDesc.ComparisonFunc = D3D11_COMPARISON_LESS_EQUAL;
+    samplerDesc.BorderColor[0] = 1.0f;
+    samplerDesc.BorderColor[1] = 1.0f;
+    samplerDesc.BorderColor[2] = 1.0f;
+    samplerDesc.BorderColor[3] = 1.0f;
+    samplerDesc.MinLOD = 0.0f;
+    samplerDesc.MaxLOD = 0.0f;
+
+    hr = device->CreateSamplerState( &samplerDesc, &m_d3dSamplerState );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create shadow atlas sampler state." );
+    }
+
+    // The walls of the room are single-sided planes, so no faces are culled.
+    D3D11_RASTERIZER_DESC rasterizerDesc;
+    ZeroMemory( &rasterizerDesc, sizeof(D3D11_RASTERIZER_DESC) );
+
+    rasterizerDesc.AntialiasedLineEnable = FALSE;
+    rasterizerDesc.CullMode = D3D11_CULL_NONE;
+    rasterizerDesc.DepthBias = 16;
+    rasterizerDesc.DepthBiasClamp = 0.0f;
+    rasterizerDesc.DepthClipEnable = TRUE;
+    rasterizerDesc.FillMode = D3D11_FILL_SOLID;
+    rasterizerDesc.FrontCounterClockwise = FALSE;
+    rasterizerDesc.MultisampleEnable = FALSE;
+    rasterizerDesc.ScissorEnable = FALSE;
+    rasterizerDesc.SlopeScaledDepthBias = 2.0f;
+
+    hr = device->CreateRasterizerState( &rasterizerDesc, &m_d3dRasterizerState );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create shadow atlas rasterizer state." );
+    }
+
+    D3D11_DEPTH_STENCIL_DESC depthStencilDesc;
+    ZeroMemory( &depthStencilDesc, sizeof(D3D11_DEPTH_STENCIL_DESC) );
+
+    depthStencilDesc.DepthEnable = TRUE;
+    depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+    depthStencilDesc.DepthFunc = D3D11_COMPARISON_ALWAYS;
+    depthStencilDesc.StencilEnable = FALSE;
+
+    hr = device->CreateDepthStencilState( &depthStencilDesc, &m_d3dClearDepthStencilState );
+    if ( FAILED(hr) )
+    {
+        throw std::exception( "Failed to create shadow atlas depth stencil state." );
+    }
+}
+
+ShadowAtlasTexture::~ShadowAtlasTexture()
+{}
+
+UINT ShadowAtlasTexture::get_Size() const
+{
+    return m_Size;
+}
+
+void ShadowAtlasTexture::Clear( ID3D11DeviceContext* deviceContext )
+{
+    deviceContext->ClearDepthStencilView( m_d3dDepthStencilView.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0 );
+}
+
+void ShadowAtlasTexture::SetRenderTarget( ID3D11DeviceContext* deviceContext )
+{
+    deviceContext->OMSetRenderTargets( 0, nullptr, m_d3dDepthStencilView.Get() );
+}
+
+void ShadowAtlasTexture::SetViewport( ID3D11DeviceContext* deviceContext, const ShadowAtlasTile& tile )
+{
+    D3D11_VIEWPORT viewport = { static_cast<FLOAT>( tile.X ), static_cast<FLOAT>( tile.Y ), static_cast<FLOAT>( tile.Size ), static_cast<FLOAT>( tile.Size ), 0.0f, 1.0f };
+    deviceContext->RSSetViewports( 1, &viewport );
+}
+
+ID3D11DepthStencilView* ShadowAtlasTexture::get_DepthStencilView() const
+{
+    return m_d3dDepthStencilView.Get();
+}
+
+ID3D11ShaderResourceView* ShadowAtlasTexture::get_ShaderResourceView() const
+{
+    return m_d3dShaderResourceView.Get();
+}
+
+ID3D11SamplerState* ShadowAtlasTexture::get_SamplerState() const
+{
+    return m_d3dSamplerState.Get();
+}
+
+ID3D11RasterizerState* ShadowAtlasTexture::get_RasterizerState() const
+{
+    return m_d3dRasterizerState.Get();
+}
+
+ID3D11DepthStencilState* ShadowAtlasTexture::get_ClearDepthStencilState() const
+{
+    return m_d3dClearDepthStencilState.Get();
+}
@@ -8,6 +8,7 @@ Window::Window()
     , m_ClientHeight( 0 )
     , m_VSync( true )
     , m_bWindowed( true )
+    , m_bHeadless( false )
     , m_pGame( nullptr )
 {}
 
@@ -18,6 +19,20 @@ Window::Window( HWND hWnd, const std::string& windowName, int clientWidth, int c
     , m_ClientHeight( clientHeight )
     , m_VSync( vSync )
     , m_bWindowed( windowed )
+    , m_bHeadless( false )
+    , m_pGame( nullptr )
+{
+
+}
+
+Window::Window( const std::string& windowName, int clientWidth, int clientHeight )
+    : m_hWnd( nullptr )
+    , m_WindowName( windowName )
+    , m_ClientWidth( clientWidth )
+    , m_ClientHeight( clientHeight )
+    , m_VSync( false )
+    , m_bWindowed( true )
+    , m_bHeadless( true )
     , m_pGame( nullptr )
 {
 
@@ -51,11 +66,18 @@ void Window::Destroy()
         DestroyWindow(m_hWnd);
         m_hWnd = nullptr;
     }
+    // A headless window is no longer valid after it has been destroyed.
+    m_bHeadless = false;
 }
 
 bool Window::IsValid() const
 {
-    return ( m_hWnd != nullptr );
+    return ( m_hWnd != nullptr || m_bHeadless );
+}
+
+bool Window::IsHeadless() const
+{
+    return m_bHeadless;
 }
 
 int Window::get_ClientWidth() const
@@ -90,6 +112,14 @@ bool Window::RegisterDirectXTemplate( Game* pTemplate )
     return false;
 }
 
+void Window::WaitForNextFrame()
+{
+    if ( m_pGame )
+    {
+        m_pGame->WaitForNextFrame();
+    }
+}
+
 void Window::OnUpdate( UpdateEventArgs& e )
 {
     if ( m_pGame )
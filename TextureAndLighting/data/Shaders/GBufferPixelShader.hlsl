@@ -0,0 +1,83 @@
+// The G-buffer pass of the tiled deferred path (see TiledDeferred.h).
+// The lighting is done by TiledDeferredComputeShader.hlsl.
+
+// The specular power is stored as log2( power ) / log2( MaxSpecularPower ).
+#define MAX_SPECULAR_POWER 1024.0f
+
+Texture2D Texture : register(t0);
+sampler Sampler : register(s0);
+
+struct _Material
+{
+    float4  Emissive;       // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float4  Ambient;        // 16 bytes
+    //------------------------------------(16 byte boundary)
+    float4  Diffuse;        // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float4  Specular;       // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float   SpecularPower;  // 4 bytes
+    bool    UseTexture;     // 4 bytes
+    float2  Padding;        // 8 bytes
+    //----------------------------------- (16 byte boundary)
+};  // Total:               // 80 bytes ( 5 * 16 )
+
+cbuffer MaterialProperties : register(b0)
+{
+    _Material Material;
+};
+
+// The first members of the LightProperties constant buffer of TexturedLitPixelShader.hlsl.
+cbuffer LightProperties : register(b1)
+{
+    float4 EyePosition;                 // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float4 GlobalAmbient;               // 16 bytes
+    //----------------------------------- (16 byte boundary)
+};
+
+struct PixelShaderInput
+{
+    float4 PositionWS   : TEXCOORD1;
+    float3 NormalWS     : TEXCOORD2;
+    float2 TexCoord     : TEXCOORD0;
+    float4 Position     : SV_Position;
+};
+
+struct GBuffer
+{
+    float4 Albedo       : SV_Target0;   // R8G8B8A8_UNORM
+    float4 Specular     : SV_Target1;   // R8G8B8A8_UNORM
+    float2 Normal       : SV_Target2;   // R16G16_SNORM
+    float4 Ambient      : SV_Target3;   // R8G8B8A8_UNORM
+};
+
+float2 EncodeOctahedral( float3 n )
+{
+    n /= abs( n.x ) + abs( n.y ) + abs( n.z );
+    if ( n.z < 0.0f )
+    {
+        n.xy = ( 1.0f - abs( n.yx ) ) * ( n.xy >= 0.0f ? 1.0f : -1.0f );
+    }
+    return n.xy;
+}
+
+GBuffer GBufferPixelShader( PixelShaderInput IN )
+{
+    float4 texColor = { 1, 1, 1, 1 };
+
+    if ( Material.UseTexture )
+    {
+        texColor = Texture.Sample( Sampler, IN.TexCoord );
+    }
+
+    GBuffer OUT;
+
+    OUT.Albedo = float4( Material.Diffuse.rgb * texColor.rgb, log2( max( Material.SpecularPower, 1.0f ) ) / log2( MAX_SPECULAR_POWER ) );
+    OUT.Specular = float4( Material.Specular.rgb * texColor.rgb, 0.0f );
+    OUT.Normal = EncodeOctahedral( normalize( IN.NormalWS ) );
+    OUT.Ambient = float4( ( Material.Emissive.rgb + Material.Ambient.rgb * GlobalAmbient.rgb ) * texColor.rgb, 1.0f );
+
+    return OUT;
+}
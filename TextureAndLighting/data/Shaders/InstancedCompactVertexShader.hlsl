@@ -0,0 +1,49 @@
+// Instanced vertex shader for the compact vertex formats (see VertexFormats.h).
+// Positions that are quantized to the bounding box of the mesh are dequantized
+// by the per-instance world matrix (see Mesh::get_PositionDequantization). The
+// inverse transpose world matrix must not include the dequantization.
+cbuffer PerFrame : register( b0 )
+{
+    matrix ViewProjectionMatrix;
+}
+
+struct AppData
+{
+    // Per-vertex data
+    float4 Position : POSITION;     // R16G16B16A16_FLOAT or R16G16B16A16_UNORM (w = 1)
+    float2 Normal   : NORMAL;       // R16G16_SNORM (octahedral)
+    float2 TexCoord : TEXCOORD;     // R16G16_UNORM
+    // Per-instance data
+    matrix Matrix   : WORLDMATRIX;
+    matrix InverseTranspose : INVERSETRANSPOSEWORLDMATRIX;
+};
+
+struct VertexShaderOutput
+{
+    float4 PositionWS   : TEXCOORD1;
+    float3 NormalWS     : TEXCOORD2;
+    float2 TexCoord     : TEXCOORD0;
+    float4 Position     : SV_Position;
+};
+
+float3 DecodeOctahedral( float2 e )
+{
+    float3 n = float3( e.xy, 1.0f - abs( e.x ) - abs( e.y ) );
+    float t = saturate( -n.z );
+    n.xy += ( n.xy >= 0.0f ) ? -t : t;
+    return normalize( n );
+}
+
+VertexShaderOutput InstancedCompactVertexShader( AppData IN )
+{
+    VertexShaderOutput OUT;
+
+    matrix MVP = mul( ViewProjectionMatrix, IN.Matrix );
+
+    OUT.Position = mul( MVP, IN.Position );
+    OUT.PositionWS = mul( IN.Matrix, IN.Position );
+    OUT.NormalWS = mul( (float3x3)IN.InverseTranspose, DecodeOctahedral( IN.Normal ) );
+    OUT.TexCoord = IN.TexCoord;
+
+    return OUT;
+}
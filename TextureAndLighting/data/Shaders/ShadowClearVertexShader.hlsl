@@ -0,0 +1,8 @@
+// A triangle that covers the viewport at the far plane. Drawn with three vertices,
+// no input layout and a depth-stencil state that always writes the depth, it clears
+// the tile of the shadow atlas in the viewport (see ShadowAtlasTexture.h).
+float4 ShadowClearVertexShader( uint vertexID : SV_VertexID ) : SV_Position
+{
+    float2 texCoord = float2( ( vertexID << 1 ) & 2, vertexID & 2 );
+    return float4( texCoord * float2( 2.0f, -2.0f ) + float2( -1.0f, 1.0f ), 1.0f, 1.0f );
+}
@@ -1,10 +1,26 @@
-#define MAX_LIGHTS 8
-
 // Light types.
 #define DIRECTIONAL_LIGHT 0
 #define POINT_LIGHT 1
 #define SPOT_LIGHT 2
 
+// The number of cascades of a directional light.
+#define MAX_CASCADES 4
+
+// The keywords of the shader variants (see ShaderPermutations.h). Without the defines
+// (the precompiled shader) every material and every type of light is handled at runtime.
+#ifndef USE_TEXTURE
+#define USE_TEXTURE Material.UseTexture
+#endif
+#ifndef DIRECTIONAL_LIGHTS
+#define DIRECTIONAL_LIGHTS 1
+#endif
+#ifndef POINT_LIGHTS
+#define POINT_LIGHTS 1
+#endif
+#ifndef SPOT_LIGHTS
+#define SPOT_LIGHTS 1
+#endif
+
 Texture2D Texture : register(t0);
 sampler Sampler : register(s0);
 
@@ -44,18 +60,57 @@ struct Light
     //----------------------------------- (16 byte boundary)
     int         LightType;              // 4 bytes
     bool        Enabled;                // 4 bytes
-    int2        Padding;                // 8 bytes
+    float       Range;                  // 4 bytes
+    int         ShadowIndex;            // 4 bytes
     //----------------------------------- (16 byte boundary)
 };  // Total:                           // 80 bytes (5 * 16 byte boundary)
 
+// The lights of a cluster are LightIndices[Offset, Offset + Count) (see LightClusters.h).
+struct LightCluster
+{
+    uint        Offset;
+    uint        Count;
+};
+
 cbuffer LightProperties : register(b1)
 {
     float4 EyePosition;                 // 16 bytes
     //----------------------------------- (16 byte boundary)
     float4 GlobalAmbient;               // 16 bytes
     //----------------------------------- (16 byte boundary)
-    Light Lights[MAX_LIGHTS];           // 80 * 8 = 640 bytes
-};  // Total:                           // 672 bytes (42 * 16 byte boundary)
+    float2 TileScale;                   // 8 bytes
+    float2 TileBias;                    // 8 bytes
+    //----------------------------------- (16 byte boundary)
+    float  SliceScale;                  // 4 bytes
+    float  SliceBias;                   // 4 bytes
+    uint   NumTilesX;                   // 4 bytes
+    uint   NumTilesY;                   // 4 bytes
+    //----------------------------------- (16 byte boundary)
+    uint   NumSlices;                   // 4 bytes
+    uint3  ClusterPadding;              // 12 bytes
+    //----------------------------------- (16 byte boundary)
+};  // Total:                           // 80 bytes (5 * 16 byte boundary)
+
+StructuredBuffer<Light> Lights : register(t1);
+StructuredBuffer<LightCluster> LightClusters : register(t2);
+StructuredBuffer<uint> LightIndices : register(t3);
+
+// A shadow map in a tile of the shadow atlas (see ShadowMaps.h).
+struct ShadowMap
+{
+    float4x4    ShadowMatrix;           // 64 bytes
+    //----------------------------------- (16 byte boundary)
+    float4      TileBounds;             // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float       SplitDepth;             // 4 bytes
+    float       DepthBias;              // 4 bytes
+    float2      Padding;                // 8 bytes
+    //----------------------------------- (16 byte boundary)
+};  // Total:                           // 96 bytes (6 * 16 byte boundary)
+
+StructuredBuffer<ShadowMap> ShadowMaps : register(t4);
+Texture2D<float> ShadowAtlas : register(t5);
+SamplerComparisonState ShadowSampler : register(s1);
 
 float4 DoDiffuse( Light light, float3 L, float3 N )
 {
@@ -78,7 +133,33 @@ float4 DoSpecular( Light light, float3 V, float3 L, float3 N )
 
 float DoAttenuation( Light light, float d )
 {
-    return 1.0f / ( light.ConstantAttenuation + light.LinearAttenuation * d + light.QuadraticAttenuation * d * d );
+    // The light has no effect beyond its range, so it is only assigned to the clusters in range.
+    return ( d <= light.Range ) ? 1.0f / ( light.ConstantAttenuation + light.LinearAttenuation * d + light.QuadraticAttenuation * d * d ) : 0.0f;
+}
+
+// The fraction of the light that reaches P (1 if the light has no shadow map).
+// The cascades of a directional light are consecutive shadow maps, and the first
+// cascade whose split depth is beyond the view-space depth of the pixel is used.
+float DoShadow( Light light, float4 P, float viewDepth )
+{
+    if ( light.ShadowIndex < 0 ) return 1.0f;
+
+    uint index = light.ShadowIndex;
+    if ( light.LightType == DIRECTIONAL_LIGHT )
+    {
+        for ( uint i = 1; i < MAX_CASCADES && viewDepth > ShadowMaps[index].SplitDepth; ++i )
+        {
+            ++index;
+        }
+    }
+
+    ShadowMap shadowMap = ShadowMaps[index];
+    float4 shadowPosition = mul( shadowMap.ShadowMatrix, P );
+    shadowPosition.xyz /= shadowPosition.w;
+
+    // Clamp to the tile, so the filter never reads the neighbouring shadow maps.
+    float2 texCoord = clamp( shadowPosition.xy, shadowMap.TileBounds.xy, shadowMap.TileBounds.zw );
+    return ShadowAtlas.SampleCmpLevelZero( ShadowSampler, texCoord, shadowPosition.z - shadowMap.DepthBias );
 }
 
 struct LightingResult
@@ -103,14 +184,16 @@ LightingResult DoPointLight( Light light, float3 V, float4 P, float3 N )
     return result;
 }
 
-LightingResult DoDirectionalLight( Light light, float3 V, float4 P, float3 N )
+LightingResult DoDirectionalLight( Light light, float3 V, float4 P, float3 N, float viewDepth )
 {
     LightingResult result;
 
     float3 L = -light.Direction.xyz;
 
-    result.Diffuse = DoDiffuse( light, L, N );
-    result.Specular = DoSpecular( light, V, L, N );
+    float shadow = DoShadow( light, P, viewDepth );
+
+    result.Diffuse = DoDiffuse( light, L, N ) * shadow;
+    result.Specular = DoSpecular( light, V, L, N ) * shadow;
 
     return result;
 }
@@ -123,7 +206,7 @@ float DoSpotCone( Light light, float3 L )
     return smoothstep( minCos, maxCos, cosAngle ); 
 }
 
-LightingResult DoSpotLight( Light light, float3 V, float4 P, float3 N )
+LightingResult DoSpotLight( Light light, float3 V, float4 P, float3 N, float viewDepth )
 {
     LightingResult result;
 
@@ -132,7 +215,7 @@ LightingResult DoSpotLight( Light light, float3 V, float4 P, float3 N )
     L = L / distance;
 
     float attenuation = DoAttenuation( light, distance );
-    float spotIntensity = DoSpotCone( light, L );
+    float spotIntensity = DoSpotCone( light, L ) * DoShadow( light, P, viewDepth );
 
     result.Diffuse = DoDiffuse( light, L, N ) * attenuation * spotIntensity;
     result.Specular = DoSpecular( light, V, L, N ) * attenuation * spotIntensity;
@@ -140,40 +223,69 @@ LightingResult DoSpotLight( Light light, float3 V, float4 P, float3 N )
     return result;
 }
 
-LightingResult ComputeLighting( float4 P, float3 N )
+// The cluster of a pixel. The w component of SV_Position is the view-space depth.
+LightCluster GetCluster( float4 position )
+{
+    uint2 tile = min( uint2( position.xy * TileScale + TileBias ), uint2( NumTilesX - 1, NumTilesY - 1 ) );
+    uint slice = min( uint( max( log2( position.w ) * SliceScale + SliceBias, 0.0f ) ), NumSlices - 1 );
+    return LightClusters[( slice * NumTilesY + tile.y ) * NumTilesX + tile.x];
+}
+
+LightingResult ComputeLighting( float4 P, float3 N, float4 position )
 {
     float3 V = normalize( EyePosition - P ).xyz;
 
     LightingResult totalResult = { {0, 0, 0, 0}, {0, 0, 0, 0} };
 
-    [unroll]
-    for( int i = 0; i < MAX_LIGHTS; ++i )
+#if DIRECTIONAL_LIGHTS || POINT_LIGHTS || SPOT_LIGHTS
+    // Only shade the lights of the cluster of the pixel.
+    LightCluster cluster = GetCluster( position );
+    for( uint i = 0; i < cluster.Count; ++i )
     {
+        Light light = Lights[LightIndices[cluster.Offset + i]];
         LightingResult result = { {0, 0, 0, 0}, {0, 0, 0, 0} };
 
-        if ( !Lights[i].Enabled ) continue;
-        
-        switch( Lights[i].LightType )
+        if ( !light.Enabled ) continue;
+
+#if DIRECTIONAL_LIGHTS + POINT_LIGHTS + SPOT_LIGHTS == 1
+        // All of the enabled lights have the same type, so there is no branch on the type.
+#if DIRECTIONAL_LIGHTS
+        result = DoDirectionalLight( light, V, P, N, position.w );
+#elif POINT_LIGHTS
+        result = DoPointLight( light, V, P, N );
+#else
+        result = DoSpotLight( light, V, P, N, position.w );
+#endif
+#else
+        switch( light.LightType )
         {
+#if DIRECTIONAL_LIGHTS
         case DIRECTIONAL_LIGHT:
             {
-                result = DoDirectionalLight( Lights[i], V, P, N );
+                result = DoDirectionalLight( light, V, P, N, position.w );
             }
             break;
+#endif
+#if POINT_LIGHTS
         case POINT_LIGHT: 
             {
-                result = DoPointLight( Lights[i], V, P, N );
+                result = DoPointLight( light, V, P, N );
             }
             break;
+#endif
+#if SPOT_LIGHTS
         case SPOT_LIGHT:
             {
-                result = DoSpotLight( Lights[i], V, P, N );
+                result = DoSpotLight( light, V, P, N, position.w );
             }
             break;
+#endif
         }
+#endif
         totalResult.Diffuse += result.Diffuse;
         totalResult.Specular += result.Specular;
     }
+#endif
 
     totalResult.Diffuse = saturate(totalResult.Diffuse);
     totalResult.Specular = saturate(totalResult.Specular);
@@ -186,11 +298,12 @@ struct PixelShaderInput
     float4 PositionWS   : TEXCOORD1;
     float3 NormalWS     : TEXCOORD2;
     float2 TexCoord     : TEXCOORD0;
+    float4 Position     : SV_Position;
 };
 
 float4 TexturedLitPixelShader( PixelShaderInput IN ) : SV_TARGET
 {
-    LightingResult lit = ComputeLighting( IN.PositionWS, normalize(IN.NormalWS) );
+    LightingResult lit = ComputeLighting( IN.PositionWS, normalize(IN.NormalWS), IN.Position );
     
     float4 emissive = Material.Emissive;
     float4 ambient = Material.Ambient * GlobalAmbient;
@@ -199,7 +312,7 @@ float4 TexturedLitPixelShader( PixelShaderInput IN ) : SV_TARGET
 
     float4 texColor = { 1, 1, 1, 1 };
     
-    if ( Material.UseTexture )
+    if ( USE_TEXTURE )
     {
         texColor = Texture.Sample( Sampler, IN.TexCoord );
     }
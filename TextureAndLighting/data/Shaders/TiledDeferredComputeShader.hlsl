@@ -0,0 +1,315 @@
+// The lighting pass of the tiled deferred path (see TiledDeferred.h).
+// One thread group shades a TILE_SIZE x TILE_SIZE tile of the G-buffer that was
+// written by GBufferPixelShader.hlsl. The group finds the depth bounds of the tile,
+// culls the lights against the tile and shades every pixel once with the lights that
+// are left. TiledLightCulling does the same culling on the CPU. The spot lights and the
+// directional lights sample their shadow maps like TexturedLitPixelShader.hlsl does.
+
+// Light types.
+#define DIRECTIONAL_LIGHT 0
+#define POINT_LIGHT 1
+#define SPOT_LIGHT 2
+
+// TiledLightCulling::TileSize and TiledLightCulling::MaxLightsPerTile.
+#define TILE_SIZE 16
+#define MAX_LIGHTS_PER_TILE 512
+
+#define MAX_SPECULAR_POWER 1024.0f
+
+// The number of cascades of a directional light.
+#define MAX_CASCADES 4
+
+struct Light
+{
+    float4      Position;               // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float4      Direction;              // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float4      Color;                  // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float       SpotAngle;              // 4 bytes
+    float       ConstantAttenuation;    // 4 bytes
+    float       LinearAttenuation;      // 4 bytes
+    float       QuadraticAttenuation;   // 4 bytes
+    //----------------------------------- (16 byte boundary)
+    int         LightType;              // 4 bytes
+    bool        Enabled;                // 4 bytes
+    float       Range;                  // 4 bytes
+    int         ShadowIndex;            // 4 bytes
+    //----------------------------------- (16 byte boundary)
+};  // Total:                           // 80 bytes (5 * 16 byte boundary)
+
+cbuffer TiledDeferredConstants : register(b0)
+{
+    matrix InverseViewMatrix;           // 64 bytes
+    //----------------------------------- (16 byte boundary)
+    float4 EyePosition;                 // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float  ProjectionScaleX;            // 4 bytes
+    float  ProjectionScaleY;            // 4 bytes
+    float  DepthScale;                  // 4 bytes
+    float  DepthBias;                   // 4 bytes
+    //----------------------------------- (16 byte boundary)
+    uint   ScreenWidth;                 // 4 bytes
+    uint   ScreenHeight;                // 4 bytes
+    uint   NumLights;                   // 4 bytes
+    uint   Padding;                     // 4 bytes
+    //----------------------------------- (16 byte boundary)
+};  // Total:                           // 112 bytes (7 * 16 byte boundary)
+
+// A shadow map in a tile of the shadow atlas (ShadowMapConstants in ShadowMaps.h).
+struct ShadowMap
+{
+    float4x4    ShadowMatrix;           // 64 bytes
+    //----------------------------------- (16 byte boundary)
+    float4      TileBounds;             // 16 bytes
+    //----------------------------------- (16 byte boundary)
+    float       SplitDepth;             // 4 bytes
+    float       DepthBias;              // 4 bytes
+    float2      Padding;                // 8 bytes
+    //----------------------------------- (16 byte boundary)
+};  // Total:                           // 96 bytes (6 * 16 byte boundary)
+
+Texture2D<float> DepthTexture : register(t0);
+Texture2D<float4> AlbedoTexture : register(t1);
+Texture2D<float4> SpecularTexture : register(t2);
+Texture2D<float2> NormalTexture : register(t3);
+Texture2D<float4> AmbientTexture : register(t4);
+
+StructuredBuffer<Light> Lights : register(t5);
+// The view-space bounding spheres of the lights (xyz = center, w = radius).
+StructuredBuffer<float4> LightBounds : register(t6);
+
+StructuredBuffer<ShadowMap> ShadowMaps : register(t7);
+Texture2D<float> ShadowAtlas : register(t8);
+SamplerComparisonState ShadowSampler : register(s0);
+
+RWTexture2D<unorm float4> OutputTexture : register(u0);
+
+groupshared uint TileMinDepth;
+groupshared uint TileMaxDepth;
+groupshared uint TileLightCount;
+groupshared uint TileLightIndices[MAX_LIGHTS_PER_TILE];
+
+float4 DoDiffuse( Light light, float3 L, float3 N )
+{
+    float NdotL = max( 0, dot( N, L ) );
+    return light.Color * NdotL;
+}
+
+float4 DoSpecular( Light light, float3 V, float3 L, float3 N, float specularPower )
+{
+    // Phong lighting.
+    float3 R = normalize( reflect( -L, N ) );
+    float RdotV = max( 0, dot( R, V ) );
+
+    return light.Color * pow( RdotV, specularPower );
+}
+
+float DoAttenuation( Light light, float d )
+{
+    return ( d <= light.Range ) ? 1.0f / ( light.ConstantAttenuation + light.LinearAttenuation * d + light.QuadraticAttenuation * d * d ) : 0.0f;
+}
+
+float DoSpotCone( Light light, float3 L )
+{
+    float minCos = cos( light.SpotAngle );
+    float maxCos = ( minCos + 1.0f ) / 2.0f;
+    float cosAngle = dot( light.Direction.xyz, -L );
+    return smoothstep( minCos, maxCos, cosAngle );
+}
+
+// The fraction of the light that reaches P (1 if the light has no shadow map).
+// A directional light has MAX_CASCADES consecutive shadow maps, one per split of the view depth.
+float DoShadow( Light light, float3 P, float viewDepth )
+{
+    if ( light.ShadowIndex < 0 ) return 1.0f;
+
+    uint index = light.ShadowIndex;
+    if ( light.LightType == DIRECTIONAL_LIGHT )
+    {
+        for ( uint i = 1; i < MAX_CASCADES && viewDepth > ShadowMaps[index].SplitDepth; ++i )
+        {
+            ++index;
+        }
+    }
+
+    ShadowMap shadowMap = ShadowMaps[index];
+    float4 shadowPosition = mul( shadowMap.ShadowMatrix, float4( P, 1.0f ) );
+    shadowPosition.xyz /= shadowPosition.w;
+
+    // Clamp to the tile, so the filter never reads the neighbouring shadow maps.
+    float2 texCoord = clamp( shadowPosition.xy, shadowMap.TileBounds.xy, shadowMap.TileBounds.zw );
+    return ShadowAtlas.SampleCmpLevelZero( ShadowSampler, texCoord, shadowPosition.z - shadowMap.DepthBias );
+}
+
+struct LightingResult
+{
+    float4 Diffuse;
+    float4 Specular;
+};
+
+LightingResult DoLight( Light light, float3 V, float3 P, float3 N, float specularPower, float viewDepth )
+{
+    LightingResult result = { {0, 0, 0, 0}, {0, 0, 0, 0} };
+
+    float3 L;
+    float intensity = 1.0f;
+
+    switch( light.LightType )
+    {
+    case DIRECTIONAL_LIGHT:
+        {
+            L = -light.Direction.xyz;
+            intensity = DoShadow( light, P, viewDepth );
+        }
+        break;
+    case POINT_LIGHT:
+    case SPOT_LIGHT:
+        {
+            L = light.Position.xyz - P;
+            float distance = length( L );
+            L = L / distance;
+
+            intensity = DoAttenuation( light, distance );
+            if ( light.LightType == SPOT_LIGHT )
+            {
+                intensity *= DoSpotCone( light, L ) * DoShadow( light, P, viewDepth );
+            }
+        }
+        break;
+    default:
+        return result;
+    }
+
+    result.Diffuse = DoDiffuse( light, L, N ) * intensity;
+    result.Specular = DoSpecular( light, V, L, N, specularPower ) * intensity;
+
+    return result;
+}
+
+float3 DecodeOctahedral( float2 e )
+{
+    float3 n = float3( e.xy, 1.0f - abs( e.x ) - abs( e.y ) );
+    float t = saturate( -n.z );
+    n.xy += ( n.xy >= 0.0f ) ? -t : t;
+    return normalize( n );
+}
+
+// The view-space depth of a post-projection depth.
+float ViewDepth( float depth )
+{
+    return DepthScale / ( depth - DepthBias );
+}
+
+// The signed distance of a view-space point to the plane through the eye and the
+// column of pixels at x (positive to the right).
+float ColumnDistance( float3 p, uint x )
+{
+    float slope = ( 2.0f * min( x, ScreenWidth ) / ScreenWidth - 1.0f ) / ProjectionScaleX;
+    return ( p.x - slope * p.z ) * rsqrt( 1.0f + slope * slope );
+}
+
+// The signed distance of a view-space point to the plane through the eye and the
+// row of pixels at y (positive downwards).
+float RowDistance( float3 p, uint y )
+{
+    float slope = ( 1.0f - 2.0f * min( y, ScreenHeight ) / ScreenHeight ) / ProjectionScaleY;
+    return ( slope * p.z - p.y ) * rsqrt( 1.0f + slope * slope );
+}
+
+[numthreads( TILE_SIZE, TILE_SIZE, 1 )]
+void TiledDeferredComputeShader( uint3 groupId : SV_GroupID, uint3 dispatchThreadId : SV_DispatchThreadID, uint groupIndex : SV_GroupIndex )
+{
+    uint2 pixel = dispatchThreadId.xy;
+    bool onScreen = pixel.x < ScreenWidth && pixel.y < ScreenHeight;
+
+    if ( groupIndex == 0 )
+    {
+        TileMinDepth = 0x7f7fffff; // asuint( FLT_MAX )
+        TileMaxDepth = 0;
+        TileLightCount = 0;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    // The depths are positive, so their bits are in the same order as their values.
+    // The clear depth of 1 does not extend the bounds.
+    float depth = onScreen ? DepthTexture[pixel] : 1.0f;
+    if ( depth < 1.0f )
+    {
+        InterlockedMin( TileMinDepth, asuint( depth ) );
+        InterlockedMax( TileMaxDepth, asuint( depth ) );
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    // Cull the lights against the tile, TILE_SIZE * TILE_SIZE lights at a time.
+    if ( TileMinDepth <= TileMaxDepth )
+    {
+        float minDepth = ViewDepth( asfloat( TileMinDepth ) );
+        float maxDepth = ViewDepth( asfloat( TileMaxDepth ) );
+        uint2 firstPixel = groupId.xy * TILE_SIZE;
+        uint2 lastPixel = firstPixel + TILE_SIZE;
+
+        for ( uint i = groupIndex; i < NumLights; i += TILE_SIZE * TILE_SIZE )
+        {
+            float4 sphere = LightBounds[i];
+            float3 center = sphere.xyz;
+            float radius = sphere.w;
+
+            if ( ColumnDistance( center, firstPixel.x ) >= -radius && ColumnDistance( center, lastPixel.x ) <= radius &&
+                 RowDistance( center, firstPixel.y ) >= -radius && RowDistance( center, lastPixel.y ) <= radius &&
+                 center.z + radius >= minDepth && center.z - radius <= maxDepth )
+            {
+                uint index;
+                InterlockedAdd( TileLightCount, 1, index );
+                if ( index < MAX_LIGHTS_PER_TILE )
+                {
+                    TileLightIndices[index] = i;
+                }
+            }
+        }
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    if ( !onScreen )
+    {
+        return;
+    }
+
+    float4 ambient = AmbientTexture[pixel];
+    if ( depth >= 1.0f )
+    {
+        // No geometry: the ambient target holds the clear color.
+        OutputTexture[pixel] = ambient;
+        return;
+    }
+
+    float4 albedo = AlbedoTexture[pixel];
+    float4 specular = SpecularTexture[pixel];
+    float3 N = DecodeOctahedral( NormalTexture[pixel] );
+    float specularPower = exp2( albedo.a * log2( MAX_SPECULAR_POWER ) );
+
+    // Reconstruct the world-space position from the depth.
+    float2 ndc = float2( ( pixel.x + 0.5f ) / ScreenWidth * 2.0f - 1.0f, 1.0f - ( pixel.y + 0.5f ) / ScreenHeight * 2.0f );
+    float z = ViewDepth( depth );
+    float4 positionVS = float4( ndc.x * z / ProjectionScaleX, ndc.y * z / ProjectionScaleY, z, 1.0f );
+    float3 P = mul( InverseViewMatrix, positionVS ).xyz;
+    float3 V = normalize( EyePosition.xyz - P );
+
+    LightingResult totalResult = { {0, 0, 0, 0}, {0, 0, 0, 0} };
+
+    uint numTileLights = min( TileLightCount, MAX_LIGHTS_PER_TILE );
+    for ( uint j = 0; j < numTileLights; ++j )
+    {
+        Light light = Lights[TileLightIndices[j]];
+        if ( !light.Enabled ) continue;
+
+        LightingResult result = DoLight( light, V, P, N, specularPower, z );
+        totalResult.Diffuse += result.Diffuse;
+        totalResult.Specular += result.Specular;
+    }
+
+    float3 finalColor = ambient.rgb + albedo.rgb * saturate( totalResult.Diffuse.rgb ) + specular.rgb * saturate( totalResult.Specular.rgb );
+
+    OutputTexture[pixel] = float4( finalColor, 1.0f );
+}
@@ -3,94 +3,20 @@
 #include <Game.h>
 #include <Camera.h>
 #include <Mesh.h>
-
-#define MAX_LIGHTS 8
-
-struct _Material
-{
-    _Material() 
-        : Emissive( 0.0f, 0.0f, 0.0f, 1.0f )
-        , Ambient( 0.1f, 0.1f, 0.1f, 1.0f )
-        , Diffuse( 1.0f, 1.0f, 1.0f, 1.0f )
-        , Specular( 1.0f, 1.0f, 1.0f, 1.0f )
-        , SpecularPower( 128.0f )
-        , UseTexture( false )
-    {}
-
-    DirectX::XMFLOAT4   Emissive;
-    //----------------------------------- (16 byte boundary)
-    DirectX::XMFLOAT4   Ambient;
-    //----------------------------------- (16 byte boundary)
-    DirectX::XMFLOAT4   Diffuse;
-    //----------------------------------- (16 byte boundary)
-    DirectX::XMFLOAT4   Specular;
-    //----------------------------------- (16 byte boundary)
-    float               SpecularPower;
-    // Add some padding complete the 16 byte boundary.
-    int                 UseTexture;
-    // Add some padding to complete the 16 byte boundary.
-    float                 Padding[2];
-    //----------------------------------- (16 byte boundary)
-}; // Total:                                80 bytes (5 * 16)
-
-struct MaterialProperties
-{
-    _Material   Material;
-};
-
-enum LightType
-{
-    DirectionalLight    = 0,
-    PointLight          = 1,
-    SpotLight           = 2
-};
-
-struct Light
-{
-    Light()
-        : Position( 0.0f, 0.0f, 0.0f, 1.0f )
-        , Direction( 0.0f, 0.0f, 1.0f, 0.0f )
-        , Color( 1.0f, 1.0f, 1.0f, 1.0f )
-        , SpotAngle( DirectX::XM_PIDIV2 )
-        , ConstantAttenuation( 1.0f )
-        , LinearAttenuation( 0.0f )
-        , QuadraticAttenuation( 0.0f )
-        , LightType( DirectionalLight )
-        , Enabled( 0 )
-    {}
-
-    DirectX::XMFLOAT4    Position;
-    //----------------------------------- (16 byte boundary)
-    DirectX::XMFLOAT4    Direction;
-    //----------------------------------- (16 byte boundary)
-    DirectX::XMFLOAT4    Color;
-    //----------------------------------- (16 byte boundary)
-    float       SpotAngle;
-    float       ConstantAttenuation;
-    float       LinearAttenuation;
-    float       QuadraticAttenuation;
-    //----------------------------------- (16 byte boundary)
-    int         LightType;
-    int         Enabled;
-    // Add some padding to make this struct size a multiple of 16 bytes.
-    int         Padding[2];
-    //----------------------------------- (16 byte boundary)
-};  // Total:                              80 bytes ( 5 * 16 )
-
-struct LightProperties
-{
-    LightProperties()
-        : EyePosition( 0.0f, 0.0f, 0.0f, 1.0f )
-        , GlobalAmbient( 0.2f, 0.2f, 0.8f, 1.0f )
-    {}
-
-    DirectX::XMFLOAT4   EyePosition;
-    //----------------------------------- (16 byte boundary)
-    DirectX::XMFLOAT4   GlobalAmbient;
-    //----------------------------------- (16 byte boundary)
-    Light               Lights[MAX_LIGHTS]; // 80 * 8 bytes
-};  // Total:                                  672 bytes (42 * 16)
-
+#include <MathInterop.h>
+#include <Lighting.h>
+#include <DynamicConstantBuffer.h>
+#include <DynamicStructuredBuffer.h>
+#include <GBuffer.h>
+#include <LightBuffer.h>
+#include <LightClusters.h>
+#include <LightManager.h>
+#include <RenderQueue.h>
+#include <ShaderPermutations.h>
+#include <ShadowAtlasTexture.h>
+#include <ShadowMaps.h>
+#include <StateCache.h>
+#include <TiledDeferred.h>
 
 class TextureAndLightingDemo : public Game
 {
@@ -110,6 +36,29 @@ public:
      */
     virtual void UnloadContent();
 
+    // The number of state changes that were submitted and avoided in the last frame.
+    const StateCache::Statistics& get_StateCacheStatistics() const;
+
+    // The number of lights and bytes that were uploaded to the light buffer in the last frame.
+    const LightBuffer::Statistics& get_LightBufferStatistics() const;
+
+    // The number of shadow maps that were still valid and that were rendered in the last frame.
+    const ShadowCache::Statistics& get_ShadowCacheStatistics() const;
+
+    /**
+     * The number of small static point lights that are scattered around the room in
+     * addition to the animated lights. Call before LoadContent.
+     */
+    void set_NumStaticLights( unsigned int numStaticLights );
+    unsigned int get_NumStaticLights() const;
+
+    /**
+     * Shade the scene with the tiled deferred path (see TiledDeferred.h) instead of
+     * the clustered forward path. Call before LoadContent.
+     */
+    void set_DeferredShading( bool deferredShading );
+    bool get_DeferredShading() const;
+
 protected:
     // Don't allow copying of the demo.
     TextureAndLightingDemo( const TextureAndLightingDemo& copy );
@@ -127,6 +76,33 @@ protected:
 
     virtual void OnResize( ResizeEventArgs& e );
 
+    // Add an object to the list of objects that are culled against the view frustum.
+    void SubmitObject( uint64_t sortKey, const DrawCommand& drawCommand, const BoundingSphere& bounds );
+
+    // The lighting pass of the tiled deferred path. Writes the lit G-buffer to the back buffer.
+    void ShadeGBuffer();
+
+    /**
+     * Pack the shadow maps of the spot lights into the shadow atlas and set the shadow
+     * indices of the lights. Adds a shadow pass for every shadow map that the shadow
+     * cache does not hold.
+     */
+    void UpdateShadowMaps();
+    // Render the shadow casters into the tiles of the shadow passes.
+    void RenderShadowMaps();
+
+    /**
+     * Load the variants of the textured lit pixel shader from the shader cache, or
+     * compile them from the source file. Variants that are not available use the
+     * precompiled shader.
+     */
+    void LoadTexturedLitVariants();
+    // The index of the pixel shader of a material: the variant of the textured lit
+    // pixel shader, or the number of variants for the G-buffer pixel shader.
+    uint32_t GetPixelShaderVariant( const MaterialProperties& material ) const;
+    // The pixel shader of the forward or the G-buffer pass for a material.
+    ID3D11PixelShader* GetPixelShader( const MaterialProperties& material ) const;
+
 private:
     Camera m_Camera;
 
@@ -160,21 +136,86 @@ private:
     // Vertex shader for simple (non-instanced) geometry.
     Microsoft::WRL::ComPtr<ID3D11VertexShader> m_d3dSimplVertexShader;
     Microsoft::WRL::ComPtr<ID3D11PixelShader> m_d3dTexturedLitPixelShader;
+    // The variants of the textured lit pixel shader for the materials and the types of
+    // the enabled lights, indexed by GetTexturedLitVariant.
+    ShaderPermutations m_TexturedLitPermutations;
+    std::vector< Microsoft::WRL::ComPtr<ID3D11PixelShader> > m_d3dTexturedLitPixelShaders;
 
     Microsoft::WRL::ComPtr<ID3D11InputLayout> m_d3dInstancedInputLayout;
 
-    // Per-Frame constant buffer defined in the instanced vertex shader.
-    Microsoft::WRL::ComPtr<ID3D11Buffer> m_d3dPerFrameConstantBuffer;
-    // Per-Object constant buffer defined in the simple vertex shader.
-    Microsoft::WRL::ComPtr<ID3D11Buffer> m_d3dPerObjectConstantBuffer;
-
-    // Material properties defined in the pixel shader
-    Microsoft::WRL::ComPtr<ID3D11Buffer> m_d3dMaterialPropertiesConstantBuffer;
+    // The Per-Frame constant buffer defined in the instanced vertex shader,
+    // the Per-Object constant buffer defined in the simple vertex shader and
+    // the material properties defined in the pixel shader are sub-allocated
+    // from a single dynamic constant buffer.
+    std::unique_ptr<DynamicConstantBuffer> m_DynamicConstantBuffer;
+
+    // The draw calls of the scene are sorted by state before they are executed.
+    RenderQueue m_RenderQueue;
+    StateCache::Statistics m_StateCacheStatistics;
+
+    // The world-space bounds, sort keys, and draw commands of the objects that are frustum culled.
+    BoundingSphereArrays m_ObjectBounds;
+    std::vector<uint64_t> m_ObjectSortKeys;
+    std::vector<DrawCommand> m_ObjectDrawCommands;
+    std::vector<uint32_t> m_VisibleObjects;
     std::vector<MaterialProperties> m_MaterialProperties;
 
     // Light properties defined in the pixel shader
     Microsoft::WRL::ComPtr<ID3D11Buffer> m_d3dLightPropertiesConstantBuffer;
-    LightProperties m_LightProperties;
+    ClusteredLightProperties m_LightProperties;
+
+    // The animated lights and the sun followed by the static lights. Only the lights that moved
+    // since the last frame are uploaded to the light buffer.
+    LightManager m_LightManager;
+    std::vector<LightHandle> m_AnimatedLights;
+    LightHandle m_SunLight;
+    unsigned int m_NumStaticLights;
+
+    // The lights are assigned to the clusters of the view frustum every frame, and the
+    // lights, the clusters, and the light indices are read by the pixel shader.
+    LightClusters m_LightClusters;
+    BoundingSphereArrays m_LightViewBounds;
+    std::unique_ptr<LightBuffer> m_LightBuffer;
+    std::unique_ptr<DynamicStructuredBuffer> m_LightClusterBuffer;
+    std::unique_ptr<DynamicStructuredBuffer> m_LightIndexBuffer;
+
+    // The tiled deferred path renders the scene to the G-buffer, and a compute shader
+    // culls the lights per tile and shades every pixel once. The lights are not
+    // assigned to the clusters; the compute shader reads their view-space bounds.
+    bool m_DeferredShading;
+    std::unique_ptr<GBuffer> m_GBuffer;
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> m_d3dGBufferPixelShader;
+    Microsoft::WRL::ComPtr<ID3D11ComputeShader> m_d3dTiledDeferredComputeShader;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> m_d3dTiledDeferredConstantBuffer;
+    std::vector<Math::Float4> m_LightViewSpheres;
+    std::unique_ptr<DynamicStructuredBuffer> m_LightBoundsBuffer;
+
+    // The spot lights and the sun cast shadows in both paths. The sun has cascaded shadow
+    // maps that are split along the view frustum of the camera. The shadow maps are packed
+    // into a single atlas every frame (see ShadowMaps.h), and since the scene is static
+    // a shadow map is only rendered again when its light moved or its tile changed.
+    struct ShadowPass
+    {
+        ShadowAtlasTile Tile;
+        // The per-frame constants of the walls and the per-object constants of the shapes.
+        DynamicConstantBuffer::Allocation WallsConstants;
+        DynamicConstantBuffer::Allocation SphereConstants;
+        DynamicConstantBuffer::Allocation CubeConstants;
+        DynamicConstantBuffer::Allocation TorusConstants;
+        Math::Float4x4 ViewProjectionMatrix;
+        // The walls do not cast shadows into the cascades of the sun.
+        bool RenderWalls;
+    };
+    ShadowAtlas m_ShadowAtlas;
+    ShadowCache m_ShadowCache;
+    std::unique_ptr<ShadowAtlasTexture> m_ShadowAtlasTexture;
+    std::unique_ptr<DynamicStructuredBuffer> m_ShadowMapBuffer;
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> m_d3dShadowClearVertexShader;
+    std::vector<float> m_ShadowImportance;
+    std::vector<ShadowView> m_ShadowViews;
+    std::vector<ShadowAtlasTile> m_ShadowTiles;
+    std::vector<ShadowMapConstants> m_ShadowMapConstants;
+    std::vector<ShadowPass> m_ShadowPasses;
 
     // Create some geometric primitives for the scene.
     // The outer walls of our room.
@@ -184,6 +225,9 @@ private:
     std::unique_ptr<Mesh> m_Cone;
     std::unique_ptr<Mesh> m_Torus;
 
+    // Generated meshes are loaded from this cache after the first run.
+    std::unique_ptr<MeshCache> m_MeshCache;
+
     // Some textures used by our demo.
     Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_DirectXTexture;
     Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_EarthTexture;
@@ -2,19 +2,37 @@
 #include <TextureAndLightingDemo.h>
 
 #include <Window.h>
+#include <D3D11RenderContext.h>
+#include <D3DShaderCompiler.h>
+#include <Profiler.h>
+
+#include <fstream>
+#include <iterator>
+#include <random>
 
 #if _DEBUG
 #include <SimpleVertexShader_d.h>
 #include <InstancedVertexShader_d.h>
 #include <TexturedLitPixelShader_d.h>
+#include <GBufferPixelShader_d.h>
+#include <TiledDeferredComputeShader_d.h>
+#include <ShadowClearVertexShader_d.h>
 #else
 #include <SimpleVertexShader.h>
 #include <InstancedVertexShader.h>
 #include <TexturedLitPixelShader.h>
+#include <GBufferPixelShader.h>
+#include <TiledDeferredComputeShader.h>
+#include <ShadowClearVertexShader.h>
 #endif
 
 using namespace DirectX;
 
+// The lights that circle the room. The static lights follow them in the light manager.
+static const int NumAnimatedLights = 8;
+// The number of cascades of the shadow map of the sun (MAX_CASCADES in the shaders).
+static const int NumCascades = 4;
+
 // Per-vertex data.
 struct VertexPosNormTex
 {
@@ -72,17 +90,21 @@ TextureAndLightingDemo::TextureAndLightingDemo( Window& window )
     , m_Yaw( 0.0f )
     , m_bAnimate( false )
     , m_NumInstances( 6 )
+    , m_TexturedLitPermutations( GetTexturedLitKeywords() )
+    , m_NumStaticLights( 0 )
+    , m_DeferredShading( false )
 {
     pData = (AlignedData*)_aligned_malloc( sizeof(AlignedData), 16 );
+    ZeroMemory( &m_StateCacheStatistics, sizeof(StateCache::Statistics) );
     
     XMVECTOR cameraPos = XMVectorSet( 0, 5, -20, 1 );
     XMVECTOR cameraTarget = XMVectorSet( 0, 5, 0, 1 );
     XMVECTOR cameraUp = XMVectorSet( 0, 1, 0, 0 );
 
-    m_Camera.set_LookAt( cameraPos, cameraTarget, cameraUp );
+    m_Camera.set_LookAt( ToFloat3(cameraPos), ToFloat3(cameraTarget), ToFloat3(cameraUp) );
 
-    pData->m_InitialCameraPos = m_Camera.get_Translation();
-    pData->m_InitialCameraRot = m_Camera.get_Rotation();
+    pData->m_InitialCameraPos = XMLoad( m_Camera.get_Translation() );
+    pData->m_InitialCameraRot = XMLoad( m_Camera.get_Rotation() );
 }
 
 TextureAndLightingDemo::~TextureAndLightingDemo()
@@ -92,8 +114,46 @@ TextureAndLightingDemo::~TextureAndLightingDemo()
     _aligned_free(pData);
 }
 
+// The animated light i at the time (in radians) of its circle around the room.
+static Light AnimatedLight( int i, float totalTime )
+{
+    static const XMVECTORF32 LightColors[NumAnimatedLights] = {
+        Colors::White, Colors::Orange, Colors::Yellow, Colors::Green, Colors::Blue, Colors::Indigo, Colors::Violet, Colors::White
+    };
+
+    static const LightType LightTypes[NumAnimatedLights] = {
+        SpotLight, SpotLight, SpotLight, PointLight, SpotLight, SpotLight, SpotLight, PointLight
+    };
+
+    static const bool LightEnabled[NumAnimatedLights] = {
+        true, true, true, true, true, true, true, true
+    };
+
+    float radius = 8.0f;
+    float offset = 2.0f * XM_PI / NumAnimatedLights;
+
+    Light light;
+    light.Enabled = static_cast<int>(LightEnabled[i]);
+    light.LightType = LightTypes[i];
+    light.Color = ToFloat4( LightColors[i] );
+    light.SpotAngle = XMConvertToRadians(45.0f);
+    light.ConstantAttenuation = 1.0f;
+    light.LinearAttenuation = 0.08f;
+    light.QuadraticAttenuation = 0.0f;
+    Math::Float4 LightPosition = Math::Float4( std::sin( totalTime + offset * i ) * radius, 9.0f, std::cos( totalTime + offset * i ) * radius, 1.0f );
+    light.Position = LightPosition;
+    XMVECTOR LightDirection = XMVectorSet( -LightPosition.x, -LightPosition.y, -LightPosition.z, 0.0f );
+    LightDirection = XMVector3Normalize( LightDirection );
+    light.Direction = ToFloat4( LightDirection );
+    light.Range = AttenuationRange( light );
+
+    return light;
+}
+
 bool TextureAndLightingDemo::LoadContent()
 {
+    PROFILE_SCOPE( "LoadContent" );
+
     HRESULT hr = 0;
 
     m_EffectFactory = std::unique_ptr<EffectFactory>(new EffectFactory(m_d3dDevice.Get()));
@@ -106,7 +166,7 @@ bool TextureAndLightingDemo::LoadContent()
     }
     catch ( std::exception& )
     {
-        MessageBoxA(m_Window.get_WindowHandle(), "Failed to load texture.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to load texture." );
         return false;
     }
 
@@ -131,7 +191,7 @@ bool TextureAndLightingDemo::LoadContent()
     hr = m_d3dDevice->CreateSamplerState( &samplerDesc, &m_d3dSamplerState );
     if ( FAILED( hr ) )
     {
-        MessageBoxA(m_Window.get_WindowHandle(), "Failed to create texture sampler.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create texture sampler." );
         return false;
     }
 
@@ -140,22 +200,22 @@ bool TextureAndLightingDemo::LoadContent()
     m_MaterialProperties.push_back( defaultMaterial );
 
     MaterialProperties greenMaterial;
-    greenMaterial.Material.Ambient = XMFLOAT4(  0.07568f, 0.61424f, 0.07568f, 1.0f );
-    greenMaterial.Material.Diffuse = XMFLOAT4( 0.07568f, 0.61424f, 0.07568f, 1.0f );
-    greenMaterial.Material.Specular = XMFLOAT4( 0.07568f, 0.61424f, 0.07568f, 1.0f );
+    greenMaterial.Material.Ambient = Math::Float4(  0.07568f, 0.61424f, 0.07568f, 1.0f );
+    greenMaterial.Material.Diffuse = Math::Float4( 0.07568f, 0.61424f, 0.07568f, 1.0f );
+    greenMaterial.Material.Specular = Math::Float4( 0.07568f, 0.61424f, 0.07568f, 1.0f );
     greenMaterial.Material.SpecularPower = 76.8f;
     m_MaterialProperties.push_back( greenMaterial );
 
     MaterialProperties redPlasticMaterial;
-    redPlasticMaterial.Material.Diffuse = XMFLOAT4( 0.6f, 0.1f, 0.1f, 1.0f );
-    redPlasticMaterial.Material.Specular = XMFLOAT4( 1.0f, 0.2f, 0.2f, 1.0f );
+    redPlasticMaterial.Material.Diffuse = Math::Float4( 0.6f, 0.1f, 0.1f, 1.0f );
+    redPlasticMaterial.Material.Specular = Math::Float4( 1.0f, 0.2f, 0.2f, 1.0f );
     redPlasticMaterial.Material.SpecularPower = 32.0f;
     m_MaterialProperties.push_back( redPlasticMaterial );
 
     MaterialProperties pearlMaterial;
-    pearlMaterial.Material.Ambient = XMFLOAT4( 0.25f, 0.20725f, 0.20725f, 1.0f );
-    pearlMaterial.Material.Diffuse = XMFLOAT4( 1.0f, 0.829f, 0.829f, 1.0f );
-    pearlMaterial.Material.Specular = XMFLOAT4( 0.296648f, 0.296648f, 0.296648f, 1.0f );
+    pearlMaterial.Material.Ambient = Math::Float4( 0.25f, 0.20725f, 0.20725f, 1.0f );
+    pearlMaterial.Material.Diffuse = Math::Float4( 1.0f, 0.829f, 0.829f, 1.0f );
+    pearlMaterial.Material.Specular = Math::Float4( 0.296648f, 0.296648f, 0.296648f, 1.0f );
     pearlMaterial.Material.SpecularPower = 11.264f;
     m_MaterialProperties.push_back( pearlMaterial );
 
@@ -176,7 +236,7 @@ bool TextureAndLightingDemo::LoadContent()
     hr = m_d3dDevice->CreateBuffer( &vertexBufferDesc, &resourceData, &m_d3dPlaneVertexBuffer );
     if ( FAILED(hr) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create vertex buffer.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create vertex buffer." );
         return false;
     }
 
@@ -252,7 +312,7 @@ bool TextureAndLightingDemo::LoadContent()
 
     if ( FAILED(hr) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create instance buffer.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create instance buffer." );
         return false;
     }
     
@@ -270,14 +330,14 @@ bool TextureAndLightingDemo::LoadContent()
     hr = m_d3dDevice->CreateBuffer( &indexBufferDesc, &resourceData, &m_d3dPlaneIndexBuffer );
     if ( FAILED(hr) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create index buffer.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create index buffer." );
         return false;
     }
 
     hr = m_d3dDevice->CreateVertexShader( g_InstancedVertexShader, sizeof(g_InstancedVertexShader), nullptr, &m_d3dInstancedVertexShader );
     if ( FAILED(hr) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to load vertex shader.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to load vertex shader." );
         return false;
     }
 
@@ -302,84 +362,185 @@ bool TextureAndLightingDemo::LoadContent()
     hr = m_d3dDevice->CreateInputLayout( vertexLayoutDesc, _countof(vertexLayoutDesc), g_InstancedVertexShader, sizeof(g_InstancedVertexShader), &m_d3dInstancedInputLayout );
     if ( FAILED(hr) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create input layout.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create input layout." );
         return false;
     }
 
     hr = m_d3dDevice->CreatePixelShader( g_TexturedLitPixelShader, sizeof(g_TexturedLitPixelShader), nullptr, &m_d3dTexturedLitPixelShader );
     if ( FAILED(hr) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to load pixel shader.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to load pixel shader." );
         return false;
     }
 
-    // Create a constant buffer for the per-frame data required by the instanced vertex shader.
+    LoadTexturedLitVariants();
+
+    if ( m_DeferredShading )
+    {
+        hr = m_d3dDevice->CreatePixelShader( g_GBufferPixelShader, sizeof(g_GBufferPixelShader), nullptr, &m_d3dGBufferPixelShader );
+        if ( FAILED(hr) )
+        {
+            ReportError( "Failed to load the G-buffer pixel shader." );
+            return false;
+        }
+
+        hr = m_d3dDevice->CreateComputeShader( g_TiledDeferredComputeShader, sizeof(g_TiledDeferredComputeShader), nullptr, &m_d3dTiledDeferredComputeShader );
+        if ( FAILED(hr) )
+        {
+            ReportError( "Failed to load the tiled deferred compute shader." );
+            return false;
+        }
+
+        // The G-buffer is created again when the window is resized.
+        try
+        {
+            m_GBuffer.reset( new GBuffer( m_d3dDevice.Get(), m_Window.get_ClientWidth(), m_Window.get_ClientHeight() ) );
+        }
+        catch ( std::exception& )
+        {
+            ReportError( "Failed to create the G-buffer." );
+            return false;
+        }
+    }
+
+    // The per-frame, per-object, and material constants are sub-allocated from a single dynamic constant buffer.
+    try
+    {
+        m_DynamicConstantBuffer.reset( new DynamicConstantBuffer( m_d3dDevice.Get() ) );
+    }
+    catch ( std::exception& )
+    {
+        ReportError( "Failed to create the dynamic constant buffer." );
+        return false;
+    }
+
+    // Create a constant buffer for the light properties required by the pixel shader.
+    // The light properties only change when the lights are animated.
     D3D11_BUFFER_DESC constantBufferDesc;
     ZeroMemory( &constantBufferDesc, sizeof(D3D11_BUFFER_DESC) );
 
     constantBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-    constantBufferDesc.ByteWidth = sizeof( PerFrameConstantBufferData );
     constantBufferDesc.CPUAccessFlags = 0;
     constantBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-
-    hr = m_d3dDevice->CreateBuffer( &constantBufferDesc, nullptr, &m_d3dPerFrameConstantBuffer );
-    if ( FAILED(hr) )
+    constantBufferDesc.ByteWidth = sizeof( ClusteredLightProperties );
+    hr = m_d3dDevice->CreateBuffer( &constantBufferDesc, nullptr, &m_d3dLightPropertiesConstantBuffer );
+    if ( FAILED( hr ) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create constant buffer for per-frame data.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create constant buffer for light properties." );
         return false;
     }
 
-    // Create a constant buffer for the per-object data required by teh simple vertex shader.
-    constantBufferDesc.ByteWidth = sizeof( PerObjectConstantBufferData );
+    if ( m_DeferredShading )
+    {
+        constantBufferDesc.ByteWidth = sizeof( TiledDeferredConstants );
+        hr = m_d3dDevice->CreateBuffer( &constantBufferDesc, nullptr, &m_d3dTiledDeferredConstantBuffer );
+        if ( FAILED( hr ) )
+        {
+            ReportError( "Failed to create constant buffer for the tiled deferred constants." );
+            return false;
+        }
+    }
+
 
-    hr = m_d3dDevice->CreateBuffer( &constantBufferDesc, nullptr, &m_d3dPerObjectConstantBuffer );
-    if ( FAILED(hr) )
+    // Global ambient
+    m_LightProperties.GlobalAmbient = Math::Float4( 0.2f, 0.2f, 0.2f, 1.0f );
+
+    // The lights, the light clusters, and the light indices of the clusters are read
+    // by the pixel shader from structured buffers that grow with the number of lights.
+    try
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create constant buffer for per-object data.", "Error", MB_OK|MB_ICONERROR );
+        m_LightBuffer.reset( new LightBuffer( m_d3dDevice.Get(), NumAnimatedLights + 1 + m_NumStaticLights ) );
+        m_LightClusterBuffer.reset( new DynamicStructuredBuffer( m_d3dDevice.Get(), sizeof(LightCluster), m_LightClusters.get_NumClusters() ) );
+        m_LightIndexBuffer.reset( new DynamicStructuredBuffer( m_d3dDevice.Get(), sizeof(uint32_t), 4 * m_LightClusters.get_NumClusters() ) );
+        m_LightBoundsBuffer.reset( new DynamicStructuredBuffer( m_d3dDevice.Get(), sizeof(Math::Float4), NumAnimatedLights + 1 + m_NumStaticLights ) );
+    }
+    catch ( std::exception& )
+    {
+        ReportError( "Failed to create the structured buffers for the lights." );
         return false;
     }
-    
-    // Create a constant buffer for the material properties required by the pixel shader.
-    constantBufferDesc.ByteWidth = sizeof( MaterialProperties );
 
-    hr = m_d3dDevice->CreateBuffer( &constantBufferDesc, nullptr, &m_d3dMaterialPropertiesConstantBuffer );
-    if ( FAILED( hr ) )
+    // The spot lights and the sun cast shadows in both paths.
+    try
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create constant buffer for material properties.", "Error", MB_OK|MB_ICONERROR );
+        m_ShadowAtlasTexture.reset( new ShadowAtlasTexture( m_d3dDevice.Get(), m_ShadowAtlas.get_Size() ) );
+        m_ShadowMapBuffer.reset( new DynamicStructuredBuffer( m_d3dDevice.Get(), sizeof(ShadowMapConstants), NumAnimatedLights + NumCascades ) );
+    }
+    catch ( std::exception& )
+    {
+        ReportError( "Failed to create the shadow atlas." );
         return false;
     }
 
-    // Create a constant buffer for the light properties required by the pixel shader.
-    constantBufferDesc.ByteWidth = sizeof( LightProperties );
-    hr = m_d3dDevice->CreateBuffer( &constantBufferDesc, nullptr, &m_d3dLightPropertiesConstantBuffer );
-    if ( FAILED( hr ) )
+    hr = m_d3dDevice->CreateVertexShader( g_ShadowClearVertexShader, sizeof(g_ShadowClearVertexShader), nullptr, &m_d3dShadowClearVertexShader );
+    if ( FAILED(hr) )
     {
-        MessageBoxA( m_Window.get_WindowHandle(), "Failed to create constant buffer for light properties.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to load the shadow clear vertex shader." );
         return false;
     }
 
+    // The new atlas does not hold any of the cached shadow maps.
+    m_ShadowAtlasTexture->Clear( m_d3dDeviceContext.Get() );
+    m_ShadowCache.InvalidateAll();
 
-    // Global ambient
-    m_LightProperties.GlobalAmbient = XMFLOAT4( 0.2f, 0.2f, 0.2f, 1.0f );
+    m_LightManager.Clear();
+    m_AnimatedLights.clear();
+    for ( int i = 0; i < NumAnimatedLights; ++i )
+    {
+        m_AnimatedLights.push_back( m_LightManager.Add( AnimatedLight( i, 0.0f ) ) );
+    }
 
-    m_Sphere = Mesh::CreateSphere( m_d3dDeviceContext.Get(), 1.0f, 16, false );
+    // A dim sun that shines into the room from above, as if there was no ceiling.
+    Light sunLight;
+    sunLight.Enabled = 1;
+    sunLight.LightType = DirectionalLight;
+    sunLight.Color = Math::Float4( 0.3f, 0.3f, 0.25f, 1.0f );
+    sunLight.Direction = Math::Float4( Math::Normalize( Math::Float3( 0.4f, -1.0f, 0.3f ) ), 0.0f );
+    m_SunLight = m_LightManager.Add( sunLight );
+
+    // Scatter small point lights with random colors around the room (see set_NumStaticLights).
+    std::mt19937 random( 1234 );
+    std::uniform_real_distribution<float> positionXZ( -9.5f, 9.5f );
+    std::uniform_real_distribution<float> positionY( 0.25f, 6.0f );
+    std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+    for ( unsigned int i = 0; i < m_NumStaticLights; ++i )
+    {
+        Light light;
+        light.Enabled = 1;
+        light.LightType = PointLight;
+        light.Color = Math::Float4( unit( random ), unit( random ), unit( random ), 1.0f );
+        light.Position = Math::Float4( positionXZ( random ), positionY( random ), positionXZ( random ), 1.0f );
+        light.ConstantAttenuation = 1.0f;
+        light.LinearAttenuation = 0.0f;
+        light.QuadraticAttenuation = 16.0f + 48.0f * unit( random );
+        light.Range = AttenuationRange( light );
+        m_LightManager.Add( light );
+    }
+
+    // Cache the generated meshes so they are only generated on the first run.
+    CreateDirectoryA( "..\\data\\MeshCache", nullptr );
+    m_MeshCache.reset( new MeshCache( "..\\data\\MeshCache" ) );
+    Mesh::set_Cache( m_MeshCache.get() );
+
+    // The sphere and the torus have levels of detail that are selected by their size on the screen.
+    m_Sphere = Mesh::CreateSphere( m_d3dDeviceContext.Get(), 1.0f, 32, false, Mesh::FullPrecisionVertices, 4 );
     m_Cube = Mesh::CreateCube( m_d3dDeviceContext.Get(), 1.0f, false );
     m_Cone = Mesh::CreateCone( m_d3dDeviceContext.Get(), 1.0f, 1.0f, 32, false );
-    m_Torus = Mesh::CreateTorus( m_d3dDeviceContext.Get(), 1.0f, 0.33f, 32, false );
+    m_Torus = Mesh::CreateTorus( m_d3dDeviceContext.Get(), 1.0f, 0.33f, 32, false, Mesh::FullPrecisionVertices, 4 );
 
     // Load a simple vertex shader that will be used to render the shapes.
     hr = m_d3dDevice->CreateVertexShader( g_SimpleVertexShader, sizeof(g_SimpleVertexShader), nullptr, &m_d3dSimplVertexShader );
     if ( FAILED(hr) )
     {
-        MessageBoxA(m_Window.get_WindowHandle(), "Failed to create the simple vertex shader.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create the simple vertex shader." );
         return false;
     }
 
     // Create the input layout for the simple shapes.
-    hr = m_d3dDevice->CreateInputLayout( VertexPositionNormalTexture::InputElements, VertexPositionNormalTexture::InputElementCount, g_SimpleVertexShader, sizeof(g_SimpleVertexShader), &m_d3dVertexPositionNormalTextureInputLayout );
+    hr = m_d3dDevice->CreateInputLayout( VertexInputLayout<VertexPositionNormalTexture>::InputElements, VertexInputLayout<VertexPositionNormalTexture>::InputElementCount, g_SimpleVertexShader, sizeof(g_SimpleVertexShader), &m_d3dVertexPositionNormalTextureInputLayout );
     if ( FAILED(hr) )
     {
-        MessageBoxA(m_Window.get_WindowHandle(), "Failed to create the input layout for the simple vertex shader.", "Error", MB_OK|MB_ICONERROR );
+        ReportError( "Failed to create the input layout for the simple vertex shader." );
         return false;
     }
     
@@ -397,58 +558,27 @@ void TextureAndLightingDemo::OnUpdate( UpdateEventArgs& e )
 
     XMVECTOR cameraTranslate = XMVectorSet( static_cast<float>(m_D - m_A), 0.0f, static_cast<float>(m_W - m_S), 1.0f ) * speedMultipler * e.ElapsedTime;
     XMVECTOR cameraPan = XMVectorSet( 0.0f, static_cast<float>(m_E - m_Q), 0.0f, 1.0f ) * speedMultipler * e.ElapsedTime;
-    m_Camera.Translate( cameraTranslate, Camera::LocalSpace );
-    m_Camera.Translate( cameraPan, Camera::WorldSpace );
+    m_Camera.Translate( ToFloat3(cameraTranslate), Camera::LocalSpace );
+    m_Camera.Translate( ToFloat3(cameraPan), Camera::WorldSpace );
 
     XMVECTOR cameraRotation = XMQuaternionRotationRollPitchYaw( XMConvertToRadians(m_Pitch), XMConvertToRadians(m_Yaw), 0.0f );
-    m_Camera.set_Rotation( cameraRotation );
-
-    // Update the light properties
-    XMStoreFloat4( &m_LightProperties.EyePosition, m_Camera.get_Translation() );
+    m_Camera.set_Rotation( ToFloat4(cameraRotation) );
 
     static float totalTime = 0.0f;
 
+    // The lights only need to be uploaded again when they move.
     if ( m_bAnimate )
     {
-        totalTime += e.ElapsedTime * 0.5f * XM_PI;
-    }
-
-    static const XMVECTORF32 LightColors[MAX_LIGHTS] = {
-        Colors::White, Colors::Orange, Colors::Yellow, Colors::Green, Colors::Blue, Colors::Indigo, Colors::Violet, Colors::White
-    };
-
-    static const LightType LightTypes[MAX_LIGHTS] = {
-        SpotLight, SpotLight, SpotLight, PointLight, SpotLight, SpotLight, SpotLight, PointLight
-    };
-
-    static const bool LightEnabled[MAX_LIGHTS] = {
-        true, true, true, true, true, true, true, true
-    };
-
-    const int numLights = MAX_LIGHTS;
-    float radius = 8.0f;
-    float offset = 2.0f * XM_PI / numLights;
-    for( int i = 0; i < numLights; ++i )
-    {
-        Light light;
-        light.Enabled = static_cast<int>(LightEnabled[i]);
-        light.LightType = LightTypes[i];
-        light.Color = XMFLOAT4(LightColors[i]);
-        light.SpotAngle = XMConvertToRadians(45.0f);
-        light.ConstantAttenuation = 1.0f;
-        light.LinearAttenuation = 0.08f;
-        light.QuadraticAttenuation = 0.0f;
-        XMFLOAT4 LightPosition = XMFLOAT4( std::sin( totalTime + offset * i ) * radius, 9.0f, std::cos( totalTime + offset * i ) * radius, 1.0f );
-        light.Position = LightPosition;
-        XMVECTOR LightDirection = XMVectorSet( -LightPosition.x, -LightPosition.y, -LightPosition.z, 0.0f );
-        LightDirection = XMVector3Normalize( LightDirection );
-        XMStoreFloat4( &light.Direction, LightDirection );
+        // Keep the angle in one period so it does not lose precision when the demo runs for days.
+        totalTime = std::fmod( totalTime + e.ElapsedTime * 0.5f * XM_PI, XM_2PI );
 
-        m_LightProperties.Lights[i] = light;
+        for ( int i = 0; i < NumAnimatedLights; ++i )
+        {
+            Light light = AnimatedLight( i, totalTime );
+            m_LightManager.SetPosition( m_AnimatedLights[i], Math::XYZ( light.Position ) );
+            m_LightManager.SetDirection( m_AnimatedLights[i], Math::XYZ( light.Direction ) );
+        }
     }
-
-    // Update the light properties
-    m_d3dDeviceContext->UpdateSubresource( m_d3dLightPropertiesConstantBuffer.Get(), 0, nullptr, &m_LightProperties, 0, 0 );
 }
 
 // Builds a look-at (world) matrix from a point, up and direction vectors.
@@ -471,157 +601,708 @@ XMMATRIX XM_CALLCONV LookAtMatrix( FXMVECTOR Position, FXMVECTOR Direction, FXMV
     return M;
 }
 
-void TextureAndLightingDemo::OnRender( RenderEventArgs& e )
+static PerObjectConstantBufferData ComputePerObjectConstants( FXMMATRIX worldMatrix, CXMMATRIX viewProjectionMatrix )
 {
-    Clear( DirectX::Colors::CornflowerBlue, 1.0f, 0 );
-    
-    float aspectRatio = m_Window.get_ClientWidth() / (float)m_Window.get_ClientHeight();
+    PerObjectConstantBufferData perObjectConstantBufferData;
+    perObjectConstantBufferData.WorldMatrix = worldMatrix;
+    perObjectConstantBufferData.InverseTransposeWorldMatrix = XMMatrixTranspose( XMMatrixInverse(nullptr, worldMatrix) );
+    perObjectConstantBufferData.WorldViewProjectionMatrix = worldMatrix * viewProjectionMatrix;
 
-    XMMATRIX viewMatrix = m_Camera.get_ViewMatrix();
-    XMMATRIX projectionMatrix = m_Camera.get_ProjectionMatrix();
-    XMMATRIX viewProjectionMatrix = viewMatrix * projectionMatrix;
+    return perObjectConstantBufferData;
+}
 
-    PerFrameConstantBufferData constantBufferData;
-    constantBufferData.ViewProjectionMatrix = viewProjectionMatrix;
+// The IDs of the vertex shaders and textures used to build the sort keys of the render queue.
+// The material ID is the index of the material in m_MaterialProperties (or 4 + the light index).
+enum ShaderID
+{
+    InstancedShaderID,
+    SimpleShaderID,
+    ShaderIDCount,
+};
 
-    MaterialProperties wallMaterial = m_MaterialProperties[1];
-    wallMaterial.Material.UseTexture = true;
+enum TextureID
+{
+    DirectXTextureID,
+    EarthTextureID,
+};
 
-    m_d3dDeviceContext->UpdateSubresource( m_d3dPerFrameConstantBuffer.Get(), 0, nullptr, &constantBufferData, 0, 0 );
-    m_d3dDeviceContext->UpdateSubresource( m_d3dMaterialPropertiesConstantBuffer.Get(), 0, nullptr, &wallMaterial, 0, 0 );
+// The shader field of a sort key: the variant of the pixel shader (see GetPixelShaderVariant)
+// and the vertex shader, so the draw calls that use the same variant are next to each other.
+static uint32_t ShaderSortID( uint32_t pixelShaderVariant, ShaderID vertexShader )
+{
+    return pixelShaderVariant * ShaderIDCount + vertexShader;
+}
 
-    const UINT vertexStride[2] = { sizeof(VertexPosNormTex), sizeof(PlaneInstanceData) };
-    const UINT offset[2] = { 0, 0 };
-    ID3D11Buffer* buffers[2] = { m_d3dPlaneVertexBuffer.Get(), m_d3dPlaneInstanceBuffer.Get() };
+// The distance from the camera to the origin of an object normalized
+// to the range [0, 1] for the sort key of the render queue.
+static float ViewDepth( FXMMATRIX worldMatrix, CXMMATRIX viewMatrix )
+{
+    const float farClipPlane = 100.0f;
+    return XMVectorGetZ( XMVector3Transform( worldMatrix.r[3], viewMatrix ) ) / farClipPlane;
+}
 
-    m_d3dDeviceContext->IASetVertexBuffers( 0, 2, buffers, vertexStride, offset );
-    m_d3dDeviceContext->IASetInputLayout( m_d3dInstancedInputLayout.Get() );
-    m_d3dDeviceContext->IASetIndexBuffer( m_d3dPlaneIndexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0 );
-    m_d3dDeviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+// Transform the bounding sphere of a mesh to world space.
+static BoundingSphere WorldBounds( const Mesh& mesh, FXMMATRIX worldMatrix )
+{
+    return Transform( mesh.get_BoundingSphere(), ToFloat4x4( worldMatrix ) );
+}
 
-    m_d3dDeviceContext->RSSetState( m_d3dRasterizerState.Get() );
-    D3D11_VIEWPORT viewport = m_Camera.get_Viewport();
-    m_d3dDeviceContext->RSSetViewports( 1, &viewport ); 
+void TextureAndLightingDemo::SubmitObject( uint64_t sortKey, const DrawCommand& drawCommand, const BoundingSphere& bounds )
+{
+    m_ObjectBounds.Add( bounds );
+    m_ObjectSortKeys.push_back( sortKey );
+    m_ObjectDrawCommands.push_back( drawCommand );
+}
+
+void TextureAndLightingDemo::OnRender( RenderEventArgs& e )
+{
+    {
+        GPU_PROFILE_SCOPE( get_GpuProfiler(), "Clear" );
+        Clear( DirectX::Colors::CornflowerBlue, 1.0f, 0 );
+        if ( m_DeferredShading )
+        {
+            // The lighting pass outputs the clear color of the ambient target where there is no geometry.
+            m_GBuffer->Clear( m_d3dDeviceContext.Get(), DirectX::Colors::CornflowerBlue );
+        }
+    }
+    
+    float aspectRatio = m_Window.get_ClientWidth() / (float)m_Window.get_ClientHeight();
 
-    m_d3dDeviceContext->VSSetShader( m_d3dInstancedVertexShader.Get(), nullptr, 0 );
-    m_d3dDeviceContext->VSSetConstantBuffers( 0, 1, m_d3dPerFrameConstantBuffer.GetAddressOf() );
+    XMMATRIX viewMatrix = XMLoad( m_Camera.get_ViewMatrix() );
+    XMMATRIX projectionMatrix = XMLoad( m_Camera.get_ProjectionMatrix() );
+    XMMATRIX viewProjectionMatrix = viewMatrix * projectionMatrix;
 
-    m_d3dDeviceContext->PSSetShader( m_d3dTexturedLitPixelShader.Get(), nullptr, 0 );
+    UpdateShadowMaps();
 
-    ID3D11Buffer* pixelShaderConstantBuffers[2] = { m_d3dMaterialPropertiesConstantBuffer.Get(), m_d3dLightPropertiesConstantBuffer.Get() };
-    m_d3dDeviceContext->PSSetConstantBuffers( 0, 2, pixelShaderConstantBuffers );
+    // Allocate the constants for all of the draw calls before any of them are
+    // bound so that they are uploaded to the GPU with a single Map.
+    m_DynamicConstantBuffer->BeginFrame( m_d3dDeviceContext.Get() );
 
-    m_d3dDeviceContext->PSSetSamplers( 0, 1, m_d3dSamplerState.GetAddressOf() );
-    m_d3dDeviceContext->PSSetShaderResources( 0, 1, m_DirectXTexture.GetAddressOf() );
+    PerFrameConstantBufferData constantBufferData;
+    constantBufferData.ViewProjectionMatrix = viewProjectionMatrix;
 
-    m_d3dDeviceContext->OMSetRenderTargets( 1, m_d3dRenderTargetView.GetAddressOf(), m_d3dDepthStencilView.Get() );
-    m_d3dDeviceContext->OMSetDepthStencilState( m_d3dDepthStencilState.Get(), 0 );
+    MaterialProperties wallMaterial = m_MaterialProperties[1];
+    wallMaterial.Material.UseTexture = true;
 
-    m_d3dDeviceContext->DrawIndexedInstanced( _countof(g_PlaneIndex), m_NumInstances, 0, 0, 0 );
+    MaterialProperties cubeMaterial = m_MaterialProperties[2];
+    MaterialProperties torusMaterial = m_MaterialProperties[3];
 
-    // Draw the sphere
+    DynamicConstantBuffer::Allocation perFrameConstants = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), constantBufferData );
+    DynamicConstantBuffer::Allocation wallMaterialConstants = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), wallMaterial );
+
+    // The sphere
     XMMATRIX translationMatrix = XMMatrixTranslation( -4.0f, 2.0f, -4.0f );
     XMMATRIX rotationMatrix = XMMatrixIdentity();
     XMMATRIX scaleMatrix = XMMatrixScaling( 4.0f, 4.0f, 4.0f );
     XMMATRIX worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
 
-    PerObjectConstantBufferData perObjectConstantBufferData;
-    perObjectConstantBufferData.WorldMatrix = worldMatrix;
-    perObjectConstantBufferData.InverseTransposeWorldMatrix = XMMatrixTranspose( XMMatrixInverse(nullptr, worldMatrix) );
-    perObjectConstantBufferData.WorldViewProjectionMatrix = worldMatrix * viewProjectionMatrix;
-
-    m_d3dDeviceContext->UpdateSubresource( m_d3dPerObjectConstantBuffer.Get(), 0, nullptr, &perObjectConstantBufferData, 0, 0 );
-
     MaterialProperties sphereMaterial = m_MaterialProperties[0];
     sphereMaterial.Material.UseTexture = true;
 
-    m_d3dDeviceContext->UpdateSubresource( m_d3dMaterialPropertiesConstantBuffer.Get(), 0, nullptr, &sphereMaterial, 0, 0 );
-    
-    m_d3dDeviceContext->VSSetShader( m_d3dSimplVertexShader.Get(), nullptr, 0 );
-    m_d3dDeviceContext->VSSetConstantBuffers( 0, 1, m_d3dPerObjectConstantBuffer.GetAddressOf() );
-    
-    m_d3dDeviceContext->PSSetShaderResources( 0, 1, m_EarthTexture.GetAddressOf() );
-
-    m_d3dDeviceContext->IASetInputLayout( m_d3dVertexPositionNormalTextureInputLayout.Get() );
+    XMMATRIX sphereWorldMatrix = worldMatrix;
+    float sphereDepth = ViewDepth( worldMatrix, viewMatrix );
+    BoundingSphere sphereBounds = WorldBounds( *m_Sphere, worldMatrix );
+    size_t sphereLod = m_Sphere->SelectLod( m_Camera, ToFloat4x4( worldMatrix ) );
+    DynamicConstantBuffer::Allocation sphereConstants = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), ComputePerObjectConstants( worldMatrix, viewProjectionMatrix ) );
+    DynamicConstantBuffer::Allocation sphereMaterialConstants = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), sphereMaterial );
 
-    m_Sphere->Draw( m_d3dDeviceContext.Get() );
-
-    // Draw a cube
+    // The cube
     translationMatrix = XMMatrixTranslation( 4.0f, 4.0f, 4.0f );
     rotationMatrix = XMMatrixRotationY( XMConvertToRadians(45.0f) );
     scaleMatrix = XMMatrixScaling( 4.0f, 8.0f, 4.0f );
     worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
 
-    perObjectConstantBufferData.WorldMatrix = worldMatrix;
-    perObjectConstantBufferData.InverseTransposeWorldMatrix = XMMatrixTranspose( XMMatrixInverse(nullptr, worldMatrix) );
-    perObjectConstantBufferData.WorldViewProjectionMatrix = worldMatrix * viewProjectionMatrix;
-
-    m_d3dDeviceContext->UpdateSubresource( m_d3dPerObjectConstantBuffer.Get(), 0, nullptr, &perObjectConstantBufferData, 0, 0 );
+    XMMATRIX cubeWorldMatrix = worldMatrix;
+    float cubeDepth = ViewDepth( worldMatrix, viewMatrix );
+    BoundingSphere cubeBounds = WorldBounds( *m_Cube, worldMatrix );
+    DynamicConstantBuffer::Allocation cubeConstants = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), ComputePerObjectConstants( worldMatrix, viewProjectionMatrix ) );
+    DynamicConstantBuffer::Allocation cubeMaterialConstants = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), cubeMaterial );
 
-    m_d3dDeviceContext->UpdateSubresource( m_d3dMaterialPropertiesConstantBuffer.Get(), 0, nullptr, &m_MaterialProperties[2], 0, 0 );
-
-    m_Cube->Draw( m_d3dDeviceContext.Get() );
-
-    // Draw a torus
+    // The torus
     translationMatrix = XMMatrixTranslation( 4.0f, 0.5f, -4.0f );
     rotationMatrix = XMMatrixRotationY( XMConvertToRadians(45.0f) );
     scaleMatrix = XMMatrixScaling( 4.0f, 4.0f, 4.0f );
     worldMatrix = scaleMatrix * rotationMatrix * translationMatrix;
 
-    perObjectConstantBufferData.WorldMatrix = worldMatrix;
-    perObjectConstantBufferData.InverseTransposeWorldMatrix = XMMatrixTranspose( XMMatrixInverse(nullptr, worldMatrix) );
-    perObjectConstantBufferData.WorldViewProjectionMatrix = worldMatrix * viewProjectionMatrix;
+    XMMATRIX torusWorldMatrix = worldMatrix;
+    float torusDepth = ViewDepth( worldMatrix, viewMatrix );
+    BoundingSphere torusBounds = WorldBounds( *m_Torus, worldMatrix );
+    size_t torusLod = m_Torus->SelectLod( m_Camera, ToFloat4x4( worldMatrix ) );
+    DynamicConstantBuffer::Allocation torusConstants = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), ComputePerObjectConstants( worldMatrix, viewProjectionMatrix ) );
+    DynamicConstantBuffer::Allocation torusMaterialConstants = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), torusMaterial );
 
-    m_d3dDeviceContext->UpdateSubresource( m_d3dPerObjectConstantBuffer.Get(), 0, nullptr, &perObjectConstantBufferData, 0, 0 );
-    m_d3dDeviceContext->UpdateSubresource( m_d3dMaterialPropertiesConstantBuffer.Get(), 0, nullptr, &m_MaterialProperties[3], 0, 0 );
+    // Geometry at the position of the active animated lights in the scene.
+    DynamicConstantBuffer::Allocation lightConstants[NumAnimatedLights];
+    DynamicConstantBuffer::Allocation lightMaterialConstants[NumAnimatedLights];
+    float lightDepths[NumAnimatedLights];
+    BoundingSphere lightBounds[NumAnimatedLights];
 
-    m_Torus->Draw( m_d3dDeviceContext.Get() );
-
-    // Draw geometry at the position of the active lights in the scene.
     MaterialProperties lightMaterial = m_MaterialProperties[0];
-    for ( int i = 0; i < MAX_LIGHTS; ++i )
+    for ( int i = 0; i < NumAnimatedLights; ++i )
     {
-        Light* pLight = &(m_LightProperties.Lights[i]);
-        if ( !pLight->Enabled ) continue;
+        Light light = m_LightManager.Get( m_AnimatedLights[i] );
+        if ( !light.Enabled ) continue;
 
-        XMVECTOR lightPos = XMLoadFloat4( &(pLight->Position) );
-        XMVECTOR lightDir = XMLoadFloat4( &(pLight->Direction) );
+        XMVECTOR lightPos = XMLoad( light.Position );
+        XMVECTOR lightDir = XMLoad( light.Direction );
         XMVECTOR UpDirection = XMVectorSet( 0, 1, 0, 0 );
 
         scaleMatrix = XMMatrixScaling( 1.0f, 1.0f, 1.0f );
         rotationMatrix = XMMatrixRotationX( -90.0f );
         worldMatrix = scaleMatrix * rotationMatrix * LookAtMatrix( lightPos, lightDir, UpDirection );
 
-        perObjectConstantBufferData.WorldMatrix = worldMatrix;
-        perObjectConstantBufferData.InverseTransposeWorldMatrix = XMMatrixTranspose( XMMatrixInverse(nullptr, worldMatrix) );
-        perObjectConstantBufferData.WorldViewProjectionMatrix = worldMatrix * viewProjectionMatrix;
+        lightMaterial.Material.Emissive = light.Color;
+
+        lightDepths[i] = ViewDepth( worldMatrix, viewMatrix );
+        lightBounds[i] = WorldBounds( ( light.LightType == PointLight ) ? *m_Sphere : *m_Cone, worldMatrix );
+        lightConstants[i] = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), ComputePerObjectConstants( worldMatrix, viewProjectionMatrix ) );
+        lightMaterialConstants[i] = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), lightMaterial );
+    }
+
+    // The walls, the sphere, the cube, and the torus cast shadows (the light geometry does not).
+    // The walls do not cast shadows into the cascades of the sun, since the sun shines over them.
+    for ( size_t i = 0; i < m_ShadowPasses.size(); ++i )
+    {
+        ShadowPass& shadowPass = m_ShadowPasses[i];
+        XMMATRIX shadowViewProjectionMatrix = XMLoad( shadowPass.ViewProjectionMatrix );
+
+        PerFrameConstantBufferData shadowConstantBufferData;
+        shadowConstantBufferData.ViewProjectionMatrix = shadowViewProjectionMatrix;
+
+        shadowPass.WallsConstants = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), shadowConstantBufferData );
+        shadowPass.SphereConstants = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), ComputePerObjectConstants( sphereWorldMatrix, shadowViewProjectionMatrix ) );
+        shadowPass.CubeConstants = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), ComputePerObjectConstants( cubeWorldMatrix, shadowViewProjectionMatrix ) );
+        shadowPass.TorusConstants = m_DynamicConstantBuffer->Allocate( m_d3dDeviceContext.Get(), ComputePerObjectConstants( torusWorldMatrix, shadowViewProjectionMatrix ) );
+    }
+
+    m_DynamicConstantBuffer->Commit( m_d3dDeviceContext.Get() );
+
+    // Assign the view-space bounds of the lights to the clusters of the view frustum,
+    // and upload the lights, the clusters, and the light indices. The deferred path
+    // uploads the view-space bounds instead and culls the lights on the GPU.
+    if ( m_DeferredShading )
+    {
+        PROFILE_SCOPE( "UploadLights" );
+
+        m_LightManager.ComputeBounds( m_Camera.get_ViewMatrix(), m_LightViewBounds );
+        m_LightViewSpheres.resize( m_LightViewBounds.Size() );
+        for ( size_t i = 0; i < m_LightViewBounds.Size(); ++i )
+        {
+            BoundingSphere bounds = m_LightViewBounds.Get( i );
+            m_LightViewSpheres[i] = Math::Float4( bounds.Center, bounds.Radius );
+        }
 
-        lightMaterial.Material.Emissive = pLight->Color;
+        m_LightBuffer->Update( m_d3dDeviceContext.Get(), m_LightManager );
+        m_LightBoundsBuffer->Update( m_d3dDeviceContext.Get(), m_LightViewSpheres );
+
+        TiledDeferredConstants tiledDeferredConstants = ComputeTiledDeferredConstants( m_Camera, m_GBuffer->get_Width(), m_GBuffer->get_Height(),
+            m_LightManager.get_NumLights() );
+        m_d3dDeviceContext->UpdateSubresource( m_d3dTiledDeferredConstantBuffer.Get(), 0, nullptr, &tiledDeferredConstants, 0, 0 );
+
+        // The G-buffer pixel shader reads the eye position and the global ambient.
+        m_LightProperties.EyePosition = Math::Float4( m_Camera.get_Translation(), 1.0f );
+        m_d3dDeviceContext->UpdateSubresource( m_d3dLightPropertiesConstantBuffer.Get(), 0, nullptr, &m_LightProperties, 0, 0 );
+    }
+    else
+    {
+        PROFILE_SCOPE( "AssignLights" );
+
+        m_LightManager.ComputeBounds( m_Camera.get_ViewMatrix(), m_LightViewBounds );
+        m_LightClusters.AssignLights( m_LightViewBounds, &get_JobSystem() );
+
+        m_LightBuffer->Update( m_d3dDeviceContext.Get(), m_LightManager );
+        m_LightClusterBuffer->Update( m_d3dDeviceContext.Get(), m_LightClusters.get_Clusters() );
+        m_LightIndexBuffer->Update( m_d3dDeviceContext.Get(), m_LightClusters.get_LightIndices() );
+
+        m_LightProperties.EyePosition = Math::Float4( m_Camera.get_Translation(), 1.0f );
+        m_LightProperties.Clusters = m_LightClusters.GetConstants( m_Camera.get_Viewport() );
+        m_d3dDeviceContext->UpdateSubresource( m_d3dLightPropertiesConstantBuffer.Get(), 0, nullptr, &m_LightProperties, 0, 0 );
+    }
+
+    // The light buffer was uploaded with the shadow indices that UpdateShadowMaps set.
+    {
+        GPU_PROFILE_SCOPE( get_GpuProfiler(), "Shadows" );
+        RenderShadowMaps();
+    }
+
+    D3D11_VIEWPORT viewport = ToD3D11Viewport( m_Camera.get_Viewport() );
+    m_d3dDeviceContext->RSSetViewports( 1, &viewport ); 
+
+    m_d3dDeviceContext->PSSetSamplers( 0, 1, m_d3dSamplerState.GetAddressOf() );
+    if ( !m_DeferredShading )
+    {
+        ID3D11SamplerState* shadowSampler = m_ShadowAtlasTexture->get_SamplerState();
+        m_d3dDeviceContext->PSSetSamplers( 1, 1, &shadowSampler );
+    }
+
+    if ( m_DeferredShading )
+    {
+        m_GBuffer->SetRenderTargets( m_d3dDeviceContext.Get() );
+    }
+    else
+    {
+        m_d3dDeviceContext->OMSetRenderTargets( 1, m_d3dRenderTargetView.GetAddressOf(), m_d3dDepthStencilView.Get() );
+    }
+
+    // Submit the draw calls to the render queue. The queue sorts the draw calls
+    // by shader, material, and texture to minimize the state changes.
+    m_RenderQueue.Clear();
+
+    // The state that is shared by all of the draw calls.
+    ConstantBufferBinding lightPropertiesBinding = { m_d3dLightPropertiesConstantBuffer.Get(), 0, 0 };
+
+    DrawCommand drawCommand = {};
+    drawCommand.NumVSConstantBuffers = 1;
+    drawCommand.RasterizerState = m_d3dRasterizerState.Get();
+    drawCommand.PSConstantBuffers[1] = lightPropertiesBinding;
+    drawCommand.NumPSConstantBuffers = 2;
+    if ( m_DeferredShading )
+    {
+        // The G-buffer pass only reads the texture.
+        drawCommand.NumPSShaderResources = 1;
+    }
+    else
+    {
+        drawCommand.PSShaderResources[1] = m_LightBuffer->get_ShaderResourceView();
+        drawCommand.PSShaderResources[2] = m_LightClusterBuffer->get_ShaderResourceView();
+        drawCommand.PSShaderResources[3] = m_LightIndexBuffer->get_ShaderResourceView();
+        drawCommand.PSShaderResources[4] = m_ShadowMapBuffer->get_ShaderResourceView();
+        drawCommand.PSShaderResources[5] = m_ShadowAtlasTexture->get_ShaderResourceView();
+        drawCommand.NumPSShaderResources = 6;
+    }
+    drawCommand.DepthStencilState = m_d3dDepthStencilState.Get();
+
+    // The walls of the room.
+    DrawCommand wallsCommand = drawCommand;
+    wallsCommand.InputLayout = m_d3dInstancedInputLayout.Get();
+    wallsCommand.PrimitiveTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    VertexBufferBinding planeVertexBuffer = { m_d3dPlaneVertexBuffer.Get(), sizeof(VertexPosNormTex), 0 };
+    VertexBufferBinding planeInstanceBuffer = { m_d3dPlaneInstanceBuffer.Get(), sizeof(PlaneInstanceData), 0 };
+    wallsCommand.VertexBuffers[0] = planeVertexBuffer;
+    wallsCommand.VertexBuffers[1] = planeInstanceBuffer;
+    wallsCommand.NumVertexBuffers = 2;
+    wallsCommand.IndexBuffer = m_d3dPlaneIndexBuffer.Get();
+    wallsCommand.IndexFormat = DXGI_FORMAT_R16_UINT;
+    wallsCommand.VertexShader = m_d3dInstancedVertexShader.Get();
+    wallsCommand.PixelShader = GetPixelShader( wallMaterial );
+    wallsCommand.VSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( perFrameConstants );
+    wallsCommand.PSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( wallMaterialConstants );
+    wallsCommand.PSShaderResources[0] = m_DirectXTexture.Get();
+    wallsCommand.IndexCount = _countof(g_PlaneIndex);
+    wallsCommand.InstanceCount = m_NumInstances;
+
+    m_RenderQueue.Submit( SortKey::Opaque( 0, ShaderSortID( GetPixelShaderVariant( wallMaterial ), InstancedShaderID ), 1, DirectXTextureID, 1.0f ), wallsCommand );
+
+    // The simple shapes are culled against the view frustum before they are submitted to the render queue.
+    m_ObjectBounds.Clear();
+    m_ObjectSortKeys.clear();
+    m_ObjectDrawCommands.clear();
+
+    drawCommand.InputLayout = m_d3dVertexPositionNormalTextureInputLayout.Get();
+    drawCommand.VertexShader = m_d3dSimplVertexShader.Get();
+
+    DrawCommand sphereCommand = drawCommand;
+    m_Sphere->SetupDrawCommand( sphereCommand, 0, sphereLod );
+    sphereCommand.PixelShader = GetPixelShader( sphereMaterial );
+    sphereCommand.VSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( sphereConstants );
+    sphereCommand.PSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( sphereMaterialConstants );
+    sphereCommand.PSShaderResources[0] = m_EarthTexture.Get();
+    SubmitObject( SortKey::Opaque( 0, ShaderSortID( GetPixelShaderVariant( sphereMaterial ), SimpleShaderID ), 0, EarthTextureID, sphereDepth ), sphereCommand, sphereBounds );
+
+    // The cube and the torus are not textured. The earth texture is left bound
+    // so that the texture does not change between the draw calls.
+    DrawCommand cubeCommand = drawCommand;
+    m_Cube->SetupDrawCommand( cubeCommand );
+    cubeCommand.PixelShader = GetPixelShader( cubeMaterial );
+    cubeCommand.VSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( cubeConstants );
+    cubeCommand.PSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( cubeMaterialConstants );
+    cubeCommand.PSShaderResources[0] = m_EarthTexture.Get();
+    SubmitObject( SortKey::Opaque( 0, ShaderSortID( GetPixelShaderVariant( cubeMaterial ), SimpleShaderID ), 2, EarthTextureID, cubeDepth ), cubeCommand, cubeBounds );
+
+    DrawCommand torusCommand = drawCommand;
+    m_Torus->SetupDrawCommand( torusCommand, 0, torusLod );
+    torusCommand.PixelShader = GetPixelShader( torusMaterial );
+    torusCommand.VSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( torusConstants );
+    torusCommand.PSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( torusMaterialConstants );
+    torusCommand.PSShaderResources[0] = m_EarthTexture.Get();
+    SubmitObject( SortKey::Opaque( 0, ShaderSortID( GetPixelShaderVariant( torusMaterial ), SimpleShaderID ), 3, EarthTextureID, torusDepth ), torusCommand, torusBounds );
+
+    // Geometry at the position of the active animated lights in the scene.
+    for ( int i = 0; i < NumAnimatedLights; ++i )
+    {
+        Light light = m_LightManager.Get( m_AnimatedLights[i] );
+        if ( !light.Enabled ) continue;
 
-        m_d3dDeviceContext->UpdateSubresource( m_d3dPerObjectConstantBuffer.Get(), 0, nullptr, &perObjectConstantBufferData, 0, 0 );
-        m_d3dDeviceContext->UpdateSubresource( m_d3dMaterialPropertiesConstantBuffer.Get(), 0, nullptr, &lightMaterial, 0, 0 );
-        switch( pLight->LightType )
+        DrawCommand lightCommand = drawCommand;
+        switch( light.LightType )
         {
         case PointLight:
             {
-                m_Sphere->Draw( m_d3dDeviceContext.Get() );
+                m_Sphere->SetupDrawCommand( lightCommand );
             }
             break;
         case DirectionalLight:
         case SpotLight:
             {
-                m_Cone->Draw( m_d3dDeviceContext.Get() );
+                m_Cone->SetupDrawCommand( lightCommand );
             }
             break;
         }
+        lightCommand.PixelShader = GetPixelShader( lightMaterial );
+        lightCommand.VSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( lightConstants[i] );
+        lightCommand.PSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( lightMaterialConstants[i] );
+        lightCommand.PSShaderResources[0] = m_EarthTexture.Get();
+        SubmitObject( SortKey::Opaque( 0, ShaderSortID( GetPixelShaderVariant( lightMaterial ), SimpleShaderID ), 4 + i, EarthTextureID, lightDepths[i] ), lightCommand, lightBounds[i] );
+    }
+
+    m_Camera.get_Frustum().Cull( m_ObjectBounds, m_VisibleObjects );
+    for ( size_t i = 0; i < m_VisibleObjects.size(); ++i )
+    {
+        uint32_t objectIndex = m_VisibleObjects[i];
+        m_RenderQueue.Submit( m_ObjectSortKeys[objectIndex], m_ObjectDrawCommands[objectIndex] );
+    }
+
+    D3D11RenderContext renderContext( m_d3dDeviceContext.Get(), m_DynamicConstantBuffer.get() );
+    StateCache stateCache( renderContext );
+
+    {
+        GPU_PROFILE_SCOPE( get_GpuProfiler(), "Scene" );
+        m_RenderQueue.Execute( stateCache );
+    }
+    m_StateCacheStatistics = stateCache.get_Statistics();
+
+    if ( m_DeferredShading )
+    {
+        GPU_PROFILE_SCOPE( get_GpuProfiler(), "Lighting" );
+        ShadeGBuffer();
     }
 
+    m_DynamicConstantBuffer->EndFrame( m_d3dDeviceContext.Get() );
+    m_LightBuffer->EndFrame( m_d3dDeviceContext.Get() );
+
     Present();
 }
 
+void TextureAndLightingDemo::LoadTexturedLitVariants()
+{
+    PROFILE_SCOPE( "LoadTexturedLitVariants" );
+
+    // The precompiled shader handles every material and light type.
+    m_d3dTexturedLitPixelShaders.assign( m_TexturedLitPermutations.get_NumVariants(), m_d3dTexturedLitPixelShader );
+
+    std::ifstream file( "..\\data\\Shaders\\TexturedLitPixelShader.hlsl", std::ios::in | std::ios::binary );
+    if ( !file )
+    {
+        OutputDebugStringA( "The source of the textured lit pixel shader was not found. The variants are not used.\n" );
+        return;
+    }
+
+    ShaderSource source;
+    source.Name = "TexturedLitPixelShader.hlsl";
+    source.Code.assign( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+    source.EntryPoint = "TexturedLitPixelShader";
+    source.Target = "ps_5_0";
+
+    // The variants are only compiled on the first run or after the shader changed.
+    CreateDirectoryA( "..\\data\\ShaderCache", nullptr );
+    D3DShaderCompiler compiler;
+    ShaderCache cache( compiler, "..\\data\\ShaderCache" );
+
+    std::vector<ShaderDefine> defines;
+    std::vector<uint8_t> bytecode;
+    for ( uint32_t variant = 0; variant < m_TexturedLitPermutations.get_NumVariants(); ++variant )
+    {
+        m_TexturedLitPermutations.GetDefines( variant, defines );
+        if ( !cache.Load( source, defines, bytecode ) )
+        {
+            OutputDebugStringA( cache.get_Errors().c_str() );
+            continue;
+        }
+
+        Microsoft::WRL::ComPtr<ID3D11PixelShader> pixelShader;
+        HRESULT hr = m_d3dDevice->CreatePixelShader( bytecode.data(), bytecode.size(), nullptr, &pixelShader );
+        if ( SUCCEEDED(hr) )
+        {
+            m_d3dTexturedLitPixelShaders[variant] = pixelShader;
+        }
+    }
+}
+
+uint32_t TextureAndLightingDemo::GetPixelShaderVariant( const MaterialProperties& material ) const
+{
+    // The G-buffer pixel shader is numbered after the variants of the textured lit pixel shader.
+    if ( m_DeferredShading )
+    {
+        return m_TexturedLitPermutations.get_NumVariants();
+    }
+
+    // The variant without the branches on the texture and the light types that are not enabled.
+    uint32_t numEnabledLights[LightTypeCount];
+    for ( int type = 0; type < LightTypeCount; ++type )
+    {
+        numEnabledLights[type] = m_LightManager.GetNumEnabledLights( static_cast<LightType>( type ) );
+    }
+    return GetTexturedLitVariant( m_TexturedLitPermutations, material.Material, numEnabledLights );
+}
+
+ID3D11PixelShader* TextureAndLightingDemo::GetPixelShader( const MaterialProperties& material ) const
+{
+    if ( m_DeferredShading )
+    {
+        return m_d3dGBufferPixelShader.Get();
+    }
+    return m_d3dTexturedLitPixelShaders[GetPixelShaderVariant( material )].Get();
+}
+
+void TextureAndLightingDemo::UpdateShadowMaps()
+{
+    PROFILE_SCOPE( "UpdateShadowMaps" );
+
+    const float shadowNearZ = 0.5f;
+    const float shadowFarZ = 100.0f;
+    const float shadowDepthBias = 0.0001f;
+    const float cascadeSplitLambda = 0.8f;
+    const float cascadeCasterDistance = 50.0f;
+    // The cascades get 1024 x 1024 tiles (see ShadowAtlas::GetTileSize).
+    const float cascadeImportance = 0.5f;
+
+    // The shadow map of animated light i is shadow map i (the point lights do not cast shadows),
+    // followed by the cascades of the sun.
+    m_ShadowImportance.assign( NumAnimatedLights + NumCascades, 0.0f );
+    m_ShadowViews.resize( NumAnimatedLights + NumCascades );
+    for ( int i = 0; i < NumAnimatedLights; ++i )
+    {
+        Light light = m_LightManager.Get( m_AnimatedLights[i] );
+        if ( light.Enabled && light.LightType == SpotLight )
+        {
+            m_ShadowImportance[i] = ShadowImportance( light, m_Camera );
+            m_ShadowViews[i] = ComputeSpotShadowView( light, shadowNearZ, shadowFarZ );
+        }
+    }
+
+    Light sunLight = m_LightManager.Get( m_SunLight );
+    if ( sunLight.Enabled )
+    {
+        std::fill( m_ShadowImportance.begin() + NumAnimatedLights, m_ShadowImportance.end(), cascadeImportance );
+    }
+
+    m_ShadowAtlas.Pack( m_ShadowImportance, m_ShadowTiles );
+    m_ShadowCache.BeginFrame();
+    m_ShadowMapConstants.clear();
+    m_ShadowPasses.clear();
+
+    for ( int i = 0; i < NumAnimatedLights; ++i )
+    {
+        const ShadowAtlasTile& tile = m_ShadowTiles[i];
+        if ( tile.Size == 0 )
+        {
+            m_LightManager.SetShadowIndex( m_AnimatedLights[i], -1 );
+            continue;
+        }
+
+        m_LightManager.SetShadowIndex( m_AnimatedLights[i], static_cast<int>( m_ShadowMapConstants.size() ) );
+        m_ShadowMapConstants.push_back( ComputeShadowMapConstants( m_ShadowViews[i], tile, m_ShadowAtlas.get_Size(), FLT_MAX, shadowDepthBias ) );
+
+        if ( m_ShadowCache.Update( i, tile, m_ShadowViews[i] ) )
+        {
+            ShadowPass shadowPass = {};
+            shadowPass.Tile = tile;
+            shadowPass.ViewProjectionMatrix = m_ShadowViews[i].ViewProjectionMatrix;
+            shadowPass.RenderWalls = true;
+            m_ShadowPasses.push_back( shadowPass );
+        }
+    }
+
+    // The shaders find the cascade of a pixel from the first one, so the cascades are
+    // consecutive shadow maps and the sun only casts shadows if all of them have a tile.
+    bool cascadesPacked = sunLight.Enabled != 0;
+    for ( int c = 0; c < NumCascades; ++c )
+    {
+        cascadesPacked = cascadesPacked && m_ShadowTiles[NumAnimatedLights + c].Size != 0;
+    }
+    if ( !cascadesPacked )
+    {
+        m_LightManager.SetShadowIndex( m_SunLight, -1 );
+        return;
+    }
+
+    float splits[NumCascades + 1];
+    ComputeCascadeSplits( m_Camera.get_NearClipPlane(), m_Camera.get_FarClipPlane(), NumCascades, cascadeSplitLambda, splits );
+
+    m_LightManager.SetShadowIndex( m_SunLight, static_cast<int>( m_ShadowMapConstants.size() ) );
+    for ( int c = 0; c < NumCascades; ++c )
+    {
+        int i = NumAnimatedLights + c;
+        const ShadowAtlasTile& tile = m_ShadowTiles[i];
+        m_ShadowViews[i] = ComputeCascadeView( m_Camera, Math::XYZ( sunLight.Direction ), splits[c], splits[c + 1], tile.Size, cascadeCasterDistance );
+
+        float splitDepth = ( c + 1 < NumCascades ) ? splits[c + 1] : FLT_MAX;
+        m_ShadowMapConstants.push_back( ComputeShadowMapConstants( m_ShadowViews[i], tile, m_ShadowAtlas.get_Size(), splitDepth, shadowDepthBias ) );
+
+        if ( m_ShadowCache.Update( i, tile, m_ShadowViews[i] ) )
+        {
+            ShadowPass shadowPass = {};
+            shadowPass.Tile = tile;
+            shadowPass.ViewProjectionMatrix = m_ShadowViews[i].ViewProjectionMatrix;
+            shadowPass.RenderWalls = false;
+            m_ShadowPasses.push_back( shadowPass );
+        }
+    }
+}
+
+void TextureAndLightingDemo::RenderShadowMaps()
+{
+    // The atlas cannot be bound as a depth buffer and a shader resource at the same time.
+    ID3D11ShaderResourceView* nullShaderResourceViews[2] = { nullptr, nullptr };
+    m_d3dDeviceContext->PSSetShaderResources( 4, 2, nullShaderResourceViews );
+
+    m_ShadowMapBuffer->Update( m_d3dDeviceContext.Get(), m_ShadowMapConstants );
+
+    if ( m_ShadowPasses.empty() )
+    {
+        return;
+    }
+
+    m_ShadowAtlasTexture->SetRenderTarget( m_d3dDeviceContext.Get() );
+
+    // Only the depth of the shadow casters is written.
+    DrawCommand casterCommand = {};
+    casterCommand.NumVSConstantBuffers = 1;
+    casterCommand.RasterizerState = m_ShadowAtlasTexture->get_RasterizerState();
+    casterCommand.DepthStencilState = m_d3dDepthStencilState.Get();
+
+    DrawCommand wallsCommand = casterCommand;
+    wallsCommand.InputLayout = m_d3dInstancedInputLayout.Get();
+    wallsCommand.PrimitiveTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    VertexBufferBinding planeVertexBuffer = { m_d3dPlaneVertexBuffer.Get(), sizeof(VertexPosNormTex), 0 };
+    VertexBufferBinding planeInstanceBuffer = { m_d3dPlaneInstanceBuffer.Get(), sizeof(PlaneInstanceData), 0 };
+    wallsCommand.VertexBuffers[0] = planeVertexBuffer;
+    wallsCommand.VertexBuffers[1] = planeInstanceBuffer;
+    wallsCommand.NumVertexBuffers = 2;
+    wallsCommand.IndexBuffer = m_d3dPlaneIndexBuffer.Get();
+    wallsCommand.IndexFormat = DXGI_FORMAT_R16_UINT;
+    wallsCommand.VertexShader = m_d3dInstancedVertexShader.Get();
+    wallsCommand.IndexCount = _countof(g_PlaneIndex);
+    wallsCommand.InstanceCount = m_NumInstances;
+
+    casterCommand.InputLayout = m_d3dVertexPositionNormalTextureInputLayout.Get();
+    casterCommand.VertexShader = m_d3dSimplVertexShader.Get();
+
+    DrawCommand sphereCommand = casterCommand;
+    m_Sphere->SetupDrawCommand( sphereCommand );
+    DrawCommand cubeCommand = casterCommand;
+    m_Cube->SetupDrawCommand( cubeCommand );
+    DrawCommand torusCommand = casterCommand;
+    m_Torus->SetupDrawCommand( torusCommand );
+
+    D3D11RenderContext renderContext( m_d3dDeviceContext.Get(), m_DynamicConstantBuffer.get() );
+
+    for ( size_t i = 0; i < m_ShadowPasses.size(); ++i )
+    {
+        const ShadowPass& shadowPass = m_ShadowPasses[i];
+        m_ShadowAtlasTexture->SetViewport( m_d3dDeviceContext.Get(), shadowPass.Tile );
+
+        // Clear the tile to the far plane with a triangle that covers the viewport.
+        m_d3dDeviceContext->IASetInputLayout( nullptr );
+        m_d3dDeviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+        m_d3dDeviceContext->VSSetShader( m_d3dShadowClearVertexShader.Get(), nullptr, 0 );
+        m_d3dDeviceContext->PSSetShader( nullptr, nullptr, 0 );
+        m_d3dDeviceContext->RSSetState( m_ShadowAtlasTexture->get_RasterizerState() );
+        m_d3dDeviceContext->OMSetDepthStencilState( m_ShadowAtlasTexture->get_ClearDepthStencilState(), 0 );
+        m_d3dDeviceContext->Draw( 3, 0 );
+
+        if ( shadowPass.RenderWalls )
+        {
+            wallsCommand.VSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( shadowPass.WallsConstants );
+            RenderQueue::Execute( renderContext, wallsCommand );
+        }
+
+        sphereCommand.VSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( shadowPass.SphereConstants );
+        RenderQueue::Execute( renderContext, sphereCommand );
+
+        cubeCommand.VSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( shadowPass.CubeConstants );
+        RenderQueue::Execute( renderContext, cubeCommand );
+
+        torusCommand.VSConstantBuffers[0] = m_DynamicConstantBuffer->GetBinding( shadowPass.TorusConstants );
+        RenderQueue::Execute( renderContext, torusCommand );
+    }
+}
+
+void TextureAndLightingDemo::ShadeGBuffer()
+{
+    // The G-buffer cannot be bound as a render target and a shader resource at the same time.
+    m_d3dDeviceContext->OMSetRenderTargets( 0, nullptr, nullptr );
+
+    // t0 - t4: the depth buffer and the G-buffer, t5: the lights, t6: the view-space bounds of the lights,
+    // t7: the shadow maps, t8: the shadow atlas.
+    m_GBuffer->SetComputeShaderResources( m_d3dDeviceContext.Get(), 0 );
+    ID3D11ShaderResourceView* lightViews[4] = { m_LightBuffer->get_ShaderResourceView(), m_LightBoundsBuffer->get_ShaderResourceView(),
+        m_ShadowMapBuffer->get_ShaderResourceView(), m_ShadowAtlasTexture->get_ShaderResourceView() };
+    m_d3dDeviceContext->CSSetShaderResources( GBuffer::NumTargets + 1, _countof(lightViews), lightViews );
+    ID3D11SamplerState* shadowSampler = m_ShadowAtlasTexture->get_SamplerState();
+    m_d3dDeviceContext->CSSetSamplers( 0, 1, &shadowSampler );
+
+    ID3D11UnorderedAccessView* outputView = m_GBuffer->get_OutputUnorderedAccessView();
+    m_d3dDeviceContext->CSSetUnorderedAccessViews( 0, 1, &outputView, nullptr );
+    m_d3dDeviceContext->CSSetConstantBuffers( 0, 1, m_d3dTiledDeferredConstantBuffer.GetAddressOf() );
+    m_d3dDeviceContext->CSSetShader( m_d3dTiledDeferredComputeShader.Get(), nullptr, 0 );
+
+    const UINT tileSize = TiledLightCulling::TileSize;
+    m_d3dDeviceContext->Dispatch( ( m_GBuffer->get_Width() + tileSize - 1 ) / tileSize, ( m_GBuffer->get_Height() + tileSize - 1 ) / tileSize, 1 );
+
+    // Unbind the G-buffer, the atlas, and the output so that they can be rendered to in the next frame.
+    ID3D11ShaderResourceView* nullViews[GBuffer::NumTargets + 5] = {};
+    m_d3dDeviceContext->CSSetShaderResources( 0, _countof(nullViews), nullViews );
+    ID3D11UnorderedAccessView* nullOutputView = nullptr;
+    m_d3dDeviceContext->CSSetUnorderedAccessViews( 0, 1, &nullOutputView, nullptr );
+    m_d3dDeviceContext->CSSetShader( nullptr, nullptr, 0 );
+
+    // The output has the size and the format of the back buffer.
+    Microsoft::WRL::ComPtr<ID3D11Resource> backBuffer;
+    m_d3dRenderTargetView->GetResource( &backBuffer );
+    m_d3dDeviceContext->CopyResource( backBuffer.Get(), m_GBuffer->get_OutputTexture() );
+
+    m_d3dDeviceContext->OMSetRenderTargets( 1, m_d3dRenderTargetView.GetAddressOf(), m_d3dDepthStencilView.Get() );
+}
+
 void TextureAndLightingDemo::UnloadContent()
 {
+    Mesh::set_Cache( nullptr );
+}
 
+const StateCache::Statistics& TextureAndLightingDemo::get_StateCacheStatistics() const
+{
+    return m_StateCacheStatistics;
+}
+
+const LightBuffer::Statistics& TextureAndLightingDemo::get_LightBufferStatistics() const
+{
+    return m_LightBuffer->get_Statistics();
+}
+
+const ShadowCache::Statistics& TextureAndLightingDemo::get_ShadowCacheStatistics() const
+{
+    return m_ShadowCache.get_Statistics();
+}
+
+void TextureAndLightingDemo::set_NumStaticLights( unsigned int numStaticLights )
+{
+    m_NumStaticLights = numStaticLights;
+}
+
+unsigned int TextureAndLightingDemo::get_NumStaticLights() const
+{
+    return m_NumStaticLights;
+}
+
+void TextureAndLightingDemo::set_DeferredShading( bool deferredShading )
+{
+    m_DeferredShading = deferredShading;
+}
+
+bool TextureAndLightingDemo::get_DeferredShading() const
+{
+    return m_DeferredShading;
 }
 
 void TextureAndLightingDemo::OnKeyPressed( KeyEventArgs& e )
@@ -673,8 +1354,8 @@ void TextureAndLightingDemo::OnKeyPressed( KeyEventArgs& e )
     case KeyCode::R:
         {
             // Reset camera position and orientation
-            m_Camera.set_Translation( pData->m_InitialCameraPos );
-            m_Camera.set_Rotation( pData->m_InitialCameraRot );
+            m_Camera.set_Translation( ToFloat3(pData->m_InitialCameraPos) );
+            m_Camera.set_Rotation( ToFloat4(pData->m_InitialCameraRot) );
             m_Pitch = 0.0f;
             m_Yaw = 0.0f;
         }
@@ -790,6 +1471,11 @@ void TextureAndLightingDemo::OnResize( ResizeEventArgs& e )
     float aspectRatio = e.Width / (float)e.Height;
 
     m_Camera.set_Projection( 45.0f, aspectRatio, 0.1f, 100.0f );
+    m_LightClusters.SetProjection( m_Camera );
+    if ( m_GBuffer )
+    {
+        m_GBuffer->Resize( e.Width, e.Height );
+    }
 
     // Setup the viewports for the camera.
     D3D11_VIEWPORT viewport;
@@ -800,7 +1486,7 @@ void TextureAndLightingDemo::OnResize( ResizeEventArgs& e )
     viewport.MinDepth = 0.0f;
     viewport.MaxDepth = 1.0f;
 
-    m_Camera.set_Viewport( viewport );
+    m_Camera.set_Viewport( FromD3D11Viewport(viewport) );
 
     m_d3dDeviceContext->RSSetViewports( 1, &viewport ); 
 }
@@ -1,26 +1,134 @@
 #include <TextureAndLightingPCH.h>
 #include <Application.h>
 #include <Window.h>
+#include <Profiler.h>
 
 #include <TextureAndLightingDemo.h>
 
+#include <fstream>
+
 const char* g_WindowName = "Texture and Lighting Demo";
 int g_WindowWidth = 800;
 int g_WindowHeight = 600;
 bool g_VSync = false;
 bool g_Windowed = true;
 
+// Command line options for headless mode:
+//   -headless <frames>   Render <frames> frames into an offscreen render target
+//                        and write the CPU frame times to frametimes.csv.
+//   -capture <interval>  In headless mode, save every <interval> frame to frame_<n>.tga.
+bool g_Headless = false;
+unsigned int g_HeadlessFrames = 100;
+unsigned int g_CaptureInterval = 0;
+const float g_HeadlessTimeStep = 1.0f / 60.0f;
+
+// -fixedupdate <rate>    Update the demo <rate> times per second instead of once per frame.
+unsigned int g_FixedUpdateRate = 0;
+
+// Frame pacing options:
+//   -flipmodel <buffers>  Use a flip-model swap chain with <buffers> buffers.
+//   -latency <frames>     The maximum number of queued frames of the flip-model swap chain.
+//   -predictive           Delay the start of each frame so it finishes just before the vertical blank.
+unsigned int g_FlipModelBuffers = 0;
+FramePacingSettings g_FramePacing;
+
+// -profile <file>        Write the latest CPU and GPU profiler zones to <file> on exit, as a
+//                         Chrome trace or in the binary format if the file name ends with .dxtp.
+std::string g_ProfileFileName;
+
+// -lights <count>        Scatter <count> small static point lights around the room.
+unsigned int g_NumStaticLights = 0;
+
+// -deferred              Shade the scene with the tiled deferred path instead of clustered forward.
+bool g_DeferredShading = false;
+
+void WriteProfile( const std::string& fileName )
+{
+    ProfileCapture capture;
+    Profiler::Collect( capture );
+
+    const std::string binaryExtension = ".dxtp";
+    bool binary = fileName.size() >= binaryExtension.size() &&
+        fileName.compare( fileName.size() - binaryExtension.size(), binaryExtension.size(), binaryExtension ) == 0;
+    if ( !( binary ? capture.WriteBinary( fileName ) : capture.WriteChromeTrace( fileName ) ) )
+    {
+        std::cerr << "Error: Failed to write the profile to " << fileName << std::endl;
+    }
+}
+
+void ParseCommandLine( LPWSTR cmdLine )
+{
+    std::wistringstream arguments( cmdLine );
+    std::wstring argument;
+    while ( arguments >> argument )
+    {
+        if ( argument == L"-headless" )
+        {
+            g_Headless = true;
+            arguments >> g_HeadlessFrames;
+        }
+        else if ( argument == L"-capture" )
+        {
+            arguments >> g_CaptureInterval;
+        }
+        else if ( argument == L"-fixedupdate" )
+        {
+            arguments >> g_FixedUpdateRate;
+        }
+        else if ( argument == L"-flipmodel" )
+        {
+            arguments >> g_FlipModelBuffers;
+        }
+        else if ( argument == L"-latency" )
+        {
+            arguments >> g_FramePacing.MaxFrameLatency;
+            if ( g_FramePacing.MaxFrameLatency == 0 )
+            {
+                g_FramePacing.MaxFrameLatency = 1;
+            }
+        }
+        else if ( argument == L"-predictive" )
+        {
+            g_FramePacing.PredictiveStart = true;
+        }
+        else if ( argument == L"-profile" )
+        {
+            std::wstring fileName;
+            arguments >> fileName;
+            g_ProfileFileName.assign( fileName.begin(), fileName.end() );
+        }
+        else if ( argument == L"-lights" )
+        {
+            arguments >> g_NumStaticLights;
+        }
+        else if ( argument == L"-deferred" )
+        {
+            g_DeferredShading = true;
+        }
+    }
+}
+
 int WINAPI wWinMain( HINSTANCE hInstance, HINSTANCE prevInstance, LPWSTR cmdLine, int cmdShow )
 {
     UNREFERENCED_PARAMETER( prevInstance );
-    UNREFERENCED_PARAMETER( cmdLine );
+
+    ParseCommandLine( cmdLine );
+    Profiler::set_Enabled( !g_ProfileFileName.empty() );
 
     Application::Create(hInstance);
     Application& app = Application::Get();
+    app.set_FixedUpdateRate( g_FixedUpdateRate );
 
-    Window& window = app.CreateRenderWindow( g_WindowName, g_WindowWidth, g_WindowHeight, g_VSync, g_Windowed );
+    Window& window = g_Headless ?
+        app.CreateHeadlessWindow( g_WindowName, g_WindowWidth, g_WindowHeight ) :
+        app.CreateRenderWindow( g_WindowName, g_WindowWidth, g_WindowHeight, g_VSync, g_Windowed );
 
     TextureAndLightingDemo* pDemo = new TextureAndLightingDemo(window);
+    pDemo->set_FlipModel( g_FlipModelBuffers > 0, g_FlipModelBuffers );
+    pDemo->set_FramePacing( g_FramePacing );
+    pDemo->set_GpuProfiling( !g_ProfileFileName.empty() );
+    pDemo->set_NumStaticLights( g_NumStaticLights );
+    pDemo->set_DeferredShading( g_DeferredShading );
 
     if ( !pDemo->Initialize() )
     {
@@ -32,12 +140,40 @@ int WINAPI wWinMain( HINSTANCE hInstance, HINSTANCE prevInstance, LPWSTR cmdLine
         return -1;
     }
 
-    int exitCode = app.Run();
+    int exitCode = 0;
+
+    if ( g_Headless )
+    {
+        std::ofstream frameTimes( "frametimes.csv" );
+        frameTimes << "Frame,Time (ms)" << std::endl;
+
+        exitCode = app.RunHeadless( g_HeadlessFrames, g_HeadlessTimeStep, 
+            [&]( unsigned int frameIndex, double frameTime )
+            {
+                frameTimes << frameIndex << "," << frameTime * 1000.0 << std::endl;
+
+                if ( g_CaptureInterval > 0 && ( frameIndex % g_CaptureInterval ) == 0 )
+                {
+                    std::ostringstream fileName;
+                    fileName << "frame_" << frameIndex << ".tga";
+                    pDemo->SaveBackBuffer( fileName.str() );
+                }
+            } );
+    }
+    else
+    {
+        exitCode = app.Run();
+    }
 
     pDemo->UnloadContent();
     pDemo->Cleanup();
 
     delete pDemo;
 
+    if ( !g_ProfileFileName.empty() )
+    {
+        WriteProfile( g_ProfileFileName );
+    }
+
     return exitCode;
-}
\ No newline at end of file
+}